@@ -277,6 +277,143 @@ public:
     }
 };
 
+// SimpleSharedPtr的三个问题：对象和计数分两次分配、计数总是原子操作、计数无法放进对象内部
+// 下面用计数策略(CountPolicy)把"是否原子"独立出来，再分别实现单次分配和侵入式两种引用计数
+
+// 多线程共享：增加用relaxed即可，减少需要acq_rel保证析构前看到其他线程的全部写入
+struct AtomicRefCount {
+    typedef std::atomic<int> counter_type;
+    static void increment(counter_type& count) { count.fetch_add(1, std::memory_order_relaxed); }
+    static bool decrement(counter_type& count) { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    static int load(const counter_type& count) { return count.load(std::memory_order_relaxed); }
+};
+
+// 仅限单线程使用的对象图：普通int，没有锁前缀指令
+struct LocalRefCount {
+    typedef int counter_type;
+    static void increment(counter_type& count) { ++count; }
+    static bool decrement(counter_type& count) { return --count == 0; }
+    static int load(const counter_type& count) { return count; }
+};
+
+// make_shared风格：计数和对象放在同一个控制块里，只分配一次
+template<typename T, typename CountPolicy = AtomicRefCount>
+class BasicSharedPtr {
+private:
+    struct ControlBlock {
+        typename CountPolicy::counter_type count;
+        T value;
+        
+        template<typename... Args>
+        explicit ControlBlock(Args&&... args) : count(1), value(std::forward<Args>(args)...) {}
+    };
+    
+    ControlBlock* block;
+    
+    explicit BasicSharedPtr(ControlBlock* b) : block(b) {}
+    
+public:
+    BasicSharedPtr() noexcept : block(nullptr) {}
+    
+    BasicSharedPtr(const BasicSharedPtr& other) noexcept : block(other.block) {
+        if (block) CountPolicy::increment(block->count);
+    }
+    
+    BasicSharedPtr(BasicSharedPtr&& other) noexcept : block(other.block) {
+        other.block = nullptr;
+    }
+    
+    BasicSharedPtr& operator=(BasicSharedPtr other) noexcept {
+        std::swap(block, other.block);
+        return *this;
+    }
+    
+    ~BasicSharedPtr() {
+        if (block && CountPolicy::decrement(block->count)) {
+            delete block;
+        }
+    }
+    
+    template<typename... Args>
+    static BasicSharedPtr make(Args&&... args) {
+        return BasicSharedPtr(new ControlBlock(std::forward<Args>(args)...));
+    }
+    
+    T& operator*() const { return block->value; }
+    T* operator->() const { return &block->value; }
+    T* get() const { return block ? &block->value : nullptr; }
+    
+    int use_count() const { return block ? CountPolicy::load(block->count) : 0; }
+    explicit operator bool() const { return block != nullptr; }
+};
+
+template<typename T, typename... Args>
+BasicSharedPtr<T, AtomicRefCount> make_simple_shared(Args&&... args) {
+    return BasicSharedPtr<T, AtomicRefCount>::make(std::forward<Args>(args)...);
+}
+
+template<typename T, typename... Args>
+BasicSharedPtr<T, LocalRefCount> make_local_shared(Args&&... args) {
+    return BasicSharedPtr<T, LocalRefCount>::make(std::forward<Args>(args)...);
+}
+
+// 侵入式计数：计数嵌在对象里，指针只有一个字长，可以从裸指针重新得到共享所有权
+template<typename CountPolicy = AtomicRefCount>
+class RefCounted {
+private:
+    mutable typename CountPolicy::counter_type ref_count_;
+    
+protected:
+    RefCounted() : ref_count_(0) {}
+    RefCounted(const RefCounted&) : ref_count_(0) {}  // 拷贝出的新对象从0开始计数
+    RefCounted& operator=(const RefCounted&) { return *this; }
+    ~RefCounted() {}
+    
+public:
+    void add_ref() const { CountPolicy::increment(ref_count_); }
+    bool release_ref() const { return CountPolicy::decrement(ref_count_); }
+    int ref_count() const { return CountPolicy::load(ref_count_); }
+};
+
+template<typename T>
+class IntrusivePtr {
+private:
+    T* ptr;
+    
+public:
+    IntrusivePtr() noexcept : ptr(nullptr) {}
+    
+    explicit IntrusivePtr(T* p) : ptr(p) {
+        if (ptr) ptr->add_ref();
+    }
+    
+    IntrusivePtr(const IntrusivePtr& other) : ptr(other.ptr) {
+        if (ptr) ptr->add_ref();
+    }
+    
+    IntrusivePtr(IntrusivePtr&& other) noexcept : ptr(other.ptr) {
+        other.ptr = nullptr;
+    }
+    
+    IntrusivePtr& operator=(IntrusivePtr other) noexcept {
+        std::swap(ptr, other.ptr);
+        return *this;
+    }
+    
+    ~IntrusivePtr() {
+        if (ptr && ptr->release_ref()) {
+            delete ptr;
+        }
+    }
+    
+    T& operator*() const { return *ptr; }
+    T* operator->() const { return ptr; }
+    T* get() const { return ptr; }
+    
+    int use_count() const { return ptr ? ptr->ref_count() : 0; }
+    explicit operator bool() const { return ptr != nullptr; }
+};
+
 void demonstrate_shared_ptr_mechanism() {
     std::cout << "=== shared_ptr引用计数机制演示 ===\n";
     
@@ -294,6 +431,23 @@ void demonstrate_shared_ptr_mechanism() {
         std::cout << "退出内层作用域后引用计数: " << sptr1.use_count() << std::endl;
     }  // sptr1销毁，引用计数归零，资源释放
     
+    std::cout << "\n--- 单次分配与侵入式计数 ---\n";
+    {
+        BasicSharedPtr<std::string> text1 = make_simple_shared<std::string>("控制块与对象一次分配");
+        BasicSharedPtr<std::string> text2 = text1;
+        std::cout << "BasicSharedPtr引用计数: " << text1.use_count() << ", 值: " << *text2 << std::endl;
+        
+        struct Widget : RefCounted<> {
+            int id;
+            explicit Widget(int i) : id(i) {}
+        };
+        IntrusivePtr<Widget> widget1(new Widget(9));
+        Widget* raw = widget1.get();
+        IntrusivePtr<Widget> widget2(raw);  // 计数在对象里，裸指针也能重新共享所有权
+        std::cout << "IntrusivePtr引用计数: " << widget2.use_count() << ", sizeof: " << sizeof(widget2)
+                  << " (shared_ptr: " << sizeof(std::shared_ptr<Widget>) << ")" << std::endl;
+    }
+    
     // 标准shared_ptr演示
     std::cout << "\n--- 标准shared_ptr ---\n";
     std::shared_ptr<Resource> std_ptr1 = std::make_shared<Resource>(7, "StdShared");
@@ -397,6 +551,73 @@ void demonstrate_circular_reference_problem() {
 
 // ===== 5. 性能对比分析 =====
 
+// DOM风格的树：节点通过智能指针持有子节点，遍历时按值传递指针，产生大量计数增减
+template<typename T> using StdSharedPtr = std::shared_ptr<T>;
+template<typename T> using AtomicSharedPtr = BasicSharedPtr<T, AtomicRefCount>;
+template<typename T> using LocalSharedPtr = BasicSharedPtr<T, LocalRefCount>;
+
+template<template<typename> class Ptr>
+struct SharedDomNode {
+    int value;
+    std::vector<Ptr<SharedDomNode>> children;
+    explicit SharedDomNode(int v) : value(v) {}
+};
+
+template<typename CountPolicy>
+struct IntrusiveDomNode : RefCounted<CountPolicy> {
+    int value;
+    std::vector<IntrusivePtr<IntrusiveDomNode>> children;
+    explicit IntrusiveDomNode(int v) : value(v) {}
+};
+
+template<typename Ptr, typename Make>
+Ptr build_dom_tree(Make make, int depth, int& next_value) {
+    Ptr node = make(next_value++);
+    if (depth > 0) {
+        for (int i = 0; i < 4; ++i) {
+            node->children.push_back(build_dom_tree<Ptr>(make, depth - 1, next_value));
+        }
+    }
+    return node;
+}
+
+// 按值传参：每次调用一次计数增加、返回时一次计数减少
+template<typename Ptr>
+long long visit_dom_tree(Ptr node) {
+    long long sum = node->value;
+    for (size_t i = 0; i < node->children.size(); ++i) {
+        sum += visit_dom_tree(node->children[i]);
+    }
+    return sum;
+}
+
+template<typename Ptr, typename Make>
+void benchmark_refcount_policy(const char* name, Make make) {
+    const int depth = 6;        // 4叉树，5461个节点，能放进缓存，突出计数本身的开销
+    const int visits = 1000;
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    long long checksum = 0;
+    {
+        int next_value = 0;
+        Ptr root = build_dom_tree<Ptr>(make, depth, next_value);
+        auto built = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < visits; ++i) {
+            checksum += visit_dom_tree(root);
+        }
+        auto visited = std::chrono::high_resolution_clock::now();
+        std::cout << "  " << name << "构建 "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(built - start).count() / 1000.0
+                  << "ms, 遍历x" << visits << " "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(visited - built).count() / 1000.0
+                  << "ms";
+        start = std::chrono::high_resolution_clock::now();
+    }  // 析构整棵树
+    auto destroyed = std::chrono::high_resolution_clock::now();
+    std::cout << ", 析构 " << std::chrono::duration_cast<std::chrono::microseconds>(destroyed - start).count() / 1000.0
+              << "ms (sizeof指针=" << sizeof(Ptr) << ", 校验和=" << checksum << ")\n";
+}
+
 void performance_comparison() {
     std::cout << "=== 智能指针性能对比 ===\n";
     
@@ -451,6 +672,30 @@ void performance_comparison() {
     std::cout << "unique_ptr大小: " << sizeof(std::unique_ptr<Resource>) << " bytes\n";
     std::cout << "shared_ptr大小: " << sizeof(std::shared_ptr<Resource>) << " bytes\n";
     
+    // 引用计数策略对比：两次分配/单次分配/侵入式，原子计数/普通计数
+    typedef SharedDomNode<StdSharedPtr> StdNode;
+    typedef SharedDomNode<AtomicSharedPtr> AtomicNode;
+    typedef SharedDomNode<LocalSharedPtr> LocalNode;
+    typedef IntrusiveDomNode<AtomicRefCount> AtomicIntrusiveNode;
+    typedef IntrusiveDomNode<LocalRefCount> LocalIntrusiveNode;
+    
+    // libstdc++在进程从未创建过线程时对shared_ptr使用非原子计数，先启动一个线程保证比较公平
+    std::thread([] {}).join();
+    std::cout << "\n引用计数策略对比 (DOM树):\n";
+    benchmark_refcount_policy<std::shared_ptr<StdNode>>("shared_ptr(new T)       ",
+        [](int v) { return std::shared_ptr<StdNode>(new StdNode(v)); });
+    benchmark_refcount_policy<std::shared_ptr<StdNode>>("make_shared             ",
+        [](int v) { return std::make_shared<StdNode>(v); });
+    benchmark_refcount_policy<AtomicSharedPtr<AtomicNode>>("BasicSharedPtr<原子>    ",
+        [](int v) { return make_simple_shared<AtomicNode>(v); });
+    benchmark_refcount_policy<LocalSharedPtr<LocalNode>>("BasicSharedPtr<单线程>  ",
+        [](int v) { return make_local_shared<LocalNode>(v); });
+    benchmark_refcount_policy<IntrusivePtr<AtomicIntrusiveNode>>("IntrusivePtr<原子>      ",
+        [](int v) { return IntrusivePtr<AtomicIntrusiveNode>(new AtomicIntrusiveNode(v)); });
+    benchmark_refcount_policy<IntrusivePtr<LocalIntrusiveNode>>("IntrusivePtr<单线程>    ",
+        [](int v) { return IntrusivePtr<LocalIntrusiveNode>(new LocalIntrusiveNode(v)); });
+    std::cout << "注：遍历耗时主要来自计数增减，单线程策略省掉了lock前缀的原子指令\n";
+    
     std::cout << "\n";
 }
 
@@ -639,4 +884,5 @@ g++ -std=c++11 -pthread -O2 -Wall 03_smart_pointers_raii.cpp -o smart_pointers
 5. 了解不同智能指针的性能特征
 6. 掌握智能指针在设计模式中的应用
 7. 养成使用智能指针的最佳实践习惯
+8. 单次分配控制块、侵入式计数和非原子计数策略可以按场景降低引用计数开销
 */
\ No newline at end of file
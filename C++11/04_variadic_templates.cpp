@@ -7,6 +7,7 @@
  * 3. 完美转发与参数包的结合
  * 4. 元编程技巧：类型操作和编译期计算
  * 5. 实际应用：通用工厂函数、tuple实现等
+ * 6. 编译期解析格式串：片段列表、参数个数/类型检查、一次写出的栈缓冲区格式化
  */
 
 #include <iostream>
@@ -17,6 +18,13 @@
 #include <memory>
 #include <functional>
 #include <utility>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <streambuf>
 
 // ===== 1. 基础语法和参数包展开 =====
 
@@ -424,7 +432,7 @@ void safe_printf_impl(const char* format, T&& value, Args&&... args) {
     while (*format) {
         if (*format == '%' && *(++format) != '%') {
             std::cout << value;
-            safe_printf_impl(++format, args...);  // 递归处理剩余参数
+            safe_printf_impl(format, args...);  // 递归处理剩余参数（format已指向占位符后的字符）
             return;
         }
         std::cout << *format++;
@@ -437,15 +445,375 @@ void safe_printf(const char* format, Args... args) {
     safe_printf_impl(format, args...);
 }
 
-// 类型安全的日志系统
+// 编译期解析的格式串：格式在编译期拆成"字面量/占位符"片段列表，参数个数和类型在编译期检查，
+// 运行时先算出长度上界，再把所有片段写进同一块栈缓冲区，最后只做一次write
+// 格式字符以模板参数包的形式携带，由宏FMT("...")生成：按下标逐个取出字面量的字符作为模板实参，
+// 超出长度的位置补'\0'，再在模板里去掉末尾的'\0'（全部是标准C++11，格式串最长64字节）；
+// %是占位符，%%是字面的%，因此"占位符后紧跟%"写不出来，需要在中间加别的字符
+template<char... Chars>
+struct FormatString {};
+
+namespace format_detail {
+    constexpr std::size_t kMaxFormatLength = 64;
+    
+    template<std::size_t N>
+    constexpr char char_at(const char (&text)[N], std::size_t i) {
+        return i < N ? text[i] : '\0';
+    }
+    
+    // 逐个接收字符，遇到第一个'\0'就结束
+    template<typename Result, char... Rest>
+    struct TrimFormat;
+    
+    template<char... Chars>
+    struct TrimFormat<FormatString<Chars...>> {
+        using type = FormatString<Chars...>;
+    };
+    
+    template<char... Chars, char... Rest>
+    struct TrimFormat<FormatString<Chars...>, '\0', Rest...> {
+        using type = FormatString<Chars...>;
+    };
+    
+    template<char... Chars, char C, char... Rest>
+    struct TrimFormat<FormatString<Chars...>, C, Rest...> : TrimFormat<FormatString<Chars..., C>, Rest...> {};
+    
+    template<std::size_t N, typename Format>
+    constexpr Format checked_format(Format format) {
+        static_assert(N <= kMaxFormatLength + 1, "格式串超过64字节，需要加长FMT展开的字符个数");
+        return format;
+    }
+}
+
+#define FMT_CHAR8(s, i) ::format_detail::char_at(s, (i) + 0), ::format_detail::char_at(s, (i) + 1), \
+    ::format_detail::char_at(s, (i) + 2), ::format_detail::char_at(s, (i) + 3),                    \
+    ::format_detail::char_at(s, (i) + 4), ::format_detail::char_at(s, (i) + 5),                    \
+    ::format_detail::char_at(s, (i) + 6), ::format_detail::char_at(s, (i) + 7)
+#define FMT_CHAR64(s) FMT_CHAR8(s, 0), FMT_CHAR8(s, 8), FMT_CHAR8(s, 16), FMT_CHAR8(s, 24), \
+    FMT_CHAR8(s, 32), FMT_CHAR8(s, 40), FMT_CHAR8(s, 48), FMT_CHAR8(s, 56)
+#define FMT(s) (::format_detail::checked_format<sizeof(s)>( \
+    ::format_detail::TrimFormat< ::FormatString<>, FMT_CHAR64(s)>::type()))
+
+namespace format_detail {
+    // 片段：一段原样输出的字面量，或一个占位符
+    template<char... Chars>
+    struct Literal {
+        static constexpr char data[] = {Chars..., '\0'};
+        static constexpr std::size_t size = sizeof...(Chars);
+    };
+    template<char... Chars>
+    constexpr char Literal<Chars...>::data[];
+    
+    struct Placeholder {};
+    
+    template<typename... Segments>
+    struct SegmentList {};
+    
+    // 结束当前字面量（空字面量直接丢弃）
+    template<typename List, typename Lit>
+    struct AppendLiteral;
+    
+    template<typename... Segments, char... Chars>
+    struct AppendLiteral<SegmentList<Segments...>, Literal<Chars...>> {
+        using type = SegmentList<Segments..., Literal<Chars...>>;
+    };
+    
+    template<typename... Segments>
+    struct AppendLiteral<SegmentList<Segments...>, Literal<>> {
+        using type = SegmentList<Segments...>;
+    };
+    
+    template<typename List>
+    struct AppendPlaceholder;
+    
+    template<typename... Segments>
+    struct AppendPlaceholder<SegmentList<Segments...>> {
+        using type = SegmentList<Segments..., Placeholder>;
+    };
+    
+    // 语法与safe_printf一致：%是占位符，%%输出一个%
+    template<typename Current, typename Done, char... Rest>
+    struct ParseFormat;
+    
+    template<char... Lit, typename Done>
+    struct ParseFormat<Literal<Lit...>, Done> {
+        using type = typename AppendLiteral<Done, Literal<Lit...>>::type;
+    };
+    
+    template<char... Lit, typename Done, char... Rest>
+    struct ParseFormat<Literal<Lit...>, Done, '%', '%', Rest...>
+        : ParseFormat<Literal<Lit..., '%'>, Done, Rest...> {};
+    
+    template<char... Lit, typename Done, char... Rest>
+    struct ParseFormat<Literal<Lit...>, Done, '%', Rest...>
+        : ParseFormat<Literal<>, typename AppendPlaceholder<typename AppendLiteral<Done, Literal<Lit...>>::type>::type,
+                      Rest...> {};
+    
+    template<char... Lit, typename Done, char C, char... Rest>
+    struct ParseFormat<Literal<Lit...>, Done, C, Rest...>
+        : ParseFormat<Literal<Lit..., C>, Done, Rest...> {};
+    
+    template<typename List>
+    struct SegmentStats;
+    
+    template<>
+    struct SegmentStats<SegmentList<>> {
+        static constexpr std::size_t placeholders = 0;
+        static constexpr std::size_t literal_size = 0;
+    };
+    
+    template<typename... Segments>
+    struct SegmentStats<SegmentList<Placeholder, Segments...>> {
+        static constexpr std::size_t placeholders = 1 + SegmentStats<SegmentList<Segments...>>::placeholders;
+        static constexpr std::size_t literal_size = SegmentStats<SegmentList<Segments...>>::literal_size;
+    };
+    
+    template<char... Chars, typename... Segments>
+    struct SegmentStats<SegmentList<Literal<Chars...>, Segments...>> {
+        static constexpr std::size_t placeholders = SegmentStats<SegmentList<Segments...>>::placeholders;
+        static constexpr std::size_t literal_size = sizeof...(Chars) + SegmentStats<SegmentList<Segments...>>::literal_size;
+    };
+    
+    // 无符号整数转十进制：先数位数，再从后往前每次写两位
+    inline char* write_unsigned(char* out, unsigned long long value) {
+        static const char kDigitPairs[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        std::size_t digits = 1;
+        for (unsigned long long v = value; v >= 10; v /= 10) ++digits;
+        char* end = out + digits;
+        char* p = end;
+        while (value >= 100) {
+            const unsigned pair = static_cast<unsigned>(value % 100) * 2;
+            value /= 100;
+            *--p = kDigitPairs[pair + 1];
+            *--p = kDigitPairs[pair];
+        }
+        if (value >= 10) {
+            const unsigned pair = static_cast<unsigned>(value) * 2;
+            *--p = kDigitPairs[pair + 1];
+            *--p = kDigitPairs[pair];
+        } else {
+            *--p = static_cast<char>('0' + value);
+        }
+        return end;
+    }
+    
+    // 每种参数类型的格式化器：max_size给出写入长度上界，write写入并返回结束位置
+    // 主模板只用来标记"不支持"，格式化时用static_assert给出可读的错误信息
+    template<typename T, typename Enable = void>
+    struct ArgFormatter {
+        static constexpr bool supported = false;
+    };
+    
+    template<typename T>
+    struct is_character : std::integral_constant<bool,
+        std::is_same<T, char>::value || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value> {};
+    
+    // 整数（含bool）：与std::cout一致，bool输出1/0
+    template<typename T>
+    struct ArgFormatter<T, typename std::enable_if<std::is_integral<T>::value && !is_character<T>::value>::type> {
+        static constexpr bool supported = true;
+        static std::size_t max_size(T) { return std::numeric_limits<T>::digits10 + 2; }
+        static char* write(char* out, T value) {
+            if (is_negative(value, std::is_signed<T>())) {
+                *out++ = '-';
+                return write_unsigned(out, 0ull - static_cast<unsigned long long>(value));
+            }
+            return write_unsigned(out, static_cast<unsigned long long>(value));
+        }
+        
+    private:
+        static bool is_negative(T value, std::true_type) { return value < 0; }
+        static bool is_negative(T, std::false_type) { return false; }
+    };
+    
+    // 字符按字符输出，和operator<<相同
+    template<typename T>
+    struct ArgFormatter<T, typename std::enable_if<is_character<T>::value>::type> {
+        static constexpr bool supported = true;
+        static std::size_t max_size(T) { return 1; }
+        static char* write(char* out, T value) {
+            *out = static_cast<char>(value);
+            return out + 1;
+        }
+    };
+    
+    // 浮点数：%g与ostream默认的6位有效数字输出相同
+    template<typename T>
+    struct ArgFormatter<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+        static constexpr bool supported = true;
+        static constexpr std::size_t kMaxSize = 32;
+        static std::size_t max_size(T) { return kMaxSize; }
+        static char* write(char* out, T value) {
+            // 缓冲区为每个浮点参数预留了kMaxSize + 1字节，snprintf结尾的'\0'随后会被覆盖
+            const int written = std::is_same<T, long double>::value
+                ? std::snprintf(out, kMaxSize + 1, "%Lg", static_cast<long double>(value))
+                : std::snprintf(out, kMaxSize + 1, "%g", static_cast<double>(value));
+            return out + (written < 0 ? 0 : std::min<std::size_t>(static_cast<std::size_t>(written), kMaxSize));
+        }
+    };
+    
+    // std::min按引用接收kMaxSize，属于ODR使用，C++11需要类外定义
+    template<typename T>
+    constexpr std::size_t
+        ArgFormatter<T, typename std::enable_if<std::is_floating_point<T>::value>::type>::kMaxSize;
+    
+    template<>
+    struct ArgFormatter<const char*> {
+        static constexpr bool supported = true;
+        static std::size_t max_size(const char* value) { return value ? std::strlen(value) : 6; }
+        static char* write(char* out, const char* value) {
+            if (!value) value = "(null)";
+            const std::size_t size = std::strlen(value);
+            std::memcpy(out, value, size);
+            return out + size;
+        }
+    };
+    
+    template<>
+    struct ArgFormatter<char*> : ArgFormatter<const char*> {};
+    
+    template<>
+    struct ArgFormatter<std::string> {
+        static constexpr bool supported = true;
+        static std::size_t max_size(const std::string& value) { return value.size(); }
+        static char* write(char* out, const std::string& value) {
+            std::memcpy(out, value.data(), value.size());
+            return out + value.size();
+        }
+    };
+    
+    // 数组（字符串字面量）按退化后的指针处理
+    template<typename T>
+    using FormatterFor = ArgFormatter<typename std::decay<T>::type>;
+    
+    template<typename... Args>
+    struct AllFormattable : std::true_type {};
+    
+    template<typename First, typename... Rest>
+    struct AllFormattable<First, Rest...>
+        : std::integral_constant<bool, FormatterFor<First>::supported && AllFormattable<Rest...>::value> {};
+    
+    // 浮点参数需要多留1字节给snprintf的结尾'\0'
+    template<typename T>
+    std::size_t arg_bound(const T& value) {
+        return FormatterFor<T>::max_size(value) + (std::is_floating_point<typename std::decay<T>::type>::value ? 1 : 0);
+    }
+    
+    inline std::size_t sum_bounds() { return 0; }
+    
+    template<typename First, typename... Rest>
+    std::size_t sum_bounds(const First& first, const Rest&... rest) {
+        return arg_bound(first) + sum_bounds(rest...);
+    }
+    
+    // 按片段顺序展开成直线代码：字面量是定长memcpy，占位符直接调用对应类型的格式化器
+    template<typename List>
+    struct Emitter;
+    
+    template<>
+    struct Emitter<SegmentList<>> {
+        static char* write(char* out) { return out; }
+    };
+    
+    template<char... Chars, typename... Segments>
+    struct Emitter<SegmentList<Literal<Chars...>, Segments...>> {
+        template<typename... Args>
+        static char* write(char* out, const Args&... args) {
+            std::memcpy(out, Literal<Chars...>::data, sizeof...(Chars));
+            return Emitter<SegmentList<Segments...>>::write(out + sizeof...(Chars), args...);
+        }
+    };
+    
+    template<typename... Segments>
+    struct Emitter<SegmentList<Placeholder, Segments...>> {
+        template<typename T, typename... Args>
+        static char* write(char* out, const T& value, const Args&... args) {
+            return Emitter<SegmentList<Segments...>>::write(FormatterFor<T>::write(out, value), args...);
+        }
+    };
+    
+    template<char... Chars>
+    struct CompiledFormat {
+        using segments = typename ParseFormat<Literal<>, SegmentList<>, Chars...>::type;
+        static constexpr std::size_t placeholders = SegmentStats<segments>::placeholders;
+        static constexpr std::size_t literal_size = SegmentStats<segments>::literal_size;
+    };
+    
+    template<char... Chars, typename... Args>
+    void check_arguments(FormatString<Chars...>, const Args&...) {
+        static_assert(CompiledFormat<Chars...>::placeholders == sizeof...(Args), "格式串中占位符%的个数与参数个数不一致");
+        static_assert(AllFormattable<Args...>::value, "存在不支持格式化的参数类型");
+    }
+}
+
+// 输出长度上界：字面量长度在编译期已知，只有参数部分在运行时计算
+template<char... Chars, typename... Args>
+std::size_t formatted_size_bound(FormatString<Chars...> format, const Args&... args) {
+    format_detail::check_arguments(format, args...);
+    return format_detail::CompiledFormat<Chars...>::literal_size + format_detail::sum_bounds(args...);
+}
+
+// 写入out（容量至少为formatted_size_bound），返回结束位置
+template<char... Chars, typename... Args>
+char* format_to(char* out, FormatString<Chars...> format, const Args&... args) {
+    format_detail::check_arguments(format, args...);
+    return format_detail::Emitter<typename format_detail::CompiledFormat<Chars...>::segments>::write(out, args...);
+}
+
+// 在栈缓冲区（放不下时换成堆缓冲区）里格式化，然后交给sink一次写出
+template<std::size_t StackSize = 256, typename Sink, char... Chars, typename... Args>
+void format_with_buffer(Sink&& sink, FormatString<Chars...> format, const Args&... args) {
+    const std::size_t bound = formatted_size_bound(format, args...);
+    char stack_buffer[StackSize];
+    std::unique_ptr<char[]> heap_buffer;
+    char* buffer = stack_buffer;
+    if (bound > StackSize) {
+        heap_buffer.reset(new char[bound]);
+        buffer = heap_buffer.get();
+    }
+    char* end = format_to(buffer, format, args...);
+    sink(buffer, static_cast<std::size_t>(end - buffer));
+}
+
+template<char... Chars, typename... Args>
+std::string format_string(FormatString<Chars...> format, const Args&... args) {
+    std::string result;
+    format_with_buffer([&result](const char* data, std::size_t size) { result.assign(data, size); }, format, args...);
+    return result;
+}
+
+// 编译期格式串版本：safe_printf(FMT("...%..."), args...)，参数个数不对直接编译失败
+template<char... Chars, typename... Args>
+void safe_printf(FormatString<Chars...> format, const Args&... args) {
+    format_with_buffer([](const char* data, std::size_t size) { std::cout.write(data, static_cast<std::streamsize>(size)); },
+                       format, args...);
+}
+
+// 类型安全的日志系统：级别前缀、消息和换行在同一块缓冲区里拼好，只写一次
 enum class LogLevel { DEBUG, INFO, WARNING, ERROR };
 
-template<typename... Args>
-void log(LogLevel level, const char* format, Args... args) {
-    const char* level_str[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
-    std::cout << "[" << level_str[static_cast<int>(level)] << "] ";
-    safe_printf(format, args...);
-    std::cout << std::endl;
+template<char... Chars, typename... Args>
+void log(LogLevel level, FormatString<Chars...> format, const Args&... args) {
+    static const char* const level_str[] = {"[DEBUG] ", "[INFO] ", "[WARNING] ", "[ERROR] "};
+    const char* prefix = level_str[static_cast<int>(level)];
+    const std::size_t prefix_size = std::strlen(prefix);
+    const std::size_t bound = prefix_size + formatted_size_bound(format, args...) + 1;
+    
+    char stack_buffer[256];
+    std::unique_ptr<char[]> heap_buffer;
+    char* buffer = stack_buffer;
+    if (bound > sizeof(stack_buffer)) {
+        heap_buffer.reset(new char[bound]);
+        buffer = heap_buffer.get();
+    }
+    std::memcpy(buffer, prefix, prefix_size);
+    char* end = format_to(buffer + prefix_size, format, args...);
+    *end++ = '\n';
+    // 不再逐行std::endl刷新：需要立即落盘的场景（如崩溃前）应显式flush
+    std::cout.write(buffer, static_cast<std::streamsize>(end - buffer));
 }
 
 void demonstrate_practical_applications() {
@@ -461,9 +829,85 @@ void demonstrate_practical_applications() {
     
     // 日志系统
     std::cout << "\n日志系统演示:\n";
-    log(LogLevel::INFO, "程序启动，版本 %", "1.0.0");
-    log(LogLevel::WARNING, "内存使用率: %%", 85);
-    log(LogLevel::ERROR, "连接失败，错误代码: %", 404);
+    log(LogLevel::INFO, FMT("程序启动，版本 %"), "1.0.0");
+    log(LogLevel::WARNING, FMT("内存使用率(%%): %"), 85);
+    log(LogLevel::ERROR, FMT("连接失败，错误代码: %"), 404);
+    
+    std::cout << "\n";
+}
+
+// 只计数不保存的streambuf，用来测量格式化本身而不是终端输出
+class CountingStreambuf : public std::streambuf {
+    std::size_t count_ = 0;
+    
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) ++count_;
+        return ch;
+    }
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        count_ += static_cast<std::size_t>(n);
+        return n;
+    }
+    
+public:
+    std::size_t count() const { return count_; }
+};
+
+template<typename Func>
+double best_ns_per_call(int iterations, Func&& func) {
+    double best = 1e300;
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) func(i);
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed / iterations);
+    }
+    return best;
+}
+
+void demonstrate_compile_time_format() {
+    std::cout << "=== 编译期解析的格式串 ===\n";
+    
+    safe_printf(FMT("Hello %, my age is % and my score is %\n"), "World", 25, 98.5);
+    safe_printf(FMT("整数边界: % % %, 字符 %, 字符串 %\n"), std::numeric_limits<long long>::min(),
+                std::numeric_limits<unsigned long long>::max(), -7, 'x', std::string("std::string"));
+    
+    // 片段列表在编译期就确定了
+    typedef format_detail::CompiledFormat<'i', 'd', '=', '%', ',', ' ', '%', '%', 'o', 'k'> Parsed;
+    std::cout << "\"id=%, %%ok\" 解析结果: 占位符 " << Parsed::placeholders << " 个, 字面量 " << Parsed::literal_size
+              << " 字节 -> \"" << format_string(FMT("id=%, %%ok"), 42) << "\"\n";
+    // safe_printf(FMT("% %"), 1);  // 编译错误：格式串中占位符%的个数与参数个数不一致
+    // safe_printf(FMT("%"), std::vector<int>{});  // 编译错误：存在不支持格式化的参数类型
+    
+    // 对比：运行时逐字符扫描并逐段写std::cout vs 编译期片段+一次写出，输出都导向计数streambuf
+    CountingStreambuf counter;
+    std::streambuf* original = std::cout.rdbuf(&counter);
+    const int iterations = 200000;
+    const double runtime_ns = best_ns_per_call(iterations, [](int i) {
+        safe_printf("请求 % 耗时 % us, 状态 %, 路径 %\n", i, i * 0.25, 200, "/api/v1/items");
+    });
+    const double compiled_ns = best_ns_per_call(iterations, [](int i) {
+        safe_printf(FMT("请求 % 耗时 % us, 状态 %, 路径 %\n"), i, i * 0.25, 200, "/api/v1/items");
+    });
+    const double log_ns = best_ns_per_call(iterations, [](int i) {
+        log(LogLevel::INFO, FMT("请求 % 耗时 % us, 状态 %, 路径 %"), i, i * 0.25, 200, "/api/v1/items");
+    });
+    std::cout.rdbuf(original);
+    
+    char buffer[128];
+    volatile char sink = 0;
+    const double format_only_ns = best_ns_per_call(iterations, [&](int i) {
+        char* end = format_to(buffer, FMT("请求 % 耗时 % us, 状态 %, 路径 %\n"), i, i * 0.25, 200, "/api/v1/items");
+        sink = end[-1];
+    });
+    (void)sink;
+    
+    std::cout << "每次格式化(共写出 " << counter.count() << " 字节):\n";
+    std::cout << "  运行时扫描格式串: " << runtime_ns << " ns\n";
+    std::cout << "  编译期格式串:     " << compiled_ns << " ns (" << runtime_ns / compiled_ns << "x)\n";
+    std::cout << "  log一次写出:      " << log_ns << " ns\n";
+    std::cout << "  仅format_to:      " << format_only_ns << " ns\n";
     
     std::cout << "\n";
 }
@@ -532,6 +976,7 @@ int main() {
     
     // 实际应用
     demonstrate_practical_applications();
+    demonstrate_compile_time_format();
     
     // 性能和最佳实践
     demonstrate_performance_and_best_practices();
@@ -555,4 +1000,5 @@ g++ -std=c++11 -O2 -Wall 04_variadic_templates.cpp -o variadic_templates
 5. 掌握编译期算法的设计和实现
 6. 学会在实际项目中合理应用变长模板
 7. 理解性能影响和编译时间权衡
+8. 格式串作为字符参数包时可以在编译期拆成片段并检查参数，运行时只剩定长拷贝和数值转换
 */
\ No newline at end of file
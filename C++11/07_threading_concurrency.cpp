@@ -21,6 +21,17 @@
 #include <random>
 #include <memory>
 #include <functional>
+#include <deque>
+#include <cstdint>
+#include <stdexcept>
+#include <stack>
+#include <string>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
 
 // ===== 1. std::thread基础和RAII设计 =====
 
@@ -161,7 +172,8 @@ public:
         Node* new_node = new Node(data);
         new_node->next = head_.load();
         
-        // 使用compare_exchange_weak防止ABA问题
+        // 注意：compare_exchange_weak只保证原子性，并不能防止ABA问题
+        // 带标签头指针和安全回收的版本见第9节ConcurrentStack
         while (!head_.compare_exchange_weak(new_node->next, new_node)) {
             // 如果失败，new_node->next已被更新为当前head值
             // 继续尝试
@@ -177,6 +189,7 @@ public:
         
         if (old_head) {
             result = old_head->data;
+            // 其他线程可能仍在读取old_head->next，这里直接delete存在释放后使用风险
             delete old_head;
             return true;
         }
@@ -430,10 +443,13 @@ private:
     std::condition_variable not_empty_;
     std::condition_variable not_full_;
     const size_t max_size_;
+    const bool verbose_;
     bool finished_ = false;
     
 public:
-    explicit ProducerConsumerQueue(size_t max_size) : max_size_(max_size) {}
+    // verbose为false时关闭逐条日志，便于做性能对比
+    explicit ProducerConsumerQueue(size_t max_size, bool verbose = true)
+        : max_size_(max_size), verbose_(verbose) {}
     
     void produce(int item) {
         std::unique_lock<std::mutex> lock(mtx_);
@@ -443,7 +459,7 @@ public:
         
         if (!finished_) {
             queue_.push(item);
-            std::cout << "生产: " << item << " (队列大小: " << queue_.size() << ")" << std::endl;
+            if (verbose_) std::cout << "生产: " << item << " (队列大小: " << queue_.size() << ")" << std::endl;
         }
         
         not_empty_.notify_one();  // 通知消费者
@@ -458,7 +474,7 @@ public:
         if (!queue_.empty()) {
             item = queue_.front();
             queue_.pop();
-            std::cout << "消费: " << item << " (队列大小: " << queue_.size() << ")" << std::endl;
+            if (verbose_) std::cout << "消费: " << item << " (队列大小: " << queue_.size() << ")" << std::endl;
             not_full_.notify_one();  // 通知生产者
             return true;
         }
@@ -837,6 +853,1634 @@ void demonstrate_best_practices() {
     std::cout << "\n";
 }
 
+// ===== 8. 工作窃取线程池 =====
+
+// C++11的new只保证alignof(std::max_align_t)对齐（对齐new是C++17才有的），
+// 含alignas(64)成员的对象放在堆上时要自己申请对齐内存，否则缓存行隔离并不成立
+inline void* aligned_allocate(std::size_t alignment, std::size_t size) {
+    void* p = nullptr;
+#if defined(_WIN32)
+    p = _aligned_malloc(size, alignment);
+#else
+    // posix_memalign要求对齐至少为sizeof(void*)
+    if (posix_memalign(&p, std::max(alignment, sizeof(void*)), size) != 0) {
+        p = nullptr;
+    }
+#endif
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+inline void aligned_deallocate(void* p) {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+// 与aligned_allocate配对的删除器：先析构再归还内存，不能交给delete
+template<typename T>
+struct AlignedDeleter {
+    void operator()(T* p) const {
+        p->~T();
+        aligned_deallocate(p);
+    }
+};
+
+template<typename T>
+using AlignedPtr = std::unique_ptr<T, AlignedDeleter<T>>;
+
+template<typename T, typename... Args>
+AlignedPtr<T> make_aligned(Args&&... args) {
+    void* mem = aligned_allocate(alignof(T), sizeof(T));
+    try {
+        return AlignedPtr<T>(new (mem) T(std::forward<Args>(args)...));
+    } catch (...) {
+        aligned_deallocate(mem);
+        throw;
+    }
+}
+
+// 数组版本：删除器记住元素个数，逐个析构后归还整块内存
+template<typename T>
+struct AlignedArrayDeleter {
+    std::size_t count;
+    void operator()(T* p) const {
+        for (std::size_t i = count; i > 0; --i) {
+            p[i - 1].~T();
+        }
+        aligned_deallocate(p);
+    }
+};
+
+template<typename T>
+using AlignedArray = std::unique_ptr<T[], AlignedArrayDeleter<T>>;
+
+// 元素值初始化；构造中途抛异常时析构已构造的部分
+template<typename T>
+AlignedArray<T> make_aligned_array(std::size_t n) {
+    T* p = static_cast<T*>(aligned_allocate(alignof(T), sizeof(T) * (n ? n : 1)));
+    std::size_t built = 0;
+    try {
+        for (; built < n; ++built) {
+            new (p + built) T();
+        }
+    } catch (...) {
+        AlignedArrayDeleter<T>{built}(p);
+        throw;
+    }
+    return AlignedArray<T>(p, AlignedArrayDeleter<T>{n});
+}
+
+// Chase-Lev工作窃取双端队列
+// 所有者线程在bottom端push/take（LIFO，缓存热），窃取者在top端steal（FIFO）
+// 只有bottom==top附近的最后一个元素需要CAS仲裁，其余路径都是普通的load/store
+template<typename T>
+class ChaseLevDeque {
+private:
+    struct Array {
+        std::int64_t capacity;
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+
+        explicit Array(std::int64_t cap)
+            : capacity(cap), mask(cap - 1), slots(new std::atomic<T*>[cap]) {}
+
+        T* get(std::int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, T* x) { slots[i & mask].store(x, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<Array*> array_;
+    // 扩容后的旧数组可能仍被窃取者读取，延迟到析构时统一释放
+    std::vector<std::unique_ptr<Array>> retired_;
+
+    Array* grow(Array* old, std::int64_t b, std::int64_t t) {
+        Array* bigger = new Array(old->capacity * 2);
+        for (std::int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        retired_.emplace_back(old);
+        array_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+public:
+    explicit ChaseLevDeque(std::int64_t initial_capacity = 256)
+        : array_(new Array(initial_capacity)) {}
+
+    ~ChaseLevDeque() {
+        delete array_.load(std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // 仅所有者线程调用
+    void push(T* x) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, b, t);
+        }
+        a->put(b, x);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // 仅所有者线程调用，空时返回nullptr
+    T* take() {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* x = a->get(b);
+        if (t == b) {
+            // 最后一个元素：与窃取者竞争
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                x = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    // 任意线程调用，失败（空或竞争失败）时返回nullptr
+    T* steal() {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return nullptr;
+        }
+
+        Array* a = array_.load(std::memory_order_acquire);
+        T* x = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return x;
+    }
+
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+};
+
+// 工作窃取线程池
+// 1. 每个worker拥有一个Chase-Lev双端队列
+// 2. 在worker线程内提交的任务直接压入自己的队列（无锁快速路径）
+// 3. 外部线程提交的任务进入共享收件箱，worker一次批量搬运多个以摊薄锁开销
+// 4. 本地队列为空时随机选择受害者进行窃取
+class WorkStealingThreadPool {
+private:
+    using Task = std::function<void()>;
+
+    struct Worker {
+        ChaseLevDeque<Task> deque;
+        std::uint64_t rng_state;
+        explicit Worker(std::uint64_t seed) : rng_state(seed | 1) {}
+    };
+
+    static constexpr std::size_t kInboxBatch = 32;
+    static constexpr int kSpinRounds = 64;
+
+    // Worker内的双端队列带alignas(64)成员，必须走对齐分配
+    std::vector<AlignedPtr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex inbox_mtx_;
+    std::deque<Task*> inbox_;
+
+    std::mutex sleep_mtx_;
+    std::condition_variable sleep_cv_;
+    std::atomic<int> sleepers_{0};
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<bool> stop_{false};
+
+    static thread_local WorkStealingThreadPool* tls_pool_;
+    static thread_local std::size_t tls_index_;
+
+    static std::uint64_t next_random(std::uint64_t& state) {
+        // xorshift64：窃取目标选择不需要高质量随机数，只需要足够便宜
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    void submit(Task* task) {
+        // 先增加计数再发布任务，保证pending_不会被窃取者减到下溢
+        pending_.fetch_add(1);
+
+        if (tls_pool_ == this) {
+            workers_[tls_index_]->deque.push(task);
+        } else {
+            std::lock_guard<std::mutex> lock(inbox_mtx_);
+            inbox_.push_back(task);
+        }
+
+        if (sleepers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mtx_);
+            sleep_cv_.notify_one();
+        }
+    }
+
+    Task* take_from_inbox(Worker& self) {
+        std::lock_guard<std::mutex> lock(inbox_mtx_);
+        if (inbox_.empty()) {
+            return nullptr;
+        }
+        Task* first = inbox_.front();
+        inbox_.pop_front();
+        // 多搬运一批到本地队列，其他worker可以从这里窃取
+        for (std::size_t i = 1; i < kInboxBatch && !inbox_.empty(); ++i) {
+            self.deque.push(inbox_.front());
+            inbox_.pop_front();
+        }
+        return first;
+    }
+
+    Task* try_steal(std::size_t self_index) {
+        const std::size_t n = workers_.size();
+        if (n <= 1) {
+            return nullptr;
+        }
+        std::size_t start = static_cast<std::size_t>(
+            next_random(workers_[self_index]->rng_state) % n);
+        for (std::size_t k = 0; k < n; ++k) {
+            std::size_t victim = (start + k) % n;
+            if (victim == self_index) {
+                continue;
+            }
+            if (Task* task = workers_[victim]->deque.steal()) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    Task* find_task(std::size_t index) {
+        Worker& self = *workers_[index];
+        if (Task* task = self.deque.take()) {
+            return task;
+        }
+        if (Task* task = take_from_inbox(self)) {
+            return task;
+        }
+        return try_steal(index);
+    }
+
+    void worker_loop(std::size_t index) {
+        tls_pool_ = this;
+        tls_index_ = index;
+
+        int idle_rounds = 0;
+        while (true) {
+            if (Task* task = find_task(index)) {
+                pending_.fetch_sub(1);
+                idle_rounds = 0;
+                (*task)();
+                delete task;
+                continue;
+            }
+
+            if (stop_.load() && pending_.load() == 0) {
+                break;
+            }
+
+            // 先短暂自旋，避免小任务突发时频繁进出内核
+            if (++idle_rounds < kSpinRounds) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mtx_);
+            sleepers_.fetch_add(1);
+            sleep_cv_.wait(lock, [this] { return stop_.load() || pending_.load() > 0; });
+            sleepers_.fetch_sub(1);
+            idle_rounds = 0;
+        }
+
+        tls_pool_ = nullptr;
+    }
+
+public:
+    explicit WorkStealingThreadPool(std::size_t num_threads) {
+        if (num_threads == 0) {
+            num_threads = 1;
+        }
+        for (std::size_t i = 0; i < num_threads; ++i) {
+            workers_.push_back(make_aligned<Worker>(0x9E3779B97F4A7C15ULL * (i + 1)));
+        }
+        for (std::size_t i = 0; i < num_threads; ++i) {
+            threads_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~WorkStealingThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mtx_);
+            stop_.store(true);
+        }
+        sleep_cv_.notify_all();
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    // 与常见线程池保持相同的enqueue -> std::future接口
+    template<typename F>
+    auto enqueue(F&& f) -> std::future<decltype(std::declval<typename std::decay<F>::type&>()())> {
+        using R = decltype(std::declval<typename std::decay<F>::type&>()());
+        // 析构排空期间，正在执行的任务仍可继续派生子任务
+        if (stop_.load() && tls_pool_ != this) {
+            throw std::runtime_error("线程池已停止");
+        }
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> result = packaged->get_future();
+        submit(new Task([packaged] { (*packaged)(); }));
+        return result;
+    }
+
+    std::size_t size() const { return workers_.size(); }
+};
+
+thread_local WorkStealingThreadPool* WorkStealingThreadPool::tls_pool_ = nullptr;
+thread_local std::size_t WorkStealingThreadPool::tls_index_ = 0;
+
+template<typename Pool>
+long long benchmark_flat_submission(std::size_t threads, int num_tasks) {
+    std::atomic<int> done{0};
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        Pool pool(threads);
+        for (int i = 0; i < num_tasks; ++i) {
+            pool.enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        while (done.load(std::memory_order_relaxed) < num_tasks) {
+            std::this_thread::yield();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    if (done.load() != num_tasks) {
+        std::cout << "  [错误] 任务数不符: " << done.load() << std::endl;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// 嵌套提交：根任务在worker线程内继续派生子任务，走工作窃取池的本地快速路径
+template<typename Pool>
+long long benchmark_nested_submission(std::size_t threads, int roots, int children) {
+    std::atomic<int> done{0};
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        Pool pool(threads);
+        Pool* p = &pool;
+        for (int r = 0; r < roots; ++r) {
+            pool.enqueue([p, &done, children] {
+                for (int c = 0; c < children; ++c) {
+                    p->enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+                }
+            });
+        }
+        // SimpleThreadPool停止后拒绝新任务，因此必须在析构前等待子任务全部完成
+        while (done.load(std::memory_order_relaxed) < roots * children) {
+            std::this_thread::yield();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    if (done.load() != roots * children) {
+        std::cout << "  [错误] 任务数不符: " << done.load() << std::endl;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+void demonstrate_work_stealing_pool() {
+    std::cout << "=== 工作窃取线程池演示 ===\n";
+
+    // 1. 基本用法：enqueue返回future
+    {
+        WorkStealingThreadPool pool(4);
+        std::vector<std::future<long>> results;
+        for (int i = 20; i < 28; ++i) {
+            results.push_back(pool.enqueue([i] { return fibonacci_slow(i); }));
+        }
+        std::cout << "fibonacci(20..27): ";
+        for (auto& f : results) {
+            std::cout << f.get() << " ";
+        }
+        std::cout << std::endl;
+
+        // 在任务内部递归提交：子任务进入当前worker的本地队列
+        auto nested = pool.enqueue([&pool] {
+            auto inner = pool.enqueue([] { return 21; });
+            return inner.get() * 2;  // 仅作演示：真实代码应避免在worker内阻塞等待
+        });
+        std::cout << "嵌套提交结果: " << nested.get() << std::endl;
+    }
+
+    // 2. 与单一锁队列的SimpleThreadPool对比
+    const int flat_tasks = 200000;
+    const int roots = 64;
+    const int children = 3000;
+    const std::size_t thread_counts[] = {1, 4, 16, 64};
+
+    std::cout << "\n性能对比 (外部提交" << flat_tasks << "个微任务 / 嵌套提交"
+              << roots * children << "个微任务, 单位μs):\n";
+    std::cout << "线程数\tSimple(外部)\tStealing(外部)\tSimple(嵌套)\tStealing(嵌套)\n";
+    for (std::size_t threads : thread_counts) {
+        long long simple_flat = benchmark_flat_submission<SimpleThreadPool>(threads, flat_tasks);
+        long long steal_flat = benchmark_flat_submission<WorkStealingThreadPool>(threads, flat_tasks);
+        long long simple_nested = benchmark_nested_submission<SimpleThreadPool>(threads, roots, children);
+        long long steal_nested = benchmark_nested_submission<WorkStealingThreadPool>(threads, roots, children);
+        std::cout << threads << "\t" << simple_flat << "\t\t" << steal_flat
+                  << "\t\t" << simple_nested << "\t\t" << steal_nested << std::endl;
+    }
+
+    std::cout << "\n要点:\n";
+    std::cout << "- 单锁队列下所有worker争抢同一个mutex，核数越多越严重\n";
+    std::cout << "- 本地LIFO执行保持缓存热度，窃取从FIFO端取走最老（通常最大）的任务\n";
+    std::cout << "- 外部提交仍需同步，批量搬运把锁开销摊薄到每kInboxBatch个任务一次\n";
+
+    std::cout << "\n";
+}
+
+// ===== 9. ABA安全的无锁栈与可插拔内存回收 =====
+
+// 指针打包：x86-64/AArch64用户态地址只使用低48位，高16位存放版本标签
+// 每次成功CAS都递增标签，使"A被弹出又被压回"的头指针不再与旧值相等
+namespace tagged {
+    static_assert(sizeof(void*) == 8, "指针打包要求64位平台");
+
+    constexpr int kTagShift = 48;
+    constexpr std::uint64_t kPtrMask = (std::uint64_t(1) << kTagShift) - 1;
+
+    inline std::uint64_t pack(void* p, std::uint16_t tag) {
+        return (reinterpret_cast<std::uintptr_t>(p) & kPtrMask) |
+               (static_cast<std::uint64_t>(tag) << kTagShift);
+    }
+
+    template<typename T>
+    inline T* ptr(std::uint64_t v) {
+        return reinterpret_cast<T*>(static_cast<std::uintptr_t>(v & kPtrMask));
+    }
+
+    inline std::uint16_t tag(std::uint64_t v) {
+        return static_cast<std::uint16_t>(v >> kTagShift);
+    }
+}
+
+// 节点池：按块批量分配，空闲节点挂在带标签的无锁空闲链表上
+// 节点内存在池销毁前永不归还系统（类型稳定），因此读取已被他人取走节点的next是安全的
+template<typename Node>
+class NodePool {
+private:
+    static constexpr std::size_t kChunkSize = 256;
+
+    std::atomic<std::uint64_t> free_head_{0};
+    std::mutex chunk_mtx_;
+    std::vector<std::unique_ptr<Node[]>> chunks_;
+    // 所有者持有1个引用，每个尚未回收的退休节点各持有1个引用
+    std::atomic<std::size_t> refs_{1};
+
+    void push_chain(Node* first, Node* last) {
+        std::uint64_t h = free_head_.load(std::memory_order_relaxed);
+        do {
+            last->next.store(tagged::ptr<Node>(h), std::memory_order_relaxed);
+        } while (!free_head_.compare_exchange_weak(
+            h, tagged::pack(first, static_cast<std::uint16_t>(tagged::tag(h) + 1)),
+            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void refill() {
+        std::lock_guard<std::mutex> lock(chunk_mtx_);
+        if (tagged::ptr<Node>(free_head_.load(std::memory_order_acquire)) != nullptr) {
+            return;  // 其他线程已经补充过
+        }
+        std::unique_ptr<Node[]> chunk(new Node[kChunkSize]);
+        for (std::size_t i = 0; i + 1 < kChunkSize; ++i) {
+            chunk[i].next.store(&chunk[i + 1], std::memory_order_relaxed);
+        }
+        push_chain(&chunk[0], &chunk[kChunkSize - 1]);
+        chunks_.push_back(std::move(chunk));
+    }
+
+public:
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    Node* allocate() {
+        while (true) {
+            std::uint64_t h = free_head_.load(std::memory_order_acquire);
+            Node* n = tagged::ptr<Node>(h);
+            if (!n) {
+                refill();  // 冷路径：只在池耗尽时加锁
+                continue;
+            }
+            Node* next = n->next.load(std::memory_order_relaxed);
+            if (free_head_.compare_exchange_weak(
+                    h, tagged::pack(next, static_cast<std::uint16_t>(tagged::tag(h) + 1)),
+                    std::memory_order_acquire, std::memory_order_relaxed)) {
+                return n;
+            }
+        }
+    }
+
+    void recycle(Node* n) {
+        push_chain(n, n);
+    }
+
+    void retain() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+    void release() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    std::size_t capacity() {
+        std::lock_guard<std::mutex> lock(chunk_mtx_);
+        return chunks_.size() * kChunkSize;
+    }
+};
+
+// 回收策略接口：
+//   Guard         - 作用域内保护从原子头读取到的节点不被复用
+//   protect(src)  - 读取打包头并确保其指向的节点受保护
+//   retire(p,...) - 节点摘除后登记，待无人引用时调用回调真正回收
+//   protects_reads - 为true时受保护节点的负载可以安全读取（支持peek）
+namespace reclaim {
+
+using ReclaimFn = void (*)(void* node, void* ctx);
+
+struct Retired {
+    void* node;
+    ReclaimFn fn;
+    void* ctx;
+    std::uint64_t epoch;
+};
+
+constexpr std::size_t kMaxThreads = 128;
+constexpr std::size_t kScanThreshold = 64;
+
+// 策略1：立即复用，只依赖带标签头指针防ABA（最快，但不能安全peek）
+struct Immediate {
+    static constexpr bool protects_reads = false;
+
+    class Guard {
+    public:
+        std::uint64_t protect(const std::atomic<std::uint64_t>& src) const {
+            return src.load(std::memory_order_acquire);
+        }
+    };
+
+    static void retire(void* node, ReclaimFn fn, void* ctx) {
+        fn(node, ctx);
+    }
+};
+
+// 线程退出时仍未能回收的节点交给全局孤儿链表，由后续扫描接管
+inline std::mutex& orphan_mutex() {
+    static std::mutex m;
+    return m;
+}
+
+inline std::vector<Retired>& orphans() {
+    static std::vector<Retired> list;
+    return list;
+}
+
+inline void adopt_orphans(std::vector<Retired>& into) {
+    std::lock_guard<std::mutex> lock(orphan_mutex());
+    into.insert(into.end(), orphans().begin(), orphans().end());
+    orphans().clear();
+}
+
+inline void hand_over_orphans(std::vector<Retired>& from) {
+    if (from.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(orphan_mutex());
+    orphans().insert(orphans().end(), from.begin(), from.end());
+    from.clear();
+}
+
+// 策略2：危险指针（每线程一个槽位），扫描时跳过仍被任何线程声明的节点
+class HazardPointers {
+private:
+    struct alignas(64) Record {
+        std::atomic<void*> hazard{nullptr};
+        std::atomic<bool> in_use{false};
+    };
+
+    static Record* records() {
+        static Record table[kMaxThreads];
+        return table;
+    }
+
+    static void scan(std::vector<Retired>& list) {
+        adopt_orphans(list);
+
+        std::vector<void*> hazards;
+        hazards.reserve(kMaxThreads);
+        Record* table = records();
+        for (std::size_t i = 0; i < kMaxThreads; ++i) {
+            if (void* h = table[i].hazard.load(std::memory_order_seq_cst)) {
+                hazards.push_back(h);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        std::vector<Retired> keep;
+        for (const Retired& r : list) {
+            if (std::binary_search(hazards.begin(), hazards.end(), r.node)) {
+                keep.push_back(r);
+            } else {
+                r.fn(r.node, r.ctx);
+            }
+        }
+        list.swap(keep);
+    }
+
+    struct Local {
+        Record* rec = nullptr;
+        std::vector<Retired> retired;
+
+        Local() {
+            Record* table = records();
+            for (std::size_t i = 0; i < kMaxThreads; ++i) {
+                bool expected = false;
+                if (table[i].in_use.compare_exchange_strong(expected, true)) {
+                    rec = &table[i];
+                    return;
+                }
+            }
+            throw std::runtime_error("危险指针槽位耗尽");
+        }
+
+        ~Local() {
+            scan(retired);
+            hand_over_orphans(retired);
+            rec->hazard.store(nullptr);
+            rec->in_use.store(false);
+        }
+    };
+
+    static Local& local() {
+        static thread_local Local l;
+        return l;
+    }
+
+public:
+    static constexpr bool protects_reads = true;
+
+    // 每线程只有一个危险指针槽位，Guard不可嵌套
+    class Guard {
+    private:
+        Record* rec_;
+
+    public:
+        Guard() : rec_(local().rec) {}
+        ~Guard() { rec_->hazard.store(nullptr, std::memory_order_release); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        std::uint64_t protect(const std::atomic<std::uint64_t>& src) {
+            std::uint64_t v = src.load(std::memory_order_relaxed);
+            while (true) {
+                rec_->hazard.store(tagged::ptr<void>(v), std::memory_order_seq_cst);
+                // 声明之后再确认一次：头未变则节点在声明生效前未被摘除
+                std::uint64_t again = src.load(std::memory_order_seq_cst);
+                if (again == v) {
+                    return v;
+                }
+                v = again;
+            }
+        }
+    };
+
+    static void retire(void* node, ReclaimFn fn, void* ctx) {
+        Local& l = local();
+        l.retired.push_back(Retired{node, fn, ctx, 0});
+        if (l.retired.size() >= kScanThreshold) {
+            scan(l.retired);
+        }
+    }
+};
+
+// 策略3：基于纪元的回收(EBR)，读者进入临界区只需一次store，回收按纪元批量进行
+class EpochReclamation {
+private:
+    // state = (epoch << 1) | active
+    struct alignas(64) Record {
+        std::atomic<std::uint64_t> state{0};
+        std::atomic<bool> in_use{false};
+    };
+
+    static std::atomic<std::uint64_t>& global_epoch() {
+        static std::atomic<std::uint64_t> epoch{2};
+        return epoch;
+    }
+
+    static Record* records() {
+        static Record table[kMaxThreads];
+        return table;
+    }
+
+    static bool try_advance(std::uint64_t current) {
+        Record* table = records();
+        for (std::size_t i = 0; i < kMaxThreads; ++i) {
+            if (!table[i].in_use.load(std::memory_order_acquire)) {
+                continue;
+            }
+            std::uint64_t s = table[i].state.load(std::memory_order_seq_cst);
+            if ((s & 1) && (s >> 1) != current) {
+                return false;  // 仍有线程停留在旧纪元
+            }
+        }
+        return global_epoch().compare_exchange_strong(current, current + 1);
+    }
+
+    static void collect(std::vector<Retired>& list) {
+        adopt_orphans(list);
+        std::uint64_t e = global_epoch().load();
+        if (try_advance(e)) {
+            ++e;
+        }
+        // 退休于e-2及更早纪元的节点不可能再被任何活跃读者看到
+        std::vector<Retired> keep;
+        for (const Retired& r : list) {
+            if (r.epoch + 2 <= e) {
+                r.fn(r.node, r.ctx);
+            } else {
+                keep.push_back(r);
+            }
+        }
+        list.swap(keep);
+    }
+
+    struct Local {
+        Record* rec = nullptr;
+        int depth = 0;
+        std::size_t next_collect = kScanThreshold;
+        std::vector<Retired> retired;
+
+        Local() {
+            Record* table = records();
+            for (std::size_t i = 0; i < kMaxThreads; ++i) {
+                bool expected = false;
+                if (table[i].in_use.compare_exchange_strong(expected, true)) {
+                    rec = &table[i];
+                    return;
+                }
+            }
+            throw std::runtime_error("纪元记录槽位耗尽");
+        }
+
+        ~Local() {
+            collect(retired);
+            hand_over_orphans(retired);
+            rec->state.store(0);
+            rec->in_use.store(false);
+        }
+    };
+
+    static Local& local() {
+        static thread_local Local l;
+        return l;
+    }
+
+public:
+    static constexpr bool protects_reads = true;
+
+    // 支持嵌套：只有最外层Guard真正进入/离开临界区
+    class Guard {
+    private:
+        Local& local_;
+
+    public:
+        Guard() : local_(local()) {
+            if (local_.depth++ == 0) {
+                std::uint64_t e = global_epoch().load(std::memory_order_relaxed);
+                local_.rec->state.store((e << 1) | 1, std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard() {
+            if (--local_.depth == 0) {
+                local_.rec->state.store(0, std::memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        std::uint64_t protect(const std::atomic<std::uint64_t>& src) const {
+            return src.load(std::memory_order_acquire);
+        }
+    };
+
+    static void retire(void* node, ReclaimFn fn, void* ctx) {
+        Local& l = local();
+        l.retired.push_back(Retired{node, fn, ctx, global_epoch().load()});
+        if (l.retired.size() >= l.next_collect) {
+            collect(l.retired);
+            // 纪元推进受阻时列表无法清空，按剩余量放宽阈值，避免反复全量扫描
+            l.next_collect = std::max(kScanThreshold, l.retired.size() * 2);
+        }
+    }
+};
+
+}  // namespace reclaim
+
+// 模板化的生产级无锁栈
+// - 头指针带16位版本标签，杜绝ABA
+// - 节点来自NodePool，热路径不调用new/delete
+// - 回收策略可插拔：Immediate / HazardPointers / EpochReclamation
+template<typename T, typename Reclaimer = reclaim::HazardPointers>
+class ConcurrentStack {
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() { return reinterpret_cast<T*>(storage); }
+    };
+
+    std::atomic<std::uint64_t> head_{0};
+    NodePool<Node>* pool_;
+
+    // 回收回调：负载在真正回收时才析构，保证受保护的peek读者不会读到已析构对象
+    static void reclaim_node(void* p, void* ctx) {
+        Node* node = static_cast<Node*>(p);
+        NodePool<Node>* pool = static_cast<NodePool<Node>*>(ctx);
+        node->value()->~T();
+        pool->recycle(node);
+        pool->release();
+    }
+
+    // 能保护读取的策略下其他线程可能正在peek，只能拷贝；否则可以直接移动
+    static void extract(T& out, T& src, std::true_type) { out = src; }
+    static void extract(T& out, T& src, std::false_type) { out = std::move(src); }
+
+public:
+    ConcurrentStack() : pool_(new NodePool<Node>()) {}
+
+    ~ConcurrentStack() {
+        // 此时假定已无并发访问
+        Node* n = tagged::ptr<Node>(head_.load());
+        while (n) {
+            Node* next = n->next.load(std::memory_order_relaxed);
+            n->value()->~T();
+            pool_->recycle(n);
+            n = next;
+        }
+        pool_->release();  // 仍在退休列表中的节点各自持有池的引用
+    }
+
+    ConcurrentStack(const ConcurrentStack&) = delete;
+    ConcurrentStack& operator=(const ConcurrentStack&) = delete;
+
+    void push(T value) {
+        Node* node = pool_->allocate();
+        new (node->storage) T(std::move(value));
+
+        std::uint64_t h = head_.load(std::memory_order_relaxed);
+        do {
+            node->next.store(tagged::ptr<Node>(h), std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(
+            h, tagged::pack(node, static_cast<std::uint16_t>(tagged::tag(h) + 1)),
+            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    bool try_pop(T& out) {
+        typename Reclaimer::Guard guard;
+        while (true) {
+            std::uint64_t h = guard.protect(head_);
+            Node* n = tagged::ptr<Node>(h);
+            if (!n) {
+                return false;
+            }
+            // n可能已被别的线程弹出甚至复用：节点内存类型稳定，读取安全；标签保证随后的CAS失败
+            Node* next = n->next.load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(
+                    h, tagged::pack(next, static_cast<std::uint16_t>(tagged::tag(h) + 1)),
+                    std::memory_order_acquire, std::memory_order_relaxed)) {
+                extract(out, *n->value(),
+                        std::integral_constant<bool, Reclaimer::protects_reads>());
+                pool_->retain();
+                Reclaimer::retire(n, &ConcurrentStack::reclaim_node, pool_);
+                return true;
+            }
+        }
+    }
+
+    // 只读查看栈顶：需要策略保证节点在Guard作用域内不被回收
+    bool try_peek(T& out) {
+        static_assert(Reclaimer::protects_reads, "try_peek需要危险指针或纪元回收策略");
+        typename Reclaimer::Guard guard;
+        Node* n = tagged::ptr<Node>(guard.protect(head_));
+        if (!n) {
+            return false;
+        }
+        out = *n->value();
+        return true;
+    }
+
+    bool empty() const {
+        return tagged::ptr<Node>(head_.load(std::memory_order_acquire)) == nullptr;
+    }
+
+    std::size_t pool_capacity() const { return pool_->capacity(); }
+};
+
+// 基准对照：std::mutex + std::stack
+template<typename T>
+class MutexStack {
+private:
+    std::mutex mtx_;
+    std::stack<T> stack_;
+
+public:
+    void push(T value) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stack_.push(std::move(value));
+    }
+
+    bool try_pop(T& out) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (stack_.empty()) {
+            return false;
+        }
+        out = std::move(stack_.top());
+        stack_.pop();
+        return true;
+    }
+};
+
+template<typename Stack>
+long long benchmark_stack_contention(int num_threads, int ops_per_thread, long long& checksum) {
+    Stack stack;
+    std::atomic<long long> popped_sum{0};
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&stack, &popped_sum, ops_per_thread, t] {
+            long long local_sum = 0;
+            int value = 0;
+            for (int i = 0; i < ops_per_thread; ++i) {
+                stack.push(t * ops_per_thread + i);
+                if (stack.try_pop(value)) {
+                    local_sum += value;
+                }
+            }
+            popped_sum.fetch_add(local_sum);
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    int value = 0;
+    long long rest = 0;
+    while (stack.try_pop(value)) {
+        rest += value;
+    }
+    checksum = popped_sum.load() + rest;
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+void demonstrate_aba_safe_stack() {
+    std::cout << "=== ABA安全的无锁栈与内存回收演示 ===\n";
+
+    std::cout << "原始LockFreeStack的问题:\n";
+    std::cout << "- compare_exchange只比较指针值，A被弹出、释放、重新分配到同一地址后CAS仍会成功(ABA)\n";
+    std::cout << "- pop读取old_head->next时，另一线程可能已经delete了old_head(释放后使用)\n";
+    std::cout << "- 每次push都调用new，热路径上有分配器竞争\n\n";
+
+    // 1. 非平凡类型的正确性测试
+    {
+        ConcurrentStack<std::string, reclaim::EpochReclamation> stack;
+        const int per_thread = 2000;
+        std::atomic<int> popped{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&stack, &popped, t, per_thread] {
+                std::string s;
+                for (int i = 0; i < per_thread; ++i) {
+                    stack.push("item-" + std::to_string(t) + "-" + std::to_string(i));
+                    if (stack.try_pop(s)) {
+                        popped.fetch_add(1);
+                    }
+                    stack.try_peek(s);
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        std::string s;
+        while (stack.try_pop(s)) {
+            popped.fetch_add(1);
+        }
+        std::cout << "ConcurrentStack<std::string, EBR> 弹出总数: " << popped.load()
+                  << " (预期: " << 4 * per_thread << "), 池容量: " << stack.pool_capacity() << "\n";
+    }
+
+    // 2. 竞争基准
+    const int ops_per_thread = 200000;
+    const int thread_counts[] = {1, 2, 4, 8};
+
+    std::cout << "\n竞争基准 (每线程" << ops_per_thread << "次push+pop, 单位μs):\n";
+    // 原始LockFreeStack在多线程push/pop交错下会发生释放后使用，不参与竞争基准
+    std::cout << "线程数\tmutex+stack\tImmediate\tHazardPtr\tEpoch\n";
+    for (int threads : thread_counts) {
+        long long expected = 0;
+        const long long total = static_cast<long long>(threads) * ops_per_thread;
+        expected = total * (total - 1) / 2;
+
+        long long sums[4];
+        long long t_mutex = benchmark_stack_contention<MutexStack<int>>(threads, ops_per_thread, sums[0]);
+        long long t_imm = benchmark_stack_contention<ConcurrentStack<int, reclaim::Immediate>>(threads, ops_per_thread, sums[1]);
+        long long t_hp = benchmark_stack_contention<ConcurrentStack<int, reclaim::HazardPointers>>(threads, ops_per_thread, sums[2]);
+        long long t_ebr = benchmark_stack_contention<ConcurrentStack<int, reclaim::EpochReclamation>>(threads, ops_per_thread, sums[3]);
+
+        std::cout << threads << "\t" << t_mutex << "\t\t" << t_imm
+                  << "\t\t" << t_hp << "\t\t" << t_ebr;
+        for (long long s : sums) {
+            if (s != expected) {
+                std::cout << "  [校验和不符]";
+                break;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "\n要点:\n";
+    std::cout << "- 16位标签在两次读取之间需要恰好回绕65536次才会误判，实际中可忽略\n";
+    std::cout << "- Immediate依赖类型稳定节点池，不能安全地读取节点负载(peek)\n";
+    std::cout << "- 危险指针回收延迟有界但每次读取需要一次seq_cst store+重读\n";
+    std::cout << "- 纪元回收读者开销最低，但一个长时间停留在临界区的线程会阻止所有回收\n";
+
+    std::cout << "\n";
+}
+
+// ===== 10. 有界无锁MPMC环形队列 =====
+
+// 事件计数器：无等待者时notify只是一次load；有等待者时才真正唤醒
+// C++20下用std::atomic::wait（futex），否则退化为mutex+condition_variable
+class EventCount {
+private:
+    std::atomic<std::uint32_t> epoch_{0};
+    std::atomic<int> waiters_{0};
+#if !defined(__cpp_lib_atomic_wait)
+    std::mutex mtx_;
+    std::condition_variable cv_;
+#endif
+
+public:
+    std::uint32_t prepare_wait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    void cancel_wait() {
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void wait(std::uint32_t key) {
+#if defined(__cpp_lib_atomic_wait)
+        epoch_.wait(key, std::memory_order_seq_cst);
+#else
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this, key] { return epoch_.load() != key; });
+#endif
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify(bool all = false) {
+        // 与prepare_wait中的栅栏配对：要么等待者看到新数据，要么这里看到等待者
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+#if defined(__cpp_lib_atomic_wait)
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (all) {
+            epoch_.notify_all();
+        } else {
+            epoch_.notify_one();
+        }
+#else
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        if (all) {
+            cv_.notify_all();
+        } else {
+            cv_.notify_one();
+        }
+#endif
+    }
+};
+
+// Vyukov有界MPMC队列：每个槽位带序列号，生产者/消费者各自只CAS一个位置计数器
+// seq == pos      -> 槽位空闲，可供位置pos的生产者写入
+// seq == pos + 1  -> 槽位已满，可供位置pos的消费者读取
+template<typename T>
+class MPMCRingBuffer {
+private:
+    static constexpr std::size_t kCacheLine = 64;
+    static constexpr int kSpinBeforePark = 128;
+
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() { return reinterpret_cast<T*>(storage); }
+    };
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // 生产者与消费者计数器各占一条缓存行，避免伪共享
+    alignas(kCacheLine) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(kCacheLine) std::atomic<std::size_t> dequeue_pos_{0};
+    alignas(kCacheLine) std::atomic<bool> closed_{false};
+
+    EventCount not_empty_;
+    EventCount not_full_;
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t cap = 2;
+        while (cap < n) {
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    // 从当前位置起连续认领最多max_count个满足seq == pos + offset的槽位，成功时返回起始位置
+    std::size_t claim(std::atomic<std::size_t>& counter, std::size_t offset,
+                      std::size_t max_count, std::size_t& claimed) {
+        std::size_t pos = counter.load(std::memory_order_relaxed);
+        while (true) {
+            std::size_t n = 0;
+            while (n < max_count) {
+                std::size_t seq = cells_[(pos + n) & mask_].seq.load(std::memory_order_acquire);
+                if (seq != pos + n + offset) {
+                    break;
+                }
+                ++n;
+            }
+
+            if (n == 0) {
+                std::size_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+                std::intptr_t diff = static_cast<std::intptr_t>(seq) -
+                                     static_cast<std::intptr_t>(pos + offset);
+                if (diff < 0) {
+                    claimed = 0;  // 队列满（生产者）或空（消费者）
+                    return pos;
+                }
+                pos = counter.load(std::memory_order_relaxed);  // 被其他线程抢先，重读
+                continue;
+            }
+
+            // 槽位一旦对位置p就绪，在位置p被认领之前不会改变，因此一次CAS即可认领整段
+            if (counter.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                claimed = n;
+                return pos;
+            }
+        }
+    }
+
+public:
+    explicit MPMCRingBuffer(std::size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPMCRingBuffer() {
+        // 此时假定已无并发访问，析构仍在队列中的元素
+        std::size_t end = enqueue_pos_.load(std::memory_order_relaxed);
+        for (std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed); pos != end; ++pos) {
+            Cell& cell = cells_[pos & mask_];
+            if (cell.seq.load(std::memory_order_relaxed) == pos + 1) {
+                cell.value()->~T();
+            }
+        }
+    }
+
+    MPMCRingBuffer(const MPMCRingBuffer&) = delete;
+    MPMCRingBuffer& operator=(const MPMCRingBuffer&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    // 只有成功时才会移动value，失败后调用方仍持有原值，可以重试
+    bool try_push(T&& value) {
+        std::size_t claimed = 0;
+        std::size_t pos = claim(enqueue_pos_, 0, 1, claimed);
+        if (claimed == 0) {
+            return false;
+        }
+        Cell& cell = cells_[pos & mask_];
+        new (cell.storage) T(std::move(value));
+        cell.seq.store(pos + 1, std::memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+
+    bool try_push(const T& value) {
+        T copy(value);
+        return try_push(std::move(copy));
+    }
+
+    bool try_pop(T& out) {
+        std::size_t claimed = 0;
+        std::size_t pos = claim(dequeue_pos_, 1, 1, claimed);
+        if (claimed == 0) {
+            return false;
+        }
+        Cell& cell = cells_[pos & mask_];
+        out = std::move(*cell.value());
+        cell.value()->~T();
+        cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+        not_full_.notify();
+        return true;
+    }
+
+    // 批量写入：一次CAS认领连续槽位，返回实际写入的个数
+    template<typename InputIt>
+    std::size_t push_n(InputIt first, std::size_t count) {
+        std::size_t claimed = 0;
+        std::size_t pos = claim(enqueue_pos_, 0, count, claimed);
+        for (std::size_t i = 0; i < claimed; ++i, ++first) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            new (cell.storage) T(std::move(*first));
+            cell.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        if (claimed > 0) {
+            not_empty_.notify(claimed > 1);
+        }
+        return claimed;
+    }
+
+    // 批量读取：返回实际读取的个数
+    template<typename OutputIt>
+    std::size_t pop_n(OutputIt out, std::size_t count) {
+        std::size_t claimed = 0;
+        std::size_t pos = claim(dequeue_pos_, 1, count, claimed);
+        for (std::size_t i = 0; i < claimed; ++i, ++out) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            *out = std::move(*cell.value());
+            cell.value()->~T();
+            cell.seq.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        if (claimed > 0) {
+            not_full_.notify(claimed > 1);
+        }
+        return claimed;
+    }
+
+    // 阻塞模式：先自旋，再通过EventCount挂起，空闲消费者不占用CPU
+    bool push(T value) {
+        for (int i = 0; i < kSpinBeforePark; ++i) {
+            if (closed_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            if (try_push(std::move(value))) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        while (true) {
+            std::uint32_t key = not_full_.prepare_wait();
+            if (closed_.load()) {
+                not_full_.cancel_wait();
+                return false;
+            }
+            if (try_push(std::move(value))) {
+                not_full_.cancel_wait();
+                return true;
+            }
+            not_full_.wait(key);
+        }
+    }
+
+    // 返回false表示队列已关闭且已排空
+    bool pop(T& out) {
+        for (int i = 0; i < kSpinBeforePark; ++i) {
+            if (try_pop(out)) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        while (true) {
+            std::uint32_t key = not_empty_.prepare_wait();
+            if (try_pop(out)) {
+                not_empty_.cancel_wait();
+                return true;
+            }
+            if (closed_.load()) {
+                not_empty_.cancel_wait();
+                return try_pop(out);
+            }
+            not_empty_.wait(key);
+        }
+    }
+
+    void close() {
+        closed_.store(true);
+        not_empty_.notify(true);
+        not_full_.notify(true);
+    }
+};
+
+struct QueueBenchResult {
+    double ops_per_sec;
+    long long p50_ns;
+    long long p99_ns;
+};
+
+// 每个元素是时间戳数组的下标：生产者写时间戳后入队，消费者出队时计算端到端延迟
+template<typename PushFn, typename PopFn, typename CloseFn>
+QueueBenchResult run_queue_benchmark(int producers, int consumers, int items_per_producer,
+                                     PushFn push, PopFn pop, CloseFn close) {
+    const int total = producers * items_per_producer;
+    std::vector<std::chrono::steady_clock::time_point> stamps(total);
+    std::vector<std::vector<long long>> latencies(consumers);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            int item;
+            while (pop(item)) {
+                auto now = std::chrono::steady_clock::now();
+                latencies[c].push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - stamps[item]).count());
+            }
+        });
+    }
+    std::vector<std::thread> producer_threads;
+    for (int p = 0; p < producers; ++p) {
+        producer_threads.emplace_back([&, p] {
+            for (int i = 0; i < items_per_producer; ++i) {
+                int item = p * items_per_producer + i;
+                stamps[item] = std::chrono::steady_clock::now();
+                push(item);
+            }
+        });
+    }
+    for (auto& t : producer_threads) {
+        t.join();
+    }
+    close();
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::vector<long long> all;
+    for (auto& l : latencies) {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    QueueBenchResult result{0.0, 0, 0};
+    if (all.empty()) {
+        return result;
+    }
+    std::sort(all.begin(), all.end());
+    double seconds = std::chrono::duration<double>(end - start).count();
+    result.ops_per_sec = static_cast<double>(all.size()) / seconds;
+    result.p50_ns = all[all.size() / 2];
+    result.p99_ns = all[all.size() * 99 / 100];
+    return result;
+}
+
+void demonstrate_mpmc_ring_buffer() {
+    std::cout << "=== 有界无锁MPMC环形队列演示 ===\n";
+
+    // 1. 基本与批量接口
+    MPMCRingBuffer<int> ring(6);  // 向上取整到8
+    std::cout << "容量(向上取整为2的幂): " << ring.capacity() << "\n";
+    int batch[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::size_t pushed = ring.push_n(batch, 10);
+    std::cout << "push_n(10) 实际写入: " << pushed << "，队列满时try_push: "
+              << (ring.try_push(99) ? "成功" : "失败") << "\n";
+    int out[10];
+    std::size_t popped = ring.pop_n(out, 5);
+    std::cout << "pop_n(5) 读出: ";
+    for (std::size_t i = 0; i < popped; ++i) {
+        std::cout << out[i] << " ";
+    }
+    std::cout << "\n";
+
+    // 2. 与ProducerConsumerQueue对比（关闭其日志输出）
+    const int producers = 2;
+    const int consumers = 2;
+    const int items_per_producer = 100000;
+
+    ProducerConsumerQueue locked_queue(1024, false);
+    QueueBenchResult locked = run_queue_benchmark(
+        producers, consumers, items_per_producer,
+        [&](int item) { locked_queue.produce(item); },
+        [&](int& item) { return locked_queue.consume(item); },
+        [&] { locked_queue.finish(); });
+
+    MPMCRingBuffer<int> lock_free_queue(1024);
+    QueueBenchResult lock_free = run_queue_benchmark(
+        producers, consumers, items_per_producer,
+        [&](int item) { lock_free_queue.push(item); },
+        [&](int& item) { return lock_free_queue.pop(item); },
+        [&] { lock_free_queue.close(); });
+
+    std::cout << "\n" << producers << "生产者/" << consumers << "消费者, 共"
+              << producers * items_per_producer << "个元素:\n";
+    std::cout << "队列\t\t\tops/s\t\tp50(ns)\tp99(ns)\n";
+    std::cout << "ProducerConsumerQueue\t" << static_cast<long long>(locked.ops_per_sec) << "\t"
+              << locked.p50_ns << "\t" << locked.p99_ns << "\n";
+    std::cout << "MPMCRingBuffer\t\t" << static_cast<long long>(lock_free.ops_per_sec) << "\t"
+              << lock_free.p50_ns << "\t" << lock_free.p99_ns << "\n";
+
+    std::cout << "\n要点:\n";
+    std::cout << "- 容量取2的幂，下标用位与代替取模\n";
+    std::cout << "- 槽位序列号让生产者与消费者只在同一槽位上同步，而不是争抢同一把锁\n";
+    std::cout << "- 批量接口一次CAS认领连续槽位，并把唤醒合并为一次\n";
+    std::cout << "- 阻塞模式先自旋再挂起，无等待者时notify只是一次load\n";
+
+    std::cout << "\n";
+}
+
+// ===== 11. 分片计数器 =====
+// AtomicCounter/ThreadSafeCounter/ReaderWriterCounter的所有线程都写同一个缓存行：
+// 每次递增都要把该缓存行从其他核心抢过来，线程越多抢得越凶
+// 分片计数器让每个线程写自己的槽位，槽位按缓存行对齐互不干扰，读取时再汇总
+
+#ifdef __cpp_lib_hardware_interference_size
+constexpr std::size_t kDestructiveInterference = std::hardware_destructive_interference_size;
+#else
+constexpr std::size_t kDestructiveInterference = 64;
+#endif
+
+// SlotAlign取缓存行大小时无伪共享；取alignof(atomic)时槽位紧挨着，用来对照伪共享的代价
+template<std::size_t SlotAlign = kDestructiveInterference>
+class BasicShardedCounter {
+private:
+    struct alignas(SlotAlign) Slot {
+        std::atomic<std::int64_t> value{0};
+    };
+
+    std::size_t mask_;
+    // Slot按缓存行对齐，C++11的new[]不保证这一点，改用对齐分配
+    AlignedArray<Slot> slots_;
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t cap = 1;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    // 每个线程第一次使用时领取一个递增编号，之后固定映射到同一槽位
+    static std::size_t thread_index() {
+        static std::atomic<std::size_t> next_index{0};
+        thread_local std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+public:
+    // 默认分片数为硬件线程数的两倍，线程数超过分片数时多个线程共享槽位，结果仍然正确
+    explicit BasicShardedCounter(std::size_t shards = 2 * std::max(1u, std::thread::hardware_concurrency()))
+        : mask_(round_up_pow2(shards) - 1), slots_(make_aligned_array<Slot>(mask_ + 1)) {}
+
+    BasicShardedCounter(const BasicShardedCounter&) = delete;
+    BasicShardedCounter& operator=(const BasicShardedCounter&) = delete;
+
+    // 递增只需relaxed：计数器不用来同步其他数据
+    void increment(std::int64_t by = 1) {
+        slots_[thread_index() & mask_].value.fetch_add(by, std::memory_order_relaxed);
+    }
+
+    // 汇总所有槽位；并发递增时得到的是某个近似快照
+    std::int64_t read() const {
+        std::int64_t sum = 0;
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            sum += slots_[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    void reset() {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            slots_[i].value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t shards() const { return mask_ + 1; }
+};
+
+using ShardedCounter = BasicShardedCounter<>;
+using UnpaddedShardedCounter = BasicShardedCounter<alignof(std::atomic<std::int64_t>)>;
+
+// 所有线程同时开始递增，返回每秒总递增次数
+template<typename Increment>
+double benchmark_counter(int threads, int increments_per_thread, Increment increment) {
+    std::atomic<bool> go{false};
+    std::atomic<int> ready{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < increments_per_thread; ++i) {
+                increment();
+            }
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers) {
+        w.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(threads) * increments_per_thread / seconds;
+}
+
+void demonstrate_sharded_counter() {
+    std::cout << "=== 分片计数器演示 ===\n";
+    std::cout << "缓存行大小: " << kDestructiveInterference << " 字节, 硬件线程: "
+              << std::thread::hardware_concurrency() << "\n";
+
+    const int increments_per_thread = 200000;
+    const int thread_counts[] = {1, 4, 16, 64};
+
+    std::cout << "线程数\tAtomicCounter\tThreadSafe\tReaderWriter\t未对齐分片\t分片计数器\t(M次/秒)\n";
+    for (int threads : thread_counts) {
+        AtomicCounter atomic_counter;
+        ThreadSafeCounter mutex_counter;
+        ReaderWriterCounter rw_counter;
+        UnpaddedShardedCounter unpadded(64);
+        ShardedCounter sharded(64);
+
+        double results[] = {
+            benchmark_counter(threads, increments_per_thread, [&] { atomic_counter.increment_relaxed(); }),
+            benchmark_counter(threads, increments_per_thread, [&] { mutex_counter.increment(); }),
+            benchmark_counter(threads, increments_per_thread, [&] { rw_counter.write_increment(); }),
+            benchmark_counter(threads, increments_per_thread, [&] { unpadded.increment(); }),
+            benchmark_counter(threads, increments_per_thread, [&] { sharded.increment(); }),
+        };
+
+        std::cout << threads;
+        for (double r : results) {
+            std::cout << "\t" << static_cast<long long>(r / 1e4) / 100.0 << "\t";
+        }
+        std::cout << "\n";
+
+        // 分片计数器汇总后与期望值一致
+        const std::int64_t expected = static_cast<std::int64_t>(threads) * increments_per_thread;
+        if (sharded.read() != expected || atomic_counter.get_relaxed() != expected) {
+            std::cout << "计数错误: " << sharded.read() << " != " << expected << "\n";
+        }
+    }
+
+    std::cout << "\n要点:\n";
+    std::cout << "- 单一计数器的吞吐随线程数增加而下降，瓶颈是缓存行在核心间来回迁移\n";
+    std::cout << "- 槽位不对齐时多个线程仍写同一缓存行(伪共享)，分片只解决了一半问题\n";
+    std::cout << "- read()需要遍历所有槽位，适合写多读少的统计场景\n";
+    std::cout << "- 单核机器上线程轮流运行，不存在缓存行争用，各方案差距只剩指令开销\n";
+
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 
 int main() {
@@ -864,6 +2508,18 @@ int main() {
     // 最佳实践
     demonstrate_best_practices();
     
+    // 工作窃取线程池
+    demonstrate_work_stealing_pool();
+    
+    // ABA安全的无锁栈
+    demonstrate_aba_safe_stack();
+    
+    // 有界无锁MPMC队列
+    demonstrate_mpmc_ring_buffer();
+    
+    // 分片计数器
+    demonstrate_sharded_counter();
+    
     return 0;
 }
 
@@ -881,6 +2537,10 @@ g++ -std=c++11 -pthread -O2 -Wall 07_threading_concurrency.cpp -o threading_demo
 6. 了解线程局部存储的使用场景
 7. 学会识别和避免常见的并发编程陷阱
 8. 掌握现代C++并发编程的最佳实践
+9. 理解Chase-Lev工作窃取队列如何消除单一任务队列的锁竞争
+10. 区分ABA问题与内存回收问题：标签解决前者，危险指针/纪元回收解决后者
+11. 掌握Vyukov序列号环形队列，以及自旋后挂起(std::atomic::wait)的阻塞策略
+12. 高频计数按线程分片并按缓存行对齐，写入互不干扰，读取时汇总
 
 注意事项:
 - 编译时需要链接pthread库 (-pthread)
@@ -7,6 +7,7 @@
  * 3. enable_if的工作原理和应用模式
  * 4. 自定义类型检测器的设计
  * 5. 模板特化与SFINAE的结合使用
+ * 6. 基于同一套特征分派的二进制序列化(varint/zigzag、批量memcpy、零拷贝视图)
  */
 
 #include <iostream>
@@ -15,6 +16,12 @@
 #include <vector>
 #include <memory>
 #include <utility>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <tuple>
 
 // ===== 1. SFINAE基本原理演示 =====
 
@@ -658,6 +665,636 @@ void demonstrate_best_practices() {
     std::cout << "\n";
 }
 
+// ===== 8. 二进制序列化后端：同一套特征分派，零拷贝读取 =====
+// 上面的Serializer把一切拼成std::string，容器里每个元素都要分配一次临时字符串
+// BinarySerializer沿用同样的"主模板 + enable_if偏特化"分派，但换成二进制格式：
+// 1. 写入调用方提供的缓冲区，空间不够时只计数不写入，size()给出所需字节数
+// 2. 整数用varint编码，有符号整数先做zigzag，小数值只占1~2字节
+// 3. 元素为算术类型的连续容器(vector<int>、vector<double>...)整段memcpy
+// 4. 读取端可以返回指向缓冲区的视图(BinaryStringView/BinaryArrayView)，不分配内存
+// 格式约定：浮点数和批量数组按主机字节序(小端)存放，跨字节序传输需要另行转换
+
+class BinaryWriter {
+private:
+    unsigned char* data_;
+    size_t capacity_;
+    size_t pos_;
+    bool overflow_;
+    
+public:
+    BinaryWriter(unsigned char* data, size_t capacity)
+        : data_(data), capacity_(capacity), pos_(0), overflow_(false) {}
+    
+    // 只统计所需字节数的"测量"写入器
+    BinaryWriter() : BinaryWriter(nullptr, 0) {}
+    
+    void write_bytes(const void* src, size_t n) {
+        if (n <= capacity_ - std::min(pos_, capacity_) && !overflow_) {
+            if (n > 0) std::memcpy(data_ + pos_, src, n);
+        } else {
+            overflow_ = true;
+        }
+        pos_ += n;
+    }
+    
+    void write_byte(unsigned char byte) {
+        if (pos_ < capacity_ && !overflow_) {
+            data_[pos_] = byte;
+        } else {
+            overflow_ = true;
+        }
+        ++pos_;
+    }
+    
+    // 每字节7位有效数据，最高位表示后面还有字节
+    void write_varint(uint64_t value) {
+        if (capacity_ - std::min(pos_, capacity_) >= 10 && !overflow_) {
+            unsigned char* out = data_ + pos_;
+            while (value >= 0x80) {
+                *out++ = static_cast<unsigned char>(value | 0x80);
+                value >>= 7;
+            }
+            *out++ = static_cast<unsigned char>(value);
+            pos_ = static_cast<size_t>(out - data_);
+            return;
+        }
+        while (value >= 0x80) {
+            write_byte(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        write_byte(static_cast<unsigned char>(value));
+    }
+    
+    void write_zigzag(int64_t value) {
+        const uint64_t bits = static_cast<uint64_t>(value);
+        write_varint((bits << 1) ^ (uint64_t(0) - (bits >> 63)));
+    }
+    
+    size_t size() const { return pos_; }
+    bool ok() const { return !overflow_; }
+};
+
+// 指向读缓冲区的字符串视图，缓冲区必须比视图活得久
+struct BinaryStringView {
+    const char* data;
+    size_t size;
+    
+    std::string str() const { return std::string(data, size); }
+};
+
+// 指向读缓冲区的数组视图；缓冲区里的元素不保证按T对齐，所以逐个memcpy读取
+template<typename T>
+struct BinaryArrayView {
+    const unsigned char* data;
+    size_t count;
+    
+    size_t size() const { return count; }
+    
+    T operator[](size_t i) const {
+        T value;
+        std::memcpy(&value, data + i * sizeof(T), sizeof(T));
+        return value;
+    }
+    
+    void copy_to(T* out) const {
+        if (count > 0) std::memcpy(out, data, count * sizeof(T));
+    }
+};
+
+class BinaryReader {
+private:
+    const unsigned char* data_;
+    size_t size_;
+    size_t pos_;
+    bool failed_;
+    
+public:
+    BinaryReader(const unsigned char* data, size_t size)
+        : data_(data), size_(size), pos_(0), failed_(false) {}
+    
+    // 截断或格式错误时置失败标志并返回nullptr，之后的读取全部失败
+    const unsigned char* take(size_t n) {
+        if (failed_ || n > size_ - pos_) {
+            failed_ = true;
+            return nullptr;
+        }
+        const unsigned char* p = data_ + pos_;
+        pos_ += n;
+        return p;
+    }
+    
+    bool read_bytes(void* dst, size_t n) {
+        const unsigned char* p = take(n);
+        if (p && n > 0) std::memcpy(dst, p, n);
+        return p != nullptr;
+    }
+    
+    bool read_varint(uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const unsigned char* p = take(1);
+            if (!p) return false;
+            value |= static_cast<uint64_t>(*p & 0x7F) << shift;
+            if ((*p & 0x80) == 0) {
+                // 第10个字节只能携带最高的1位
+                if (shift == 63 && *p > 1) break;
+                return true;
+            }
+        }
+        failed_ = true;
+        return false;
+    }
+    
+    bool read_zigzag(int64_t& value) {
+        uint64_t bits;
+        if (!read_varint(bits)) return false;
+        value = static_cast<int64_t>((bits >> 1) ^ (uint64_t(0) - (bits & 1)));
+        return true;
+    }
+    
+    // 读取元素个数：每个元素至少占min_element_bytes字节，超出剩余数据的长度直接判为错误，
+    // 避免损坏的长度字段触发巨大的内存分配
+    bool read_length(size_t& length, size_t min_element_bytes) {
+        uint64_t n;
+        if (!read_varint(n)) return false;
+        if (min_element_bytes > 0 && n > (size_ - pos_) / min_element_bytes) {
+            failed_ = true;
+            return false;
+        }
+        length = static_cast<size_t>(n);
+        return true;
+    }
+    
+    BinaryStringView read_string_view() {
+        size_t length = 0;
+        read_length(length, 1);
+        const unsigned char* p = take(length);
+        BinaryStringView view = {p ? reinterpret_cast<const char*>(p) : "", p ? length : 0};
+        return view;
+    }
+    
+    template<typename T>
+    BinaryArrayView<T> read_array_view() {
+        size_t count = 0;
+        read_length(count, sizeof(T));
+        const unsigned char* p = take(count * sizeof(T));
+        BinaryArrayView<T> view = {p, p ? count : 0};
+        return view;
+    }
+    
+    void fail() { failed_ = true; }
+    bool ok() const { return !failed_; }
+    size_t remaining() const { return size_ - pos_; }
+};
+
+// 分派用的类型特征
+template<typename T>
+struct is_varint_type : std::integral_constant<bool,
+    std::is_integral<T>::value && !std::is_same<T, bool>::value> {};
+
+template<typename T>
+struct is_fixed_width_type : std::integral_constant<bool,
+    std::is_floating_point<T>::value || std::is_same<T, bool>::value> {};
+
+DEFINE_HAS_MEMBER(data);
+DEFINE_HAS_MEMBER(fields);
+
+template<typename T>
+class has_resize {
+private:
+    template<typename U>
+    static auto test(U* u) -> decltype(u->resize(size_t{}), std::true_type{});
+    template<typename>
+    static std::false_type test(...);
+    
+public:
+    static constexpr bool value = decltype(test<T>(nullptr))::value;
+};
+
+// 可以整段memcpy的容器：连续存储、可resize、元素是算术类型(不含vector<bool>)
+template<typename T, bool = is_container<T>::value>
+struct is_bulk_container : std::false_type {};
+
+template<typename T>
+struct is_bulk_container<T, true> : std::integral_constant<bool,
+    has_data<T>::value && has_resize<T>::value &&
+    std::is_arithmetic<typename T::value_type>::value &&
+    !std::is_same<typename T::value_type, bool>::value> {};
+
+template<typename T>
+struct is_element_container : std::integral_constant<bool,
+    is_container<T>::value && !is_bulk_container<T>::value> {};
+
+// map的value_type是pair<const K, V>，读取时需要一个可赋值的临时对象（写入直接按value_type分派，不复制元素）
+template<typename T>
+struct mutable_value { using type = T; };
+
+template<typename K, typename V>
+struct mutable_value<std::pair<const K, V>> { using type = std::pair<K, V>; };
+
+template<typename T, typename Enable = void>
+struct BinarySerializer;
+
+// 整数：varint，有符号先zigzag；读取时检查范围，超出目标类型视为格式错误
+template<typename T>
+struct BinarySerializer<T, typename std::enable_if<is_varint_type<T>::value && std::is_signed<T>::value>::type> {
+    static void write(BinaryWriter& out, T value) {
+        out.write_zigzag(static_cast<int64_t>(value));
+    }
+    static void read(BinaryReader& in, T& value) {
+        int64_t wide;
+        if (!in.read_zigzag(wide)) return;
+        if (wide < static_cast<int64_t>(std::numeric_limits<T>::min()) ||
+            wide > static_cast<int64_t>(std::numeric_limits<T>::max())) {
+            in.fail();
+            return;
+        }
+        value = static_cast<T>(wide);
+    }
+};
+
+template<typename T>
+struct BinarySerializer<T, typename std::enable_if<is_varint_type<T>::value && std::is_unsigned<T>::value>::type> {
+    static void write(BinaryWriter& out, T value) {
+        out.write_varint(static_cast<uint64_t>(value));
+    }
+    static void read(BinaryReader& in, T& value) {
+        uint64_t wide;
+        if (!in.read_varint(wide)) return;
+        if (wide > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+            in.fail();
+            return;
+        }
+        value = static_cast<T>(wide);
+    }
+};
+
+// bool和浮点数：定长原样存放
+template<typename T>
+struct BinarySerializer<T, typename std::enable_if<is_fixed_width_type<T>::value>::type> {
+    static void write(BinaryWriter& out, T value) {
+        out.write_bytes(&value, sizeof(T));
+    }
+    static void read(BinaryReader& in, T& value) {
+        if (std::is_same<T, bool>::value) {
+            unsigned char byte = 0;
+            if (in.read_bytes(&byte, 1) && byte > 1) in.fail();
+            value = byte != 0;
+        } else {
+            in.read_bytes(&value, sizeof(T));
+        }
+    }
+};
+
+template<typename T>
+struct BinarySerializer<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+    using Underlying = typename std::underlying_type<T>::type;
+    static void write(BinaryWriter& out, T value) {
+        BinarySerializer<Underlying>::write(out, static_cast<Underlying>(value));
+    }
+    static void read(BinaryReader& in, T& value) {
+        Underlying raw = Underlying();
+        BinarySerializer<Underlying>::read(in, raw);
+        value = static_cast<T>(raw);
+    }
+};
+
+// 字符串：长度 + 原始字节
+template<>
+struct BinarySerializer<std::string> {
+    static void write(BinaryWriter& out, const std::string& value) {
+        out.write_varint(value.size());
+        out.write_bytes(value.data(), value.size());
+    }
+    static void read(BinaryReader& in, std::string& value) {
+        BinaryStringView view = in.read_string_view();
+        value.assign(view.data, view.size);
+    }
+};
+
+// 零拷贝视图与std::string/vector的编码相同，读取时只记录位置
+template<>
+struct BinarySerializer<BinaryStringView> {
+    static void write(BinaryWriter& out, const BinaryStringView& value) {
+        out.write_varint(value.size);
+        out.write_bytes(value.data, value.size);
+    }
+    static void read(BinaryReader& in, BinaryStringView& value) {
+        value = in.read_string_view();
+    }
+};
+
+template<typename T>
+struct BinarySerializer<BinaryArrayView<T>> {
+    static void write(BinaryWriter& out, const BinaryArrayView<T>& value) {
+        out.write_varint(value.count);
+        out.write_bytes(value.data, value.count * sizeof(T));
+    }
+    static void read(BinaryReader& in, BinaryArrayView<T>& value) {
+        value = in.read_array_view<T>();
+    }
+};
+
+// 算术元素的连续容器：长度 + 一次memcpy
+template<typename T>
+struct BinarySerializer<T, typename std::enable_if<is_bulk_container<T>::value>::type> {
+    using Element = typename T::value_type;
+    static void write(BinaryWriter& out, const T& container) {
+        out.write_varint(container.size());
+        out.write_bytes(container.data(), container.size() * sizeof(Element));
+    }
+    static void read(BinaryReader& in, T& container) {
+        BinaryArrayView<Element> view = in.read_array_view<Element>();
+        container.resize(view.count);
+        view.copy_to(container.data());
+    }
+};
+
+// 其余容器：长度 + 逐个元素，元素类型再次经过BinarySerializer分派
+template<typename T>
+struct BinarySerializer<T, typename std::enable_if<is_element_container<T>::value>::type> {
+    using Element = typename mutable_value<typename T::value_type>::type;
+    static void write(BinaryWriter& out, const T& container) {
+        out.write_varint(container.size());
+        for (const auto& item : container) {
+            BinarySerializer<typename T::value_type>::write(out, item);
+        }
+    }
+    static void read(BinaryReader& in, T& container) {
+        size_t count = 0;
+        if (!in.read_length(count, 1)) return;
+        container.clear();
+        for (size_t i = 0; i < count && in.ok(); ++i) {
+            Element item = Element();
+            BinarySerializer<Element>::read(in, item);
+            container.insert(container.end(), std::move(item));
+        }
+    }
+};
+
+template<typename A, typename B>
+struct BinarySerializer<std::pair<A, B>> {
+    static void write(BinaryWriter& out, const std::pair<A, B>& value) {
+        BinarySerializer<A>::write(out, value.first);
+        BinarySerializer<B>::write(out, value.second);
+    }
+    static void read(BinaryReader& in, std::pair<A, B>& value) {
+        BinarySerializer<A>::read(in, value.first);
+        BinarySerializer<B>::read(in, value.second);
+    }
+};
+
+// map的元素只需要写：键按const引用交给K的序列化器；读取走mutable_value得到的pair<K, V>
+template<typename K, typename V>
+struct BinarySerializer<std::pair<const K, V>> {
+    static void write(BinaryWriter& out, const std::pair<const K, V>& value) {
+        BinarySerializer<K>::write(out, value.first);
+        BinarySerializer<V>::write(out, value.second);
+    }
+};
+
+// 智能指针：1字节存在标志 + 指向的值
+template<typename T>
+struct BinarySerializer<std::unique_ptr<T>> {
+    static void write(BinaryWriter& out, const std::unique_ptr<T>& ptr) {
+        out.write_byte(ptr ? 1 : 0);
+        if (ptr) BinarySerializer<T>::write(out, *ptr);
+    }
+    static void read(BinaryReader& in, std::unique_ptr<T>& ptr) {
+        bool present = false;
+        BinarySerializer<bool>::read(in, present);
+        ptr.reset(present ? new T() : nullptr);
+        if (ptr) BinarySerializer<T>::read(in, *ptr);
+    }
+};
+
+template<typename T>
+struct BinarySerializer<std::shared_ptr<T>> {
+    static void write(BinaryWriter& out, const std::shared_ptr<T>& ptr) {
+        out.write_byte(ptr ? 1 : 0);
+        if (ptr) BinarySerializer<T>::write(out, *ptr);
+    }
+    static void read(BinaryReader& in, std::shared_ptr<T>& ptr) {
+        bool present = false;
+        BinarySerializer<bool>::read(in, present);
+        ptr = present ? std::make_shared<T>() : std::shared_ptr<T>();
+        if (ptr) BinarySerializer<T>::read(in, *ptr);
+    }
+};
+
+// 逐个处理tuple元素(C++11没有index_sequence和折叠表达式，用递归展开)
+template<size_t I, size_t N>
+struct TupleFields {
+    template<typename Tuple>
+    static void write(BinaryWriter& out, const Tuple& fields) {
+        using Field = typename std::decay<typename std::tuple_element<I, Tuple>::type>::type;
+        BinarySerializer<Field>::write(out, std::get<I>(fields));
+        TupleFields<I + 1, N>::write(out, fields);
+    }
+    template<typename Tuple>
+    static void read(BinaryReader& in, Tuple& fields) {
+        using Field = typename std::decay<typename std::tuple_element<I, Tuple>::type>::type;
+        BinarySerializer<Field>::read(in, std::get<I>(fields));
+        TupleFields<I + 1, N>::read(in, fields);
+    }
+};
+
+template<size_t N>
+struct TupleFields<N, N> {
+    template<typename Tuple>
+    static void write(BinaryWriter&, const Tuple&) {}
+    template<typename Tuple>
+    static void read(BinaryReader&, Tuple&) {}
+};
+
+template<typename... Ts>
+struct BinarySerializer<std::tuple<Ts...>> {
+    static void write(BinaryWriter& out, const std::tuple<Ts...>& value) {
+        TupleFields<0, sizeof...(Ts)>::write(out, value);
+    }
+    static void read(BinaryReader& in, std::tuple<Ts...>& value) {
+        TupleFields<0, sizeof...(Ts)>::read(in, value);
+    }
+};
+
+// 结构体：提供fields()成员(返回std::tie(...))即可按声明顺序序列化
+// C++17起也可以用结构化绑定自动拆出字段，见C++17/01；这里保持C++11可用的写法
+template<typename T>
+struct BinarySerializer<T, typename std::enable_if<has_fields<T>::value && !is_container<T>::value>::type> {
+    static void write(BinaryWriter& out, const T& value) {
+        auto fields = const_cast<T&>(value).fields();
+        TupleFields<0, std::tuple_size<decltype(fields)>::value>::write(out, fields);
+    }
+    static void read(BinaryReader& in, T& value) {
+        auto fields = value.fields();
+        TupleFields<0, std::tuple_size<decltype(fields)>::value>::read(in, fields);
+    }
+};
+
+// 写入调用方的缓冲区，返回所需字节数；返回值大于capacity说明缓冲区不够，内容不完整
+template<typename T>
+size_t serialize_binary(const T& value, unsigned char* buffer, size_t capacity) {
+    BinaryWriter writer(buffer, capacity);
+    BinarySerializer<T>::write(writer, value);
+    return writer.size();
+}
+
+// 便捷版本：先测量再一次性分配
+template<typename T>
+std::vector<unsigned char> serialize_binary(const T& value) {
+    BinaryWriter measure;
+    BinarySerializer<T>::write(measure, value);
+    std::vector<unsigned char> buffer(measure.size());
+    serialize_binary(value, buffer.data(), buffer.size());
+    return buffer;
+}
+
+// 必须恰好读完整个缓冲区才算成功
+template<typename T>
+bool deserialize_binary(const unsigned char* data, size_t size, T& value) {
+    BinaryReader reader(data, size);
+    BinarySerializer<T>::read(reader, value);
+    return reader.ok() && reader.remaining() == 0;
+}
+
+// 演示用的RPC消息：同一份线格式，分别用拥有所有权的结构和零拷贝视图读取
+enum class Priority : uint8_t { Low, Normal, High };
+
+struct RpcRequest {
+    uint64_t request_id;
+    int32_t shard;
+    Priority priority;
+    std::string method;
+    std::vector<float> features;
+    std::vector<std::string> tags;
+    std::unique_ptr<std::string> trace_id;
+    
+    std::tuple<uint64_t&, int32_t&, Priority&, std::string&, std::vector<float>&,
+               std::vector<std::string>&, std::unique_ptr<std::string>&> fields() {
+        return std::tie(request_id, shard, priority, method, features, tags, trace_id);
+    }
+};
+
+struct RpcRequestView {
+    uint64_t request_id;
+    int32_t shard;
+    Priority priority;
+    BinaryStringView method;
+    BinaryArrayView<float> features;
+    
+    std::tuple<uint64_t&, int32_t&, Priority&, BinaryStringView&, BinaryArrayView<float>&> fields() {
+        return std::tie(request_id, shard, priority, method, features);
+    }
+};
+
+template<typename Func>
+double best_ns_per_op(size_t ops, Func&& func) {
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ns / static_cast<double>(ops));
+    }
+    return best;
+}
+
+void demonstrate_binary_serializer() {
+    std::cout << "=== 二进制序列化后端演示 ===\n";
+    
+    // 1. varint/zigzag的编码长度
+    std::cout << "1. 整数编码长度:\n";
+    const int64_t samples[] = {0, -1, 63, -64, 300, -100000, std::numeric_limits<int64_t>::min()};
+    for (int64_t v : samples) {
+        std::cout << "  " << v << " -> " << serialize_binary(v).size() << " 字节\n";
+    }
+    
+    // 2. 往返：结构体经fields()反射，容器和智能指针递归分派
+    std::cout << "\n2. RPC消息往返:\n";
+    RpcRequest request;
+    request.request_id = 9001;
+    request.shard = -3;
+    request.priority = Priority::High;
+    request.method = "Search.Query";
+    request.features = {0.5f, 1.25f, -2.0f, 8.0f};
+    request.tags = {"beta", "cn-north"};
+    request.trace_id.reset(new std::string("trace-7f3a"));
+    
+    std::vector<unsigned char> wire = serialize_binary(request);
+    std::cout << "  编码后 " << wire.size() << " 字节\n";
+    
+    RpcRequest decoded;
+    bool ok = deserialize_binary(wire.data(), wire.size(), decoded);
+    std::cout << "  解码" << (ok ? "成功" : "失败") << ": id=" << decoded.request_id << ", shard=" << decoded.shard
+              << ", method=" << decoded.method << ", features=" << decoded.features.size()
+              << ", tags=" << Serializer<std::vector<std::string>>::serialize(decoded.tags)
+              << ", trace=" << (decoded.trace_id ? *decoded.trace_id : "null") << "\n";
+    
+    // 3. 零拷贝：前五个字段的编码与RpcRequest相同，视图直接指向wire
+    RpcRequestView view;
+    BinaryReader reader(wire.data(), wire.size());
+    BinarySerializer<RpcRequestView>::read(reader, view);
+    std::cout << "  零拷贝视图: method=" << view.method.str() << " (指向缓冲区偏移 "
+              << (reinterpret_cast<const unsigned char*>(view.method.data) - wire.data()) << "), features[1]="
+              << view.features[1] << ", 剩余未读 " << reader.remaining() << " 字节\n";
+    
+    // 4. 调用方缓冲区不够时不越界，返回所需大小；截断的输入被拒绝
+    unsigned char small[8];
+    size_t needed = serialize_binary(request, small, sizeof(small));
+    std::cout << "  8字节缓冲区: 需要 " << needed << " 字节, 写入" << (needed <= sizeof(small) ? "完整" : "不完整") << "\n";
+    RpcRequest truncated;
+    std::cout << "  截断输入解码: " << (deserialize_binary(wire.data(), wire.size() - 3, truncated) ? "成功" : "失败") << "\n";
+    
+    // 5. 与文本Serializer对比
+    std::cout << "\n3. 性能对比 (5轮取最好):\n";
+    std::vector<int> numbers(1000);
+    for (size_t i = 0; i < numbers.size(); ++i) numbers[i] = static_cast<int>(i * 37 % 2001) - 1000;
+    std::vector<std::string> words;
+    for (int i = 0; i < 100; ++i) words.push_back("token_" + std::to_string(i * 7919));
+    
+    std::vector<unsigned char> buffer(64 * 1024);
+    const size_t rounds = 2000;
+    size_t sink = 0;
+    
+    double text_ints = best_ns_per_op(rounds, [&] {
+        for (size_t r = 0; r < rounds; ++r) sink += Serializer<std::vector<int>>::serialize(numbers).size();
+    });
+    double bin_ints = best_ns_per_op(rounds, [&] {
+        for (size_t r = 0; r < rounds; ++r) sink += serialize_binary(numbers, buffer.data(), buffer.size());
+    });
+    double text_words = best_ns_per_op(rounds, [&] {
+        for (size_t r = 0; r < rounds; ++r) sink += Serializer<std::vector<std::string>>::serialize(words).size();
+    });
+    double bin_words = best_ns_per_op(rounds, [&] {
+        for (size_t r = 0; r < rounds; ++r) sink += serialize_binary(words, buffer.data(), buffer.size());
+    });
+    
+    size_t request_bytes = serialize_binary(request, buffer.data(), buffer.size());
+    double decode_owned = best_ns_per_op(rounds, [&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            RpcRequest out;
+            sink += deserialize_binary(buffer.data(), request_bytes, out);
+        }
+    });
+    double decode_view = best_ns_per_op(rounds, [&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            RpcRequestView out;
+            BinaryReader in(buffer.data(), request_bytes);
+            BinarySerializer<RpcRequestView>::read(in, out);
+            sink += out.method.size;
+        }
+    });
+    
+    std::cout << "  vector<int>(1000)    文本: " << text_ints << " ns (" << Serializer<std::vector<int>>::serialize(numbers).size()
+              << " 字节), 二进制: " << bin_ints << " ns (" << serialize_binary(numbers).size() << " 字节)\n";
+    std::cout << "  vector<string>(100)  文本: " << text_words << " ns (" << Serializer<std::vector<std::string>>::serialize(words).size()
+              << " 字节), 二进制: " << bin_words << " ns (" << serialize_binary(words).size() << " 字节)\n";
+    std::cout << "  RpcRequest解码  拥有所有权: " << decode_owned << " ns, 零拷贝视图: " << decode_view << " ns\n";
+    if (sink == 0) std::cout << "";  // 防止循环被优化掉
+    
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 
 int main() {
@@ -685,6 +1322,9 @@ int main() {
     // 最佳实践
     demonstrate_best_practices();
     
+    // 二进制序列化
+    demonstrate_binary_serializer();
+    
     return 0;
 }
 
@@ -702,10 +1342,13 @@ g++ -std=c++11 -O2 -Wall 09_type_traits_sfinae.cpp -o sfinae_demo
 6. 掌握SFINAE在泛型编程中的最佳实践
 7. 了解SFINAE的性能特性和现代替代方案
 8. 学会构建基于SFINAE的通用算法库
+9. 同一套enable_if分派可以换成二进制后端：写入调用方缓冲区、算术数组整段memcpy、读取返回缓冲区视图
 
 注意事项:
 - SFINAE是编译期技术，不会影响运行时性能
 - 过度复杂的SFINAE表达式会增加编译时间
 - C++17的if constexpr和C++20的Concepts提供了更好的替代方案
 - 在实际项目中要平衡代码复杂度和功能需求
+- 零拷贝视图(BinaryStringView/BinaryArrayView)只在读缓冲区存活期间有效
+- 二进制格式中的浮点数和批量数组按主机字节序存放，跨平台传输需要统一字节序
 */
\ No newline at end of file
@@ -7,6 +7,7 @@
  * 3. 与传统enum的兼容性和迁移策略
  * 4. 枚举在模板编程中的应用
  * 5. 类型安全的位操作和枚举组合
+ * 6. 枚举索引的编译期转换矩阵 - 缓存紧凑的表驱动状态机
  */
 
 #include <iostream>
@@ -15,6 +16,12 @@
 #include <type_traits>
 #include <unordered_map>
 #include <bitset>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
 
 // ===== 1. 传统枚举的问题演示 =====
 
@@ -214,10 +221,12 @@ private:
     underlying_type current_;
     
 public:
-    explicit enum_iterator(EnumType start) 
+    using value_type = EnumType;
+    
+    constexpr explicit enum_iterator(EnumType start) 
         : current_(static_cast<underlying_type>(start)) {}
     
-    EnumType operator*() const {
+    constexpr EnumType operator*() const {
         return static_cast<EnumType>(current_);
     }
     
@@ -226,15 +235,20 @@ public:
         return *this;
     }
     
-    bool operator!=(const enum_iterator& other) const {
+    constexpr bool operator!=(const enum_iterator& other) const {
         return current_ != other.current_;
     }
     
-    static enum_iterator begin() {
+    static constexpr enum_iterator begin() {
         return enum_iterator(First);
     }
     
-    static enum_iterator end() {
+    // 要求枚举值连续
+    static constexpr std::size_t count() {
+        return static_cast<std::size_t>(Last) - static_cast<std::size_t>(First) + 1;
+    }
+    
+    static constexpr enum_iterator end() {
         return enum_iterator(static_cast<EnumType>(
             static_cast<underlying_type>(Last) + 1
         ));
@@ -426,55 +440,180 @@ enum class ConnectionEvent {
     Error
 };
 
+// 状态和事件都是小而连续的枚举，直接用底层值做转换矩阵的二维下标
+using ConnectionStates = enum_iterator<ConnectionState, ConnectionState::Disconnected, ConnectionState::Failed>;
+using ConnectionEvents = enum_iterator<ConnectionEvent, ConnectionEvent::Connect, ConnectionEvent::Error>;
+
+// 一条转换规则；action为空表示只切换状态
+template<typename States, typename Events, typename Context>
+struct TransitionRule {
+    typename States::value_type from;
+    typename Events::value_type event;
+    typename States::value_type to;
+    void (*action)(Context&);
+};
+
+// 编译期生成的转换矩阵：每格2字节（目标状态 + 动作下标），动作是普通函数指针，
+// 整张表只占一两条缓存行。重复定义同一个(状态, 事件)会在编译期报错
+template<typename States, typename Events, typename Context, std::size_t N>
+class TransitionTable {
+public:
+    using State = typename States::value_type;
+    using Event = typename Events::value_type;
+    using Rule = TransitionRule<States, Events, Context>;
+    using Action = void (*)(Context&);
+    
+    // 无效格的next指回源状态、rule为0，热路径可以无分支地"转换"并累计拒绝数
+    struct Cell {
+        uint8_t next;  // 目标状态下标
+        uint8_t rule;  // 规则序号+1，同时是actions_下标；0表示该事件在此状态下无效
+        
+        constexpr bool valid() const { return rule != 0; }
+    };
+    
+    static constexpr std::size_t kStates = States::count();
+    static constexpr std::size_t kEvents = Events::count();
+    static_assert(kStates <= 0xFF && N < 0xFF, "状态或规则太多，一个字节放不下");
+    
+    constexpr explicit TransitionTable(const Rule (&rules)[N])
+        : TransitionTable(rules, std::make_index_sequence<kStates * kEvents>{}, std::make_index_sequence<N>{}) {}
+    
+    constexpr Cell cell(State state, Event event) const {
+        return cells_[state_index(state) * kEvents + event_index(event)];
+    }
+    
+    Action action(uint8_t id) const { return actions_[id]; }
+    
+    static constexpr State to_state(uint8_t index) {
+        return static_cast<State>(index + static_cast<std::size_t>(*States::begin()));
+    }
+    
+    static constexpr std::size_t state_index(State state) {
+        return static_cast<std::size_t>(state) - static_cast<std::size_t>(*States::begin());
+    }
+    
+    static constexpr std::size_t event_index(Event event) {
+        return static_cast<std::size_t>(event) - static_cast<std::size_t>(*Events::begin());
+    }
+    
+private:
+    std::array<Cell, kStates * kEvents> cells_;
+    std::array<Action, N + 1> actions_;
+    
+    template<std::size_t... Cs, std::size_t... Rs>
+    constexpr TransitionTable(const Rule (&rules)[N], std::index_sequence<Cs...>, std::index_sequence<Rs...>)
+        : cells_{{make_cell(rules, Cs)...}}, actions_{{nullptr, rules[Rs].action...}} {}
+    
+    static constexpr Cell make_cell(const Rule (&rules)[N], std::size_t flat) {
+        Cell result{static_cast<uint8_t>(flat / kEvents), 0};
+        for (std::size_t i = 0; i < N; ++i) {
+            if (state_index(rules[i].from) * kEvents + event_index(rules[i].event) == flat) {
+                if (result.valid()) {
+                    throw std::logic_error("重复的状态转换");
+                }
+                result = Cell{static_cast<uint8_t>(state_index(rules[i].to)), static_cast<uint8_t>(i + 1)};
+            }
+        }
+        return result;
+    }
+};
+
+template<typename States, typename Events, typename Context, std::size_t N>
+constexpr TransitionTable<States, Events, Context, N>
+make_transition_table(const TransitionRule<States, Events, Context> (&rules)[N]) {
+    return TransitionTable<States, Events, Context, N>(rules);
+}
+
+// 每条连接的统计，由转换动作更新
+struct ConnectionStats {
+    uint64_t attempts = 0;
+    uint64_t established = 0;
+    uint64_t drops = 0;
+    uint64_t failures = 0;
+    uint64_t rejected = 0;
+};
+
+namespace connection_actions {
+    inline void on_attempt(ConnectionStats& s) { ++s.attempts; }
+    inline void on_established(ConnectionStats& s) { ++s.established; }
+    inline void on_drop(ConnectionStats& s) { ++s.drops; }
+    inline void on_failure(ConnectionStats& s) { ++s.failures; }
+}
+
+using ConnectionRule = TransitionRule<ConnectionStates, ConnectionEvents, ConnectionStats>;
+
+constexpr ConnectionRule kConnectionRules[] = {
+    {ConnectionState::Disconnected, ConnectionEvent::Connect,               ConnectionState::Connecting,   connection_actions::on_attempt},
+    {ConnectionState::Connecting,   ConnectionEvent::ConnectionEstablished, ConnectionState::Connected,    connection_actions::on_established},
+    {ConnectionState::Connecting,   ConnectionEvent::Error,                 ConnectionState::Failed,       connection_actions::on_failure},
+    {ConnectionState::Connected,    ConnectionEvent::ConnectionLost,        ConnectionState::Reconnecting, connection_actions::on_drop},
+    {ConnectionState::Connected,    ConnectionEvent::Disconnect,            ConnectionState::Disconnected, nullptr},
+    {ConnectionState::Reconnecting, ConnectionEvent::ConnectionEstablished, ConnectionState::Connected,    connection_actions::on_established},
+    {ConnectionState::Reconnecting, ConnectionEvent::Error,                 ConnectionState::Failed,       connection_actions::on_failure},
+    {ConnectionState::Failed,       ConnectionEvent::Connect,               ConnectionState::Connecting,   connection_actions::on_attempt},
+};
+
+constexpr auto kConnectionTable = make_transition_table(kConnectionRules);
+using ConnectionTable = std::remove_const_t<decltype(kConnectionTable)>;
+
+// 转换矩阵在编译期就已确定
+static_assert(kConnectionTable.cell(ConnectionState::Disconnected, ConnectionEvent::Connect).next ==
+              ConnectionTable::state_index(ConnectionState::Connecting), "转换矩阵构建错误");
+static_assert(!kConnectionTable.cell(ConnectionState::Connected, ConnectionEvent::Connect).valid(),
+              "转换矩阵构建错误");
+
 class StateMachine {
 private:
     ConnectionState current_state_;
-    std::unordered_map<std::pair<ConnectionState, ConnectionEvent>, ConnectionState, 
-                       std::hash<std::pair<int, int>>> transitions_;
+    ConnectionStats stats_;
     
-    // 自定义哈希函数的辅助结构
-    struct PairHash {
-        size_t operator()(const std::pair<ConnectionState, ConnectionEvent>& p) const {
-            auto h1 = std::hash<int>{}(static_cast<int>(p.first));
-            auto h2 = std::hash<int>{}(static_cast<int>(p.second));
-            return h1 ^ (h2 << 1);
-        }
-    };
+public:
+    StateMachine() : current_state_(ConnectionState::Disconnected) {}
     
-    std::unordered_map<std::pair<ConnectionState, ConnectionEvent>, 
-                       ConnectionState, PairHash> state_transitions_;
+    ConnectionState get_state() const { return current_state_; }
+    const ConnectionStats& stats() const { return stats_; }
     
-public:
-    StateMachine() : current_state_(ConnectionState::Disconnected) {
-        // 定义状态转换表
-        state_transitions_[{ConnectionState::Disconnected, ConnectionEvent::Connect}] = 
-            ConnectionState::Connecting;
-        state_transitions_[{ConnectionState::Connecting, ConnectionEvent::ConnectionEstablished}] = 
-            ConnectionState::Connected;
-        state_transitions_[{ConnectionState::Connecting, ConnectionEvent::Error}] = 
-            ConnectionState::Failed;
-        state_transitions_[{ConnectionState::Connected, ConnectionEvent::ConnectionLost}] = 
-            ConnectionState::Reconnecting;
-        state_transitions_[{ConnectionState::Connected, ConnectionEvent::Disconnect}] = 
-            ConnectionState::Disconnected;
-        state_transitions_[{ConnectionState::Reconnecting, ConnectionEvent::ConnectionEstablished}] = 
-            ConnectionState::Connected;
-        state_transitions_[{ConnectionState::Reconnecting, ConnectionEvent::Error}] = 
-            ConnectionState::Failed;
-        state_transitions_[{ConnectionState::Failed, ConnectionEvent::Connect}] = 
-            ConnectionState::Connecting;
+    // 热路径：一次查表，没有哈希、没有日志
+    bool on_event(ConnectionEvent event) {
+        const auto cell = kConnectionTable.cell(current_state_, event);
+        if (!cell.valid()) {
+            ++stats_.rejected;
+            return false;
+        }
+        current_state_ = ConnectionTable::to_state(cell.next);
+        if (auto action = kConnectionTable.action(cell.rule)) {
+            action(stats_);
+        }
+        return true;
     }
     
-    ConnectionState get_state() const { return current_state_; }
+    // 批量处理一段事件，返回被接受的个数；状态放在局部变量里，循环中不回写成员，
+    // 无效事件不走分支（C++20可以把参数换成std::span<const ConnectionEvent>）
+    size_t process(const ConnectionEvent* events, size_t count) {
+        ConnectionState state = current_state_;
+        size_t accepted = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const auto cell = kConnectionTable.cell(state, events[i]);
+            state = ConnectionTable::to_state(cell.next);
+            accepted += cell.valid();
+            if (auto action = kConnectionTable.action(cell.rule)) {
+                action(stats_);
+            }
+        }
+        stats_.rejected += count - accepted;
+        current_state_ = state;
+        return accepted;
+    }
     
+    template<typename Container>
+    size_t process(const Container& events) {
+        return process(events.data(), events.size());
+    }
+    
+    // 带日志的单事件处理，用于演示
     bool process_event(ConnectionEvent event) {
-        auto key = std::make_pair(current_state_, event);
-        auto it = state_transitions_.find(key);
-        
-        if (it != state_transitions_.end()) {
-            ConnectionState old_state = current_state_;
-            current_state_ = it->second;
-            
+        ConnectionState old_state = current_state_;
+        if (on_event(event)) {
             std::cout << "状态转换: " << state_to_string(old_state) 
                       << " -> " << state_to_string(current_state_)
                       << " (事件: " << event_to_string(event) << ")" << std::endl;
@@ -486,8 +625,7 @@ public:
         }
     }
     
-private:
-    std::string state_to_string(ConnectionState state) const {
+    static std::string state_to_string(ConnectionState state) {
         switch (state) {
             case ConnectionState::Disconnected: return "Disconnected";
             case ConnectionState::Connecting:   return "Connecting";
@@ -498,7 +636,7 @@ private:
         }
     }
     
-    std::string event_to_string(ConnectionEvent event) const {
+    static std::string event_to_string(ConnectionEvent event) {
         switch (event) {
             case ConnectionEvent::Connect:               return "Connect";
             case ConnectionEvent::ConnectionEstablished: return "ConnectionEstablished";
@@ -511,6 +649,78 @@ private:
     }
 };
 
+// 对比：原先的写法，unordered_map查转换、std::function做动作
+void benchmark_state_machine() {
+    struct PairHash {
+        size_t operator()(const std::pair<ConnectionState, ConnectionEvent>& p) const {
+            auto h1 = std::hash<int>{}(static_cast<int>(p.first));
+            auto h2 = std::hash<int>{}(static_cast<int>(p.second));
+            return h1 ^ (h2 << 1);
+        }
+    };
+    std::unordered_map<std::pair<ConnectionState, ConnectionEvent>,
+                       std::pair<ConnectionState, std::function<void(ConnectionStats&)>>, PairHash> hashed;
+    for (const auto& rule : kConnectionRules) {
+        std::function<void(ConnectionStats&)> action;
+        if (rule.action != nullptr) action = rule.action;
+        hashed[{rule.from, rule.event}] = {rule.to, action};
+    }
+    
+    // 模拟网关的事件流：90%是当前状态下合法的事件，其余随机
+    constexpr size_t count = 10000000;
+    std::vector<ConnectionEvent> events;
+    events.reserve(count);
+    uint64_t seed = 2024;
+    auto next_random = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(seed >> 33);
+    };
+    std::vector<ConnectionEvent> valid[ConnectionTable::kStates];
+    for (auto s = ConnectionStates::begin(); s != ConnectionStates::end(); ++s) {
+        for (auto e = ConnectionEvents::begin(); e != ConnectionEvents::end(); ++e) {
+            if (kConnectionTable.cell(*s, *e).valid()) {
+                valid[ConnectionTable::state_index(*s)].push_back(*e);
+            }
+        }
+    }
+    ConnectionState state = ConnectionState::Disconnected;
+    while (events.size() < count) {
+        const auto& choices = valid[ConnectionTable::state_index(state)];
+        ConnectionEvent event = next_random() % 10 != 0
+            ? choices[next_random() % choices.size()]
+            : static_cast<ConnectionEvent>(next_random() % ConnectionEvents::count());
+        const auto cell = kConnectionTable.cell(state, event);
+        state = ConnectionTable::to_state(cell.next);
+        events.push_back(event);
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    ConnectionStats hashed_stats;
+    ConnectionState hashed_state = ConnectionState::Disconnected;
+    for (ConnectionEvent event : events) {
+        auto it = hashed.find({hashed_state, event});
+        if (it == hashed.end()) {
+            ++hashed_stats.rejected;
+            continue;
+        }
+        hashed_state = it->second.first;
+        if (it->second.second) it->second.second(hashed_stats);
+    }
+    auto mid = std::chrono::high_resolution_clock::now();
+    StateMachine machine;
+    machine.process(events);
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto ns_per = [](std::chrono::high_resolution_clock::duration d) {
+        return std::chrono::duration<double, std::nano>(d).count() / count;
+    };
+    bool same = hashed_state == machine.get_state() && hashed_stats.rejected == machine.stats().rejected &&
+                hashed_stats.established == machine.stats().established;
+    std::cout << "处理" << count << "个事件: unordered_map+std::function " << ns_per(mid - start)
+              << " ns/个, 转换矩阵批处理 " << ns_per(end - mid) << " ns/个, 转换表 "
+              << sizeof(kConnectionTable) << " 字节, 结果" << (same ? "一致" : "不一致") << std::endl;
+}
+
 void demonstrate_state_machine_enums() {
     std::cout << "=== 状态机中的枚举应用演示 ===\n";
     
@@ -535,6 +745,32 @@ void demonstrate_state_machine_enums() {
         machine.process_event(event);
     }
     
+    // 用enum_iterator遍历整个转换矩阵
+    std::cout << "\n转换矩阵（" << ConnectionTable::kStates << "x" << ConnectionTable::kEvents << "）:\n";
+    for (auto s = ConnectionStates::begin(); s != ConnectionStates::end(); ++s) {
+        std::cout << "  " << StateMachine::state_to_string(*s) << ":";
+        for (auto e = ConnectionEvents::begin(); e != ConnectionEvents::end(); ++e) {
+            const auto cell = kConnectionTable.cell(*s, *e);
+            if (cell.valid()) {
+                std::cout << " " << StateMachine::event_to_string(*e) << "->"
+                          << StateMachine::state_to_string(ConnectionTable::to_state(cell.next));
+            }
+        }
+        std::cout << std::endl;
+    }
+    
+    // 批量处理：一次传入一整段事件
+    StateMachine batch_machine;
+    std::vector<ConnectionEvent> packet_events(events.begin(), events.end());
+    size_t accepted = batch_machine.process(packet_events);
+    const ConnectionStats& stats = batch_machine.stats();
+    std::cout << "批量处理" << packet_events.size() << "个事件: 接受" << accepted
+              << ", 尝试连接" << stats.attempts << ", 建立" << stats.established
+              << ", 断开" << stats.drops << ", 失败" << stats.failures
+              << ", 拒绝" << stats.rejected << std::endl;
+    
+    benchmark_state_machine();
+    
     std::cout << "\n";
 }
 
@@ -714,10 +950,13 @@ g++ -std=c++11 -O2 -Wall 10_scoped_enums.cpp -o scoped_enums_demo
 6. 理解枚举在模板编程中的类型检测
 7. 学会枚举相关的最佳实践和迁移策略
 8. 避免常见的枚举使用陷阱
+9. 连续的小枚举可以直接作为数组下标，用constexpr构建转换矩阵替代哈希表查找
 
 注意事项:
 - 优先使用enum class获得类型安全
 - 根据取值范围选择合适的底层类型
 - 为复杂应用场景设计配套的实用函数
 - 注意编译器优化对枚举性能的影响
+- 转换矩阵依赖枚举值连续；插入带显式取值的枚举成员会让矩阵变稀疏甚至越界
+- TransitionTable的constexpr构建用到C++14的宽松constexpr和index_sequence
 */
\ No newline at end of file
@@ -18,6 +18,8 @@
 #include <chrono>
 #include <map>
 
+#include "../common/micro_bench.h"
+
 // ===== 1. C++11尾置返回类型的限制回顾 =====
 
 // C++11方式：繁琐的尾置返回类型
@@ -501,20 +503,14 @@ struct CompileTimeTest {
     }
 };
 
-// 运行时性能对比
+// 运行时性能对比：单次计时受调度和升频影响太大，交给统一基准框架预热并重复采样
 class PerformanceAnalyzer {
 public:
     template<typename Func>
-    static auto measure_execution(Func&& func, int iterations = 1000000) {
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        for (int i = 0; i < iterations; ++i) {
-            volatile auto result = func();
-            (void)result;  // 防止优化
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    static micro_bench::BenchmarkResult measure_execution(const std::string& name, Func&& func) {
+        return micro_bench::measure(name, [&func]() {
+            micro_bench::do_not_optimize(func());  // 防止优化
+        });
     }
 };
 
@@ -530,14 +526,10 @@ void demonstrate_performance_analysis() {
     auto auto_return = []() { return 42; };
     auto decltype_auto_return = []() -> decltype(auto) { return 42; };
     
-    auto explicit_time = PerformanceAnalyzer::measure_execution(explicit_return);
-    auto auto_time = PerformanceAnalyzer::measure_execution(auto_return);
-    auto decltype_auto_time = PerformanceAnalyzer::measure_execution(decltype_auto_return);
-    
-    std::cout << "性能测试结果 (1M次调用):\n";
-    std::cout << "显式返回类型: " << explicit_time.count() << "μs\n";
-    std::cout << "auto返回类型: " << auto_time.count() << "μs\n";
-    std::cout << "decltype(auto): " << decltype_auto_time.count() << "μs\n";
+    std::cout << "性能测试结果 (每次调用，中位数与95%置信区间):\n";
+    micro_bench::print_result(std::cout, PerformanceAnalyzer::measure_execution("显式返回类型", explicit_return));
+    micro_bench::print_result(std::cout, PerformanceAnalyzer::measure_execution("auto返回类型", auto_return));
+    micro_bench::print_result(std::cout, PerformanceAnalyzer::measure_execution("decltype(auto)", decltype_auto_return));
     
     std::cout << "\n最佳实践总结:\n";
     std::cout << "✓ 简单情况优先使用auto\n";
@@ -563,7 +555,8 @@ void demonstrate_performance_analysis() {
 
 // ===== 主函数 =====
 
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++14 函数返回类型推导深度解析\n";
     std::cout << "===============================\n";
     
@@ -20,6 +20,8 @@
 #include <thread>
 #include <atomic>
 
+#include "../common/micro_bench.h"
+
 // ===== 1. C++11 Lambda捕获的限制回顾 =====
 
 void demonstrate_cpp11_capture_limitations() {
@@ -556,32 +558,22 @@ void demonstrate_closure_memory_layout() {
 
 // ===== 7. 性能分析和最佳实践 =====
 
+// 创建/执行开销都在纳秒级，单次计时没有意义：交给统一基准框架预热、重复采样并报告中位数
 class PerformanceBenchmark {
 public:
     template<typename Func>
-    static auto measure_lambda_creation(Func&& factory, int iterations = 1000000) {
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        for (int i = 0; i < iterations; ++i) {
-            volatile auto lambda = factory();
-            (void)lambda;  // 防止优化掉
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    static micro_bench::BenchmarkResult measure_lambda_creation(const std::string& name, Func&& factory) {
+        return micro_bench::measure(name, [&factory]() {
+            auto lambda = factory();
+            micro_bench::do_not_optimize(lambda);  // 防止优化掉
+        });
     }
     
     template<typename Lambda>
-    static auto measure_lambda_execution(Lambda&& lambda, int iterations = 1000000) {
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        for (int i = 0; i < iterations; ++i) {
-            volatile auto result = lambda();
-            (void)result;
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    static micro_bench::BenchmarkResult measure_lambda_execution(const std::string& name, Lambda&& lambda) {
+        return micro_bench::measure(name, [&lambda]() {
+            micro_bench::do_not_optimize(lambda());
+        });
     }
 };
 
@@ -591,7 +583,7 @@ void demonstrate_performance_best_practices() {
     std::vector<int> data(1000, 42);
     
     // 对比不同捕获方式的性能
-    std::cout << "Lambda创建性能测试 (1M次):\n";
+    std::cout << "Lambda创建性能测试 (每次创建):\n";
     
     // 按值捕获大对象
     auto value_capture_factory = [&data]() {
@@ -608,33 +600,28 @@ void demonstrate_performance_best_practices() {
         return [size = data.size()](){ return size; };  // 只捕获需要的值
     };
     
-    auto value_time = PerformanceBenchmark::measure_lambda_creation(value_capture_factory);
-    auto ref_time = PerformanceBenchmark::measure_lambda_creation(ref_capture_factory);
-    auto move_time = PerformanceBenchmark::measure_lambda_creation(move_capture_factory);
-    
-    std::cout << "按值捕获创建时间: " << value_time.count() << " ns\n";
-    std::cout << "引用捕获创建时间: " << ref_time.count() << " ns\n";
-    std::cout << "优化捕获创建时间: " << move_time.count() << " ns\n";
+    micro_bench::print_result(std::cout, PerformanceBenchmark::measure_lambda_creation("按值捕获创建", value_capture_factory));
+    micro_bench::print_result(std::cout, PerformanceBenchmark::measure_lambda_creation("引用捕获创建", ref_capture_factory));
+    micro_bench::print_result(std::cout, PerformanceBenchmark::measure_lambda_creation("优化捕获创建", move_capture_factory));
     
     // Lambda执行性能测试
-    std::cout << "\nLambda执行性能测试 (1M次):\n";
+    std::cout << "\nLambda执行性能测试 (每次调用):\n";
     
     auto value_lambda = [data](){ return std::accumulate(data.begin(), data.end(), 0); };
     auto ref_lambda = [&data](){ return std::accumulate(data.begin(), data.end(), 0); };
     
-    auto value_exec_time = PerformanceBenchmark::measure_lambda_execution(value_lambda);
-    auto ref_exec_time = PerformanceBenchmark::measure_lambda_execution(ref_lambda);
-    
-    std::cout << "按值捕获执行时间: " << value_exec_time.count() << " ns\n";
-    std::cout << "引用捕获执行时间: " << ref_exec_time.count() << " ns\n";
+    micro_bench::print_result(std::cout, PerformanceBenchmark::measure_lambda_execution("按值捕获执行", value_lambda));
+    micro_bench::print_result(std::cout, PerformanceBenchmark::measure_lambda_execution("引用捕获执行", ref_lambda));
     
     // 复杂初始化捕获的开销
     std::cout << "\n初始化捕获开销分析:\n";
     
     auto expensive_init_factory = []() {
         return [
-            expensive_calc = std::accumulate(std::vector<int>(1000, 1).begin(), 
-                                           std::vector<int>(1000, 1).end(), 0),
+            expensive_calc = [] {
+                std::vector<int> ones(1000, 1);  // 两个迭代器必须来自同一个容器
+                return std::accumulate(ones.begin(), ones.end(), 0);
+            }(),
             timestamp = std::chrono::high_resolution_clock::now()
         ](){
             return expensive_calc;
@@ -645,11 +632,8 @@ void demonstrate_performance_best_practices() {
         return [](){ return 42000; };
     };
     
-    auto expensive_time = PerformanceBenchmark::measure_lambda_creation(expensive_init_factory, 10000);
-    auto simple_time = PerformanceBenchmark::measure_lambda_creation(simple_factory, 10000);
-    
-    std::cout << "复杂初始化捕获时间: " << expensive_time.count() << " ns\n";
-    std::cout << "简单Lambda创建时间: " << simple_time.count() << " ns\n";
+    micro_bench::print_result(std::cout, PerformanceBenchmark::measure_lambda_creation("复杂初始化捕获", expensive_init_factory));
+    micro_bench::print_result(std::cout, PerformanceBenchmark::measure_lambda_creation("简单Lambda创建", simple_factory));
     
     std::cout << "\n最佳实践总结:\n";
     std::cout << "✓ 优先使用移动捕获减少拷贝开销\n";
@@ -670,7 +654,8 @@ void demonstrate_performance_best_practices() {
 
 // ===== 主函数 =====
 
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++14 广义Lambda捕获深度解析\n";
     std::cout << "=============================\n";
     
@@ -18,6 +18,8 @@
 #include <complex>
 #include <limits>
 
+#include "../common/micro_bench.h"
+
 // ===== 1. C++11类型特征的冗长语法回顾 =====
 
 void demonstrate_cpp11_type_traits_verbosity() {
@@ -474,21 +476,14 @@ void demonstrate_configuration_system() {
 
 // ===== 7. 性能分析和最佳实践 =====
 
-// 性能测试模板
-template<size_t Iterations>
+// 性能测试：单次调用只有零点几纳秒，由统一基准框架标定每个样本的调用次数并重复采样
 class PerformanceTester {
 public:
     template<typename Func>
-    static auto measure(Func&& func) {
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        for (size_t i = 0; i < Iterations; ++i) {
-            volatile auto result = func();
-            (void)result;
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    static micro_bench::BenchmarkResult measure(const std::string& name, Func&& func) {
+        return micro_bench::measure(name, [&func]() {
+            micro_bench::do_not_optimize(func());
+        });
     }
 };
 
@@ -500,22 +495,16 @@ constexpr double runtime_pi() {
 void demonstrate_performance_best_practices() {
     std::cout << "=== 性能分析和最佳实践 ===\n";
     
-    constexpr size_t test_iterations = 10000000;
-    
     // 常量访问性能对比
-    std::cout << "常量访问性能测试 (" << test_iterations << "次):\n";
+    std::cout << "常量访问性能测试 (每次调用):\n";
     
     auto compile_time_test = []() { return pi_v<double>; };
     auto runtime_test = []() { return runtime_pi(); };
     auto literal_test = []() { return 3.14159265358979323846; };
     
-    auto compile_time_result = PerformanceTester<test_iterations>::measure(compile_time_test);
-    auto runtime_time_result = PerformanceTester<test_iterations>::measure(runtime_test);
-    auto literal_time_result = PerformanceTester<test_iterations>::measure(literal_test);
-    
-    std::cout << "编译期常量: " << compile_time_result.count() << " ns\n";
-    std::cout << "运行时函数: " << runtime_time_result.count() << " ns\n";
-    std::cout << "字面量: " << literal_time_result.count() << " ns\n";
+    micro_bench::print_result(std::cout, PerformanceTester::measure("编译期常量", compile_time_test));
+    micro_bench::print_result(std::cout, PerformanceTester::measure("运行时函数", runtime_test));
+    micro_bench::print_result(std::cout, PerformanceTester::measure("字面量", literal_test));
     
     // 类型特征性能对比
     std::cout << "\n类型特征性能测试:\n";
@@ -528,11 +517,8 @@ void demonstrate_performance_best_practices() {
         return is_integral_v<int> && is_arithmetic_v<double>; 
     };
     
-    auto old_time = PerformanceTester<test_iterations>::measure(old_trait_test);
-    auto new_time = PerformanceTester<test_iterations>::measure(new_trait_test);
-    
-    std::cout << "传统类型特征: " << old_time.count() << " ns\n";
-    std::cout << "变量模板: " << new_time.count() << " ns\n";
+    micro_bench::print_result(std::cout, PerformanceTester::measure("传统类型特征", old_trait_test));
+    micro_bench::print_result(std::cout, PerformanceTester::measure("变量模板", new_trait_test));
     
     std::cout << "\n编译时间影响分析:\n";
     std::cout << "• 变量模板减少了模板实例化复杂度\n";
@@ -557,7 +543,8 @@ void demonstrate_performance_best_practices() {
 
 // ===== 主函数 =====
 
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++14 变量模板深度解析\n";
     std::cout << "=======================\n";
     
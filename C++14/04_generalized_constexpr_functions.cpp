@@ -10,6 +10,7 @@
  * 3. 控制流 - 支持if/switch/for/while等控制结构
  * 4. 成员函数 - constexpr成员函数可以修改对象状态
  * 5. 更复杂的算法 - 支持递归以外的算法实现方式
+ * 6. 编译期与运行时共用 - 同一个constexpr哈希函数既用于编译期完美哈希，也用于运行时Swiss表
  */
 
 #include <iostream>
@@ -17,6 +18,24 @@
 #include <string_view>
 #include <chrono>
 #include <cmath>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <random>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../common/byte_hash.h"
+#include "../common/micro_bench.h"
 
 namespace cpp14_constexpr {
 
@@ -339,17 +358,10 @@ constexpr bool simple_wildcard_match(const char* pattern, const char* text) {
 
 template<typename Func>
 void benchmark_constexpr(const char* name, Func&& func) {
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    constexpr int iterations = 1000000;
-    for (int i = 0; i < iterations; ++i) {
-        func();
-    }
-    
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-    
-    std::cout << name << ": " << duration.count() / iterations << " ns per call\n";
+    // 预热后重复采样，报告每次调用的中位耗时与95%置信区间
+    micro_bench::print_result(std::cout, micro_bench::measure(name, [&func]() {
+        micro_bench::do_not_optimize(func());
+    }));
 }
 
 void demonstrate_constexpr_benefits() {
@@ -389,6 +401,393 @@ void demonstrate_constexpr_benefits() {
     std::cout << "通配符匹配: test* vs testing.txt -> " << (match2 ? "匹配" : "不匹配") << "\n";
 }
 
+// ===== 运行时Swiss表与编译期完美哈希 =====
+// ConstexprHashMap只能在编译期装入const char*键；运行时热路径需要的是：
+// 1. SwissMap：开放寻址，控制字节与槽位各自连续存放，SIMD一次比较16个控制字节
+// 2. 透明查找：find(std::string_view)不用构造临时std::string
+// 3. PerfectHashMap：键在编译期已知时，constexpr搜索一个无冲突的种子，查找只算一次哈希、比一次键
+
+// load_le/mix64/hash_bytes定义在common/byte_hash.h，C++20的static_string_map共用同一份实现
+using byte_hash::hash_bytes;
+using byte_hash::mix64;
+
+// 默认哈希：字符串类型统一按string_view处理，所以string和string_view的哈希值相同
+struct swiss_hash {
+    using is_transparent = void;
+    uint64_t operator()(std::string_view s) const { return hash_bytes(s); }
+    uint64_t operator()(const std::string& s) const { return hash_bytes(s); }
+    uint64_t operator()(const char* s) const { return hash_bytes(s); }
+    uint64_t operator()(uint64_t v) const { return mix64(v + 0x9e3779b97f4a7c15ULL); }
+};
+
+template<typename Key, typename Value, typename Hash = swiss_hash, typename KeyEqual = std::equal_to<>>
+class SwissMap {
+public:
+    using value_type = std::pair<Key, Value>;
+
+private:
+    static constexpr size_t kGroupWidth = 16;
+    // 控制字节：空为0x80，墓碑为0xFE，满槽存哈希的低7位（最高位为0）
+    static constexpr int8_t kEmpty = -128;
+    static constexpr int8_t kDeleted = -2;
+    static constexpr size_t kNotFound = ~size_t{0};
+
+    // 一组16个控制字节；返回的掩码第i位对应组内第i个槽
+    struct Group {
+        const int8_t* ctrl;
+
+        uint32_t match(int8_t h2) const {
+#if defined(__SSE2__)
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(h2))));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < kGroupWidth; ++i) mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+            return mask;
+#endif
+        }
+
+        uint32_t match_empty() const { return match(kEmpty); }
+
+        // 空槽和墓碑的最高位都是1，满槽为0
+        uint32_t match_empty_or_deleted() const {
+#if defined(__SSE2__)
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+            return static_cast<uint32_t>(_mm_movemask_epi8(v));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < kGroupWidth; ++i) mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+            return mask;
+#endif
+        }
+    };
+
+    std::unique_ptr<int8_t[]> ctrl_;  // capacity_ + kGroupWidth字节，末尾镜像开头一组，加载组时无需回绕
+    std::unique_ptr<value_type[]> slots_;
+    size_t capacity_ = 0;  // 2的幂，至少kGroupWidth
+    size_t size_ = 0;
+    size_t growth_left_ = 0;  // 最大负载7/8，墓碑也占用这部分额度
+    Hash hash_;
+    KeyEqual eq_;
+
+    static int8_t h2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+    size_t h1(uint64_t hash) const { return static_cast<size_t>(hash >> 7) & (capacity_ - 1); }
+
+    void set_ctrl(size_t index, int8_t value) {
+        ctrl_[index] = value;
+        if (index < kGroupWidth) ctrl_[capacity_ + index] = value;
+    }
+
+    template<typename K>
+    size_t find_index(const K& key, uint64_t hash) const {
+        if (capacity_ == 0) return kNotFound;
+        const size_t mask = capacity_ - 1;
+        size_t pos = h1(hash);
+        for (size_t step = kGroupWidth;; step += kGroupWidth) {
+            Group group{ctrl_.get() + pos};
+            for (uint32_t bits = group.match(h2(hash)); bits; bits &= bits - 1) {
+                size_t index = (pos + static_cast<size_t>(__builtin_ctz(bits))) & mask;
+                if (eq_(slots_[index].first, key)) return index;
+            }
+            if (group.match_empty()) return kNotFound;
+            pos = (pos + step) & mask;  // 按组做三角探测，能遍历所有位置
+        }
+    }
+
+    size_t find_insert_slot(uint64_t hash) const {
+        const size_t mask = capacity_ - 1;
+        size_t pos = h1(hash);
+        for (size_t step = kGroupWidth;; step += kGroupWidth) {
+            uint32_t bits = Group{ctrl_.get() + pos}.match_empty_or_deleted();
+            if (bits) return (pos + static_cast<size_t>(__builtin_ctz(bits))) & mask;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    void rehash(size_t new_capacity) {
+        std::unique_ptr<int8_t[]> old_ctrl = std::move(ctrl_);
+        std::unique_ptr<value_type[]> old_slots = std::move(slots_);
+        const size_t old_capacity = capacity_;
+
+        capacity_ = new_capacity;
+        ctrl_.reset(new int8_t[capacity_ + kGroupWidth]);
+        std::fill_n(ctrl_.get(), capacity_ + kGroupWidth, kEmpty);
+        slots_.reset(new value_type[capacity_]);
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] < 0) continue;
+            uint64_t hash = hash_(old_slots[i].first);
+            size_t index = find_insert_slot(hash);
+            set_ctrl(index, h2(hash));
+            slots_[index] = std::move(old_slots[i]);
+        }
+        growth_left_ = capacity_ - capacity_ / 8 - size_;
+    }
+
+    void prepare_insert() {
+        if (growth_left_ > 0) return;
+        // 墓碑较多时原容量重建即可回收空间，否则翻倍
+        if (capacity_ != 0 && size_ <= capacity_ * 7 / 16) {
+            rehash(capacity_);
+        } else {
+            rehash(capacity_ == 0 ? kGroupWidth : capacity_ * 2);
+        }
+    }
+
+public:
+    SwissMap() = default;
+
+    void reserve(size_t count) {
+        size_t needed = kGroupWidth;
+        while (needed - needed / 8 < count) needed *= 2;
+        if (needed > capacity_) rehash(needed);
+    }
+
+    // 键已存在时不覆盖，返回false
+    template<typename K, typename V>
+    bool insert(K&& key, V&& value) {
+        uint64_t hash = hash_(key);
+        if (find_index(key, hash) != kNotFound) return false;
+        prepare_insert();
+        size_t index = find_insert_slot(hash);
+        if (ctrl_[index] == kEmpty) --growth_left_;
+        set_ctrl(index, h2(hash));
+        slots_[index] = value_type(std::forward<K>(key), std::forward<V>(value));
+        ++size_;
+        return true;
+    }
+
+    template<typename K>
+    Value& operator[](const K& key) {
+        uint64_t hash = hash_(key);
+        size_t index = find_index(key, hash);
+        if (index == kNotFound) {
+            insert(Key(key), Value{});
+            index = find_index(key, hash);
+        }
+        return slots_[index].second;
+    }
+
+    template<typename K>
+    const Value* find(const K& key) const {
+        size_t index = find_index(key, hash_(key));
+        return index == kNotFound ? nullptr : &slots_[index].second;
+    }
+
+    template<typename K>
+    Value* find(const K& key) {
+        size_t index = find_index(key, hash_(key));
+        return index == kNotFound ? nullptr : &slots_[index].second;
+    }
+
+    template<typename K>
+    bool contains(const K& key) const { return find(key) != nullptr; }
+
+    template<typename K>
+    bool erase(const K& key) {
+        size_t index = find_index(key, hash_(key));
+        if (index == kNotFound) return false;
+        set_ctrl(index, kDeleted);
+        slots_[index] = value_type{};
+        --size_;
+        return true;
+    }
+
+    template<typename Func>
+    void for_each(Func&& func) const {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (ctrl_[i] >= 0) func(slots_[i].first, slots_[i].second);
+        }
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+};
+
+// 编译期完美哈希：槽位数取不小于4N的2的幂，逐个尝试种子直到所有键落在不同槽位
+// 负载不超过1/4时，N=16大约十次以内就能找到种子
+template<typename Value, size_t N>
+class PerfectHashMap {
+private:
+    static constexpr size_t slot_count() {
+        size_t slots = 1;
+        while (slots < N * 4) slots *= 2;
+        return slots;
+    }
+    static constexpr size_t kSlots = slot_count();
+    static constexpr uint64_t kMaxSeeds = 1 << 16;
+
+    struct Slot {
+        std::string_view key;
+        Value value{};
+        bool used = false;
+    };
+
+    std::array<Slot, kSlots> slots_{};
+    uint64_t seed_ = 0;
+
+    constexpr size_t slot_of(std::string_view key, uint64_t seed) const {
+        return static_cast<size_t>(hash_bytes(key, seed)) & (kSlots - 1);
+    }
+
+public:
+    constexpr explicit PerfectHashMap(const std::pair<std::string_view, Value> (&entries)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = i + 1; j < N; ++j) {
+                if (entries[i].first == entries[j].first) throw std::logic_error("PerfectHashMap: 重复的键");
+            }
+        }
+        for (uint64_t seed = 1; seed < kMaxSeeds; ++seed) {
+            std::array<bool, kSlots> taken{};
+            bool ok = true;
+            for (size_t i = 0; i < N && ok; ++i) {
+                size_t slot = slot_of(entries[i].first, seed);
+                ok = !taken[slot];
+                taken[slot] = true;
+            }
+            if (!ok) continue;
+            seed_ = seed;
+            for (size_t i = 0; i < N; ++i) {
+                Slot& slot = slots_[slot_of(entries[i].first, seed)];
+                slot.key = entries[i].first;
+                slot.value = entries[i].second;
+                slot.used = true;
+            }
+            return;
+        }
+        throw std::logic_error("PerfectHashMap: 找不到无冲突的种子");
+    }
+
+    // 不探测：算一次哈希，比较一次键
+    constexpr const Value* find(std::string_view key) const {
+        const Slot& slot = slots_[slot_of(key, seed_)];
+        return (slot.used && slot.key == key) ? &slot.value : nullptr;
+    }
+
+    constexpr Value get(std::string_view key, Value fallback) const {
+        const Value* value = find(key);
+        return value ? *value : fallback;
+    }
+
+    constexpr uint64_t seed() const { return seed_; }
+    static constexpr size_t size() { return N; }
+    static constexpr size_t slots() { return kSlots; }
+};
+
+template<typename Value, size_t N>
+constexpr PerfectHashMap<Value, N> make_perfect_map(const std::pair<std::string_view, Value> (&entries)[N]) {
+    return PerfectHashMap<Value, N>(entries);
+}
+
+// 与create_config_map相同的配置，键在编译期已知
+constexpr auto create_perfect_config() {
+    return make_perfect_map<int>({
+        {"max_connections", 1000},
+        {"timeout_ms", 5000},
+        {"buffer_size", 8192},
+        {"thread_pool_size", 8},
+    });
+}
+
+template<typename Map, typename Query>
+[[gnu::noinline]] long long lookup_all(const Map& map, const std::vector<Query>& queries) {
+    long long sum = 0;
+    for (const auto& q : queries) {
+        auto it = map.find(q);
+        if (it != map.end()) sum += it->second;
+    }
+    return sum;
+}
+
+template<typename Map, typename Query>
+[[gnu::noinline]] long long lookup_all_ptr(const Map& map, const std::vector<Query>& queries) {
+    long long sum = 0;
+    for (const auto& q : queries) {
+        if (const auto* value = map.find(q)) sum += *value;
+    }
+    return sum;
+}
+
+void demonstrate_swiss_table() {
+    std::cout << "\n===== 运行时Swiss表与编译期完美哈希 =====\n";
+
+    constexpr auto config = create_perfect_config();
+    static_assert(config.get("timeout_ms", -1) == 5000, "编译期查找");
+    static_assert(config.find("missing") == nullptr, "编译期查找");
+    std::cout << "完美哈希配置: " << config.size() << " 个键 / " << config.slots() << " 个槽, 种子 " << config.seed()
+              << ", buffer_size = " << config.get("buffer_size", -1) << "\n";
+
+    SwissMap<std::string, int> routes;
+    routes.insert(std::string("/index"), 1);
+    routes.insert(std::string("/login"), 2);
+    routes["/logout"] = 3;
+    std::string_view request_path = "/login?user=alice";
+    request_path = request_path.substr(0, request_path.find('?'));
+    const int* route = routes.find(request_path);  // 透明查找，不构造std::string
+    std::cout << "透明查找 " << request_path << " -> " << (route ? *route : -1)
+              << ", 删除/index后大小 " << (routes.erase("/index"), routes.size()) << "\n";
+
+    auto time_ms = [](auto&& f) {
+        double best = 1e300;
+        long long result = 0;
+        for (int rep = 0; rep < 3; ++rep) {
+            auto start = std::chrono::steady_clock::now();
+            result = f();
+            best = std::min(best, std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+        return std::make_pair(best, result);
+    };
+
+    // 字符串键查找：一半命中
+    std::mt19937_64 rng(7);
+    const size_t lookups = 2'000'000;
+    std::cout << "\n字符串键  unordered_map  SwissMap   (ms/" << lookups << "次查找)\n";
+    for (size_t n : {size_t{1'000}, size_t{100'000}, size_t{1'000'000}}) {
+        std::vector<std::string> keys(2 * n);
+        for (size_t i = 0; i < 2 * n; ++i) keys[i] = "user:" + std::to_string(rng() % 100'000'000) + ":" + std::to_string(i);
+        std::unordered_map<std::string, int> std_map;
+        SwissMap<std::string, int> swiss;
+        swiss.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            std_map.emplace(keys[i], static_cast<int>(i));
+            swiss.insert(keys[i], static_cast<int>(i));
+        }
+        std::vector<std::string> queries(lookups);
+        std::vector<std::string_view> views(lookups);
+        for (size_t i = 0; i < lookups; ++i) {
+            queries[i] = keys[rng() % (2 * n)];
+            views[i] = queries[i];
+        }
+        auto std_result = time_ms([&] { return lookup_all(std_map, queries); });
+        auto swiss_result = time_ms([&] { return lookup_all_ptr(swiss, views); });
+        std::cout << std::left << std::setw(10) << n << std::right << std::setw(14) << std_result.first
+                  << std::setw(11) << swiss_result.first << " (" << std_result.first / swiss_result.first << "x)"
+                  << (std_result.second == swiss_result.second ? "" : " 结果不一致!") << "\n";
+    }
+
+    // 固定的少量配置键：完美哈希不探测
+    std::unordered_map<std::string, int> std_config{
+        {"max_connections", 1000}, {"timeout_ms", 5000}, {"buffer_size", 8192}, {"thread_pool_size", 8}};
+    SwissMap<std::string, int> swiss_config;
+    for (const auto& kv : std_config) swiss_config.insert(kv.first, kv.second);
+    const char* names[] = {"max_connections", "timeout_ms", "buffer_size", "thread_pool_size", "log_level"};
+    std::vector<std::string> config_queries(lookups);
+    std::vector<std::string_view> config_views(lookups);
+    for (size_t i = 0; i < lookups; ++i) {
+        config_queries[i] = names[rng() % 5];
+        config_views[i] = config_queries[i];
+    }
+    auto std_config_result = time_ms([&] { return lookup_all(std_config, config_queries); });
+    auto swiss_config_result = time_ms([&] { return lookup_all_ptr(swiss_config, config_views); });
+    auto perfect_result = time_ms([&] { return lookup_all_ptr(config, config_views); });
+    std::cout << "配置键(4个): unordered_map " << std_config_result.first << " ms, SwissMap "
+              << swiss_config_result.first << " ms, 完美哈希 " << perfect_result.first << " ms"
+              << (std_config_result.second == perfect_result.second && std_config_result.second == swiss_config_result.second
+                      ? "" : " 结果不一致!")
+              << "\n";
+}
+
 // ===== 设计原理和最佳实践 =====
 
 /*
@@ -424,6 +823,7 @@ void demonstrate_constexpr_benefits() {
  * 3. 可维护性
  *    - constexpr函数也要考虑可读性
  *    - 提供非constexpr版本作为运行时备选
+ *    - 编译期和运行时共用的函数必须保证两条路径结果一致（如hash_bytes的字节序）
  *    - 适当的单元测试验证正确性
  */
 
@@ -456,7 +856,8 @@ void demonstrate_constexpr_benefits() {
  *    - 递归深度限制（通常512-1024层）
  */
 
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "=== C++14 广义constexpr函数示例 ===\n";
     
     cpp14_constexpr::demonstrate_constexpr_benefits();
@@ -472,5 +873,7 @@ int main() {
     constexpr bool same = cpp14_constexpr::constexpr_strcmp("test", "test");
     std::cout << "字符串比较: " << (same ? "相等" : "不相等") << "\n";
     
+    cpp14_constexpr::demonstrate_swiss_table();
+    
     return 0;
 }
\ No newline at end of file
@@ -10,6 +10,9 @@
  * - 大型数值常量的可读性和维护性
  * - 硬件寄存器配置的准确性
  * - 二进制协议和文件格式处理
+ * 
+ * 在此基础上演示批量报文解析：pshufb换字节序并转置成列存储，
+ * 子网(CIDR)匹配和位模式分类一次比较4个值
  */
 
 #include <iostream>
@@ -19,6 +22,16 @@
 #include <string>
 #include <type_traits>
 #include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "../common/micro_bench.h"
 
 namespace cpp14_literals {
 
@@ -324,50 +337,473 @@ using RTypeInstr = BitPatternMatcher<0b0000000'00000'00000'000'00000'0110011, 0b
 using ITypeInstr = BitPatternMatcher<0b000000000000'00000'000'00000'0010011, 0b000000000000'00000'111'00000'1111111>;
 using LoadInstr  = BitPatternMatcher<0b000000000000'00000'000'00000'0000011, 0b000000000000'00000'111'00000'1111111>;
 
+// ===== 批量报文解析：SIMD解码、子网匹配与模式分类 =====
+
+// 抓包口送来的一帧原始数据
+struct FrameRef {
+    const uint8_t* data;
+    uint16_t length;
+};
+
+// 解码结果按字段分开存放(SoA)：后续的过滤/统计只需扫描用到的那几列
+struct PacketColumns {
+    static constexpr uint8_t FLAG_IPV4  = 0b01;
+    static constexpr uint8_t FLAG_PORTS = 0b10;  // TCP/UDP首个分片，端口有效
+    
+    std::vector<uint32_t> src_ip;
+    std::vector<uint32_t> dst_ip;
+    std::vector<uint16_t> src_port;
+    std::vector<uint16_t> dst_port;
+    std::vector<uint16_t> ethertype;
+    std::vector<uint8_t> protocol;
+    std::vector<uint8_t> flags;
+    size_t count = 0;
+    
+    // 列长度向上取整到4，SIMD路径可以整块写入；容量在批次之间复用
+    void reset(size_t n) {
+        count = n;
+        const size_t padded = (n + 3) & ~size_t(3);
+        src_ip.resize(padded);
+        dst_ip.resize(padded);
+        src_port.resize(padded);
+        dst_port.resize(padded);
+        ethertype.resize(padded);
+        protocol.resize(padded);
+        flags.resize(padded);
+    }
+};
+
+namespace PacketDecode {
+    constexpr uint16_t TYPE_VLAN = 0x8100;
+    constexpr uint8_t PROTO_TCP = 6;
+    constexpr uint8_t PROTO_UDP = 17;
+    constexpr size_t FAST_PATH_MIN_LENGTH = 42;  // 以太网14 + IPv4 20 + 端口4 + 向量加载越过的4字节
+    
+    inline uint16_t load_be16(const uint8_t* p) {
+        return static_cast<uint16_t>((p[0] << 8) | p[1]);
+    }
+    
+    inline uint32_t load_be32(const uint8_t* p) {
+        return IPv4Address(p[0], p[1], p[2], p[3]).get_raw();
+    }
+    
+    // 逐个解码：处理VLAN标签、IPv4选项和分片，所有读取都检查长度
+    inline void decode_one(const FrameRef& frame, PacketColumns& out, size_t i) {
+        out.src_ip[i] = out.dst_ip[i] = 0;
+        out.src_port[i] = out.dst_port[i] = 0;
+        out.ethertype[i] = 0;
+        out.protocol[i] = 0;
+        out.flags[i] = 0;
+        
+        EthernetHeader eth;
+        if (frame.length < sizeof(EthernetHeader)) return;
+        std::memcpy(&eth, frame.data, sizeof(EthernetHeader));
+        size_t offset = sizeof(EthernetHeader);
+        uint16_t type = load_be16(reinterpret_cast<const uint8_t*>(&eth.ethertype));
+        if (type == TYPE_VLAN && frame.length >= offset + 4) {
+            type = load_be16(frame.data + offset + 2);
+            offset += 4;
+        }
+        out.ethertype[i] = type;
+        if (type != EthernetHeader::TYPE_IPV4 || frame.length < offset + 20) return;
+        
+        const uint8_t* ip = frame.data + offset;
+        const size_t header_length = (ip[0] & 0x0F) * 4u;
+        if ((ip[0] >> 4) != 4 || header_length < 20 || frame.length < offset + header_length) return;
+        out.flags[i] = PacketColumns::FLAG_IPV4;
+        out.protocol[i] = ip[9];
+        out.src_ip[i] = load_be32(ip + 12);
+        out.dst_ip[i] = load_be32(ip + 16);
+        
+        const bool first_fragment = (load_be16(ip + 6) & 0x1FFF) == 0;
+        const bool has_ports = ip[9] == PROTO_TCP || ip[9] == PROTO_UDP;
+        if (first_fragment && has_ports && frame.length >= offset + header_length + 4) {
+            out.src_port[i] = load_be16(ip + header_length);
+            out.dst_port[i] = load_be16(ip + header_length + 2);
+            out.flags[i] |= PacketColumns::FLAG_PORTS;
+        }
+    }
+    
+    inline void decode_scalar(const FrameRef* frames, size_t n, PacketColumns& out) {
+        out.reset(n);
+        for (size_t i = 0; i < n; ++i) {
+            decode_one(frames[i], out, i);
+        }
+    }
+    
+#if defined(__SSSE3__)
+    // 快速路径：无VLAN、IHL=5、未分片的TCP/UDP。每帧两次16字节加载(偏移12和26)，
+    // pshufb把需要的字节换成小端并排成一行[src, dst, ports, check]，4帧一组做4x4转置，
+    // 每一列一次写入；不满足快速路径条件的帧回退到decode_one
+    inline void decode_simd(const FrameRef* frames, size_t n, PacketColumns& out) {
+        out.reset(n);
+        // 偏移26的加载：0-3源地址，4-7目的地址，8-9源端口，10-11目的端口
+        const __m128i from_addr = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                                                -128, -128, -128, -128);
+        // 偏移12的加载：2版本/IHL，8-9标志/分片偏移，11协议
+        const __m128i from_header = _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128,
+                                                  -128, -128, -128, -128, 2, 8, 9, 11);
+        const __m128i low_halves = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128);
+        const __m128i high_halves = _mm_setr_epi8(2, 3, 6, 7, 10, 11, 14, 15, -128, -128, -128, -128, -128, -128, -128, -128);
+        const __m128i top_bytes = _mm_setr_epi8(3, 7, 11, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128);
+        const __m128i check_mask = _mm_set1_epi32(0x00FF1FFF);  // IHL字节 + 分片偏移
+        const __m128i check_value = _mm_set1_epi32(0x00000045);
+        const __m128i tcp = _mm_set1_epi32(PROTO_TCP);
+        const __m128i udp = _mm_set1_epi32(PROTO_UDP);
+        const uint16_t ipv4_le = 0x0008;  // 网络序0x0800按小端读出的值
+        
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const FrameRef* f = frames + i;
+            bool loadable = true;
+            int ipv4_lanes = 0;
+            __m128i rows[4];
+            for (int k = 0; k < 4; ++k) {
+                if (f[k].length < FAST_PATH_MIN_LENGTH) {
+                    loadable = false;
+                    break;
+                }
+                uint16_t type;
+                std::memcpy(&type, f[k].data + 12, 2);
+                ipv4_lanes |= (type == ipv4_le) << k;
+                const __m128i header = _mm_loadu_si128(reinterpret_cast<const __m128i*>(f[k].data + 12));
+                const __m128i addr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(f[k].data + 26));
+                rows[k] = _mm_or_si128(_mm_shuffle_epi8(addr, from_addr), _mm_shuffle_epi8(header, from_header));
+            }
+            if (!loadable) {
+                for (int k = 0; k < 4; ++k) decode_one(f[k], out, i + k);
+                continue;
+            }
+            
+            const __m128i t0 = _mm_unpacklo_epi32(rows[0], rows[1]);
+            const __m128i t1 = _mm_unpacklo_epi32(rows[2], rows[3]);
+            const __m128i t2 = _mm_unpackhi_epi32(rows[0], rows[1]);
+            const __m128i t3 = _mm_unpackhi_epi32(rows[2], rows[3]);
+            const __m128i src = _mm_unpacklo_epi64(t0, t1);
+            const __m128i dst = _mm_unpackhi_epi64(t0, t1);
+            const __m128i ports = _mm_unpacklo_epi64(t2, t3);
+            const __m128i check = _mm_unpackhi_epi64(t2, t3);
+            
+            const __m128i proto = _mm_srli_epi32(check, 24);
+            const __m128i fast = _mm_and_si128(
+                _mm_cmpeq_epi32(_mm_and_si128(check, check_mask), check_value),
+                _mm_or_si128(_mm_cmpeq_epi32(proto, tcp), _mm_cmpeq_epi32(proto, udp)));
+            const int fast_lanes = _mm_movemask_ps(_mm_castsi128_ps(fast)) & ipv4_lanes;
+            
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&out.src_ip[i]), src);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&out.dst_ip[i]), dst);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&out.dst_port[i]), _mm_shuffle_epi8(ports, low_halves));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&out.src_port[i]), _mm_shuffle_epi8(ports, high_halves));
+            const uint32_t protocols = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi8(check, top_bytes)));
+            std::memcpy(&out.protocol[i], &protocols, 4);
+            for (int k = 0; k < 4; ++k) {
+                out.ethertype[i + k] = EthernetHeader::TYPE_IPV4;
+                out.flags[i + k] = PacketColumns::FLAG_IPV4 | PacketColumns::FLAG_PORTS;
+            }
+            
+            if (fast_lanes != 0b1111) {
+                for (int k = 0; k < 4; ++k) {
+                    if (!(fast_lanes & (1 << k))) decode_one(f[k], out, i + k);
+                }
+            }
+        }
+        for (; i < n; ++i) {
+            decode_one(frames[i], out, i);
+        }
+    }
+    #define PACKET_DECODE_KERNEL "SSSE3"
+#else
+    inline void decode_simd(const FrameRef* frames, size_t n, PacketColumns& out) {
+        decode_scalar(frames, n, out);
+    }
+    #define PACKET_DECODE_KERNEL "标量(编译时加-mssse3启用SIMD)"
+#endif
+}
+
+// 子网表：规则按前缀长度降序排列，第一个命中的就是最长前缀匹配
+// 规则数在几十条以内时，把每条规则广播成向量、一次比较4个地址，比逐条分支判断更快；
+// 规则上万时应改用多级查找表(如DIR-24-8)
+class SubnetTable {
+private:
+    struct Rule {
+        uint32_t network;
+        uint32_t mask;
+        int prefix_length;
+        int id;
+    };
+    std::vector<Rule> rules_;
+    
+public:
+    static constexpr int32_t NO_MATCH = -1;
+    
+    // 前缀长度超出0..32时移位量越界(未定义行为)，直接拒绝
+    void add(IPv4Address network, int prefix_length, int id) {
+        if (prefix_length < 0 || prefix_length > 32) {
+            throw std::out_of_range("SubnetTable: 前缀长度必须在0到32之间");
+        }
+        const uint32_t mask = prefix_length == 0 ? 0u : ~0u << (32 - prefix_length);
+        Rule rule{network.get_raw() & mask, mask, prefix_length, id};
+        auto pos = std::upper_bound(rules_.begin(), rules_.end(), rule, [](const Rule& a, const Rule& b) {
+            return a.prefix_length > b.prefix_length;
+        });
+        rules_.insert(pos, rule);
+    }
+    
+    size_t size() const { return rules_.size(); }
+    
+    int32_t match(uint32_t address) const {
+        for (const Rule& rule : rules_) {
+            if ((address & rule.mask) == rule.network) return rule.id;
+        }
+        return NO_MATCH;
+    }
+    
+    void match_scalar(const uint32_t* addresses, size_t n, int32_t* out) const {
+        for (size_t i = 0; i < n; ++i) out[i] = match(addresses[i]);
+    }
+    
+    // 倒序遍历规则并无条件覆盖，最后留下的是排在最前(前缀最长)的命中规则，循环中没有分支
+    void match_batch(const uint32_t* addresses, size_t n, int32_t* out) const {
+        size_t i = 0;
+#if defined(__SSE2__)
+        for (; i + 4 <= n; i += 4) {
+            const __m128i addr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addresses + i));
+            __m128i result = _mm_set1_epi32(NO_MATCH);
+            for (size_t r = rules_.size(); r-- > 0;) {
+                const __m128i hit = _mm_cmpeq_epi32(
+                    _mm_and_si128(addr, _mm_set1_epi32(static_cast<int>(rules_[r].mask))),
+                    _mm_set1_epi32(static_cast<int>(rules_[r].network)));
+                result = _mm_or_si128(_mm_and_si128(hit, _mm_set1_epi32(rules_[r].id)),
+                                      _mm_andnot_si128(hit, result));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+        }
+#endif
+        for (; i < n; ++i) out[i] = match(addresses[i]);
+    }
+};
+
+// 把一组BitPatternMatcher编译成模式/掩码数组，classify返回第一个命中的模式下标
+template<typename Word, typename... Matchers>
+struct BitPatternSet {
+    static constexpr size_t size = sizeof...(Matchers);
+    static constexpr Word patterns[] = {static_cast<Word>(Matchers::pattern & Matchers::mask)...};
+    static constexpr Word masks[] = {static_cast<Word>(Matchers::mask)...};
+    static constexpr uint8_t NO_MATCH = 0xFF;
+    
+    static_assert(size > 0 && size < NO_MATCH, "模式数量必须在1到254之间");
+    
+    static constexpr bool fits(uint64_t value) {
+        return (value >> (8 * sizeof(Word) - 1) >> 1) == 0;
+    }
+    static constexpr bool all_fit(std::initializer_list<bool> checks) {
+        for (bool ok : checks) {
+            if (!ok) return false;
+        }
+        return true;
+    }
+    static_assert(all_fit({fits(Matchers::mask)...}), "模式掩码超出Word的位宽");
+    
+    static uint8_t classify(Word value) {
+        for (size_t p = 0; p < size; ++p) {
+            if ((value & masks[p]) == patterns[p]) return static_cast<uint8_t>(p);
+        }
+        return NO_MATCH;
+    }
+    
+    static void classify_scalar(const Word* values, size_t n, uint8_t* out) {
+        for (size_t i = 0; i < n; ++i) out[i] = classify(values[i]);
+    }
+    
+    static void classify_batch(const Word* values, size_t n, uint8_t* out) {
+        classify_batch_impl(values, n, out, std::integral_constant<bool, sizeof(Word) == 4>{});
+    }
+    
+private:
+    static void classify_batch_impl(const Word* values, size_t n, uint8_t* out, std::false_type) {
+        classify_scalar(values, n, out);
+    }
+    
+    // 32位字：每个模式一次比较4个字，倒序覆盖保证"第一个命中"的语义
+    static void classify_batch_impl(const Word* values, size_t n, uint8_t* out, std::true_type) {
+        size_t i = 0;
+#if defined(__SSE2__)
+        for (; i + 4 <= n; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            __m128i result = _mm_set1_epi32(NO_MATCH);
+            for (size_t p = size; p-- > 0;) {
+                const __m128i hit = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(masks[p]))),
+                                                    _mm_set1_epi32(static_cast<int>(patterns[p])));
+                result = _mm_or_si128(_mm_and_si128(hit, _mm_set1_epi32(static_cast<int>(p))),
+                                      _mm_andnot_si128(hit, result));
+            }
+            // 每个32位结果只有低字节有效，压缩成4个uint8_t
+            const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(result, result), _mm_setzero_si128());
+            const uint32_t bytes = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+            std::memcpy(out + i, &bytes, 4);
+        }
+#endif
+        for (; i < n; ++i) out[i] = classify(values[i]);
+    }
+};
+
+template<typename Word, typename... Matchers>
+constexpr Word BitPatternSet<Word, Matchers...>::patterns[];
+
+template<typename Word, typename... Matchers>
+constexpr Word BitPatternSet<Word, Matchers...>::masks[];
+
+using RiscVDecoder = BitPatternSet<uint32_t, RTypeInstr, ITypeInstr, LoadInstr>;
+
+// 构造测试帧：以IPv4 TCP/UDP为主，混入VLAN、ARP、带选项和分片的报文
+inline void build_test_frame(uint8_t* frame, uint16_t& length, uint32_t seed) {
+    std::memset(frame, 0, 64);
+    for (int b = 0; b < 12; ++b) frame[b] = static_cast<uint8_t>(seed >> (b % 4 * 8));
+    size_t offset = 12;
+    const uint32_t kind = seed % 100;
+    if (kind == 0) {  // ARP
+        frame[12] = 0x08; frame[13] = 0x06;
+        length = 60;
+        return;
+    }
+    if (kind == 1) {  // 802.1Q
+        frame[12] = 0x81; frame[13] = 0x00; frame[15] = 0x64;
+        offset = 16;
+    }
+    frame[offset] = 0x08; frame[offset + 1] = 0x00;
+    uint8_t* ip = frame + offset + 2;
+    const size_t ihl = kind == 2 ? 6 : 5;
+    ip[0] = static_cast<uint8_t>(0x40 | ihl);
+    ip[6] = kind == 3 ? 0x00 : 0x40;  // kind 3: 分片偏移非0
+    ip[7] = kind == 3 ? 0x10 : 0x00;
+    ip[8] = 64;
+    ip[9] = (seed >> 7) % 3 == 0 ? PacketDecode::PROTO_UDP : ((seed >> 9) % 10 == 0 ? 1 : PacketDecode::PROTO_TCP);
+    const uint32_t src = 0x0A000000 | (seed * 2654435761u >> 8);
+    const uint32_t dst = (seed >> 3) % 2 ? (0xC0A80000 | (seed & 0xFFFF)) : (seed * 40503u);
+    for (int b = 0; b < 4; ++b) {
+        ip[12 + b] = static_cast<uint8_t>(src >> (24 - 8 * b));
+        ip[16 + b] = static_cast<uint8_t>(dst >> (24 - 8 * b));
+    }
+    uint8_t* l4 = ip + ihl * 4;
+    l4[0] = static_cast<uint8_t>(seed >> 11); l4[1] = static_cast<uint8_t>(seed >> 19);
+    l4[2] = 0x01; l4[3] = static_cast<uint8_t>(0xBB + seed % 3);
+    length = static_cast<uint16_t>(kind == 4 ? 38 : 60 + seed % 5);  // kind 4: 截断帧
+}
+
+inline bool same_decode(const PacketColumns& a, const PacketColumns& b) {
+    if (a.count != b.count) return false;
+    for (size_t i = 0; i < a.count; ++i) {
+        if (a.src_ip[i] != b.src_ip[i] || a.dst_ip[i] != b.dst_ip[i] || a.src_port[i] != b.src_port[i] ||
+            a.dst_port[i] != b.dst_port[i] || a.ethertype[i] != b.ethertype[i] ||
+            a.protocol[i] != b.protocol[i] || a.flags[i] != b.flags[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Func>
+double best_ns(int rounds, Func&& func) {
+    double best = 1e300;
+    for (int r = 0; r < rounds; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+void demonstrate_batch_packet_parsing() {
+    std::cout << "\n===== 批量报文解析 =====\n";
+    std::cout << "解码内核: " << PACKET_DECODE_KERNEL << "\n";
+    
+    constexpr size_t frame_count = 1'000'000;
+    constexpr size_t stride = 64;
+    std::vector<uint8_t> ring(frame_count * stride + 16);
+    std::vector<FrameRef> frames(frame_count);
+    uint32_t seed = 0x1234'5678;
+    for (size_t i = 0; i < frame_count; ++i) {
+        seed = seed * 1'664'525 + 1'013'904'223;
+        uint16_t length = 0;
+        build_test_frame(&ring[i * stride], length, seed >> 4);
+        frames[i] = FrameRef{&ring[i * stride], length};
+    }
+    
+    PacketColumns scalar, batched;
+    const double scalar_ns = best_ns(5, [&] { PacketDecode::decode_scalar(frames.data(), frame_count, scalar); });
+    const double simd_ns = best_ns(5, [&] { PacketDecode::decode_simd(frames.data(), frame_count, batched); });
+    size_t ipv4 = 0, with_ports = 0;
+    for (size_t i = 0; i < batched.count; ++i) {
+        ipv4 += (batched.flags[i] & PacketColumns::FLAG_IPV4) != 0;
+        with_ports += (batched.flags[i] & PacketColumns::FLAG_PORTS) != 0;
+    }
+    std::cout << "解码 " << frame_count << " 帧 (IPv4 " << ipv4 << ", 带端口 " << with_ports << "):\n";
+    std::cout << "  逐帧解码: " << std::setprecision(1) << std::fixed << frame_count * 1e3 / scalar_ns << " Mpps\n";
+    std::cout << "  批量解码: " << frame_count * 1e3 / simd_ns << " Mpps, 结果一致: "
+              << (same_decode(scalar, batched) ? "是" : "否") << "\n";
+    
+    SubnetTable subnets;
+    subnets.add(IPv4Address(10, 0, 0, 0), 8, 1);
+    subnets.add(IPv4Address(172, 16, 0, 0), 12, 2);
+    subnets.add(IPv4Address(192, 168, 0, 0), 16, 3);
+    subnets.add(IPv4Address(192, 168, 1, 0), 24, 4);
+    subnets.add(IPv4Address(192, 168, 1, 128), 25, 5);
+    subnets.add(IPv4Address(127, 0, 0, 0), 8, 6);
+    for (int r = 0; r < 10; ++r) {
+        subnets.add(IPv4Address(static_cast<uint8_t>(20 + r), static_cast<uint8_t>(r * 16), 0, 0), 12 + r, 10 + r);
+    }
+    std::vector<int32_t> match_scalar(frame_count), match_batch(frame_count);
+    const double match_scalar_ns = best_ns(5, [&] { subnets.match_scalar(batched.dst_ip.data(), frame_count, match_scalar.data()); });
+    const double match_batch_ns = best_ns(5, [&] { subnets.match_batch(batched.dst_ip.data(), frame_count, match_batch.data()); });
+    std::cout << "目的地址匹配 " << subnets.size() << " 条CIDR规则:\n";
+    std::cout << "  逐条分支: " << frame_count * 1e3 / match_scalar_ns << " Mpps\n";
+    std::cout << "  向量比较: " << frame_count * 1e3 / match_batch_ns << " Mpps, 结果一致: "
+              << (match_scalar == match_batch ? "是" : "否") << "\n";
+    std::cout << "  192.168.1.200 -> 规则 " << subnets.match(IPv4Address(192, 168, 1, 200).get_raw())
+              << ", 192.168.2.1 -> 规则 " << subnets.match(IPv4Address(192, 168, 2, 1).get_raw()) << "\n";
+    
+    std::vector<uint32_t> words(frame_count);
+    for (size_t i = 0; i < frame_count; ++i) {
+        const uint32_t opcodes[] = {0b0110011, 0b0010011, 0b0000011, 0b0100011};
+        words[i] = (batched.src_ip[i] & ~0x7Fu & ~(0x7u << 12)) | opcodes[i % 4] | ((i % 3 == 0 ? 1u : 0u) << 12);
+    }
+    std::vector<uint8_t> class_scalar(frame_count), class_batch(frame_count);
+    const double class_scalar_ns = best_ns(5, [&] { RiscVDecoder::classify_scalar(words.data(), frame_count, class_scalar.data()); });
+    const double class_batch_ns = best_ns(5, [&] { RiscVDecoder::classify_batch(words.data(), frame_count, class_batch.data()); });
+    std::cout << "指令字按 " << RiscVDecoder::size << " 个位模式分类:\n";
+    std::cout << "  逐个匹配: " << frame_count * 1e3 / class_scalar_ns << " M/s\n";
+    std::cout << "  向量匹配: " << frame_count * 1e3 / class_batch_ns << " M/s, 结果一致: "
+              << (class_scalar == class_batch ? "是" : "否") << "\n";
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
 // ===== 性能基准测试 =====
 
 void benchmark_literal_formats() {
     std::cout << "\n===== 字面值格式性能对比 =====\n";
     
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    // 测试不同字面值格式的编译时常量
-    constexpr int iterations = 1000000;
-    
+    // 测试不同字面值格式的编译时常量：每次迭代累加一次，预热、重复采样交给统一基准框架
     // 二进制字面值测试
     volatile uint32_t binary_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
+    micro_bench::print_result(std::cout, micro_bench::measure("二进制字面值", [&binary_sum]() {
         binary_sum += 0b1010'1010'1010'1010'1010'1010'1010'1010;
-    }
-    
-    auto mid1 = std::chrono::high_resolution_clock::now();
+    }));
     
     // 十六进制字面值测试
     volatile uint32_t hex_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
+    micro_bench::print_result(std::cout, micro_bench::measure("十六进制字面值", [&hex_sum]() {
         hex_sum += 0xAAAA'AAAA;
-    }
-    
-    auto mid2 = std::chrono::high_resolution_clock::now();
+    }));
     
     // 十进制字面值测试
     volatile uint32_t decimal_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
+    micro_bench::print_result(std::cout, micro_bench::measure("十进制字面值", [&decimal_sum]() {
         decimal_sum += 2'863'311'530;
-    }
-    
-    auto end = std::chrono::high_resolution_clock::now();
-    
-    auto binary_time = std::chrono::duration_cast<std::chrono::nanoseconds>(mid1 - start);
-    auto hex_time = std::chrono::duration_cast<std::chrono::nanoseconds>(mid2 - mid1);
-    auto decimal_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid2);
-    
-    std::cout << "二进制字面值: " << binary_time.count() / iterations << " ns/op\n";
-    std::cout << "十六进制字面值: " << hex_time.count() / iterations << " ns/op\n";
-    std::cout << "十进制字面值: " << decimal_time.count() / iterations << " ns/op\n";
+    }));
     
-    // 验证结果相等
-    std::cout << "结果验证: " << (binary_sum == hex_sum && hex_sum == decimal_sum ? "通过" : "失败") << "\n";
+    // 三个字面值相同，累加结果只取决于次数，这里验证单次累加的结果
+    const uint32_t binary_once = 0b1010'1010'1010'1010'1010'1010'1010'1010;
+    std::cout << "结果验证: " << (binary_once == 0xAAAA'AAAA && binary_once == 2'863'311'530 ? "通过" : "失败") << "\n";
 }
 
 void demonstrate_readability_benefits() {
@@ -473,7 +909,8 @@ public:
  *    - 支持在调试时切换数值显示格式
  */
 
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "=== C++14 二进制字面值和数字分隔符示例 ===\n";
     
     // 基本用法演示
@@ -534,6 +971,7 @@ int main() {
     
     cpp14_literals::demonstrate_readability_benefits();
     cpp14_literals::benchmark_literal_formats();
+    cpp14_literals::demonstrate_batch_packet_parsing();
     
     return 0;
 }
\ No newline at end of file
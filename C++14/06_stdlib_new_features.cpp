@@ -10,6 +10,9 @@
  * 6. <tuple>库的std::get按类型访问 - 增强元组操作
  * 7. <algorithm>库的新算法 - 交换操作和比较算法
  * 8. <iterator>库的std::make_reverse_iterator - 迭代器适配器
+ * 9. 综合应用：基于steady_clock的分层时间轮调度器 - O(1)调度与取消
+ * 10. 统一微基准测试框架 - 预热、重复采样、中位数/p99/置信区间、硬件计数器与JSON/CSV输出
+ * 11. RCU风格的配置快照 - 不可变shared_ptr快照、版本号缓存读取器、复制-发布与变更回调
  * 
  * 这些改进体现了C++14对库的完善和对实际编程问题的解决。
  */
@@ -29,6 +32,19 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <utility>
+
+#include "../common/micro_bench.h"
 
 namespace cpp14_stdlib {
 
@@ -79,26 +95,14 @@ namespace ChronoLiterals {
         }
     };
     
-    // 性能基准测试器
-    class PerformanceBenchmark {
-    private:
-        std::string name_;
-        std::chrono::high_resolution_clock::time_point start_;
-        
-    public:
-        explicit PerformanceBenchmark(const std::string& name) : name_(name) {
-            start_ = std::chrono::high_resolution_clock::now();
-        }
-        
-        ~PerformanceBenchmark() {
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = end - start_;
-            
-            std::cout << "性能测试 [" << name_ << "]: ";
-            std::cout << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() << " μs";
-            std::cout << " (" << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() << " ns)\n";
-        }
-    };
+    // ----- 统一微基准测试框架 -----
+    // 实现在common/micro_bench.h，其他示例文件的性能对比也用同一套预热、重复采样和统计
+    using micro_bench::BenchmarkConfig;
+    using micro_bench::BenchmarkResult;
+    using micro_bench::HardwareCounters;
+    using micro_bench::PerformanceBenchmark;
+    using micro_bench::clobber_memory;
+    using micro_bench::do_not_optimize;
     
     // 定时器类
     class Timer {
@@ -516,34 +520,48 @@ namespace AlgorithmExtensions {
         }
     };
     
-    // 算法性能测试
-    void benchmark_algorithms() {
-        std::cout << "\n===== 算法性能测试 =====\n";
+    // 算法性能测试：缓冲区在循环外准备好，只测算法本身
+    void benchmark_algorithms(ChronoLiterals::PerformanceBenchmark& bench) {
+        using ChronoLiterals::clobber_memory;
+        using ChronoLiterals::do_not_optimize;
         
         std::vector<int> large_vector(1000000);
         std::iota(large_vector.begin(), large_vector.end(), 0);
         
-        // 测试std::reverse
-        {
-            ChronoLiterals::PerformanceBenchmark bench("std::reverse");
-            std::vector<int> copy = large_vector;
+        std::vector<int> copy = large_vector;
+        bench.run("std::reverse", [&copy]() {
             std::reverse(copy.begin(), copy.end());
-        }
-        
-        // 测试反向迭代器
-        {
-            ChronoLiterals::PerformanceBenchmark bench("反向迭代器");
-            std::vector<int> copy = large_vector;
-            std::vector<int> reversed;
-            reversed.reserve(copy.size());
-            std::copy(copy.rbegin(), copy.rend(), std::back_inserter(reversed));
-        }
+            do_not_optimize(copy.data());
+            clobber_memory();
+        }, copy.size());
+        
+        std::vector<int> reversed;
+        reversed.reserve(large_vector.size());
+        bench.run("反向迭代器拷贝", [&]() {
+            reversed.assign(large_vector.rbegin(), large_vector.rend());
+            do_not_optimize(reversed.data());
+            clobber_memory();
+        }, large_vector.size());
     }
 }
 
 // ===== 6. <iterator>库的std::make_reverse_iterator =====
 
 namespace IteratorUtilities {
+    // 溢出策略：默认抛异常；遥测窗口通常只关心最近的数据，用覆盖最旧元素
+    enum class OverflowPolicy { Throw, OverwriteOldest };
+    
+    // 环形区域最多对应两段连续内存：环绕时第二段从缓冲区开头开始
+    template<typename T>
+    struct SpanPair {
+        T* first;
+        size_t first_size;
+        T* second;
+        size_t second_size;
+        
+        size_t size() const { return first_size + second_size; }
+    };
+    
     // 自定义容器示例
     template<typename T>
     class CircularBuffer {
@@ -552,13 +570,25 @@ namespace IteratorUtilities {
         size_t head_{0};
         size_t tail_{0};
         size_t size_{0};
+        OverflowPolicy policy_;
+        
+        template<typename U>
+        SpanPair<U> make_spans(U* base, size_t start, size_t count) const {
+            size_t first = std::min(count, buffer_.size() - start);
+            return SpanPair<U>{base + start, first, base, count - first};
+        }
         
     public:
-        explicit CircularBuffer(size_t capacity) : buffer_(capacity) {}
+        explicit CircularBuffer(size_t capacity, OverflowPolicy policy = OverflowPolicy::Throw)
+            : buffer_(capacity), policy_(policy) {}
         
         void push_back(const T& value) {
             if (size_ == buffer_.size()) {
-                throw std::runtime_error("缓冲区已满");
+                if (policy_ == OverflowPolicy::Throw) {
+                    throw std::runtime_error("缓冲区已满");
+                }
+                head_ = (head_ + 1) % buffer_.size();  // 丢弃最旧的元素
+                --size_;
             }
             
             buffer_[tail_] = value;
@@ -577,19 +607,88 @@ namespace IteratorUtilities {
             return value;
         }
         
-        // 正向迭代器
-        auto begin() { return buffer_.begin() + head_; }
-        auto end() { return buffer_.begin() + (head_ + size_); }
+        // 零拷贝写入：返回tail之后最多n个可写槽位，填好后调用commit_push
+        // 覆盖模式下可写区域可以包含最旧的元素，它们在commit_push时被丢弃
+        SpanPair<T> push_span(size_t n) {
+            size_t limit = policy_ == OverflowPolicy::Throw ? buffer_.size() - size_ : buffer_.size();
+            return make_spans(buffer_.data(), tail_, std::min(n, limit));
+        }
         
-        // 反向迭代器
-        auto rbegin() { 
-            return std::make_reverse_iterator(buffer_.begin() + (head_ + size_)); 
+        void commit_push(size_t n) {
+            if (n > buffer_.size() || (policy_ == OverflowPolicy::Throw && size_ + n > buffer_.size())) {
+                throw std::runtime_error("提交的元素超出可写区域");
+            }
+            tail_ = (tail_ + n) % buffer_.size();
+            size_ += n;
+            if (size_ > buffer_.size()) {
+                size_t dropped = size_ - buffer_.size();
+                head_ = (head_ + dropped) % buffer_.size();
+                size_ = buffer_.size();
+            }
         }
-        auto rend() { 
-            return std::make_reverse_iterator(buffer_.begin() + head_); 
+        
+        // 零拷贝读取：按从旧到新的顺序返回当前全部元素，读完后调用consume
+        SpanPair<const T> read_span() const {
+            return make_spans(buffer_.data(), head_, size_);
+        }
+        
+        void consume(size_t n) {
+            n = std::min(n, size_);
+            head_ = (head_ + n) % buffer_.size();
+            size_ -= n;
         }
         
+        // 环形迭代器：记录逻辑下标(0..size)，解引用时才映射到物理槽位，
+        // 环绕（覆盖模式下的常态）之后也不会越过buffer_.end()
+        template<typename Value>
+        class RingIterator {
+        private:
+            Value* data_;
+            size_t capacity_;
+            size_t head_;
+            size_t index_;
+            
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = typename std::remove_const<Value>::type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value*;
+            using reference = Value&;
+            
+            RingIterator(Value* data, size_t capacity, size_t head, size_t index)
+                : data_(data), capacity_(capacity), head_(head), index_(index) {}
+            
+            // head < capacity且index <= capacity，减一次即可代替取模
+            reference operator*() const {
+                size_t slot = head_ + index_;
+                return data_[slot >= capacity_ ? slot - capacity_ : slot];
+            }
+            pointer operator->() const { return &**this; }
+            
+            RingIterator& operator++() { ++index_; return *this; }
+            RingIterator operator++(int) { RingIterator old = *this; ++index_; return old; }
+            RingIterator& operator--() { --index_; return *this; }
+            RingIterator operator--(int) { RingIterator old = *this; --index_; return old; }
+            
+            bool operator==(const RingIterator& other) const { return index_ == other.index_; }
+            bool operator!=(const RingIterator& other) const { return index_ != other.index_; }
+        };
+        
+        using iterator = RingIterator<T>;
+        using const_iterator = RingIterator<const T>;
+        
+        // 正向迭代器
+        iterator begin() { return iterator(buffer_.data(), buffer_.size(), head_, 0); }
+        iterator end() { return iterator(buffer_.data(), buffer_.size(), head_, size_); }
+        const_iterator begin() const { return const_iterator(buffer_.data(), buffer_.size(), head_, 0); }
+        const_iterator end() const { return const_iterator(buffer_.data(), buffer_.size(), head_, size_); }
+        
+        // 反向迭代器
+        auto rbegin() { return std::make_reverse_iterator(end()); }
+        auto rend() { return std::make_reverse_iterator(begin()); }
+        
         size_t size() const { return size_; }
+        size_t capacity() const { return buffer_.size(); }
         bool empty() const { return size_ == 0; }
     };
     
@@ -623,135 +722,835 @@ namespace IteratorUtilities {
     StepIterator<Iterator> make_step_iterator(Iterator current, Iterator end, size_t step) {
         return StepIterator<Iterator>(current, end, step);
     }
+    
+    // 单写多读的快照环：写者从不等待读者，读者也从不等待写者
+    // 1. 写者先发布pending_（即将覆盖的位置），release栅栏后写槽位，最后发布head_
+    // 2. 读者读head_后拷贝最近N个槽位，acquire栅栏后读pending_，丢弃拷贝期间可能被覆盖的旧槽位
+    // 3. 槽位按8字节原子字逐个relaxed读写，不存在数据竞争，因此要求T可平凡复制
+    // 读者一次遍历即返回（wait-free），被套圈时只是拿到的条数变少
+    template<typename T, size_t Capacity>
+    class SnapshotRing {
+        static_assert((Capacity & (Capacity - 1)) == 0, "容量必须是2的幂");
+        static_assert(std::is_trivially_copyable<T>::value, "快照环只能存放可平凡复制的类型");
+        
+        static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        
+        struct Slot {
+            std::atomic<uint64_t> words[kWords];
+        };
+        
+        std::unique_ptr<Slot[]> slots_{new Slot[Capacity]};
+        alignas(64) std::atomic<uint64_t> head_{0};     // 已写完的元素总数
+        alignas(64) std::atomic<uint64_t> pending_{0};  // 已开始写的元素总数
+        
+        void store_slot(uint64_t index, const T& value) {
+            uint64_t words[kWords] = {};
+            std::memcpy(words, &value, sizeof(T));
+            Slot& slot = slots_[index & (Capacity - 1)];
+            for (size_t w = 0; w < kWords; ++w) slot.words[w].store(words[w], std::memory_order_relaxed);
+        }
+        
+        T load_slot(uint64_t index) const {
+            uint64_t words[kWords];
+            const Slot& slot = slots_[index & (Capacity - 1)];
+            for (size_t w = 0; w < kWords; ++w) words[w] = slot.words[w].load(std::memory_order_relaxed);
+            T value;
+            std::memcpy(&value, words, sizeof(T));
+            return value;
+        }
+        
+    public:
+        SnapshotRing() {
+            for (size_t i = 0; i < Capacity; ++i) {
+                for (size_t w = 0; w < kWords; ++w) slots_[i].words[w].store(0, std::memory_order_relaxed);
+            }
+        }
+        
+        // 只允许一个写线程
+        void push(const T& value) { push_batch(&value, 1); }
+        
+        // 批量写：一次发布，读者看到的要么是整批之前的状态，要么包含整批
+        void push_batch(const T* values, size_t n) {
+            if (n == 0) return;
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            // 超过容量的部分反正会被覆盖，只写最后Capacity个，但total_pushed仍按整批n个计数
+            const size_t skip = n > Capacity ? n - Capacity : 0;
+            pending_.store(head + n, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = skip; i < n; ++i) store_slot(head + i, values[i]);
+            head_.store(head + n, std::memory_order_release);
+        }
+        
+        // 把最近最多max_items个元素按从旧到新写入out，返回实际条数；任意多个读线程可并发调用
+        size_t snapshot(T* out, size_t max_items) const {
+            const uint64_t head = head_.load(std::memory_order_acquire);
+            const uint64_t count = std::min<uint64_t>({max_items, head, Capacity});
+            const uint64_t first = head - count;
+            for (uint64_t i = first; i < head; ++i) out[i - first] = load_slot(i);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // pending之前Capacity个位置以内的槽位在拷贝期间可能已被改写
+            const uint64_t pending = pending_.load(std::memory_order_relaxed);
+            const uint64_t valid_from = pending > Capacity ? pending - Capacity : 0;
+            if (valid_from <= first) return static_cast<size_t>(count);
+            if (valid_from >= head) return 0;
+            const size_t valid = static_cast<size_t>(head - valid_from);
+            std::memmove(out, out + (valid_from - first), valid * sizeof(T));
+            return valid;
+        }
+        
+        uint64_t total_pushed() const { return head_.load(std::memory_order_acquire); }
+        static constexpr size_t capacity() { return Capacity; }
+    };
+    
+    // 遥测样本：序号、时间戳和数值之间有确定关系，便于检查快照是否撕裂
+    struct TelemetrySample {
+        uint64_t sequence;
+        uint64_t timestamp_ns;
+        double value;
+    };
+    
+    inline TelemetrySample make_sample(uint64_t sequence) {
+        return TelemetrySample{sequence, sequence * 1000 + 7, static_cast<double>(sequence) * 0.5};
+    }
+    
+    inline bool snapshot_consistent(const TelemetrySample* items, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            const TelemetrySample expected = make_sample(items[i].sequence);
+            if (items[i].timestamp_ns != expected.timestamp_ns || items[i].value != expected.value) return false;
+            if (i > 0 && items[i].sequence != items[i - 1].sequence + 1) return false;
+        }
+        return true;
+    }
+    
+    // 互斥锁版本作为对照：写者和读者都要拿同一把锁
+    class MutexTelemetryWindow {
+        CircularBuffer<TelemetrySample> buffer_;
+        mutable std::mutex mutex_;
+        
+    public:
+        explicit MutexTelemetryWindow(size_t capacity) : buffer_(capacity, OverflowPolicy::OverwriteOldest) {}
+        
+        void push(const TelemetrySample& sample) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buffer_.push_back(sample);
+        }
+        
+        size_t snapshot(TelemetrySample* out, size_t max_items) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            SpanPair<const TelemetrySample> spans = buffer_.read_span();
+            size_t count = std::min(max_items, spans.size());
+            size_t skip = spans.size() - count;  // 只要最近的count个
+            for (size_t i = 0; i < count; ++i) {
+                size_t index = skip + i;
+                out[i] = index < spans.first_size ? spans.first[index] : spans.second[index - spans.first_size];
+            }
+            return count;
+        }
+    };
+    
+    // 一个写线程持续写入，若干读线程反复取最近64条快照
+    template<typename Window>
+    void run_telemetry_benchmark(const char* name, Window& window, int readers) {
+        const auto duration = std::chrono::milliseconds(200);
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> snapshots{0};
+        std::atomic<uint64_t> items_read{0};
+        std::atomic<bool> torn{false};
+        uint64_t written = 0;
+        for (; written < 1024; ++written) window.push(make_sample(written));  // 先填满，读者一开始就有完整窗口
+        
+        std::vector<std::thread> reader_threads;
+        for (int r = 0; r < readers; ++r) {
+            reader_threads.emplace_back([&] {
+                TelemetrySample local[64];
+                uint64_t local_snapshots = 0, local_items = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    size_t n = window.snapshot(local, 64);
+                    if (!snapshot_consistent(local, n)) torn.store(true);
+                    ++local_snapshots;
+                    local_items += n;
+                }
+                snapshots.fetch_add(local_snapshots);
+                items_read.fetch_add(local_items);
+            });
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < duration) {
+            for (int i = 0; i < 1024; ++i) window.push(make_sample(written++));
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stop.store(true);
+        for (auto& t : reader_threads) t.join();
+        
+        std::cout << "  " << name << " 读者" << readers << ": 写入 " << std::fixed << std::setprecision(1)
+                  << written / seconds / 1e6 << " M条/秒, 快照 " << snapshots.load() / seconds / 1e3
+                  << " K次/秒, 平均每次 " << (snapshots.load() ? items_read.load() / snapshots.load() : 0)
+                  << " 条, " << (torn.load() ? "发现撕裂数据!" : "数据一致") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+    
+    inline void benchmark_telemetry_windows() {
+        std::cout << "\n单写多读遥测窗口 (硬件线程数 " << std::thread::hardware_concurrency() << "):\n";
+        for (int readers : {1, 2, 4}) {
+            SnapshotRing<TelemetrySample, 1024> ring;
+            run_telemetry_benchmark("SnapshotRing ", ring, readers);
+            MutexTelemetryWindow locked(1024);
+            run_telemetry_benchmark("mutex+环形缓冲", locked, readers);
+        }
+    }
 }
 
 // ===== 7. 综合应用示例 =====
 
 namespace ComprehensiveExamples {
-    // 任务调度器
-    class TaskScheduler {
-    private:
+    // 分层时间轮：第0层256个槽、每槽一个tick；第1~3层各64个槽，每层跨度是下一层的64倍，
+    // 共覆盖2^26个tick（1ms精度约18.6小时），更远的定时器先放在最高层，级联时重新放置。
+    // 节点放在数组里、用下标串成双向链表，插入和取消都是O(1)；句柄带代数，过期句柄取消无效。
+    // 本类不加锁，由调用方保证同一时间只有一个线程访问
+    class TimingWheel {
+    public:
+        using clock = std::chrono::steady_clock;
         using Task = std::function<void()>;
-        using TimePoint = std::chrono::system_clock::time_point;
         
-        struct ScheduledTask {
-            TimePoint execute_time;
-            Task task;
-            std::string name;
+        static constexpr uint32_t kNone = 0xFFFFFFFFu;
+        
+        struct Handle {
+            uint32_t index = kNone;
+            uint32_t generation = 0;
+            
+            explicit operator bool() const { return index != kNone; }
+        };
+        
+        explicit TimingWheel(clock::duration tick = std::chrono::milliseconds(1),
+                             clock::time_point start = clock::now())
+            : tick_(tick), start_(start) {
+            for (auto& head : heads_) head = kNone;
+        }
+        
+        // 到期时间向上取整到tick，定时器不会提前触发，最多晚一个tick
+        Handle schedule_at(clock::time_point when, Task task) {
+            uint64_t deadline = 0;
+            if (when > start_) {
+                deadline = static_cast<uint64_t>((when - start_ + tick_ - clock::duration(1)) / tick_);
+            }
+            deadline = std::max(deadline, current_tick_ + 1);
             
-            bool operator<(const ScheduledTask& other) const {
-                return execute_time > other.execute_time;  // 优先队列需要
+            const uint32_t index = allocate();
+            Node& node = nodes_[index];
+            node.task = std::move(task);
+            node.deadline = deadline;
+            place(index);
+            ++size_;
+            return Handle{index, node.generation};
+        }
+        
+        bool cancel(Handle handle) {
+            if (handle.index >= nodes_.size()) return false;
+            Node& node = nodes_[handle.index];
+            if (node.generation != handle.generation || node.slot == kFreeSlot) return false;
+            unlink(handle.index);
+            release(handle.index);
+            --size_;
+            return true;
+        }
+        
+        // 把到now为止到期的任务按tick顺序移入expired，返回移入的个数。
+        // 第0层剩余的槽位为空时直接跳到下一个有任务的槽或本圈末尾，空闲时间不逐tick空转
+        size_t advance(clock::time_point now, std::vector<Task>& expired) {
+            if (now < start_) return 0;
+            const uint64_t target = static_cast<uint64_t>((now - start_) / tick_);
+            const size_t before = expired.size();
+            while (current_tick_ < target) {
+                if (size_ == 0) {
+                    current_tick_ = target;
+                    break;
+                }
+                const uint64_t next = next_event_tick();
+                if (next > target) {
+                    current_tick_ = target;
+                    break;
+                }
+                current_tick_ = next;
+                process_tick(expired);
+            }
+            return expired.size() - before;
+        }
+        
+        // 下一次需要调用advance的时间；只是保守的估计，到达时可能只发生级联
+        clock::time_point next_expiry() const {
+            if (size_ == 0) return clock::time_point::max();
+            return start_ + tick_ * static_cast<clock::rep>(next_event_tick());
+        }
+        
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        
+        // 预先分配节点，避免大量调度时节点数组反复扩容
+        void reserve(size_t timers) { nodes_.reserve(timers); }
+        
+    private:
+        static constexpr int kLevels = 4;
+        static constexpr uint32_t kLevel0Bits = 8;
+        static constexpr uint32_t kLevelBits = 6;
+        static constexpr uint64_t kLevel0Mask = (1u << kLevel0Bits) - 1;
+        static constexpr uint64_t kLevelMask = (1u << kLevelBits) - 1;
+        static constexpr uint32_t kSlotCount = (1u << kLevel0Bits) + (kLevels - 1) * (1u << kLevelBits);
+        static constexpr uint64_t kMaxSpan = 1ull << (kLevel0Bits + (kLevels - 1) * kLevelBits);
+        static constexpr uint16_t kFreeSlot = 0xFFFF;
+        
+        struct Node {
+            Task task;
+            uint64_t deadline = 0;
+            uint32_t prev = kNone;
+            uint32_t next = kNone;
+            uint32_t generation = 0;
+            uint16_t slot = kFreeSlot;
+        };
+        
+        clock::duration tick_;
+        clock::time_point start_;
+        uint64_t current_tick_ = 0;  // 已经处理完的tick
+        size_t size_ = 0;
+        std::vector<Node> nodes_;
+        uint32_t free_head_ = kNone;
+        uint32_t heads_[kSlotCount];
+        uint64_t level0_occupied_[(1u << kLevel0Bits) / 64] = {};
+        
+        static constexpr uint32_t shift(int level) {
+            return kLevel0Bits + (level - 1) * kLevelBits;
+        }
+        
+        static constexpr uint32_t slot_id(int level, uint64_t slot) {
+            return level == 0 ? static_cast<uint32_t>(slot)
+                              : (1u << kLevel0Bits) + (level - 1) * (1u << kLevelBits) + static_cast<uint32_t>(slot);
+        }
+        
+        uint32_t allocate() {
+            if (free_head_ != kNone) {
+                const uint32_t index = free_head_;
+                free_head_ = nodes_[index].next;
+                return index;
+            }
+            nodes_.emplace_back();
+            return static_cast<uint32_t>(nodes_.size() - 1);
+        }
+        
+        void release(uint32_t index) {
+            Node& node = nodes_[index];
+            node.task = nullptr;  // 释放回调捕获的资源
+            ++node.generation;
+            node.slot = kFreeSlot;
+            node.prev = kNone;
+            node.next = free_head_;
+            free_head_ = index;
+        }
+        
+        // 按剩余tick数选层：越远的定时器放在越粗的层
+        void place(uint32_t index) {
+            Node& node = nodes_[index];
+            uint64_t delta = node.deadline - current_tick_;
+            uint64_t deadline = node.deadline;
+            if (delta >= kMaxSpan) {
+                delta = kMaxSpan - 1;
+                deadline = current_tick_ + delta;
+            }
+            uint32_t slot;
+            if (delta <= kLevel0Mask) {
+                slot = slot_id(0, deadline & kLevel0Mask);
+                level0_occupied_[slot / 64] |= 1ull << (slot % 64);
+            } else {
+                int level = 1;
+                while (delta >= (1ull << (shift(level) + kLevelBits))) ++level;
+                slot = slot_id(level, (deadline >> shift(level)) & kLevelMask);
+            }
+            node.slot = static_cast<uint16_t>(slot);
+            node.prev = kNone;
+            node.next = heads_[slot];
+            if (node.next != kNone) nodes_[node.next].prev = index;
+            heads_[slot] = index;
+        }
+        
+        void unlink(uint32_t index) {
+            Node& node = nodes_[index];
+            if (node.prev != kNone) {
+                nodes_[node.prev].next = node.next;
+            } else {
+                heads_[node.slot] = node.next;
+                if (node.next == kNone && node.slot < (1u << kLevel0Bits)) {
+                    level0_occupied_[node.slot / 64] &= ~(1ull << (node.slot % 64));
+                }
+            }
+            if (node.next != kNone) nodes_[node.next].prev = node.prev;
+        }
+        
+        // 本圈内下一个非空的第0层槽位对应的tick；没有则返回本圈末尾（需要级联）
+        uint64_t next_event_tick() const {
+            const uint64_t base = current_tick_ & ~kLevel0Mask;
+            for (uint32_t pos = static_cast<uint32_t>(current_tick_ & kLevel0Mask) + 1; pos <= kLevel0Mask;) {
+                const uint64_t bits = level0_occupied_[pos / 64] >> (pos % 64);
+                if (bits != 0) {
+                    return base + pos + static_cast<uint64_t>(__builtin_ctzll(bits));
+                }
+                pos = (pos / 64 + 1) * 64;
             }
+            return base + kLevel0Mask + 1;
+        }
+        
+        void process_tick(std::vector<Task>& expired) {
+            const uint64_t tick = current_tick_;
+            if ((tick & kLevel0Mask) == 0) {
+                for (int level = 1; level < kLevels; ++level) {
+                    const uint64_t slot = (tick >> shift(level)) & kLevelMask;
+                    cascade(slot_id(level, slot));
+                    if (slot != 0) break;
+                }
+            }
+            const uint32_t slot = slot_id(0, tick & kLevel0Mask);
+            uint32_t index = heads_[slot];
+            heads_[slot] = kNone;
+            level0_occupied_[slot / 64] &= ~(1ull << (slot % 64));
+            while (index != kNone) {
+                const uint32_t next = nodes_[index].next;
+                expired.push_back(std::move(nodes_[index].task));
+                release(index);
+                --size_;
+                index = next;
+            }
+        }
+        
+        // 把高层一个槽里的定时器按剩余时间重新放到更低的层
+        void cascade(uint32_t slot) {
+            uint32_t index = heads_[slot];
+            heads_[slot] = kNone;
+            while (index != kNone) {
+                const uint32_t next = nodes_[index].next;
+                place(index);
+                index = next;
+            }
+        }
+    };
+    
+    // 任务调度器：每个工作线程独占一个时间轮分片，基于steady_clock，不受系统时间调整影响。
+    // 调度与取消都是O(1)，到期任务整批取出后在锁外执行
+    class TaskScheduler {
+    public:
+        using clock = TimingWheel::clock;
+        using Task = TimingWheel::Task;
+        using TimePoint = clock::time_point;
+        
+        struct TimerHandle {
+            uint32_t shard = 0;
+            TimingWheel::Handle timer;
         };
         
-        std::priority_queue<ScheduledTask> task_queue_;
+    private:
+        struct Shard {
+            std::mutex mutex;
+            std::condition_variable cv;
+            TimingWheel wheel;
+            TimePoint wake_at = TimePoint::max();  // 工作线程睡到何时；醒着时为min，不需要通知
+            std::thread worker;
+            
+            Shard(clock::duration tick, TimePoint start) : wheel(tick, start) {}
+        };
+        
+        std::vector<std::unique_ptr<Shard>> shards_;
         std::atomic<bool> running_{false};
-        std::thread scheduler_thread_;
-        std::mutex queue_mutex_;
-        std::condition_variable cv_;
+        std::atomic<uint32_t> next_shard_{0};
+        std::atomic<uint64_t> executed_{0};
         
     public:
-        TaskScheduler() = default;
+        explicit TaskScheduler(size_t threads = 1, clock::duration tick = std::chrono::milliseconds(1)) {
+            const TimePoint start = clock::now();
+            for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i) {
+                shards_.push_back(std::make_unique<Shard>(tick, start));
+            }
+        }
         
         ~TaskScheduler() {
             stop();
         }
         
         void start() {
-            running_ = true;
-            scheduler_thread_ = std::thread([this]() {
-                while (running_) {
-                    std::unique_lock<std::mutex> lock(queue_mutex_);
-                    
-                    if (task_queue_.empty()) {
-                        cv_.wait(lock);
-                        continue;
-                    }
-                    
-                    auto now = std::chrono::system_clock::now();
-                    auto& next_task = task_queue_.top();
-                    
-                    if (now >= next_task.execute_time) {
-                        auto task = std::move(next_task.task);
-                        auto name = next_task.name;
-                        task_queue_.pop();
-                        lock.unlock();
-                        
+            if (running_.exchange(true)) return;
+            for (auto& shard : shards_) {
+                Shard* s = shard.get();
+                s->worker = std::thread([this, s]() { run_shard(*s); });
+            }
+        }
+        
+        void stop() {
+            running_ = false;
+            for (auto& shard : shards_) {
+                { std::lock_guard<std::mutex> lock(shard->mutex); }
+                shard->cv.notify_all();
+                if (shard->worker.joinable()) {
+                    shard->worker.join();
+                }
+            }
+        }
+        
+        template<typename Rep, typename Period>
+        TimerHandle schedule_after(const std::chrono::duration<Rep, Period>& delay, Task task) {
+            return schedule_at(clock::now() + delay, std::move(task));
+        }
+        
+        template<typename Rep, typename Period>
+        TimerHandle schedule_after(const std::chrono::duration<Rep, Period>& delay, 
+                                   Task task, const std::string& name) {
+            return schedule_at(clock::now() + delay, std::move(task), name);
+        }
+        
+        // 带名字的任务：执行时打印名字，失败时报告是哪个任务
+        TimerHandle schedule_at(TimePoint execute_time, Task task, const std::string& name) {
+            return schedule_at(execute_time, [task, name]() {
+                try {
+                    std::cout << "执行任务: " << name << "\n";
+                    task();
+                } catch (const std::exception& e) {
+                    std::cerr << "任务执行失败: " << name << " - " << e.what() << "\n";
+                }
+            });
+        }
+        
+        TimerHandle schedule_at(TimePoint execute_time, Task task) {
+            const uint32_t index = next_shard_.fetch_add(1, std::memory_order_relaxed) % shards_.size();
+            Shard& shard = *shards_[index];
+            TimerHandle handle;
+            handle.shard = index;
+            bool wake = false;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                handle.timer = shard.wheel.schedule_at(execute_time, std::move(task));
+                wake = execute_time < shard.wake_at;
+            }
+            if (wake) {
+                shard.cv.notify_one();
+            }
+            return handle;
+        }
+        
+        // 已经执行或已取消的句柄返回false
+        bool cancel(TimerHandle handle) {
+            if (handle.shard >= shards_.size()) return false;
+            Shard& shard = *shards_[handle.shard];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.wheel.cancel(handle.timer);
+        }
+        
+        size_t pending() const {
+            size_t total = 0;
+            for (const auto& shard : shards_) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                total += shard->wheel.size();
+            }
+            return total;
+        }
+        
+        uint64_t executed() const { return executed_.load(); }
+        
+    private:
+        void run_shard(Shard& shard) {
+            std::vector<Task> batch;
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            while (running_) {
+                shard.wheel.advance(clock::now(), batch);
+                if (!batch.empty()) {
+                    lock.unlock();
+                    for (auto& task : batch) {
                         try {
-                            std::cout << "执行任务: " << name << "\n";
                             task();
                         } catch (const std::exception& e) {
-                            std::cerr << "任务执行失败: " << name << " - " << e.what() << "\n";
+                            std::cerr << "任务执行失败: " << e.what() << "\n";
                         }
-                    } else {
-                        cv_.wait_until(lock, next_task.execute_time);
                     }
+                    executed_ += batch.size();
+                    batch.clear();
+                    lock.lock();
+                    continue;
                 }
-            });
+                shard.wake_at = shard.wheel.next_expiry();
+                if (shard.wake_at == TimePoint::max()) {
+                    shard.cv.wait(lock);
+                } else {
+                    shard.cv.wait_until(lock, shard.wake_at);
+                }
+                shard.wake_at = TimePoint::min();
+            }
+        }
+    };
+    
+    // 时间轮与优先队列的对比：模拟时钟驱动，不依赖真实等待
+    void benchmark_timer_wheel() {
+        using clock = TimingWheel::clock;
+        constexpr size_t count = 1000000;
+        constexpr uint32_t max_delay_ms = 60000;
+        
+        std::vector<uint32_t> delays(count);
+        uint64_t seed = 42;
+        for (auto& d : delays) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            d = 1 + static_cast<uint32_t>((seed >> 33) % max_delay_ms);
         }
         
-        void stop() {
-            running_ = false;
-            cv_.notify_all();
-            if (scheduler_thread_.joinable()) {
-                scheduler_thread_.join();
+        auto ns_per = [](clock::duration d, size_t n) {
+            return std::chrono::duration<double, std::nano>(d).count() / static_cast<double>(n);
+        };
+        const clock::time_point start = clock::now();
+        
+        // 时间轮：一半的超时在到期前被取消（请求正常完成的典型情况）
+        size_t wheel_fired = 0;
+        TimingWheel wheel(std::chrono::milliseconds(1), start);
+        wheel.reserve(count);
+        std::vector<TimingWheel::Handle> handles(count);
+        auto t0 = clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            handles[i] = wheel.schedule_at(start + std::chrono::milliseconds(delays[i]), [&wheel_fired]() { ++wheel_fired; });
+        }
+        auto t1 = clock::now();
+        for (size_t i = 1; i < count; i += 2) {
+            wheel.cancel(handles[i]);
+        }
+        auto t2 = clock::now();
+        std::vector<TimingWheel::Task> batch;
+        for (uint32_t ms = 0; ms <= max_delay_ms; ms += 10) {
+            wheel.advance(start + std::chrono::milliseconds(ms), batch);
+            for (auto& task : batch) task();
+            batch.clear();
+        }
+        auto t3 = clock::now();
+        
+        // 优先队列：无法直接删除，只能打墓碑标记，到期弹出时跳过
+        struct Entry {
+            clock::time_point when;
+            uint32_t id;
+            bool operator<(const Entry& other) const { return when > other.when; }
+        };
+        size_t heap_fired = 0;
+        std::priority_queue<Entry> heap;
+        std::vector<TimingWheel::Task> heap_tasks(count);
+        std::vector<bool> cancelled(count, false);
+        auto h0 = clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            heap_tasks[i] = [&heap_fired]() { ++heap_fired; };
+            heap.push({start + std::chrono::milliseconds(delays[i]), static_cast<uint32_t>(i)});
+        }
+        auto h1 = clock::now();
+        for (size_t i = 1; i < count; i += 2) {
+            cancelled[i] = true;
+            heap_tasks[i] = nullptr;
+        }
+        auto h2 = clock::now();
+        for (uint32_t ms = 0; ms <= max_delay_ms; ms += 10) {
+            const clock::time_point now = start + std::chrono::milliseconds(ms);
+            while (!heap.empty() && heap.top().when <= now) {
+                const uint32_t id = heap.top().id;
+                heap.pop();
+                if (!cancelled[id]) heap_tasks[id]();
             }
         }
+        auto h3 = clock::now();
+        
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "定时器基准（" << count << "个超时，取消一半，模拟时钟每10ms推进一次）:\n";
+        std::cout << "  时间轮:   调度 " << ns_per(t1 - t0, count) << " ns, 取消 " << ns_per(t2 - t1, count / 2)
+                  << " ns, 到期处理 " << ns_per(t3 - t2, count) << " ns/个, 触发 " << wheel_fired << "\n";
+        std::cout << "  优先队列: 调度 " << ns_per(h1 - h0, count) << " ns, 取消(墓碑) " << ns_per(h2 - h1, count / 2)
+                  << " ns, 到期处理 " << ns_per(h3 - h2, count) << " ns/个, 触发 " << heap_fired << "\n";
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+    
+    void demonstrate_task_scheduler() {
+        std::cout << "\n--- 时间轮任务调度器 ---\n";
+        using namespace std::chrono_literals;
+        
+        TaskScheduler scheduler(2);
+        scheduler.start();
+        
+        scheduler.schedule_after(60ms, []() { std::cout << "  心跳检查完成\n"; }, "心跳");
+        scheduler.schedule_after(20ms, []() { std::cout << "  缓存刷新完成\n"; }, "刷新缓存");
+        auto timeout = scheduler.schedule_after(40ms, []() { std::cout << "  不应该出现\n"; }, "请求超时");
+        std::cout << "取消请求超时: " << (scheduler.cancel(timeout) ? "成功" : "失败") << "\n";
+        std::this_thread::sleep_for(100ms);
+        std::cout << "再次取消同一句柄: " << (scheduler.cancel(timeout) ? "成功" : "失败") << "\n";
+        
+        // 大量超时：多数请求按时完成并取消超时，只有少数真正触发
+        constexpr size_t timeouts = 200000;
+        std::atomic<size_t> fired{0};
+        std::vector<TaskScheduler::TimerHandle> handles;
+        handles.reserve(timeouts);
+        const uint64_t executed_before = scheduler.executed();
+        for (size_t i = 0; i < timeouts; ++i) {
+            handles.push_back(scheduler.schedule_after(std::chrono::milliseconds(50 + i % 100), [&fired]() { ++fired; }));
+        }
+        size_t cancelled = 0;
+        for (size_t i = 0; i < timeouts; ++i) {
+            if (i % 4 != 0) cancelled += scheduler.cancel(handles[i]);
+        }
+        std::cout << timeouts << "个超时已登记, 取消" << cancelled << "个, 待触发 " << scheduler.pending() << "\n";
+        std::this_thread::sleep_for(300ms);
+        std::cout << "触发 " << fired.load() << " 个, 批量执行总数 " << scheduler.executed() - executed_before
+                  << ", 剩余 " << scheduler.pending() << "\n";
+        scheduler.stop();
         
-        template<typename Rep, typename Period>
-        void schedule_after(const std::chrono::duration<Rep, Period>& delay, 
-                           Task task, const std::string& name) {
-            auto execute_time = std::chrono::system_clock::now() + delay;
-            schedule_at(execute_time, std::move(task), name);
+        benchmark_timer_wheel();
+    }
+    
+    // RCU风格的只读快照：读者拿不可变的shared_ptr<const T>，写者复制-修改-整体发布
+    // 1. 写者之间用writer_mutex_串行化，读者从不碰这把锁
+    // 2. 发布顺序：先atomic_store新指针，再对version_做release递增
+    // 3. 旧版本由shared_ptr引用计数回收：最后一个持有旧快照的读者放手时才释放（宽限期）
+    // libstdc++的std::atomic_load(shared_ptr*)内部是散列自旋锁池而不是无锁的，
+    // 所以请求路径上推荐用Reader：快路径只有一次version_的acquire读取，版本变化时才重新取指针
+    template<typename T>
+    class SnapshotHolder {
+    public:
+        using Snapshot = std::shared_ptr<const T>;
+        using Callback = std::function<void(const T& old_value, const T& new_value)>;
+        
+    private:
+        Snapshot current_;  // 只通过std::atomic_load/std::atomic_store访问（C++20起可换成std::atomic<shared_ptr>）
+        alignas(64) std::atomic<uint64_t> version_{1};
+        std::mutex writer_mutex_;
+        std::vector<std::pair<uint64_t, Callback>> callbacks_;  // 受writer_mutex_保护
+        uint64_t next_callback_id_ = 1;
+        
+        // 调用方已持有writer_mutex_；回调在锁内按发布顺序执行，因此回调里不能再调用update/publish/subscribe
+        uint64_t publish_locked(const Snapshot& old_snapshot, Snapshot next) {
+            std::atomic_store(&current_, next);
+            const uint64_t version = version_.fetch_add(1, std::memory_order_release) + 1;
+            for (const auto& entry : callbacks_) entry.second(*old_snapshot, *next);
+            return version;
         }
         
-        void schedule_at(TimePoint execute_time, Task task, const std::string& name) {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            task_queue_.push({execute_time, std::move(task), name});
-            cv_.notify_one();
+    public:
+        explicit SnapshotHolder(T initial) : current_(std::make_shared<const T>(std::move(initial))) {}
+        
+        SnapshotHolder(const SnapshotHolder&) = delete;
+        SnapshotHolder& operator=(const SnapshotHolder&) = delete;
+        
+        // 任意线程：取得当前版本，返回的快照在持有期间永远不会变化
+        Snapshot load() const { return std::atomic_load(&current_); }
+        
+        uint64_t version() const { return version_.load(std::memory_order_acquire); }
+        
+        // 复制当前版本，交给mutate修改后整体发布，返回新版本号
+        template<typename Mutator>
+        uint64_t update(Mutator&& mutate) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            Snapshot old_snapshot = std::atomic_load(&current_);
+            auto next = std::make_shared<T>(*old_snapshot);
+            mutate(*next);
+            return publish_locked(old_snapshot, std::move(next));
         }
+        
+        // 整体替换（例如重新加载配置文件），省掉一次复制
+        uint64_t publish(T value) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            Snapshot old_snapshot = std::atomic_load(&current_);
+            return publish_locked(old_snapshot, std::make_shared<const T>(std::move(value)));
+        }
+        
+        uint64_t subscribe(Callback callback) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            callbacks_.emplace_back(next_callback_id_, std::move(callback));
+            return next_callback_id_++;
+        }
+        
+        bool unsubscribe(uint64_t id) {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            auto it = std::find_if(callbacks_.begin(), callbacks_.end(),
+                                   [id](const std::pair<uint64_t, Callback>& entry) { return entry.first == id; });
+            if (it == callbacks_.end()) return false;
+            callbacks_.erase(it);
+            return true;
+        }
+        
+        // 每个线程各持有一个Reader，不能跨线程共享
+        class Reader {
+            const SnapshotHolder* holder_;
+            uint64_t cached_version_ = 0;
+            Snapshot cached_;
+            
+        public:
+            explicit Reader(const SnapshotHolder& holder) : holder_(&holder) {}
+            
+            // 返回的引用在本Reader下一次get()之前一直有效
+            const T& get() {
+                // 先读版本再取指针：取到的指针至少和该版本一样新，最坏只是下次多刷新一次
+                const uint64_t version = holder_->version_.load(std::memory_order_acquire);
+                if (version != cached_version_) {
+                    cached_ = holder_->load();
+                    cached_version_ = version;
+                }
+                return *cached_;
+            }
+            
+            Snapshot snapshot() {
+                get();
+                return cached_;
+            }
+            
+            uint64_t version() const { return cached_version_; }
+        };
+        
+        Reader reader() const { return Reader(*this); }
     };
     
-    // 配置管理系统
+    // 配置管理系统：配置整体是不可变快照，读取不加锁，修改走复制-发布
     class ConfigurationManager {
-    private:
+    public:
         using ConfigTuple = std::tuple<int, std::string, bool, double, std::vector<std::string>>;
-        ConfigTuple config_;
+        using ConfigReader = SnapshotHolder<ConfigTuple>::Reader;
+        
+    private:
+        SnapshotHolder<ConfigTuple> config_;
         std::string config_file_;
-        std::mutex config_mutex_;
         
     public:
-        ConfigurationManager(const std::string& file) : config_file_(file) {
-            // 默认配置
-            config_ = std::make_tuple(8080, "localhost", false, 30.0, std::vector<std::string>{"user", "admin"});
-        }
+        // 默认配置
+        ConfigurationManager(const std::string& file)
+            : config_(std::make_tuple(8080, "localhost", false, 30.0, std::vector<std::string>{"user", "admin"})),
+              config_file_(file) {}
         
-        // 获取配置项
+        // 获取配置项：一次原子读取快照，无需锁
         template<typename T>
         T get_config() const {
-            std::lock_guard<std::mutex> lock(config_mutex_);
-            return std::get<T>(config_);
+            return std::get<T>(*config_.load());
         }
         
-        // 设置配置项
+        // 设置配置项：在副本上std::exchange后发布新版本
         template<typename T>
         void set_config(T value) {
-            std::lock_guard<std::mutex> lock(config_mutex_);
-            auto old_value = std::exchange(std::get<T>(config_), value);
+            T old_value{};
+            config_.update([&](ConfigTuple& config) { old_value = std::exchange(std::get<T>(config), value); });
             std::cout << "配置更新: " << typeid(T).name() 
                      << " = " << value << " (旧值: " << old_value << ")\n";
         }
         
+        // 重新加载：整份配置一次发布，读者要么看到全部旧值，要么看到全部新值
+        uint64_t reload(ConfigTuple fresh) { return config_.publish(std::move(fresh)); }
+        
+        SnapshotHolder<ConfigTuple>::Snapshot snapshot() const { return config_.load(); }
+        ConfigReader reader() const { return config_.reader(); }
+        uint64_t version() const { return config_.version(); }
+        
+        uint64_t on_change(SnapshotHolder<ConfigTuple>::Callback callback) { return config_.subscribe(std::move(callback)); }
+        bool remove_listener(uint64_t id) { return config_.unsubscribe(id); }
+        
         // 打印配置
         void print_config() const {
-            std::lock_guard<std::mutex> lock(config_mutex_);
-            std::cout << "当前配置:\n";
-            std::cout << "  端口: " << std::get<int>(config_) << "\n";
-            std::cout << "  主机: " << std::get<std::string>(config_) << "\n";
-            std::cout << "  调试: " << (std::get<bool>(config_) ? "是" : "否") << "\n";
-            std::cout << "  超时: " << std::get<double>(config_) << "s\n";
+            const auto snapshot = config_.load();  // 整个打印过程使用同一版本
+            const ConfigTuple& config = *snapshot;
+            std::cout << "当前配置(版本 " << config_.version() << "):\n";
+            std::cout << "  端口: " << std::get<int>(config) << "\n";
+            std::cout << "  主机: " << std::get<std::string>(config) << "\n";
+            std::cout << "  调试: " << (std::get<bool>(config) ? "是" : "否") << "\n";
+            std::cout << "  超时: " << std::get<double>(config) << "s\n";
             
-            const auto& roles = std::get<std::vector<std::string>>(config_);
+            const auto& roles = std::get<std::vector<std::string>>(config);
             std::cout << "  角色: ";
             for (const auto& role : roles) {
                 std::cout << role << " ";
@@ -759,16 +1558,227 @@ namespace ComprehensiveExamples {
             std::cout << "\n";
         }
     };
+    
+    // 第generation代配置：端口和超时由同一代数推出，读者据此检查是否读到了撕裂的配置
+    inline ConfigurationManager::ConfigTuple make_generation_config(uint64_t generation) {
+        return ConfigurationManager::ConfigTuple(
+            8000 + static_cast<int>(generation % 1000), "host-" + std::to_string(generation),
+            generation % 2 == 0, static_cast<double>(generation), std::vector<std::string>{"user", "admin"});
+    }
+    
+    inline bool config_consistent(const ConfigurationManager::ConfigTuple& config) {
+        const uint64_t generation = static_cast<uint64_t>(std::get<double>(config));
+        return std::get<int>(config) == 8000 + static_cast<int>(generation % 1000) &&
+               std::get<bool>(config) == (generation % 2 == 0);
+    }
+    
+    // 对照组：原来的做法，读写共用一把锁
+    class MutexConfigStore {
+        ConfigurationManager::ConfigTuple config_;
+        mutable std::mutex mutex_;
+        
+    public:
+        void reload(ConfigurationManager::ConfigTuple fresh) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            config_ = std::move(fresh);
+        }
+        
+        // 请求路径上的一次读取：取端口、超时和主机名长度
+        bool read(uint64_t& checksum) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            checksum += static_cast<uint64_t>(std::get<int>(config_)) + std::get<std::string>(config_).size();
+            return config_consistent(config_);
+        }
+    };
+    
+    inline bool read_config(const ConfigurationManager::ConfigTuple& config, uint64_t& checksum) {
+        checksum += static_cast<uint64_t>(std::get<int>(config)) + std::get<std::string>(config).size();
+        return config_consistent(config);
+    }
+    
+    // readers个线程持续读取，写线程按reload_interval重载（0表示不停重载）
+    template<typename Store, typename ReadFactory>
+    void run_config_read_benchmark(const char* name, Store& store, int readers,
+                                   std::chrono::microseconds reload_interval, ReadFactory make_read) {
+        const auto duration = std::chrono::milliseconds(200);
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> total_reads{0};
+        std::atomic<bool> torn{false};
+        std::atomic<uint64_t> sink{0};
+        uint64_t generation = 0;
+        store.reload(make_generation_config(generation));  // 默认配置不满足一致性关系，先换成第0代
+        
+        std::vector<std::thread> reader_threads;
+        for (int r = 0; r < readers; ++r) {
+            reader_threads.emplace_back([&] {
+                auto read = make_read();  // 每个线程自己的读取器
+                uint64_t local_reads = 0, checksum = 0;
+                bool local_torn = false;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    for (int i = 0; i < 64; ++i) local_torn |= !read(checksum);
+                    local_reads += 64;
+                }
+                total_reads.fetch_add(local_reads);
+                sink.fetch_add(checksum);
+                if (local_torn) torn.store(true);
+            });
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < duration) {
+            store.reload(make_generation_config(++generation));
+            if (reload_interval.count() > 0) std::this_thread::sleep_for(reload_interval);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stop.store(true);
+        for (auto& t : reader_threads) t.join();
+        
+        std::cout << "  " << name << " 读者" << readers << ": 读取 " << std::fixed << std::setprecision(1)
+                  << total_reads.load() / seconds / 1e6 << " M次/秒, 重载 " << generation / seconds
+                  << " 次/秒, " << (torn.load() ? "读到撕裂配置!" : "配置一致") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+    
+    inline void benchmark_config_snapshots() {
+        std::cout << "\n读多写少的配置读取 (硬件线程数 " << std::thread::hardware_concurrency() << "):\n";
+        const std::chrono::microseconds intervals[] = {std::chrono::microseconds(1000), std::chrono::microseconds(0)};
+        for (auto interval : intervals) {
+            std::cout << (interval.count() > 0 ? " 每毫秒重载一次:\n" : " 连续重载:\n");
+            for (int readers : {1, 4}) {
+                MutexConfigStore locked;
+                run_config_read_benchmark("mutex       ", locked, readers, interval, [&locked] {
+                    return [&locked](uint64_t& checksum) { return locked.read(checksum); };
+                });
+                
+                ConfigurationManager atomic_manager("bench.config");
+                run_config_read_benchmark("atomic_load ", atomic_manager, readers, interval, [&atomic_manager] {
+                    return [&atomic_manager](uint64_t& checksum) { return read_config(*atomic_manager.snapshot(), checksum); };
+                });
+                
+                ConfigurationManager cached_manager("bench.config");
+                run_config_read_benchmark("版本号Reader", cached_manager, readers, interval, [&cached_manager] {
+                    auto reader = std::make_shared<ConfigurationManager::ConfigReader>(cached_manager.reader());
+                    return [reader](uint64_t& checksum) { return read_config(reader->get(), checksum); };
+                });
+            }
+        }
+    }
+    
+    inline void demonstrate_config_snapshots() {
+        std::cout << "\n=== RCU风格配置快照 ===\n";
+        
+        ConfigurationManager manager("app.config");
+        
+        // 变更回调拿到新旧两份完整快照，可以只对关心的字段做差异处理
+        uint64_t listener = manager.on_change([](const ConfigurationManager::ConfigTuple& old_config,
+                                                 const ConfigurationManager::ConfigTuple& new_config) {
+            if (std::get<int>(old_config) != std::get<int>(new_config)) {
+                std::cout << "  [回调] 端口 " << std::get<int>(old_config) << " -> " << std::get<int>(new_config) << "\n";
+            }
+            if (std::get<std::string>(old_config) != std::get<std::string>(new_config)) {
+                std::cout << "  [回调] 主机 " << std::get<std::string>(old_config) << " -> "
+                          << std::get<std::string>(new_config) << "\n";
+            }
+        });
+        
+        // 读者持有的旧快照不受后续发布影响
+        auto before = manager.snapshot();
+        auto reader = manager.reader();
+        std::cout << "Reader初次读取: 端口 " << std::get<int>(reader.get()) << ", 版本 " << reader.version() << "\n";
+        
+        manager.set_config<int>(9443);
+        manager.reload(std::make_tuple(7000, std::string("config.example.com"), true, 5.0,
+                                       std::vector<std::string>{"ops"}));
+        
+        std::cout << "Reader再次读取: 端口 " << std::get<int>(reader.get()) << ", 版本 " << reader.version() << "\n";
+        std::cout << "旧快照仍然是: 端口 " << std::get<int>(*before) << ", 主机 " << std::get<std::string>(*before)
+                  << " (引用计数 " << before.use_count() << ")\n";
+        
+        manager.remove_listener(listener);
+        manager.set_config<int>(7001);  // 已注销，不再触发回调
+        manager.print_config();
+        
+        benchmark_config_snapshots();
+        std::cout << "\n";
+    }
+}
+
+// ===== 10. 统一微基准测试套件 =====
+
+namespace BenchmarkSuite {
+    using ChronoLiterals::BenchmarkConfig;
+    using ChronoLiterals::PerformanceBenchmark;
+    using ChronoLiterals::do_not_optimize;
+    
+    void benchmark_containers(PerformanceBenchmark& bench) {
+        IteratorUtilities::CircularBuffer<int> ring(1024, IteratorUtilities::OverflowPolicy::OverwriteOldest);
+        int value = 0;
+        bench.run("环形缓冲push+pop", [&]() {
+            for (int i = 0; i < 256; ++i) ring.push_back(value++);
+            int sum = 0;
+            for (int i = 0; i < 256; ++i) sum += ring.pop_front();
+            do_not_optimize(sum);
+        }, 256);
+        
+        // 节点池处于稳态：每轮取消的节点被下一轮复用，不再分配
+        using ComprehensiveExamples::TimingWheel;
+        const auto start = TimingWheel::clock::now();
+        TimingWheel wheel(std::chrono::milliseconds(1), start);
+        wheel.reserve(1024);
+        std::vector<TimingWheel::Handle> handles(1024);
+        uint32_t delay = 1;
+        bench.run("时间轮调度+取消", [&]() {
+            for (auto& handle : handles) {
+                delay = delay * 1103515245u + 12345u;
+                handle = wheel.schedule_at(start + std::chrono::milliseconds(1 + (delay >> 8) % 60000), []() {});
+            }
+            for (auto& handle : handles) wheel.cancel(handle);
+            do_not_optimize(wheel.size());
+        }, handles.size());
+    }
+    
+    // 登记本文件的所有微基准；新增的基准加在这里，--bench模式和正常演示都会运行
+    void register_all(PerformanceBenchmark& bench) {
+        AlgorithmExtensions::benchmark_algorithms(bench);
+        benchmark_containers(bench);
+    }
+    
+    // 只跑基准套件，JSON/CSV由micro_bench::init解析的参数决定，用于在不同编译器版本之间追踪性能回归：
+    //   ./stdlib_features --bench --json=gcc12.json --csv=gcc12.csv
+    // 不加--bench时，正常演示中跑过的所有基准同样会被导出
+    int run_benchmarks_only() {
+        PerformanceBenchmark bench("cpp14_stdlib");
+        register_all(bench);
+        bench.print_report();
+        return micro_bench::write_reports();
+    }
+    
+    void demonstrate_benchmark_suite() {
+        std::cout << "\n===== 10. 统一微基准测试套件 =====\n";
+        PerformanceBenchmark bench("cpp14_stdlib");
+        register_all(bench);
+        bench.print_report();
+        
+        std::cout << "CSV输出:\n";
+        bench.write_csv(std::cout);
+        std::cout << "\n";
+    }
 }
 
 } // namespace cpp14_stdlib
 
 // ===== 主函数 =====
 
-int main() {
-    std::cout << "=== C++14 标准库新特性深度解析 ===\n";
-    
+int main(int argc, char* argv[]) {
     using namespace cpp14_stdlib;
+    micro_bench::init(argc, argv);
+    
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return BenchmarkSuite::run_benchmarks_only();
+    }
+    
+    std::cout << "=== C++14 标准库新特性深度解析 ===\n";
     
     // 1. Chrono字面值演示
     std::cout << "\n===== 1. Chrono字面值演示 =====\n";
@@ -873,6 +1883,31 @@ int main() {
     }
     std::cout << "\n";
     
+    // 覆盖模式 + 两段式零拷贝读写
+    CircularBuffer<int> window(4, OverflowPolicy::OverwriteOldest);
+    for (int i = 1; i <= 6; ++i) {
+        window.push_back(i);
+    }
+    auto writable = window.push_span(3);
+    int next_value = 100;
+    for (size_t i = 0; i < writable.first_size; ++i) writable.first[i] = next_value++;
+    for (size_t i = 0; i < writable.second_size; ++i) writable.second[i] = next_value++;
+    window.commit_push(writable.size());
+    
+    auto readable = window.read_span();
+    std::cout << "覆盖模式窗口(" << readable.first_size << "+" << readable.second_size << "段): ";
+    for (size_t i = 0; i < readable.first_size; ++i) std::cout << readable.first[i] << " ";
+    for (size_t i = 0; i < readable.second_size; ++i) std::cout << readable.second[i] << " ";
+    std::cout << "\n";
+    
+    std::cout << "环绕后正向遍历: ";
+    for (const auto& item : window) std::cout << item << " ";
+    std::cout << "\n环绕后反向遍历: ";
+    for (auto it = window.rbegin(); it != window.rend(); ++it) std::cout << *it << " ";
+    std::cout << "\n";
+    
+    benchmark_telemetry_windows();
+    
     // 7. 综合应用演示
     std::cout << "\n===== 7. 综合应用演示 =====\n";
     using namespace ComprehensiveExamples;
@@ -887,8 +1922,12 @@ int main() {
     
     config_manager.print_config();
     
+    demonstrate_config_snapshots();
+    
+    demonstrate_task_scheduler();
+    
     // 性能测试
-    AlgorithmExtensions::benchmark_algorithms();
+    BenchmarkSuite::demonstrate_benchmark_suite();
     
     // 定时器演示
     std::cout << "\n===== 定时器演示 =====\n";
@@ -910,6 +1949,8 @@ int main() {
 编译和运行建议:
 g++ -std=c++14 -O2 -Wall -pthread 06_stdlib_new_features.cpp -o stdlib_features
 ./stdlib_features
+./stdlib_features --bench --json=result.json --csv=result.csv   # 只运行基准套件
+./stdlib_features --json=all.json                               # 完整演示，并导出其中跑过的全部基准
 
 关键学习点:
 1. Chrono字面值提供了直观的时间单位表示，使时间相关的代码更加清晰
@@ -918,12 +1959,20 @@ g++ -std=c++14 -O2 -Wall -pthread 06_stdlib_new_features.cpp -o stdlib_features
 4. std::get按类型访问增强了元组的易用性，使配置系统更加类型安全
 5. 类型特征别名模板(_t后缀)简化了模板编程的代码
 6. std::make_reverse_iterator提供了更灵活的迭代器适配器
+   环形缓冲区的零拷贝接口最多返回两段连续内存；单写多读场景可用seqlock式快照避免读者阻塞写者
 7. 这些库改进体现了C++14对实际编程问题的关注和解决
+8. 分层时间轮用数组槽位加侵入式链表实现O(1)调度/取消，到期任务整批取出在锁外执行
+9. 可信的微基准需要预热、多次采样和稳健统计（中位数、p99、置信区间），并用do_not_optimize阻止死代码消除
+10. 读多写少的配置用不可变快照加复制-发布：读者不加锁，写者整体替换，旧版本靠引用计数在最后一个读者放手后回收
 
 注意事项:
 - Chrono字面值需要using namespace std::chrono_literals;或using声明
 - std::make_unique比直接使用new更安全，避免了内存泄漏
 - std::exchange在多线程环境中需要配合原子类型使用
+- SnapshotRing只允许一个写线程，元素必须可平凡复制；读者拿到的条数可能少于请求数
+- libstdc++的std::atomic_load(shared_ptr)并非无锁；热路径用每线程的版本号Reader，变更回调在写锁内执行，不能在回调里再修改配置
 - std::get按类型访问要求类型在元组中唯一，否则会编译错误
+- 定时任务应使用steady_clock，system_clock会随系统时间调整跳变；时间轮的精度是一个tick
+- 硬件计数器依赖perf_event_open，受perf_event_paranoid和容器权限限制；不可用时只报告时间，虚拟机里的数字偏差也更大
 - C++14的库改进主要是完善C++11，没有引入重大的概念性变化
 */
\ No newline at end of file
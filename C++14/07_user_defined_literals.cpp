@@ -6,6 +6,9 @@
  * 2. std::string_literals - 字符串字面值的std::string对象
  * 3. std::complex_literals - 复数字面值的便捷创建
  * 
+ * 综合示例中的Profiler用chrono的时间单位展示结果：热路径无锁的分层性能分析器，
+ * 支持按线程缓冲、调用树聚合和Chrome trace导出
+ * 
  * 用户定义字面值的核心价值：
  * - 提高代码的可读性和表达力
  * - 减少类型转换的显式代码
@@ -26,6 +29,25 @@
 #include <mutex>
 #include <cmath>
 #include <limits>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <list>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
 
 namespace cpp14_udl {
 
@@ -216,64 +238,405 @@ namespace ChronoUDL {
         }
     };
     
-    // 性能分析器
+    // 性能分析器：热路径无锁
+    // 每个线程写自己的单生产者环形缓冲区，区域名是静态字符串（按地址记录，不拷贝），
+    // 时间戳默认用rdtsc、启动时对照steady_clock校准；加锁只发生在线程首次使用和收集时。
+    // 收集时按线程重建调用树并聚合，也可以导出Chrome trace / Perfetto可读的JSON
     class Profiler {
+    public:
+        enum class ClockSource { Tsc, Steady };
+        
+        struct Event {
+            const char* name;
+            uint64_t start;
+            uint64_t end;
+            uint32_t depth;
+        };
+        
     private:
-        struct ProfileEntry {
-            std::string name;
-            std::chrono::nanoseconds duration;
-            size_t call_count;
+        // 单生产者单消费者环：所属线程写head，收集者写tail；满了就丢弃并计数，不阻塞
+        struct ThreadBuffer {
+            ThreadBuffer(size_t capacity, uint64_t owner_id, uint32_t buffer_index)
+                : events(capacity), mask(capacity - 1), owner(owner_id), index(buffer_index) {}
+            
+            void push(const char* name, uint64_t start, uint64_t end, uint32_t event_depth) {
+                const uint64_t h = head.load(std::memory_order_relaxed);
+                if (h - tail.load(std::memory_order_acquire) > mask) {
+                    dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return;
+                }
+                events[h & mask] = Event{name, start, end, event_depth};
+                head.store(h + 1, std::memory_order_release);
+            }
+            
+            void drain(std::vector<Event>& out) {
+                uint64_t t = tail.load(std::memory_order_relaxed);
+                const uint64_t h = head.load(std::memory_order_acquire);
+                for (; t != h; ++t) out.push_back(events[t & mask]);
+                tail.store(h, std::memory_order_release);
+            }
+            
+            std::vector<Event> events;
+            const uint64_t mask;
+            const uint64_t owner;  // 线程序号（thread_serial），不是系统线程id
+            const uint32_t index;
+            uint32_t depth = 0;  // 当前嵌套深度，只有所属线程访问
+            std::atomic<uint64_t> head{0};
+            char pad_[64];       // head与tail分属不同线程，隔开避免伪共享
+            std::atomic<uint64_t> tail{0};
+            std::atomic<uint64_t> dropped{0};
         };
         
-        std::vector<ProfileEntry> entries_;
-        std::mutex entries_mutex_;
+        struct TreeNode {
+            const char* name = nullptr;
+            uint64_t calls = 0;
+            uint64_t total = 0;
+            uint64_t children_total = 0;
+            std::vector<std::unique_ptr<TreeNode>> children;
+            
+            // 同一个字面值在不同翻译单元可能地址不同，地址不等时再比较内容
+            TreeNode* child(const char* child_name) {
+                for (auto& c : children) {
+                    if (c->name == child_name || std::strcmp(c->name, child_name) == 0) return c.get();
+                }
+                children.push_back(std::make_unique<TreeNode>());
+                children.back()->name = child_name;
+                return children.back().get();
+            }
+        };
+        
+        const uint64_t id_;
+        const size_t capacity_;
+        const ClockSource source_;
+        const double ns_per_tick_;
+        mutable std::mutex entries_mutex_;  // 只保护缓冲区登记表和已收集的事件
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+        std::vector<std::vector<Event>> collected_;
+        
+        static uint64_t next_profiler_id() {
+            static std::atomic<uint64_t> counter{0};
+            return ++counter;
+        }
+        
+        static uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+        
+        static uint64_t read_steady() {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+        
+        // 在约10ms内同时读取两种时钟，得到每个TSC周期对应的纳秒数；整个进程只校准一次
+        static double tsc_ns_per_tick() {
+            static const double ratio = []() {
+                const uint64_t ns0 = read_steady();
+                const uint64_t tsc0 = read_tsc();
+                while (read_steady() - ns0 < 10'000'000) {}
+                const uint64_t ns1 = read_steady();
+                const uint64_t tsc1 = read_tsc();
+                return tsc1 > tsc0 ? static_cast<double>(ns1 - ns0) / static_cast<double>(tsc1 - tsc0) : 1.0;
+            }();
+            return ratio;
+        }
+        
+        // 热路径：线程本地缓存命中时只是一次比较
+        ThreadBuffer& local_buffer() {
+            thread_local uint64_t cached_id = 0;
+            thread_local ThreadBuffer* cached = nullptr;
+            if (cached_id != id_) {
+                cached = &register_thread();
+                cached_id = id_;
+            }
+            return *cached;
+        }
+        
+        // 进程内每个线程领取一个递增序号；std::thread::id在线程退出后可能被新线程复用，
+        // 用它做键会让新线程接着写已退出线程的缓冲区，trace里两个线程混在同一条轨道上
+        static uint64_t thread_serial() {
+            static std::atomic<uint64_t> counter{0};
+            thread_local const uint64_t serial = ++counter;
+            return serial;
+        }
+        
+        ThreadBuffer& register_thread() {
+            const uint64_t self = thread_serial();
+            std::lock_guard<std::mutex> lock(entries_mutex_);
+            for (auto& buffer : buffers_) {
+                if (buffer->owner == self) return *buffer;
+            }
+            buffers_.push_back(std::make_unique<ThreadBuffer>(capacity_, self, static_cast<uint32_t>(buffers_.size())));
+            collected_.emplace_back();
+            return *buffers_.back();
+        }
+        
+        static size_t round_up_pow2(size_t n) {
+            size_t p = 1;
+            while (p < n) p <<= 1;
+            return p;
+        }
+        
+        void print_node(const TreeNode& node, int indent, uint64_t parent_total) const {
+            const auto total = std::chrono::nanoseconds(static_cast<int64_t>(to_ns(node.total)));
+            const auto self = std::chrono::nanoseconds(static_cast<int64_t>(to_ns(node.total - node.children_total)));
+            std::cout << std::string(static_cast<size_t>(indent) * 2, ' ') << node.name
+                      << "  调用" << node.calls << "次"
+                      << "  总计 " << TimeCalculator(total).to_string()
+                      << "  自身 " << TimeCalculator(self).to_string()
+                      << "  平均 " << TimeCalculator(total / static_cast<int64_t>(node.calls)).to_string();
+            if (parent_total > 0) {
+                std::cout << "  占父级 " << std::fixed << std::setprecision(1)
+                          << 100.0 * static_cast<double>(node.total) / static_cast<double>(parent_total) << "%"
+                          << std::defaultfloat << std::setprecision(6);
+            }
+            std::cout << "\n";
+            for (const auto& child : node.children) {
+                print_node(*child, indent + 1, node.total);
+            }
+        }
+        
+        static void write_json_string(std::ostream& out, const char* s) {
+            out << '"';
+            for (; *s; ++s) {
+                const unsigned char c = static_cast<unsigned char>(*s);
+                if (c == '"' || c == '\\') {
+                    out << '\\' << *s;
+                } else if (c < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                        << std::dec << std::setfill(' ');
+                } else {
+                    out << *s;
+                }
+            }
+            out << '"';
+        }
         
     public:
+        explicit Profiler(size_t events_per_thread = 1 << 16, ClockSource source = ClockSource::Tsc)
+            : id_(next_profiler_id()), capacity_(round_up_pow2(std::max<size_t>(events_per_thread, 2))),
+              source_(source), ns_per_tick_(source == ClockSource::Tsc ? tsc_ns_per_tick() : 1.0) {}
+        
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+        
+        uint64_t now() const {
+            return source_ == ClockSource::Tsc ? read_tsc() : read_steady();
+        }
+        
+        double to_ns(uint64_t ticks) const {
+            return static_cast<double>(ticks) * ns_per_tick_;
+        }
+        
+        // 作用域计时：名字必须是静态存储期的字符串（建议用PROFILE_ZONE宏，强制字面值）
         class ScopeTimer {
         private:
             Profiler& profiler_;
-            std::string name_;
-            std::chrono::high_resolution_clock::time_point start_;
+            ThreadBuffer& buffer_;
+            const char* name_;
+            uint32_t depth_;
+            uint64_t start_;
             
         public:
-            ScopeTimer(Profiler& profiler, const std::string& name)
-                : profiler_(profiler), name_(name), start_(std::chrono::high_resolution_clock::now()) {}
+            ScopeTimer(Profiler& profiler, const char* name)
+                : profiler_(profiler), buffer_(profiler.local_buffer()), name_(name),
+                  depth_(buffer_.depth++), start_(profiler.now()) {}
+            
+            ScopeTimer(const ScopeTimer&) = delete;
+            ScopeTimer& operator=(const ScopeTimer&) = delete;
             
             ~ScopeTimer() {
-                auto duration = std::chrono::high_resolution_clock::now() - start_;
-                profiler_.add_entry(name_, duration);
+                const uint64_t end = profiler_.now();
+                buffer_.push(name_, start_, end, depth_);
+                --buffer_.depth;
             }
         };
         
-        void add_entry(const std::string& name, std::chrono::nanoseconds duration) {
+        // 把各线程缓冲区里已结束的区域搬到收集区；可以在其他线程仍在记录时调用
+        void collect() {
             std::lock_guard<std::mutex> lock(entries_mutex_);
+            for (size_t i = 0; i < buffers_.size(); ++i) {
+                buffers_[i]->drain(collected_[i]);
+            }
+        }
+        
+        uint64_t dropped() const {
+            std::lock_guard<std::mutex> lock(entries_mutex_);
+            uint64_t total = 0;
+            for (const auto& buffer : buffers_) total += buffer->dropped.load(std::memory_order_relaxed);
+            return total;
+        }
+        
+        // 按嵌套关系聚合所有线程的调用树：同一路径上的同名区域合并
+        void print_report() {
+            collect();
+            TreeNode root;
+            size_t threads = 0;
+            {
+                std::lock_guard<std::mutex> lock(entries_mutex_);
+                for (auto& events : collected_) {
+                    if (events.empty()) continue;
+                    ++threads;
+                    // 父区域先开始；同一时刻开始时深度小的在前
+                    std::vector<Event> sorted(events);
+                    std::sort(sorted.begin(), sorted.end(), [](const Event& a, const Event& b) {
+                        return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+                    });
+                    std::vector<TreeNode*> path;
+                    for (const Event& e : sorted) {
+                        path.resize(std::min<size_t>(path.size(), e.depth));
+                        TreeNode* parent = path.empty() ? &root : path.back();
+                        TreeNode* node = parent->child(e.name);
+                        const uint64_t duration = e.end - e.start;
+                        ++node->calls;
+                        node->total += duration;
+                        if (parent != &root) parent->children_total += duration;
+                        path.push_back(node);
+                    }
+                }
+            }
             
-            auto it = std::find_if(entries_.begin(), entries_.end(),
-                                 [&name](const ProfileEntry& entry) {
-                                     return entry.name == name;
-                                 });
-            
-            if (it != entries_.end()) {
-                it->duration += duration;
-                it->call_count++;
-            } else {
-                entries_.push_back({name, duration, 1});
+            std::cout << "\n=== 性能分析报告（" << threads << "个线程"
+                      << (source_ == ClockSource::Tsc ? "，TSC计时" : "，steady_clock计时") << "）===\n";
+            for (const auto& child : root.children) {
+                print_node(*child, 0, 0);
+            }
+            if (const uint64_t lost = dropped()) {
+                std::cout << "警告: 缓冲区已满丢弃了" << lost << "个区域，调用树可能不完整\n";
             }
         }
         
-        void print_report() const {
+        // Chrome trace事件格式（"X"完整事件，时间单位微秒），可直接拖进ui.perfetto.dev或chrome://tracing
+        size_t export_chrome_trace(std::ostream& out) {
+            collect();
             std::lock_guard<std::mutex> lock(entries_mutex_);
+            uint64_t origin = std::numeric_limits<uint64_t>::max();
+            for (const auto& events : collected_) {
+                for (const Event& e : events) origin = std::min(origin, e.start);
+            }
             
-            std::cout << "\n=== 性能分析报告 ===\n";
-            for (const auto& entry : entries_) {
-                auto avg_duration = entry.duration / entry.call_count;
-                std::cout << entry.name << ":\n";
-                std::cout << "  总时间: " << TimeCalculator(entry.duration).to_string() << "\n";
-                std::cout << "  调用次数: " << entry.call_count << "\n";
-                std::cout << "  平均时间: " << TimeCalculator(avg_duration).to_string() << "\n";
+            const auto flags = out.flags();
+            const auto precision = out.precision();
+            out << std::fixed << std::setprecision(3);
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            size_t written = 0;
+            for (size_t tid = 0; tid < collected_.size(); ++tid) {
+                for (const Event& e : collected_[tid]) {
+                    out << (written++ == 0 ? "\n" : ",\n") << "{\"name\":";
+                    write_json_string(out, e.name);
+                    out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid + 1
+                        << ",\"ts\":" << to_ns(e.start - origin) / 1000.0
+                        << ",\"dur\":" << to_ns(e.end - e.start) / 1000.0 << "}";
+                }
             }
+            out << "\n]}\n";
+            out.flags(flags);
+            out.precision(precision);
+            return written;
         }
     };
+    
+#define PROFILE_ZONE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_IMPL(a, b)
+// 名字前拼接""，传入非字面值时编译失败，保证名字有静态存储期
+#define PROFILE_ZONE(profiler, name) \
+    ::cpp14_udl::ChronoUDL::Profiler::ScopeTimer PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)((profiler), "" name)
+    
+    // 测量每个空区域的开销，并单独给出一次时钟读取的开销：区域开销 ≈ 2次读时钟 + 写一条记录
+    inline void benchmark_profiler_overhead() {
+        constexpr size_t zones = 60000;  // 小于缓冲区容量，避免走丢弃路径
+        constexpr int rounds = 20;
+        
+        struct Cost {
+            double zone;
+            double clock_read;
+        };
+        auto measure = [](Profiler::ClockSource source) {
+            Profiler profiler(1 << 17, source);
+            Cost best{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+            for (int r = 0; r < rounds; ++r) {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < zones; ++i) {
+                    PROFILE_ZONE(profiler, "空区域");
+                }
+                auto mid = std::chrono::steady_clock::now();
+                volatile uint64_t sink = 0;  // 防止读时钟被优化掉
+                for (size_t i = 0; i < zones; ++i) sink = profiler.now();
+                (void)sink;
+                auto end = std::chrono::steady_clock::now();
+                best.zone = std::min(best.zone, std::chrono::duration<double, std::nano>(mid - start).count() / zones);
+                best.clock_read = std::min(best.clock_read,
+                                           std::chrono::duration<double, std::nano>(end - mid).count() / zones);
+                profiler.collect();
+            }
+            return best;
+        };
+        
+        const Cost tsc = measure(Profiler::ClockSource::Tsc);
+        const Cost steady = measure(Profiler::ClockSource::Steady);
+        std::cout << std::fixed << std::setprecision(1)
+                  << "每个区域的记录开销: TSC " << tsc.zone << " ns（读一次时钟 " << tsc.clock_read << " ns）, "
+                  << "steady_clock " << steady.zone << " ns（读一次时钟 " << steady.clock_read << " ns）\n"
+                  << std::defaultfloat << std::setprecision(6);
+    }
+    
+    // 进程级分析器，任何demonstrate_*函数都可以直接在里面放PROFILE_ZONE
+    inline Profiler& global_profiler() {
+        static Profiler profiler;
+        return profiler;
+    }
+    
+    inline void busy_work(unsigned iterations) {
+        volatile unsigned sink = 0;
+        for (unsigned i = 0; i < iterations; ++i) sink = sink + i;
+    }
+    
+    // trace_path为空时只在内存中导出并报告大小，不在当前目录留下文件
+    inline void demonstrate_profiler(const char* trace_path = nullptr) {
+        PROFILE_ZONE(global_profiler(), "Profiler演示");
+        std::cout << "\n--- 嵌套区域、多线程与trace导出 ---\n";
+        
+        Profiler profiler;
+        auto worker = [&profiler](unsigned id) {
+            PROFILE_ZONE(profiler, "处理请求批次");
+            for (int i = 0; i < 200; ++i) {
+                PROFILE_ZONE(profiler, "处理请求");
+                {
+                    PROFILE_ZONE(profiler, "解析");
+                    busy_work(2000 + id * 1000);
+                }
+                {
+                    PROFILE_ZONE(profiler, "计算");
+                    busy_work(5000);
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned id = 0; id < 3; ++id) threads.emplace_back(worker, id);
+        for (auto& t : threads) t.join();
+        profiler.print_report();
+        
+        if (trace_path != nullptr && *trace_path != '\0') {
+            std::ofstream trace(trace_path);
+            if (trace) {
+                const size_t exported = profiler.export_chrome_trace(trace);
+                std::cout << "已导出" << exported << "个区域到" << trace_path << "（可用ui.perfetto.dev打开）\n";
+            } else {
+                std::cout << "无法写入trace文件: " << trace_path << "\n";
+            }
+        } else {
+            std::ostringstream trace;
+            const size_t exported = profiler.export_chrome_trace(trace);
+            std::cout << "trace共" << exported << "个区域、" << trace.str().size()
+                      << "字节；设置环境变量PROFILE_TRACE=<路径>可写入文件\n";
+        }
+        
+        benchmark_profiler_overhead();
+    }
 }
 
 // ===== 2. std::string_literals 深度解析 =====
@@ -787,6 +1150,425 @@ namespace CustomUDL {
     }
 }
 
+// ===== 5. 线程安全的内存池分配器 =====
+// FixedSizeAllocator只能顺序分配、不能单独释放、用完即抛异常，这里把它推广为SlabPool：
+// 1. 按大小分级(16~512字节)，每级一条空闲链表，释放是O(1)的链表头插
+// 2. 每个线程持有本地缓存，空了才加锁从中心池批量取，攒多了批量归还
+// 3. 中心池按块(chunk)向上游申请内存，可以链式增长，也可以固定容量
+// 4. 对外提供标准分配器PoolAllocator<T>，C++17下另提供std::pmr::memory_resource
+
+namespace MemoryPool {
+    class SlabPool {
+    public:
+        struct Options {
+            size_t chunk_bytes;   // 每次向上游申请的块大小
+            size_t max_chunks;    // 0表示不限制块数
+            bool allow_growth;    // false时只使用构造时申请的第一个块
+        };
+        
+        struct Stats {
+            size_t chunks;
+            size_t bytes_reserved;
+            size_t central_refills;
+            size_t large_allocations;
+        };
+        
+        static constexpr size_t kMinBlock = 16;
+        static constexpr size_t kMaxBlock = 512;
+        static constexpr size_t kNumClasses = 6;   // 16, 32, 64, 128, 256, 512
+        static constexpr size_t kBatch = 32;       // 本地缓存与中心池之间每次转移的块数
+        static constexpr size_t kCacheSlots = 4;   // 每个线程同时缓存的池数量
+        
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+        
+        struct LocalList {
+            FreeBlock* head = nullptr;
+            size_t count = 0;
+        };
+        
+        // 中心池：所有线程共享，用互斥量保护
+        struct Central {
+            std::mutex mtx;
+            Options options;
+            std::vector<void*> chunks;
+            char* cursor = nullptr;
+            char* chunk_end = nullptr;
+            FreeBlock* free_lists[kNumClasses] = {};
+            size_t refills = 0;
+            std::atomic<size_t> large{0};
+            
+            explicit Central(Options opts) : options(opts) {}
+            ~Central() {
+                for (void* chunk : chunks) ::operator delete(chunk);
+            }
+            
+            // 调用方持有mtx
+            bool grow() {
+                if (!chunks.empty() && !options.allow_growth) return false;
+                if (options.max_chunks != 0 && chunks.size() >= options.max_chunks) return false;
+                void* chunk = ::operator new(options.chunk_bytes);
+                chunks.push_back(chunk);
+                cursor = static_cast<char*>(chunk);
+                chunk_end = cursor + options.chunk_bytes;
+                return true;
+            }
+        };
+        
+        // 线程本地缓存按池的唯一id区分；池析构后id不会复用，旧槽位只会被淘汰
+        struct CacheSlot {
+            uint64_t pool_id = 0;
+            std::weak_ptr<Central> central;
+            LocalList lists[kNumClasses];
+        };
+        
+        struct ThreadCache {
+            CacheSlot slots[kCacheSlots];
+            size_t next_victim = 0;
+            
+            // 线程退出时把缓存的块还给仍然存活的池
+            ~ThreadCache() {
+                for (auto& slot : slots) flush(slot);
+            }
+        };
+        
+        std::shared_ptr<Central> central_;
+        uint64_t id_;
+        
+        static uint64_t next_id() {
+            static std::atomic<uint64_t> counter{0};
+            return ++counter;
+        }
+        
+        static size_t class_of(size_t size) {
+#if defined(__GNUC__)
+            return size <= kMinBlock ? 0 : 60 - static_cast<size_t>(__builtin_clzll(size - 1));
+#else
+            size_t cls = 0;
+            for (size_t block = kMinBlock; block < size; block <<= 1) ++cls;
+            return cls;
+#endif
+        }
+        
+        static size_t block_size(size_t cls) { return kMinBlock << cls; }
+        
+        static void flush(CacheSlot& slot) {
+            if (slot.pool_id == 0) return;
+            if (auto central = slot.central.lock()) {
+                std::lock_guard<std::mutex> lock(central->mtx);
+                for (size_t cls = 0; cls < kNumClasses; ++cls) {
+                    LocalList& list = slot.lists[cls];
+                    while (list.head) {
+                        FreeBlock* block = list.head;
+                        list.head = block->next;
+                        block->next = central->free_lists[cls];
+                        central->free_lists[cls] = block;
+                    }
+                }
+            }
+            slot = CacheSlot{};
+        }
+        
+        // 同一线程连续使用同一个池是常态，先查最近一次命中的槽位
+        struct LastHit {
+            uint64_t pool_id;
+            LocalList* lists;
+        };
+        
+        LocalList* local_lists() {
+            static thread_local LastHit last{0, nullptr};
+            if (last.pool_id == id_) return last.lists;
+            LocalList* lists = find_slot();
+            last = LastHit{id_, lists};
+            return lists;
+        }
+        
+        LocalList* find_slot() {
+            static thread_local ThreadCache cache;
+            for (auto& slot : cache.slots) {
+                if (slot.pool_id == id_) return slot.lists;
+            }
+            CacheSlot& victim = cache.slots[cache.next_victim++ % kCacheSlots];
+            flush(victim);
+            victim.pool_id = id_;
+            victim.central = central_;
+            return victim.lists;
+        }
+        
+        // 从中心池取最多kBatch块：先用空闲链表，再从当前块切分，必要时增长
+        void refill(LocalList& list, size_t cls) {
+            const size_t size = block_size(cls);
+            std::lock_guard<std::mutex> lock(central_->mtx);
+            ++central_->refills;
+            FreeBlock*& shared = central_->free_lists[cls];
+            while (list.count < kBatch && shared) {
+                FreeBlock* block = shared;
+                shared = block->next;
+                block->next = list.head;
+                list.head = block;
+                ++list.count;
+            }
+            while (list.count < kBatch) {
+                if (static_cast<size_t>(central_->chunk_end - central_->cursor) < size) {
+                    // 块尾不足一个block的部分直接放弃
+                    if (list.count > 0 || !central_->grow()) break;
+                    if (static_cast<size_t>(central_->chunk_end - central_->cursor) < size) break;
+                }
+                auto* block = reinterpret_cast<FreeBlock*>(central_->cursor);
+                central_->cursor += size;
+                block->next = list.head;
+                list.head = block;
+                ++list.count;
+            }
+            if (list.count == 0) throw std::bad_alloc();
+        }
+        
+        void release(LocalList& list, size_t cls, size_t n) {
+            std::lock_guard<std::mutex> lock(central_->mtx);
+            FreeBlock*& shared = central_->free_lists[cls];
+            for (size_t i = 0; i < n && list.head; ++i) {
+                FreeBlock* block = list.head;
+                list.head = block->next;
+                --list.count;
+                block->next = shared;
+                shared = block;
+            }
+        }
+        
+    public:
+        SlabPool() : SlabPool(Options{64 * 1024, 0, true}) {}
+        
+        explicit SlabPool(Options options)
+            : central_(std::make_shared<Central>(options)), id_(next_id()) {
+            if (options.chunk_bytes < kMaxBlock) {
+                throw std::invalid_argument("chunk_bytes必须不小于最大分级");
+            }
+            std::lock_guard<std::mutex> lock(central_->mtx);
+            central_->grow();
+        }
+        
+        SlabPool(const SlabPool&) = delete;
+        SlabPool& operator=(const SlabPool&) = delete;
+        
+        // 要求对齐不超过alignof(std::max_align_t)；超过kMaxBlock的请求直接走operator new
+        void* allocate(size_t size) {
+            if (size > kMaxBlock) {
+                central_->large.fetch_add(1, std::memory_order_relaxed);
+                return ::operator new(size);
+            }
+            const size_t cls = class_of(size);
+            LocalList& list = local_lists()[cls];
+            if (!list.head) refill(list, cls);
+            FreeBlock* block = list.head;
+            list.head = block->next;
+            --list.count;
+            return block;
+        }
+        
+        // size必须与allocate时一致
+        void deallocate(void* p, size_t size) noexcept {
+            if (!p) return;
+            if (size > kMaxBlock) {
+                ::operator delete(p);
+                return;
+            }
+            const size_t cls = class_of(size);
+            LocalList& list = local_lists()[cls];
+            auto* block = static_cast<FreeBlock*>(p);
+            block->next = list.head;
+            list.head = block;
+            if (++list.count >= 2 * kBatch) release(list, cls, kBatch);
+        }
+        
+        Stats stats() const {
+            std::lock_guard<std::mutex> lock(central_->mtx);
+            return Stats{central_->chunks.size(), central_->chunks.size() * central_->options.chunk_bytes,
+                         central_->refills, central_->large.load(std::memory_order_relaxed)};
+        }
+    };
+    
+    // 标准分配器接口：可直接用于std::vector/std::list/std::map等容器
+    template<typename T>
+    class PoolAllocator {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "SlabPool不支持超对齐类型");
+        
+    private:
+        SlabPool* pool_;
+        
+    public:
+        using value_type = T;
+        
+        explicit PoolAllocator(SlabPool& pool) noexcept : pool_(&pool) {}
+        
+        template<typename U>
+        PoolAllocator(const PoolAllocator<U>& other) noexcept : pool_(other.pool()) {}
+        
+        T* allocate(size_t n) {
+            if (n > std::numeric_limits<size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+            return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+        }
+        
+        void deallocate(T* p, size_t n) noexcept { pool_->deallocate(p, n * sizeof(T)); }
+        
+        SlabPool* pool() const noexcept { return pool_; }
+        
+        template<typename U>
+        bool operator==(const PoolAllocator<U>& other) const noexcept { return pool_ == other.pool(); }
+        
+        template<typename U>
+        bool operator!=(const PoolAllocator<U>& other) const noexcept { return pool_ != other.pool(); }
+    };
+    
+#if __cplusplus >= 201703L
+    // pmr接口：超对齐请求转给上游资源，其余交给SlabPool
+    class SlabPoolResource : public std::pmr::memory_resource {
+    private:
+        SlabPool& pool_;
+        std::pmr::memory_resource* upstream_;
+        
+    public:
+        explicit SlabPoolResource(SlabPool& pool,
+                                  std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : pool_(pool), upstream_(upstream) {}
+        
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            if (alignment > alignof(std::max_align_t)) return upstream_->allocate(bytes, alignment);
+            return pool_.allocate(bytes);
+        }
+        
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            if (alignment > alignof(std::max_align_t)) {
+                upstream_->deallocate(p, bytes, alignment);
+            } else {
+                pool_.deallocate(p, bytes);
+            }
+        }
+        
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+#endif
+    
+    // 多线程分配/释放混合负载：每个线程维护256个存活对象，随机替换
+    struct ChurnResult {
+        double mops;
+        uint64_t checksum;
+    };
+    
+    template<typename Alloc, typename Free>
+    ChurnResult run_churn(size_t threads, size_t ops_per_thread, Alloc alloc, Free release) {
+        std::atomic<uint64_t> checksum{0};
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                constexpr size_t kLive = 256;
+                void* live[kLive] = {};
+                size_t sizes[kLive] = {};
+                uint64_t state = 0x9E3779B97F4A7C15ull * (t + 1);
+                uint64_t local = 0;
+                for (size_t i = 0; i < ops_per_thread; ++i) {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    size_t slot = state & (kLive - 1);
+                    if (live[slot]) {
+                        local += *static_cast<unsigned char*>(live[slot]);
+                        release(live[slot], sizes[slot]);
+                    }
+                    size_t size = 16 + ((state >> 8) % 241);   // 16~256字节
+                    live[slot] = alloc(size);
+                    sizes[slot] = size;
+                    *static_cast<unsigned char*>(live[slot]) = static_cast<unsigned char>(i);
+                }
+                for (size_t slot = 0; slot < kLive; ++slot) {
+                    if (live[slot]) release(live[slot], sizes[slot]);
+                }
+                checksum += local;
+            });
+        }
+        for (auto& w : workers) w.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return ChurnResult{threads * ops_per_thread / seconds / 1e6, checksum.load()};
+    }
+    
+    void demonstrate_memory_pool() {
+        PROFILE_ZONE(ChronoUDL::global_profiler(), "内存池演示");
+        using namespace CustomUDL::Memory;
+        
+        // 固定容量：与FixedSizeAllocator一样用完即抛异常，但释放后可以重新分配
+        {
+            SlabPool fixed(SlabPool::Options{to_bytes(4_KB).value, 1, false});
+            std::vector<void*> blocks;
+            try {
+                while (true) blocks.push_back(fixed.allocate(64));
+            } catch (const std::bad_alloc&) {
+                std::cout << "固定4KB池可分配64字节块: " << blocks.size() << " 个\n";
+            }
+            for (void* p : blocks) fixed.deallocate(p, 64);
+            size_t reused = 0;
+            blocks.clear();
+            try {
+                while (true) {
+                    blocks.push_back(fixed.allocate(64));
+                    ++reused;
+                }
+            } catch (const std::bad_alloc&) {
+            }
+            for (void* p : blocks) fixed.deallocate(p, 64);
+            std::cout << "全部释放后重新分配: " << reused << " 个\n";
+        }
+        
+        // 标准分配器接入容器
+        SlabPool pool(SlabPool::Options{to_bytes(64_KB).value, 0, true});
+        {
+            std::list<int, PoolAllocator<int>> numbers{PoolAllocator<int>(pool)};
+            for (int i = 0; i < 10000; ++i) numbers.push_back(i);
+            using MapAlloc = PoolAllocator<std::pair<const int, double>>;
+            std::map<int, double, std::less<int>, MapAlloc> squares{std::less<int>(), MapAlloc(pool)};
+            for (int i = 0; i < 1000; ++i) squares[i] = i * 0.5;
+            auto stats = pool.stats();
+            std::cout << "list(10000) + map(1000) 使用池: " << stats.chunks << " 个块, "
+                      << stats.bytes_reserved / 1024 << "KB, 中心池补充 " << stats.central_refills << " 次\n";
+        }
+        
+#if __cplusplus >= 201703L
+        {
+            SlabPoolResource resource(pool);
+            std::pmr::vector<std::pmr::string> names(&resource);
+            for (int i = 0; i < 1000; ++i) names.emplace_back("pmr字符串超过小字符串优化长度_" + std::to_string(i));
+            std::cout << "pmr::vector<pmr::string> 最后一个元素: " << names.back() << "\n";
+        }
+#endif
+        
+        // 多线程吞吐：与malloc/free对比
+        const size_t threads = 4;
+        const size_t ops = 2000000;
+        ChurnResult best_malloc{0, 0};
+        ChurnResult best_pool{0, 0};
+        for (int rep = 0; rep < 3; ++rep) {
+            auto m = run_churn(threads, ops, [](size_t size) { return std::malloc(size); },
+                               [](void* p, size_t) { std::free(p); });
+            auto p = run_churn(threads, ops, [&](size_t size) { return pool.allocate(size); },
+                               [&](void* ptr, size_t size) { pool.deallocate(ptr, size); });
+            if (m.mops > best_malloc.mops) best_malloc = m;
+            if (p.mops > best_pool.mops) best_pool = p;
+        }
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << threads << "线程 x " << ops << "次分配/释放:\n";
+        std::cout << "  malloc/free: " << best_malloc.mops << " M ops/s\n";
+        std::cout << "  SlabPool:    " << best_pool.mops << " M ops/s ("
+                  << std::setprecision(2) << best_pool.mops / best_malloc.mops << "x)\n";
+        std::cout << "  校验和一致: " << (best_malloc.checksum == best_pool.checksum ? "是" : "否") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+        auto stats = pool.stats();
+        std::cout << "池占用: " << stats.chunks << " 个块, " << stats.bytes_reserved / 1024 << "KB\n";
+    }
+}
+
 } // namespace cpp14_udl
 
 // ===== 主函数 =====
@@ -839,6 +1621,7 @@ int main() {
     }
     
     profiler.print_report();
+    demonstrate_profiler(std::getenv("PROFILE_TRACE"));
     
     // 2. String字面值演示
     std::cout << "\n===== 2. String字面值演示 =====\n";
@@ -951,6 +1734,13 @@ database.url = postgresql://localhost:5432/mydb
     std::cout << "分配器使用: " << allocator.used() << " / 1024 字节\n";
     std::cout << "可用空间: " << allocator.available() << " 字节\n";
     
+    // 5. 内存池分配器演示
+    std::cout << "\n===== 5. 内存池分配器演示 =====\n";
+    cpp14_udl::MemoryPool::demonstrate_memory_pool();
+    
+    // 各演示函数里的PROFILE_ZONE汇总
+    global_profiler().print_report();
+    
     return 0;
 }
 
@@ -958,6 +1748,7 @@ database.url = postgresql://localhost:5432/mydb
 编译和运行建议:
 g++ -std=c++14 -O2 -Wall -pthread 07_user_defined_literals.cpp -o udl_examples
 ./udl_examples
+PROFILE_TRACE=profile_trace.json ./udl_examples   # 同时导出Chrome trace
 
 关键学习点:
 1. Chrono字面值提供了直观的时间单位表示，使时间相关的代码更加清晰
@@ -966,6 +1757,8 @@ g++ -std=c++14 -O2 -Wall -pthread 07_user_defined_literals.cpp -o udl_examples
 4. 用户定义字面值通过operator""定义，可以创建特定领域的直观表示
 5. 字面值运算符必须在命名空间作用域或全局作用域中定义
 6. 字面值运算符的参数类型限制了可用的字面值形式
+7. 分级空闲链表 + 线程本地缓存让内存池的分配和释放都是O(1)，只有批量补充/归还时才加锁
+8. 性能分析器的热路径只写线程自己的环形缓冲区，聚合、建调用树和导出都推迟到收集时做
 
 注意事项:
 - 使用标准库字面值需要相应的using声明或using指令
@@ -973,4 +1766,5 @@ g++ -std=c++14 -O2 -Wall -pthread 07_user_defined_literals.cpp -o udl_examples
 - 字面值运算符必须是constexpr函数，以确保编译期求值
 - 自定义字面值应该遵循直观的命名约定，避免混淆
 - 字面值运算符应该返回适当的类型，提供良好的类型安全性
+- PROFILE_ZONE只接受字符串字面值；TSC计时假设CPU支持恒定频率TSC，不确定时改用steady_clock
 */
\ No newline at end of file
@@ -7,6 +7,7 @@
  * 3. SFINAE应用 - 更清晰的enable_if写法
  * 4. 模板元编程 - 简化元函数的写法
  * 5. 策略模式 - 通过类型别名实现策略选择
+ * 6. 高频事件总线 - 写时复制槽列表、批量发布与异步扇出
  * 
  * 类型别名模板的核心价值：
  * - 简化复杂的模板类型表达式
@@ -32,6 +33,15 @@
 #include <forward_list>
 #include <unordered_map>
 #include <unordered_set>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <exception>
 
 namespace cpp14_alias_templates {
 
@@ -696,6 +706,440 @@ namespace PracticalExamples {
     }
 }
 
+// ===== 6. 高频事件总线 =====
+
+namespace EventBus {
+    // C++14没有std::span，用指针+长度的只读视图把一段连续事件交给槽函数
+    template<typename Event>
+    class EventSpan {
+    private:
+        const Event* data_;
+        std::size_t size_;
+
+    public:
+        EventSpan(const Event* data, std::size_t size) : data_(data), size_(size) {}
+
+        template<typename Alloc>
+        EventSpan(const std::vector<Event, Alloc>& events) : data_(events.data()), size_(events.size()) {}
+
+        const Event* begin() const { return data_; }
+        const Event* end() const { return data_ + size_; }
+        const Event& operator[](std::size_t i) const { return data_[i]; }
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        EventSpan subspan(std::size_t offset, std::size_t count) const {
+            return EventSpan(data_ + offset, std::min(count, size_ - offset));
+        }
+    };
+
+    template<typename Event>
+    using EventSlot = std::function<void(const Event&)>;
+
+    template<typename Event>
+    using BatchSlot = std::function<void(EventSpan<Event>)>;
+
+    // 简单的固定线程池，异步发布时每个槽函数作为一个任务
+    class FanoutPool {
+    private:
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        bool stopping_ = false;
+
+        void worker_loop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                    if (tasks_.empty()) return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+
+    public:
+        explicit FanoutPool(std::size_t num_threads) {
+            for (std::size_t i = 0; i < num_threads; ++i) {
+                workers_.emplace_back([this] { worker_loop(); });
+            }
+        }
+
+        ~FanoutPool() {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            for (auto& w : workers_) w.join();
+        }
+
+        FanoutPool(const FanoutPool&) = delete;
+        FanoutPool& operator=(const FanoutPool&) = delete;
+
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                tasks_.push_back(std::move(task));
+            }
+            cv_.notify_one();
+        }
+
+        std::size_t thread_count() const { return workers_.size(); }
+    };
+
+    // 等待一组任务全部完成；任务抛出的第一个异常在wait()返回时重新抛出
+    class CountdownLatch {
+    private:
+        std::size_t count_;
+        std::exception_ptr error_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+
+    public:
+        explicit CountdownLatch(std::size_t count) : count_(count) {}
+
+        // 无论任务成功还是失败都必须计数，否则等待方永远醒不过来
+        void count_down(std::exception_ptr error = nullptr) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (error && !error_) error_ = std::move(error);
+            if (--count_ == 0) cv_.notify_all();
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait(lock, [this] { return count_ == 0; });
+            if (error_) std::rethrow_exception(error_);
+        }
+    };
+
+    // 读多写少的信号：槽列表是不可变快照，connect/disconnect复制一份新列表再原子替换
+    // 发布端只做计数器自增和指针读取，不加锁、不复制std::function
+    // 旧快照的回收采用SRCU式的两组读者计数：写者翻转代数后，等待旧代数的读者全部离开再释放
+    // 限制：写者会等待正在进行的emit结束，因此不能在槽函数里对同一个信号connect/disconnect
+    template<typename Event>
+    class ConcurrentSignal {
+    public:
+        using SlotId = std::uint64_t;
+
+    private:
+        struct SlotEntry {
+            SlotId id;
+            BatchSlot<Event> fn;
+        };
+        using SlotVector = std::vector<SlotEntry>;
+
+        struct alignas(64) ReaderCounter {
+            std::atomic<std::size_t> count{0};
+        };
+
+        std::atomic<const SlotVector*> slots_;
+        std::atomic<std::uint64_t> generation_{0};
+        ReaderCounter readers_[2];
+
+        std::mutex write_mtx_;
+        SlotId next_id_ = 1;
+
+        // 进入读侧：登记到当前代数的计数器；登记期间代数变了就重试
+        std::size_t read_lock() {
+            while (true) {
+                std::uint64_t gen = generation_.load();
+                std::size_t idx = static_cast<std::size_t>(gen & 1);
+                readers_[idx].count.fetch_add(1);
+                if (generation_.load() == gen) return idx;
+                readers_[idx].count.fetch_sub(1);
+            }
+        }
+
+        void read_unlock(std::size_t idx) {
+            readers_[idx].count.fetch_sub(1);
+        }
+
+        class ReadGuard {
+        private:
+            ConcurrentSignal& signal_;
+            std::size_t idx_;
+
+        public:
+            explicit ReadGuard(ConcurrentSignal& signal) : signal_(signal), idx_(signal.read_lock()) {}
+            ~ReadGuard() { signal_.read_unlock(idx_); }
+            ReadGuard(const ReadGuard&) = delete;
+            ReadGuard& operator=(const ReadGuard&) = delete;
+        };
+
+        // 调用方持有write_mtx_：发布新快照，等旧快照不再被读者引用后释放
+        void publish(std::unique_ptr<const SlotVector> next) {
+            const SlotVector* old = slots_.exchange(next.release());
+            std::uint64_t old_gen = generation_.fetch_add(1);
+            auto& old_readers = readers_[old_gen & 1].count;
+            while (old_readers.load() != 0) {
+                std::this_thread::yield();
+            }
+            delete old;
+        }
+
+    public:
+        ConcurrentSignal() : slots_(new SlotVector()) {}
+
+        ~ConcurrentSignal() {
+            delete slots_.load();
+        }
+
+        ConcurrentSignal(const ConcurrentSignal&) = delete;
+        ConcurrentSignal& operator=(const ConcurrentSignal&) = delete;
+
+        // 批量槽：一次拿到整段事件，循环在槽函数内部，可以被内联
+        SlotId connect_batch(BatchSlot<Event> slot) {
+            std::lock_guard<std::mutex> lock(write_mtx_);
+            std::unique_ptr<SlotVector> next(new SlotVector(*slots_.load()));
+            SlotId id = next_id_++;
+            next->push_back(SlotEntry{id, std::move(slot)});
+            publish(std::move(next));
+            return id;
+        }
+
+        // 逐事件槽：包装成批量槽，每批仍是一次间接调用进入包装层
+        SlotId connect(EventSlot<Event> slot) {
+            return connect_batch([slot](EventSpan<Event> events) {
+                for (const auto& e : events) slot(e);
+            });
+        }
+
+        bool disconnect(SlotId id) {
+            std::lock_guard<std::mutex> lock(write_mtx_);
+            const SlotVector& current = *slots_.load();
+            std::unique_ptr<SlotVector> next(new SlotVector());
+            next->reserve(current.size());
+            for (const auto& entry : current) {
+                if (entry.id != id) next->push_back(entry);
+            }
+            if (next->size() == current.size()) return false;
+            publish(std::move(next));
+            return true;
+        }
+
+        void emit(const Event& event) {
+            emit_batch(EventSpan<Event>(&event, 1));
+        }
+
+        // 一次读侧进入覆盖整批事件，每个槽函数只被调用一次
+        void emit_batch(EventSpan<Event> events) {
+            if (events.empty()) return;
+            ReadGuard guard(*this);
+            for (const auto& entry : *slots_.load()) {
+                entry.fn(events);
+            }
+        }
+
+        // 异步扇出：每个槽函数是线程池里的一个任务，返回前等待全部完成（events在此期间保持有效）
+        // 同一个槽函数始终在单个任务里按顺序处理整批事件，保持每个槽看到的事件顺序
+        void emit_batch_async(FanoutPool& pool, EventSpan<Event> events) {
+            if (events.empty()) return;
+            ReadGuard guard(*this);
+            const SlotVector& slots = *slots_.load();
+            if (slots.empty()) return;
+            CountdownLatch latch(slots.size());
+            for (const auto& entry : slots) {
+                const BatchSlot<Event>* fn = &entry.fn;
+                pool.submit([fn, events, &latch] {
+                    try {
+                        (*fn)(events);
+                    } catch (...) {
+                        latch.count_down(std::current_exception());
+                        return;
+                    }
+                    latch.count_down();
+                });
+            }
+            // 即使有槽函数抛出异常，也要等全部任务结束后再传播：events和快照在此之前必须保持有效
+            latch.wait();
+        }
+
+        std::size_t slot_count() {
+            ReadGuard guard(*this);
+            return slots_.load()->size();
+        }
+    };
+
+    // 行情事件
+    struct MarketEvent {
+        std::uint32_t instrument;
+        std::uint32_t sequence;
+        double price;
+        std::int64_t quantity;
+    };
+
+    std::vector<MarketEvent> make_market_events(std::size_t n) {
+        std::vector<MarketEvent> events(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            events[i].instrument = static_cast<std::uint32_t>(i % 64);
+            events[i].sequence = static_cast<std::uint32_t>(i);
+            events[i].price = 100.0 + static_cast<double>(i % 1000) * 0.01;
+            events[i].quantity = static_cast<std::int64_t>(i % 7) + 1;
+        }
+        return events;
+    }
+
+    // 四个典型订阅者：成交额、成交量、最新价、序号校验
+    struct MarketStats {
+        double notional = 0;
+        std::int64_t volume = 0;
+        double last_price = 0;
+        std::uint32_t max_sequence = 0;
+
+        // 成交额是浮点累加，分批求和的舍入顺序不同，不参与比较
+        bool same_totals(const MarketStats& other) const {
+            return volume == other.volume && last_price == other.last_price &&
+                   max_sequence == other.max_sequence;
+        }
+    };
+
+    template<typename Clock = std::chrono::steady_clock, typename F>
+    double measure_ms(F&& f) {
+        auto start = Clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void demonstrate_event_bus() {
+        const std::size_t event_count = 1000000;
+        const std::size_t batch_size = 256;
+        auto events = make_market_events(event_count);
+
+        // 原有Signal：逐事件emit，每个事件对每个槽一次std::function调用
+        MarketStats legacy_stats;
+        PracticalExamples::Signal<const MarketEvent&> legacy;
+        legacy.connect([&legacy_stats](const MarketEvent& e) { legacy_stats.notional += e.price * e.quantity; });
+        legacy.connect([&legacy_stats](const MarketEvent& e) { legacy_stats.volume += e.quantity; });
+        legacy.connect([&legacy_stats](const MarketEvent& e) { legacy_stats.last_price = e.price; });
+        legacy.connect([&legacy_stats](const MarketEvent& e) {
+            legacy_stats.max_sequence = std::max(legacy_stats.max_sequence, e.sequence);
+        });
+
+        double legacy_ms = measure_ms([&] {
+            for (const auto& e : events) legacy.emit(e);
+        });
+
+        // 新信号 + 逐事件槽
+        MarketStats single_stats;
+        ConcurrentSignal<MarketEvent> per_event;
+        per_event.connect([&single_stats](const MarketEvent& e) { single_stats.notional += e.price * e.quantity; });
+        per_event.connect([&single_stats](const MarketEvent& e) { single_stats.volume += e.quantity; });
+        per_event.connect([&single_stats](const MarketEvent& e) { single_stats.last_price = e.price; });
+        per_event.connect([&single_stats](const MarketEvent& e) {
+            single_stats.max_sequence = std::max(single_stats.max_sequence, e.sequence);
+        });
+
+        double per_event_ms = measure_ms([&] {
+            for (const auto& e : events) per_event.emit(e);
+        });
+
+        // 新信号 + 批量槽：每批256个事件，每个槽一次调用，循环在槽内部
+        MarketStats batch_stats;
+        ConcurrentSignal<MarketEvent> batched;
+        batched.connect_batch([&batch_stats](EventSpan<MarketEvent> es) {
+            double sum = 0;
+            for (const auto& e : es) sum += e.price * e.quantity;
+            batch_stats.notional += sum;
+        });
+        batched.connect_batch([&batch_stats](EventSpan<MarketEvent> es) {
+            std::int64_t sum = 0;
+            for (const auto& e : es) sum += e.quantity;
+            batch_stats.volume += sum;
+        });
+        batched.connect_batch([&batch_stats](EventSpan<MarketEvent> es) {
+            batch_stats.last_price = es[es.size() - 1].price;
+        });
+        batched.connect_batch([&batch_stats](EventSpan<MarketEvent> es) {
+            std::uint32_t m = batch_stats.max_sequence;
+            for (const auto& e : es) m = std::max(m, e.sequence);
+            batch_stats.max_sequence = m;
+        });
+
+        EventSpan<MarketEvent> all(events);
+        double batch_ms = measure_ms([&] {
+            for (std::size_t i = 0; i < all.size(); i += batch_size) {
+                batched.emit_batch(all.subspan(i, batch_size));
+            }
+        });
+
+        // 异步扇出：同一组批量槽，每批的四个槽并行执行
+        MarketStats sync_stats = batch_stats;
+        batch_stats = MarketStats{};
+        const std::size_t async_batch = 16384;
+        double async_ms;
+        {
+            FanoutPool pool(4);
+            async_ms = measure_ms([&] {
+                for (std::size_t i = 0; i < all.size(); i += async_batch) {
+                    batched.emit_batch_async(pool, all.subspan(i, async_batch));
+                }
+            });
+        }
+
+        std::cout << "发布 " << event_count << " 个行情事件到 4 个订阅者:\n";
+        std::cout << "  原Signal逐事件emit: " << legacy_ms << " ms ("
+                  << event_count / legacy_ms / 1000 << " M事件/秒)\n";
+        std::cout << "  并发Signal逐事件emit: " << per_event_ms << " ms ("
+                  << event_count / per_event_ms / 1000 << " M事件/秒)\n";
+        std::cout << "  并发Signal批量emit(" << batch_size << "): " << batch_ms << " ms ("
+                  << event_count / batch_ms / 1000 << " M事件/秒)\n";
+        std::cout << "  异步扇出(批" << async_batch << ", " << 4 << "线程): " << async_ms << " ms ("
+                  << event_count / async_ms / 1000 << " M事件/秒, 硬件线程数 "
+                  << std::thread::hardware_concurrency() << ")\n";
+
+        bool consistent = legacy_stats.same_totals(single_stats) &&
+                          legacy_stats.same_totals(sync_stats) &&
+                          legacy_stats.same_totals(batch_stats);
+        std::cout << "  各方案统计结果一致: " << (consistent ? "是" : "否") << "\n";
+
+        // 发布过程中并发地订阅/退订：发布端不加锁，也不会看到半更新的槽列表
+        ConcurrentSignal<MarketEvent> live;
+        std::atomic<std::int64_t> permanent_volume{0};
+        live.connect_batch([&permanent_volume](EventSpan<MarketEvent> es) {
+            std::int64_t sum = 0;
+            for (const auto& e : es) sum += e.quantity;
+            permanent_volume.fetch_add(sum, std::memory_order_relaxed);
+        });
+
+        std::atomic<bool> publishing{true};
+        std::atomic<int> churn_rounds{0};
+        std::thread churner([&] {
+            std::atomic<std::int64_t> sink{0};
+            while (publishing.load()) {
+                auto id = live.connect([&sink](const MarketEvent& e) {
+                    sink.fetch_add(e.quantity, std::memory_order_relaxed);
+                });
+                live.disconnect(id);
+                churn_rounds.fetch_add(1);
+            }
+        });
+
+        std::vector<std::thread> publishers;
+        const std::size_t publisher_count = 2;
+        for (std::size_t p = 0; p < publisher_count; ++p) {
+            publishers.emplace_back([&] {
+                for (std::size_t i = 0; i < all.size(); i += batch_size) {
+                    live.emit_batch(all.subspan(i, batch_size));
+                }
+            });
+        }
+        for (auto& t : publishers) t.join();
+        publishing.store(false);
+        churner.join();
+
+        std::cout << "并发测试: " << publisher_count << " 个发布线程, 期间订阅/退订 "
+                  << churn_rounds.load() << " 轮, 常驻订阅者成交量 "
+                  << (permanent_volume.load() == legacy_stats.volume * static_cast<std::int64_t>(publisher_count)
+                      ? "正确" : "错误")
+                  << ", 剩余槽数 " << live.slot_count() << "\n";
+    }
+}
+
 } // namespace cpp14_alias_templates
 
 // ===== 主函数 =====
@@ -850,12 +1294,16 @@ int main() {
     }
     std::cout << "\n";
     
+    // 6. 高频事件总线演示
+    std::cout << "\n===== 6. 高频事件总线演示 =====\n";
+    EventBus::demonstrate_event_bus();
+    
     return 0;
 }
 
 /*
 编译和运行建议:
-g++ -std=c++14 -O2 -Wall 08_alias_templates.cpp -o alias_templates
+g++ -std=c++14 -O2 -Wall -pthread 08_alias_templates.cpp -o alias_templates
 ./alias_templates
 
 关键学习点:
@@ -865,9 +1313,11 @@ g++ -std=c++14 -O2 -Wall 08_alias_templates.cpp -o alias_templates
 4. SFINAE技术通过类型别名模板变得更加简洁和直观
 5. 策略模式可以通过类型别名模板实现灵活的组件组合
 6. 类型别名模板是现代C++模板编程的重要工具
+7. 读多写少的槽列表用不可变快照加原子替换，发布端无锁；按批发布把每个槽的调用次数降到每批一次
 
 注意事项:
 - 类型别名模板不能特化，需要使用类模板特化
+- ConcurrentSignal的写者会等待进行中的emit，不要在槽函数里对同一个信号connect/disconnect
 - 类型别名模板在模板参数推导中的作用与原始类型相同
 - 过度使用类型别名可能导致代码难以理解和调试
 - 类型别名模板应该有清晰的命名，避免混淆
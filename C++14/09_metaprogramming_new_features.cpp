@@ -8,6 +8,8 @@
  * 4. 类型别名模板 - 简化元函数的写法
  * 5. 编译期数组大小推导 - std::size()等
  * 6. 更强大的std::integral_constant - 编译期常量
+ * 7. 位集合批量运算 - SIMD集合代数、硬件popcount与rank/select
+ * 8. 编译期选择的流式压缩 - LZ4块格式与差分+位压缩，按块读写
  * 
  * C++14元编程的核心价值：
  * - 将更多计算从运行时移到编译期
@@ -32,6 +34,13 @@
 #include <numeric>
 #include <cmath>
 #include <limits>
+#include <cstdint>
+#include <stdexcept>
+#include <cstring>
+#include <sstream>
+#if defined(__SSE2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
 namespace cpp14_metaprogramming {
 
@@ -740,6 +749,477 @@ namespace CompileTimePatterns {
         }
     };
     
+    // 流式压缩子系统：上面的策略只能压缩单个对象的sizeof(T)个字节，且每次调用都经过虚函数。
+    // 下面的编解码器都是只有静态成员函数的类型，由CompressionFactory在编译期选定，调用完全内联：
+    // 1. Lz4BlockCodec     LZ4块格式：哈希表找4字节重复串，输出(字面量, 偏移, 长度)序列
+    // 2. DeltaForCodec      整数列先做差分，再按128个值一组做frame-of-reference位压缩
+    // 3. ForCodec           不做差分的frame-of-reference，适合取值范围小但无序的列
+    // 位压缩采用4路交错布局：第i个值放在第i%4路，解码时SSE2一次还原4个相邻的值
+    namespace codec_detail {
+        inline uint32_t load_u32(const uint8_t* p) {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint64_t load_u64(const uint8_t* p) {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline void store_u32(uint8_t* p, uint32_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+        [[noreturn]] inline void corrupt(const char* what) {
+            throw std::runtime_error(std::string("压缩数据损坏: ") + what);
+        }
+
+        // LZ4长度字段：低4位放不下时追加255,255,...,余数
+        inline uint8_t* write_length(uint8_t* op, size_t length) {
+            for (; length >= 255; length -= 255) *op++ = 255;
+            *op++ = static_cast<uint8_t>(length);
+            return op;
+        }
+
+        inline size_t read_length(const uint8_t*& ip, const uint8_t* end) {
+            size_t length = 0;
+            uint8_t byte;
+            do {
+                if (ip == end) corrupt("长度字段越界");
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255);
+            return length;
+        }
+
+        inline size_t lz4_compress(const uint8_t* src, size_t n, uint8_t* dst) {
+            constexpr unsigned kHashLog = 14;
+            constexpr size_t kMinMatch = 4;
+            constexpr size_t kLastLiterals = 5;   // 格式规定最后5个字节必须是字面量
+            constexpr size_t kMatchFindLimit = 12;
+
+            uint8_t* op = dst;
+            size_t anchor = 0;
+
+            auto emit = [&](size_t literal_end, size_t offset, size_t match_length) {
+                const size_t literals = literal_end - anchor;
+                uint8_t* token = op++;
+                *token = static_cast<uint8_t>(std::min<size_t>(literals, 15) << 4);
+                if (literals >= 15) op = write_length(op, literals - 15);
+                if (literals != 0) std::memcpy(op, src + anchor, literals);
+                op += literals;
+                if (match_length == 0) return;  // 最后一段只有字面量
+                *op++ = static_cast<uint8_t>(offset);
+                *op++ = static_cast<uint8_t>(offset >> 8);
+                const size_t extra = match_length - kMinMatch;
+                *token |= static_cast<uint8_t>(std::min<size_t>(extra, 15));
+                if (extra >= 15) op = write_length(op, extra - 15);
+            };
+
+            if (n >= kMatchFindLimit + 1) {
+                std::vector<uint32_t> table(size_t(1) << kHashLog, 0);
+                auto hash = [](uint32_t seq) { return (seq * 2654435761u) >> (32 - kHashLog); };
+                const size_t match_find_limit = n - kMatchFindLimit;
+                const size_t match_limit = n - kLastLiterals;
+
+                size_t ip = 0;
+                while (ip < match_find_limit) {
+                    const uint32_t seq = load_u32(src + ip);
+                    const uint32_t h = hash(seq);
+                    size_t candidate = table[h];
+                    table[h] = static_cast<uint32_t>(ip);
+                    if (candidate >= ip || ip - candidate > 65535 || load_u32(src + candidate) != seq) {
+                        ip += 1 + ((ip - anchor) >> 6);  // 长时间找不到匹配时加大步长
+                        continue;
+                    }
+                    // 向前扩展，再按8字节一次向后扩展
+                    while (ip > anchor && candidate > 0 && src[ip - 1] == src[candidate - 1]) {
+                        --ip;
+                        --candidate;
+                    }
+                    size_t length = kMinMatch;
+                    while (ip + length + 8 <= match_limit) {
+                        const uint64_t diff = load_u64(src + ip + length) ^ load_u64(src + candidate + length);
+                        if (diff) {
+                            length += static_cast<size_t>(__builtin_ctzll(diff)) / 8;
+                            goto matched;
+                        }
+                        length += 8;
+                    }
+                    while (ip + length < match_limit && src[ip + length] == src[candidate + length]) ++length;
+                matched:
+                    emit(ip, ip - candidate, length);
+                    ip += length;
+                    anchor = ip;
+                    if (ip < match_find_limit) table[hash(load_u32(src + ip - 2))] = static_cast<uint32_t>(ip - 2);
+                }
+            }
+            emit(n, 0, 0);
+            return static_cast<size_t>(op - dst);
+        }
+
+        inline void lz4_decompress(const uint8_t* ip, size_t in_size, uint8_t* dst, size_t out_size) {
+            const uint8_t* const end = ip + in_size;
+            uint8_t* op = dst;
+            uint8_t* const out_end = dst + out_size;
+            while (ip < end) {
+                const uint8_t token = *ip++;
+                size_t literals = token >> 4;
+                if (literals == 15) literals += read_length(ip, end);
+                if (literals > static_cast<size_t>(end - ip) || literals > static_cast<size_t>(out_end - op)) {
+                    corrupt("字面量越界");
+                }
+                if (literals != 0) std::memcpy(op, ip, literals);
+                ip += literals;
+                op += literals;
+                if (ip == end) break;
+
+                if (end - ip < 2) corrupt("偏移截断");
+                const size_t offset = ip[0] | (size_t(ip[1]) << 8);
+                ip += 2;
+                if (offset == 0 || offset > static_cast<size_t>(op - dst)) corrupt("偏移非法");
+                size_t length = (token & 15) + 4;
+                if ((token & 15) == 15) length += read_length(ip, end);
+                if (length > static_cast<size_t>(out_end - op)) corrupt("匹配越界");
+
+                const uint8_t* match = op - offset;
+                if (offset >= 8 && static_cast<size_t>(out_end - op) >= length + 8) {
+                    // 偏移不小于8时每次拷贝8字节互不重叠，允许多写最多7个字节
+                    uint8_t* const stop = op + length;
+                    for (uint8_t* p = op; p < stop; p += 8, match += 8) std::memcpy(p, match, 8);
+                    op = stop;
+                } else {
+                    for (size_t i = 0; i < length; ++i) op[i] = match[i];
+                    op += length;
+                }
+            }
+            if (op != out_end) corrupt("解压长度不符");
+        }
+
+        // frame-of-reference：每组128个值，组头为最小值(4字节)与位宽(1字节)，其后4·位宽个32位字
+        constexpr size_t kForGroup = 128;
+
+        inline size_t for_group_bytes(unsigned bits) { return 5 + 16 * bits; }
+
+        template<bool Delta>
+        inline uint8_t* for_encode_group(const uint32_t* values, uint32_t& previous, uint8_t* out) {
+            uint32_t deltas[kForGroup];
+            for (size_t i = 0; i < kForGroup; ++i) {
+                deltas[i] = Delta ? values[i] - previous : values[i];
+                previous = values[i];
+            }
+            // 差分按有符号数取最小值，这样递减序列也只需要很少的位；不做差分时按无符号数处理
+            uint32_t lo;
+            uint64_t range;
+            if (Delta) {
+                int32_t smin = static_cast<int32_t>(deltas[0]), smax = smin;
+                for (uint32_t d : deltas) {
+                    smin = std::min(smin, static_cast<int32_t>(d));
+                    smax = std::max(smax, static_cast<int32_t>(d));
+                }
+                lo = static_cast<uint32_t>(smin);
+                range = static_cast<uint64_t>(int64_t(smax) - int64_t(smin));
+            } else {
+                uint32_t umin = deltas[0], umax = deltas[0];
+                for (uint32_t d : deltas) {
+                    umin = std::min(umin, d);
+                    umax = std::max(umax, d);
+                }
+                lo = umin;
+                range = umax - umin;
+            }
+            const unsigned bits = range == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(range));
+
+            store_u32(out, lo);
+            out[4] = static_cast<uint8_t>(bits);
+            uint8_t* words_out = out + 5;
+            uint32_t words[4 * 32] = {};
+            for (size_t lane = 0; lane < 4; ++lane) {
+                for (size_t j = 0; j < 32; ++j) {
+                    const uint64_t v = deltas[j * 4 + lane] - lo;
+                    const size_t bit = j * bits;
+                    words[(bit / 32) * 4 + lane] |= static_cast<uint32_t>(v << (bit % 32));
+                    if (bit % 32 + bits > 32) words[(bit / 32 + 1) * 4 + lane] |= static_cast<uint32_t>(v >> (32 - bit % 32));
+                }
+            }
+            std::memcpy(words_out, words, 16 * bits);
+            return out + for_group_bytes(bits);
+        }
+
+        template<bool Delta>
+        inline const uint8_t* for_decode_group(const uint8_t* in, const uint8_t* end, uint32_t& previous, uint32_t* out) {
+            if (end - in < 5) corrupt("组头截断");
+            const uint32_t base = load_u32(in);
+            const unsigned bits = in[4];
+            if (bits > 32 || static_cast<size_t>(end - in) < for_group_bytes(bits)) corrupt("位宽非法");
+            const uint8_t* words = in + 5;
+#if defined(__SSE2__)
+            const __m128i vbase = _mm_set1_epi32(static_cast<int>(base));
+            const __m128i mask = _mm_set1_epi32(bits == 32 ? -1 : static_cast<int>((1u << bits) - 1));
+            __m128i carry = _mm_set1_epi32(static_cast<int>(previous));
+            for (size_t j = 0; j < 32; ++j) {
+                __m128i v = _mm_setzero_si128();
+                if (bits != 0) {
+                    const size_t bit = j * bits;
+                    const size_t w = bit / 32, shift = bit % 32;
+                    v = _mm_srl_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + w * 16)),
+                                      _mm_cvtsi32_si128(static_cast<int>(shift)));
+                    if (shift + bits > 32) {
+                        __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + (w + 1) * 16));
+                        v = _mm_or_si128(v, _mm_sll_epi32(next, _mm_cvtsi32_si128(static_cast<int>(32 - shift))));
+                    }
+                    v = _mm_and_si128(v, mask);
+                }
+                v = _mm_add_epi32(v, vbase);
+                if (Delta) {
+                    // 4个相邻差分的前缀和，再加上前一组的最后一个值
+                    v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+                    v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+                    v = _mm_add_epi32(v, carry);
+                    carry = _mm_shuffle_epi32(v, 0xFF);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j * 4), v);
+            }
+            previous = out[kForGroup - 1];
+#else
+            for (size_t lane = 0; lane < 4; ++lane) {
+                for (size_t j = 0; j < 32; ++j) {
+                    uint64_t v = 0;
+                    if (bits != 0) {
+                        const size_t bit = j * bits;
+                        v = load_u32(words + (bit / 32) * 16 + lane * 4) >> (bit % 32);
+                        if (bit % 32 + bits > 32) v |= uint64_t(load_u32(words + (bit / 32 + 1) * 16 + lane * 4)) << (32 - bit % 32);
+                        v &= bits == 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+                    }
+                    out[j * 4 + lane] = static_cast<uint32_t>(v) + base;
+                }
+            }
+            if (Delta) {
+                for (size_t i = 0; i < kForGroup; ++i) out[i] = previous += out[i];
+            }
+            previous = out[kForGroup - 1];
+#endif
+            return in + for_group_bytes(bits);
+        }
+    }
+
+    template<typename T>
+    struct Lz4BlockCodec {
+        static_assert(std::is_trivially_copyable<T>::value, "LZ4按字节压缩，要求T可平凡拷贝");
+
+        static const char* name() { return "LZ4"; }
+
+        static size_t max_compressed_size(size_t count) {
+            const size_t bytes = count * sizeof(T);
+            return bytes + bytes / 255 + 16;
+        }
+
+        static size_t compress(const T* in, size_t count, uint8_t* out) {
+            return codec_detail::lz4_compress(reinterpret_cast<const uint8_t*>(in), count * sizeof(T), out);
+        }
+
+        static void decompress(const uint8_t* in, size_t in_size, T* out, size_t count) {
+            codec_detail::lz4_decompress(in, in_size, reinterpret_cast<uint8_t*>(out), count * sizeof(T));
+        }
+    };
+
+    template<typename T, bool Delta>
+    struct FrameOfReferenceCodec {
+        static_assert(std::is_integral<T>::value && sizeof(T) == 4, "frame-of-reference编解码器只支持32位整数列");
+
+        static const char* name() { return Delta ? "Delta+FOR" : "FOR"; }
+
+        static size_t groups(size_t count) { return (count + codec_detail::kForGroup - 1) / codec_detail::kForGroup; }
+
+        static size_t max_compressed_size(size_t count) { return groups(count) * codec_detail::for_group_bytes(32); }
+
+        // 最后一组不足128个值时用最后一个值补齐，解码时丢弃
+        static size_t compress(const T* in, size_t count, uint8_t* out) {
+            using codec_detail::kForGroup;
+            uint8_t* op = out;
+            uint32_t previous = 0;
+            uint32_t group[kForGroup];
+            for (size_t g = 0; g < groups(count); ++g) {
+                const size_t first = g * kForGroup;
+                const size_t n = std::min(kForGroup, count - first);
+                std::memcpy(group, in + first, n * sizeof(uint32_t));
+                for (size_t i = n; i < kForGroup; ++i) group[i] = group[n - 1];
+                op = codec_detail::for_encode_group<Delta>(group, previous, op);
+            }
+            return static_cast<size_t>(op - out);
+        }
+
+        static void decompress(const uint8_t* in, size_t in_size, T* out, size_t count) {
+            using codec_detail::kForGroup;
+            const uint8_t* ip = in;
+            const uint8_t* const end = in + in_size;
+            uint32_t previous = 0;
+            uint32_t group[kForGroup];
+            const size_t full = count / kForGroup;
+            for (size_t g = 0; g < full; ++g) {
+                // 完整的组直接解码到输出中
+                ip = codec_detail::for_decode_group<Delta>(ip, end, previous, reinterpret_cast<uint32_t*>(out + g * kForGroup));
+            }
+            if (count % kForGroup != 0) {
+                ip = codec_detail::for_decode_group<Delta>(ip, end, previous, group);
+                std::memcpy(out + full * kForGroup, group, (count % kForGroup) * sizeof(uint32_t));
+            }
+            if (ip != end) codec_detail::corrupt("多余的数据");
+        }
+    };
+
+    template<typename T>
+    using DeltaForCodec = FrameOfReferenceCodec<T, true>;
+
+    template<typename T>
+    using ForCodec = FrameOfReferenceCodec<T, false>;
+
+    // 分块流：每块独立压缩，帧格式为[值个数u32][压缩字节数u32][数据]，以值个数为0的帧结束；
+    // 读写两端都只需要一个块大小的缓冲区
+    template<typename Codec, typename T>
+    class CompressedWriter {
+    private:
+        std::ostream& out_;
+        std::vector<T> buffer_;
+        std::vector<uint8_t> scratch_;
+        size_t chunk_values_;
+        uint64_t raw_bytes_ = 0;
+        uint64_t compressed_bytes_ = 0;
+        bool finished_ = false;
+
+        void write_frame(uint32_t count, const uint8_t* data, uint32_t size) {
+            uint8_t header[8];
+            codec_detail::store_u32(header, count);
+            codec_detail::store_u32(header + 4, size);
+            out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+            out_.write(reinterpret_cast<const char*>(data), size);
+            compressed_bytes_ += sizeof(header) + size;
+        }
+
+        void flush_chunk() {
+            if (buffer_.empty()) return;
+            const size_t size = Codec::compress(buffer_.data(), buffer_.size(), scratch_.data());
+            write_frame(static_cast<uint32_t>(buffer_.size()), scratch_.data(), static_cast<uint32_t>(size));
+            raw_bytes_ += buffer_.size() * sizeof(T);
+            buffer_.clear();
+        }
+
+    public:
+        explicit CompressedWriter(std::ostream& out, size_t chunk_values = 16384)
+            : out_(out), scratch_(Codec::max_compressed_size(chunk_values)), chunk_values_(chunk_values) {
+            buffer_.reserve(chunk_values_);
+        }
+
+        CompressedWriter(const CompressedWriter&) = delete;
+        CompressedWriter& operator=(const CompressedWriter&) = delete;
+        // 被移走的对象不再写结束帧
+        CompressedWriter(CompressedWriter&& other)
+            : out_(other.out_), buffer_(std::move(other.buffer_)), scratch_(std::move(other.scratch_)),
+              chunk_values_(other.chunk_values_), raw_bytes_(other.raw_bytes_),
+              compressed_bytes_(other.compressed_bytes_), finished_(other.finished_) {
+            other.finished_ = true;
+        }
+
+        ~CompressedWriter() {
+            try {
+                finish();
+            } catch (...) {
+                // 析构函数不能抛出；需要感知错误时应显式调用finish()
+            }
+        }
+
+        void write(const T* data, size_t count) {
+            while (count > 0) {
+                const size_t n = std::min(count, chunk_values_ - buffer_.size());
+                buffer_.insert(buffer_.end(), data, data + n);
+                data += n;
+                count -= n;
+                if (buffer_.size() == chunk_values_) flush_chunk();
+            }
+        }
+
+        void write(const T& value) { write(&value, 1); }
+
+        void finish() {
+            if (finished_) return;
+            finished_ = true;
+            flush_chunk();
+            write_frame(0, nullptr, 0);
+            out_.flush();
+        }
+
+        uint64_t raw_bytes() const { return raw_bytes_; }
+        uint64_t compressed_bytes() const { return compressed_bytes_; }
+    };
+
+    template<typename Codec, typename T>
+    class CompressedReader {
+    private:
+        static constexpr uint32_t MaxChunkValues = 1u << 24;
+
+        std::istream& in_;
+        std::vector<T> buffer_;
+        std::vector<uint8_t> scratch_;
+        size_t position_ = 0;
+        bool eof_ = false;
+
+        bool next_chunk() {
+            uint8_t header[8];
+            if (!in_.read(reinterpret_cast<char*>(header), sizeof(header))) codec_detail::corrupt("帧头截断");
+            const uint32_t count = codec_detail::load_u32(header);
+            const uint32_t size = codec_detail::load_u32(header + 4);
+            if (count == 0) {
+                eof_ = true;
+                return false;
+            }
+            if (count > MaxChunkValues || size > Codec::max_compressed_size(count)) codec_detail::corrupt("帧头非法");
+            scratch_.resize(size);
+            if (!in_.read(reinterpret_cast<char*>(scratch_.data()), size)) codec_detail::corrupt("帧数据截断");
+            buffer_.resize(count);
+            Codec::decompress(scratch_.data(), size, buffer_.data(), count);
+            position_ = 0;
+            return true;
+        }
+
+    public:
+        explicit CompressedReader(std::istream& in) : in_(in) {}
+
+        // 读出至多count个值，返回实际个数；返回0表示流已结束
+        size_t read(T* out, size_t count) {
+            size_t total = 0;
+            while (total < count) {
+                if (position_ == buffer_.size() && (eof_ || !next_chunk())) break;
+                const size_t n = std::min(count - total, buffer_.size() - position_);
+                std::copy(buffer_.begin() + static_cast<std::ptrdiff_t>(position_),
+                          buffer_.begin() + static_cast<std::ptrdiff_t>(position_ + n), out + total);
+                position_ += n;
+                total += n;
+            }
+            return total;
+        }
+    };
+
+    // 策略编号到编解码器类型的编译期映射：0、1为上面的单对象策略，没有流式编解码器
+    template<typename T, int Strategy>
+    struct CodecSelector {
+        using type = void;
+    };
+
+    template<typename T>
+    struct CodecSelector<T, 2> {
+        using type = Lz4BlockCodec<T>;
+    };
+
+    template<typename T>
+    struct CodecSelector<T, 3> {
+        using type = DeltaForCodec<T>;
+    };
+
+    template<typename T>
+    struct CodecSelector<T, 4> {
+        using type = ForCodec<T>;
+    };
+
     // 编译期策略工厂
     template<typename T, int Strategy>
     class CompressionFactory {
@@ -753,7 +1233,119 @@ namespace CompileTimePatterns {
                 return std::make_unique<NoCompression<T>>();
             }
         }
+        
+        // 策略2~4：流式编解码器，类型在编译期确定，读写路径上没有虚函数调用
+        using Codec = typename CodecSelector<T, Strategy>::type;
+        
+        static CompressedWriter<Codec, T> make_writer(std::ostream& out, size_t chunk_values = 16384) {
+            return CompressedWriter<Codec, T>(out, chunk_values);
+        }
+        
+        static CompressedReader<Codec, T> make_reader(std::istream& in) {
+            return CompressedReader<Codec, T>(in);
+        }
     };
+    
+    template<typename Codec, typename T>
+    inline void run_codec_benchmark(const char* dataset, const std::vector<T>& data, size_t chunk_values = 16384) {
+        const size_t chunks = (data.size() + chunk_values - 1) / chunk_values;
+        std::vector<uint8_t> compressed(chunks * Codec::max_compressed_size(chunk_values));
+        std::vector<size_t> offsets(chunks + 1, 0);
+        std::vector<T> restored(data.size());
+
+        auto best_ms = [](auto&& f) {
+            double best = 1e300;
+            for (int rep = 0; rep < 3; ++rep) {
+                auto start = std::chrono::high_resolution_clock::now();
+                f();
+                best = std::min(best, std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start).count());
+            }
+            return best;
+        };
+
+        double compress_ms = best_ms([&] {
+            for (size_t c = 0; c < chunks; ++c) {
+                const size_t first = c * chunk_values;
+                const size_t n = std::min(chunk_values, data.size() - first);
+                offsets[c + 1] = offsets[c] + Codec::compress(data.data() + first, n, compressed.data() + offsets[c]);
+            }
+        });
+        double decompress_ms = best_ms([&] {
+            for (size_t c = 0; c < chunks; ++c) {
+                const size_t first = c * chunk_values;
+                const size_t n = std::min(chunk_values, data.size() - first);
+                Codec::decompress(compressed.data() + offsets[c], offsets[c + 1] - offsets[c], restored.data() + first, n);
+            }
+        });
+
+        const double raw_bytes = static_cast<double>(data.size() * sizeof(T));
+        const std::ios::fmtflags flags = std::cout.flags();
+        const std::streamsize precision = std::cout.precision();
+        std::cout << std::fixed << std::setprecision(2)
+                  << "  " << std::left << std::setw(12) << dataset << std::setw(10) << Codec::name() << std::right
+                  << " 压缩比 " << std::setw(6) << raw_bytes / static_cast<double>(offsets[chunks])
+                  << "  压缩 " << std::setw(6) << raw_bytes / compress_ms / 1e6 << " GB/s"
+                  << "  解压 " << std::setw(6) << raw_bytes / decompress_ms / 1e6 << " GB/s"
+                  << (restored == data ? "" : "  还原失败") << "\n";
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+    }
+
+    inline void benchmark_compression_codecs() {
+        const size_t count = size_t(1) << 22;
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        auto next = [&state] {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        std::vector<uint32_t> timestamps(count), sensor_ids(count);
+        uint32_t now = 1700000000;
+        for (size_t i = 0; i < count; ++i) {
+            now += static_cast<uint32_t>(next() % 16);       // 递增时间戳：差分很小
+            timestamps[i] = now;
+            sensor_ids[i] = 1000000 + static_cast<uint32_t>(next() % 4096);  // 无序但只有12位的取值范围
+        }
+        std::vector<char> log_text;
+        const char* levels[] = {"INFO", "WARN", "DEBUG"};
+        for (size_t i = 0; log_text.size() < count * 4; ++i) {
+            std::string line = "2024-01-01T12:00:" + std::to_string(10 + i % 50) + " " + levels[next() % 3] +
+                               " worker-" + std::to_string(next() % 8) + " request_id=" + std::to_string(i) +
+                               " status=200\n";
+            log_text.insert(log_text.end(), line.begin(), line.end());
+        }
+
+        std::cout << "\n压缩编解码器基准（每组约16MB，按16384个值分块）:\n";
+        run_codec_benchmark<Lz4BlockCodec<uint32_t>>("时间戳列", timestamps);
+        run_codec_benchmark<DeltaForCodec<uint32_t>>("时间戳列", timestamps);
+        run_codec_benchmark<ForCodec<uint32_t>>("时间戳列", timestamps);
+        run_codec_benchmark<Lz4BlockCodec<uint32_t>>("传感器ID列", sensor_ids);
+        run_codec_benchmark<DeltaForCodec<uint32_t>>("传感器ID列", sensor_ids);
+        run_codec_benchmark<ForCodec<uint32_t>>("传感器ID列", sensor_ids);
+        run_codec_benchmark<Lz4BlockCodec<char>>("日志文本", log_text, 65536);
+
+        // 分块流：经由工厂在编译期选择编解码器，逐块写入、逐块读回
+        std::stringstream stream;
+        {
+            auto writer = CompressionFactory<uint32_t, 3>::make_writer(stream);
+            for (size_t i = 0; i < count; i += 1000) writer.write(timestamps.data() + i, std::min<size_t>(1000, count - i));
+            writer.finish();
+            std::cout << "  分块流(Delta+FOR): " << writer.raw_bytes() << " 字节 -> " << writer.compressed_bytes() << " 字节";
+        }
+        auto reader = CompressionFactory<uint32_t, 3>::make_reader(stream);
+        std::vector<uint32_t> piece(777);
+        size_t total = 0;
+        bool same = true;
+        for (size_t n; (n = reader.read(piece.data(), piece.size())) > 0; total += n) {
+            same = same && std::equal(piece.begin(), piece.begin() + static_cast<std::ptrdiff_t>(n),
+                                      timestamps.begin() + static_cast<std::ptrdiff_t>(total));
+        }
+        std::cout << ", 读回" << (same && total == count ? "一致" : "不一致") << "\n";
+    }
+
 }
 
 // ===== 5. 编译期容器和算法 =====
@@ -797,6 +1389,160 @@ namespace CompileTimeContainers {
         }
     };
     
+    // 位集合批量运算内核：BitSet与DynamicBitSet共用
+    // 按编译选项选择AVX-512 / AVX2 / 标量实现（-march=native才会启用向量化路径），
+    // 单个位的接口不变，整段运算一次处理8个或4个64位字
+    namespace BitOps {
+        using Word = uint64_t;
+
+        struct AndOp {
+            static Word scalar(Word a, Word b) { return a & b; }
+#if defined(__AVX2__)
+            static __m256i avx2(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#endif
+#if defined(__AVX512F__)
+            static __m512i avx512(__m512i a, __m512i b) { return _mm512_and_si512(a, b); }
+#endif
+        };
+
+        struct OrOp {
+            static Word scalar(Word a, Word b) { return a | b; }
+#if defined(__AVX2__)
+            static __m256i avx2(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#endif
+#if defined(__AVX512F__)
+            static __m512i avx512(__m512i a, __m512i b) { return _mm512_or_si512(a, b); }
+#endif
+        };
+
+        struct XorOp {
+            static Word scalar(Word a, Word b) { return a ^ b; }
+#if defined(__AVX2__)
+            static __m256i avx2(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#endif
+#if defined(__AVX512F__)
+            static __m512i avx512(__m512i a, __m512i b) { return _mm512_xor_si512(a, b); }
+#endif
+        };
+
+        // a & ~b
+        struct AndNotOp {
+            static Word scalar(Word a, Word b) { return a & ~b; }
+#if defined(__AVX2__)
+            static __m256i avx2(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+#endif
+#if defined(__AVX512F__)
+            static __m512i avx512(__m512i a, __m512i b) { return _mm512_andnot_si512(b, a); }
+#endif
+        };
+
+        // dst[i] = Op(dst[i], src[i])
+        template<typename Op>
+        inline void apply(Word* dst, const Word* src, size_t n) {
+            size_t i = 0;
+#if defined(__AVX512F__)
+            for (const size_t end = n - n % 8; i < end; i += 8) {
+                __m512i a = _mm512_loadu_si512(dst + i);
+                __m512i b = _mm512_loadu_si512(src + i);
+                _mm512_storeu_si512(dst + i, Op::avx512(a, b));
+            }
+#elif defined(__AVX2__)
+            for (const size_t end = n - n % 4; i < end; i += 4) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), Op::avx2(a, b));
+            }
+#endif
+            for (; i < n; ++i) dst[i] = Op::scalar(dst[i], src[i]);
+        }
+
+#if defined(__AVX2__) && !defined(__AVX512VPOPCNTDQ__)
+        // AVX2没有向量popcount：按4位查表(vpshufb)再用vpsadbw横向求和
+        inline __m256i popcount_bytes_avx2(__m256i v) {
+            const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i low_mask = _mm256_set1_epi8(0x0f);
+            __m256i lo = _mm256_and_si256(v, low_mask);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+            return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+        }
+
+        inline uint64_t horizontal_sum_avx2(__m256i acc) {
+            return static_cast<uint64_t>(_mm256_extract_epi64(acc, 0)) + static_cast<uint64_t>(_mm256_extract_epi64(acc, 1)) +
+                   static_cast<uint64_t>(_mm256_extract_epi64(acc, 2)) + static_cast<uint64_t>(_mm256_extract_epi64(acc, 3));
+        }
+#endif
+
+        // 统计a[0..n)中1的个数；b非空时统计a & b，不需要先物化交集
+        inline uint64_t popcount(const Word* a, const Word* b, size_t n) {
+            size_t i = 0;
+            uint64_t total = 0;
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+            __m512i acc = _mm512_setzero_si512();
+            for (const size_t end = n - n % 8; i < end; i += 8) {
+                __m512i v = _mm512_loadu_si512(a + i);
+                if (b) v = _mm512_and_si512(v, _mm512_loadu_si512(b + i));
+                acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+            }
+            total += static_cast<uint64_t>(_mm512_reduce_add_epi64(acc));
+#elif defined(__AVX2__)
+            __m256i acc = _mm256_setzero_si256();
+            for (const size_t end = n - n % 4; i < end; i += 4) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                if (b) v = _mm256_and_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+                acc = _mm256_add_epi64(acc, _mm256_sad_epu8(popcount_bytes_avx2(v), _mm256_setzero_si256()));
+            }
+            total += horizontal_sum_avx2(acc);
+#endif
+            for (; i < n; ++i) {
+                total += static_cast<uint64_t>(__builtin_popcountll(b ? a[i] & b[i] : a[i]));
+            }
+            return total;
+        }
+
+        // 从pos开始的第一个置位的位置，没有则返回nbits
+        inline size_t find_next(const Word* words, size_t nwords, size_t nbits, size_t pos) {
+            if (pos >= nbits) return nbits;
+            size_t w = pos / 64;
+            Word current = words[w] & (~Word(0) << (pos % 64));
+            while (current == 0) {
+                if (++w == nwords) return nbits;
+                current = words[w];
+            }
+            return w * 64 + static_cast<size_t>(__builtin_ctzll(current));
+        }
+
+        // 逐个访问置位：tzcnt取最低位，w &= w - 1清掉它，代价只和置位个数成正比
+        template<typename F>
+        inline void for_each_set(const Word* words, size_t nwords, F&& f) {
+            for (size_t w = 0; w < nwords; ++w) {
+                Word current = words[w];
+                while (current) {
+                    f(w * 64 + static_cast<size_t>(__builtin_ctzll(current)));
+                    current &= current - 1;
+                }
+            }
+        }
+
+        // 一个字中第k个(从0开始)置位的位置
+        inline unsigned select_in_word(Word w, unsigned k) {
+#if defined(__BMI2__)
+            return static_cast<unsigned>(__builtin_ctzll(_pdep_u64(Word(1) << k, w)));
+#else
+            for (unsigned i = 0; i < k; ++i) w &= w - 1;
+            return static_cast<unsigned>(__builtin_ctzll(w));
+#endif
+        }
+    }
+
+    // C++14没有std::is_constant_evaluated；编译器提供该内建函数时（GCC 9+/Clang 9+），
+    // count()在运行期改走BitOps，否则两种场合都用逐字循环
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define BITSET_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+#endif
+
     // 编译期位集合
     template<size_t Size>
     class BitSet {
@@ -815,7 +1561,16 @@ namespace CompileTimeContainers {
             return pos % WordSize;
         }
         
+        // Size不是64的倍数时，最后一个字的高位必须保持为0
+        constexpr void clear_tail() {
+            if (Size % WordSize != 0) {
+                words_[WordCount - 1] &= (WordType(1) << (Size % WordSize)) - 1;
+            }
+        }
+        
     public:
+        static constexpr size_t npos = Size;
+        
         constexpr BitSet() = default;
         
         constexpr bool test(size_t pos) const {
@@ -832,16 +1587,35 @@ namespace CompileTimeContainers {
             }
         }
         
+        constexpr void set() {
+            for (size_t i = 0; i < WordCount; ++i) {
+                words_[i] = ~WordType(0);
+            }
+            clear_tail();
+        }
+        
         constexpr void reset(size_t pos) {
             set(pos, false);
         }
         
+        constexpr void reset() {
+            for (size_t i = 0; i < WordCount; ++i) {
+                words_[i] = 0;
+            }
+        }
+        
         constexpr void flip(size_t pos) {
             if (pos >= Size) return;
             words_[word_index(pos)] ^= (WordType(1) << bit_index(pos));
         }
         
         constexpr size_t count() const {
+#if defined(BITSET_HAS_IS_CONSTANT_EVALUATED)
+            // 运行期走BitOps的向量化popcount，编译期保留逐字循环
+            if (!__builtin_is_constant_evaluated()) {
+                return static_cast<size_t>(BitOps::popcount(words_, nullptr, WordCount));
+            }
+#endif
             size_t result = 0;
             for (size_t i = 0; i < WordCount; ++i) {
                 result += __builtin_popcountll(words_[i]);
@@ -860,7 +1634,356 @@ namespace CompileTimeContainers {
         constexpr bool none() const {
             return count() == 0;
         }
+        
+        // 整体集合运算
+        BitSet& operator&=(const BitSet& other) {
+            BitOps::apply<BitOps::AndOp>(words_, other.words_, WordCount);
+            return *this;
+        }
+        
+        BitSet& operator|=(const BitSet& other) {
+            BitOps::apply<BitOps::OrOp>(words_, other.words_, WordCount);
+            return *this;
+        }
+        
+        BitSet& operator^=(const BitSet& other) {
+            BitOps::apply<BitOps::XorOp>(words_, other.words_, WordCount);
+            return *this;
+        }
+        
+        // 差集：*this & ~other
+        BitSet& and_not(const BitSet& other) {
+            BitOps::apply<BitOps::AndNotOp>(words_, other.words_, WordCount);
+            return *this;
+        }
+        
+        friend BitSet operator&(BitSet a, const BitSet& b) { return a &= b; }
+        friend BitSet operator|(BitSet a, const BitSet& b) { return a |= b; }
+        friend BitSet operator^(BitSet a, const BitSet& b) { return a ^= b; }
+        
+        constexpr BitSet operator~() const {
+            BitSet result;
+            for (size_t i = 0; i < WordCount; ++i) {
+                result.words_[i] = ~words_[i];
+            }
+            result.clear_tail();
+            return result;
+        }
+        
+        // |*this & other|，不生成中间结果
+        size_t count_and(const BitSet& other) const {
+            return static_cast<size_t>(BitOps::popcount(words_, other.words_, WordCount));
+        }
+        
+        size_t find_first() const { return find_next(0); }
+        
+        size_t find_next(size_t pos) const {
+            return BitOps::find_next(words_, WordCount, Size, pos);
+        }
+        
+        template<typename F>
+        void for_each_set(F&& f) const {
+            BitOps::for_each_set(words_, WordCount, std::forward<F>(f));
+        }
+        
+        const WordType* data() const { return words_; }
+        constexpr size_t word_count() const { return WordCount; }
+        constexpr size_t size() const { return Size; }
+    };
+
+    // 运行期大小的位集合：宽度在构造时确定，存储在vector中，批量运算与BitSet共用内核
+    class DynamicBitSet {
+    private:
+        using WordType = BitOps::Word;
+
+        std::vector<WordType> words_;
+        size_t size_ = 0;
+
+        static size_t words_for(size_t bits) { return (bits + 63) / 64; }
+
+        void clear_tail() {
+            if (size_ % 64 != 0) {
+                words_.back() &= (WordType(1) << (size_ % 64)) - 1;
+            }
+        }
+
+        void check_same_size(const DynamicBitSet& other) const {
+            if (other.size_ != size_) {
+                throw std::invalid_argument("DynamicBitSet: 参与运算的位集合大小不一致");
+            }
+        }
+
+    public:
+        DynamicBitSet() = default;
+
+        explicit DynamicBitSet(size_t bits, bool value = false)
+            : words_(words_for(bits), value ? ~WordType(0) : 0), size_(bits) {
+            clear_tail();
+        }
+
+        size_t size() const { return size_; }
+        size_t npos() const { return size_; }
+
+        void resize(size_t bits, bool value = false) {
+            const size_t old_size = size_;
+            words_.resize(words_for(bits), value ? ~WordType(0) : 0);
+            size_ = bits;
+            if (value && bits > old_size && old_size % 64 != 0) {
+                words_[old_size / 64] |= ~WordType(0) << (old_size % 64);
+            }
+            clear_tail();
+        }
+
+        bool test(size_t pos) const {
+            if (pos >= size_) return false;
+            return (words_[pos / 64] >> (pos % 64)) & 1;
+        }
+
+        void set(size_t pos, bool value = true) {
+            if (pos >= size_) return;
+            if (value) {
+                words_[pos / 64] |= WordType(1) << (pos % 64);
+            } else {
+                words_[pos / 64] &= ~(WordType(1) << (pos % 64));
+            }
+        }
+
+        void set() {
+            std::fill(words_.begin(), words_.end(), ~WordType(0));
+            clear_tail();
+        }
+
+        void reset(size_t pos) { set(pos, false); }
+        void reset() { std::fill(words_.begin(), words_.end(), 0); }
+
+        void flip(size_t pos) {
+            if (pos >= size_) return;
+            words_[pos / 64] ^= WordType(1) << (pos % 64);
+        }
+
+        size_t count() const {
+            return static_cast<size_t>(BitOps::popcount(words_.data(), nullptr, words_.size()));
+        }
+
+        size_t count_and(const DynamicBitSet& other) const {
+            check_same_size(other);
+            return static_cast<size_t>(BitOps::popcount(words_.data(), other.words_.data(), words_.size()));
+        }
+
+        bool all() const { return count() == size_; }
+        bool any() const { return find_first() != size_; }
+        bool none() const { return !any(); }
+
+        DynamicBitSet& operator&=(const DynamicBitSet& other) {
+            check_same_size(other);
+            BitOps::apply<BitOps::AndOp>(words_.data(), other.words_.data(), words_.size());
+            return *this;
+        }
+
+        DynamicBitSet& operator|=(const DynamicBitSet& other) {
+            check_same_size(other);
+            BitOps::apply<BitOps::OrOp>(words_.data(), other.words_.data(), words_.size());
+            return *this;
+        }
+
+        DynamicBitSet& operator^=(const DynamicBitSet& other) {
+            check_same_size(other);
+            BitOps::apply<BitOps::XorOp>(words_.data(), other.words_.data(), words_.size());
+            return *this;
+        }
+
+        DynamicBitSet& and_not(const DynamicBitSet& other) {
+            check_same_size(other);
+            BitOps::apply<BitOps::AndNotOp>(words_.data(), other.words_.data(), words_.size());
+            return *this;
+        }
+
+        friend DynamicBitSet operator&(DynamicBitSet a, const DynamicBitSet& b) { return std::move(a &= b); }
+        friend DynamicBitSet operator|(DynamicBitSet a, const DynamicBitSet& b) { return std::move(a |= b); }
+        friend DynamicBitSet operator^(DynamicBitSet a, const DynamicBitSet& b) { return std::move(a ^= b); }
+
+        DynamicBitSet operator~() const {
+            DynamicBitSet result(*this);
+            for (auto& w : result.words_) w = ~w;
+            result.clear_tail();
+            return result;
+        }
+
+        size_t find_first() const { return find_next(0); }
+
+        size_t find_next(size_t pos) const {
+            return BitOps::find_next(words_.data(), words_.size(), size_, pos);
+        }
+
+        template<typename F>
+        void for_each_set(F&& f) const {
+            BitOps::for_each_set(words_.data(), words_.size(), std::forward<F>(f));
+        }
+
+        const WordType* data() const { return words_.data(); }
+        size_t word_count() const { return words_.size(); }
+    };
+
+    // rank/select辅助结构：每512位（8个字）记录一次前缀计数，额外占用1/8的空间；
+    // 每隔SelectSample个置位记录它所在的块，select先用采样缩小范围再二分。
+    // 构建后位集合不能再修改，否则计数失效
+    class RankSelect {
+    private:
+        using WordType = BitOps::Word;
+        static constexpr size_t BlockWords = 8;
+        static constexpr size_t BlockBits = BlockWords * 64;
+        static constexpr size_t SelectSample = 4096;
+
+        const WordType* words_ = nullptr;
+        size_t word_count_ = 0;
+        size_t size_ = 0;
+        std::vector<uint64_t> block_rank_;      // 第b块之前的置位个数，末尾多存一个总数
+        std::vector<uint32_t> select_blocks_;   // 第i·SelectSample个置位所在的块
+
+    public:
+        RankSelect() = default;
+
+        RankSelect(const WordType* words, size_t bits)
+            : words_(words), word_count_((bits + 63) / 64), size_(bits) {
+            const size_t blocks = (word_count_ + BlockWords - 1) / BlockWords;
+            block_rank_.resize(blocks + 1);
+            uint64_t total = 0;
+            for (size_t b = 0; b < blocks; ++b) {
+                block_rank_[b] = total;
+                const size_t first = b * BlockWords;
+                const size_t n = word_count_ - first < BlockWords ? word_count_ - first : BlockWords;
+                const uint64_t ones = BitOps::popcount(words_ + first, nullptr, n);
+                // 记录所有落在本块内的采样点
+                for (uint64_t next = (total + SelectSample - 1) / SelectSample * SelectSample;
+                     next < total + ones; next += SelectSample) {
+                    select_blocks_.push_back(static_cast<uint32_t>(b));
+                }
+                total += ones;
+            }
+            block_rank_[blocks] = total;
+        }
+
+        template<typename Bits>
+        explicit RankSelect(const Bits& bits) : RankSelect(bits.data(), bits.size()) {}
+
+        size_t ones() const { return static_cast<size_t>(block_rank_.back()); }
+
+        // [0, pos)中置位的个数
+        size_t rank(size_t pos) const {
+            pos = std::min(pos, size_);
+            const size_t word = pos / 64;
+            const size_t block = word / BlockWords;
+            uint64_t result = block_rank_[block];
+            for (size_t w = block * BlockWords; w < word; ++w) {
+                result += static_cast<uint64_t>(__builtin_popcountll(words_[w]));
+            }
+            if (pos % 64 != 0) {
+                result += static_cast<uint64_t>(__builtin_popcountll(words_[word] & ((WordType(1) << (pos % 64)) - 1)));
+            }
+            return static_cast<size_t>(result);
+        }
+
+        // 第k个（从0开始）置位的位置；k >= ones()时返回size()
+        size_t select(size_t k) const {
+            if (k >= ones()) return size_;
+            const size_t sample = k / SelectSample;
+            size_t lo = select_blocks_[sample];
+            size_t hi = sample + 1 < select_blocks_.size() ? select_blocks_[sample + 1] + 1 : block_rank_.size() - 1;
+            // 找最后一个block_rank_[b] <= k的块
+            while (hi - lo > 1) {
+                const size_t mid = lo + (hi - lo) / 2;
+                if (block_rank_[mid] <= k) lo = mid; else hi = mid;
+            }
+            uint64_t remaining = k - block_rank_[lo];
+            for (size_t w = lo * BlockWords; w < word_count_; ++w) {
+                const uint64_t ones_in_word = static_cast<uint64_t>(__builtin_popcountll(words_[w]));
+                if (remaining < ones_in_word) {
+                    return w * 64 + BitOps::select_in_word(words_[w], static_cast<unsigned>(remaining));
+                }
+                remaining -= ones_in_word;
+            }
+            return size_;
+        }
     };
+
+    // 行过滤场景：1.34亿行上的两个谓词位图，对比逐位接口与批量接口
+    inline void benchmark_bitset_filters() {
+        const size_t rows = size_t(1) << 27;
+        DynamicBitSet price_ok(rows), in_stock(rows);
+        std::vector<bool> price_flags(rows), stock_flags(rows);
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (size_t i = 0; i < rows; ++i) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            const bool p = (state & 1) != 0;             // 约50%
+            const bool s = ((state >> 8) & 7) == 0;      // 约12.5%
+            price_ok.set(i, p);
+            in_stock.set(i, s);
+            price_flags[i] = p;
+            stock_flags[i] = s;
+        }
+
+        auto time_ms = [](auto&& f) {
+            auto start = std::chrono::high_resolution_clock::now();
+            f();
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+
+        // 1. 求交集并计数
+        size_t bitwise_count = 0, bulk_count = 0, fused_count = 0;
+        std::vector<bool> bitwise_result(rows);
+        DynamicBitSet bulk_result;
+        double bitwise_ms = time_ms([&] {
+            for (size_t i = 0; i < rows; ++i) {
+                const bool hit = price_flags[i] && stock_flags[i];
+                bitwise_result[i] = hit;
+                bitwise_count += hit;
+            }
+        });
+        double bulk_ms = time_ms([&] {
+            bulk_result = price_ok & in_stock;
+            bulk_count = bulk_result.count();
+        });
+        double fused_ms = time_ms([&] { fused_count = price_ok.count_and(in_stock); });
+
+        // 2. 遍历命中行
+        uint64_t scan_sum = 0, iter_sum = 0;
+        double scan_ms = time_ms([&] {
+            for (size_t i = 0; i < rows; ++i) {
+                if (bulk_result.test(i)) scan_sum += i;
+            }
+        });
+        double iter_ms = time_ms([&] { bulk_result.for_each_set([&](size_t i) { iter_sum += i; }); });
+
+        // 3. rank/select：第k个命中行在哪里、某行之前有多少个命中行
+        RankSelect index(bulk_result);
+        const size_t queries = 1000000;
+        bool consistent = index.ones() == bulk_count;
+        uint64_t select_sum = 0;
+        double select_ms = time_ms([&] {
+            uint64_t q = 12345;
+            for (size_t i = 0; i < queries; ++i) {
+                q = q * 6364136223846793005ULL + 1442695040888963407ULL;
+                const size_t k = static_cast<size_t>((q >> 17) % bulk_count);
+                const size_t pos = index.select(k);
+                select_sum += pos;
+                if (i % 1024 == 0) consistent = consistent && bulk_result.test(pos) && index.rank(pos) == k;
+            }
+        });
+
+        std::cout << "\n行过滤基准（" << rows << "行, 每个位图" << rows / 8 / (1 << 20) << "MB）:\n";
+        std::cout << "  交集+计数 逐位(vector<bool>): " << bitwise_ms << " ms\n";
+        std::cout << "  交集+计数 批量运算:           " << bulk_ms << " ms (" << bitwise_ms / bulk_ms << "x)\n";
+        std::cout << "  仅计数 count_and:             " << fused_ms << " ms (" << bitwise_ms / fused_ms << "x)\n";
+        std::cout << "  结果一致: " << (bitwise_count == bulk_count && bulk_count == fused_count ? "是" : "否")
+                  << " (" << bulk_count << "行命中)\n";
+        std::cout << "  遍历命中行 逐位test:          " << scan_ms << " ms\n";
+        std::cout << "  遍历命中行 for_each_set:      " << iter_ms << " ms (" << scan_ms / iter_ms << "x)"
+                  << (scan_sum == iter_sum ? "" : " 结果不一致") << "\n";
+        std::cout << "  " << queries << "次select:               " << select_ms << " ms, rank/select互逆: "
+                  << (consistent ? "是" : "否") << " (校验和" << select_sum % 1000 << ")\n";
+    }
     
     // 编译期字符串
     template<size_t Size>
@@ -1033,6 +2156,17 @@ int main() {
     std::cout << "无压缩大小: " << compressed1.size() << " 字节\n";
     std::cout << "RLE压缩大小: " << compressed2.size() << " 字节\n";
     
+    // 流式编解码器：同一个工厂，策略编号在编译期映射到具体类型
+    using TimestampCodec = CompressionFactory<uint32_t, 3>::Codec;
+    std::vector<uint32_t> column = {100, 103, 104, 110, 111, 111, 120, 125, 126, 130};
+    std::vector<uint8_t> packed(TimestampCodec::max_compressed_size(column.size()));
+    size_t packed_size = TimestampCodec::compress(column.data(), column.size(), packed.data());
+    std::vector<uint32_t> unpacked(column.size());
+    TimestampCodec::decompress(packed.data(), packed_size, unpacked.data(), unpacked.size());
+    std::cout << TimestampCodec::name() << "压缩10个递增时间戳: " << column.size() * sizeof(uint32_t) << " -> "
+              << packed_size << " 字节, 还原" << (unpacked == column ? "正确" : "错误") << "\n";
+    benchmark_compression_codecs();
+    
     // 5. 编译期容器演示
     std::cout << "\n===== 5. 编译期容器演示 =====\n";
     using namespace CompileTimeContainers;
@@ -1056,6 +2190,26 @@ int main() {
     std::cout << "\n";
     std::cout << "设置的位数: " << bitset.count() << "\n";
     
+    // 批量集合运算与置位遍历
+    BitSet<200> evens, threes;
+    for (size_t i = 0; i < 200; i += 2) evens.set(i);
+    for (size_t i = 0; i < 200; i += 3) threes.set(i);
+    std::cout << "200以内偶数∩3的倍数: " << (evens & threes).count() << "个, 前几个:";
+    auto sixes = evens & threes;
+    for (size_t i = sixes.find_first(), n = 0; i != sixes.npos && n < 5; i = sixes.find_next(i + 1), ++n) {
+        std::cout << " " << i;
+    }
+    std::cout << "\n";
+    std::cout << "偶数但不是3的倍数: " << BitSet<200>(evens).and_not(threes).count() << "个\n";
+    
+    // 运行期宽度的位集合与rank/select
+    DynamicBitSet filter(1000);
+    for (size_t i = 0; i < 1000; i += 7) filter.set(i);
+    RankSelect filter_index(filter);
+    std::cout << "DynamicBitSet(1000)中7的倍数: " << filter.count() << "个, rank(500)=" << filter_index.rank(500)
+              << ", select(10)=" << filter_index.select(10) << "\n";
+    benchmark_bitset_filters();
+    
     // 固定字符串
     FixedString<5> fixed_str("Hello");
     std::cout << "固定字符串: " << fixed_str.c_str() << "\n";
@@ -1067,6 +2221,8 @@ int main() {
 /*
 编译和运行建议:
 g++ -std=c++14 -O2 -Wall 09_metaprogramming_new_features.cpp -o metaprogramming
+# 启用AVX2/AVX-512/BMI2向量化路径
+g++ -std=c++14 -O2 -Wall -march=native 09_metaprogramming_new_features.cpp -o metaprogramming
 ./metaprogramming
 
 关键学习点:
@@ -1076,6 +2232,8 @@ g++ -std=c++14 -O2 -Wall 09_metaprogramming_new_features.cpp -o metaprogramming
 4. 类型列表操作提供了强大的类型系统元编程能力
 5. 编译期设计模式可以实现零开销的抽象
 6. 编译期容器提供了类型安全和性能保证
+7. 位集合的集合运算按字批量处理，popcount/tzcnt/pdep让计数、遍历和select都与字数而非位数成正比
+8. 编解码器做成只有静态函数的类型、由工厂在编译期选择，压缩内核可以完全内联，不需要虚函数
 
 注意事项:
 - 编译期计算需要所有操作都是constexpr的
@@ -1084,4 +2242,8 @@ g++ -std=c++14 -O2 -Wall 09_metaprogramming_new_features.cpp -o metaprogramming
 - 变量模板不能特化，需要使用类模板特化
 - 编译期调试比较困难，需要仔细验证逻辑
 - 编译期内存使用也有限制，避免过大的编译期数据结构
-*/
\ No newline at end of file
+- 位集合的最后一个字要保持高位为0，否则count和取反结果会出错
+- RankSelect只保存指向位数据的指针，构建后位集合不能再修改
+- 解压不可信数据时必须检查每个长度和偏移，这里遇到损坏数据抛出std::runtime_error
+- 差分编码对递增列效果最好；无序列用FOR或LZ4，应按列的分布选择编解码器
+*/
@@ -7,6 +7,7 @@
  * 3. 运算符重载配合 - 自定义类型的折叠操作
  * 4. 性能优化分析 - 与传统递归模板的对比
  * 5. 高级应用模式 - 函数式编程和元编程技巧
+ * 6. 分块绳索构建 - 折叠预计算长度一次分配，片段列表直接writev
  */
 
 #include <iostream>
@@ -17,6 +18,23 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <string_view>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#if !defined(_WIN32)
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "../common/micro_bench.h"
 
 // ===== 1. 折叠表达式语法演示 =====
 template<typename... Args>
@@ -125,6 +143,44 @@ void demonstrate_expansion_mechanism() {
 }
 
 // ===== 3. 运算符重载配合演示 =====
+// 片段长度：char为1，其余按string_view取长度
+// 字符串字面量的长度由char_traits::length算出，属于常量表达式，编译期即可折叠
+template<typename T>
+constexpr size_t piece_size(const T& piece) {
+    if constexpr (std::is_same_v<T, char>) {
+        return 1;
+    } else {
+        return std::string_view(piece).size();
+    }
+}
+
+template<typename... Pieces>
+constexpr size_t total_size(const Pieces&... pieces) {
+    return (size_t{0} + ... + piece_size(pieces));
+}
+
+template<typename T>
+void append_piece(std::string& out, const T& piece) {
+    if constexpr (std::is_same_v<T, char>) {
+        out.push_back(piece);
+    } else {
+        out.append(std::string_view(piece));
+    }
+}
+
+// 写进调用方已分配好的内存，返回下一个片段的起点
+template<typename T>
+char* append_piece(char* out, const T& piece) {
+    if constexpr (std::is_same_v<T, char>) {
+        *out = piece;
+        return out + 1;
+    } else {
+        const std::string_view view(piece);
+        std::memcpy(out, view.data(), view.size());
+        return out + view.size();
+    }
+}
+
 class StringBuilder {
 private:
     std::string data;
@@ -134,20 +190,44 @@ public:
     explicit StringBuilder(const std::string& str) : data(str) {}
     
     // 自定义加法运算符用于字符串连接
-    StringBuilder operator+(const StringBuilder& other) const {
+    StringBuilder operator+(const StringBuilder& other) const & {
         return StringBuilder(data + other.data);
     }
     
     // 支持与字符串字面量的操作
-    StringBuilder operator+(const std::string& str) const {
+    StringBuilder operator+(const std::string& str) const & {
         return StringBuilder(data + str);
     }
     
     // 支持与字符的操作
-    StringBuilder operator+(char c) const {
+    StringBuilder operator+(char c) const & {
         return StringBuilder(data + c);
     }
     
+    // 左操作数是临时对象时直接在它的缓冲区上追加，折叠链不再每步复制整个字符串
+    StringBuilder operator+(const StringBuilder& other) && {
+        data += other.data;
+        return std::move(*this);
+    }
+    
+    StringBuilder operator+(const std::string& str) && {
+        data += str;
+        return std::move(*this);
+    }
+    
+    StringBuilder operator+(char c) && {
+        data += c;
+        return std::move(*this);
+    }
+    
+    // 先折叠出所有片段的总长度，reserve一次后逐段追加
+    template<typename... Pieces>
+    StringBuilder& append_all(const Pieces&... pieces) {
+        data.reserve(data.size() + total_size(pieces...));
+        (append_piece(data, pieces), ...);
+        return *this;
+    }
+    
     // 逗号运算符重载用于链式添加
     StringBuilder& operator,(const std::string& str) {
         data += str;
@@ -155,6 +235,7 @@ public:
     }
     
     std::string str() const { return data; }
+    std::string_view view() const { return data; }
     
     friend std::ostream& operator<<(std::ostream& os, const StringBuilder& sb) {
         return os << sb.data;
@@ -181,11 +262,20 @@ public:
     T get() const { return value; }
 };
 
+// 逐个operator+：每个参数先构造一个StringBuilder，结果缓冲区随长度增长多次realloc
 template<typename... Args>
-StringBuilder concatenate_all(Args... args) {
+StringBuilder concatenate_by_plus(Args... args) {
     return (StringBuilder{} + ... + StringBuilder{args});
 }
 
+// 总长度已知后只分配一次；参数按引用传递，字面量保留数组类型
+template<typename... Args>
+StringBuilder concatenate_all(const Args&... args) {
+    StringBuilder sb;
+    sb.append_all(args...);
+    return sb;
+}
+
 template<typename T, typename... Args>
 Accumulator<T> accumulate_all(Args... args) {
     return (Accumulator<T>{args} + ...);
@@ -197,6 +287,14 @@ void demonstrate_operator_overloading() {
     // 字符串构建器折叠
     auto result = concatenate_all("Hello", " ", "World", "!");
     std::cout << "字符串折叠结果: " << result.str() << "\n";
+    std::cout << "operator+折叠结果: " << concatenate_by_plus("Hello", " ", "World", "!").str() << "\n";
+    
+    // 字面量和字符的总长度在编译期就能确定
+    static_assert(total_size("Hello", ' ', "World", '!') == 12);
+    std::string name = "报表";
+    auto exact = concatenate_all("[", name, "] 行数=", std::to_string(42), '\n');
+    std::cout << "预计算长度: " << total_size("[", name, "] 行数=", std::to_string(42), '\n')
+              << ", 实际长度: " << exact.view().size() << "\n";
     
     // 数值累积器折叠
     auto sum_acc = accumulate_all<int>(1, 2, 3, 4, 5);
@@ -230,15 +328,17 @@ constexpr auto fold_sum(Args... args) {
     return (args + ...);
 }
 
-// 性能测试辅助函数
+// 性能测试辅助函数：预热后重复采样，报告中位数和95%置信区间，而不是一次计时
 template<typename Func>
 auto measure_time(Func&& func, const std::string& name) {
-    auto start = std::chrono::high_resolution_clock::now();
-    auto result = func();
-    auto end = std::chrono::high_resolution_clock::now();
+    std::decay_t<decltype(func())> result{};
+    const auto stats = micro_bench::measure(name, [&]() {
+        result = func();
+        micro_bench::do_not_optimize(result);
+    });
     
-    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-    std::cout << name << " 耗时: " << duration.count() << " ns, 结果: " << result << "\n";
+    micro_bench::print_result(std::cout, stats);
+    std::cout << "  结果: " << result << "\n";
     
     return result;
 }
@@ -366,8 +466,270 @@ void demonstrate_advanced_patterns() {
     std::cout << "\n";
 }
 
+// ===== 6. 分块绳索构建演示 =====
+// 大报表如果先拼成一个std::string再写出，会经历多次扩容拷贝，峰值内存还是报表大小的两倍
+// RopeBuilder只记录片段列表：
+// 1. append_ref  借用调用者的数据（常量表头、模板、mmap内容），不拷贝
+// 2. append_copy 临时生成的片段拷进64KB固定块，块从不搬家，已发出的视图一直有效
+// 同一块里连续拷贝的片段会合并成一个片段，最后可以直接交给writev，不需要展平
+class RopeBuilder {
+private:
+    static constexpr size_t kChunkSize = 64 * 1024;
+    static constexpr size_t kLargePiece = kChunkSize / 4;  // 超过此长度的单独分配，不浪费块的剩余空间
+    static constexpr size_t kMinRef = 256;  // 短片段借用不划算：每个iovec都有内核开销，不如拷进块里合并
+
+    std::vector<std::string_view> pieces_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* chunk_cursor_ = nullptr;  // 当前块的空闲起点
+    size_t chunk_left_ = 0;
+    size_t total_ = 0;
+
+    char* allocate(size_t n) {
+        if (n > kLargePiece) {
+            chunks_.push_back(std::unique_ptr<char[]>(new char[n]));  // make_unique会清零，这里不需要
+            return chunks_.back().get();
+        }
+        if (n > chunk_left_) {
+            chunks_.push_back(std::unique_ptr<char[]>(new char[kChunkSize]));
+            chunk_cursor_ = chunks_.back().get();
+            chunk_left_ = kChunkSize;
+        }
+        char* p = chunk_cursor_;
+        chunk_cursor_ += n;
+        chunk_left_ -= n;
+        return p;
+    }
+
+    void push_piece(const char* p, size_t n) {
+        // 与上一个片段首尾相接时直接延长，减少iovec数量
+        if (!pieces_.empty() && pieces_.back().data() + pieces_.back().size() == p) {
+            pieces_.back() = std::string_view(pieces_.back().data(), pieces_.back().size() + n);
+        } else {
+            pieces_.emplace_back(p, n);
+        }
+        total_ += n;
+    }
+
+public:
+    RopeBuilder& append_ref(std::string_view s) {
+        if (s.size() < kMinRef) return append_copy(s);
+        push_piece(s.data(), s.size());
+        return *this;
+    }
+
+    RopeBuilder& append_copy(std::string_view s) {
+        if (s.empty()) return *this;
+        char* p = allocate(s.size());
+        std::memcpy(p, s.data(), s.size());
+        push_piece(p, s.size());
+        return *this;
+    }
+
+    RopeBuilder& append_copy(char c) {
+        char* p = allocate(1);
+        *p = c;
+        push_piece(p, 1);
+        return *this;
+    }
+
+    // 整数直接格式化进块里，不经过临时std::string
+    RopeBuilder& append_int(long long value) {
+        char buffer[24];
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        (void)ec;
+        return append_copy(std::string_view(buffer, static_cast<size_t>(end - buffer)));
+    }
+
+    // 一行的多个片段：总长度折叠算出后一次性占用块空间，各片段直接拷进去，整行只产生一个片段
+    template<typename... Pieces>
+    RopeBuilder& append_all(const Pieces&... pieces) {
+        const size_t n = total_size(pieces...);
+        if (n == 0) return *this;
+        char* const line = allocate(n);
+        char* cursor = line;
+        ((cursor = append_piece(cursor, pieces)), ...);
+        push_piece(line, n);
+        return *this;
+    }
+
+    size_t size() const { return total_; }
+    size_t piece_count() const { return pieces_.size(); }
+    const std::vector<std::string_view>& pieces() const { return pieces_; }
+
+    // 确实需要连续内存时才展平，长度已知所以只分配一次
+    std::string flatten() const {
+        std::string out;
+        out.reserve(total_);
+        for (auto piece : pieces_) out.append(piece);
+        return out;
+    }
+
+#if !defined(_WIN32)
+    std::vector<iovec> iovecs() const {
+        std::vector<iovec> iov;
+        iov.reserve(pieces_.size());
+        for (auto piece : pieces_) {
+            iov.push_back(iovec{const_cast<char*>(piece.data()), piece.size()});
+        }
+        return iov;
+    }
+
+    // 按IOV_MAX分批调用writev，处理部分写入与EINTR
+    bool write_to(int fd) const {
+#if defined(IOV_MAX)
+        constexpr size_t kMaxIov = IOV_MAX;
+#else
+        constexpr size_t kMaxIov = 1024;
+#endif
+        std::vector<iovec> iov = iovecs();
+        size_t index = 0;
+        while (index < iov.size()) {
+            int batch = static_cast<int>(std::min(iov.size() - index, kMaxIov));
+            ssize_t written = ::writev(fd, iov.data() + index, batch);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            // 跳过已写完的iovec，写了一半的那个调整起点
+            size_t n = static_cast<size_t>(written);
+            while (index < iov.size() && n >= iov[index].iov_len) {
+                n -= iov[index].iov_len;
+                ++index;
+            }
+            if (n > 0) {
+                iov[index].iov_base = static_cast<char*>(iov[index].iov_base) + n;
+                iov[index].iov_len -= n;
+            }
+        }
+        return true;
+    }
+#endif
+};
+
+void demonstrate_rope_builder() {
+    std::cout << "=== 分块绳索构建演示 ===\n";
+    
+    auto time_best = [](auto&& f) {
+        double best = 1e300;
+        for (int rep = 0; rep < 5; ++rep) {
+            auto start = std::chrono::high_resolution_clock::now();
+            f();
+            best = std::min(best, std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count());
+        }
+        return best;
+    };
+    
+    // 1. 单行拼接：operator+折叠 vs 预计算长度
+    std::vector<std::string> names;
+    for (int i = 0; i < 64; ++i) names.push_back("service-component-" + std::to_string(i));
+    const int lines = 200000;
+    size_t plus_bytes = 0, exact_bytes = 0;
+    double plus_ms = time_best([&] {
+        plus_bytes = 0;
+        for (int i = 0; i < lines; ++i) {
+            const std::string& name = names[static_cast<size_t>(i) & 63];
+            plus_bytes += concatenate_by_plus("| ", name, " | status=", "OK", " | latency_ms=", name, " |\n")
+                              .view().size();
+        }
+    });
+    double exact_ms = time_best([&] {
+        exact_bytes = 0;
+        for (int i = 0; i < lines; ++i) {
+            const std::string& name = names[static_cast<size_t>(i) & 63];
+            exact_bytes += concatenate_all("| ", name, " | status=", "OK", " | latency_ms=", name, " |\n")
+                               .view().size();
+        }
+    });
+    std::cout << "单行拼接 " << lines << " 行:\n";
+    std::cout << "  operator+折叠:   " << plus_ms << " ms\n";
+    std::cout << "  预计算长度:      " << exact_ms << " ms (" << plus_ms / exact_ms << "x)"
+              << ", 字节数" << (plus_bytes == exact_bytes ? "一致" : "不一致") << "\n";
+    
+    // 2. 大报表：拼成一个string再write vs 片段列表直接writev
+    // 表头和说明是大段常量，借用而不拷贝；每行的短字段拷进块里合并
+    std::string header = "# 服务状态报表\n";
+    for (int i = 0; i < 64; ++i) header += "# " + names[static_cast<size_t>(i)] + ": 说明文字占位\n";
+    header += "服务,序号,状态\n";
+    const int rows = 500000;
+    auto build_string = [&] {
+        std::string report;
+        report += header;
+        for (int i = 0; i < rows; ++i) {
+            report += names[static_cast<size_t>(i) & 63];
+            report += ',';
+            report += std::to_string(i);
+            report += ",OK\n";
+        }
+        return report;
+    };
+    auto build_rope = [&] {
+        RopeBuilder rope;
+        rope.append_ref(header);
+        for (int i = 0; i < rows; ++i) {
+            rope.append_ref(names[static_cast<size_t>(i) & 63]);
+            rope.append_copy(',').append_int(i).append_copy(",OK\n");
+        }
+        return rope;
+    };
+    
+    std::string flat;
+    RopeBuilder rope;
+    double string_build_ms = time_best([&] { flat = build_string(); });
+    double rope_build_ms = time_best([&] { rope = build_rope(); });
+    std::cout << "\n构建 " << rows << " 行报表 (" << flat.size() / 1024 << " KB):\n";
+    std::cout << "  std::string追加: " << string_build_ms << " ms\n";
+    std::cout << "  RopeBuilder:     " << rope_build_ms << " ms, 片段数 " << rope.piece_count() << "\n";
+    std::cout << "  展平后内容一致: " << (rope.flatten() == flat ? "是" : "否") << "\n";
+    
+    // append_all：一行的多个字段直接拷进块里，相邻的行继续合并成同一个片段
+    RopeBuilder line_rope;
+    std::string line_expected;
+    for (int i = 0; i < 1000; ++i) {
+        const std::string& name = names[static_cast<size_t>(i) & 63];
+        const std::string index = std::to_string(i);
+        line_rope.append_all(name, ',', index, ",OK\n");
+        line_expected += name + ',' + index + ",OK\n";
+    }
+    std::cout << "  append_all 1000行: 片段数 " << line_rope.piece_count()
+              << ", 内容" << (line_rope.flatten() == line_expected ? "一致" : "不一致") << "\n";
+    
+#if !defined(_WIN32)
+    namespace fs = std::filesystem;
+    fs::path path = fs::temp_directory_path() / "rope_builder_demo.csv";
+    auto write_file = [&](auto&& writer) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        bool ok = writer(fd);
+        ::close(fd);
+        return ok;
+    };
+    double write_ms = time_best([&] {
+        write_file([&](int fd) {
+            std::string report = build_string();
+            return ::write(fd, report.data(), report.size()) == static_cast<ssize_t>(report.size());
+        });
+    });
+    double writev_ms = time_best([&] {
+        write_file([&](int fd) { return build_rope().write_to(fd); });
+    });
+    std::ifstream in(path, std::ios::binary);
+    std::string written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::cout << "构建并写出文件:\n";
+    std::cout << "  string + write:  " << write_ms << " ms\n";
+    std::cout << "  rope + writev:   " << writev_ms << " ms (" << write_ms / writev_ms << "x)"
+              << ", 文件内容" << (written == flat ? "一致" : "不一致") << "\n";
+    in.close();
+    std::error_code ec;
+    fs::remove(path, ec);
+#endif
+    
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++17 折叠表达式参数包处理深度解析\n";
     std::cout << "=====================================\n";
     
@@ -378,6 +740,7 @@ int main() {
     demonstrate_operator_overloading();
     demonstrate_performance_analysis();
     demonstrate_advanced_patterns();
+    demonstrate_rope_builder();
     
     return 0;
 }
@@ -393,10 +756,12 @@ g++ -std=c++17 -O2 -Wall 03_fold_expressions.cpp -o fold_expressions
 3. 自定义运算符重载可实现复杂的折叠操作
 4. 折叠表达式通常比递归模板性能更好
 5. 在函数式编程和元编程中有广泛应用
+6. 用折叠先求总长度再reserve，拼接只分配一次；大输出用片段列表+writev避免展平
 
 注意事项:
 - 空参数包的折叠需要注意默认值（&&为true，||为false，,为void()）
 - 运算符优先级在复杂折叠中需要用括号明确
 - 某些运算符（如赋值运算符）不能用于折叠表达式
 - 折叠表达式可与其他C++17特性（如constexpr if）结合使用
+- RopeBuilder::append_ref只借用数据，被引用的字符串必须活到写出完成
 */
\ No newline at end of file
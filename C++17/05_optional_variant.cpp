@@ -7,6 +7,8 @@
  * 3. 异常安全保证 - 强异常安全和基本异常安全的实现
  * 4. 函数式编程范式 - monadic操作和链式调用
  * 5. 性能和内存优化 - 零开销抽象的实际应用
+ * 6. 热路径分派 - switch/跳转表实现的fast_visit与扁平化字节码求值
+ * 7. 列式记录存储 - 有效位图代替逐字段optional，字符串入字节区/字典，按列过滤聚合
  */
 
 #include <iostream>
@@ -19,6 +21,18 @@
 #include <type_traits>
 #include <chrono>
 #include <exception>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <bitset>
+#include <limits>
+#include <string_view>
+
+#include "../common/micro_bench.h"
 
 // ===== 1. std::optional类型安全的空值处理 =====
 class DatabaseRecord {
@@ -151,13 +165,176 @@ public:
     }
 };
 
+// 热路径variant分派：fast_visit
+// 备选组合数不超过kSwitchLimit时展开成switch，编译器可以生成直接跳转并内联每个分支；
+// 组合更多时退化为编译期生成的函数指针表。多个variant时先把下标压平成一个整数，
+// 最后一个variant的下标变化最快
+namespace fast_visit_detail {
+    constexpr size_t kSwitchLimit = 8;
+    
+    template<typename V>
+    constexpr size_t alternatives = std::variant_size_v<std::remove_reference_t<V>>;
+    
+    template<typename... Vs>
+    constexpr size_t total_combinations = (alternatives<Vs> * ...);
+    
+    // 第K个variant在压平下标中的步长
+    template<size_t K, typename... Vs>
+    constexpr size_t stride() {
+        constexpr size_t sizes[] = {alternatives<Vs>...};
+        size_t s = 1;
+        for (size_t i = K + 1; i < sizeof...(Vs); ++i) s *= sizes[i];
+        return s;
+    }
+    
+    template<size_t Flat, size_t K, typename... Vs>
+    constexpr size_t index_at = (Flat / stride<K, Vs...>()) % alternatives<std::tuple_element_t<K, std::tuple<Vs...>>>;
+    
+    // 下标已经由分派保证，跳过std::get的检查；保留参数的值类别
+    template<size_t I, typename V>
+    decltype(auto) unchecked_get(V&& v) {
+        auto* p = std::get_if<I>(&v);
+        if constexpr (std::is_lvalue_reference_v<V>) {
+            return *p;
+        } else {
+            return std::move(*p);
+        }
+    }
+    
+    template<typename F, typename... Vs>
+    using result_t = std::invoke_result_t<F, decltype(unchecked_get<0>(std::declval<Vs>()))...>;
+    
+    template<typename R, size_t Flat, typename F, typename... Vs, size_t... Ks>
+    R invoke_flat_impl(std::index_sequence<Ks...>, F&& f, Vs&&... vs) {
+        return std::invoke(std::forward<F>(f), unchecked_get<index_at<Flat, Ks, Vs...>>(std::forward<Vs>(vs))...);
+    }
+    
+    template<typename R, size_t Flat, typename F, typename... Vs>
+    R invoke_flat(F&& f, Vs&&... vs) {
+        return invoke_flat_impl<R, Flat>(std::index_sequence_for<Vs...>{}, std::forward<F>(f), std::forward<Vs>(vs)...);
+    }
+    
+    template<typename R, typename F, typename... Vs, size_t... Flat>
+    constexpr auto make_table(std::index_sequence<Flat...>) {
+        return std::array<R (*)(F&&, Vs&&...), sizeof...(Flat)>{{&invoke_flat<R, Flat, F, Vs...>...}};
+    }
+    
+    template<typename R, typename F, typename... Vs>
+    constexpr auto dispatch_table = make_table<R, F, Vs...>(std::make_index_sequence<total_combinations<Vs...>>{});
+}
+
+template<typename F, typename... Vs>
+decltype(auto) fast_visit(F&& f, Vs&&... vs) {
+    using namespace fast_visit_detail;
+    static_assert(sizeof...(Vs) > 0, "fast_visit至少需要一个variant");
+    using R = result_t<F, Vs...>;
+    constexpr size_t total = total_combinations<Vs...>;
+    
+    if ((vs.valueless_by_exception() || ...)) {
+        throw std::bad_variant_access{};
+    }
+    size_t flat = 0;
+    ((flat = flat * alternatives<Vs> + vs.index()), ...);
+    
+    if constexpr (total <= kSwitchLimit) {
+#define FAST_VISIT_CASE(I) \
+        case I: \
+            if constexpr (I < total) { \
+                return invoke_flat<R, I, F, Vs...>(std::forward<F>(f), std::forward<Vs>(vs)...); \
+            } \
+            break;
+        switch (flat) {
+            FAST_VISIT_CASE(0) FAST_VISIT_CASE(1) FAST_VISIT_CASE(2) FAST_VISIT_CASE(3)
+            FAST_VISIT_CASE(4) FAST_VISIT_CASE(5) FAST_VISIT_CASE(6) FAST_VISIT_CASE(7)
+        }
+#undef FAST_VISIT_CASE
+        __builtin_unreachable();
+    } else {
+        return dispatch_table<R, F, Vs...>[flat](std::forward<F>(f), std::forward<Vs>(vs)...);
+    }
+}
+
 // 复杂的variant处理：表达式求值器
 using Expression = std::variant<int, double, std::string>;
 
+// 规则表达式树：叶子是Expression，内部节点是二元运算
+struct BinaryExpr;
+using RuleExpr = std::variant<Expression, std::unique_ptr<BinaryExpr>>;
+
+struct BinaryExpr {
+    char op;  // + - * / < >
+    RuleExpr lhs;
+    RuleExpr rhs;
+};
+
+inline RuleExpr leaf(Expression value) { return RuleExpr{std::in_place_index<0>, std::move(value)}; }
+
+inline RuleExpr binary(char op, RuleExpr lhs, RuleExpr rhs) {
+    return std::make_unique<BinaryExpr>(BinaryExpr{op, std::move(lhs), std::move(rhs)});
+}
+
+// 扁平化的字节码：后序遍历生成，变量在编译时解析成槽位下标。
+// 栈顶缓存在acc里，右操作数是叶子时直接作为指令操作数，省掉一次压栈/出栈
+class Bytecode {
+public:
+    enum class Op : uint8_t { Load, Add, Sub, Mul, Div, Less, Greater };
+    enum class Source : uint8_t { Const, Slot, Stack };
+    
+    struct Instruction {
+        Op op;
+        Source source;
+        uint32_t operand;
+    };
+    
+    static constexpr size_t kMaxStack = 32;
+    
+    // slots按编译时给出的变量顺序排列
+    double run(const double* slots) const;
+    
+    size_t size() const { return code.size(); }
+    
+private:
+    friend class ExpressionEvaluator;
+    
+    static constexpr int key(Op op, Source source) {
+        return static_cast<int>(op) * 3 + static_cast<int>(source);
+    }
+    
+    std::vector<Instruction> code;
+    std::vector<double> constants;
+};
+
+inline double Bytecode::run(const double* slots) const {
+    double stack[kMaxStack];
+    size_t sp = 0;
+    double acc = 0.0;
+    const double* pool = constants.data();
+    // 运算和操作数来源合成一个分派键，每条指令只经过一次switch
+#define BYTECODE_CASES(OP, EXPR) \
+    case key(Op::OP, Source::Const): { const double operand = pool[ins.operand]; EXPR; break; } \
+    case key(Op::OP, Source::Slot): { const double operand = slots[ins.operand]; EXPR; break; } \
+    case key(Op::OP, Source::Stack): { const double operand = acc; acc = stack[--sp]; EXPR; break; }
+    for (const Instruction& ins : code) {
+        switch (key(ins.op, ins.source)) {
+            case key(Op::Load, Source::Const): stack[sp++] = acc; acc = pool[ins.operand]; break;
+            case key(Op::Load, Source::Slot): stack[sp++] = acc; acc = slots[ins.operand]; break;
+            BYTECODE_CASES(Add, acc += operand)
+            BYTECODE_CASES(Sub, acc -= operand)
+            BYTECODE_CASES(Mul, acc *= operand)
+            BYTECODE_CASES(Div, acc /= operand)
+            BYTECODE_CASES(Less, acc = acc < operand ? 1.0 : 0.0)
+            BYTECODE_CASES(Greater, acc = acc > operand ? 1.0 : 0.0)
+            default: break;
+        }
+    }
+#undef BYTECODE_CASES
+    return acc;
+}
+
 class ExpressionEvaluator {
 public:
     static double evaluate(const Expression& expr, const std::map<std::string, double>& variables = {}) {
-        return std::visit([&variables](const auto& value) -> double {
+        return fast_visit([&variables](const auto& value) -> double {
             using T = std::decay_t<decltype(value)>;
             if constexpr (std::is_same_v<T, int>) {
                 return static_cast<double>(value);
@@ -172,6 +349,91 @@ public:
             }
         }, expr);
     }
+    
+    // 递归求值：每个节点一次分派，每个变量一次map查找
+    static double evaluate(const RuleExpr& expr, const std::map<std::string, double>& variables = {}) {
+        return fast_visit([&variables](const auto& node) -> double {
+            using T = std::decay_t<decltype(node)>;
+            if constexpr (std::is_same_v<T, Expression>) {
+                return evaluate(node, variables);
+            } else {
+                return apply(node->op, evaluate(node->lhs, variables), evaluate(node->rhs, variables));
+            }
+        }, expr);
+    }
+    
+    // 编译一次、执行多次：slot_names给出run()时slots数组的变量顺序
+    static Bytecode compile(const RuleExpr& expr, const std::vector<std::string>& slot_names) {
+        Bytecode program;
+        size_t depth = 0;
+        emit(program, expr, slot_names, depth);
+        return program;
+    }
+    
+    static double apply(char op, double lhs, double rhs) {
+        switch (op) {
+            case '+': return lhs + rhs;
+            case '-': return lhs - rhs;
+            case '*': return lhs * rhs;
+            case '/': return lhs / rhs;
+            case '<': return lhs < rhs ? 1.0 : 0.0;
+            case '>': return lhs > rhs ? 1.0 : 0.0;
+            default: throw std::runtime_error(std::string{"未知运算符: "} + op);
+        }
+    }
+    
+private:
+    static Bytecode::Op to_opcode(char op) {
+        switch (op) {
+            case '+': return Bytecode::Op::Add;
+            case '-': return Bytecode::Op::Sub;
+            case '*': return Bytecode::Op::Mul;
+            case '/': return Bytecode::Op::Div;
+            case '<': return Bytecode::Op::Less;
+            case '>': return Bytecode::Op::Greater;
+            default: throw std::runtime_error(std::string{"未知运算符: "} + op);
+        }
+    }
+    
+    // 叶子变成一条(来源, 操作数)：常量进常量池，变量换成槽位下标
+    static Bytecode::Instruction operand_of(Bytecode& program, const Expression& value,
+                                            const std::vector<std::string>& slot_names) {
+        return fast_visit([&](const auto& v) -> Bytecode::Instruction {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                auto it = std::find(slot_names.begin(), slot_names.end(), v);
+                if (it == slot_names.end()) {
+                    throw std::runtime_error("未知变量: " + v);
+                }
+                return {Bytecode::Op::Load, Bytecode::Source::Slot, static_cast<uint32_t>(it - slot_names.begin())};
+            } else {
+                program.constants.push_back(static_cast<double>(v));
+                return {Bytecode::Op::Load, Bytecode::Source::Const, static_cast<uint32_t>(program.constants.size() - 1)};
+            }
+        }, value);
+    }
+    
+    static void emit(Bytecode& program, const RuleExpr& expr, const std::vector<std::string>& slot_names, size_t& depth) {
+        if (const Expression* value = std::get_if<Expression>(&expr)) {
+            if (++depth > Bytecode::kMaxStack) {
+                throw std::runtime_error("表达式嵌套过深");
+            }
+            program.code.push_back(operand_of(program, *value, slot_names));
+            return;
+        }
+        const BinaryExpr& node = *std::get<std::unique_ptr<BinaryExpr>>(expr);
+        const Bytecode::Op op = to_opcode(node.op);
+        emit(program, node.lhs, slot_names, depth);
+        if (const Expression* rhs = std::get_if<Expression>(&node.rhs)) {
+            Bytecode::Instruction ins = operand_of(program, *rhs, slot_names);
+            ins.op = op;
+            program.code.push_back(ins);
+        } else {
+            emit(program, node.rhs, slot_names, depth);
+            program.code.push_back({op, Bytecode::Source::Stack, 0});
+            --depth;
+        }
+    }
 };
 
 void demonstrate_variant_basics() {
@@ -364,7 +626,7 @@ Maybe<std::string> process_string_chain(const std::string& input) {
 // variant的函数式处理
 template<typename... Types, typename F>
 auto visit_with_index(const std::variant<Types...>& var, F&& func) {
-    return std::visit([&func, index = var.index()](const auto& value) {
+    return fast_visit([&func, index = var.index()](const auto& value) {
         return func(value, index);
     }, var);
 }
@@ -411,71 +673,68 @@ void demonstrate_functional_programming() {
 // 性能测试：optional vs 指针
 class PerformanceTest {
 public:
+    // 每次迭代处理一批元素，由统一基准框架预热、标定迭代次数并重复采样，报告中位数而不是单次计时
+    static constexpr size_t kBatch = 10000;
+    
     static void test_optional_vs_pointer() {
-        constexpr size_t iterations = 10000000;
-        
         // optional测试
-        auto start = std::chrono::high_resolution_clock::now();
-        
         size_t optional_hits = 0;
-        for (size_t i = 0; i < iterations; ++i) {
-            std::optional<int> opt = (i % 2 == 0) ? std::make_optional(static_cast<int>(i)) : std::nullopt;
-            if (opt) {
-                optional_hits += *opt % 1000;  // 避免编译器优化
+        const auto optional_result = micro_bench::measure("Optional", [&optional_hits]() {
+            for (size_t i = 0; i < kBatch; ++i) {
+                std::optional<int> opt = (i % 2 == 0) ? std::make_optional(static_cast<int>(i)) : std::nullopt;
+                if (opt) {
+                    optional_hits += *opt % 1000;
+                }
             }
-        }
-        
-        auto mid = std::chrono::high_resolution_clock::now();
+            micro_bench::do_not_optimize(optional_hits);  // 避免编译器优化
+        }, kBatch);
         
         // 指针测试
         size_t pointer_hits = 0;
-        for (size_t i = 0; i < iterations; ++i) {
-            std::unique_ptr<int> ptr = (i % 2 == 0) ? std::make_unique<int>(static_cast<int>(i)) : nullptr;
-            if (ptr) {
-                pointer_hits += *ptr % 1000;  // 避免编译器优化
+        const auto pointer_result = micro_bench::measure("指针", [&pointer_hits]() {
+            for (size_t i = 0; i < kBatch; ++i) {
+                std::unique_ptr<int> ptr = (i % 2 == 0) ? std::make_unique<int>(static_cast<int>(i)) : nullptr;
+                if (ptr) {
+                    pointer_hits += *ptr % 1000;
+                }
             }
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        
-        auto optional_time = std::chrono::duration_cast<std::chrono::milliseconds>(mid - start);
-        auto pointer_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - mid);
+            micro_bench::do_not_optimize(pointer_hits);  // 避免编译器优化
+        }, kBatch);
         
-        std::cout << "Optional耗时: " << optional_time.count() << "ms (命中: " << optional_hits % 1000 << ")\n";
-        std::cout << "指针耗时: " << pointer_time.count() << "ms (命中: " << pointer_hits % 1000 << ")\n";
+        micro_bench::print_result(std::cout, optional_result);
+        micro_bench::print_result(std::cout, pointer_result);
+        std::cout << "  命中: optional " << optional_hits % 1000 << "，指针 " << pointer_hits % 1000 << "\n";
     }
     
     static void test_variant_vs_inheritance() {
-        constexpr size_t iterations = 1000000;
-        
-        // variant测试
+        // variant测试：容器在循环外预留好容量，样本之间只清空不重新分配
         std::vector<std::variant<int, double, std::string>> variant_data;
-        variant_data.reserve(iterations);
-        
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        for (size_t i = 0; i < iterations; ++i) {
-            switch (i % 3) {
-                case 0: variant_data.emplace_back(static_cast<int>(i)); break;
-                case 1: variant_data.emplace_back(static_cast<double>(i)); break;
-                case 2: variant_data.emplace_back(std::to_string(i)); break;
-            }
-        }
+        variant_data.reserve(kBatch);
         
         size_t variant_sum = 0;
-        for (const auto& item : variant_data) {
-            std::visit([&variant_sum](const auto& value) {
-                using T = std::decay_t<decltype(value)>;
-                if constexpr (std::is_arithmetic_v<T>) {
-                    variant_sum += static_cast<size_t>(value) % 1000;
+        const auto variant_result = micro_bench::measure("Variant构造+访问", [&]() {
+            variant_data.clear();
+            for (size_t i = 0; i < kBatch; ++i) {
+                switch (i % 3) {
+                    case 0: variant_data.emplace_back(static_cast<int>(i)); break;
+                    case 1: variant_data.emplace_back(static_cast<double>(i)); break;
+                    case 2: variant_data.emplace_back(std::to_string(i)); break;
                 }
-            }, item);
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        auto variant_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+            }
+            
+            for (const auto& item : variant_data) {
+                std::visit([&variant_sum](const auto& value) {
+                    using T = std::decay_t<decltype(value)>;
+                    if constexpr (std::is_arithmetic_v<T>) {
+                        variant_sum += static_cast<size_t>(value) % 1000;
+                    }
+                }, item);
+            }
+            micro_bench::do_not_optimize(variant_sum);
+        }, kBatch);
         
-        std::cout << "Variant耗时: " << variant_time.count() << "ms (求和: " << variant_sum % 1000 << ")\n";
+        micro_bench::print_result(std::cout, variant_result);
+        std::cout << "  求和: " << variant_sum % 1000 << "\n";
     }
 };
 
@@ -496,8 +755,607 @@ void demonstrate_performance_optimization() {
     std::cout << "\n";
 }
 
+// ===== 6. 热路径variant分派与字节码求值 =====
+template<typename... Fs>
+struct overloaded : Fs... {
+    using Fs::operator()...;
+};
+template<typename... Fs>
+overloaded(Fs...) -> overloaded<Fs...>;
+
+// 多variant访问：int与int相加保持int，其余组合提升为double
+using Number = std::variant<int, double>;
+
+Number add_numbers(const Number& a, const Number& b) {
+    return fast_visit(overloaded{
+        [](int x, int y) -> Number { return x + y; },
+        [](auto x, auto y) -> Number { return static_cast<double>(x) + static_cast<double>(y); }
+    }, a, b);
+}
+
+class VisitBenchmark {
+public:
+    using Scalar = std::variant<int, double, float, int64_t>;
+    
+    // 随机的备选下标让分支预测失效，比较std::visit与fast_visit各自的分派开销
+    static void test_dispatch() {
+        constexpr size_t count = 4000000;
+        std::vector<Scalar> data;
+        data.reserve(count);
+        uint64_t seed = 12345;
+        for (size_t i = 0; i < count; ++i) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            const int v = static_cast<int>((seed >> 33) % 1000);
+            switch (seed >> 62) {
+                case 0: data.emplace_back(v); break;
+                case 1: data.emplace_back(static_cast<double>(v)); break;
+                case 2: data.emplace_back(static_cast<float>(v)); break;
+                default: data.emplace_back(static_cast<int64_t>(v)); break;
+            }
+        }
+        
+        auto to_double = [](auto value) { return static_cast<double>(value); };
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        double std_sum = 0.0;
+        for (const auto& item : data) std_sum += std::visit(to_double, item);
+        auto mid = std::chrono::high_resolution_clock::now();
+        double fast_sum = 0.0;
+        for (const auto& item : data) fast_sum += fast_visit(to_double, item);
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        auto ns_per = [](auto d) { return std::chrono::duration<double, std::nano>(d).count() / count; };
+        std::cout << "单variant分派(" << count << "个随机备选): std::visit " << ns_per(mid - start)
+                  << " ns/次, fast_visit " << ns_per(end - mid) << " ns/次"
+                  << (std_sum == fast_sum ? "" : " (结果不一致!)") << "\n";
+    }
+    
+    // 同一条规则：递归树遍历 + map查找 对比 编译后的字节码 + 槽位数组
+    static void test_rule_evaluation() {
+        constexpr size_t records = 1000000;
+        const std::vector<std::string> slots = {"temperature", "humidity", "threshold"};
+        // (temperature - 20) * 1.8 + humidity / 4 > threshold
+        RuleExpr rule = binary('>',
+            binary('+',
+                binary('*', binary('-', leaf(std::string{"temperature"}), leaf(20)), leaf(1.8)),
+                binary('/', leaf(std::string{"humidity"}), leaf(4))),
+            leaf(std::string{"threshold"}));
+        Bytecode program = ExpressionEvaluator::compile(rule, slots);
+        
+        std::vector<double> data(records * slots.size());
+        uint64_t seed = 777;
+        for (size_t i = 0; i < data.size(); i += 3) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            data[i] = static_cast<double>((seed >> 40) % 40);
+            data[i + 1] = static_cast<double>((seed >> 20) % 100);
+            data[i + 2] = 30.0;
+        }
+        
+        // map版本只跑前1/10的记录，否则基准太慢
+        constexpr size_t tree_records = records / 10;
+        std::map<std::string, double> variables;
+        for (const auto& name : slots) variables[name] = 0.0;
+        double* bound[] = {&variables["temperature"], &variables["humidity"], &variables["threshold"]};
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t tree_hits = 0;
+        for (size_t r = 0; r < tree_records; ++r) {
+            for (size_t s = 0; s < 3; ++s) *bound[s] = data[r * 3 + s];
+            tree_hits += ExpressionEvaluator::evaluate(rule, variables) != 0.0;
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        size_t code_hits = 0, code_hits_prefix = 0;
+        for (size_t r = 0; r < records; ++r) {
+            code_hits += program.run(&data[r * 3]) != 0.0;
+            if (r + 1 == tree_records) code_hits_prefix = code_hits;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        auto per_second = [](auto d, size_t n) {
+            return n / std::chrono::duration<double>(d).count() / 1e6;
+        };
+        std::cout << "规则求值(" << program.size() << "条指令): 递归树+map " << per_second(mid - start, tree_records)
+                  << " M次/秒, 字节码 " << per_second(end - mid, records) << " M次/秒, 命中 "
+                  << code_hits << "/" << records
+                  << (tree_hits == code_hits_prefix ? "" : " (两种求值结果不一致!)") << "\n";
+    }
+};
+
+void demonstrate_fast_dispatch() {
+    std::cout << "=== 热路径variant分派与字节码求值 ===\n";
+    
+    // 多variant访问
+    std::cout << "3 + 4 = " << std::get<int>(add_numbers(3, 4)) << " (int)\n";
+    std::cout << "3 + 0.5 = " << std::get<double>(add_numbers(3, 0.5)) << " (double)\n";
+    
+    // 3个variant共27种组合，超过switch上限，走函数指针表
+    Expression a = 2, b = 1.5, c = std::string{"x"};
+    auto describe = fast_visit([](const auto&... values) {
+        return (std::string{} + ... + (std::is_same_v<std::decay_t<decltype(values)>, std::string> ? "s" : "n"));
+    }, a, b, c);
+    std::cout << "三个表达式的种类: " << describe << "\n";
+    
+    // 同一棵规则树：递归求值与字节码求值
+    std::map<std::string, double> variables = {{"x", 10.0}, {"y", 20.0}};
+    RuleExpr rule = binary('>', binary('+', binary('*', leaf(std::string{"x"}), leaf(2)), leaf(std::string{"y"})), leaf(30));
+    Bytecode program = ExpressionEvaluator::compile(rule, {"x", "y"});
+    const double slots[] = {10.0, 20.0};
+    std::cout << "x * 2 + y > 30: 递归求值 " << ExpressionEvaluator::evaluate(rule, variables)
+              << ", 字节码(" << program.size() << "条指令) " << program.run(slots) << "\n";
+    
+    try {
+        ExpressionEvaluator::compile(rule, {"x"});
+    } catch (const std::exception& e) {
+        std::cout << "编译错误: " << e.what() << "\n";
+    }
+    
+    VisitBenchmark::test_dispatch();
+    VisitBenchmark::test_rule_evaluation();
+    
+    std::cout << "\n";
+}
+
+// ===== 7. 列式记录存储：有效位图代替逐字段optional =====
+// DatabaseRecord每行一个对象：string(32字节) + optional<int>(8字节) + optional<string>(40字节)，
+// 超出SSO长度的邮箱还要单独分配一次堆内存；扫描"年龄"时也要把整行拉进缓存
+// ColumnarTable把每个字段存成一列：
+// 1. 空值用每行1位的有效位图表示，空槽位的值固定为0，聚合时可以不看位图直接求和
+// 2. 字符串写进连续的字节区，每行只记(偏移, 长度)；重复多的列(姓名)再做字典编码，每行一个uint32_t
+// 3. 过滤/聚合内核只扫描用到的列，循环里没有分支，编译器可以自动向量化
+// 4. RecordView/RecordRef按行号访问各列，保留get_age/get_email_display等原有接口
+
+class ValidityBitmap {
+private:
+    std::vector<uint64_t> words_;
+    size_t size_ = 0;
+    
+public:
+    void push_back(bool valid) {
+        if (size_ % 64 == 0) words_.push_back(0);
+        words_.back() |= static_cast<uint64_t>(valid) << (size_ % 64);
+        ++size_;
+    }
+    
+    void set(size_t i, bool valid) {
+        const uint64_t bit = uint64_t{1} << (i % 64);
+        words_[i / 64] = valid ? (words_[i / 64] | bit) : (words_[i / 64] & ~bit);
+    }
+    
+    bool test(size_t i) const { return (words_[i / 64] >> (i % 64)) & 1; }
+    
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t w : words_) total += std::bitset<64>(w).count();
+        return total;
+    }
+    
+    const uint64_t* words() const { return words_.data(); }
+    size_t word_count() const { return words_.size(); }
+    size_t memory_bytes() const { return words_.capacity() * sizeof(uint64_t); }
+    
+    void reserve(size_t n) { words_.reserve((n + 63) / 64); }
+};
+
+// 可空的定长列
+template<typename T>
+class NullableColumn {
+    static_assert(std::is_arithmetic_v<T>);
+    
+private:
+    std::vector<T> values_;
+    ValidityBitmap validity_;
+    
+public:
+    void push_back(std::optional<T> value) {
+        values_.push_back(value.value_or(T{}));
+        validity_.push_back(value.has_value());
+    }
+    
+    void set(size_t i, std::optional<T> value) {
+        values_[i] = value.value_or(T{});
+        validity_.set(i, value.has_value());
+    }
+    
+    std::optional<T> get(size_t i) const {
+        return validity_.test(i) ? std::optional<T>(values_[i]) : std::nullopt;
+    }
+    
+    const T* data() const { return values_.data(); }
+    const ValidityBitmap& validity() const { return validity_; }
+    size_t memory_bytes() const { return values_.capacity() * sizeof(T) + validity_.memory_bytes(); }
+    
+    void reserve(size_t n) {
+        values_.reserve(n);
+        validity_.reserve(n);
+    }
+};
+
+// 字节区字符串列：重写某一行时追加新内容，旧字节成为垃圾，compact()时回收
+class ArenaStringColumn {
+private:
+    struct Slice {
+        uint32_t offset;
+        uint32_t length;
+    };
+    std::vector<char> bytes_;
+    std::vector<Slice> slices_;
+    ValidityBitmap validity_;
+    
+    Slice store(std::string_view text) {
+        if (bytes_.size() + text.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("字符串列超过4GB");
+        }
+        Slice slice{static_cast<uint32_t>(bytes_.size()), static_cast<uint32_t>(text.size())};
+        bytes_.insert(bytes_.end(), text.begin(), text.end());
+        return slice;
+    }
+    
+public:
+    void push_back(std::optional<std::string_view> text) {
+        slices_.push_back(text ? store(*text) : Slice{0, 0});
+        validity_.push_back(text.has_value());
+    }
+    
+    void set(size_t i, std::optional<std::string_view> text) {
+        slices_[i] = text ? store(*text) : Slice{0, 0};
+        validity_.set(i, text.has_value());
+    }
+    
+    std::optional<std::string_view> get(size_t i) const {
+        if (!validity_.test(i)) return std::nullopt;
+        return std::string_view(bytes_.data() + slices_[i].offset, slices_[i].length);
+    }
+    
+    // 按行序重新写一遍字节区，丢掉被覆盖的旧内容
+    void compact() {
+        std::vector<char> packed;
+        packed.reserve(bytes_.size());
+        for (auto& slice : slices_) {
+            const uint32_t offset = static_cast<uint32_t>(packed.size());
+            packed.insert(packed.end(), bytes_.begin() + slice.offset, bytes_.begin() + slice.offset + slice.length);
+            slice.offset = offset;
+        }
+        bytes_ = std::move(packed);
+    }
+    
+    const ValidityBitmap& validity() const { return validity_; }
+    size_t memory_bytes() const {
+        return bytes_.capacity() + slices_.capacity() * sizeof(Slice) + validity_.memory_bytes();
+    }
+    
+    void reserve(size_t rows, size_t bytes) {
+        slices_.reserve(rows);
+        bytes_.reserve(bytes);
+        validity_.reserve(rows);
+    }
+};
+
+// 字典编码字符串列(非空)：每个不同的值只存一次，行里只放编码
+class DictionaryStringColumn {
+private:
+    std::vector<uint32_t> codes_;
+    std::vector<std::string> dictionary_;
+    std::map<std::string, uint32_t, std::less<>> lookup_;
+    
+public:
+    static constexpr uint32_t NOT_FOUND = std::numeric_limits<uint32_t>::max();
+    
+    void push_back(std::string_view text) {
+        codes_.push_back(intern(text));
+    }
+    
+    void set(size_t i, std::string_view text) {
+        codes_[i] = intern(text);
+    }
+    
+    uint32_t intern(std::string_view text) {
+        auto it = lookup_.find(text);
+        if (it != lookup_.end()) return it->second;
+        const auto code = static_cast<uint32_t>(dictionary_.size());
+        dictionary_.emplace_back(text);
+        lookup_.emplace(dictionary_.back(), code);
+        return code;
+    }
+    
+    uint32_t find(std::string_view text) const {
+        auto it = lookup_.find(text);
+        return it == lookup_.end() ? NOT_FOUND : it->second;
+    }
+    
+    std::string_view get(size_t i) const { return dictionary_[codes_[i]]; }
+    std::string_view decode(uint32_t code) const { return dictionary_[code]; }
+    
+    const uint32_t* codes() const { return codes_.data(); }
+    size_t cardinality() const { return dictionary_.size(); }
+    
+    // 字典本身按字符串实际占用估算：两份字符串(数组和查找表) + map节点
+    size_t memory_bytes() const {
+        size_t bytes = codes_.capacity() * sizeof(uint32_t) + dictionary_.capacity() * sizeof(std::string);
+        for (const auto& s : dictionary_) {
+            bytes += 2 * (s.capacity() > 15 ? s.capacity() + 1 : 0) + sizeof(std::string) + 48;
+        }
+        return bytes;
+    }
+    
+    void reserve(size_t n) { codes_.reserve(n); }
+};
+
+class ColumnarTable {
+private:
+    DictionaryStringColumn names_;
+    NullableColumn<int32_t> ages_;
+    ArenaStringColumn emails_;
+    size_t rows_ = 0;
+    
+public:
+    // 只读行视图：接口与DatabaseRecord一致，字符串以string_view返回，指向表内存储
+    class RecordView {
+    protected:
+        const ColumnarTable* table_;
+        size_t row_;
+        
+    public:
+        RecordView(const ColumnarTable* table, size_t row) : table_(table), row_(row) {}
+        
+        std::string_view get_name() const { return table_->names_.get(row_); }
+        
+        std::optional<int> get_age() const { return table_->ages_.get(row_); }
+        
+        std::optional<std::string> get_email() const {
+            auto email = table_->emails_.get(row_);
+            return email ? std::optional<std::string>(*email) : std::nullopt;
+        }
+        
+        std::optional<std::string_view> get_email_view() const { return table_->emails_.get(row_); }
+        
+        std::string get_age_display() const {
+            auto age = get_age();
+            return age.has_value() ? std::to_string(age.value()) : "未知";
+        }
+        
+        std::string get_email_display() const {
+            return std::string(get_email_view().value_or("无邮箱"));
+        }
+    };
+    
+    // 可写行代理：set_*直接改对应列
+    class RecordRef : public RecordView {
+    public:
+        RecordRef(ColumnarTable* table, size_t row) : RecordView(table, row) {}
+        
+        void set_age(int a) { mutable_table().ages_.set(row_, a); }
+        void clear_age() { mutable_table().ages_.set(row_, std::nullopt); }
+        void set_email(std::string_view e) { mutable_table().emails_.set(row_, e); }
+        void clear_email() { mutable_table().emails_.set(row_, std::nullopt); }
+        
+    private:
+        ColumnarTable& mutable_table() const { return *const_cast<ColumnarTable*>(table_); }
+    };
+    
+    void reserve(size_t rows, size_t email_bytes) {
+        names_.reserve(rows);
+        ages_.reserve(rows);
+        emails_.reserve(rows, email_bytes);
+    }
+    
+    RecordRef append(std::string_view name, std::optional<int> age = std::nullopt,
+                     std::optional<std::string_view> email = std::nullopt) {
+        names_.push_back(name);
+        ages_.push_back(age);
+        emails_.push_back(email);
+        return RecordRef(this, rows_++);
+    }
+    
+    RecordRef append(const DatabaseRecord& record) {
+        auto email = record.get_email();
+        return append(record.get_name(), record.get_age(),
+                      email ? std::optional<std::string_view>(*email) : std::nullopt);
+    }
+    
+    size_t size() const { return rows_; }
+    size_t distinct_names() const { return names_.cardinality(); }
+    RecordView operator[](size_t row) const { return RecordView(this, row); }
+    RecordRef operator[](size_t row) { return RecordRef(this, row); }
+    
+    void compact() { emails_.compact(); }
+    
+    size_t memory_bytes() const {
+        return names_.memory_bytes() + ages_.memory_bytes() + emails_.memory_bytes();
+    }
+    
+    // ---- 向量化内核 ----
+    
+    // age在[lo, hi]内的行号：每行无条件写入，满足条件才前进；一个无符号比较同时检查上下界
+    size_t filter_age_between(int lo, int hi, std::vector<uint32_t>& out) const {
+        // lo > hi时hi - lo按无符号回绕成一个很大的跨度，几乎每行都会命中，空区间直接返回
+        if (lo > hi) {
+            out.clear();
+            return 0;
+        }
+        out.resize(rows_);
+        const int32_t* ages = ages_.data();
+        const uint64_t* valid = ages_.validity().words();
+        const auto span = static_cast<uint32_t>(hi) - static_cast<uint32_t>(lo);
+        size_t n = 0;
+        for (size_t w = 0; w < ages_.validity().word_count(); ++w) {
+            const uint64_t bits = valid[w];
+            if (bits == 0) continue;
+            const size_t base = w * 64;
+            const size_t end = std::min<size_t>(64, rows_ - base);
+            for (size_t j = 0; j < end; ++j) {
+                const bool keep = ((bits >> j) & 1) &
+                                  (static_cast<uint32_t>(ages[base + j]) - static_cast<uint32_t>(lo) <= span);
+                out[n] = static_cast<uint32_t>(base + j);
+                n += keep;
+            }
+        }
+        out.resize(n);
+        return n;
+    }
+    
+    // 空槽位存的是0，求和时不必检查位图；个数来自位图的popcount
+    std::optional<double> average_age() const {
+        const int32_t* ages = ages_.data();
+        int64_t sum = 0;
+        for (size_t i = 0; i < rows_; ++i) sum += ages[i];
+        const size_t count = ages_.validity().count();
+        return count ? std::optional<double>(static_cast<double>(sum) / count) : std::nullopt;
+    }
+    
+    size_t count_with_email() const { return emails_.validity().count(); }
+    
+    // 字符串比较只做一次(查字典)，之后是整数列上的计数
+    size_t count_name(std::string_view name) const {
+        const uint32_t code = names_.find(name);
+        if (code == DictionaryStringColumn::NOT_FOUND) return 0;
+        return static_cast<size_t>(std::count(names_.codes(), names_.codes() + rows_, code));
+    }
+    
+    // 按姓名分组求平均年龄：以字典编码为下标累加，不需要哈希表
+    std::vector<std::pair<std::string_view, double>> average_age_by_name() const {
+        std::vector<int64_t> sums(names_.cardinality());
+        std::vector<uint32_t> counts(names_.cardinality());
+        const uint32_t* codes = names_.codes();
+        const int32_t* ages = ages_.data();
+        for (size_t i = 0; i < rows_; ++i) {
+            sums[codes[i]] += ages[i];
+            counts[codes[i]] += ages_.validity().test(i);
+        }
+        std::vector<std::pair<std::string_view, double>> result;
+        for (uint32_t code = 0; code < sums.size(); ++code) {
+            if (counts[code]) result.emplace_back(names_.decode(code), static_cast<double>(sums[code]) / counts[code]);
+        }
+        return result;
+    }
+};
+
+// 行存储一侧的内存：对象本身 + 超出SSO的字符串堆块(按glibc malloc的8字节块头、16字节粒度估算)
+size_t row_store_bytes(const std::vector<DatabaseRecord>& records) {
+    auto heap = [](const std::string& s) -> size_t {
+        return s.capacity() > 15 ? (s.capacity() + 1 + 8 + 15) / 16 * 16 : 0;
+    };
+    size_t bytes = records.capacity() * sizeof(DatabaseRecord);
+    for (const auto& r : records) {
+        bytes += heap(r.get_name());
+        if (auto email = r.get_email()) bytes += heap(*email);
+    }
+    return bytes;
+}
+
+template<typename Func>
+double best_ms(Func&& func) {
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+void demonstrate_columnar_records() {
+    std::cout << "=== 列式记录存储演示 ===\n";
+    
+    // 1. 行代理保留原有接口
+    ColumnarTable table;
+    table.append("Alice", 25);
+    table.append("Bob", std::nullopt, "bob.smith.1987@example.com");
+    auto carol = table.append("Carol");
+    carol.set_email("carol@example.org");
+    carol.set_age(41);
+    table[0].set_email("alice.wonderland@example.com");
+    table[1].set_email("bob@example.com");
+    for (size_t i = 0; i < table.size(); ++i) {
+        auto record = table[i];
+        std::cout << "记录: " << record.get_name() << ", 年龄: " << record.get_age_display()
+                  << ", 邮箱: " << record.get_email_display() << "\n";
+    }
+    
+    // 2. 同样的1M行数据：vector<DatabaseRecord> 与 ColumnarTable
+    constexpr size_t rows = 1'000'000;
+    const char* first[] = {"Wei", "Fang", "Min", "Jing", "Lei", "Yan", "Jun", "Tao", "Ming", "Hua",
+                           "Oliver", "Emma", "Noah", "Sophia", "Liam", "Mia"};
+    const char* last[] = {"Zhang", "Wang", "Li", "Zhao", "Chen", "Liu", "Yang", "Huang",
+                          "Smith", "Johnson", "Brown", "Garcia", "Miller", "Davis", "Wilson", "Moore"};
+    std::vector<DatabaseRecord> records;
+    records.reserve(rows);
+    ColumnarTable columns;
+    columns.reserve(rows, rows * 28);
+    uint64_t seed = 2024;
+    for (size_t i = 0; i < rows; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::string name = std::string(first[(seed >> 20) % 16]) + " " + last[(seed >> 30) % 16];
+        std::optional<int> age;
+        if ((seed >> 40) % 10 != 0) age = 18 + static_cast<int>((seed >> 44) % 60);
+        std::optional<std::string> email;
+        if ((seed >> 50) % 10 < 7) email = name.substr(0, name.find(' ')) + "." + std::to_string(i) + "@customer-mail.com";
+        
+        records.emplace_back(name);
+        if (age) records.back().set_age(*age);
+        if (email) records.back().set_email(*email);
+        columns.append(name, age, email ? std::optional<std::string_view>(*email) : std::nullopt);
+    }
+    
+    columns.compact();  // 装载完成后收紧字节区，预留的多余容量不计入
+    const size_t row_bytes = row_store_bytes(records);
+    const size_t column_bytes = columns.memory_bytes();
+    std::cout << "\n" << rows << " 行 (不同姓名 " << columns.distinct_names() << " 个):\n";
+    std::cout << "  行存储(DatabaseRecord " << sizeof(DatabaseRecord) << " 字节/对象): "
+              << row_bytes / rows << " 字节/行\n";
+    std::cout << "  列存储: " << column_bytes / rows << " 字节/行 (" << static_cast<double>(row_bytes) / column_bytes
+              << "x)\n";
+    
+    // 3. 同一查询在两种布局上的耗时与结果
+    std::vector<uint32_t> selected;
+    size_t row_hits = 0, column_hits = 0;
+    const double row_filter = best_ms([&] {
+        row_hits = 0;
+        for (const auto& r : records) {
+            auto age = r.get_age();
+            row_hits += age && *age >= 30 && *age <= 39;
+        }
+    });
+    const double column_filter = best_ms([&] { column_hits = columns.filter_age_between(30, 39, selected); });
+    
+    double row_avg = 0, column_avg = 0;
+    const double row_aggregate = best_ms([&] {
+        int64_t sum = 0;
+        size_t count = 0;
+        for (const auto& r : records) {
+            if (auto age = r.get_age()) {
+                sum += *age;
+                ++count;
+            }
+        }
+        row_avg = static_cast<double>(sum) / count;
+    });
+    const double column_aggregate = best_ms([&] { column_avg = columns.average_age().value_or(0); });
+    
+    size_t row_named = 0, column_named = 0;
+    const double row_count = best_ms([&] {
+        row_named = std::count_if(records.begin(), records.end(), [](const DatabaseRecord& r) {
+            return r.get_name() == "Wei Zhang";
+        });
+    });
+    const double column_count = best_ms([&] { column_named = columns.count_name("Wei Zhang"); });
+    
+    std::cout << "  过滤 30<=age<=39: 行存储 " << row_filter << " ms, 列存储 " << column_filter << " ms ("
+              << (row_hits == column_hits ? "结果一致" : "结果不一致!") << ", " << column_hits << " 行)\n";
+    std::cout << "  平均年龄:         行存储 " << row_aggregate << " ms, 列存储 " << column_aggregate << " ms ("
+              << (row_avg == column_avg ? "结果一致" : "结果不一致!") << ", " << column_avg << ")\n";
+    std::cout << "  按姓名计数:       行存储 " << row_count << " ms, 列存储 " << column_count << " ms ("
+              << (row_named == column_named ? "结果一致" : "结果不一致!") << ")\n";
+    
+    auto by_name = columns.average_age_by_name();
+    std::cout << "  按姓名分组 " << by_name.size() << " 组, 例如 " << by_name.front().first << ": "
+              << by_name.front().second << "\n";
+    
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++17 std::optional和std::variant类型安全容器深度解析\n";
     std::cout << "====================================================\n";
     
@@ -506,6 +1364,8 @@ int main() {
     demonstrate_exception_safety();
     demonstrate_functional_programming();
     demonstrate_performance_optimization();
+    demonstrate_fast_dispatch();
+    demonstrate_columnar_records();
     
     return 0;
 }
@@ -521,10 +1381,15 @@ g++ -std=c++17 -O2 -Wall 05_optional_variant.cpp -o optional_variant
 3. 两者都提供强异常安全保证，不会出现未定义行为
 4. 支持函数式编程范式，可以实现优雅的链式操作
 5. 零开销抽象，性能接近原生实现
+6. 备选较少时用switch分派、较多时用编译期函数指针表；热点规则先编译成字节码，避免逐节点递归访问
+7. 大量同构记录按列存储：每个空值只占1位，字符串不再逐行分配，扫描只触碰查询用到的列
 
 注意事项:
 - optional的value()在空值时会抛出异常，推荐使用value_or()
 - variant访问时要注意类型检查，避免bad_variant_access异常
 - 在性能关键的场景中要考虑内存开销
 - 与现代C++其他特性（如结构化绑定）结合使用效果更佳
+- fast_visit要求所有分支返回同一类型，valueless的variant同样抛出bad_variant_access
+- 字节码在编译时固定了变量槽位顺序，run()传入的数组必须按同样顺序排列
+- ColumnarTable返回的string_view指向列内存储，追加新行或修改字符串后可能失效
 */
\ No newline at end of file
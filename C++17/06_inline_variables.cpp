@@ -7,6 +7,7 @@
  * 3. 静态成员初始化 - 类内直接定义静态成员
  * 4. 编译器实现机制 - 链接期的符号合并
  * 5. 性能和内存优化 - ODR违反的解决和优化
+ * 6. 线程安全资源池 - inline thread_local弹匣与无锁仓库
  */
 
 #include <iostream>
@@ -16,6 +17,13 @@
 #include <type_traits>
 #include <chrono>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <limits>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
 
 // ===== 1. 单一定义规则突破演示 =====
 // 传统方式需要声明和定义分离
@@ -385,6 +393,372 @@ void demonstrate_performance_optimization() {
     std::cout << "\n";
 }
 
+// ===== 6. 线程安全的资源池演示 =====
+// 第3节的ResourcePool用static inline vector保存空闲对象，没有任何同步，多线程下不可用
+// ConcurrentResourcePool沿用"每个类型一个池"的内联静态成员设计：
+// 1. 每个线程一个弹匣(magazine)，缓存最多kMagazineSize个空闲对象，命中时不需要任何同步
+// 2. 弹匣空/满时与全局仓库(depot)整批交换；仓库是两个无锁栈，分别存放满弹匣和空弹匣
+// 3. 仓库节点预先分配、按下标链接，栈顶带版本号以避免ABA问题
+// 4. max_size限制对象总数，prewarm()预先构造，pooled_ptr析构时自动归还
+template<typename T>
+class ConcurrentResourcePool;
+
+// RAII句柄：只能移动，析构时把对象还给池
+template<typename T>
+class pooled_ptr {
+private:
+    T* ptr_ = nullptr;
+    
+public:
+    pooled_ptr() noexcept = default;
+    explicit pooled_ptr(T* ptr) noexcept : ptr_(ptr) {}
+    
+    pooled_ptr(pooled_ptr&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+    
+    pooled_ptr& operator=(pooled_ptr&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ptr_ = std::exchange(other.ptr_, nullptr);
+        }
+        return *this;
+    }
+    
+    pooled_ptr(const pooled_ptr&) = delete;
+    pooled_ptr& operator=(const pooled_ptr&) = delete;
+    
+    ~pooled_ptr() { reset(); }
+    
+    void reset() noexcept {
+        if (ptr_) ConcurrentResourcePool<T>::release(std::exchange(ptr_, nullptr));
+    }
+    
+    T* get() const noexcept { return ptr_; }
+    T& operator*() const noexcept { return *ptr_; }
+    T* operator->() const noexcept { return ptr_; }
+    explicit operator bool() const noexcept { return ptr_ != nullptr; }
+};
+
+template<typename T>
+class ConcurrentResourcePool {
+public:
+    static constexpr size_t kMagazineSize = 16;
+    
+    // 对象总数上限；需要在首次使用前设置，仓库容量按它分配
+    static inline size_t max_size = 1000;
+    
+private:
+    static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+    
+    struct Magazine {
+        T* items[kMagazineSize];
+        size_t count = 0;
+        std::atomic<uint32_t> next{kNil};
+    };
+    
+    // 无锁栈：64位栈顶 = 高32位版本号 + 低32位节点下标，节点永不释放
+    class IndexStack {
+    private:
+        std::atomic<uint64_t> head_{kNil};
+        
+        static uint64_t bump(uint64_t head, uint32_t index) { return (((head >> 32) + 1) << 32) | index; }
+        
+    public:
+        void push(Magazine* nodes, uint32_t index) {
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            do {
+                nodes[index].next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            } while (!head_.compare_exchange_weak(head, bump(head, index), std::memory_order_release,
+                                                  std::memory_order_relaxed));
+        }
+        
+        uint32_t pop(Magazine* nodes) {
+            uint64_t head = head_.load(std::memory_order_acquire);
+            while (true) {
+                auto index = static_cast<uint32_t>(head);
+                if (index == kNil) return kNil;
+                // 节点可能已被其他线程弹出并重新压入，此时版本号不同，CAS失败重试
+                uint32_t next = nodes[index].next.load(std::memory_order_relaxed);
+                if (head_.compare_exchange_weak(head, bump(head, next), std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+                    return index;
+                }
+            }
+        }
+    };
+    
+    struct Depot {
+        uint32_t capacity;
+        std::unique_ptr<Magazine[]> nodes;
+        IndexStack full;
+        IndexStack empty;
+        
+        explicit Depot(size_t max_objects)
+            : capacity(static_cast<uint32_t>(max_objects / kMagazineSize + 2)),
+              nodes(std::make_unique<Magazine[]>(capacity)) {
+            for (uint32_t i = 0; i < capacity; ++i) empty.push(nodes.get(), i);
+        }
+        
+        // 程序退出时销毁仓库中缓存的对象
+        ~Depot() {
+            for (uint32_t index = full.pop(nodes.get()); index != kNil; index = full.pop(nodes.get())) {
+                Magazine& magazine = nodes[index];
+                for (size_t i = 0; i < magazine.count; ++i) delete magazine.items[i];
+            }
+        }
+    };
+    
+    struct LocalCache {
+        T* items[kMagazineSize];
+        size_t count = 0;
+        
+        // 先构造仓库，保证仓库晚于线程缓存析构
+        LocalCache() { depot(); }
+        
+        // 线程退出时把缓存的对象交回仓库
+        ~LocalCache() {
+            if (count > 0 && !spill(*this)) {
+                for (size_t i = 0; i < count; ++i) destroy(items[i]);
+            }
+        }
+    };
+    
+    static inline std::atomic<size_t> created_count{0};
+    static inline thread_local LocalCache local_cache;
+    
+    static Depot& depot() {
+        static Depot instance(max_size);
+        return instance;
+    }
+    
+    static bool try_reserve() {
+        size_t created = created_count.load(std::memory_order_relaxed);
+        do {
+            if (created >= max_size) return false;
+        } while (!created_count.compare_exchange_weak(created, created + 1, std::memory_order_relaxed));
+        return true;
+    }
+    
+    static T* create() {
+        try {
+            return new T();
+        } catch (...) {
+            created_count.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+    
+    static void destroy(T* object) {
+        delete object;
+        created_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    
+    // 整个本地弹匣换一个满弹匣
+    static void refill(LocalCache& cache) {
+        Depot& d = depot();
+        uint32_t index = d.full.pop(d.nodes.get());
+        if (index == kNil) return;
+        Magazine& magazine = d.nodes[index];
+        std::copy(magazine.items, magazine.items + magazine.count, cache.items);
+        cache.count = magazine.count;
+        magazine.count = 0;
+        d.empty.push(d.nodes.get(), index);
+    }
+    
+    // 本地弹匣整体交给仓库；没有空弹匣时返回false
+    static bool spill(LocalCache& cache) {
+        Depot& d = depot();
+        uint32_t index = d.empty.pop(d.nodes.get());
+        if (index == kNil) return false;
+        Magazine& magazine = d.nodes[index];
+        std::copy(cache.items, cache.items + cache.count, magazine.items);
+        magazine.count = cache.count;
+        cache.count = 0;
+        d.full.push(d.nodes.get(), index);
+        return true;
+    }
+    
+public:
+    // 池为空且已达上限时返回空句柄，与ResourcePool::acquire一致
+    static pooled_ptr<T> acquire() {
+        LocalCache& cache = local_cache;
+        if (cache.count == 0) refill(cache);
+        if (cache.count > 0) return pooled_ptr<T>(cache.items[--cache.count]);
+        if (!try_reserve()) return pooled_ptr<T>();
+        return pooled_ptr<T>(create());
+    }
+    
+    // 对象原样回到池中，不会重置状态
+    static void release(T* object) {
+        LocalCache& cache = local_cache;
+        if (cache.count == kMagazineSize && !spill(cache)) {
+            destroy(object);
+            return;
+        }
+        cache.items[cache.count++] = object;
+    }
+    
+    // 预先构造最多n个对象并直接放入仓库，所有线程都能取到
+    static size_t prewarm(size_t n) {
+        Depot& d = depot();
+        size_t made = 0;
+        while (made < n) {
+            uint32_t index = d.empty.pop(d.nodes.get());
+            if (index == kNil) break;
+            Magazine& magazine = d.nodes[index];
+            magazine.count = 0;
+            while (magazine.count < kMagazineSize && made < n && try_reserve()) {
+                magazine.items[magazine.count++] = create();
+                ++made;
+            }
+            if (magazine.count == 0) {
+                d.empty.push(d.nodes.get(), index);
+                break;
+            }
+            d.full.push(d.nodes.get(), index);
+        }
+        return made;
+    }
+    
+    static size_t total_created() { return created_count.load(std::memory_order_relaxed); }
+    static size_t local_available() { return local_cache.count; }
+};
+
+// 对照组：ResourcePool的逻辑加一把互斥锁，是让它线程安全的最小改动
+template<typename T>
+class LockedResourcePool {
+private:
+    static inline std::mutex mtx;
+    static inline std::vector<std::unique_ptr<T>> available_resources;
+    static inline size_t created_count = 0;
+    
+public:
+    static inline size_t max_size = 1000;
+    
+    static std::unique_ptr<T> acquire() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!available_resources.empty()) {
+            auto resource = std::move(available_resources.back());
+            available_resources.pop_back();
+            return resource;
+        }
+        if (created_count >= max_size) return nullptr;
+        ++created_count;
+        return std::make_unique<T>();
+    }
+    
+    static void release(std::unique_ptr<T> resource) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (resource && available_resources.size() < max_size) {
+            available_resources.push_back(std::move(resource));
+        }
+    }
+};
+
+// 模拟构造昂贵的连接对象：分配并初始化64KB缓冲区
+struct ExpensiveConnection {
+    std::vector<char> buffer;
+    long long requests = 0;
+    
+    ExpensiveConnection() : buffer(64 * 1024) {
+        for (size_t i = 0; i < buffer.size(); i += 64) buffer[i] = static_cast<char>(i);
+    }
+};
+
+struct PooledBuffer {
+    char data[256];
+    long long uses = 0;
+};
+
+// 每个线程循环执行"获取-使用-归还"，同时持有hold个对象
+template<typename Acquire>
+double run_pool_churn(size_t threads, size_t iterations, size_t hold, Acquire acquire_and_use) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] { acquire_and_use(iterations, hold); });
+    }
+    for (auto& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threads * iterations / seconds / 1e6;
+}
+
+void demonstrate_concurrent_resource_pool() {
+    std::cout << "=== 线程安全资源池演示 ===\n";
+    
+    using ConnPool = ConcurrentResourcePool<ExpensiveConnection>;
+    ConnPool::max_size = 64;
+    std::cout << "预热连接数: " << ConnPool::prewarm(32) << "，已创建: " << ConnPool::total_created() << "\n";
+    {
+        auto conn = ConnPool::acquire();
+        conn->requests++;
+        std::cout << "获取连接后本线程缓存: " << ConnPool::local_available() << " 个\n";
+    }
+    std::cout << "句柄析构后本线程缓存: " << ConnPool::local_available() << " 个\n";
+    
+    // 上限：持有全部对象后再获取得到空句柄
+    {
+        std::vector<pooled_ptr<ExpensiveConnection>> held;
+        while (auto conn = ConnPool::acquire()) held.push_back(std::move(conn));
+        std::cout << "达到上限时持有 " << held.size() << " 个连接，再获取返回空句柄\n";
+    }
+    
+    // 获取+归还的单次开销，对比每次都构造新对象
+    const size_t pairs = 200000;
+    auto time_pairs = [&](auto&& body) {
+        auto start = std::chrono::steady_clock::now();
+        long long sink = 0;
+        for (size_t i = 0; i < pairs; ++i) sink += body();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / pairs;
+        return sink >= 0 ? ns : -ns;
+    };
+    double construct_ns = time_pairs([] { return std::make_unique<ExpensiveConnection>()->requests++; });
+    double locked_ns = time_pairs([] {
+        auto conn = LockedResourcePool<ExpensiveConnection>::acquire();
+        long long r = conn->requests++;
+        LockedResourcePool<ExpensiveConnection>::release(std::move(conn));
+        return r;
+    });
+    double pooled_ns = time_pairs([] { return ConnPool::acquire()->requests++; });
+    std::cout << "\n单线程获取+归还开销:\n";
+    std::cout << "  每次新建连接:        " << construct_ns << " ns\n";
+    std::cout << "  LockedResourcePool:  " << locked_ns << " ns\n";
+    std::cout << "  ConcurrentResourcePool: " << pooled_ns << " ns\n";
+    
+    // 扩展性：每个线程同时持有4个对象
+    using BufPool = ConcurrentResourcePool<PooledBuffer>;
+    using LockedBufPool = LockedResourcePool<PooledBuffer>;
+    const size_t iterations = 500000;
+    const size_t hold = 4;
+    std::cout << "\n多线程获取/归还吞吐 (M ops/s, 每线程持有" << hold << "个):\n";
+    std::cout << "线程数\tmutex池\t\t无锁弹匣池\n";
+    for (size_t threads : {1, 2, 4, 8}) {
+        double locked = run_pool_churn(threads, iterations, hold, [](size_t n, size_t k) {
+            std::vector<std::unique_ptr<PooledBuffer>> held(k);
+            for (size_t i = 0; i < n; ++i) {
+                auto& slot = held[i % k];
+                if (slot) LockedBufPool::release(std::move(slot));
+                slot = LockedBufPool::acquire();
+                if (slot) slot->uses++;
+            }
+            for (auto& slot : held) LockedBufPool::release(std::move(slot));
+        });
+        double lock_free = run_pool_churn(threads, iterations, hold, [](size_t n, size_t k) {
+            std::vector<pooled_ptr<PooledBuffer>> held(k);
+            for (size_t i = 0; i < n; ++i) {
+                auto& slot = held[i % k];
+                slot.reset();
+                slot = BufPool::acquire();
+                if (slot) slot->uses++;
+            }
+        });
+        std::cout << threads << "\t" << locked << "\t\t" << lock_free << "\n";
+    }
+    std::cout << "PooledBuffer创建总数: " << BufPool::total_created() << " (上限 " << BufPool::max_size << ")\n";
+    std::cout << "注：热路径只访问线程本地弹匣，线程数超过核数时mutex池的锁竞争和线程切换开销更明显\n";
+    
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++17 内联变量深度解析\n";
@@ -395,13 +769,14 @@ int main() {
     demonstrate_static_member_initialization();
     demonstrate_compiler_implementation();
     demonstrate_performance_optimization();
+    demonstrate_concurrent_resource_pool();
     
     return 0;
 }
 
 /*
 编译和运行建议:
-g++ -std=c++17 -O2 -Wall 06_inline_variables.cpp -o inline_variables
+g++ -std=c++17 -O2 -Wall -pthread 06_inline_variables.cpp -o inline_variables
 ./inline_variables
 
 关键学习点:
@@ -410,6 +785,7 @@ g++ -std=c++17 -O2 -Wall 06_inline_variables.cpp -o inline_variables
 3. 静态成员可以在类内直接初始化，简化了代码结构
 4. 编译器通过符号合并确保内联变量的唯一性
 5. 相比传统方法，内联变量提供了更好的性能和内存效率
+6. static inline thread_local成员让每个类型、每个线程拥有独立缓存，热路径无需同步
 
 注意事项:
 - 内联变量在所有翻译单元中必须有相同的定义
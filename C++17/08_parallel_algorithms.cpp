@@ -7,6 +7,9 @@
  * 3. SIMD向量化优化 - 单指令多数据的性能提升
  * 4. 内存访问模式 - 缓存友好的并行数据处理
  * 5. 性能测试与调优 - 不同负载下的最优策略选择
+ * 6. 自定义并行后端 - 工作窃取线程池上的for_each/transform/reduce/sort/inclusive_scan
+ * 7. 基数排序与单遍扫描 - 大规模整数键的LSD基数排序和decoupled look-back前缀和
+ * 8. 数组结构体(SoA) - soa_vector按字段分列存储，带代理引用和zip迭代器
  */
 
 #include <iostream>
@@ -19,6 +22,32 @@
 #include <thread>
 #include <cmath>
 #include <functional>
+#include <future>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <iomanip>
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <new>
+#include <iterator>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "../common/micro_bench.h"
 
 // ===== 1. 执行策略体系演示 =====
 // 不同执行策略的性能特征展示
@@ -482,46 +511,45 @@ public:
         return sum;
     }
     
+    // 每种策略重复运行几次取中位数；单次运行会把线程池启动、缺页和升频都算进第一个策略
     template<typename ExecutionPolicy>
-    static auto benchmark_workload(ExecutionPolicy&& policy,
-                                  WorkloadType workload,
-                                  const std::string& policy_name) {
-        const size_t data_size = 100000;
+    static double benchmark_workload(ExecutionPolicy&& policy,
+                                     WorkloadType workload,
+                                     const std::string& policy_name) {
+        const size_t data_size = 10000;
         std::vector<int> data(data_size);
         std::iota(data.begin(), data.end(), 1);
+        std::vector<double> results(data.size());
         
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        switch (workload) {
-            case WorkloadType::CPU_INTENSIVE: {
-                std::vector<double> results(data.size());
-                std::transform(policy, data.begin(), data.end(), results.begin(),
-                    [](int x) { return cpu_intensive_work(1000); });
-                break;
-            }
-            case WorkloadType::MEMORY_INTENSIVE: {
-                std::vector<int> results(data.size());
-                std::transform(policy, data.begin(), data.end(), results.begin(),
-                    [&data](int x) { return memory_intensive_work(data, x % 100 + 1); });
-                break;
-            }
-            case WorkloadType::BALANCED: {
-                std::vector<double> results(data.size());
-                std::transform(policy, data.begin(), data.end(), results.begin(),
-                    [&data](int x) {
-                        double cpu_result = cpu_intensive_work(100);
-                        int mem_result = memory_intensive_work(data, x % 10 + 1);
-                        return cpu_result + mem_result;
-                    });
-                break;
+        auto run_once = [&]() {
+            switch (workload) {
+                case WorkloadType::CPU_INTENSIVE: {
+                    std::transform(policy, data.begin(), data.end(), results.begin(),
+                        [](int) { return cpu_intensive_work(1000); });
+                    break;
+                }
+                case WorkloadType::MEMORY_INTENSIVE: {
+                    std::transform(policy, data.begin(), data.end(), results.begin(),
+                        [&data](int x) { return memory_intensive_work(data, x % 100 + 1); });
+                    break;
+                }
+                case WorkloadType::BALANCED: {
+                    std::transform(policy, data.begin(), data.end(), results.begin(),
+                        [&data](int x) {
+                            double cpu_result = cpu_intensive_work(100);
+                            int mem_result = memory_intensive_work(data, x % 10 + 1);
+                            return cpu_result + mem_result;
+                        });
+                    break;
+                }
             }
-        }
+            micro_bench::do_not_optimize(results.data());
+            micro_bench::clobber_memory();
+        };
         
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        
-        std::cout << policy_name << ": " << duration.count() << "ms\n";
-        return duration.count();
+        const auto result = micro_bench::measure(policy_name, run_once, data_size, micro_bench::heavy_config(5));
+        micro_bench::print_result(std::cout, result);
+        return result.median_ns;
     }
     
     static void compare_execution_policies(WorkloadType workload, const std::string& workload_name) {
@@ -532,9 +560,9 @@ public:
         auto unseq_time = benchmark_workload(std::execution::unseq, workload, "向量化");
         auto par_unseq_time = benchmark_workload(std::execution::par_unseq, workload, "并行+向量化");
         
-        std::cout << "并行加速比: " << (seq_time / (double)par_time) << "x\n";
-        std::cout << "向量化加速比: " << (seq_time / (double)unseq_time) << "x\n";
-        std::cout << "并行+向量化加速比: " << (seq_time / (double)par_unseq_time) << "x\n\n";
+        std::cout << "并行加速比: " << (seq_time / par_time) << "x\n";
+        std::cout << "向量化加速比: " << (seq_time / unseq_time) << "x\n";
+        std::cout << "并行+向量化加速比: " << (seq_time / par_unseq_time) << "x\n\n";
     }
 };
 
@@ -565,8 +593,1151 @@ void demonstrate_performance_tuning() {
     std::cout << "\n";
 }
 
+// ===== 6. 自定义并行算法后端：工作窃取线程池 =====
+// libstdc++的std::execution::par依赖TBB，MSVC的实现无法调节；这里基于工作窃取线程池
+// 实现for_each/transform/reduce/sort/inclusive_scan，粒度、线程数和线程绑定都可控制
+namespace parallel {
+
+// 按NUMA节点顺序列出可用CPU：紧凑绑定时先填满节点0，协作的线程共享同一块本地内存
+inline std::vector<int> numa_cpu_order() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    for (int node = 0;; ++node) {
+        std::ifstream list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!list) break;
+        // 格式如 "0-3,8-11"
+        std::string range;
+        while (std::getline(list, range, ',')) {
+            int lo = 0, hi = 0;
+            char dash = 0;
+            std::istringstream in(range);
+            in >> lo;
+            hi = (in >> dash >> hi) ? hi : lo;
+            for (int cpu = lo; cpu <= hi; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+            }
+        }
+    }
+    if (cpus.empty()) {  // 没有NUMA信息时按亲和性掩码顺序
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+class WorkStealingPool {
+public:
+    struct Options {
+        size_t threads = 0;        // 参与计算的线程总数（含调用线程），0表示hardware_concurrency
+        bool pin_threads = false;  // 按numa_cpu_order()把工作线程绑定到固定CPU
+    };
+    
+private:
+    // 一次fork_join调用：chunks个块，全部执行完时remaining归零
+    struct Job {
+        void (*run)(const void* ctx, size_t chunk);
+        const void* ctx;
+        std::atomic<size_t> remaining;
+    };
+    
+    // 待执行的块区间[lo, hi)；执行时再二分，一半留给窃取者
+    struct Task {
+        Job* job;
+        size_t lo, hi;
+    };
+    
+    struct alignas(64) Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+    
+    size_t participants_;
+    std::vector<std::unique_ptr<Queue>> queues_;  // 每个工作线程一个，最后一个给外部调用线程
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleep_mtx_;
+    std::condition_variable sleep_cv_;
+    
+    // 当前线程所属的线程池和队列下标
+    struct WorkerSlot {
+        const WorkStealingPool* pool = nullptr;
+        size_t index = 0;
+    };
+    
+    static WorkerSlot& current_slot() {
+        static thread_local WorkerSlot slot;
+        return slot;
+    }
+    
+    // 本池的工作线程用自己的队列，其他线程共用外部队列
+    size_t local_queue() const {
+        const WorkerSlot& slot = current_slot();
+        return slot.pool == this ? slot.index : queues_.size() - 1;
+    }
+    
+    void push(size_t q, Task task) {
+        {
+            std::lock_guard<std::mutex> lock(queues_[q]->mtx);
+            queues_[q]->tasks.push_back(task);
+            queued_.fetch_add(1, std::memory_order_release);
+        }
+        if (!workers_.empty()) {
+            { std::lock_guard<std::mutex> lock(sleep_mtx_); }  // 与等待方的谓词检查串行化，避免丢失唤醒
+            sleep_cv_.notify_one();
+        }
+    }
+    
+    // 自己的队列从尾部取（最近拆出、缓存最热），窃取时从其他队列头部取（区间最大）
+    bool try_pop(size_t self, Task& task) {
+        if (queued_.load(std::memory_order_acquire) == 0) return false;
+        {
+            auto& q = *queues_[self];
+            std::lock_guard<std::mutex> lock(q.mtx);
+            if (!q.tasks.empty()) {
+                task = q.tasks.back();
+                q.tasks.pop_back();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues_.size(); ++k) {
+            auto& q = *queues_[(self + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(q.mtx);
+            if (!q.tasks.empty()) {
+                task = q.tasks.front();
+                q.tasks.pop_front();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // 惰性二分：不断把右半区间压入本地队列，自己执行最左边的块
+    void execute(size_t self, Task task) {
+        while (task.hi - task.lo > 1) {
+            size_t mid = task.lo + (task.hi - task.lo) / 2;
+            push(self, Task{task.job, mid, task.hi});
+            task.hi = mid;
+        }
+        task.job->run(task.job->ctx, task.lo);
+        task.job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    
+    void worker_loop(size_t index) {
+        current_slot() = WorkerSlot{this, index};
+        Task task;
+        while (!stopping_.load(std::memory_order_acquire)) {
+            if (try_pop(index, task)) {
+                execute(index, task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mtx_);
+            sleep_cv_.wait(lock, [this] {
+                return stopping_.load(std::memory_order_acquire) || queued_.load(std::memory_order_acquire) > 0;
+            });
+        }
+    }
+    
+public:
+    WorkStealingPool() : WorkStealingPool(Options{}) {}
+    
+    explicit WorkStealingPool(Options options)
+        : participants_(options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency())) {
+        const size_t num_workers = participants_ - 1;  // 调用线程也参与计算
+        for (size_t i = 0; i <= num_workers; ++i) queues_.push_back(std::make_unique<Queue>());
+        std::vector<int> cpus = options.pin_threads ? numa_cpu_order() : std::vector<int>{};
+        for (size_t i = 0; i < num_workers; ++i) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+#ifdef __linux__
+            if (!cpus.empty()) {
+                // 调用线程通常在第一个CPU上，工作线程从第二个开始依次绑定
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpus[(i + 1) % cpus.size()], &set);
+                pthread_setaffinity_np(workers_.back().native_handle(), sizeof(set), &set);
+            }
+#endif
+        }
+    }
+    
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mtx_);
+            stopping_.store(true, std::memory_order_release);
+        }
+        sleep_cv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    size_t size() const { return participants_; }
+    
+    // 并行执行body(0..chunks-1)并等待全部完成；等待期间调用线程也去执行/窃取任务，
+    // 因此在body内部再次调用fork_join不会死锁
+    template<typename Body>
+    void fork_join(size_t chunks, const Body& body) {
+        if (chunks == 0) return;
+        if (chunks == 1 || workers_.empty()) {
+            for (size_t c = 0; c < chunks; ++c) body(c);
+            return;
+        }
+        Job job{[](const void* ctx, size_t chunk) { (*static_cast<const Body*>(ctx))(chunk); }, &body, {chunks}};
+        size_t self = local_queue();
+        execute(self, Task{&job, 0, chunks});
+        Task task;
+        while (job.remaining.load(std::memory_order_acquire) > 0) {
+            if (try_pop(self, task)) {
+                execute(self, task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    static WorkStealingPool& default_pool() {
+        static WorkStealingPool pool;
+        return pool;
+    }
+};
+
+// 执行策略：低于serial_threshold个元素时直接串行，grain为每个任务块的元素数（0表示自动）
+struct ParallelPolicy {
+    WorkStealingPool* pool = nullptr;
+    size_t grain = 0;
+    size_t serial_threshold = 4096;
+    
+    ParallelPolicy on(WorkStealingPool& p) const { auto copy = *this; copy.pool = &p; return copy; }
+    ParallelPolicy with_grain(size_t g) const { auto copy = *this; copy.grain = g; return copy; }
+    ParallelPolicy with_threshold(size_t t) const { auto copy = *this; copy.serial_threshold = t; return copy; }
+    
+    WorkStealingPool& executor() const { return pool ? *pool : WorkStealingPool::default_pool(); }
+    
+    // 自动粒度：每个线程约4块，足够让窃取平衡负载，又不至于调度开销过大
+    size_t chunks_for(size_t n) const {
+        if (n == 0 || n < serial_threshold || executor().size() == 1) return 1;
+        size_t g = grain ? grain : std::max<size_t>(1, n / (executor().size() * 4));
+        return std::min((n + g - 1) / g, n);
+    }
+};
+
+inline constexpr ParallelPolicy par{};
+
+// 标准执行策略映射到本后端：seq串行，其余使用默认线程池
+template<typename Policy>
+ParallelPolicy to_parallel_policy(const Policy&) {
+    if constexpr (std::is_same_v<Policy, std::execution::sequenced_policy>) {
+        return ParallelPolicy{}.with_threshold(static_cast<size_t>(-1));
+    } else {
+        return ParallelPolicy{};
+    }
+}
+
+inline const ParallelPolicy& to_parallel_policy(const ParallelPolicy& policy) { return policy; }
+
+template<typename Policy>
+inline constexpr bool is_policy_v =
+    std::is_same_v<std::decay_t<Policy>, ParallelPolicy> || std::is_execution_policy_v<std::decay_t<Policy>>;
+
+// 把[0, n)按块切分，body(begin, end)处理一块
+template<typename Body>
+void for_chunks(const ParallelPolicy& policy, size_t n, const Body& body) {
+    size_t chunks = policy.chunks_for(n);
+    policy.executor().fork_join(chunks, [&](size_t c) { body(n * c / chunks, n * (c + 1) / chunks); });
+}
+
+template<typename Policy, typename It, typename F, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+void for_each(Policy&& policy, It first, It last, F f) {
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+                                    typename std::iterator_traits<It>::iterator_category>, "需要随机访问迭代器");
+    for_chunks(to_parallel_policy(policy), static_cast<size_t>(last - first), [&](size_t lo, size_t hi) {
+        std::for_each(first + lo, first + hi, f);
+    });
+}
+
+template<typename Policy, typename It, typename Out, typename F, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+Out transform(Policy&& policy, It first, It last, Out out, F f) {
+    const size_t n = static_cast<size_t>(last - first);
+    for_chunks(to_parallel_policy(policy), n, [&](size_t lo, size_t hi) {
+        std::transform(first + lo, first + hi, out + lo, f);
+    });
+    return out + n;
+}
+
+// 每块的部分和按块顺序合并：块划分只取决于n和粒度，浮点结果可复现
+template<typename Policy, typename It, typename T, typename Op, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+T reduce(Policy&& policy, It first, It last, T init, Op op) {
+    const auto& p = to_parallel_policy(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = p.chunks_for(n);
+    if (chunks == 1) return std::accumulate(first, last, init, op);
+    std::vector<std::optional<T>> partial(chunks);
+    p.executor().fork_join(chunks, [&](size_t c) {
+        It lo = first + n * c / chunks, hi = first + n * (c + 1) / chunks;
+        T acc = *lo;
+        for (++lo; lo != hi; ++lo) acc = op(std::move(acc), *lo);
+        partial[c] = std::move(acc);
+    });
+    for (auto& v : partial) init = op(std::move(init), std::move(*v));
+    return init;
+}
+
+template<typename Policy, typename It, typename T, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+T reduce(Policy&& policy, It first, It last, T init) {
+    return parallel::reduce(std::forward<Policy>(policy), first, last, std::move(init), std::plus<>{});
+}
+
+// 三遍扫描：各块求和 -> 串行求块前缀 -> 各块带偏移扫描。op需满足结合律
+template<typename Policy, typename It, typename Out, typename Op, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+Out inclusive_scan(Policy&& policy, It first, It last, Out out, Op op) {
+    using T = typename std::iterator_traits<It>::value_type;
+    const auto& p = to_parallel_policy(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = p.chunks_for(n);
+    if (chunks == 1) return std::inclusive_scan(first, last, out, op);
+    std::vector<T> sums(chunks);
+    p.executor().fork_join(chunks, [&](size_t c) {
+        It lo = first + n * c / chunks, hi = first + n * (c + 1) / chunks;
+        sums[c] = parallel::reduce(ParallelPolicy{}.with_threshold(static_cast<size_t>(-1)), lo + 1, hi, *lo, op);
+    });
+    for (size_t c = 1; c < chunks; ++c) sums[c] = op(sums[c - 1], sums[c]);
+    p.executor().fork_join(chunks, [&](size_t c) {
+        size_t lo = n * c / chunks, hi = n * (c + 1) / chunks;
+        if (c == 0) {
+            std::inclusive_scan(first + lo, first + hi, out + lo, op);
+        } else {
+            std::inclusive_scan(first + lo, first + hi, out + lo, op, sums[c - 1]);
+        }
+    });
+    return out + n;
+}
+
+template<typename Policy, typename It, typename Out, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+Out inclusive_scan(Policy&& policy, It first, It last, Out out) {
+    return parallel::inclusive_scan(std::forward<Policy>(policy), first, last, out, std::plus<>{});
+}
+
+// 各块并行std::sort，然后逐轮两两合并（每轮各对之间并行），在原数组和缓冲区之间交替
+template<typename Policy, typename It, typename Compare, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+void sort(Policy&& policy, It first, It last, Compare comp) {
+    using T = typename std::iterator_traits<It>::value_type;
+    const auto& p = to_parallel_policy(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    const size_t chunks = p.chunks_for(n);
+    if (chunks == 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+    std::vector<size_t> bounds(chunks + 1);
+    for (size_t c = 0; c <= chunks; ++c) bounds[c] = n * c / chunks;
+    p.executor().fork_join(chunks, [&](size_t c) { std::sort(first + bounds[c], first + bounds[c + 1], comp); });
+    
+    std::vector<T> buffer(n);
+    bool in_buffer = false;
+    for (size_t width = 1; width < chunks; width *= 2) {
+        const size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+        p.executor().fork_join(pairs, [&](size_t k) {
+            size_t lo = bounds[2 * k * width];
+            size_t mid = bounds[std::min(2 * k * width + width, chunks)];
+            size_t hi = bounds[std::min(2 * k * width + 2 * width, chunks)];
+            if (in_buffer) {
+                std::merge(std::make_move_iterator(buffer.begin() + lo), std::make_move_iterator(buffer.begin() + mid),
+                           std::make_move_iterator(buffer.begin() + mid), std::make_move_iterator(buffer.begin() + hi),
+                           first + lo, comp);
+            } else {
+                std::merge(std::make_move_iterator(first + lo), std::make_move_iterator(first + mid),
+                           std::make_move_iterator(first + mid), std::make_move_iterator(first + hi),
+                           buffer.begin() + lo, comp);
+            }
+        });
+        in_buffer = !in_buffer;
+    }
+    if (in_buffer) std::move(buffer.begin(), buffer.end(), first);
+}
+
+template<typename Policy, typename It, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+void sort(Policy&& policy, It first, It last) {
+    parallel::sort(std::forward<Policy>(policy), first, last, std::less<>{});
+}
+
+}  // namespace parallel
+
+void demonstrate_custom_parallel_backend() {
+    std::cout << "=== 自定义并行算法后端演示 ===\n";
+    
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    parallel::WorkStealingPool pinned({hw, true});
+    std::cout << "线程池: " << parallel::WorkStealingPool::default_pool().size() << " 个线程(含调用线程)，"
+              << "NUMA顺序CPU: " << parallel::numa_cpu_order().size() << " 个\n";
+    std::cout << "各列耗时(ms)，std::par/par_unseq由标准库实现(libstdc++下为TBB)\n\n";
+    
+    // 数据集与前面的演示一致
+    std::vector<int> small(100000);
+    std::iota(small.begin(), small.end(), 1);
+    std::vector<int> random(1000000);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> dis(1, 1000);
+    std::generate(random.begin(), random.end(), [&]() { return dis(gen); });
+    
+    auto time_ms = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+    
+    auto row = [](const char* name, double seq, double std_par, double std_par_unseq, double ours, double ours_pinned,
+                  bool ok) {
+        std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(9) << seq << std::setw(9) << std_par << std::setw(12) << std_par_unseq
+                  << std::setw(10) << ours << std::setw(10) << ours_pinned << "  " << (ok ? "一致" : "不一致") << "\n";
+    };
+    std::cout << std::left << std::setw(26) << "算法" << std::right << std::setw(9) << "seq" << std::setw(9) << "std::par"
+              << std::setw(12) << "par_unseq" << std::setw(10) << "parallel" << std::setw(10) << "绑核" << "\n";
+    
+    // transform：计算密集型，ExecutionPolicyDemo的数据集
+    {
+        std::vector<double> a(small.size()), b(small.size()), c(small.size()), d(small.size()), e(small.size());
+        auto f = ExecutionPolicyDemo::expensive_computation;
+        double t1 = time_ms([&] { std::transform(std::execution::seq, small.begin(), small.end(), a.begin(), f); });
+        double t2 = time_ms([&] { std::transform(std::execution::par, small.begin(), small.end(), b.begin(), f); });
+        double t3 = time_ms([&] { std::transform(std::execution::par_unseq, small.begin(), small.end(), c.begin(), f); });
+        double t4 = time_ms([&] { parallel::transform(parallel::par, small.begin(), small.end(), d.begin(), f); });
+        double t5 = time_ms([&] { parallel::transform(parallel::par.on(pinned), small.begin(), small.end(), e.begin(), f); });
+        row("transform(100K, 计算密集)", t1, t2, t3, t4, t5, a == b && a == d && a == e);
+    }
+    
+    // for_each：简单操作，负载很轻，粒度决定调度开销
+    {
+        std::vector<int> a = random, b = random, c = random, d = random, e = random;
+        auto f = [](int& x) { x = ExecutionPolicyDemo::simple_computation(x); };
+        double t1 = time_ms([&] { std::for_each(std::execution::seq, a.begin(), a.end(), f); });
+        double t2 = time_ms([&] { std::for_each(std::execution::par, b.begin(), b.end(), f); });
+        double t3 = time_ms([&] { std::for_each(std::execution::par_unseq, c.begin(), c.end(), f); });
+        double t4 = time_ms([&] { parallel::for_each(parallel::par, d.begin(), d.end(), f); });
+        double t5 = time_ms([&] { parallel::for_each(parallel::par.on(pinned).with_grain(1 << 16), e.begin(), e.end(), f); });
+        row("for_each(1M, 简单运算)", t1, t2, t3, t4, t5, a == b && a == d && a == e);
+    }
+    
+    // reduce：并行算法原理演示中的1M随机整数
+    {
+        long long r1 = 0, r2 = 0, r3 = 0, r4 = 0, r5 = 0;
+        double t1 = time_ms([&] { r1 = std::reduce(std::execution::seq, random.begin(), random.end(), 0LL); });
+        double t2 = time_ms([&] { r2 = std::reduce(std::execution::par, random.begin(), random.end(), 0LL); });
+        double t3 = time_ms([&] { r3 = std::reduce(std::execution::par_unseq, random.begin(), random.end(), 0LL); });
+        double t4 = time_ms([&] { r4 = parallel::reduce(parallel::par, random.begin(), random.end(), 0LL); });
+        double t5 = time_ms([&] { r5 = parallel::reduce(parallel::par.on(pinned), random.begin(), random.end(), 0LL); });
+        row("reduce(1M)", t1, t2, t3, t4, t5, r1 == r2 && r1 == r3 && r1 == r4 && r1 == r5);
+    }
+    
+    // inclusive_scan
+    {
+        std::vector<long long> a(random.size()), b(random.size()), c(random.size()), d(random.size()), e(random.size());
+        double t1 = time_ms([&] { std::inclusive_scan(std::execution::seq, random.begin(), random.end(), a.begin(), std::plus<long long>{}); });
+        double t2 = time_ms([&] { std::inclusive_scan(std::execution::par, random.begin(), random.end(), b.begin(), std::plus<long long>{}); });
+        double t3 = time_ms([&] { std::inclusive_scan(std::execution::par_unseq, random.begin(), random.end(), c.begin(), std::plus<long long>{}); });
+        double t4 = time_ms([&] { parallel::inclusive_scan(parallel::par, random.begin(), random.end(), d.begin(), std::plus<long long>{}); });
+        double t5 = time_ms([&] { parallel::inclusive_scan(parallel::par.on(pinned), random.begin(), random.end(), e.begin(), std::plus<long long>{}); });
+        row("inclusive_scan(1M)", t1, t2, t3, t4, t5, a == b && a == d && a == e);
+    }
+    
+    // sort
+    {
+        std::vector<int> a = random, b = random, c = random, d = random, e = random;
+        double t1 = time_ms([&] { std::sort(std::execution::seq, a.begin(), a.end()); });
+        double t2 = time_ms([&] { std::sort(std::execution::par, b.begin(), b.end()); });
+        double t3 = time_ms([&] { std::sort(std::execution::par_unseq, c.begin(), c.end()); });
+        double t4 = time_ms([&] { parallel::sort(parallel::par, d.begin(), d.end()); });
+        double t5 = time_ms([&] { parallel::sort(parallel::par.on(pinned), e.begin(), e.end()); });
+        row("sort(1M)", t1, t2, t3, t4, t5, a == b && a == d && a == e);
+    }
+    
+    // 小数据：低于阈值时直接串行，不付出任何调度开销
+    {
+        std::vector<int> tiny(1000, 1);
+        long long r = 0;
+        double t_default = time_ms([&] { for (int i = 0; i < 1000; ++i) r += parallel::reduce(parallel::par, tiny.begin(), tiny.end(), 0LL); });
+        double t_forced = time_ms([&] {
+            for (int i = 0; i < 1000; ++i) r += parallel::reduce(parallel::par.with_threshold(0).with_grain(64), tiny.begin(), tiny.end(), 0LL);
+        });
+        std::cout << "\n1000次reduce(1000元素): 默认阈值(串行) " << t_default << "ms, 强制并行(粒度64) " << t_forced
+                  << "ms (r=" << r << ")\n";
+    }
+    
+    // 标准执行策略也可以直接传给本后端
+    std::vector<int> v(random.begin(), random.begin() + 10000);
+    parallel::sort(std::execution::par, v.begin(), v.end());
+    std::cout << "parallel::sort(std::execution::par, ...) 有序: " << (std::is_sorted(v.begin(), v.end()) ? "是" : "否") << "\n";
+    std::cout << std::defaultfloat;
+    
+    std::cout << "\n";
+}
+
+// ===== 7. 大规模整数数据：并行基数排序与单遍扫描 =====
+// 比较排序是O(n log n)且分支难以预测；整数键用LSD基数排序，每趟只做一次读和一次按桶散列写
+namespace parallel {
+
+namespace detail {
+
+// 有符号整数翻转符号位后，按无符号比较的顺序与原顺序一致
+template<typename T>
+auto radix_key(T value) {
+    using U = std::make_unsigned_t<T>;
+    if constexpr (std::is_signed_v<T>) {
+        return static_cast<U>(static_cast<U>(value) ^ (U(1) << (sizeof(T) * 8 - 1)));
+    } else {
+        return static_cast<U>(value);
+    }
+}
+
+// C++17没有contiguous_iterator概念：只把指针和std::vector的迭代器当作连续存储
+// （vector<bool>不是连续存储），其余随机访问迭代器（如std::deque）先拷进缓冲区排序
+template<typename It, typename T = typename std::iterator_traits<It>::value_type>
+inline constexpr bool is_known_contiguous_v =
+    std::is_pointer_v<It> ||
+    (!std::is_same_v<T, bool> && std::is_same_v<It, typename std::vector<T>::iterator>);
+
+// LSD基数排序：每趟8位，共sizeof(T)趟
+// 1. 各块统计本块256个桶的直方图（线程私有，无共享写）
+// 2. 串行求出"块c的桶b"在输出中的起始位置：所有块中更小的桶 + 前面块中的同一个桶
+// 3. 各块按原顺序散列到目标位置，保持稳定性
+// 某一位在所有键上都相同时（例如小于2^24的32位键的最高字节）整趟跳过
+// 调用方保证n >= 2且data指向n个连续元素
+template<typename T>
+void radix_sort_contiguous(const ParallelPolicy& p, T* data, size_t n) {
+    constexpr size_t kBuckets = 256;
+    
+    if (n < p.serial_threshold && p.serial_threshold != static_cast<size_t>(-1)) {
+        std::sort(data, data + n);  // 小数据直接比较排序，省掉缓冲区和直方图
+        return;
+    }
+    const size_t chunks = p.chunks_for(n);
+    
+    std::vector<T> buffer(n);
+    T* src = data;
+    T* dst = buffer.data();
+    std::vector<std::array<size_t, kBuckets>> offsets(chunks);
+    
+    for (size_t shift = 0; shift < sizeof(T) * 8; shift += 8) {
+        auto digit = [shift](T v) { return static_cast<size_t>((detail::radix_key(v) >> shift) & (kBuckets - 1)); };
+        
+        p.executor().fork_join(chunks, [&](size_t c) {
+            auto& hist = offsets[c];
+            hist.fill(0);
+            for (size_t i = n * c / chunks, end = n * (c + 1) / chunks; i < end; ++i) ++hist[digit(src[i])];
+        });
+        
+        // 只有一个非空桶：本趟不改变顺序
+        size_t total_first = 0;
+        for (size_t c = 0; c < chunks; ++c) total_first += offsets[c][digit(src[0])];
+        if (total_first == n) continue;
+        
+        size_t running = 0;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            for (size_t c = 0; c < chunks; ++c) {
+                size_t count = offsets[c][b];
+                offsets[c][b] = running;
+                running += count;
+            }
+        }
+        
+        p.executor().fork_join(chunks, [&](size_t c) {
+            auto& pos = offsets[c];
+            for (size_t i = n * c / chunks, end = n * (c + 1) / chunks; i < end; ++i) {
+                dst[pos[digit(src[i])]++] = src[i];
+            }
+        });
+        std::swap(src, dst);
+    }
+    if (src != data) std::copy(src, src + n, data);
+}
+
+}  // namespace detail
+
+template<typename Policy, typename It, std::enable_if_t<is_policy_v<Policy>, int> = 0>
+void radix_sort(Policy&& policy, It first, It last) {
+    using T = typename std::iterator_traits<It>::value_type;
+    static_assert(std::is_integral_v<T>, "radix_sort只支持整数键");
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+                                    typename std::iterator_traits<It>::iterator_category>,
+                  "radix_sort需要随机访问迭代器");
+    
+    const auto& p = to_parallel_policy(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    if (n < 2) return;
+    if constexpr (detail::is_known_contiguous_v<It>) {
+        detail::radix_sort_contiguous(p, std::addressof(*first), n);
+    } else {
+        std::vector<T> work(first, last);
+        detail::radix_sort_contiguous(p, work.data(), n);
+        std::copy(work.begin(), work.end(), first);
+    }
+}
+
+// 单遍并行扫描（decoupled look-back）：数据按tile依次领取，每个tile
+// 1. 求本tile的和并发布为AGGREGATE
+// 2. 向前查看前驱tile：遇到INCLUSIVE就停止，遇到AGGREGATE就累加后继续向前
+// 3. 发布本tile的INCLUSIVE前缀，然后带着前缀扫描写出
+// tile按领取顺序编号，前驱一定已被某个正在运行的线程领取，等待必然结束；
+// tile小到能留在L2中，第二次读取不再访问内存，总流量约为一读一写（三遍扫描是两读一写）
+template<typename Policy, typename It, typename Out, typename T, typename Op>
+Out lookback_scan(Policy&& policy, It first, It last, Out out, T init, Op op, bool exclusive) {
+    static_assert(std::is_trivially_copyable_v<T>, "look-back状态需要按值发布");
+    const auto& p = to_parallel_policy(policy);
+    const size_t n = static_cast<size_t>(last - first);
+    
+    auto scan_tile = [&](size_t lo, size_t hi, T prefix) {
+        for (size_t i = lo; i < hi; ++i) {
+            T value = first[i];
+            if (exclusive) {
+                out[i] = prefix;
+                prefix = op(prefix, value);
+            } else {
+                prefix = op(prefix, value);
+                out[i] = prefix;
+            }
+        }
+    };
+    if (p.chunks_for(n) == 1) {
+        scan_tile(0, n, init);
+        return out + n;
+    }
+    
+    const size_t tile = p.grain ? p.grain : size_t{1} << 14;
+    const size_t tiles = (n + tile - 1) / tile;
+    
+    enum : int { kEmpty = 0, kAggregate = 1, kInclusive = 2 };
+    struct alignas(64) TileState {
+        std::atomic<int> flag{kEmpty};
+        T aggregate;
+        T inclusive;
+    };
+    std::unique_ptr<TileState[]> state(new TileState[tiles]);
+    std::atomic<size_t> next_tile{0};
+    
+    p.executor().fork_join(p.executor().size(), [&](size_t) {
+        for (size_t t; (t = next_tile.fetch_add(1, std::memory_order_relaxed)) < tiles;) {
+            const size_t lo = t * tile, hi = std::min(n, lo + tile);
+            T aggregate = first[lo];
+            for (size_t i = lo + 1; i < hi; ++i) aggregate = op(aggregate, first[i]);
+            
+            T prefix = init;
+            if (t == 0) {
+                state[0].inclusive = op(init, aggregate);
+                state[0].flag.store(kInclusive, std::memory_order_release);
+            } else {
+                state[t].aggregate = aggregate;
+                state[t].flag.store(kAggregate, std::memory_order_release);
+                
+                // 从近到远累加前驱的和：exclusive = agg[j] op ... op agg[t-1]
+                bool have = false;
+                T behind{};
+                for (size_t j = t; j-- > 0;) {
+                    int flag;
+                    while ((flag = state[j].flag.load(std::memory_order_acquire)) == kEmpty) {
+                        std::this_thread::yield();
+                    }
+                    T value = flag == kInclusive ? state[j].inclusive : state[j].aggregate;
+                    behind = have ? op(value, behind) : value;
+                    have = true;
+                    if (flag == kInclusive) break;
+                }
+                prefix = behind;
+                state[t].inclusive = op(prefix, aggregate);
+                state[t].flag.store(kInclusive, std::memory_order_release);
+            }
+            scan_tile(lo, hi, prefix);
+        }
+    });
+    return out + n;
+}
+
+template<typename Policy, typename It, typename Out, typename Op = std::plus<>,
+         std::enable_if_t<is_policy_v<Policy>, int> = 0>
+Out inclusive_scan_lookback(Policy&& policy, It first, It last, Out out, Op op = {}) {
+    using T = typename std::iterator_traits<It>::value_type;
+    if (first == last) return out;
+    // 以第一个元素为初值，其余元素照常扫描
+    *out = *first;
+    return lookback_scan(std::forward<Policy>(policy), first + 1, last, out + 1, static_cast<T>(*first), op, false);
+}
+
+template<typename Policy, typename It, typename Out, typename T, typename Op = std::plus<>,
+         std::enable_if_t<is_policy_v<Policy>, int> = 0>
+Out exclusive_scan_lookback(Policy&& policy, It first, It last, Out out, T init, Op op = {}) {
+    return lookback_scan(std::forward<Policy>(policy), first, last, out, init, op, true);
+}
+
+}  // namespace parallel
+
+void demonstrate_radix_sort_and_scan() {
+    std::cout << "=== 并行基数排序与单遍扫描演示 ===\n";
+    
+    const size_t n = 16'000'000;
+    std::cout << "数据: " << n << " 个随机键，线程数 " << parallel::WorkStealingPool::default_pool().size() << "\n\n";
+    
+    auto time_ms = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+    std::cout << std::fixed << std::setprecision(1);
+    
+    auto sort_benchmark = [&](auto tag, const char* name) {
+        using T = decltype(tag);
+        std::mt19937_64 gen(7);
+        std::vector<T> keys(n);
+        for (auto& k : keys) k = static_cast<T>(gen());
+        
+        auto a = keys, b = keys, c = keys, d = keys;
+        double t_seq = time_ms([&] { std::sort(a.begin(), a.end()); });
+        double t_par = time_ms([&] { std::sort(std::execution::par, b.begin(), b.end()); });
+        double t_merge = time_ms([&] { parallel::sort(parallel::par, c.begin(), c.end()); });
+        double t_radix = time_ms([&] { parallel::radix_sort(parallel::par, d.begin(), d.end()); });
+        std::cout << name << " 排序:\n";
+        std::cout << "  std::sort               " << std::setw(8) << t_seq << " ms\n";
+        std::cout << "  std::sort(par)          " << std::setw(8) << t_par << " ms\n";
+        std::cout << "  parallel::sort          " << std::setw(8) << t_merge << " ms\n";
+        std::cout << "  parallel::radix_sort    " << std::setw(8) << t_radix << " ms ("
+                  << std::setprecision(2) << t_par / t_radix << std::setprecision(1) << "x vs std::sort(par))"
+                  << "，结果一致: " << (a == b && a == c && a == d ? "是" : "否") << "\n";
+    };
+    sort_benchmark(std::uint32_t{}, "uint32_t");
+    sort_benchmark(std::int64_t{}, "int64_t(含负数)");
+    
+    // 小范围键：高位字节全相同的趟被跳过
+    {
+        std::mt19937 gen(3);
+        std::vector<std::uint32_t> keys(n);
+        for (auto& k : keys) k = gen() % 100000;
+        auto a = keys, b = keys;
+        double t_par = time_ms([&] { std::sort(std::execution::par, a.begin(), a.end()); });
+        double t_radix = time_ms([&] { parallel::radix_sort(parallel::par, b.begin(), b.end()); });
+        std::cout << "uint32_t < 100000: std::sort(par) " << t_par << " ms, radix_sort " << t_radix
+                  << " ms (最高字节一趟被跳过)，结果一致: " << (a == b ? "是" : "否") << "\n\n";
+    }
+    
+    // 扫描：三遍扫描 vs 单遍look-back
+    {
+        std::mt19937 gen(11);
+        std::vector<std::int64_t> values(n);
+        for (auto& v : values) v = static_cast<std::int64_t>(gen() % 1000);
+        std::vector<std::int64_t> a(n), b(n), c(n), d(n), e(n), f(n);
+        double t_seq = time_ms([&] { std::inclusive_scan(values.begin(), values.end(), a.begin()); });
+        double t_par = time_ms([&] { std::inclusive_scan(std::execution::par, values.begin(), values.end(), b.begin()); });
+        double t_three = time_ms([&] { parallel::inclusive_scan(parallel::par, values.begin(), values.end(), c.begin()); });
+        double t_look = time_ms([&] { parallel::inclusive_scan_lookback(parallel::par, values.begin(), values.end(), d.begin()); });
+        std::exclusive_scan(values.begin(), values.end(), e.begin(), std::int64_t{0});
+        double t_excl = time_ms([&] {
+            parallel::exclusive_scan_lookback(parallel::par, values.begin(), values.end(), f.begin(), std::int64_t{0});
+        });
+        std::cout << "int64_t 前缀和:\n";
+        std::cout << "  std::inclusive_scan          " << std::setw(8) << t_seq << " ms\n";
+        std::cout << "  std::inclusive_scan(par)     " << std::setw(8) << t_par << " ms\n";
+        std::cout << "  parallel::inclusive_scan     " << std::setw(8) << t_three << " ms (三遍)\n";
+        std::cout << "  inclusive_scan_lookback      " << std::setw(8) << t_look << " ms (单遍)\n";
+        std::cout << "  exclusive_scan_lookback      " << std::setw(8) << t_excl << " ms\n";
+        std::cout << "  结果一致: " << (a == b && a == c && a == d && e == f ? "是" : "否") << "\n";
+    }
+    std::cout << std::defaultfloat;
+    
+    std::cout << "\n";
+}
+
+// ===== 8. 结构体数组(AoS)与数组结构体(SoA) =====
+// 矩阵乘法演示里b的列访问慢是因为每取一个double要搬一整行缓存行；结构体数组里只用到
+// 部分字段时同样如此。soa_vector把每个字段放进独立的对齐连续数组，只读用到的字段
+
+// 按缓存行对齐的分配器：每一列都从64字节边界开始，便于向量化加载
+template<typename T, size_t Align = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+    
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Align>; };
+    
+    T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align))); }
+    void deallocate(T* p, size_t) noexcept { ::operator delete(p, std::align_val_t(Align)); }
+    
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const noexcept { return false; }
+};
+
+template<typename... Fields>
+class soa_vector {
+public:
+    using value_type = std::tuple<Fields...>;
+    // 代理引用：对各列元素的引用打包成tuple，支持结构化绑定和整体赋值
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+    using size_type = size_t;
+    
+private:
+    template<typename T>
+    using column = std::vector<T, AlignedAllocator<T>>;
+    
+    std::tuple<column<Fields>...> columns_;
+    
+    template<size_t... I>
+    reference ref(size_t i, std::index_sequence<I...>) { return reference(std::get<I>(columns_)[i]...); }
+    template<size_t... I>
+    const_reference ref(size_t i, std::index_sequence<I...>) const {
+        return const_reference(std::get<I>(columns_)[i]...);
+    }
+    
+    template<typename F>
+    void for_each_column(F&& f) {
+        std::apply([&](auto&... cols) { (f(cols), ...); }, columns_);
+    }
+    
+public:
+    // 随机访问迭代器：只保存容器指针和下标，解引用得到代理引用，
+    // 因此可以直接交给std::for_each/transform以及前面的parallel::算法（zip迭代）
+    template<bool Const>
+    class basic_iterator {
+        using owner_type = std::conditional_t<Const, const soa_vector, soa_vector>;
+        owner_type* owner_ = nullptr;
+        std::ptrdiff_t index_ = 0;
+        
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = soa_vector::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const_reference, soa_vector::reference>;
+        using pointer = void;
+        
+        basic_iterator() = default;
+        basic_iterator(owner_type* owner, std::ptrdiff_t index) : owner_(owner), index_(index) {}
+        
+        reference operator*() const { return (*owner_)[static_cast<size_t>(index_)]; }
+        reference operator[](difference_type n) const { return (*owner_)[static_cast<size_t>(index_ + n)]; }
+        
+        basic_iterator& operator++() { ++index_; return *this; }
+        basic_iterator operator++(int) { auto tmp = *this; ++index_; return tmp; }
+        basic_iterator& operator--() { --index_; return *this; }
+        basic_iterator operator--(int) { auto tmp = *this; --index_; return tmp; }
+        basic_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        basic_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+        friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const basic_iterator& a, const basic_iterator& b) { return a.index_ - b.index_; }
+        
+        friend bool operator==(const basic_iterator& a, const basic_iterator& b) { return a.index_ == b.index_; }
+        friend bool operator!=(const basic_iterator& a, const basic_iterator& b) { return a.index_ != b.index_; }
+        friend bool operator<(const basic_iterator& a, const basic_iterator& b) { return a.index_ < b.index_; }
+        friend bool operator>(const basic_iterator& a, const basic_iterator& b) { return a.index_ > b.index_; }
+        friend bool operator<=(const basic_iterator& a, const basic_iterator& b) { return a.index_ <= b.index_; }
+        friend bool operator>=(const basic_iterator& a, const basic_iterator& b) { return a.index_ >= b.index_; }
+    };
+    
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+    
+    soa_vector() = default;
+    explicit soa_vector(size_t n) { resize(n); }
+    
+    // 从结构体数组转换：soa_vector<float, float>::from_aos(particles, &Particle::x, &Particle::y)
+    template<typename Struct, typename... Members>
+    static soa_vector from_aos(const std::vector<Struct>& aos, Members Struct::*... members) {
+        static_assert(sizeof...(Members) == sizeof...(Fields), "每个字段对应一个成员指针");
+        soa_vector result(aos.size());
+        result.from_aos_impl(aos, std::index_sequence_for<Fields...>{}, members...);
+        return result;
+    }
+    
+    // 转回结构体：to_aos<Particle>(&Particle::x, &Particle::y)
+    template<typename Struct, typename... Members>
+    std::vector<Struct> to_aos(Members Struct::*... members) const {
+        std::vector<Struct> aos(size());
+        to_aos_impl(aos, std::index_sequence_for<Fields...>{}, members...);
+        return aos;
+    }
+    
+    size_t size() const { return std::get<0>(columns_).size(); }
+    bool empty() const { return size() == 0; }
+    
+    void reserve(size_t n) { for_each_column([n](auto& col) { col.reserve(n); }); }
+    void resize(size_t n) { for_each_column([n](auto& col) { col.resize(n); }); }
+    void clear() { for_each_column([](auto& col) { col.clear(); }); }
+    
+    void push_back(const Fields&... values) {
+        std::apply([&](auto&... cols) { (cols.push_back(values), ...); }, columns_);
+    }
+    
+    reference operator[](size_t i) { return ref(i, std::index_sequence_for<Fields...>{}); }
+    const_reference operator[](size_t i) const { return ref(i, std::index_sequence_for<Fields...>{}); }
+    
+    // 第I列的连续存储，热循环里直接用指针，编译器可以按列向量化
+    template<size_t I>
+    auto* field() { return std::get<I>(columns_).data(); }
+    template<size_t I>
+    const auto* field() const { return std::get<I>(columns_).data(); }
+    
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, static_cast<std::ptrdiff_t>(size())); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, static_cast<std::ptrdiff_t>(size())); }
+    
+private:
+    template<typename Struct, size_t... I, typename... Members>
+    void from_aos_impl(const std::vector<Struct>& aos, std::index_sequence<I...>, Members Struct::*... members) {
+        for (size_t i = 0; i < aos.size(); ++i) ((std::get<I>(columns_)[i] = aos[i].*members), ...);
+    }
+    
+    template<typename Struct, size_t... I, typename... Members>
+    void to_aos_impl(std::vector<Struct>& aos, std::index_sequence<I...>, Members Struct::*... members) const {
+        for (size_t i = 0; i < aos.size(); ++i) ((aos[i].*members = std::get<I>(columns_)[i]), ...);
+    }
+};
+
+// 粒子模拟常见的布局：8个字段共32字节，一条缓存行装两个粒子
+struct Particle {
+    float x, y, z;
+    float vx, vy, vz;
+    float mass;
+    int id;
+};
+
+using ParticleSoA = soa_vector<float, float, float, float, float, float, float, int>;
+enum ParticleField : size_t { PX, PY, PZ, VX, VY, VZ, MASS, ID };
+
+// 各基准用独立的非内联函数，避免被合并进调用方后寄存器分配互相干扰
+namespace soa_kernels {
+
+// 位置积分：AoS每个粒子读写32字节，SoA只碰6列（跳过mass和id）
+[[gnu::noinline]] void integrate(std::vector<Particle>& ps, float dt) {
+    for (auto& p : ps) {
+        p.x += p.vx * dt;
+        p.y += p.vy * dt;
+        p.z += p.vz * dt;
+    }
+}
+
+[[gnu::noinline]] void integrate(ParticleSoA& ps, float dt) {
+    const size_t n = ps.size();
+    float* __restrict x = ps.field<PX>();
+    float* __restrict y = ps.field<PY>();
+    float* __restrict z = ps.field<PZ>();
+    const float* __restrict vx = ps.field<VX>();
+    const float* __restrict vy = ps.field<VY>();
+    const float* __restrict vz = ps.field<VZ>();
+    for (size_t i = 0; i < n; ++i) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        z[i] += vz[i] * dt;
+    }
+}
+
+// 过滤：选出x > threshold的粒子，返回质量和并写出下标
+// 无分支写法：无条件写下标、按条件前进；SoA只读x和mass两列，并且可以整组向量化处理
+[[gnu::noinline]] double filter(const std::vector<Particle>& ps, float threshold, std::vector<uint32_t>& out) {
+    out.resize(ps.size());
+    size_t count = 0;
+    float mass = 0.0f;
+    for (size_t i = 0; i < ps.size(); ++i) {
+        bool keep = ps[i].x > threshold;
+        out[count] = static_cast<uint32_t>(i);
+        count += keep;
+        mass += keep ? ps[i].mass : 0.0f;
+    }
+    out.resize(count);
+    return mass;
+}
+
+// 选出x > threshold的下标写入dst，同时累加被选中粒子的质量；标量版本逐个判断
+inline size_t filter_greater_scalar(const float* x, const float* m, size_t begin, size_t n, float threshold,
+                                    uint32_t* dst, float& mass) {
+    size_t count = 0;
+    for (size_t i = begin; i < n; ++i) {
+        bool keep = x[i] > threshold;
+        dst[count] = static_cast<uint32_t>(i);
+        count += keep;
+        mass += keep ? m[i] : 0.0f;
+    }
+    return count;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// AVX2版本：一次比较8个x得到8位掩码；质量用掩码按位与后累加，下标按掩码查表
+// 取出"选中者往前挤"的置换，整组写出，再按popcount前进
+__attribute__((target("avx2,popcnt"))) inline size_t filter_greater_avx2(const float* x, const float* m, size_t n,
+                                                                         float threshold, uint32_t* dst,
+                                                                         float& mass) {
+    static const auto table = [] {
+        std::array<std::array<uint32_t, 8>, 256> t{};
+        for (unsigned mask = 0; mask < 256; ++mask) {
+            unsigned k = 0;
+            for (unsigned bit = 0; bit < 8; ++bit) {
+                if (mask & (1u << bit)) t[mask][k++] = bit;
+            }
+        }
+        return t;
+    }();
+    const __m256 limit = _mm256_set1_ps(threshold);
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 acc = _mm256_setzero_ps();
+    size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 keep = _mm256_cmp_ps(_mm256_loadu_ps(x + i), limit, _CMP_GT_OQ);
+        acc = _mm256_add_ps(acc, _mm256_and_ps(keep, _mm256_loadu_ps(m + i)));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(keep));
+        __m256i perm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(table[mask].data()));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + count), _mm256_permutevar8x32_epi32(index, perm));
+        count += static_cast<size_t>(__builtin_popcount(mask));
+        index = _mm256_add_epi32(index, step);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    for (float lane : lanes) mass += lane;
+    return count + filter_greater_scalar(x, m, i, n, threshold, dst + count, mass);
+}
+#endif
+
+// dst至少要有n + 8个元素的空间：AVX2版本每次整组写出8个下标
+inline size_t filter_greater(const float* x, const float* m, size_t n, float threshold, uint32_t* dst, float& mass) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) return filter_greater_avx2(x, m, n, threshold, dst, mass);
+#endif
+    return filter_greater_scalar(x, m, 0, n, threshold, dst, mass);
+}
+
+[[gnu::noinline]] double filter(const ParticleSoA& ps, float threshold, std::vector<uint32_t>& out) {
+    const size_t n = ps.size();
+    float mass = 0.0f;
+    out.resize(n + 8);
+    out.resize(filter_greater(ps.field<PX>(), ps.field<MASS>(), n, threshold, out.data(), mass));
+    return mass;
+}
+
+// 聚集：按（已排序的）下标取出x/y/z求和，模拟邻居列表或订单簿按价位取档
+[[gnu::noinline]] double gather(const std::vector<Particle>& ps, const std::vector<uint32_t>& idx) {
+    double sum = 0.0;
+    for (uint32_t i : idx) sum += ps[i].x + ps[i].y + ps[i].z;
+    return sum;
+}
+
+[[gnu::noinline]] double gather(const ParticleSoA& ps, const std::vector<uint32_t>& idx) {
+    const float* x = ps.field<PX>();
+    const float* y = ps.field<PY>();
+    const float* z = ps.field<PZ>();
+    double sum = 0.0;
+    for (uint32_t i : idx) sum += x[i] + y[i] + z[i];
+    return sum;
+}
+
+}  // namespace soa_kernels
+
+void demonstrate_soa_layout() {
+    std::cout << "=== 结构体数组 vs 数组结构体演示 ===\n";
+    
+    // 基本用法：代理引用、结构化绑定、与结构体互转
+    soa_vector<int, double> pairs;
+    pairs.push_back(1, 1.5);
+    pairs.push_back(2, 2.5);
+    auto [key, value] = pairs[1];
+    value *= 2;  // 通过引用写回容器
+    std::cout << "pairs[1] = (" << key << ", " << std::get<1>(pairs[1]) << ")，第二列地址按64字节对齐: "
+              << (reinterpret_cast<uintptr_t>(pairs.field<1>()) % 64 == 0 ? "是" : "否") << "\n";
+    
+    const size_t n = 4'000'000;
+    std::vector<Particle> aos(n);
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<float> pos(0.0f, 100.0f), vel(-1.0f, 1.0f), mass(0.5f, 2.0f);
+    for (size_t i = 0; i < n; ++i) {
+        aos[i] = Particle{pos(gen), pos(gen), pos(gen), vel(gen), vel(gen), vel(gen), mass(gen), static_cast<int>(i)};
+    }
+    auto soa = ParticleSoA::from_aos(aos, &Particle::x, &Particle::y, &Particle::z, &Particle::vx, &Particle::vy,
+                                     &Particle::vz, &Particle::mass, &Particle::id);
+    std::cout << n << " 个粒子，AoS " << n * sizeof(Particle) / (1024 * 1024) << " MB，"
+              << "往返转换一致: " << (soa.to_aos<Particle>(&Particle::x, &Particle::y, &Particle::z, &Particle::vx,
+                                                           &Particle::vy, &Particle::vz, &Particle::mass,
+                                                           &Particle::id)[n / 2].id == aos[n / 2].id ? "是" : "否")
+              << "\n\n";
+    
+    // 各方案交替运行，取最短时间
+    auto best_of = [](int rounds, auto&& fn) {
+        double best = 1e300;
+        for (int r = 0; r < rounds; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(
+                                      std::chrono::high_resolution_clock::now() - start).count());
+        }
+        return best;
+    };
+    std::cout << std::fixed << std::setprecision(2);
+    auto line = [](const std::string& name, double aos_ms, double soa_ms, double aos_mb, double soa_mb) {
+        std::cout << "AoS " << std::setw(7) << aos_ms << " ms (" << std::setw(6) << aos_mb / aos_ms << " GB/s)  "
+                  << "SoA " << std::setw(7) << soa_ms << " ms (" << std::setw(6) << soa_mb / soa_ms << " GB/s)  "
+                  << std::setw(5) << aos_ms / soa_ms << "x  " << name << "\n";
+    };
+    const double mb_per_field = n * 4.0 / 1e6;  // 按实际用到的字节计
+    
+    // 1. 位置积分（流式读写）
+    double t_aos = best_of(5, [&] { soa_kernels::integrate(aos, 0.01f); });
+    double t_soa = best_of(5, [&] { soa_kernels::integrate(soa, 0.01f); });
+    line("积分 x += v*dt", t_aos, t_soa, 2 * 8 * mb_per_field, 9 * mb_per_field);
+    
+    // 2. zip迭代交给并行算法：同一个lambda，按代理引用访问各列
+    double t_zip = best_of(5, [&] {
+        parallel::for_each(parallel::par, soa.begin(), soa.end(), [](ParticleSoA::reference p) {
+            std::get<PX>(p) += std::get<VX>(p) * 0.01f;
+        });
+    });
+    double t_aos_par = best_of(5, [&] {
+        parallel::for_each(parallel::par, aos.begin(), aos.end(), [](Particle& p) { p.x += p.vx * 0.01f; });
+    });
+    line("parallel::for_each 只更新x", t_aos_par, t_zip, 2 * 8 * mb_per_field, 3 * mb_per_field);
+    
+    // 3. 过滤（stream compaction）
+    std::vector<uint32_t> sel_aos, sel_soa;
+    double m_aos = 0, m_soa = 0;
+    t_aos = best_of(5, [&] { m_aos = soa_kernels::filter(aos, 50.0f, sel_aos); });
+    t_soa = best_of(5, [&] { m_soa = soa_kernels::filter(soa, 50.0f, sel_soa); });
+    line("过滤 x > 50", t_aos, t_soa, 8 * mb_per_field, 2 * mb_per_field);
+    std::cout << "  选中 " << sel_soa.size() << " 个，下标一致: " << (sel_aos == sel_soa ? "是" : "否")
+              << "，质量和相对误差 " << std::scientific << std::abs(m_aos - m_soa) / m_aos << std::fixed << "\n";
+    
+    // 4. 聚集：稀疏度不同时的差别
+    for (uint32_t stride : {2u, 8u, 64u}) {
+        std::vector<uint32_t> idx;
+        for (uint32_t i = 0; i < n; i += 1 + gen() % (2 * stride - 1)) idx.push_back(i);
+        double s_aos = 0, s_soa = 0;
+        t_aos = best_of(5, [&] { s_aos = soa_kernels::gather(aos, idx); });
+        t_soa = best_of(5, [&] { s_soa = soa_kernels::gather(soa, idx); });
+        line("聚集x/y/z，平均每" + std::to_string(stride) + "个取1", t_aos, t_soa, 3 * idx.size() * 4.0 / 1e6, 3 * idx.size() * 4.0 / 1e6);
+        if (s_aos != s_soa) std::cout << "  !! 聚集结果不一致\n";
+    }
+    std::cout << std::defaultfloat;
+    
+    std::cout << "\n要点:\n";
+    std::cout << "- GB/s按实际用到的字段计；AoS还要搬运用不到的字段，受内存带宽限制时差距接近字节数之比\n";
+    std::cout << "- 聚集时下标越稀疏，SoA的优势越小；稀疏到每条缓存行只取一个元素时，AoS一次取齐三个字段，\n";
+    std::cout << "  SoA却要碰三条缓存行，反而更慢——布局要按访问模式选\n";
+    std::cout << "- 代理引用方便通用算法使用；热循环里用field<I>()拿到列指针效果最好\n";
+    
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++17 并行算法性能飞跃深度解析\n";
     std::cout << "=================================\n";
     
@@ -575,6 +1746,9 @@ int main() {
     demonstrate_simd_optimization();
     demonstrate_memory_access_patterns();
     demonstrate_performance_tuning();
+    demonstrate_custom_parallel_backend();
+    demonstrate_radix_sort_and_scan();
+    demonstrate_soa_layout();
     
     return 0;
 }
@@ -592,10 +1766,14 @@ g++ -std=c++17 -O2 -Wall -ltbb 08_parallel_algorithms.cpp -o parallel_algorithms
 3. SIMD向量化对简单数学运算有显著性能提升
 4. 内存访问模式对并行性能有重大影响
 5. 不同类型的工作负载需要选择合适的执行策略
+6. 自己的并行后端可以控制粒度、线程数和绑核，并在数据量低于阈值时退回串行
+7. 整数键用基数排序避开比较和分支；单遍look-back扫描让每个tile只从内存读一次
+8. 只访问部分字段的带宽受限循环适合SoA布局，内存流量与用到的字节数成正比
 
 注意事项:
 - 并行算法需要编译器和标准库的支持
 - 小数据集可能不适合并行处理，存在线程开销
 - 向量化要求操作简单且无分支
 - 要注意数据竞争和内存一致性问题
+- parallel::reduce和inclusive_scan要求运算满足结合律，块划分固定因此浮点结果可复现
 */
\ No newline at end of file
@@ -7,6 +7,8 @@
  * 3. 自定义视图实现 - 深入理解view_interface和适配器模式
  * 4. Range算法增强 - 投影和约束的算法设计革新
  * 5. constexpr Ranges - 编译期范围计算的实现原理
+ * 6. 分段轮式筛法 - 按缓存分段、按需生成的惰性素数范围与并行筛选
+ * 7. 增量窗口聚合 - 累加值/单调队列/双栈让滑动窗口每步O(1)
  */
 
 #include <iostream>
@@ -18,6 +20,18 @@
 #include <functional>
 #include <iterator>
 #include <concepts>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
 
 // ===== 1. 视图惰性求值演示 =====
 // 对比传统STL与Ranges的性能差异
@@ -625,18 +639,18 @@ void demonstrate_constexpr_ranges() {
     std::cout << "\n\n";
 }
 
+// 模拟传感器数据
+struct SensorReading {
+    int sensor_id;
+    double value;
+    std::string timestamp;
+    bool is_valid;
+};
+
 // 高级应用：数据流处理管道
 void demonstrate_advanced_pipeline() {
     std::cout << "=== 高级数据流处理管道 ===\n";
     
-    // 模拟传感器数据
-    struct SensorReading {
-        int sensor_id;
-        double value;
-        std::string timestamp;
-        bool is_valid;
-    };
-    
     std::vector<SensorReading> sensor_data = {
         {1, 23.5, "2023-01-01T10:00:00", true},
         {1, 24.1, "2023-01-01T10:01:00", true},
@@ -702,6 +716,873 @@ void demonstrate_advanced_pipeline() {
     std::cout << "\n";
 }
 
+// ===== 6. 分段轮式筛法素数视图 =====
+// PrimeView对每个候选数做试除，枚举到n的代价约为O(n·√n/log n)，10^7以上已经不可用
+// wheel_sieve用分段埃拉托斯特尼筛法代替，要点：
+// 1. 30轮(wheel-30)：与30互素的余数只有{1,7,11,13,17,19,23,29}这8个，
+//    一个字节正好表示30个连续整数，内存只有普通字节筛的1/30
+// 2. 分段：每次只筛一段适合放进L1/L2缓存的字节，筛到10^10也只需几十KB的工作集
+// 3. 对素数p，乘数m≡r(mod 30)的倍数p·m落在同一个比特上，字节步长恰好为p，
+//    因此每个筛素数只需保存8个"下一个倍数所在字节"的偏移，跨段时减去段长即可
+// 4. prime_range按需逐段生成素数，是可以接到std::views管道后面的惰性输入范围
+// 5. reduce_segments把字节区间切成连续块交给多个线程，每个线程独立维护筛素数的偏移
+namespace wheel_sieve {
+
+inline constexpr uint8_t kResidues[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+
+// n % 30 -> 对应的比特位置，与30不互素的余数为-1
+inline constexpr auto kBitOf = [] {
+    std::array<int8_t, 30> table{};
+    table.fill(-1);
+    for (int i = 0; i < 8; ++i) table[kResidues[i]] = static_cast<int8_t>(i);
+    return table;
+}();
+
+inline constexpr size_t kDefaultSegmentBytes = 32 * 1024;  // 一段覆盖983040个整数
+
+inline uint64_t isqrt(uint64_t n) {
+    uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+    while (r * r > n) --r;
+    while ((r + 1) * (r + 1) <= n) ++r;
+    return r;
+}
+
+// 筛到√limit的基础素数（跳过2、3、5，它们已经被轮子排除）
+inline std::vector<uint32_t> base_primes(uint64_t limit) {
+    const uint64_t root = isqrt(limit);
+    std::vector<char> composite(root + 1, 0);
+    std::vector<uint32_t> primes;
+    for (uint64_t i = 2; i <= root; ++i) {
+        if (composite[i]) continue;
+        if (i > 5) primes.push_back(static_cast<uint32_t>(i));
+        for (uint64_t j = i * i; j <= root; j += i) composite[j] = 1;
+    }
+    return primes;
+}
+
+// 一段筛选结果：第k个字节的第i位为1表示30·(first_byte+k)+kResidues[i]是素数
+struct Segment {
+    uint64_t first_byte = 0;
+    size_t bytes = 0;
+    const uint8_t* bits = nullptr;  // 长度向上取整到8字节，填充部分为0
+
+    uint64_t low() const { return first_byte * 30; }
+
+    uint64_t count() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < bytes; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bits + i, sizeof(word));
+            total += static_cast<uint64_t>(std::popcount(word));
+        }
+        return total;
+    }
+
+    template<typename F>
+    void for_each_prime(F&& f) const {
+        for (size_t i = 0; i < bytes; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bits + i, sizeof(word));
+            while (word) {
+                const int b = std::countr_zero(word);
+                f((first_byte + i + static_cast<unsigned>(b >> 3)) * 30 + kResidues[b & 7]);
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+// 单线程的分段筛引擎：从first_byte开始，每次sieve_next筛出紧接着的一段
+class SegmentSieve {
+    struct SievingPrime {
+        uint32_t prime;
+        uint32_t offset[8];  // 相对当前段起点的字节偏移
+        uint8_t mask[8];     // 需要清除的比特
+    };
+
+    std::vector<uint32_t> base_;
+    std::vector<SievingPrime> primes_;  // 已经开始筛的素数，即p² < 当前段上界的那一部分
+    uint64_t limit_;
+    uint64_t next_byte_;
+    uint64_t end_byte_;  // 最后一个需要的字节之后
+    size_t segment_bytes_;
+    std::vector<uint8_t> buffer_;
+
+public:
+    SegmentSieve(const std::vector<uint32_t>& base, uint64_t limit, uint64_t first_byte,
+                 uint64_t end_byte, size_t segment_bytes = kDefaultSegmentBytes)
+        : base_(base), limit_(limit), next_byte_(first_byte), end_byte_(end_byte),
+          segment_bytes_((segment_bytes + 7) & ~size_t{7}),
+          buffer_(segment_bytes_ + 8, 0) {
+        primes_.reserve(base_.size());
+    }
+
+    // 素数p在段first开始时才加入：从max(p², 段下界)起找第一个与30互素的乘数m，8个余数类各取一个。
+    // 此时p² < 段上界，所有偏移都小于段长+p，uint32足够
+    void activate(uint32_t p, uint64_t first) {
+        SievingPrime sp{};
+        sp.prime = p;
+        const uint64_t m_min = std::max<uint64_t>(p, (first * 30 + p - 1) / p);
+        for (int j = 0; j < 8; ++j) {
+            const uint64_t m = m_min + (kResidues[j] + 30 - m_min % 30) % 30;
+            const uint64_t v = static_cast<uint64_t>(p) * m;
+            sp.offset[j] = static_cast<uint32_t>(v / 30 - first);
+            sp.mask[j] = static_cast<uint8_t>(~(1u << kBitOf[v % 30]));
+        }
+        primes_.push_back(sp);
+    }
+
+    bool done() const { return next_byte_ >= end_byte_; }
+
+    // 筛出下一段；返回的Segment指向内部缓冲区，下一次调用后失效
+    Segment sieve_next() {
+        const uint64_t first = next_byte_;
+        const size_t bytes = static_cast<size_t>(std::min<uint64_t>(segment_bytes_, end_byte_ - first));
+        uint8_t* seg = buffer_.data();
+        std::memset(seg, 0xFF, bytes);
+        std::memset(seg + bytes, 0, buffer_.size() - bytes);
+
+        // 基础素数递增，p²落进本段之前的素数不需要筛
+        const uint64_t high = (first + bytes) * 30;
+        while (primes_.size() < base_.size()) {
+            const uint64_t p = base_[primes_.size()];
+            if (p * p >= high) break;
+            activate(static_cast<uint32_t>(p), first);
+        }
+        for (SievingPrime& sp : primes_) {
+            const uint64_t p = sp.prime;
+            for (int j = 0; j < 8; ++j) {
+                uint64_t off = sp.offset[j];
+                const uint8_t mask = sp.mask[j];
+                for (; off < bytes; off += p) seg[off] &= mask;
+                sp.offset[j] = static_cast<uint32_t>(off - bytes);
+            }
+        }
+
+        if (first == 0) seg[0] &= static_cast<uint8_t>(~1u);  // 1不是素数
+        if (first + bytes == limit_ / 30 + 1) {
+            // 最后一个字节里大于limit的数要清掉
+            const uint64_t base = (limit_ / 30) * 30;
+            for (int i = 0; i < 8; ++i) {
+                if (base + kResidues[i] > limit_) seg[bytes - 1] &= static_cast<uint8_t>(~(1u << i));
+            }
+        }
+        next_byte_ += bytes;
+        return Segment{first, bytes, seg};
+    }
+};
+
+inline uint64_t total_bytes(uint64_t limit) { return limit / 30 + 1; }
+
+// 2、3、5不在轮子里，单独计入
+inline uint64_t small_prime_count(uint64_t limit) {
+    return (limit >= 2) + (limit >= 3) + (limit >= 5);
+}
+
+// 惰性素数范围：begin()时才计算基础素数，遍历过程中逐段筛选
+class prime_range : public std::ranges::view_interface<prime_range> {
+    struct State {
+        uint64_t limit;
+        SegmentSieve sieve;
+        Segment segment{};
+        size_t word_index = 0;
+        uint64_t word = 0;
+        int small_index = 0;  // 先依次产出2、3、5
+        uint64_t current = 0;
+        bool done = false;
+
+        State(uint64_t lim, size_t segment_bytes)
+            : limit(lim), sieve(base_primes(lim), lim, 0, total_bytes(lim), segment_bytes) {}
+
+        void advance() {
+            static constexpr uint64_t kSmall[3] = {2, 3, 5};
+            if (small_index < 3) {
+                const uint64_t p = kSmall[small_index++];
+                if (p <= limit) {
+                    current = p;
+                    return;
+                }
+                small_index = 3;
+            }
+            for (;;) {
+                if (word) {
+                    const int b = std::countr_zero(word);
+                    word &= word - 1;
+                    current = (segment.first_byte + word_index * 8 + static_cast<unsigned>(b >> 3)) * 30 +
+                              kResidues[b & 7];
+                    return;
+                }
+                if (segment.bits && (word_index + 1) * 8 < segment.bytes) {
+                    ++word_index;
+                } else if (!sieve.done()) {
+                    segment = sieve.sieve_next();
+                    word_index = 0;
+                } else {
+                    done = true;
+                    return;
+                }
+                std::memcpy(&word, segment.bits + word_index * 8, sizeof(word));
+            }
+        }
+    };
+
+    uint64_t limit_ = 0;
+    size_t segment_bytes_ = kDefaultSegmentBytes;
+    std::unique_ptr<State> state_;  // 迭代器指向它，移动视图不会让迭代器失效
+
+public:
+    class iterator {
+        State* state_ = nullptr;
+
+    public:
+        using value_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::input_iterator_tag;
+
+        iterator() = default;
+        explicit iterator(State* state) : state_(state) {}
+
+        uint64_t operator*() const { return state_->current; }
+        iterator& operator++() {
+            state_->advance();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) { return it.state_->done; }
+    };
+
+    prime_range() = default;
+    explicit prime_range(uint64_t limit, size_t segment_bytes = kDefaultSegmentBytes)
+        : limit_(limit), segment_bytes_(segment_bytes) {}
+
+    // 输入范围只能遍历一次，每次begin()都从头开始重新筛
+    iterator begin() {
+        state_ = std::make_unique<State>(limit_, segment_bytes_);
+        state_->advance();
+        return iterator(state_.get());
+    }
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+};
+
+inline prime_range wheel_primes(uint64_t limit) { return prime_range(limit); }
+
+// 并行模式：字节区间切成threads个连续块（按段长对齐），每个线程从自己的起点初始化偏移，
+// 对每一段调用per_segment并累加它的返回值。per_segment会在多个线程上同时调用
+template<typename F>
+uint64_t reduce_segments(uint64_t limit, unsigned threads, F per_segment,
+                         size_t segment_bytes = kDefaultSegmentBytes) {
+    const std::vector<uint32_t> base = base_primes(limit);
+    const uint64_t bytes = total_bytes(limit);
+    threads = std::max(1u, threads);
+    uint64_t block = (bytes + threads - 1) / threads;
+    block = (block + segment_bytes - 1) / segment_bytes * segment_bytes;
+
+    auto work = [&](uint64_t first, uint64_t last) {
+        uint64_t sum = 0;
+        SegmentSieve sieve(base, limit, first, last, segment_bytes);
+        while (!sieve.done()) sum += per_segment(sieve.sieve_next());
+        return sum;
+    };
+
+    std::vector<uint64_t> partial(threads, 0);
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads && t * block < bytes; ++t) {
+        workers.emplace_back([&, t] {
+            partial[t] = work(t * block, std::min(bytes, (t + 1) * block));
+        });
+    }
+    partial[0] = work(0, std::min(bytes, block));  // 当前线程处理第一块
+    for (auto& w : workers) w.join();
+    return std::accumulate(partial.begin(), partial.end(), uint64_t{0});
+}
+
+inline uint64_t count_primes(uint64_t limit, unsigned threads = 1) {
+    if (limit < 2) return 0;
+    return small_prime_count(limit) +
+           reduce_segments(limit, threads, [](const Segment& s) { return s.count(); });
+}
+
+} // namespace wheel_sieve
+
+void demonstrate_wheel_sieve() {
+    std::cout << "=== 分段轮式筛法素数视图演示 ===\n";
+    using namespace wheel_sieve;
+
+    std::cout << "100以内的素数(prime_range):\n";
+    for (auto p : wheel_primes(100)) std::cout << p << " ";
+    std::cout << "\n";
+
+    // 作为惰性范围接入ranges管道：只筛到取够为止
+    std::cout << "不小于999999000的前5个素数: ";
+    for (auto p : wheel_primes(1'000'000'000) | std::views::drop_while([](uint64_t p) { return p < 999'999'000; })
+                                               | std::views::take(5)) {
+        std::cout << p << " ";
+    }
+    std::cout << "\n";
+
+    auto time_best = [](int reps, auto&& f) {
+        double best = 1e300;
+        for (int rep = 0; rep < reps; ++rep) {
+            auto start = std::chrono::high_resolution_clock::now();
+            f();
+            best = std::min(best, std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count());
+        }
+        return best;
+    };
+
+    // 与试除法对比：逐个枚举10^6以内的素数
+    constexpr uint64_t kSmallLimit = 1'000'000;
+    uint64_t trial_sum = 0, trial_count = 0, sieve_sum = 0, sieve_count = 0;
+    double trial_ms = time_best(3, [&] {
+        trial_sum = trial_count = 0;
+        for (auto p : primes(kSmallLimit)) {
+            trial_sum += p;
+            ++trial_count;
+        }
+    });
+    double sieve_ms = time_best(3, [&] {
+        sieve_sum = sieve_count = 0;
+        for (auto p : wheel_primes(kSmallLimit)) {
+            sieve_sum += p;
+            ++sieve_count;
+        }
+    });
+    std::cout << "\n枚举10^6以内的素数:\n";
+    std::cout << "  PrimeView试除:    " << trial_ms << " ms\n";
+    std::cout << "  prime_range筛法:  " << sieve_ms << " ms (" << trial_ms / sieve_ms << "x)\n";
+    std::cout << "  结果一致: " << (trial_count == sieve_count && trial_sum == sieve_sum ? "是" : "否")
+              << " (" << sieve_count << "个)\n";
+
+    // 按段回调求和：2·10^6以内素数之和为142913828922
+    uint64_t segment_sum = 5 + 3 + 2 + reduce_segments(2'000'000, 1, [](const Segment& s) {
+        uint64_t sum = 0;
+        s.for_each_prime([&](uint64_t p) { sum += p; });
+        return sum;
+    });
+    std::cout << "2·10^6以内素数之和: " << segment_sum
+              << (segment_sum == 142'913'828'922ULL ? " (正确)" : " (错误)") << "\n";
+
+    // 计数：π(10^9) = 50847534；筛到10^10(π = 455052511)只需把limit换成10'000'000'000
+    constexpr uint64_t kLimit = 1'000'000'000;
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t serial = 0, parallel = 0;
+    double serial_ms = time_best(1, [&] { serial = count_primes(kLimit, 1); });
+    double parallel_ms = time_best(1, [&] { parallel = count_primes(kLimit, hw); });
+    std::cout << "\nπ(10^9):\n";
+    std::cout << "  单线程:       " << serial << ", " << serial_ms << " ms\n";
+    std::cout << "  " << hw << "线程并行:    " << parallel << ", " << parallel_ms << " ms ("
+              << serial_ms / parallel_ms << "x)\n";
+    std::cout << "  结果" << (serial == 50'847'534 && parallel == serial ? "正确" : "错误") << "\n";
+
+    std::cout << "\n";
+}
+
+// ===== 7. 增量滑动窗口聚合演示 =====
+// SlidingWindowView每一步都把整个窗口拷贝成vector，再对窗口求和/最值，代价是O(n·k)
+// window_agg让窗口滑动一步只做O(1)（均摊）的工作：
+// 1. 可逆运算(ops::sum / ops::mean)：维护累加值，新元素加入、最旧元素减去；
+//    浮点数用Neumaier补偿求和，避免长流上的舍入误差累积
+// 2. ops::min / ops::max：单调队列，队列里只保留"还有可能成为最值"的元素
+// 3. 其他任意满足结合律的运算（gcd、按位或、矩阵乘……）：双栈队列，弹出时批量翻转并预计算后缀聚合
+// 4. sliding_window_agg(k, op)按元素个数开窗，只产出完整窗口（共n-k+1个值）
+// 5. sliding_time_window_agg(width, op, time_proj)按时间开窗，窗口为(t - width, t]，输入须按时间有序
+namespace window_agg {
+
+// 容量为2的幂的环形队列，满了自动扩容；窗口聚合器的底层存储
+template<typename T>
+class ring_queue {
+    std::vector<T> buf_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+
+    size_t mask() const { return buf_.size() - 1; }
+
+    void grow() {
+        std::vector<T> bigger(buf_.size() * 2);
+        for (size_t i = 0; i < size_; ++i) bigger[i] = std::move(buf_[(head_ + i) & mask()]);
+        buf_ = std::move(bigger);
+        head_ = 0;
+    }
+
+public:
+    explicit ring_queue(size_t capacity = 16) : buf_(std::bit_ceil(std::max<size_t>(capacity, 16))) {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T& front() { return buf_[head_]; }
+    T& back() { return buf_[(head_ + size_ - 1) & mask()]; }
+    const T& front() const { return buf_[head_]; }
+    const T& back() const { return buf_[(head_ + size_ - 1) & mask()]; }
+
+    void push_back(T value) {
+        if (size_ == buf_.size()) grow();
+        buf_[(head_ + size_) & mask()] = std::move(value);
+        ++size_;
+    }
+    void pop_front() {
+        head_ = (head_ + 1) & mask();
+        --size_;
+    }
+    void pop_back() { --size_; }
+};
+
+namespace ops {
+struct sum {};
+struct mean {};
+struct min {};
+struct max {};
+} // namespace ops
+
+// 通用情形：双栈队列，只要求op满足结合律（不要求交换律和逆元）
+// front_栈顶是最旧的元素，每个位置保存"从它到front_栈底"的聚合；back_只保存整体聚合
+template<typename T, typename Op>
+class aggregator {
+    struct entry {
+        T value;
+        T agg;
+    };
+
+    Op op_;
+    std::vector<entry> front_;
+    std::vector<T> back_;
+    T back_agg_{};
+
+    void flip() {
+        // back_从旧到新，逆序压入front_，使最旧的元素位于栈顶且其agg覆盖整个front_
+        for (size_t i = back_.size(); i-- > 0;) {
+            T agg = front_.empty() ? back_[i] : op_(back_[i], front_.back().agg);
+            front_.push_back({std::move(back_[i]), std::move(agg)});
+        }
+        back_.clear();
+    }
+
+public:
+    explicit aggregator(Op op = {}, size_t capacity = 0) : op_(std::move(op)) {
+        front_.reserve(capacity);
+        back_.reserve(capacity);
+    }
+
+    size_t size() const { return front_.size() + back_.size(); }
+
+    void push(const T& value) {
+        back_agg_ = back_.empty() ? value : op_(back_agg_, value);
+        back_.push_back(value);
+    }
+
+    void pop() {
+        if (front_.empty()) flip();
+        front_.pop_back();
+    }
+
+    // 前置条件：窗口非空
+    T value() const {
+        if (front_.empty()) return back_agg_;
+        if (back_.empty()) return front_.back().agg;
+        return op_(front_.back().agg, back_agg_);
+    }
+};
+
+// 可逆运算：累加和
+template<typename T>
+class aggregator<T, ops::sum> {
+    ring_queue<T> values_;
+    T sum_{};
+    T compensation_{};  // 只有浮点数使用
+
+    void add(T x) {
+        if constexpr (std::is_floating_point_v<T>) {
+            T t = sum_ + x;
+            compensation_ += std::abs(sum_) >= std::abs(x) ? (sum_ - t) + x : (x - t) + sum_;
+            sum_ = t;
+        } else {
+            sum_ += x;
+        }
+    }
+
+public:
+    explicit aggregator(ops::sum = {}, size_t capacity = 0) : values_(capacity + 1) {}
+
+    size_t size() const { return values_.size(); }
+
+    void push(const T& value) {
+        values_.push_back(value);
+        add(value);
+    }
+
+    void pop() {
+        add(-values_.front());
+        values_.pop_front();
+    }
+
+    T value() const { return sum_ + compensation_; }
+};
+
+template<typename T>
+class aggregator<T, ops::mean> : public aggregator<T, ops::sum> {
+    using base = aggregator<T, ops::sum>;
+
+public:
+    explicit aggregator(ops::mean = {}, size_t capacity = 0) : base(ops::sum{}, capacity) {}
+
+    double value() const { return static_cast<double>(base::value()) / static_cast<double>(base::size()); }
+};
+
+// 单调队列：对min保持队列值严格递增，队首就是窗口最小值；每个元素最多入队出队各一次
+template<typename T, typename Compare>
+class monotonic_aggregator {
+    struct entry {
+        uint64_t seq;
+        T value;
+    };
+
+    ring_queue<entry> queue_;
+    uint64_t pushed_ = 0;
+    uint64_t popped_ = 0;
+    Compare comp_;
+
+public:
+    explicit monotonic_aggregator(size_t capacity = 0) : queue_(capacity + 1) {}
+
+    size_t size() const { return static_cast<size_t>(pushed_ - popped_); }
+
+    void push(const T& value) {
+        while (!queue_.empty() && !comp_(queue_.back().value, value)) queue_.pop_back();
+        queue_.push_back({pushed_++, value});
+    }
+
+    void pop() {
+        if (queue_.front().seq == popped_) queue_.pop_front();
+        ++popped_;
+    }
+
+    const T& value() const { return queue_.front().value; }
+};
+
+template<typename T>
+class aggregator<T, ops::min> : public monotonic_aggregator<T, std::less<T>> {
+public:
+    explicit aggregator(ops::min = {}, size_t capacity = 0) : monotonic_aggregator<T, std::less<T>>(capacity) {}
+};
+
+template<typename T>
+class aggregator<T, ops::max> : public monotonic_aggregator<T, std::greater<T>> {
+public:
+    explicit aggregator(ops::max = {}, size_t capacity = 0) : monotonic_aggregator<T, std::greater<T>>(capacity) {}
+};
+
+template<typename T, typename Op>
+using result_t = std::remove_cvref_t<decltype(std::declval<const aggregator<T, Op>&>().value())>;
+
+// 按时间开窗的在线聚合器：不依赖ranges，可以直接接在数据采集回调里
+template<typename T, typename Op, typename Time>
+class time_window_aggregator {
+    using duration = decltype(std::declval<Time>() - std::declval<Time>());
+
+    aggregator<T, Op> agg_;
+    ring_queue<Time> times_;
+    duration width_;
+
+public:
+    // 窗口为(t - width, t]：width不为正时窗口为空，add会在淘汰循环里对空队列取front()
+    time_window_aggregator(duration width, Op op = {}) : agg_(std::move(op)), width_(width) {
+        if (!(duration{} < width_)) throw std::invalid_argument("time_window_aggregator: 窗口宽度必须为正");
+    }
+
+    size_t size() const { return agg_.size(); }
+
+    // 加入时间t的样本，并淘汰所有不晚于t - width的旧样本
+    void add(Time t, const T& value) {
+        agg_.push(value);
+        times_.push_back(t);
+        while (!(t - times_.front() < width_)) {
+            times_.pop_front();
+            agg_.pop();
+        }
+    }
+
+    result_t<T, Op> value() const { return agg_.value(); }
+};
+
+// 按个数开窗的聚合视图：单遍输入范围，状态放在堆上，迭代器只持有指针
+template<std::ranges::input_range R, typename Op, typename Proj>
+    requires std::ranges::view<R>
+class sliding_agg_view : public std::ranges::view_interface<sliding_agg_view<R, Op, Proj>> {
+    using value_type = std::remove_cvref_t<std::invoke_result_t<Proj&, std::ranges::range_reference_t<R>>>;
+    using result_type = result_t<value_type, Op>;
+
+    struct State {
+        std::ranges::iterator_t<R> it;
+        std::ranges::sentinel_t<R> last;
+        aggregator<value_type, Op> agg;
+        Proj proj;
+        size_t k;
+        result_type current{};
+        bool done = false;
+
+        bool push_next() {
+            if (it == last) return false;
+            agg.push(std::invoke(proj, *it));
+            ++it;
+            return true;
+        }
+
+        void advance() {
+            if (!push_next()) {
+                done = true;
+                return;
+            }
+            if (agg.size() > k) agg.pop();
+            current = agg.value();
+        }
+    };
+
+    R base_;
+    size_t k_ = 1;
+    Op op_;
+    Proj proj_;
+    std::unique_ptr<State> state_;
+
+public:
+    class iterator {
+        State* state_ = nullptr;
+
+    public:
+        using value_type = result_type;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::input_iterator_tag;
+
+        iterator() = default;
+        explicit iterator(State* state) : state_(state) {}
+
+        const result_type& operator*() const { return state_->current; }
+        iterator& operator++() {
+            state_->advance();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) { return it.state_->done; }
+    };
+
+    sliding_agg_view() = default;
+    sliding_agg_view(R base, size_t k, Op op, Proj proj)
+        : base_(std::move(base)), k_(std::max<size_t>(k, 1)), op_(std::move(op)), proj_(std::move(proj)) {}
+
+    iterator begin() {
+        state_.reset(new State{std::ranges::begin(base_), std::ranges::end(base_),
+                               aggregator<value_type, Op>(op_, k_), proj_, k_});
+        // 先装入前k-1个元素，第一次advance之后窗口才是满的
+        for (size_t i = 1; i < k_ && state_->push_next(); ++i) {}
+        state_->advance();
+        return iterator(state_.get());
+    }
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+};
+
+// 按时间开窗的聚合视图：每个输入元素产出一个(窗口结束时间, 聚合值)
+template<std::ranges::input_range R, typename Duration, typename Op, typename TimeProj, typename Proj>
+    requires std::ranges::view<R>
+class time_window_agg_view
+    : public std::ranges::view_interface<time_window_agg_view<R, Duration, Op, TimeProj, Proj>> {
+    using reference = std::ranges::range_reference_t<R>;
+    using time_type = std::remove_cvref_t<std::invoke_result_t<TimeProj&, reference>>;
+    using value_type = std::remove_cvref_t<std::invoke_result_t<Proj&, reference>>;
+    using result_type = std::pair<time_type, result_t<value_type, Op>>;
+
+    struct State {
+        std::ranges::iterator_t<R> it;
+        std::ranges::sentinel_t<R> last;
+        time_window_aggregator<value_type, Op, time_type> window;
+        TimeProj time_proj;
+        Proj proj;
+        result_type current{};
+        bool done = false;
+
+        void advance() {
+            if (it == last) {
+                done = true;
+                return;
+            }
+            time_type t = std::invoke(time_proj, *it);
+            window.add(t, std::invoke(proj, *it));
+            ++it;
+            current = {t, window.value()};
+        }
+    };
+
+    R base_;
+    Duration width_{};
+    Op op_;
+    TimeProj time_proj_;
+    Proj proj_;
+    std::unique_ptr<State> state_;
+
+public:
+    class iterator {
+        State* state_ = nullptr;
+
+    public:
+        using value_type = result_type;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::input_iterator_tag;
+
+        iterator() = default;
+        explicit iterator(State* state) : state_(state) {}
+
+        const result_type& operator*() const { return state_->current; }
+        iterator& operator++() {
+            state_->advance();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) { return it.state_->done; }
+    };
+
+    time_window_agg_view() = default;
+    time_window_agg_view(R base, Duration width, Op op, TimeProj time_proj, Proj proj)
+        : base_(std::move(base)), width_(width), op_(std::move(op)),
+          time_proj_(std::move(time_proj)), proj_(std::move(proj)) {}
+
+    iterator begin() {
+        state_.reset(new State{std::ranges::begin(base_), std::ranges::end(base_),
+                               time_window_aggregator<value_type, Op, time_type>(width_, op_),
+                               time_proj_, proj_});
+        state_->advance();
+        return iterator(state_.get());
+    }
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+};
+
+// 管道适配器：data | sliding_window_agg(k, ops::max{})
+template<typename Op, typename Proj>
+struct sliding_agg_closure {
+    size_t k;
+    Op op;
+    Proj proj;
+
+    template<std::ranges::viewable_range R>
+    friend auto operator|(R&& r, sliding_agg_closure c) {
+        using V = std::views::all_t<R>;
+        return sliding_agg_view<V, Op, Proj>(std::views::all(std::forward<R>(r)), c.k, std::move(c.op),
+                                             std::move(c.proj));
+    }
+};
+
+template<typename Duration, typename Op, typename TimeProj, typename Proj>
+struct time_window_agg_closure {
+    Duration width;
+    Op op;
+    TimeProj time_proj;
+    Proj proj;
+
+    template<std::ranges::viewable_range R>
+    friend auto operator|(R&& r, time_window_agg_closure c) {
+        using V = std::views::all_t<R>;
+        return time_window_agg_view<V, Duration, Op, TimeProj, Proj>(
+            std::views::all(std::forward<R>(r)), c.width, std::move(c.op), std::move(c.time_proj),
+            std::move(c.proj));
+    }
+};
+
+template<typename Op, typename Proj = std::identity>
+auto sliding_window_agg(size_t k, Op op, Proj proj = {}) {
+    return sliding_agg_closure<Op, Proj>{k, std::move(op), std::move(proj)};
+}
+
+template<typename Duration, typename Op, typename TimeProj, typename Proj = std::identity>
+auto sliding_time_window_agg(Duration width, Op op, TimeProj time_proj, Proj proj = {}) {
+    return time_window_agg_closure<Duration, Op, TimeProj, Proj>{width, std::move(op), std::move(time_proj),
+                                                                  std::move(proj)};
+}
+
+} // namespace window_agg
+
+// "2023-01-01T10:00:00" -> sys_seconds，假定格式正确
+inline std::chrono::sys_seconds parse_timestamp(std::string_view text) {
+    auto field = [text](size_t pos, size_t len) {
+        int value = 0;
+        std::from_chars(text.data() + pos, text.data() + pos + len, value);
+        return value;
+    };
+    using namespace std::chrono;
+    sys_days day{year{field(0, 4)} / field(5, 2) / field(8, 2)};
+    return day + hours{field(11, 2)} + minutes{field(14, 2)} + seconds{field(17, 2)};
+}
+
+void demonstrate_sliding_window_agg() {
+    std::cout << "=== 增量滑动窗口聚合演示 ===\n";
+    using namespace window_agg;
+
+    std::vector<int> data = {5, 1, 4, 2, 8, 3, 7, 6, 9, 0};
+    auto print = [](const char* label, auto&& range) {
+        std::cout << label;
+        for (auto v : range) std::cout << " " << v;
+        std::cout << "\n";
+    };
+    print("原始数据:      ", data);
+    print("窗口3的和:     ", data | sliding_window_agg(3, ops::sum{}));
+    print("窗口3的最小值: ", data | sliding_window_agg(3, ops::min{}));
+    print("窗口3的最大值: ", data | sliding_window_agg(3, ops::max{}));
+    print("窗口4的gcd:    ", data | sliding_window_agg(4, [](int a, int b) { return std::gcd(a, b); }));
+
+    // 按时间开窗：传感器1最近2分钟的平均温度
+    std::vector<SensorReading> readings = {
+        {1, 23.5, "2023-01-01T10:00:00", true},
+        {1, 24.1, "2023-01-01T10:01:00", true},
+        {1, 25.3, "2023-01-01T10:02:00", true},
+        {1, 26.0, "2023-01-01T10:02:30", true},
+        {1, 24.8, "2023-01-01T10:05:00", true},
+    };
+    std::cout << "传感器1最近2分钟平均温度:\n";
+    for (auto [t, avg] : readings | sliding_time_window_agg(std::chrono::minutes{2}, ops::mean{},
+                                                            [](const SensorReading& r) { return parse_timestamp(r.timestamp); },
+                                                            &SensorReading::value)) {
+        std::cout << "  截至" << std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count() % 86400
+                  << "s: " << avg << "°C\n";
+    }
+
+    // 长数据流：窗口10^4，与逐窗口重新计算对比
+    constexpr size_t kWindow = 10'000;
+    std::vector<double> stream(200'000);
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    for (double& v : stream) {
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        v = 20.0 + static_cast<double>(rng % 10'000) / 1000.0;
+    }
+
+    auto time_ms = [](auto&& f) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    double naive_sum = 0, naive_max = 0, agg_sum = 0, agg_max = 0;
+    double naive_ms = time_ms([&] {
+        for (size_t i = 0; i + kWindow <= stream.size(); ++i) {
+            auto window = std::ranges::subrange(stream.begin() + i, stream.begin() + i + kWindow);
+            naive_sum += std::accumulate(window.begin(), window.end(), 0.0);
+            naive_max += std::ranges::max(window);
+        }
+    });
+    double agg_ms = time_ms([&] {
+        for (double s : stream | sliding_window_agg(kWindow, ops::sum{})) agg_sum += s;
+        for (double m : stream | sliding_window_agg(kWindow, ops::max{})) agg_max += m;
+    });
+
+    std::cout << "\n" << stream.size() << "个样本, 窗口" << kWindow << ", 求和+最大值:\n";
+    std::cout << "  逐窗口重新计算: " << naive_ms << " ms\n";
+    std::cout << "  增量聚合:       " << agg_ms << " ms (" << naive_ms / agg_ms << "x)\n";
+    std::cout << "  结果一致: "
+              << (std::abs(naive_sum - agg_sum) <= 1e-9 * std::abs(naive_sum) && naive_max == agg_max ? "是" : "否")
+              << "\n";
+
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++20 Ranges函数式编程深度解析\n";
@@ -713,13 +1594,15 @@ int main() {
     demonstrate_enhanced_algorithms();
     demonstrate_constexpr_ranges();
     demonstrate_advanced_pipeline();
+    demonstrate_wheel_sieve();
+    demonstrate_sliding_window_agg();
     
     return 0;
 }
 
 /*
 编译和运行建议:
-g++ -std=c++20 -O2 -Wall 02_ranges.cpp -o ranges
+g++ -std=c++20 -O2 -Wall 02_ranges.cpp -o ranges -pthread
 ./ranges
 
 关键学习点:
@@ -728,10 +1611,15 @@ g++ -std=c++20 -O2 -Wall 02_ranges.cpp -o ranges
 3. 自定义视图通过继承view_interface可以实现复杂的数据处理逻辑
 4. Range算法支持投影，简化了对复杂数据结构的操作
 5. constexpr ranges支持编译期范围计算，提高运行时性能
+6. 素数枚举用分段30轮筛法代替试除，惰性范围逐段生成，段之间相互独立可以并行
+7. 滑动窗口聚合按运算性质选实现：可逆运算维护累加值，最值用单调队列，其余结合律运算用双栈
 
 注意事项:
 - 视图是轻量级对象，但要注意底层数据的生命周期
 - 惰性求值可能导致多次遍历时重复计算，适当时可以转为容器
 - 自定义视图的迭代器需要满足相应的迭代器概念要求
 - 复杂的管道可能影响编译速度，需要权衡可读性和性能
+- prime_range是只能遍历一次的输入范围，迭代器依赖视图内部状态，视图必须比迭代器活得久
+- 段长取L1/L2缓存大小为宜，过大的段会让筛素数的随机写入频繁缺失缓存
+- 双栈聚合要求运算满足结合律，否则结果依赖翻转时机；按时间开窗要求输入按时间有序
 */
\ No newline at end of file
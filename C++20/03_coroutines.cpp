@@ -20,13 +20,241 @@
 #include <optional>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <memory_resource>
+#include <span>
+#include <system_error>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stop_token>
+#include <variant>
+#include <iomanip>
+#include <stdexcept>
+#include <array>
+#include <limits>
+#include <string_view>
+#include <utility>
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+// ===== 协程帧分配：线程局部分级内存池 =====
+// 协程帧默认经全局operator new分配，短命的Generator/Task每次创建都要走一次malloc
+// promise_type声明operator new/delete后，编译器改用它们分配协程帧：
+// 1. operator new(size)：从线程局部的分级空闲链表取块，命中时只是一次链表弹出
+// 2. operator new(size, std::allocator_arg_t, alloc, ...)：协程参数以allocator_arg开头时使用调用方的分配器
+// 3. 每个帧前面有一个FrameHeader，记录帧大小、来源级别和释放方式，operator delete据此归还
+class FramePool {
+public:
+    static constexpr std::size_t kNumClasses = 7;
+    static constexpr std::size_t kClassSizes[kNumClasses] = {64, 128, 256, 512, 1024, 2048, 4096};
+    static constexpr std::size_t kMaxCachedPerClass = 256;  // 跨线程释放时防止某个线程无限囤积
+
+    struct ClassStats {
+        std::size_t allocations = 0;
+        std::size_t hits = 0;          // 直接从空闲链表取到
+        std::size_t cached = 0;        // 当前空闲链表长度
+        std::size_t max_request = 0;   // 该级别见过的最大请求
+    };
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    FreeNode* free_lists_[kNumClasses] = {};
+    ClassStats stats_[kNumClasses];
+    std::size_t oversize_allocations_ = 0;
+    std::size_t max_request_ = 0;
+
+    static int class_of(std::size_t bytes) {
+        for (std::size_t i = 0; i < kNumClasses; ++i) {
+            if (bytes <= kClassSizes[i]) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+public:
+    // 启用后才走空闲链表；关闭时退化为全局operator new，便于对比
+    bool enabled = true;
+
+    static FramePool& local() {
+        thread_local FramePool pool;
+        return pool;
+    }
+
+    FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    ~FramePool() {
+        for (auto*& head : free_lists_) {
+            while (head) {
+                FreeNode* next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+
+    // size_class输出这块内存的来源：池中的级别，或-1表示直接来自全局operator new
+    // 释放时必须原样交回，不能按释放时的enabled重新判断（期间可能切换过开关）
+    void* allocate(std::size_t bytes, int& size_class) {
+        max_request_ = std::max(max_request_, bytes);
+        int cls = enabled ? class_of(bytes) : -1;
+        size_class = cls;
+        if (cls < 0) {
+            ++oversize_allocations_;
+            return ::operator new(bytes);
+        }
+        auto& stats = stats_[cls];
+        ++stats.allocations;
+        stats.max_request = std::max(stats.max_request, bytes);
+        if (FreeNode* node = free_lists_[cls]) {
+            free_lists_[cls] = node->next;
+            --stats.cached;
+            ++stats.hits;
+            return node;
+        }
+        return ::operator new(kClassSizes[cls]);
+    }
+
+    // 块都是独立的::operator new分配，任何线程都可以释放，归还到释放线程的池里
+    void deallocate(void* p, int size_class) noexcept {
+        const int cls = size_class;
+        if (cls < 0 || !enabled || stats_[cls].cached >= kMaxCachedPerClass) {
+            ::operator delete(p);
+            return;
+        }
+        auto* node = static_cast<FreeNode*>(p);
+        node->next = free_lists_[cls];
+        free_lists_[cls] = node;
+        ++stats_[cls].cached;
+    }
+
+    const ClassStats& stats(std::size_t cls) const { return stats_[cls]; }
+    std::size_t oversize_allocations() const { return oversize_allocations_; }
+    std::size_t total_allocations() const {
+        std::size_t total = oversize_allocations_;
+        for (const auto& s : stats_) total += s.allocations;
+        return total;
+    }
+    std::size_t max_request() const { return max_request_; }
+
+    void reset_stats() {
+        for (auto& s : stats_) {
+            s.allocations = s.hits = s.max_request = 0;
+        }
+        oversize_allocations_ = 0;
+        max_request_ = 0;
+    }
+};
+
+// promise_type继承它即可获得池化的帧分配
+struct PooledFrameAllocation {
+    struct alignas(std::max_align_t) FrameHeader {
+        std::size_t frame_size;     // 编译器请求的协程帧大小
+        std::size_t total_size;     // 实际分配的字节数（含头部和分配器）
+        void (*release)(FrameHeader*) noexcept;
+        int size_class;             // 分配时所在的池级别，-1表示不在池中（自定义分配器或全局operator new）
+    };
+
+    static void* operator new(std::size_t size) {
+        std::size_t total = sizeof(FrameHeader) + size;
+        int size_class = -1;
+        void* block = FramePool::local().allocate(total, size_class);
+        auto* header = ::new (block) FrameHeader{size, total, &release_to_pool, size_class};
+        return header + 1;
+    }
+
+    // 自由函数/静态成员协程：f(std::allocator_arg, alloc, args...)
+    template<typename Alloc, typename... Args>
+    static void* operator new(std::size_t size, std::allocator_arg_t, const Alloc& alloc, const Args&...) {
+        return allocate_with(size, alloc);
+    }
+
+    // 非静态成员协程：第一个参数是对象本身
+    template<typename Self, typename Alloc, typename... Args>
+    static void* operator new(std::size_t size, const Self&, std::allocator_arg_t, const Alloc& alloc,
+                              const Args&...) {
+        return allocate_with(size, alloc);
+    }
+
+    static void operator delete(void* frame, std::size_t) noexcept {
+        FrameHeader* header = header_of(frame);
+        header->release(header);
+    }
+
+    static FrameHeader* header_of(void* frame) noexcept {
+        return static_cast<FrameHeader*>(frame) - 1;
+    }
+
+private:
+    static void release_to_pool(FrameHeader* header) noexcept {
+        FramePool::local().deallocate(header, header->size_class);
+    }
+
+    // 布局：[分配器副本][FrameHeader][协程帧]，分配器放在最前面，头部始终紧贴帧
+    // 以FrameHeader为分配单位rebind，保证块按max_align_t对齐（polymorphic_allocator<std::byte>只保证1字节对齐）
+    template<typename Alloc>
+    using UnitAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<FrameHeader>;
+
+    template<typename Alloc>
+    static constexpr std::size_t alloc_slot_size() {
+        constexpr std::size_t align = alignof(FrameHeader);
+        return (sizeof(UnitAlloc<Alloc>) + align - 1) / align * align;
+    }
+
+    template<typename Alloc>
+    static void* allocate_with(std::size_t size, const Alloc& alloc) {
+        UnitAlloc<Alloc> unit_alloc(alloc);
+        std::size_t units = (alloc_slot_size<Alloc>() + sizeof(FrameHeader) + size + sizeof(FrameHeader) - 1)
+                          / sizeof(FrameHeader);
+        auto* block = reinterpret_cast<std::byte*>(
+            std::allocator_traits<UnitAlloc<Alloc>>::allocate(unit_alloc, units));
+        ::new (block) UnitAlloc<Alloc>(std::move(unit_alloc));
+        auto* header = ::new (block + alloc_slot_size<Alloc>())
+            FrameHeader{size, units * sizeof(FrameHeader), &release_with_allocator<Alloc>, -1};
+        return header + 1;
+    }
+
+    template<typename Alloc>
+    static void release_with_allocator(FrameHeader* header) noexcept {
+        std::byte* block = reinterpret_cast<std::byte*>(header) - alloc_slot_size<Alloc>();
+        auto* stored = std::launder(reinterpret_cast<UnitAlloc<Alloc>*>(block));
+        UnitAlloc<Alloc> unit_alloc(std::move(*stored));
+        std::destroy_at(stored);
+        std::allocator_traits<UnitAlloc<Alloc>>::deallocate(
+            unit_alloc, reinterpret_cast<FrameHeader*>(block), header->total_size / sizeof(FrameHeader));
+    }
+};
 
 // ===== 1. 协程三关键字演示 =====
 // 简单的Generator实现
 template<typename T>
 class Generator {
 public:
-    struct promise_type {
+    struct promise_type : PooledFrameAllocation {
         T current_value;
         
         Generator get_return_object() {
@@ -88,6 +316,10 @@ public:
     bool done() const {
         return !handle_ || handle_.done();
     }
+    
+    std::coroutine_handle<promise_type> get_handle() const {
+        return handle_;
+    }
 };
 
 // co_yield示例：斐波那契数列生成器
@@ -137,16 +369,31 @@ void demonstrate_coroutine_keywords() {
 template<typename T>
 class Task {
 public:
-    struct promise_type {
+    struct promise_type : PooledFrameAllocation {
         std::optional<T> result_;
         std::exception_ptr exception_;
+        // co_await该Task的协程；结束时被替换为promise自身的地址作为"已完成"标记
+        std::atomic<void*> continuation_{nullptr};
         
         Task get_return_object() {
             return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
         }
         
         std::suspend_never initial_suspend() { return {}; }  // 立即开始执行
-        std::suspend_always final_suspend() noexcept { return {}; }  // 在结束时暂停
+        
+        // 在结束时暂停；若已有协程在co_await本任务，直接对称转移过去
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    auto& promise = h.promise();
+                    void* waiter = promise.continuation_.exchange(&promise, std::memory_order_acq_rel);
+                    return waiter ? std::coroutine_handle<>::from_address(waiter) : std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+            return FinalAwaiter{};
+        }
         
         void return_value(T value) {
             result_ = std::move(value);
@@ -216,6 +463,29 @@ public:
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
     }
+    
+    std::coroutine_handle<promise_type> get_handle() const {
+        return handle_;
+    }
+    
+    // co_await task：不阻塞线程，任务完成时由final_suspend恢复等待者
+    auto operator co_await() noexcept {
+        struct TaskAwaiter {
+            Task& task;
+            bool await_ready() const noexcept {
+                auto& promise = task.handle_.promise();
+                return promise.continuation_.load(std::memory_order_acquire) == &promise;
+            }
+            bool await_suspend(std::coroutine_handle<> waiter) noexcept {
+                void* expected = nullptr;
+                // 登记失败说明任务刚好完成，不挂起直接继续
+                return task.handle_.promise().continuation_.compare_exchange_strong(
+                    expected, waiter.address(), std::memory_order_acq_rel);
+            }
+            T await_resume() { return task.get_result(); }
+        };
+        return TaskAwaiter{*this};
+    }
 };
 
 // co_return示例：异步计算任务
@@ -447,16 +717,42 @@ public:
             
             // 协程帧大小估算（仅用于演示）
             std::cout << "  Promise大小: " << sizeof(Promise) << " 字节\n";
+            if constexpr (std::is_base_of_v<PooledFrameAllocation, Promise>) {
+                std::cout << "  协程帧大小: " << frame_size(handle) << " 字节\n";
+            }
         }
         std::cout << "\n";
     }
+    
+    // 池化分配的协程帧头部记录了编译器请求的真实大小
+    template<typename Promise>
+    static std::size_t frame_size(const std::coroutine_handle<Promise>& handle) {
+        static_assert(std::is_base_of_v<PooledFrameAllocation, Promise>, "需要池化分配的promise_type");
+        return handle ? PooledFrameAllocation::header_of(handle.address())->frame_size : 0;
+    }
+    
+    // 当前线程帧池各级别的命中率，用来调整级别划分和缓存上限
+    static void report_frame_pool() {
+        const auto& pool = FramePool::local();
+        std::cout << "帧池统计(当前线程):\n";
+        std::cout << "  级别(字节)\t分配次数\t命中率\t最大请求\t缓存块数\n";
+        for (std::size_t i = 0; i < FramePool::kNumClasses; ++i) {
+            const auto& s = pool.stats(i);
+            if (s.allocations == 0 && s.cached == 0) continue;
+            double hit_rate = s.allocations ? 100.0 * static_cast<double>(s.hits) / static_cast<double>(s.allocations) : 0.0;
+            std::cout << "  " << FramePool::kClassSizes[i] << "\t\t" << s.allocations << "\t\t"
+                      << hit_rate << "%\t" << s.max_request << "\t\t" << s.cached << "\n";
+        }
+        std::cout << "  超出最大级别: " << pool.oversize_allocations() << " 次, 最大请求: "
+                  << pool.max_request() << " 字节\n";
+    }
 };
 
 // 带状态跟踪的Generator
 template<typename T>
 class TrackedGenerator {
 public:
-    struct promise_type {
+    struct promise_type : PooledFrameAllocation {
         T current_value;
         int yield_count = 0;
         std::string debug_info;
@@ -577,6 +873,410 @@ void demonstrate_coroutine_frame_management() {
 }
 
 // ===== 5. 异步编程模式演示 =====
+// 真实异步I/O后端：Linux上是io_uring，Windows上是重叠I/O + IOCP，其他平台退化为同步pread
+// Linux上io_uring不可用时（旧内核ENOSYS、容器/seccomp禁用EPERM）同样退回同步pread
+// IoContext是单线程事件循环：协程co_await ctx.read(...)后挂起，run()收割完成事件并恢复协程，
+// 因此一个线程就能同时挂着几百个读请求
+struct IoOperation {
+#if defined(_WIN32)
+    OVERLAPPED overlapped{};  // 必须是第一个成员，完成事件通过它找回IoOperation
+#endif
+    std::coroutine_handle<> handle;
+    std::intptr_t file = -1;
+    std::byte* buffer = nullptr;
+    std::uint32_t length = 0;
+    std::uint64_t offset = 0;
+    int buffer_index = -1;    // >=0 表示读入已注册缓冲区
+    int result = 0;           // 读取字节数，出错时为 -errno
+};
+
+class IoContext {
+public:
+    explicit IoContext(unsigned entries = 256);
+    ~IoContext();
+
+    IoContext(const IoContext&) = delete;
+    IoContext& operator=(const IoContext&) = delete;
+
+    // co_await ctx.read(file, buffer, offset)：返回读取字节数(0表示EOF)或-errno
+    auto read(std::intptr_t file, std::span<std::byte> buffer, std::uint64_t offset, int buffer_index = -1) {
+        struct ReadAwaitable {
+            IoContext& ctx;
+            IoOperation op;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) {
+                op.handle = h;
+                ctx.submit(&op);
+            }
+            int await_resume() const noexcept { return op.result; }
+        };
+        IoOperation op;
+        op.file = file;
+        op.buffer = buffer.data();
+        op.length = static_cast<std::uint32_t>(std::min<std::size_t>(buffer.size(), UINT32_MAX));
+        op.offset = offset;
+        op.buffer_index = buffer_index;
+        return ReadAwaitable{*this, op};
+    }
+
+    // 预先注册缓冲区：io_uring用READ_FIXED省去每次读取时的页面固定；其他后端忽略
+    bool register_buffers(std::span<const std::span<std::byte>> buffers);
+    void unregister_buffers();
+
+    // 把文件句柄关联到本上下文（IOCP需要，io_uring不需要）
+    void attach(std::intptr_t file);
+
+    // 驱动事件循环直到没有进行中的请求
+    void run();
+
+    std::size_t in_flight() const { return in_flight_; }
+
+    // 实际使用的后端，以及Linux上未能启用io_uring的原因
+    const char* backend_name() const;
+    const std::string& fallback_reason() const { return fallback_reason_; }
+
+private:
+    void submit(IoOperation* op);
+    void start(IoOperation* op);
+#if !defined(_WIN32)
+    void start_pread(IoOperation* op);
+    void run_pread();
+#endif
+
+    std::size_t capacity_ = 0;
+    std::size_t in_flight_ = 0;
+    std::deque<IoOperation*> backlog_;   // 超出队列深度的请求先排队
+    std::deque<IoOperation*> completed_; // 同步完成的请求，等run()统一恢复
+    std::string fallback_reason_;
+
+#if defined(__linux__)
+    bool uring_ = false;
+    int ring_fd_ = -1;
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    std::size_t sq_len_ = 0;
+    std::size_t cq_len_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_len_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned to_submit_ = 0;
+    bool buffers_registered_ = false;
+
+    void setup_uring(unsigned entries);
+    void release_uring() noexcept;
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0));
+    }
+#elif defined(_WIN32)
+    HANDLE port_ = nullptr;
+#endif
+};
+
+#if defined(__linux__)
+IoContext::IoContext(unsigned entries) : capacity_(entries) {
+    try {
+        setup_uring(entries);
+        uring_ = true;
+    } catch (const std::system_error& e) {
+        fallback_reason_ = e.what();
+    }
+}
+
+const char* IoContext::backend_name() const { return uring_ ? "io_uring" : "同步pread回退"; }
+
+// 失败时抛出std::system_error，已建立的映射和ring_fd_全部释放
+void IoContext::setup_uring(unsigned entries) {
+    io_uring_params params{};
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0) {
+        int err = errno;
+        ring_fd_ = -1;
+        throw std::system_error(err, std::system_category(), "io_uring_setup");
+    }
+    capacity_ = params.sq_entries;
+
+    sq_len_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_len_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_len_ = cq_len_ = std::max(sq_len_, cq_len_);
+    }
+    auto map_ring = [this](std::size_t length, off_t offset) {
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+        if (p == MAP_FAILED) {
+            int err = errno;
+            release_uring();
+            throw std::system_error(err, std::system_category(), "io_uring mmap");
+        }
+        return p;
+    };
+    sq_ptr_ = map_ring(sq_len_, IORING_OFF_SQ_RING);
+    cq_ptr_ = single_mmap ? sq_ptr_ : map_ring(cq_len_, IORING_OFF_CQ_RING);
+    sqes_len_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(map_ring(sqes_len_, IORING_OFF_SQES));
+
+    auto* sq = static_cast<char*>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    auto* cq = static_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+IoContext::~IoContext() { release_uring(); }
+
+void IoContext::release_uring() noexcept {
+    if (sqes_) munmap(sqes_, sqes_len_);
+    if (cq_ptr_ && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_len_);
+    if (sq_ptr_) munmap(sq_ptr_, sq_len_);
+    if (ring_fd_ >= 0) ::close(ring_fd_);
+    sqes_ = nullptr;
+    sq_ptr_ = cq_ptr_ = nullptr;
+    ring_fd_ = -1;
+}
+
+bool IoContext::register_buffers(std::span<const std::span<std::byte>> buffers) {
+    if (!uring_) return false;
+    std::vector<iovec> iovecs;
+    for (auto b : buffers) iovecs.push_back(iovec{b.data(), b.size()});
+    int ret = static_cast<int>(syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS,
+                                       iovecs.data(), static_cast<unsigned>(iovecs.size())));
+    buffers_registered_ = ret == 0;
+    return buffers_registered_;
+}
+
+void IoContext::unregister_buffers() {
+    if (buffers_registered_) {
+        syscall(__NR_io_uring_register, ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        buffers_registered_ = false;
+    }
+}
+
+void IoContext::attach(std::intptr_t) {}
+
+void IoContext::start(IoOperation* op) {
+    if (!uring_) {
+        start_pread(op);
+        return;
+    }
+    // 只有本线程写sq_tail，内核只写sq_head；in_flight_不超过队列深度，所以这里一定有空位
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    bool fixed = op->buffer_index >= 0 && buffers_registered_;
+    sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = static_cast<int>(op->file);
+    sqe->addr = reinterpret_cast<std::uint64_t>(op->buffer);
+    sqe->len = op->length;
+    sqe->off = op->offset;
+    if (fixed) sqe->buf_index = static_cast<std::uint16_t>(op->buffer_index);
+    sqe->user_data = reinterpret_cast<std::uint64_t>(op);
+    sq_array_[index] = index;
+    std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+    ++to_submit_;
+}
+
+void IoContext::run() {
+    if (!uring_) {
+        run_pread();
+        return;
+    }
+    while (in_flight_ > 0 || !backlog_.empty() || !completed_.empty()) {
+        while (!backlog_.empty() && in_flight_ < capacity_) {
+            IoOperation* op = backlog_.front();
+            backlog_.pop_front();
+            ++in_flight_;
+            start(op);
+        }
+        if (in_flight_ > 0) {
+            int ret = enter(to_submit_, 1, IORING_ENTER_GETEVENTS);
+            if (ret < 0 && errno != EINTR) {
+                throw std::system_error(errno, std::system_category(), "io_uring_enter");
+            }
+            if (ret > 0) to_submit_ -= std::min<unsigned>(to_submit_, static_cast<unsigned>(ret));
+        }
+        // 先把本批完成事件取出并归还CQ槽位，再恢复协程（恢复过程中可能继续提交）
+        unsigned head = *cq_head_;
+        unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+            auto* op = reinterpret_cast<IoOperation*>(cqe.user_data);
+            op->result = cqe.res;
+            completed_.push_back(op);
+            ++head;
+            --in_flight_;
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+        while (!completed_.empty()) {
+            IoOperation* op = completed_.front();
+            completed_.pop_front();
+            op->handle.resume();
+        }
+    }
+}
+#elif defined(_WIN32)
+IoContext::IoContext(unsigned entries) : capacity_(entries) {
+    port_ = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if (!port_) {
+        throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "CreateIoCompletionPort");
+    }
+}
+
+IoContext::~IoContext() { CloseHandle(port_); }
+
+const char* IoContext::backend_name() const { return "重叠I/O + IOCP"; }
+
+// IOCP没有与READ_FIXED对应的机制（RIO只支持socket），已注册缓冲区按普通缓冲区读取
+bool IoContext::register_buffers(std::span<const std::span<std::byte>>) { return false; }
+void IoContext::unregister_buffers() {}
+
+void IoContext::attach(std::intptr_t file) {
+    CreateIoCompletionPort(reinterpret_cast<HANDLE>(file), port_, 0, 0);
+}
+
+void IoContext::start(IoOperation* op) {
+    op->overlapped = OVERLAPPED{};
+    op->overlapped.Offset = static_cast<DWORD>(op->offset);
+    op->overlapped.OffsetHigh = static_cast<DWORD>(op->offset >> 32);
+    if (!ReadFile(reinterpret_cast<HANDLE>(op->file), op->buffer, op->length, nullptr, &op->overlapped)) {
+        DWORD err = GetLastError();
+        if (err != ERROR_IO_PENDING) {
+            // 没有排队到IOCP，不会有完成事件
+            op->result = err == ERROR_HANDLE_EOF ? 0 : -static_cast<int>(err);
+            --in_flight_;
+            completed_.push_back(op);
+        }
+    }
+}
+
+void IoContext::run() {
+    OVERLAPPED_ENTRY entries[64];
+    while (in_flight_ > 0 || !backlog_.empty() || !completed_.empty()) {
+        while (!backlog_.empty() && in_flight_ < capacity_) {
+            IoOperation* op = backlog_.front();
+            backlog_.pop_front();
+            ++in_flight_;
+            start(op);
+        }
+        if (in_flight_ > 0) {
+            ULONG count = 0;
+            if (GetQueuedCompletionStatusEx(port_, entries, 64, &count, INFINITE, FALSE)) {
+                for (ULONG i = 0; i < count; ++i) {
+                    auto* op = reinterpret_cast<IoOperation*>(entries[i].lpOverlapped);
+                    // Internal保存NTSTATUS，读到文件末尾时不是0
+                    op->result = op->overlapped.Internal == 0
+                                     ? static_cast<int>(entries[i].dwNumberOfBytesTransferred) : 0;
+                    --in_flight_;
+                    completed_.push_back(op);
+                }
+            }
+        }
+        while (!completed_.empty()) {
+            IoOperation* op = completed_.front();
+            completed_.pop_front();
+            op->handle.resume();
+        }
+    }
+}
+#else
+IoContext::IoContext(unsigned entries) : capacity_(entries) {}
+IoContext::~IoContext() = default;
+const char* IoContext::backend_name() const { return "同步pread回退"; }
+bool IoContext::register_buffers(std::span<const std::span<std::byte>>) { return false; }
+void IoContext::unregister_buffers() {}
+void IoContext::attach(std::intptr_t) {}
+void IoContext::start(IoOperation* op) { start_pread(op); }
+void IoContext::run() { run_pread(); }
+#endif
+
+#if !defined(_WIN32)
+// 通用回退：提交时同步pread，run()负责恢复
+void IoContext::start_pread(IoOperation* op) {
+    ssize_t n = ::pread(static_cast<int>(op->file), op->buffer, op->length, static_cast<off_t>(op->offset));
+    op->result = n < 0 ? -errno : static_cast<int>(n);
+    --in_flight_;
+    completed_.push_back(op);
+}
+
+void IoContext::run_pread() {
+    while (!backlog_.empty() || !completed_.empty()) {
+        while (!backlog_.empty()) {
+            IoOperation* op = backlog_.front();
+            backlog_.pop_front();
+            ++in_flight_;
+            start(op);
+        }
+        while (!completed_.empty()) {
+            IoOperation* op = completed_.front();
+            completed_.pop_front();
+            op->handle.resume();
+        }
+    }
+}
+#endif
+
+void IoContext::submit(IoOperation* op) {
+    // 队列深度限制在SQ大小以内，CQ就不会溢出
+    if (in_flight_ < capacity_) {
+        ++in_flight_;
+        start(op);
+    } else {
+        backlog_.push_back(op);
+    }
+}
+
+// 只读文件句柄的RAII封装
+class AsyncFile {
+private:
+    std::intptr_t handle_ = -1;
+
+public:
+    AsyncFile(IoContext& ctx, const std::string& path) {
+#if defined(_WIN32)
+        HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_OVERLAPPED, nullptr);
+        if (h == INVALID_HANDLE_VALUE) {
+            throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "打开 " + path);
+        }
+        handle_ = reinterpret_cast<std::intptr_t>(h);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::system_category(), "打开 " + path);
+        }
+        handle_ = fd;
+#endif
+        ctx.attach(handle_);
+    }
+
+    ~AsyncFile() {
+        if (handle_ == -1) return;
+#if defined(_WIN32)
+        CloseHandle(reinterpret_cast<HANDLE>(handle_));
+#else
+        ::close(static_cast<int>(handle_));
+#endif
+    }
+
+    AsyncFile(const AsyncFile&) = delete;
+    AsyncFile& operator=(const AsyncFile&) = delete;
+
+    std::intptr_t native_handle() const { return handle_; }
+};
+
 // 异步文件处理模拟
 class AsyncFileProcessor {
 public:
@@ -614,34 +1314,91 @@ public:
         
         co_return result;
     }
+    
+    // 真实读取：内容直接落在调用方提供的缓冲区里，FileView只是视图，不复制到std::string
+    struct FileView {
+        std::string filename;
+        std::span<const std::byte> content;
+        size_t size;
+    };
+    
+    // buffer_index >= 0 时buffer必须位于ctx已注册的第buffer_index块缓冲区内
+    static Task<FileView> read_file_async(IoContext& ctx, const std::string& filename,
+                                          std::span<std::byte> buffer, int buffer_index = -1) {
+        AsyncFile file(ctx, filename);
+        std::size_t total = 0;
+        while (total < buffer.size()) {
+            int n = co_await ctx.read(file.native_handle(), buffer.subspan(total), total, buffer_index);
+            if (n < 0) {
+                throw std::system_error(-n, std::system_category(), "读取 " + filename);
+            }
+            if (n == 0) break;  // EOF
+            total += static_cast<std::size_t>(n);
+        }
+        co_return FileView{filename, buffer.first(total), total};
+    }
 };
 
-// 异步管道处理
+// 单线程重叠读取：先为每个文件发起读请求（协程在第一次co_await处挂起），再由ctx.run()统一驱动
+// 每个文件占用arena中slot_size字节，读取结果只是指向arena的视图
+std::vector<AsyncFileProcessor::FileView> process_files_overlapped(IoContext& ctx,
+                                                                   const std::vector<std::string>& paths,
+                                                                   std::span<std::byte> arena,
+                                                                   std::size_t slot_size,
+                                                                   int buffer_index = -1) {
+    std::vector<Task<AsyncFileProcessor::FileView>> tasks;
+    tasks.reserve(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        tasks.push_back(AsyncFileProcessor::read_file_async(ctx, paths[i], arena.subspan(i * slot_size, slot_size),
+                                                            buffer_index));
+    }
+    ctx.run();
+
+    std::vector<AsyncFileProcessor::FileView> views;
+    views.reserve(tasks.size());
+    for (auto& task : tasks) {
+        views.push_back(task.get_result());
+    }
+    return views;
+}
+
+// 异步管道处理：先通过IoContext重叠读取所有文件，再逐个co_await处理协程
 VoidTask process_multiple_files() {
-    std::vector<std::string> filenames = {"file1.txt", "file2.txt", "file3.txt"};
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "cpp20_coroutine_pipeline";
+    fs::create_directories(dir);
+    std::vector<std::string> paths;
+    for (const char* name : {"file1.txt", "file2.txt", "file3.txt"}) {
+        paths.push_back((dir / name).string());
+        std::ofstream(paths.back(), std::ios::binary) << "这是文件 " << name << " 的内容\n包含一些重要数据";
+    }
     
     std::cout << "开始处理多个文件...\n";
     
-    for (const auto& filename : filenames) {
-        // 异步读取文件
-        auto read_task = AsyncFileProcessor::read_file_async(filename);
-        read_task.wait();
+    constexpr std::size_t slot_size = 4096;
+    std::vector<std::byte> arena(paths.size() * slot_size);
+    IoContext ctx;
+    try {
+        auto views = process_files_overlapped(ctx, paths, arena, slot_size);
+        std::cout << "重叠读取完成: " << views.size() << " 个文件 (后端: " << ctx.backend_name() << ")\n";
         
-        try {
-            auto file_data = read_task.get_result();
+        for (const auto& view : views) {
+            AsyncFileProcessor::FileData file_data{fs::path(view.filename).filename().string(),
+                                                   std::string(reinterpret_cast<const char*>(view.content.data()), view.size),
+                                                   view.size};
             
             // 异步处理文件
             auto process_task = AsyncFileProcessor::process_file_async(file_data);
-            process_task.wait();
-            
-            auto result = process_task.get_result();
+            auto result = co_await process_task;
             std::cout << "最终结果: " << result << "\n\n";
-            
-        } catch (const std::exception& e) {
-            std::cout << "处理文件 " << filename << " 时出错: " << e.what() << "\n";
         }
+    } catch (const std::exception& e) {
+        std::cout << "处理文件时出错: " << e.what() << "\n";
     }
     
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    
     std::cout << "所有文件处理完成\n";
 }
 
@@ -754,6 +1511,1517 @@ void demonstrate_async_patterns() {
     std::cout << "\n";
 }
 
+// ===== 6. 协程调度器：时间轮 + 就绪队列 =====
+// TimerAwaitable为每次等待创建一个线程，AsyncFileProcessor直接阻塞调用线程
+// 调度器把"等待"变成"登记定时器后返回"：挂起的协程只占用一个协程帧，不占用线程
+
+// 单层哈希时间轮：槽位按deadline_tick取模，超过一圈的条目留在槽内等待下一圈
+class TimerWheel {
+public:
+    using clock = std::chrono::steady_clock;
+    static constexpr std::chrono::milliseconds kTick{1};
+    static constexpr std::size_t kSlots = 1024;
+
+private:
+    struct Entry {
+        std::coroutine_handle<> handle;
+        std::uint64_t deadline_tick;
+    };
+
+    std::vector<std::vector<Entry>> slots_;
+    clock::time_point origin_;
+    std::uint64_t current_tick_ = 0;
+    std::size_t size_ = 0;
+
+    std::uint64_t tick_of(clock::time_point tp) const {
+        if (tp <= origin_) return 0;
+        // 向上取整：定时器宁可晚一个tick触发，也不能提前
+        auto ticks = (tp - origin_ + kTick - clock::duration(1)) / kTick;
+        return static_cast<std::uint64_t>(ticks);
+    }
+
+public:
+    TimerWheel() : slots_(kSlots), origin_(clock::now()) {}
+
+    // 返回false表示已经到期，调用方应直接放入就绪队列
+    bool add(std::coroutine_handle<> handle, clock::time_point deadline) {
+        std::uint64_t tick = tick_of(deadline);
+        if (tick <= current_tick_) return false;
+        slots_[tick % kSlots].push_back(Entry{handle, tick});
+        ++size_;
+        return true;
+    }
+
+    // 推进到now，把到期的句柄追加到expired
+    void advance(clock::time_point now, std::vector<std::coroutine_handle<>>& expired) {
+        std::uint64_t target = tick_of(now);
+        // 空轮可以直接跳到目标tick，不必逐槽扫描
+        if (size_ == 0) {
+            current_tick_ = std::max(current_tick_, target);
+            return;
+        }
+        while (current_tick_ < target) {
+            ++current_tick_;
+            auto& slot = slots_[current_tick_ % kSlots];
+            for (std::size_t i = 0; i < slot.size();) {
+                if (slot[i].deadline_tick <= current_tick_) {
+                    expired.push_back(slot[i].handle);
+                    slot[i] = slot.back();
+                    slot.pop_back();
+                    --size_;
+                } else {
+                    ++i;
+                }
+            }
+        }
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+};
+
+class CoroutineScheduler {
+private:
+    using clock = TimerWheel::clock;
+
+    std::mutex ready_mtx_;
+    std::condition_variable ready_cv_;
+    std::deque<std::coroutine_handle<>> ready_;
+
+    std::mutex timer_mtx_;
+    std::condition_variable timer_cv_;
+    TimerWheel wheel_;
+
+    // 两个标志分别由各自的互斥量保护
+    bool timers_stopping_ = false;
+    bool workers_stopping_ = false;
+    std::vector<std::thread> workers_;
+    std::thread timer_thread_;
+
+    void worker_loop() {
+        while (true) {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock<std::mutex> lock(ready_mtx_);
+                ready_cv_.wait(lock, [this] { return workers_stopping_ || !ready_.empty(); });
+                if (ready_.empty()) return;  // 已停止且已排空
+                handle = ready_.front();
+                ready_.pop_front();
+            }
+            handle.resume();
+        }
+    }
+
+    void timer_loop() {
+        std::vector<std::coroutine_handle<>> expired;
+        std::unique_lock<std::mutex> lock(timer_mtx_);
+        while (true) {
+            if (wheel_.empty()) {
+                if (timers_stopping_) return;
+                timer_cv_.wait(lock, [this] { return timers_stopping_ || !wheel_.empty(); });
+                continue;
+            }
+            // 有活跃定时器时按tick推进；空闲时不消耗CPU
+            timer_cv_.wait_for(lock, TimerWheel::kTick);
+            wheel_.advance(clock::now(), expired);
+            if (!expired.empty()) {
+                lock.unlock();
+                post_batch(expired);
+                expired.clear();
+                lock.lock();
+            }
+        }
+    }
+
+    void post_batch(const std::vector<std::coroutine_handle<>>& handles) {
+        {
+            std::lock_guard<std::mutex> lock(ready_mtx_);
+            ready_.insert(ready_.end(), handles.begin(), handles.end());
+        }
+        ready_cv_.notify_all();
+    }
+
+public:
+    explicit CoroutineScheduler(std::size_t num_workers) {
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+        timer_thread_ = std::thread([this] { timer_loop(); });
+    }
+
+    // 析构时等待所有定时器触发、所有就绪协程执行完毕
+    ~CoroutineScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(timer_mtx_);
+            timers_stopping_ = true;
+        }
+        timer_cv_.notify_all();
+        timer_thread_.join();
+        {
+            std::lock_guard<std::mutex> lock(ready_mtx_);
+            workers_stopping_ = true;
+        }
+        ready_cv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+    CoroutineScheduler(const CoroutineScheduler&) = delete;
+    CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(ready_mtx_);
+            ready_.push_back(handle);
+        }
+        ready_cv_.notify_one();
+    }
+
+    // co_await sched.schedule()：把当前协程转移到调度器的工作线程上
+    auto schedule() {
+        struct ScheduleAwaitable {
+            CoroutineScheduler& sched;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { sched.post(h); }
+            void await_resume() const noexcept {}
+        };
+        return ScheduleAwaitable{*this};
+    }
+
+    // co_await sched.sleep_for(d)：登记定时器后立即让出线程
+    auto sleep_for(clock::duration duration) {
+        struct SleepAwaitable {
+            CoroutineScheduler& sched;
+            clock::time_point deadline;
+            bool await_ready() const noexcept { return deadline <= clock::now(); }
+            void await_suspend(std::coroutine_handle<> h) {
+                // add()发布h之后，定时线程可能立刻恢复并销毁协程帧，本awaitable也随之失效；
+                // 之后只能使用拷贝到栈上的调度器指针，不能再访问任何成员
+                CoroutineScheduler* const scheduler = &sched;
+                bool registered;
+                {
+                    std::lock_guard<std::mutex> lock(scheduler->timer_mtx_);
+                    registered = scheduler->wheel_.add(h, deadline);
+                }
+                if (registered) {
+                    scheduler->timer_cv_.notify_one();
+                } else {
+                    scheduler->post(h);
+                }
+            }
+            void await_resume() const noexcept {}
+        };
+        return SleepAwaitable{*this, clock::now() + duration};
+    }
+
+    std::size_t pending_timers() {
+        std::lock_guard<std::mutex> lock(timer_mtx_);
+        return wheel_.size();
+    }
+};
+
+// 定时任务：每次醒来记录"实际唤醒时间 - 期望时间"作为定时延迟
+struct TimerLatencyStats {
+    std::mutex mtx;
+    std::vector<long long> lateness_us;
+
+    void record(std::chrono::steady_clock::duration late) {
+        std::lock_guard<std::mutex> lock(mtx);
+        lateness_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(late).count());
+    }
+
+    std::pair<long long, long long> p50_p99() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (lateness_us.empty()) return {0, 0};
+        std::sort(lateness_us.begin(), lateness_us.end());
+        return {lateness_us[lateness_us.size() / 2], lateness_us[lateness_us.size() * 99 / 100]};
+    }
+};
+
+VoidTask scheduled_timed_task(CoroutineScheduler& sched, int rounds, std::chrono::milliseconds interval,
+                              TimerLatencyStats& stats, std::atomic<int>& remaining) {
+    co_await sched.schedule();
+    for (int i = 0; i < rounds; ++i) {
+        auto expected = std::chrono::steady_clock::now() + interval;
+        co_await sched.sleep_for(interval);
+        stats.record(std::chrono::steady_clock::now() - expected);
+    }
+    if (remaining.fetch_sub(1) == 1) {
+        remaining.notify_all();
+    }
+}
+
+// 对照组：原有TimerAwaitable，每次等待占用一个线程
+VoidTask blocking_timed_task(int rounds, std::chrono::milliseconds interval, TimerLatencyStats& stats) {
+    for (int i = 0; i < rounds; ++i) {
+        auto expected = std::chrono::steady_clock::now() + interval;
+        co_await sleep_for(interval);
+        stats.record(std::chrono::steady_clock::now() - expected);
+    }
+}
+
+void wait_until_zero(std::atomic<int>& remaining) {
+    for (int v = remaining.load(); v != 0; v = remaining.load()) {
+        remaining.wait(v);
+    }
+}
+
+void demonstrate_coroutine_scheduler() {
+    std::cout << "=== 协程调度器演示 ===\n";
+
+    const int rounds = 5;
+    const auto interval = std::chrono::milliseconds(20);
+    const int task_counts[] = {100, 1000, 4000};
+
+    std::cout << "每个任务sleep " << rounds << " 次, 每次 " << interval.count() << "ms\n";
+    std::cout << "任务数\t方案\t\t\t耗时(ms)\t延迟p50(μs)\t延迟p99(μs)\n";
+
+    for (int task_count : task_counts) {
+        // 调度器：4个工作线程 + 1个定时器线程承载全部任务
+        {
+            TimerLatencyStats stats;
+            std::atomic<int> remaining{task_count};
+            auto start = std::chrono::steady_clock::now();
+            // tasks在调度器之外声明：调度器析构先join工作线程，协程帧随后才销毁
+            std::vector<VoidTask> tasks;
+            tasks.reserve(task_count);
+            {
+                CoroutineScheduler sched(4);
+                for (int i = 0; i < task_count; ++i) {
+                    tasks.push_back(scheduled_timed_task(sched, rounds, interval, stats, remaining));
+                }
+                wait_until_zero(remaining);
+            }
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            auto [p50, p99] = stats.p50_p99();
+            std::cout << task_count << "\t时间轮调度器(5线程)\t" << ms << "\t\t" << p50 << "\t\t" << p99 << "\n";
+        }
+
+        // 原方案：并发等待数 = 并发线程数
+        {
+            TimerLatencyStats stats;
+            auto start = std::chrono::steady_clock::now();
+            std::vector<VoidTask> tasks;
+            tasks.reserve(task_count);
+            for (int i = 0; i < task_count; ++i) {
+                tasks.push_back(blocking_timed_task(rounds, interval, stats));
+            }
+            // 最后一次resume发生在detach线程上，必须等协程到达final_suspend才能销毁帧
+            for (auto& task : tasks) {
+                task.wait();
+            }
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            auto [p50, p99] = stats.p50_p99();
+            std::cout << task_count << "\t每次等待一个线程(" << task_count << ")\t" << ms << "\t\t"
+                      << p50 << "\t\t" << p99 << "\n";
+        }
+    }
+
+    std::cout << "\n要点:\n";
+    std::cout << "- 等待中的协程只是时间轮里的一个句柄，几千个定时任务只需几个线程\n";
+    std::cout << "- 时间轮插入O(1)，精度受tick(1ms)限制\n";
+    std::cout << "- 线程方案的延迟主要来自线程创建和调度，任务数越多越明显\n";
+
+    std::cout << "\n";
+}
+
+// ===== 7. 协程帧池化分配 =====
+// 固定大小的短命协程：池命中后创建成本只剩一次链表弹出
+Generator<int> small_counter(int n) {
+    for (int i = 0; i < n; ++i) {
+        co_yield i;
+    }
+}
+
+// allocator_arg约定：调用方决定帧放在哪里，例如放进一块单调增长的arena
+Generator<int> arena_counter(std::allocator_arg_t, const std::pmr::polymorphic_allocator<std::byte>&, int n) {
+    for (int i = 0; i < n; ++i) {
+        co_yield i;
+    }
+}
+
+template<typename Factory>
+double measure_frame_churn(std::size_t count, Factory make) {
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        auto gen = make(static_cast<int>(i & 3) + 1);
+        while (gen.move_next()) {
+            sum += gen.current_value();
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (sum < 0) std::cout << sum;  // 防止循环被优化掉
+    return elapsed / static_cast<double>(count);
+}
+
+void demonstrate_frame_pool() {
+    std::cout << "=== 协程帧池化分配演示 ===\n";
+
+    // 1. 各类协程的帧大小：决定它们落在哪个级别
+    {
+        auto fib = fibonacci_generator(10);
+        auto range = range_generator(0, 10);
+        auto task = format_result_async(42);
+        auto tracked = tracked_sequence(0, 3);
+        std::cout << "协程帧大小:\n";
+        std::cout << "  fibonacci_generator: " << CoroutineInspector::frame_size(fib.get_handle()) << " 字节\n";
+        std::cout << "  range_generator:     " << CoroutineInspector::frame_size(range.get_handle()) << " 字节\n";
+        std::cout << "  format_result_async: " << CoroutineInspector::frame_size(task.get_handle()) << " 字节\n";
+        std::cout << "  tracked_sequence:    " << CoroutineInspector::frame_size(tracked.get_handle()) << " 字节\n";
+    }
+
+    // 2. 反复创建/销毁同尺寸协程：池开启与关闭对比
+    constexpr std::size_t count = 200'000;
+    auto& pool = FramePool::local();
+
+    pool.enabled = false;
+    double global_ns = measure_frame_churn(count, small_counter);
+    pool.enabled = true;
+    pool.reset_stats();
+    double pooled_ns = measure_frame_churn(count, small_counter);
+
+    std::cout << "\n创建+遍历+销毁 " << count << " 个小Generator:\n";
+    std::cout << "  全局operator new: " << global_ns << " ns/个\n";
+    std::cout << "  线程局部帧池:     " << pooled_ns << " ns/个\n";
+    CoroutineInspector::report_frame_pool();
+
+    // 3. allocator_arg：帧分配绕过线程池，全部落在arena里
+    std::byte buffer[16 * 1024];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    std::pmr::polymorphic_allocator<std::byte> alloc(&arena);
+    pool.reset_stats();
+    int arena_sum = 0;
+    for (int i = 0; i < 16; ++i) {
+        auto gen = arena_counter(std::allocator_arg, alloc, 4);
+        while (gen.move_next()) {
+            arena_sum += gen.current_value();
+        }
+    }
+    std::cout << "arena中运行16个协程: 求和=" << arena_sum
+              << ", 帧池分配次数=" << pool.total_allocations() << "\n";
+
+    std::cout << "\n";
+}
+
+// ===== 8. 可等待队列：对称转移代替条件变量 =====
+// AsyncQueue::pop()在cv_.wait上阻塞整个线程；AwaitableQueue的co_await pop()只挂起协程：
+// 1. 队列本身是无锁的多生产者单消费者(MPSC)链表，push只做一次exchange
+// 2. 消费者挂起时把句柄登记到waiter_，push取走句柄后恢复它
+// 3. 协程内的handoff()把生产者放进线程局部就绪链表，并用对称转移直接切换到消费者，
+//    之后每个挂起点都从就绪链表取下一个协程，整个交接过程不经过线程调度，也不加深调用栈
+
+// 线程局部就绪链表：await_suspend返回它给出的句柄，实现协程间的直接切换
+// 对称转移依赖编译器把resume变成尾调用；GCC在-O0或开启ASan时不做尾调用，长链会爆栈
+// 因此连续转移超过kMaxTransferDepth次后改为暂存目标、返回noop_coroutine让栈回卷，由drain()继续执行
+class SymmetricTrampoline {
+private:
+    static constexpr int kMaxTransferDepth = 128;
+
+    struct State {
+        std::deque<std::coroutine_handle<>> ready;
+        int depth = 0;
+    };
+
+    static State& state() {
+        thread_local State s;
+        return s;
+    }
+
+public:
+    static void defer(std::coroutine_handle<> handle) {
+        state().ready.push_back(handle);
+    }
+
+    // await_suspend的返回值：通常直接转移到target
+    static std::coroutine_handle<> transfer_to(std::coroutine_handle<> target) {
+        auto& s = state();
+        if (++s.depth < kMaxTransferDepth) return target;
+        s.ready.push_back(target);
+        return std::noop_coroutine();
+    }
+
+    // 没有可运行的协程时返回noop_coroutine，控制权回到resume的调用者
+    static std::coroutine_handle<> next() {
+        auto& s = state();
+        if (s.ready.empty()) return std::noop_coroutine();
+        auto handle = s.ready.front();
+        s.ready.pop_front();
+        return transfer_to(handle);
+    }
+
+    // 普通函数里恢复协程的入口：恢复后把回卷时暂存的协程执行完
+    static void resume(std::coroutine_handle<> handle) {
+        auto& s = state();
+        int saved_depth = s.depth;
+        s.depth = 0;
+        handle.resume();
+        s.depth = saved_depth;
+        drain();
+    }
+
+    static void drain() {
+        auto& s = state();
+        while (!s.ready.empty()) {
+            auto handle = s.ready.front();
+            s.ready.pop_front();
+            int saved_depth = s.depth;
+            s.depth = 0;
+            handle.resume();
+            s.depth = saved_depth;
+        }
+    }
+};
+
+template<typename T>
+class AwaitableQueue {
+private:
+    // Vyukov MPSC链表：生产者exchange head_，消费者独占tail_
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    alignas(64) std::atomic<Node*> head_;
+    alignas(64) Node* tail_;
+    Node stub_;
+    std::atomic<void*> waiter_{nullptr};   // 挂起的消费者协程地址
+    std::atomic<bool> closed_{false};
+
+    // 与pop()里的"先写waiter_再读head_"构成Dekker式握手：生产者"先写head_再读waiter_"，
+    // 两边的写->读都必须处在seq_cst全序中，至少一方能看到对方，acq_rel的exchange不提供这个保证
+    // （x86上exchange本身就是全屏障，没有额外开销）
+    void enqueue(Node* node) {
+        Node* prev = head_.exchange(node, std::memory_order_seq_cst);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    bool try_dequeue(std::optional<T>& out) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (!next) return false;
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            out = std::move(tail->value);
+            tail_ = next;
+            delete tail;
+            return true;
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            return false;  // 生产者已exchange但尚未链接next
+        }
+        // 只剩最后一个节点：先放回stub，才能安全取走它
+        stub_.next.store(nullptr, std::memory_order_relaxed);
+        enqueue(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        out = std::move(tail->value);
+        tail_ = next;
+        delete tail;
+        return true;
+    }
+
+    // 生产者一侧：取走挂起的消费者（至多一个）
+    std::coroutine_handle<> take_waiter() {
+        if (!waiter_.load(std::memory_order_seq_cst)) return {};
+        void* address = waiter_.exchange(nullptr, std::memory_order_seq_cst);
+        return address ? std::coroutine_handle<>::from_address(address) : std::coroutine_handle<>{};
+    }
+
+    bool has_pending() const {
+        // tail_停在非stub节点时该节点的值尚未取走；head_离开stub说明有新入队
+        return tail_ != &stub_ || head_.load(std::memory_order_seq_cst) != &stub_;
+    }
+
+public:
+    AwaitableQueue() : head_(&stub_), tail_(&stub_) {}
+
+    AwaitableQueue(const AwaitableQueue&) = delete;
+    AwaitableQueue& operator=(const AwaitableQueue&) = delete;
+
+    ~AwaitableQueue() {
+        std::optional<T> discard;
+        while (try_dequeue(discard)) {}
+    }
+
+    // 线程一侧的push：有消费者挂起时在当前线程上直接恢复它
+    void push(T item) {
+        if (closed_.load(std::memory_order_relaxed)) return;
+        enqueue(new Node{{nullptr}, std::move(item)});
+        if (auto consumer = take_waiter()) {
+            SymmetricTrampoline::resume(consumer);
+        }
+    }
+
+    // 协程一侧的push：co_await queue.handoff(v)，有消费者挂起时对称转移过去
+    auto handoff(T item) {
+        struct HandoffAwaitable {
+            AwaitableQueue& queue;
+            T item;
+            std::coroutine_handle<> consumer{};
+
+            bool await_ready() {
+                if (queue.closed_.load(std::memory_order_relaxed)) return true;
+                queue.enqueue(new Node{{nullptr}, std::move(item)});
+                consumer = queue.take_waiter();
+                return !consumer;  // 没有等待者就不必挂起
+            }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> self) {
+                SymmetricTrampoline::defer(self);
+                return SymmetricTrampoline::transfer_to(consumer);
+            }
+            void await_resume() const noexcept {}
+        };
+        return HandoffAwaitable{*this, std::move(item)};
+    }
+
+    // co_await queue.pop()：返回nullopt表示队列已关闭且为空
+    auto pop() {
+        struct PopAwaitable {
+            AwaitableQueue& queue;
+            std::optional<T> value{};
+
+            // 无竞争路径：队列非空时直接取走，不挂起也不碰waiter_
+            bool await_ready() {
+                return queue.try_dequeue(value);
+            }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> self) {
+                queue.waiter_.store(self.address(), std::memory_order_seq_cst);
+                // 登记之后再检查一次，避免与push交错时丢失唤醒
+                if (queue.has_pending() || queue.closed_.load(std::memory_order_seq_cst)) {
+                    void* expected = self.address();
+                    if (queue.waiter_.compare_exchange_strong(expected, nullptr, std::memory_order_seq_cst)) {
+                        return self;  // 撤回登记，立即继续
+                    }
+                    // 生产者已取走句柄，由它负责恢复
+                }
+                return SymmetricTrampoline::next();
+            }
+            std::optional<T> await_resume() {
+                if (value) return std::move(value);
+                while (!queue.try_dequeue(value)) {
+                    if (queue.closed_.load(std::memory_order_acquire) && !queue.has_pending()) {
+                        return std::nullopt;
+                    }
+                    std::this_thread::yield();  // 等待尚未链接完成的生产者
+                }
+                return std::move(value);
+            }
+        };
+        return PopAwaitable{*this};
+    }
+
+    void close() {
+        closed_.store(true, std::memory_order_seq_cst);
+        if (auto consumer = take_waiter()) {
+            SymmetricTrampoline::resume(consumer);
+        }
+    }
+
+    bool is_closed() const {
+        return closed_.load(std::memory_order_acquire);
+    }
+};
+
+// 协程消费者：等待期间不占用任何线程
+VoidTask awaitable_consumer(AwaitableQueue<int>& queue, int& consumed) {
+    std::cout << "协程消费者开始等待数据...\n";
+    while (auto item = co_await queue.pop()) {
+        std::cout << "消费: " << *item << " (线程 " << std::this_thread::get_id() << ")\n";
+        ++consumed;
+    }
+    std::cout << "队列已关闭，协程消费者退出\n";
+}
+
+// 乒乓测试：两个协程通过两个队列来回传递同一个计数
+VoidTask ping_coroutine(AwaitableQueue<int>& to_pong, AwaitableQueue<int>& to_ping, int rounds) {
+    for (int i = 0; i < rounds; ++i) {
+        co_await to_pong.handoff(i);
+        auto reply = co_await to_ping.pop();
+        if (!reply || *reply != i) break;
+    }
+    to_pong.close();
+}
+
+VoidTask pong_coroutine(AwaitableQueue<int>& to_pong, AwaitableQueue<int>& to_ping) {
+    while (auto value = co_await to_pong.pop()) {
+        co_await to_ping.handoff(*value);
+    }
+}
+
+double measure_thread_ping_pong(int rounds) {
+    AsyncQueue<int> to_pong;
+    AsyncQueue<int> to_ping;
+    auto start = std::chrono::steady_clock::now();
+    std::thread pong([&] {
+        while (auto value = to_pong.pop()) {
+            to_ping.push(*value);
+        }
+    });
+    for (int i = 0; i < rounds; ++i) {
+        to_pong.push(i);
+        to_ping.pop();
+    }
+    to_pong.close();
+    pong.join();
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / rounds;
+}
+
+double measure_coroutine_ping_pong(int rounds) {
+    AwaitableQueue<int> to_pong;
+    AwaitableQueue<int> to_ping;
+    auto start = std::chrono::steady_clock::now();
+    auto pong = pong_coroutine(to_pong, to_ping);   // 立即挂起在to_pong.pop()
+    auto ping = ping_coroutine(to_pong, to_ping, rounds);
+    SymmetricTrampoline::drain();
+    ping.wait();
+    pong.wait();
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / rounds;
+}
+
+void demonstrate_awaitable_queue() {
+    std::cout << "=== 可等待队列演示 ===\n";
+
+    // 1. producer_coroutine照常由线程驱动，消费者换成协程
+    AwaitableQueue<int> queue;
+    int consumed = 0;
+    auto consumer = awaitable_consumer(queue, consumed);  // 在主线程上挂起
+    std::thread producer_thread([&queue]() {
+        auto producer = producer_coroutine(1, 5);
+        while (producer.move_next()) {
+            queue.push(producer.current_value());  // 直接在生产者线程上恢复消费者
+        }
+        queue.close();
+    });
+    producer_thread.join();
+    consumer.wait();
+    std::cout << "共消费 " << consumed << " 项\n";
+
+    // 2. 乒乓往返：线程阻塞版本 vs 协程对称转移版本
+    constexpr int thread_rounds = 20'000;
+    constexpr int coroutine_rounds = 1'000'000;
+    double thread_ns = measure_thread_ping_pong(thread_rounds);
+    double coroutine_ns = measure_coroutine_ping_pong(coroutine_rounds);
+    std::cout << "\n乒乓往返耗时:\n";
+    std::cout << "  AsyncQueue + 两个线程(cv阻塞):     " << thread_ns << " ns/往返\n";
+    std::cout << "  AwaitableQueue + 两个协程(对称转移): " << coroutine_ns << " ns/往返\n";
+    std::cout << "  协程切换约快 " << thread_ns / coroutine_ns << " 倍\n";
+    std::cout << "注：线程版本每次往返需要两次内核唤醒；协程版本" << coroutine_rounds
+              << "次往返都在同一线程上完成，栈深度不随往返次数增长\n";
+
+    std::cout << "\n";
+}
+
+// ===== 9. 真实异步文件读取 =====
+std::uint64_t checksum_bytes(std::span<const std::byte> bytes) {
+    std::uint64_t sum = 0;
+    for (auto b : bytes) sum = sum * 31 + static_cast<std::uint8_t>(b);
+    return sum;
+}
+
+void demonstrate_async_file_io() {
+    std::cout << "=== 真实异步文件读取演示 ===\n";
+    IoContext ctx(256);
+    std::cout << "后端: " << ctx.backend_name();
+    if (!ctx.fallback_reason().empty()) std::cout << " (" << ctx.fallback_reason() << ")";
+    std::cout << "\n";
+
+    // 准备测试目录：file_count个文件，每个file_size字节
+    constexpr std::size_t file_count = 512;
+    constexpr std::size_t file_size = 32 * 1024;
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "cpp20_coroutine_io_bench";
+    fs::create_directories(dir);
+    std::vector<std::string> paths;
+    {
+        std::string content(file_size, '\0');
+        for (std::size_t i = 0; i < file_count; ++i) {
+            for (std::size_t j = 0; j < file_size; ++j) {
+                content[j] = static_cast<char>('a' + (i + j) % 26);
+            }
+            paths.push_back((dir / ("file_" + std::to_string(i) + ".txt")).string());
+            std::ofstream(paths.back(), std::ios::binary).write(content.data(), static_cast<std::streamsize>(content.size()));
+        }
+    }
+    const double total_mb = static_cast<double>(file_count * file_size) / (1024.0 * 1024.0);
+
+    auto report = [&](const char* name, double seconds, std::uint64_t sum) {
+        std::cout << "  " << name << ": " << seconds * 1000.0 << " ms, "
+                  << total_mb / seconds << " MB/s, 校验和 " << sum << "\n";
+    };
+    std::cout << file_count << " 个文件 x " << file_size / 1024 << " KiB:\n";
+
+    // 1. 对照组：逐个ifstream读入std::string
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t sum = 0;
+        for (const auto& path : paths) {
+            std::ifstream in(path, std::ios::binary);
+            std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            sum += checksum_bytes(std::as_bytes(std::span(content)));
+        }
+        report("ifstream逐个阻塞读取", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), sum);
+    }
+
+    // 一块arena按文件切片，读取结果直接引用它
+    std::vector<std::byte> arena(file_count * file_size);
+
+    // 2. 协程重叠读取，调用方提供缓冲区
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto views = process_files_overlapped(ctx, paths, arena, file_size);
+        std::uint64_t sum = 0;
+        for (const auto& view : views) sum += checksum_bytes(view.content);
+        report("协程重叠读取(普通缓冲区)", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), sum);
+    }
+
+    // 3. 协程重叠读取，已注册缓冲区
+    std::span<std::byte> registered[] = {std::span(arena)};
+    if (ctx.register_buffers(registered)) {
+        auto start = std::chrono::steady_clock::now();
+        auto views = process_files_overlapped(ctx, paths, arena, file_size, 0);
+        std::uint64_t sum = 0;
+        for (const auto& view : views) sum += checksum_bytes(view.content);
+        report("协程重叠读取(已注册缓冲区)", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), sum);
+        ctx.unregister_buffers();
+    } else {
+        std::cout << "  当前后端/环境不支持注册缓冲区，跳过\n";
+    }
+
+    std::cout << "注：文件刚写入，处于页缓存中；冷缓存或网络盘上重叠读取的优势会大得多\n";
+
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+
+    std::cout << "\n";
+}
+
+// ===== 10. 任务依赖图(DAG)执行器 =====
+// compute_async -> format_result_async 手工串行调用时，无关的步骤也只能排队等待
+// TaskGraph把步骤声明为节点、依赖声明为边，运行时：
+// 1. 入度为0的节点投递到CoroutineScheduler的工作线程
+// 2. 节点完成后递减后继的入度；第一个就绪的后继由当前线程直接接着执行(延续)，其余投递给调度器
+// 3. Task<T>节点通过co_await挂起，工作线程不会阻塞在future.get()/wait()上
+// 4. 取消沿用CancellableTask的协作式语义：节点收到std::stop_token自行检查，未开始的节点直接跳过
+
+// 即发即弃的协程：由调度器恢复，结束时自行销毁帧
+struct DetachedTask {
+    struct promise_type : PooledFrameAllocation {
+        DetachedTask get_return_object() {
+            return DetachedTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template<typename T>
+struct task_value;
+
+template<typename T>
+struct task_value<Task<T>> {
+    using type = T;
+};
+
+class TaskGraph {
+public:
+    using NodeId = std::size_t;
+    using clock = std::chrono::steady_clock;
+
+    enum class NodeState { Pending, Completed, Cancelled, Failed };
+
+    // Task节点的结果句柄，图运行结束后读取
+    template<typename T>
+    struct NodeHandle {
+        NodeId id;
+        std::shared_ptr<std::optional<T>> value;
+
+        const T& get() const {
+            if (!*value) throw std::runtime_error("节点没有产生结果");
+            return **value;
+        }
+    };
+
+    struct Report {
+        std::chrono::microseconds wall{0};
+        std::size_t completed = 0;
+        std::size_t cancelled = 0;
+        std::size_t failed = 0;
+        std::vector<NodeId> critical_path;
+        std::chrono::microseconds critical_path_length{0};  // 关键路径上节点耗时之和
+    };
+
+private:
+    static constexpr NodeId kNone = static_cast<NodeId>(-1);
+
+    struct Node {
+        std::string name;
+        std::function<void(std::stop_token)> body;
+        std::function<Task<std::monostate>(std::stop_token)> async_body;
+        std::vector<NodeId> successors;
+        std::vector<NodeId> predecessors;
+
+        // 运行期数据：只由执行该节点的线程写入，run()返回后读取
+        NodeState state = NodeState::Pending;
+        clock::time_point start;
+        clock::time_point finish;
+        std::string error;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<NodeId> topo_order_;
+    std::unique_ptr<std::atomic<std::size_t>[]> pending_;
+    std::atomic<std::size_t> remaining_{0};
+    std::stop_source stop_;
+    CoroutineScheduler* sched_ = nullptr;
+    clock::time_point run_start_;
+    Report report_;
+
+    std::mutex done_mtx_;
+    std::condition_variable done_cv_;
+    bool finished_ = false;
+
+    template<typename T, typename Factory>
+    static Task<std::monostate> run_task_node(Factory& factory, std::optional<T>& slot) {
+        slot = co_await factory();
+        co_return std::monostate{};
+    }
+
+    // Kahn算法求拓扑序，顺便检查环
+    void analyze() {
+        std::vector<std::size_t> indegree(nodes_.size());
+        for (const auto& node : nodes_) {
+            for (NodeId s : node.successors) ++indegree[s];
+        }
+        topo_order_.clear();
+        for (NodeId i = 0; i < nodes_.size(); ++i) {
+            if (indegree[i] == 0) topo_order_.push_back(i);
+        }
+        for (std::size_t k = 0; k < topo_order_.size(); ++k) {
+            for (NodeId s : nodes_[topo_order_[k]].successors) {
+                if (--indegree[s] == 0) topo_order_.push_back(s);
+            }
+        }
+        if (topo_order_.size() != nodes_.size()) {
+            throw std::invalid_argument("任务图存在环");
+        }
+    }
+
+    DetachedTask execute(NodeId id) {
+        while (true) {
+            Node& node = nodes_[id];
+            node.start = clock::now();
+            if (stop_.stop_requested()) {
+                node.state = NodeState::Cancelled;
+            } else {
+                try {
+                    if (node.async_body) {
+                        co_await node.async_body(stop_.get_token());
+                    } else {
+                        node.body(stop_.get_token());
+                    }
+                    // 运行中收到取消请求的节点可能只完成了一部分
+                    node.state = stop_.stop_requested() ? NodeState::Cancelled : NodeState::Completed;
+                } catch (const std::exception& e) {
+                    node.state = NodeState::Failed;
+                    node.error = e.what();
+                    stop_.request_stop();  // 失败向下游传播为取消
+                }
+            }
+            node.finish = clock::now();
+
+            NodeId next = kNone;
+            for (NodeId s : node.successors) {
+                if (pending_[s].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    if (next == kNone) {
+                        next = s;  // 留给当前线程，省去一次入队和唤醒
+                    } else {
+                        sched_->post(execute(s).handle);
+                    }
+                }
+            }
+            if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                // 持锁通知：run()拿到锁之前本协程已不再访问图
+                std::lock_guard<std::mutex> lock(done_mtx_);
+                finished_ = true;
+                done_cv_.notify_all();
+            }
+            if (next == kNone) co_return;
+            id = next;
+        }
+    }
+
+    void build_report() {
+        report_ = Report{};
+        report_.wall = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - run_start_);
+        std::vector<clock::duration> longest(nodes_.size());
+        std::vector<NodeId> via(nodes_.size(), kNone);
+        for (NodeId id : topo_order_) {
+            const Node& node = nodes_[id];
+            switch (node.state) {
+                case NodeState::Completed: ++report_.completed; break;
+                case NodeState::Cancelled: ++report_.cancelled; break;
+                case NodeState::Failed: ++report_.failed; break;
+                case NodeState::Pending: break;
+            }
+            clock::duration best{0};
+            for (NodeId p : node.predecessors) {
+                if (longest[p] > best) {
+                    best = longest[p];
+                    via[id] = p;
+                }
+            }
+            longest[id] = best + (node.finish - node.start);
+        }
+        if (nodes_.empty()) return;
+        NodeId tail = static_cast<NodeId>(std::max_element(longest.begin(), longest.end()) - longest.begin());
+        report_.critical_path_length = std::chrono::duration_cast<std::chrono::microseconds>(longest[tail]);
+        for (NodeId id = tail; id != kNone; id = via[id]) {
+            report_.critical_path.push_back(id);
+        }
+        std::reverse(report_.critical_path.begin(), report_.critical_path.end());
+    }
+
+public:
+    // 普通可调用节点：void() 或 void(std::stop_token)
+    template<typename F>
+    NodeId add_node(std::string name, F body) {
+        Node node;
+        node.name = std::move(name);
+        if constexpr (std::is_invocable_v<F&, std::stop_token>) {
+            node.body = std::move(body);
+        } else {
+            node.body = [body = std::move(body)](std::stop_token) mutable { body(); };
+        }
+        nodes_.push_back(std::move(node));
+        return nodes_.size() - 1;
+    }
+
+    // 协程节点：factory()返回Task<T>，在工作线程上启动，结果写入NodeHandle
+    template<typename Factory>
+    auto add_task(std::string name, Factory factory) {
+        using T = typename task_value<std::invoke_result_t<Factory&>>::type;
+        NodeHandle<T> handle{nodes_.size(), std::make_shared<std::optional<T>>()};
+        Node node;
+        node.name = std::move(name);
+        node.async_body = [factory = std::move(factory), slot = handle.value](std::stop_token) mutable {
+            return run_task_node<T>(factory, *slot);
+        };
+        nodes_.push_back(std::move(node));
+        return handle;
+    }
+
+    // from完成后to才能开始
+    void add_edge(NodeId from, NodeId to) {
+        if (from >= nodes_.size() || to >= nodes_.size()) {
+            throw std::out_of_range("节点编号越界");
+        }
+        nodes_[from].successors.push_back(to);
+        nodes_[to].predecessors.push_back(from);
+    }
+
+    template<typename T>
+    void add_edge(const NodeHandle<T>& from, NodeId to) { add_edge(from.id, to); }
+    template<typename T>
+    void add_edge(NodeId from, const NodeHandle<T>& to) { add_edge(from, to.id); }
+    template<typename T, typename U>
+    void add_edge(const NodeHandle<T>& from, const NodeHandle<U>& to) { add_edge(from.id, to.id); }
+
+    // 可以在任意线程调用，包括节点内部
+    void cancel() { stop_.request_stop(); }
+
+    std::size_t size() const { return nodes_.size(); }
+
+    // 调用线程等待整张图结束；工作线程之间没有任何阻塞等待
+    const Report& run(CoroutineScheduler& sched) {
+        analyze();
+        sched_ = &sched;
+        stop_ = std::stop_source{};
+        pending_ = std::make_unique<std::atomic<std::size_t>[]>(nodes_.size());
+        for (NodeId i = 0; i < nodes_.size(); ++i) {
+            pending_[i].store(nodes_[i].predecessors.size(), std::memory_order_relaxed);
+            nodes_[i].state = NodeState::Pending;
+            nodes_[i].error.clear();
+        }
+        remaining_.store(nodes_.size(), std::memory_order_relaxed);
+        finished_ = nodes_.empty();
+        run_start_ = clock::now();
+
+        for (NodeId i = 0; i < nodes_.size(); ++i) {
+            if (nodes_[i].predecessors.empty()) {
+                sched.post(execute(i).handle);
+            }
+        }
+        {
+            std::unique_lock<std::mutex> lock(done_mtx_);
+            done_cv_.wait(lock, [this] { return finished_; });
+        }
+        build_report();
+        return report_;
+    }
+
+    // 每个节点相对图开始时刻的起止时间
+    void print_timeline() const {
+        static const char* state_names[] = {"未执行", "完成", "取消", "失败"};
+        std::cout << "  开始(ms)\t耗时(ms)\t状态\t节点\n";
+        for (NodeId id : topo_order_) {
+            const Node& node = nodes_[id];
+            auto offset = std::chrono::duration<double, std::milli>(node.start - run_start_).count();
+            auto duration = std::chrono::duration<double, std::milli>(node.finish - node.start).count();
+            std::cout << "  " << std::fixed << std::setprecision(2) << offset << "\t\t" << duration << "\t\t"
+                      << state_names[static_cast<int>(node.state)] << "\t" << node.name;
+            if (!node.error.empty()) std::cout << " (" << node.error << ")";
+            std::cout << "\n";
+        }
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+
+    void print_report() const {
+        std::cout << "  节点数 " << nodes_.size() << ": 完成 " << report_.completed << ", 取消 "
+                  << report_.cancelled << ", 失败 " << report_.failed << "\n";
+        std::cout << "  墙钟时间 " << report_.wall.count() << " μs, 关键路径 "
+                  << report_.critical_path_length.count() << " μs (" << report_.critical_path.size() << " 个节点)\n";
+        std::cout << "  关键路径:";
+        const std::size_t shown = std::min<std::size_t>(report_.critical_path.size(), 8);
+        for (std::size_t i = 0; i < shown; ++i) {
+            std::cout << (i ? " -> " : " ") << nodes_[report_.critical_path[i]].name;
+        }
+        if (shown < report_.critical_path.size()) std::cout << " -> ...";
+        std::cout << "\n";
+    }
+};
+
+// 模拟一个细粒度的小步骤
+void spin_for(std::chrono::microseconds duration) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+void demonstrate_task_graph() {
+    std::cout << "=== 任务依赖图执行器演示 ===\n";
+    CoroutineScheduler sched(4);
+
+    // 1. 把 compute_async -> format_result_async 写成图，与无关的校验步骤并行
+    {
+        TaskGraph graph;
+        int a = 0, b = 0;
+        auto load_a = graph.add_node("读取参数a", [&] { a = 10; });
+        auto load_b = graph.add_node("读取参数b", [&] { b = 20; });
+        auto compute = graph.add_task("compute_async", [&] { return compute_async(a, b); });
+        auto format = graph.add_task("format_result_async", [&] { return format_result_async(compute.get()); });
+        auto verify = graph.add_node("并行校验", [] { std::this_thread::sleep_for(std::chrono::milliseconds(60)); });
+        graph.add_edge(load_a, compute);
+        graph.add_edge(load_b, compute);
+        graph.add_edge(compute, format);
+        graph.add_edge(load_b, verify);
+
+        graph.run(sched);
+        std::cout << "结果: " << format.get() << "\n";
+        graph.print_timeline();
+        graph.print_report();
+    }
+
+    // 2. 失败传播为取消：下游节点不再执行，长节点通过stop_token提前退出
+    {
+        std::cout << "\n失败与取消传播:\n";
+        TaskGraph graph;
+        auto fetch = graph.add_node("拉取数据", [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            throw std::runtime_error("连接超时");
+        });
+        auto parse = graph.add_node("解析", [] {});
+        auto store = graph.add_node("写入", [] {});
+        auto slow = graph.add_node("长时间统计", [](std::stop_token token) {
+            for (int i = 0; i < 100 && !token.stop_requested(); ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        });
+        graph.add_edge(fetch, parse);
+        graph.add_edge(parse, store);
+        (void)slow;
+        graph.run(sched);
+        graph.print_timeline();
+        graph.print_report();
+    }
+
+    // 3. 10000个小步骤的分层DAG：串行执行 vs 图执行器
+    {
+        constexpr std::size_t layers = 100;
+        constexpr std::size_t width = 100;
+        const auto step = std::chrono::microseconds(20);
+        TaskGraph graph;
+        std::vector<std::function<void()>> serial_steps;
+        std::atomic<std::size_t> executed{0};
+        std::uint32_t seed = 12345;
+        auto next_random = [&seed] {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        };
+        for (std::size_t layer = 0; layer < layers; ++layer) {
+            for (std::size_t i = 0; i < width; ++i) {
+                auto id = graph.add_node("L" + std::to_string(layer) + "#" + std::to_string(i), [&executed, step] {
+                    spin_for(step);
+                    executed.fetch_add(1, std::memory_order_relaxed);
+                });
+                if (layer > 0) {
+                    // 每个节点依赖上一层的两个随机节点
+                    graph.add_edge((layer - 1) * width + next_random() % width, id);
+                    graph.add_edge((layer - 1) * width + next_random() % width, id);
+                }
+            }
+        }
+
+        auto serial_start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < graph.size(); ++i) spin_for(step);
+        auto serial_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - serial_start).count();
+
+        const auto& report = graph.run(sched);
+        std::cout << "\n" << graph.size() << " 个节点 (每个约" << step.count() << "μs), 调度器4个工作线程, 硬件线程 "
+                  << std::thread::hardware_concurrency() << ":\n";
+        std::cout << "  串行执行: " << serial_us << " μs\n";
+        std::cout << "  图执行器: " << report.wall.count() << " μs (执行节点 " << executed.load() << ")\n";
+        graph.print_report();
+        std::cout << "注：加速比上限为 min(工作线程数, 总耗时/关键路径)，单核环境下只能看到调度开销\n";
+    }
+
+    std::cout << "\n";
+}
+
+// ===== 11. 批量生成器：一次恢复产出一批元素 =====
+// Generator<T>每个co_yield都是一次挂起+恢复，元素本身很便宜(int、偏移量)时开销几乎全是这次往返
+// BatchedGenerator<T, N>把co_yield的值写进promise里的定长缓冲区：
+// 1. 缓冲区未满时yield_value返回的awaiter await_ready()为true，协程根本不挂起
+// 2. 写满N个或协程结束时才挂起一次，消费者拿到std::span<const T>整批处理
+// 3. move_next()/current_value()和elements()在批内逐个取值，原来按元素消费的代码不用改
+template<typename T, std::size_t N = 64>
+class BatchedGenerator {
+    static_assert(N > 0, "批大小必须大于0");
+    static_assert(std::is_default_constructible_v<T>, "缓冲区需要默认构造元素");
+
+public:
+    struct promise_type : PooledFrameAllocation {
+        std::array<T, N> buffer;
+        std::size_t count = 0;
+        std::exception_ptr exception;
+        
+        // 只有缓冲区写满时才真正挂起
+        struct YieldAwaiter {
+            bool full;
+            bool await_ready() const noexcept { return !full; }
+            void await_suspend(std::coroutine_handle<>) const noexcept {}
+            void await_resume() const noexcept {}
+        };
+        
+        BatchedGenerator get_return_object() {
+            return BatchedGenerator{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        
+        std::suspend_always initial_suspend() { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        
+        YieldAwaiter yield_value(T value) {
+            buffer[count++] = std::move(value);
+            return {count == N};
+        }
+        
+        // 异常先记下来，等消费者取完已经产出的元素之后再抛出
+        void unhandled_exception() {
+            exception = std::current_exception();
+        }
+        
+        void return_void() {}
+    };
+    
+    // 把批次展平成元素序列：批内只是指针递增，批用完才恢复协程
+    class ElementIterator {
+    public:
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        
+        ElementIterator() = default;
+        explicit ElementIterator(BatchedGenerator* gen) : gen_(gen) { load(); }
+        
+        const T& operator*() const { return *current_; }
+        
+        ElementIterator& operator++() {
+            if (++current_ == end_) load();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        
+        friend bool operator==(const ElementIterator& it, std::default_sentinel_t) {
+            return it.current_ == nullptr;
+        }
+        
+    private:
+        BatchedGenerator* gen_ = nullptr;
+        const T* current_ = nullptr;
+        const T* end_ = nullptr;
+        
+        void load() {
+            if (gen_->next_batch()) {
+                auto batch = gen_->batch();
+                current_ = batch.data();
+                end_ = batch.data() + batch.size();
+            } else {
+                current_ = end_ = nullptr;
+            }
+        }
+    };
+    
+    class Elements {
+    public:
+        explicit Elements(BatchedGenerator& gen) : gen_(&gen) {}
+        ElementIterator begin() { return ElementIterator(gen_); }
+        std::default_sentinel_t end() const { return {}; }
+        
+    private:
+        BatchedGenerator* gen_;
+    };
+    
+private:
+    std::coroutine_handle<promise_type> handle_;
+    std::size_t position_ = 0;  // move_next()在当前批里的位置
+    
+public:
+    explicit BatchedGenerator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    
+    ~BatchedGenerator() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+    
+    BatchedGenerator(const BatchedGenerator&) = delete;
+    BatchedGenerator& operator=(const BatchedGenerator&) = delete;
+    
+    BatchedGenerator(BatchedGenerator&& other) noexcept
+        : handle_(std::exchange(other.handle_, {})), position_(other.position_) {}
+    
+    BatchedGenerator& operator=(BatchedGenerator&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+            position_ = other.position_;
+        }
+        return *this;
+    }
+    
+    // 恢复协程直到攒满一批或结束；最后一批可能不满，之后返回false
+    bool next_batch() {
+        if (!handle_) return false;
+        auto& promise = handle_.promise();
+        promise.count = 0;
+        position_ = 0;
+        if (!handle_.done()) {
+            handle_.resume();
+            if (promise.count > 0) return true;  // 协程结束或抛出前攒下的元素先交出去
+        }
+        if (promise.exception) {
+            std::rethrow_exception(std::exchange(promise.exception, nullptr));
+        }
+        return false;
+    }
+    
+    std::span<const T> batch() const {
+        const auto& promise = handle_.promise();
+        return {promise.buffer.data(), promise.count};
+    }
+    
+    // 与Generator<T>相同的逐元素接口
+    bool move_next() {
+        if (handle_ && position_ + 1 < handle_.promise().count) {
+            ++position_;
+            return true;
+        }
+        return next_batch();
+    }
+    
+    const T& current_value() const {
+        return handle_.promise().buffer[position_];
+    }
+    
+    Elements elements() {
+        return Elements(*this);
+    }
+    
+    bool done() const {
+        return !handle_ || handle_.done();
+    }
+    
+    std::coroutine_handle<promise_type> get_handle() const {
+        return handle_;
+    }
+};
+
+BatchedGenerator<int> batched_fibonacci_generator(int count) {
+    if (count <= 0) co_return;
+    
+    int a = 0, b = 1;
+    for (int i = 0; i < count; ++i) {
+        co_yield a;  // 缓冲区未满时不挂起
+        int temp = a + b;
+        a = b;
+        b = temp;
+    }
+}
+
+BatchedGenerator<int> batched_range_generator(int start, int end, int step = 1) {
+    for (int i = start; i < end; i += step) {
+        co_yield i;
+    }
+}
+
+// 扫描器：逐个产出单词在文本中的位置，元素很小、数量很多，正是恢复开销占主导的场景
+Generator<std::string_view> scan_words(std::string_view text) {
+    std::size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && text[i] == ' ') ++i;
+        std::size_t begin = i;
+        while (i < text.size() && text[i] != ' ') ++i;
+        if (i > begin) co_yield text.substr(begin, i - begin);
+    }
+}
+
+BatchedGenerator<std::string_view, 128> scan_words_batched(std::string_view text) {
+    std::size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && text[i] == ' ') ++i;
+        std::size_t begin = i;
+        while (i < text.size() && text[i] != ' ') ++i;
+        if (i > begin) co_yield text.substr(begin, i - begin);
+    }
+}
+
+BatchedGenerator<int, 4> failing_after(int count) {
+    for (int i = 0; i < count; ++i) {
+        co_yield i;
+    }
+    throw std::runtime_error("数据源中断");
+}
+
+template<typename Body>
+double best_ns_per_element(std::size_t elements, Body&& body) {
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed / static_cast<double>(elements));
+    }
+    return best;
+}
+
+void demonstrate_batched_generator() {
+    std::cout << "=== 批量生成器演示 ===\n";
+
+    // 1. 原有的逐元素接口照常工作
+    std::cout << "批量斐波那契(逐元素消费): ";
+    auto fib = batched_fibonacci_generator(10);
+    while (fib.move_next()) {
+        std::cout << fib.current_value() << " ";
+    }
+    std::cout << "\n";
+
+    std::cout << "批量范围生成器 [0, 20) step=3 (elements()展平): ";
+    auto range = batched_range_generator(0, 20, 3);
+    for (int value : range.elements()) {
+        std::cout << value << " ";
+    }
+    std::cout << "\n";
+
+    std::cout << "按批消费 BatchedGenerator<int, 4>:\n";
+    auto small = [](int n) -> BatchedGenerator<int, 4> {
+        for (int i = 0; i < n; ++i) co_yield i * i;
+    }(10);
+    while (small.next_batch()) {
+        std::cout << "  批(" << small.batch().size() << "):";
+        for (int value : small.batch()) std::cout << " " << value;
+        std::cout << "\n";
+    }
+
+    // 2. 异常在已产出的元素都交出之后才抛出
+    auto failing = failing_after(6);
+    int delivered = 0;
+    try {
+        while (failing.move_next()) ++delivered;
+    } catch (const std::exception& e) {
+        std::cout << "取到 " << delivered << " 个元素后捕获异常: " << e.what() << "\n";
+    }
+
+    // 3. 恢复次数与吞吐对比
+    constexpr int n = 10'000'000;
+    long long sum_single = 0, sum_flat = 0, sum_batch = 0;
+    double single_ns = best_ns_per_element(n, [&] {
+        sum_single = 0;
+        auto gen = range_generator(0, n);
+        while (gen.move_next()) sum_single += gen.current_value();
+    });
+    double flat_ns = best_ns_per_element(n, [&] {
+        sum_flat = 0;
+        auto gen = batched_range_generator(0, n);
+        for (int value : gen.elements()) sum_flat += value;
+    });
+    double batch_ns = best_ns_per_element(n, [&] {
+        sum_batch = 0;
+        auto gen = batched_range_generator(0, n);
+        while (gen.next_batch()) {
+            for (int value : gen.batch()) sum_batch += value;
+        }
+    });
+    std::cout << "\n遍历 " << n << " 个int (每种取5轮最好成绩):\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Generator<int>:               " << single_ns << " ns/个, 恢复 " << n << " 次\n";
+    std::cout << "  BatchedGenerator elements():  " << flat_ns << " ns/个, 恢复 " << (n + 63) / 64 << " 次\n";
+    std::cout << "  BatchedGenerator next_batch(): " << batch_ns << " ns/个\n";
+    std::cout << "  结果一致: " << (sum_single == sum_flat && sum_flat == sum_batch ? "是" : "否") << "\n";
+
+    // 4. 扫描器：每个单词一个string_view
+    std::string text;
+    for (int i = 0; i < 200'000; ++i) {
+        text += (i % 7 == 0) ? "coroutine " : (i % 3 == 0 ? "a " : "scan  ");
+    }
+    std::size_t words_single = 0, words_batched = 0, bytes_single = 0, bytes_batched = 0;
+    double scan_single_ns = best_ns_per_element(200'000, [&] {
+        words_single = bytes_single = 0;
+        auto gen = scan_words(text);
+        while (gen.move_next()) {
+            ++words_single;
+            bytes_single += gen.current_value().size();
+        }
+    });
+    double scan_batched_ns = best_ns_per_element(200'000, [&] {
+        words_batched = bytes_batched = 0;
+        auto gen = scan_words_batched(text);
+        for (std::string_view word : gen.elements()) {
+            ++words_batched;
+            bytes_batched += word.size();
+        }
+    });
+    std::cout << "\n单词扫描器 (" << words_single << " 个单词):\n";
+    std::cout << "  逐个产出: " << scan_single_ns << " ns/词\n";
+    std::cout << "  批量产出: " << scan_batched_ns << " ns/词, 结果一致: "
+              << (words_single == words_batched && bytes_single == bytes_batched ? "是" : "否") << "\n";
+    std::cout << std::defaultfloat;
+
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++20 Coroutines异步编程深度解析\n";
@@ -764,6 +3032,12 @@ int main() {
     demonstrate_awaitable_objects();
     demonstrate_coroutine_frame_management();
     demonstrate_async_patterns();
+    demonstrate_coroutine_scheduler();
+    demonstrate_frame_pool();
+    demonstrate_awaitable_queue();
+    demonstrate_async_file_io();
+    demonstrate_task_graph();
+    demonstrate_batched_generator();
     
     return 0;
 }
@@ -779,6 +3053,12 @@ g++ -std=c++20 -O2 -Wall -pthread 03_coroutines.cpp -o coroutines
 3. Awaitable对象封装异步等待逻辑，可以自定义各种异步操作
 4. 协程帧在堆上分配，支持挂起和恢复，实现了栈到堆的转换
 5. 协程非常适合实现Generator、异步Task、生产者-消费者等模式
+6. 调度器把等待变成登记：时间轮管理定时器，就绪队列驱动少量工作线程恢复协程
+7. promise_type的operator new/delete可接管帧分配：线程局部分级池复用帧，allocator_arg让调用方指定分配器
+8. 可等待队列挂起协程而不是线程：await_suspend返回下一个句柄完成对称转移，无竞争时不加锁
+9. 真实的异步I/O交给内核排队(io_uring/IOCP)，一个线程用协程同时挂起数百个读请求，数据直接读进调用方缓冲区
+10. 任务依赖图按入度调度节点，完成者直接延续一个就绪后继；Task<T>可被co_await，失败经stop_token传播为取消
+11. 批量生成器把co_yield的值攒进promise缓冲区，await_ready()在未满时返回true，N个元素只付一次恢复开销
 
 注意事项:
 - 协程是C++20的实验性特性，需要编译器支持
@@ -786,4 +3066,5 @@ g++ -std=c++20 -O2 -Wall -pthread 03_coroutines.cpp -o coroutines
 - 异常处理需要在promise_type中正确实现
 - 协程的性能开销主要在首次创建和销毁时
 - 多线程环境下需要注意协程的线程安全性
+- BatchedGenerator::batch()返回的span在下一次next_batch/move_next之后失效，需要保留的元素要自己拷贝
 */
\ No newline at end of file
@@ -7,6 +7,7 @@
  * 3. 编译期计算优化 - 零运行时开销的计算模式
  * 4. constexpr扩展增强 - 更强大的编译期编程能力
  * 5. 模板元编程革新 - 编译期算法和数据结构设计
+ * 6. 编译期完美哈希 - consteval构造无冲突表，字符串分派无需探测
  */
 
 #include <iostream>
@@ -14,6 +15,17 @@
 #include <string_view>
 #include <type_traits>
 #include <chrono>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../common/byte_hash.h"
 
 // ===== 1. consteval立即函数演示 =====
 // constexpr vs consteval对比
@@ -561,6 +573,247 @@ void demonstrate_performance_comparison() {
     std::cout << "\n";
 }
 
+// ===== 6. 编译期完美哈希与字符串分派 =====
+// string_to_enum、配置解析这类代码在运行时逐个比较字符串，每条消息都要付出O(N)次比较
+// static_string_map在编译期用PTHash风格的算法构造无冲突表：
+// 1. 每个键的64位哈希先决定它属于哪个桶（约2个键一个桶）
+// 2. 按桶从大到小依次为每个桶搜索一个"pilot"值，使桶内所有键的槽位互不冲突且未被占用
+// 3. 查找时：算一次哈希 -> 读一个pilot -> 定位槽位 -> 比较一次键，没有任何探测
+// 构造函数是consteval，键表有重复或找不到pilot会直接成为编译错误
+// 哈希函数（load_le/mix64/hash_bytes）复用common/byte_hash.h，与C++14的SwissMap是同一份实现
+// hash_bytes是constexpr，consteval构造与运行时查找算出的哈希值相同
+
+template<typename Value, size_t N>
+class static_string_map {
+    static_assert(N > 0 && N < 65535, "键数量需在1到65534之间");
+
+public:
+    using entry_type = std::pair<std::string_view, Value>;
+    static constexpr size_t kSlots = std::bit_ceil(N);   // 槽位数为不小于N的2的幂，负载在(0.5, 1]
+    static constexpr size_t kBuckets = N / 2 + 1;
+
+    consteval explicit static_string_map(const entry_type (&entries)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            entries_[i] = entries[i];
+            for (size_t j = i + 1; j < N; ++j) {
+                if (entries[i].first == entries[j].first) throw "static_string_map: 重复的键";
+            }
+        }
+        for (uint64_t seed = 0x5eed; seed < 0x5eed + 64; ++seed) {
+            if (try_build(seed)) return;
+        }
+        throw "static_string_map: 找不到无冲突的布局";
+    }
+
+    constexpr const Value* find(std::string_view key) const {
+        const uint64_t h = byte_hash::hash_bytes(key, seed_);
+        const uint16_t entry = slots_[slot_of(h, pilots_[bucket_of(h)])];
+        return (entry != 0 && entries_[entry - 1].first == key) ? &entries_[entry - 1].second : nullptr;
+    }
+
+    constexpr Value get(std::string_view key, Value fallback) const {
+        const Value* value = find(key);
+        return value ? *value : fallback;
+    }
+
+    constexpr bool contains(std::string_view key) const { return find(key) != nullptr; }
+    static constexpr size_t size() { return N; }
+    constexpr const std::array<entry_type, N>& entries() const { return entries_; }
+
+private:
+    static constexpr size_t bucket_of(uint64_t h) {
+        return static_cast<size_t>(((h >> 32) * kBuckets) >> 32);
+    }
+
+    // 取乘积的高位：若直接用低位做掩码，桶内低位相同的两个键异或任何pilot后仍然冲突
+    static constexpr size_t slot_of(uint64_t h, uint32_t pilot) {
+        if constexpr (kSlots == 1) {
+            return 0;
+        } else {
+            const uint64_t x = (h ^ byte_hash::mix64(pilot + 1)) * 0x9e3779b97f4a7c15ULL;
+            return static_cast<size_t>(x >> (64 - std::countr_zero(kSlots)));
+        }
+    }
+
+    constexpr bool try_build(uint64_t seed) {
+        std::array<uint64_t, N> hashes{};
+        std::array<uint32_t, kBuckets> bucket_size{};
+        for (size_t i = 0; i < N; ++i) {
+            hashes[i] = byte_hash::hash_bytes(entries_[i].first, seed);
+            ++bucket_size[bucket_of(hashes[i])];
+        }
+        // 大桶约束最多，先放
+        std::array<uint32_t, kBuckets> order{};
+        for (size_t b = 0; b < kBuckets; ++b) order[b] = static_cast<uint32_t>(b);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return bucket_size[a] > bucket_size[b]; });
+
+        slots_.fill(0);
+        pilots_.fill(0);
+        std::array<size_t, N> members{};
+        for (uint32_t bucket : order) {
+            if (bucket_size[bucket] == 0) break;
+            size_t count = 0;
+            for (size_t i = 0; i < N; ++i) {
+                if (bucket_of(hashes[i]) == bucket) members[count++] = i;
+            }
+            bool placed = false;
+            for (uint32_t pilot = 0; pilot < (1u << 16) && !placed; ++pilot) {
+                placed = true;
+                for (size_t m = 0; m < count && placed; ++m) {
+                    const size_t slot = slot_of(hashes[members[m]], pilot);
+                    placed = slots_[slot] == 0;
+                    for (size_t k = 0; k < m && placed; ++k) placed = slot_of(hashes[members[k]], pilot) != slot;
+                }
+                if (placed) {
+                    pilots_[bucket] = pilot;
+                    for (size_t m = 0; m < count; ++m) {
+                        slots_[slot_of(hashes[members[m]], pilot)] = static_cast<uint16_t>(members[m] + 1);
+                    }
+                }
+            }
+            if (!placed) return false;
+        }
+        seed_ = seed;
+        return true;
+    }
+
+    std::array<entry_type, N> entries_{};
+    std::array<uint16_t, kSlots> slots_{};     // 0表示空槽，否则为entries_下标+1
+    std::array<uint32_t, kBuckets> pilots_{};
+    uint64_t seed_ = 0;
+};
+
+template<typename Value, size_t N>
+consteval static_string_map<Value, N> make_static_string_map(const std::pair<std::string_view, Value> (&entries)[N]) {
+    return static_string_map<Value, N>(entries);
+}
+
+// 枚举与字符串的双向映射：字符串->枚举走完美哈希，枚举->字符串按底层值直接索引
+// 要求枚举值从0开始连续，否则编译失败
+template<typename Enum, size_t N>
+class static_enum_map {
+public:
+    consteval explicit static_enum_map(const std::pair<std::string_view, Enum> (&entries)[N])
+        : by_name_(entries) {
+        std::array<bool, N> seen{};
+        for (const auto& [name, value] : entries) {
+            const auto index = static_cast<size_t>(static_cast<std::underlying_type_t<Enum>>(value));
+            if (index >= N || seen[index]) throw "static_enum_map: 枚举值必须从0开始连续且不重复";
+            seen[index] = true;
+            names_[index] = name;
+        }
+    }
+
+    constexpr std::optional<Enum> from_string(std::string_view name) const {
+        const Enum* value = by_name_.find(name);
+        return value ? std::optional<Enum>(*value) : std::nullopt;
+    }
+
+    constexpr std::string_view to_string(Enum value) const {
+        const auto index = static_cast<size_t>(static_cast<std::underlying_type_t<Enum>>(value));
+        return index < N ? names_[index] : std::string_view("Unknown");
+    }
+
+private:
+    static_string_map<Enum, N> by_name_;
+    std::array<std::string_view, N> names_{};
+};
+
+template<typename Enum, size_t N>
+consteval static_enum_map<Enum, N> make_static_enum_map(const std::pair<std::string_view, Enum> (&entries)[N]) {
+    return static_enum_map<Enum, N>(entries);
+}
+
+enum class Priority { Low, Medium, High, Critical };
+
+constexpr auto priority_names = make_static_enum_map<Priority>({
+    {"Low", Priority::Low},
+    {"Medium", Priority::Medium},
+    {"High", Priority::High},
+    {"Critical", Priority::Critical},
+});
+
+static_assert(priority_names.from_string("High") == Priority::High);
+static_assert(priority_names.to_string(Priority::Critical) == "Critical");
+static_assert(!priority_names.from_string("Urgent"));
+
+// 行情/订单消息里的字段名，每条消息都要按名字分派
+enum class MessageField {
+    Symbol, Price, Quantity, Side, OrderId, Timestamp, Account, Venue,
+    OrderType, TimeInForce, ClientId, ExecId, LastPrice, LastQty, Currency, Text
+};
+
+constexpr std::pair<std::string_view, MessageField> kFieldList[] = {
+    {"symbol", MessageField::Symbol},         {"price", MessageField::Price},
+    {"quantity", MessageField::Quantity},     {"side", MessageField::Side},
+    {"order_id", MessageField::OrderId},      {"timestamp", MessageField::Timestamp},
+    {"account", MessageField::Account},       {"venue", MessageField::Venue},
+    {"order_type", MessageField::OrderType},  {"time_in_force", MessageField::TimeInForce},
+    {"client_id", MessageField::ClientId},    {"exec_id", MessageField::ExecId},
+    {"last_price", MessageField::LastPrice},  {"last_qty", MessageField::LastQty},
+    {"currency", MessageField::Currency},     {"text", MessageField::Text},
+};
+
+constexpr auto field_names = make_static_enum_map<MessageField>(kFieldList);
+
+// 传统写法：if链逐个比较
+[[gnu::noinline]] int parse_field_linear(std::string_view name) {
+    for (const auto& [key, field] : kFieldList) {
+        if (key == name) return static_cast<int>(field);
+    }
+    return -1;
+}
+
+void demonstrate_static_string_map() {
+    std::cout << "=== 编译期完美哈希与字符串分派 ===\n";
+
+    std::cout << "Priority往返: \"High\" -> " << static_cast<int>(*priority_names.from_string("High"))
+              << " -> \"" << priority_names.to_string(Priority::High) << "\"\n";
+    std::cout << "字段表: " << kFieldList[0].first << "... 共 " << std::size(kFieldList) << " 个字段, "
+              << static_string_map<MessageField, 16>::kSlots << " 个槽, "
+              << static_string_map<MessageField, 16>::kBuckets << " 个pilot\n";
+
+    // 模拟消息流：字段名大多命中，少量未知字段；名字刚解析出来，位于缓存中
+    std::vector<std::string> names;
+    unsigned state = 12345;
+    for (int i = 0; i < 4096; ++i) {
+        state = state * 1103515245u + 12345u;
+        const unsigned pick = (state >> 16) % 20;
+        names.emplace_back(pick < 16 ? std::string(kFieldList[pick].first) : "unknown_" + std::to_string(pick));
+    }
+    std::vector<std::string_view> views(names.begin(), names.end());
+
+    std::unordered_map<std::string, MessageField> hashed;
+    for (const auto& [key, field] : kFieldList) hashed.emplace(std::string(key), field);
+
+    auto run = [&](const char* label, auto&& lookup) {
+        auto start = std::chrono::high_resolution_clock::now();
+        const int reps = 500;
+        long long sum = 0;
+        for (int rep = 0; rep < reps; ++rep) {
+            for (size_t i = 0; i < views.size(); ++i) sum += lookup(i);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / (double(reps) * views.size());
+        std::cout << "  " << label << ns << " ns/次 (校验和 " << sum << ")\n";
+        return ns;
+    };
+
+    std::cout << "字段名查找:\n";
+    double linear_ns = run("线性比较:         ", [&](size_t i) { return parse_field_linear(views[i]); });
+    double hash_ns = run("unordered_map:    ", [&](size_t i) {
+        auto it = hashed.find(names[i]);
+        return it == hashed.end() ? -1 : static_cast<int>(it->second);
+    });
+    double perfect_ns = run("static_string_map:", [&](size_t i) {
+        auto field = field_names.from_string(views[i]);
+        return field ? static_cast<int>(*field) : -1;
+    });
+    std::cout << "  相对线性比较 " << linear_ns / perfect_ns << "x, 相对unordered_map " << hash_ns / perfect_ns << "x\n";
+
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++20 编译期增强特性深度解析\n";
@@ -572,6 +825,7 @@ int main() {
     demonstrate_constexpr_extensions();
     demonstrate_metaprogramming_revolution();
     demonstrate_performance_comparison();
+    demonstrate_static_string_map();
     
     return 0;
 }
@@ -587,6 +841,7 @@ g++ -std=c++20 -O2 -Wall 04_consteval_constinit.cpp -o consteval_constinit
 3. 编译期计算可以实现零运行时开销的复杂算法
 4. C++20的constexpr扩展支持更多标准库功能
 5. 新的编译期特性革新了模板元编程的可能性
+6. 键集合在编译期已知时，consteval可以把哈希表的构造成本全部移到编译期
 
 注意事项:
 - consteval函数的参数必须是编译期常量
@@ -594,4 +849,5 @@ g++ -std=c++20 -O2 -Wall 04_consteval_constinit.cpp -o consteval_constinit
 - 过度使用编译期计算可能增加编译时间
 - 编译期计算的错误信息可能较难理解
 - 某些复杂计算在编译期可能有限制
+- static_string_map的构造受编译器常量求值步数限制（GCC默认约3300万步），几百个键以内没有问题
 */
\ No newline at end of file
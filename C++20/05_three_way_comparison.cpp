@@ -7,6 +7,7 @@
  * 3. 自动比较生成 - 编译器自动生成所有比较运算符
  * 4. 自定义比较逻辑 - 复杂数据结构的比较策略设计
  * 5. 性能优化分析 - 单一比较函数的效率提升
+ * 6. 规范化键排序 - 把<=>比较的成员编码成保序字节串，用基数排序代替多字段比较
  */
 
 #include <iostream>
@@ -16,6 +17,18 @@
 #include <tuple>
 #include <chrono>
 #include <cmath>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
 
 // ===== 1. 宇宙飞船操作符基础演示 =====
 // 简单的Point类展示默认比较
@@ -584,6 +597,363 @@ void demonstrate_comprehensive_example() {
     std::cout << "\n";
 }
 
+// ===== 6. 规范化键排序：多字段比较变成一次字节比较 =====
+// operator<=>逐字段比较，排序时每次比较都要追着多个成员（字符串还要解引用堆内存）。
+// 规范化键把参与比较的成员依次编码成定长字节串，使 memcmp(key(a), key(b)) 的顺序与 a <=> b 一致：
+//   - 无符号整数：大端序；有符号整数：翻转符号位后大端序
+//   - 浮点数：正数翻转符号位、负数按位取反，-0.0归一为+0.0，NaN排在最后
+//   - 字符串：prefix-1字节内容(不足补0) + 1字节长度，长度字节区分"ab"与"ab\0"；
+//     放不下的字符串只保留前缀并标记为"不精确"，其后的字段一律写0，键相等时回退到operator<=>
+//   - 降序字段：整段按位取反
+// 键排好后只需统一做一次置换，元素本身只移动一次
+template<std::size_t N>
+class KeyWriter {
+public:
+    explicit KeyWriter(std::uint8_t* out) : out_(out) {}
+    
+    void put_bool(bool value, bool descending = false) {
+        put_byte(static_cast<std::uint8_t>(value), descending);
+    }
+    
+    template<std::integral I>
+    void put_int(I value, bool descending = false) {
+        using U = std::make_unsigned_t<I>;
+        U bits = static_cast<U>(value);
+        if constexpr (std::is_signed_v<I>) {
+            bits ^= U{1} << (sizeof(U) * 8 - 1);
+        }
+        put_big_endian(bits, descending);
+    }
+    
+    template<std::floating_point F>
+    void put_float(F value, bool descending = false) {
+        using U = std::conditional_t<sizeof(F) == 8, std::uint64_t, std::uint32_t>;
+        constexpr U sign = U{1} << (sizeof(U) * 8 - 1);
+        if (value == F{0}) value = F{0};  // -0.0 与 +0.0 相等，编码也必须相同
+        U bits = std::bit_cast<U>(value);
+        bits = (bits & sign) ? static_cast<U>(~bits) : (bits | sign);
+        if (std::isnan(value)) bits = ~U{0};  // 所有NaN统一排在最后
+        put_big_endian(bits, descending);
+    }
+    
+    void put_string(std::string_view text, std::size_t prefix, bool descending = false) {
+        check(prefix);
+        if (prefix < 2 || prefix > 256) throw std::length_error("字符串前缀长度必须在[2, 256]之间");
+        if (!exact_) return skip(prefix);
+        const std::size_t capacity = prefix - 1;
+        const std::size_t n = std::min(text.size(), capacity);
+        std::memcpy(out_ + pos_, text.data(), n);
+        std::memset(out_ + pos_ + n, 0, capacity - n);
+        out_[pos_ + capacity] = static_cast<std::uint8_t>(n);
+        if (descending) invert(pos_, prefix);
+        pos_ += prefix;
+        // 装满的字符串无法与更长的同前缀字符串区分，后面的字段也就不能再参与字节比较
+        if (text.size() >= capacity) exact_ = false;
+    }
+    
+    bool exact() const { return exact_; }
+    
+    // 未用完的尾部补0，保证整段键都有确定的值
+    void finish() {
+        std::memset(out_ + pos_, 0, N - pos_);
+    }
+    
+private:
+    std::uint8_t* out_;
+    std::size_t pos_ = 0;
+    bool exact_ = true;
+    
+    void check(std::size_t bytes) const {
+        if (pos_ + bytes > N) throw std::length_error("规范化键超出声明的长度");
+    }
+    
+    void skip(std::size_t bytes) {
+        std::memset(out_ + pos_, 0, bytes);
+        pos_ += bytes;
+    }
+    
+    void put_byte(std::uint8_t byte, bool descending) {
+        check(1);
+        if (!exact_) return skip(1);
+        out_[pos_++] = descending ? static_cast<std::uint8_t>(~byte) : byte;
+    }
+    
+    template<typename U>
+    void put_big_endian(U bits, bool descending) {
+        check(sizeof(U));
+        if (!exact_) return skip(sizeof(U));
+        if (descending) bits = static_cast<U>(~bits);
+        for (std::size_t i = 0; i < sizeof(U); ++i) {
+            out_[pos_ + i] = static_cast<std::uint8_t>(bits >> ((sizeof(U) - 1 - i) * 8));
+        }
+        pos_ += sizeof(U);
+    }
+    
+    void invert(std::size_t from, std::size_t count) {
+        for (std::size_t i = from; i < from + count; ++i) out_[i] = static_cast<std::uint8_t>(~out_[i]);
+    }
+};
+
+// 类型通过特化NormalizedKeyTraits声明键长和编码方式，编码顺序必须与operator<=>的比较顺序一致
+template<typename T>
+struct NormalizedKeyTraits;
+
+template<typename T>
+concept NormalizedKeyEncodable = requires(const T& value, KeyWriter<NormalizedKeyTraits<T>::key_size>& writer) {
+    { NormalizedKeyTraits<T>::key_size } -> std::convertible_to<std::size_t>;
+    NormalizedKeyTraits<T>::encode(value, writer);
+} && std::three_way_comparable<T>;
+
+// 姓、名各占12字节(11字节内容+长度)；年龄不参与比较，也就不进键
+template<>
+struct NormalizedKeyTraits<Person> {
+    static constexpr std::size_t key_size = 24;
+    static void encode(const Person& p, KeyWriter<key_size>& w) {
+        w.put_string(p.last_name, 12);
+        w.put_string(p.first_name, 12);
+    }
+};
+
+// 正式版排在同号预发布版之后：先写"是否正式版"，再写预发布标签
+template<>
+struct NormalizedKeyTraits<Version> {
+    static constexpr std::size_t key_size = 24;
+    static void encode(const Version& v, KeyWriter<key_size>& w) {
+        w.put_int(v.major);
+        w.put_int(v.minor);
+        w.put_int(v.patch);
+        w.put_bool(v.prerelease.empty());
+        w.put_string(v.prerelease, 11);
+    }
+};
+
+// 与Task::operator<=>一致：is_urgent升序、priority降序、deadline升序、name升序
+template<>
+struct NormalizedKeyTraits<Task> {
+    static constexpr std::size_t key_size = 24;
+    static void encode(const Task& t, KeyWriter<key_size>& w) {
+        w.put_bool(t.is_urgent);
+        w.put_int(t.priority, /*descending=*/true);
+        w.put_int(static_cast<std::int64_t>(t.deadline.time_since_epoch().count()));
+        w.put_string(t.name, 11);
+    }
+};
+
+namespace normalized_sort_detail {
+    inline constexpr std::uint32_t kInexact = 0x8000'0000u;  // 行号最高位标记键不精确
+    inline constexpr std::size_t kSmallRange = 48;           // 小区间改用比较排序
+    
+    template<std::size_t N>
+    struct KeyEntry {
+        std::array<std::uint8_t, N> key;
+        std::uint32_t row;
+        
+        std::uint32_t index() const { return row & ~kInexact; }
+        bool exact() const { return (row & kInexact) == 0; }
+    };
+    
+    // 键完全相同时：两边都精确说明元素等价，否则回到operator<=>
+    template<std::size_t N, typename T>
+    bool entry_less(const KeyEntry<N>& a, const KeyEntry<N>& b, std::size_t depth, const std::vector<T>& data) {
+        if (const int cmp = std::memcmp(a.key.data() + depth, b.key.data() + depth, N - depth); cmp != 0) {
+            return cmp < 0;
+        }
+        if (a.exact() && b.exact()) return false;
+        return data[a.index()] < data[b.index()];
+    }
+    
+    // MSD基数排序：按第depth字节分桶，递归处理下一字节；所有元素落在同一桶时不搬数据
+    template<std::size_t N, typename T>
+    void msd_radix_sort(KeyEntry<N>* first, KeyEntry<N>* last, KeyEntry<N>* scratch,
+                        std::size_t depth, const std::vector<T>& data) {
+        const auto n = static_cast<std::size_t>(last - first);
+        if (n < 2) return;
+        if (depth == N || n <= kSmallRange) {
+            std::sort(first, last, [&](const KeyEntry<N>& a, const KeyEntry<N>& b) {
+                return entry_less(a, b, depth, data);
+            });
+            return;
+        }
+        
+        std::array<std::size_t, 256> count{};
+        for (auto* p = first; p != last; ++p) ++count[p->key[depth]];
+        if (count[first->key[depth]] == n) {
+            msd_radix_sort(first, last, scratch, depth + 1, data);
+            return;
+        }
+        
+        std::array<std::size_t, 256> offset{};
+        for (std::size_t b = 1; b < 256; ++b) offset[b] = offset[b - 1] + count[b - 1];
+        for (auto* p = first; p != last; ++p) scratch[offset[p->key[depth]]++] = *p;
+        std::copy(scratch, scratch + n, first);
+        
+        std::size_t start = 0;
+        for (std::size_t b = 0; b < 256; ++b) {
+            if (count[b] > 1) msd_radix_sort(first + start, first + start + count[b], scratch, depth + 1, data);
+            start += count[b];
+        }
+    }
+    
+    // order[k]是排序后第k个位置的元素原来所在的行；沿置换环原地移动，每个元素只搬一次
+    template<typename T>
+    void apply_permutation(std::vector<T>& data, std::vector<std::uint32_t>& order) {
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (order[i] == i) continue;
+            T carried = std::move(data[i]);
+            std::size_t hole = i;
+            while (order[hole] != i) {
+                const std::size_t next = order[hole];
+                data[hole] = std::move(data[next]);
+                order[hole] = static_cast<std::uint32_t>(hole);
+                hole = next;
+            }
+            data[hole] = std::move(carried);
+            order[hole] = static_cast<std::uint32_t>(hole);
+        }
+    }
+    
+    inline void check_row_count(std::size_t rows) {
+        if (rows >= kInexact) throw std::length_error("行数超出规范化键排序的上限(2^31)");
+    }
+}
+
+// 规范化键排序：编码 -> 键的MSD基数排序 -> 一次置换
+template<NormalizedKeyEncodable T>
+void normalized_sort(std::vector<T>& data, bool descending = false) {
+    using namespace normalized_sort_detail;
+    using Traits = NormalizedKeyTraits<T>;
+    constexpr std::size_t N = Traits::key_size;
+    check_row_count(data.size());
+    
+    std::vector<KeyEntry<N>> entries(data.size());
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        KeyWriter<N> writer(entries[i].key.data());
+        Traits::encode(data[i], writer);
+        writer.finish();
+        entries[i].row = static_cast<std::uint32_t>(i) | (writer.exact() ? 0u : kInexact);
+    }
+    
+    std::vector<KeyEntry<N>> scratch(entries.size());
+    msd_radix_sort(entries.data(), entries.data() + entries.size(), scratch.data(), 0, data);
+    
+    std::vector<std::uint32_t> order(entries.size());
+    for (std::size_t k = 0; k < entries.size(); ++k) {
+        order[k] = entries[descending ? entries.size() - 1 - k : k].index();
+    }
+    apply_permutation(data, order);
+}
+
+// Schwartzian变换：没有键编码的类型，先把投影(通常是成员视图组成的tuple)算一次缓存起来，
+// 排序只比较缓存的投影，最后同样做一次置换。投影里的string_view指向原元素，排序期间元素不动
+template<typename T, typename Projection>
+void schwartzian_sort(std::vector<T>& data, Projection project, bool descending = false) {
+    using namespace normalized_sort_detail;
+    using Key = std::remove_cvref_t<std::invoke_result_t<Projection&, const T&>>;
+    check_row_count(data.size());
+    
+    std::vector<std::pair<Key, std::uint32_t>> keyed;
+    keyed.reserve(data.size());
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        keyed.emplace_back(project(data[i]), static_cast<std::uint32_t>(i));
+    }
+    std::sort(keyed.begin(), keyed.end(), [descending](const auto& a, const auto& b) {
+        return descending ? b.first < a.first : a.first < b.first;
+    });
+    
+    std::vector<std::uint32_t> order(keyed.size());
+    for (std::size_t k = 0; k < keyed.size(); ++k) order[k] = keyed[k].second;
+    keyed.clear();  // 投影可能引用元素，置换之前丢掉
+    apply_permutation(data, order);
+}
+
+template<typename T, typename SortFunc>
+double time_sort_ms(const std::vector<T>& original, std::vector<T>& result, SortFunc&& sort_func) {
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < 3; ++round) {
+        result = original;
+        auto start = std::chrono::steady_clock::now();
+        sort_func(result);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+template<typename T, typename Projection>
+void compare_sort_strategies(const std::string& name, const std::vector<T>& original, Projection project) {
+    std::vector<T> by_comparator, by_schwartzian, by_key;
+    const double comparator_ms = time_sort_ms(original, by_comparator, [](auto& v) { std::sort(v.begin(), v.end()); });
+    const double schwartzian_ms = time_sort_ms(original, by_schwartzian, [&](auto& v) { schwartzian_sort(v, project); });
+    const double key_ms = time_sort_ms(original, by_key, [](auto& v) { normalized_sort(v); });
+    
+    // 等价元素的相对顺序可以不同，所以逐位置检查"与std::sort的结果等价"，而不是要求完全相同
+    auto equivalent = [](const T& a, const T& b) { return std::is_eq(a <=> b); };
+    const bool ok = std::equal(by_key.begin(), by_key.end(), by_comparator.begin(), by_comparator.end(), equivalent) &&
+                    std::equal(by_schwartzian.begin(), by_schwartzian.end(), by_comparator.begin(), equivalent);
+    std::cout << "  " << name << " (" << original.size() << "行): operator<=> " << comparator_ms
+              << " ms, Schwartzian " << schwartzian_ms << " ms, 规范化键 " << key_ms << " ms ("
+              << comparator_ms / key_ms << "x) " << (ok ? "结果有序" : "结果错误!") << "\n";
+}
+
+void demonstrate_normalized_key_sort() {
+    std::cout << "=== 规范化键排序：字节比较代替多字段<=> ===\n";
+    
+    // 编码示例：看看字节序如何对应比较结果
+    auto dump = [](const Version& v) {
+        std::array<std::uint8_t, 24> key{};
+        KeyWriter<24> writer(key.data());
+        NormalizedKeyTraits<Version>::encode(v, writer);
+        writer.finish();
+        std::cout << "  " << v.to_string() << "\t-> ";
+        for (std::size_t i = 0; i < 16; ++i) {
+            std::cout << "0123456789abcdef"[key[i] >> 4] << "0123456789abcdef"[key[i] & 15] << (i % 4 == 3 ? " " : "");
+        }
+        std::cout << "... 精确: " << (writer.exact() ? "是" : "否") << "\n";
+    };
+    dump({2, 1, 0, "beta"});
+    dump({2, 1, 0, ""});
+    dump({-1, 0, 0, "a-very-long-tag"});
+    
+    std::mt19937 rng(2024);
+    const std::vector<std::string> surnames = {"Zhang", "Wang", "Li", "Zhao", "Chen", "Liu", "Yang", "Huang",
+                                               "Wu", "Zhou", "Xu", "Sun", "Ma", "Zhu", "Hu", "Guo", "Lin", "Ouyang"};
+    auto random_word = [&](std::size_t min_len, std::size_t max_len) {
+        std::string word(min_len + rng() % (max_len - min_len + 1), 'a');
+        for (auto& c : word) c = static_cast<char>('a' + rng() % 26);
+        return word;
+    };
+    
+    constexpr std::size_t rows = 300'000;
+    std::vector<Person> people;
+    std::vector<Version> versions;
+    std::vector<Task> tasks;
+    const auto epoch = std::chrono::system_clock::time_point{};
+    for (std::size_t i = 0; i < rows; ++i) {
+        people.push_back({random_word(3, 14), surnames[rng() % surnames.size()], static_cast<int>(rng() % 90)});
+        versions.push_back({static_cast<int>(rng() % 4), static_cast<int>(rng() % 20), static_cast<int>(rng() % 50),
+                            rng() % 3 ? "" : "rc" + std::to_string(rng() % 12)});
+        tasks.push_back({"task-" + random_word(4, 16), static_cast<int>(rng() % 10),
+                         epoch + std::chrono::hours(rng() % 10000), rng() % 8 == 0});
+    }
+    
+    std::cout << std::fixed << std::setprecision(1);
+    compare_sort_strategies("Person", people, [](const Person& p) {
+        return std::tuple<std::string_view, std::string_view>(p.last_name, p.first_name);
+    });
+    compare_sort_strategies("Version", versions, [](const Version& v) {
+        return std::tuple<int, int, int, bool, std::string_view>(v.major, v.minor, v.patch, v.prerelease.empty(), v.prerelease);
+    });
+    compare_sort_strategies("Task", tasks, [](const Task& t) {
+        return std::tuple<bool, std::int64_t, std::chrono::system_clock::time_point, std::string_view>(
+            t.is_urgent, -static_cast<std::int64_t>(t.priority), t.deadline, t.name);
+    });
+    std::cout << std::defaultfloat << std::setprecision(6);
+    
+    std::cout << "- 键的基数排序每个字节只看一次，比较排序的每次比较都要重新走一遍多个字段\n";
+    std::cout << "- 前缀截断让键保持定长；只有键完全相同且不精确时才回到operator<=>\n";
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++20 三向比较运算符深度解析\n";
@@ -595,6 +965,7 @@ int main() {
     demonstrate_custom_comparison_logic();
     demonstrate_performance_analysis();
     demonstrate_comprehensive_example();
+    demonstrate_normalized_key_sort();
     
     return 0;
 }
@@ -610,6 +981,7 @@ g++ -std=c++20 -O2 -Wall 05_three_way_comparison.cpp -o three_way_comparison
 3. 编译器可以为聚合类型自动生成比较逻辑
 4. 自定义比较逻辑可以实现复杂的业务排序需求
 5. 相比传统方式，三向比较在性能和代码简洁性上都有优势
+6. 保序编码(大端整数、翻转符号位、浮点位变换、字符串前缀)让多字段比较退化为memcmp，可直接做基数排序
 
 注意事项:
 - 三向比较和相等比较需要分别实现
@@ -617,4 +989,5 @@ g++ -std=c++20 -O2 -Wall 05_three_way_comparison.cpp -o three_way_comparison
 - 选择合适的比较类别对算法正确性很重要
 - 自定义比较逻辑要确保传递性和一致性
 - 浮点数比较需要特别处理NaN等特殊值
+- 规范化键的编码顺序必须与operator<=>逐字段一致，改了比较逻辑要同步改NormalizedKeyTraits
 */
\ No newline at end of file
@@ -7,6 +7,7 @@
  * 3. std::jthread - 可中断线程，自动join的RAII线程管理
  * 4. 指定初始化器 - 结构化初始化语法，提高代码可读性
  * 5. 范围for循环初始化 - 循环作用域变量初始化增强
+ * 6. 可组合多级流水线 - source | stage | sink，信用背压、微批发送与stop_token优雅排空
  */
 
 #include <iostream>
@@ -22,6 +23,13 @@
 #include <type_traits>
 #include <algorithm>
 #include <numeric>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <optional>
 
 using namespace std::chrono_literals;
 
@@ -439,11 +447,686 @@ void demonstrate_range_for_init() {
     std::cout << "\n";
 }
 
+// ===== 6. 单生产者单消费者(SPSC)无等待环形队列 =====
+// 只有一个生产者和一个消费者时，不需要CAS也不需要锁：
+// 1. 写下标只由生产者修改，读下标只由消费者修改，各自一次release store发布
+// 2. 双方各缓存一份对方的下标，只有缓存值显示"满/空"时才去读共享原子变量
+// 3. stage + commit_batch 把N次写入合并为一次release store
+template<typename T>
+class SpscRing {
+private:
+    static constexpr std::size_t kCacheLine = 64;
+
+    const std::size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    // 消费者侧：读下标 + 缓存的写下标
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+
+    // 生产者侧：已发布写下标 + 未发布写下标 + 缓存的读下标
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+    std::size_t staged_tail_ = 0;
+    std::size_t cached_head_ = 0;
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t cap = 2;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+public:
+    explicit SpscRing(std::size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1), slots_(std::make_unique<T[]>(mask_ + 1)) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    // ---- 生产者接口 ----
+
+    // 写入但不发布，消费者在commit_batch之前看不到
+    bool try_stage(T value) {
+        if (staged_tail_ - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (staged_tail_ - cached_head_ > mask_) {
+                return false;  // 真的满了
+            }
+        }
+        slots_[staged_tail_ & mask_] = std::move(value);
+        ++staged_tail_;
+        return true;
+    }
+
+    // 一次release store发布所有已stage的元素
+    void commit_batch() {
+        tail_.store(staged_tail_, std::memory_order_release);
+    }
+
+    bool try_push(T value) {
+        if (!try_stage(std::move(value))) {
+            return false;
+        }
+        commit_batch();
+        return true;
+    }
+
+    // ---- 消费者接口 ----
+
+    bool try_pop(T& out) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        out = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 批量读取，同样只用一次release store归还槽位
+    std::size_t pop_batch(std::span<T> out) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < out.size()) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        std::size_t n = std::min(out.size(), cached_tail_ - head);
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::move(slots_[(head + i) & mask_]);
+        }
+        if (n > 0) {
+            head_.store(head + n, std::memory_order_release);
+        }
+        return n;
+    }
+};
+
+// 对照组：mutex + deque，代表ProducerConsumerQueue/AsyncQueue一类实现的同步开销
+template<typename T>
+class MutexQueue {
+private:
+    std::mutex mtx_;
+    std::deque<T> items_;
+
+public:
+    bool try_push(T value) {
+        std::lock_guard lock(mtx_);
+        items_.push_back(std::move(value));
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        std::lock_guard lock(mtx_);
+        if (items_.empty()) return false;
+        out = std::move(items_.front());
+        items_.pop_front();
+        return true;
+    }
+};
+
+template<typename Queue, typename Producer>
+double measure_spsc_throughput(Queue& queue, std::size_t count, Producer produce) {
+    auto start = std::chrono::steady_clock::now();
+    std::jthread producer([&] { produce(queue, count); });
+
+    double sum = 0.0;
+    double value = 0.0;
+    for (std::size_t received = 0; received < count;) {
+        if (queue.try_pop(value)) {
+            sum += value;
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sum < 0) std::cout << sum;  // 防止求和被优化掉
+    return static_cast<double>(count) / elapsed;
+}
+
+void demonstrate_spsc_queue() {
+    std::cout << "=== SPSC无等待环形队列演示 ===\n";
+
+    constexpr std::size_t count = 5'000'000;
+    constexpr std::size_t batch = 64;
+
+    MutexQueue<double> locked;
+    double locked_rate = measure_spsc_throughput(locked, count, [](auto& q, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) q.try_push(static_cast<double>(i));
+    });
+
+    SpscRing<double> ring(4096);
+    double single_rate = measure_spsc_throughput(ring, count, [](auto& q, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            while (!q.try_push(static_cast<double>(i))) std::this_thread::yield();
+        }
+    });
+
+    SpscRing<double> batched(4096);
+    double batch_rate = measure_spsc_throughput(batched, count, [](auto& q, std::size_t n) {
+        for (std::size_t i = 0; i < n;) {
+            std::size_t end = std::min(n, i + batch);
+            for (; i < end; ++i) {
+                while (!q.try_stage(static_cast<double>(i))) {
+                    q.commit_batch();  // 满时先发布已写入部分，让消费者腾出空间
+                    std::this_thread::yield();
+                }
+            }
+            q.commit_batch();
+        }
+    });
+
+    std::cout << std::format("mutex + deque:          {:>8.2f} M ops/s\n", locked_rate / 1e6);
+    std::cout << std::format("SpscRing 逐个发布:      {:>8.2f} M ops/s ({:.1f}x)\n",
+                             single_rate / 1e6, single_rate / locked_rate);
+    std::cout << std::format("SpscRing 批量发布({}):  {:>8.2f} M ops/s ({:.1f}x)\n",
+                             batch, batch_rate / 1e6, batch_rate / locked_rate);
+    std::cout << "注：提升幅度取决于核数与缓存拓扑，生产者和消费者位于不同物理核时差距最明显\n";
+
+    std::cout << "\n";
+}
+
+// ===== 7. 可组合多级流水线：信用背压、微批与分级并行 =====
+// source(f) | stage(g, {.parallelism = N}) | sink(h)
+// 1. 阶段之间是有界的批通道，生产者先拿信用额度再入队；下游处理完一批才归还额度，
+//    所以每级"排队 + 处理中"的条数都有上限，慢的下游会一路把压力传回源头
+// 2. 每个阶段的输出先攒成微批：满max_batch条或最早一条等待超过max_delay就发出，
+//    一次加锁搬运一批，而不是每条数据一次
+// 3. stop_token只送给源头：停止时源头不再产生数据，其余阶段把通道里的数据处理完再退出
+// 4. 并行阶段的多个worker共享输入通道，输出顺序不保证与输入一致
+
+struct StageOptions {
+    std::string name = "stage";
+    std::size_t parallelism = 1;
+    std::size_t max_batch = 64;                          // 满多少条发出一批
+    std::chrono::microseconds max_delay{200};            // 未满的批最多等待多久
+    std::size_t queue_capacity = 1024;                   // 输出通道的信用额度(条)
+};
+
+struct StageCounters {
+    std::atomic<std::uint64_t> items_in{0};
+    std::atomic<std::uint64_t> items_out{0};
+    std::atomic<std::uint64_t> batches_out{0};
+    std::atomic<std::uint64_t> busy_ns{0};      // 执行用户函数的时间
+    std::atomic<std::uint64_t> blocked_ns{0};   // 等待下游归还额度的时间，即背压
+};
+
+struct StageMetrics {
+    std::string name;
+    std::size_t parallelism = 1;
+    std::uint64_t items_in = 0;
+    std::uint64_t items_out = 0;
+    std::uint64_t batches_out = 0;
+    std::size_t queue_depth = 0;       // 输出通道当前占用的额度
+    std::size_t max_queue_depth = 0;
+    double busy_ms = 0.0;
+    double blocked_ms = 0.0;
+};
+
+template<typename T>
+class BatchChannel {
+public:
+    using clock = std::chrono::steady_clock;
+    enum class PopStatus { Ok, Timeout, Closed };
+
+    BatchChannel(std::size_t credits, std::size_t producers)
+        : credits_(std::max<std::size_t>(credits, 1)), producers_(producers) {}
+
+    std::size_t credits() const { return credits_; }
+
+    // 额度不足时阻塞，这就是背压；批大小不能超过总额度
+    void push(std::vector<T> batch) {
+        std::unique_lock lock(mtx_);
+        not_full_.wait(lock, [&] { return in_flight_ + batch.size() <= credits_; });
+        in_flight_ += batch.size();
+        max_in_flight_ = std::max(max_in_flight_, in_flight_);
+        batches_.push_back(std::move(batch));
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    // 在deadline之前取一批；通道关闭且已取空时返回Closed。deadline为max表示一直等
+    PopStatus pop(std::vector<T>& out, clock::time_point deadline = clock::time_point::max()) {
+        std::unique_lock lock(mtx_);
+        auto ready = [&] { return !batches_.empty() || closed_; };
+        if (deadline == clock::time_point::max()) {
+            not_empty_.wait(lock, ready);
+        } else if (!not_empty_.wait_until(lock, deadline, ready)) {
+            return PopStatus::Timeout;
+        }
+        if (batches_.empty()) return PopStatus::Closed;
+        out = std::move(batches_.front());
+        batches_.pop_front();
+        return PopStatus::Ok;
+    }
+
+    // 消费者处理完一批后归还额度
+    void release(std::size_t n) {
+        {
+            std::lock_guard lock(mtx_);
+            in_flight_ -= n;
+        }
+        not_full_.notify_all();
+    }
+
+    // 每个生产者结束时调用一次，最后一个生产者关闭通道
+    void producer_done() {
+        {
+            std::lock_guard lock(mtx_);
+            if (--producers_ > 0) return;
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+    }
+
+    std::size_t depth() const {
+        std::lock_guard lock(mtx_);
+        return in_flight_;
+    }
+
+    std::size_t max_depth() const {
+        std::lock_guard lock(mtx_);
+        return max_in_flight_;
+    }
+
+private:
+    mutable std::mutex mtx_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<std::vector<T>> batches_;
+    const std::size_t credits_;
+    std::size_t in_flight_ = 0;
+    std::size_t max_in_flight_ = 0;
+    std::size_t producers_;
+    bool closed_ = false;
+};
+
+// 每个worker独占一个微批器：攒够max_batch条或超过max_delay就推给下游
+template<typename T>
+class BatchEmitter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    BatchEmitter(BatchChannel<T>& out, const StageOptions& options, StageCounters& counters)
+        : out_(out), max_batch_(std::clamp<std::size_t>(options.max_batch, 1, out.credits())),
+          max_delay_(options.max_delay), counters_(counters) {
+        pending_.reserve(max_batch_);
+    }
+
+    void emit(T value) {
+        if (pending_.empty()) first_at_ = clock::now();
+        pending_.push_back(std::move(value));
+        if (pending_.size() >= max_batch_) flush();
+    }
+
+    // 最早一条数据的发出期限；没有待发数据时为max
+    clock::time_point deadline() const {
+        return pending_.empty() ? clock::time_point::max() : first_at_ + max_delay_;
+    }
+
+    void flush_if_due(clock::time_point now) {
+        if (now >= deadline()) flush();
+    }
+
+    // 本worker累计的背压等待，用来从执行时间里扣除
+    std::uint64_t blocked_ns() const { return blocked_ns_; }
+
+    void flush() {
+        if (pending_.empty()) return;
+        const std::size_t n = pending_.size();
+        const auto start = clock::now();
+        out_.push(std::move(pending_));
+        const auto blocked = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+        blocked_ns_ += blocked;
+        counters_.blocked_ns += blocked;
+        counters_.items_out += n;
+        ++counters_.batches_out;
+        pending_ = {};
+        pending_.reserve(max_batch_);
+    }
+
+private:
+    BatchChannel<T>& out_;
+    std::size_t max_batch_;
+    std::chrono::microseconds max_delay_;
+    StageCounters& counters_;
+    std::vector<T> pending_;
+    clock::time_point first_at_{};
+    std::uint64_t blocked_ns_ = 0;
+};
+
+// 构建期共享的状态：每个阶段的计数器、输出通道深度和待启动的worker
+struct PipelineState {
+    struct Stage {
+        StageOptions options;
+        std::unique_ptr<StageCounters> counters = std::make_unique<StageCounters>();
+        std::function<std::size_t()> depth = [] { return std::size_t{0}; };
+        std::function<std::size_t()> max_depth = [] { return std::size_t{0}; };
+        std::vector<std::function<void(std::stop_token)>> workers;
+    };
+    std::vector<Stage> stages;
+};
+
+template<typename F> struct SourceSpec { F fn; StageOptions options; };
+template<typename F> struct StageSpec { F fn; StageOptions options; };
+template<typename F> struct SinkSpec { F fn; StageOptions options; };
+
+// 源函数签名：std::optional<T>(std::stop_token)，返回nullopt表示数据耗尽
+template<typename F> SourceSpec<F> source(F fn, StageOptions options = {}) { return {std::move(fn), std::move(options)}; }
+// 阶段函数签名：Out(In)
+template<typename F> StageSpec<F> stage(F fn, StageOptions options = {}) { return {std::move(fn), std::move(options)}; }
+// 汇函数签名：void(In)
+template<typename F> SinkSpec<F> sink(F fn, StageOptions options = {}) { return {std::move(fn), std::move(options)}; }
+
+// 运行中的流水线：持有所有worker线程，析构时优雅排空
+class StreamPipeline {
+public:
+    explicit StreamPipeline(std::shared_ptr<PipelineState> state) : state_(std::move(state)) {}
+
+    StreamPipeline(StreamPipeline&&) = default;
+    StreamPipeline& operator=(StreamPipeline&&) = delete;
+
+    ~StreamPipeline() { stop(); }
+
+    void start() {
+        started_at_ = std::chrono::steady_clock::now();
+        for (auto& stage : state_->stages) {
+            for (auto& worker : stage.workers) {
+                threads_.emplace_back(std::move(worker));
+            }
+            stage.workers.clear();
+        }
+    }
+
+    // 只通知源头停止，然后等待下游把已产生的数据全部处理完
+    void stop() {
+        if (!threads_.empty()) threads_.front().request_stop();
+        wait();
+    }
+
+    // 有限数据源：等待源头耗尽并排空
+    void wait() {
+        for (auto& thread : threads_) {
+            if (thread.joinable()) thread.join();
+        }
+        if (!threads_.empty() && finished_at_ == std::chrono::steady_clock::time_point{}) {
+            finished_at_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    std::vector<StageMetrics> metrics() const {
+        std::vector<StageMetrics> result;
+        for (const auto& stage : state_->stages) {
+            const auto& c = *stage.counters;
+            result.push_back({
+                .name = stage.options.name,
+                .parallelism = stage.options.parallelism,
+                .items_in = c.items_in.load(),
+                .items_out = c.items_out.load(),
+                .batches_out = c.batches_out.load(),
+                .queue_depth = stage.depth(),
+                .max_queue_depth = stage.max_depth(),
+                .busy_ms = static_cast<double>(c.busy_ns.load()) / 1e6,
+                .blocked_ms = static_cast<double>(c.blocked_ns.load()) / 1e6,
+            });
+        }
+        return result;
+    }
+
+    void print_metrics() const {
+        const auto end = finished_at_ == std::chrono::steady_clock::time_point{} ? std::chrono::steady_clock::now()
+                                                                                 : finished_at_;
+        const double seconds = std::chrono::duration<double>(end - started_at_).count();
+        for (const auto& m : metrics()) {
+            const std::uint64_t items = std::max(m.items_in, m.items_out);
+            const double rate = seconds > 0 ? static_cast<double>(items) / seconds / 1e6 : 0.0;
+            const double avg_batch = m.batches_out ? static_cast<double>(m.items_out) / m.batches_out : 0.0;
+            std::cout << std::format("  {:<8} x{}  输入 {:>8}  输出 {:>8}  {:>6.2f} M条/秒  平均批 {:>5.1f}  "
+                                     "队列 {}/{}  执行 {:.1f}ms  背压等待 {:.1f}ms\n",
+                                     m.name, m.parallelism, m.items_in, m.items_out, rate, avg_batch,
+                                     m.queue_depth, m.max_queue_depth, m.busy_ms, m.blocked_ms);
+        }
+    }
+
+private:
+    std::shared_ptr<PipelineState> state_;
+    std::vector<std::jthread> threads_;
+    std::chrono::steady_clock::time_point started_at_{};
+    std::chrono::steady_clock::time_point finished_at_{};
+};
+
+// 构建中的流水线，T是当前最后一级的输出类型
+template<typename T>
+class PipelineBuilder {
+public:
+    using value_type = T;
+
+    PipelineBuilder(std::shared_ptr<PipelineState> state, std::shared_ptr<BatchChannel<T>> tail)
+        : state_(std::move(state)), tail_(std::move(tail)) {}
+
+    template<typename F>
+    friend auto operator|(PipelineBuilder builder, StageSpec<F> spec) {
+        using Out = std::invoke_result_t<F&, T>;
+        auto& stage = builder.add_stage(spec.options);
+        auto out = make_channel<Out>(stage);
+        auto fn = std::make_shared<F>(std::move(spec.fn));
+        for (std::size_t w = 0; w < stage.options.parallelism; ++w) {
+            stage.workers.push_back([in = builder.tail_, out, fn, options = stage.options,
+                                     &counters = *stage.counters](std::stop_token) {
+                run_stage_worker(*in, *out, *fn, options, counters);
+            });
+        }
+        return PipelineBuilder<Out>(std::move(builder.state_), std::move(out));
+    }
+
+    template<typename F>
+    friend StreamPipeline operator|(PipelineBuilder builder, SinkSpec<F> spec) {
+        auto& stage = builder.add_stage(spec.options);
+        auto fn = std::make_shared<F>(std::move(spec.fn));
+        for (std::size_t w = 0; w < stage.options.parallelism; ++w) {
+            stage.workers.push_back([in = builder.tail_, fn, &counters = *stage.counters](std::stop_token) {
+                std::vector<T> batch;
+                while (in->pop(batch) == BatchChannel<T>::PopStatus::Ok) {
+                    const auto start = std::chrono::steady_clock::now();
+                    for (auto& item : batch) (*fn)(std::move(item));
+                    counters.busy_ns += elapsed_ns(start);
+                    counters.items_in += batch.size();
+                    in->release(batch.size());
+                }
+            });
+        }
+        return StreamPipeline(std::move(builder.state_));
+    }
+
+    template<typename F>
+    static PipelineBuilder from_source(SourceSpec<F> spec) {
+        auto state = std::make_shared<PipelineState>();
+        spec.options.parallelism = 1;  // 源头只有一个线程，它持有stop_token
+        auto& stage = state->stages.emplace_back();
+        stage.options = std::move(spec.options);
+        auto out = make_channel<T>(stage);
+        stage.workers.push_back([out, fn = std::move(spec.fn), options = stage.options,
+                                 &counters = *stage.counters](std::stop_token stoken) mutable {
+            BatchEmitter<T> emitter(*out, options, counters);
+            // 快的源每产生一批才读一次时钟；单条耗时超过1μs的慢源逐条检查max_delay
+            std::size_t stride = 1;
+            bool exhausted = false;
+            while (!exhausted && !stoken.stop_requested()) {
+                const auto start = std::chrono::steady_clock::now();
+                const std::uint64_t blocked_before = emitter.blocked_ns();
+                std::size_t produced = 0;
+                for (; produced < stride; ++produced) {
+                    std::optional<T> value = fn(stoken);
+                    if (!value) {
+                        exhausted = true;
+                        break;
+                    }
+                    emitter.emit(std::move(*value));
+                }
+                const auto now = std::chrono::steady_clock::now();
+                const std::uint64_t busy = elapsed_ns(start) - (emitter.blocked_ns() - blocked_before);
+                counters.busy_ns += busy;
+                stride = (produced > 0 && busy / produced < 1000) ? std::max<std::size_t>(options.max_batch, 1) : 1;
+                emitter.flush_if_due(now);
+            }
+            emitter.flush();
+            out->producer_done();
+        });
+        return PipelineBuilder(std::move(state), std::move(out));
+    }
+
+private:
+    template<typename> friend class PipelineBuilder;
+
+    std::shared_ptr<PipelineState> state_;
+    std::shared_ptr<BatchChannel<T>> tail_;
+
+    PipelineState::Stage& add_stage(StageOptions options) {
+        options.parallelism = std::max<std::size_t>(options.parallelism, 1);
+        auto& stage = state_->stages.emplace_back();
+        stage.options = std::move(options);
+        return stage;
+    }
+
+    // 输出通道的额度至少容纳一个完整的批，否则生产者永远拿不到额度
+    template<typename U>
+    static std::shared_ptr<BatchChannel<U>> make_channel(PipelineState::Stage& stage) {
+        auto channel = std::make_shared<BatchChannel<U>>(
+            std::max(stage.options.queue_capacity, stage.options.max_batch), stage.options.parallelism);
+        stage.depth = [channel] { return channel->depth(); };
+        stage.max_depth = [channel] { return channel->max_depth(); };
+        return channel;
+    }
+
+    static std::uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    template<typename Out, typename F>
+    static void run_stage_worker(BatchChannel<T>& in, BatchChannel<Out>& out, F& fn,
+                                 const StageOptions& options, StageCounters& counters) {
+        BatchEmitter<Out> emitter(out, options, counters);
+        std::vector<T> batch;
+        for (;;) {
+            const auto status = in.pop(batch, emitter.deadline());
+            if (status == BatchChannel<T>::PopStatus::Closed) break;
+            if (status == BatchChannel<T>::PopStatus::Timeout) {
+                emitter.flush();  // 上游暂时没有数据，未满的批也不再等待
+                continue;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            const std::uint64_t blocked_before = emitter.blocked_ns();
+            for (auto& item : batch) emitter.emit(fn(std::move(item)));
+            counters.busy_ns += elapsed_ns(start) - (emitter.blocked_ns() - blocked_before);
+            counters.items_in += batch.size();
+            in.release(batch.size());
+            emitter.flush_if_due(std::chrono::steady_clock::now());
+        }
+        emitter.flush();
+        out.producer_done();
+    }
+};
+
+template<typename F>
+auto operator|(SourceSpec<F> spec, auto next) {
+    using T = typename std::invoke_result_t<F&, std::stop_token>::value_type;
+    return PipelineBuilder<T>::from_source(std::move(spec)) | std::move(next);
+}
+
+void demonstrate_stream_pipeline() {
+    std::cout << "=== 可组合多级流水线演示 ===\n";
+
+    struct Reading {
+        std::uint32_t sensor;
+        double value;
+    };
+
+    // 有限数据源：跑完即止，看各级吞吐和实际批大小
+    {
+        constexpr std::uint32_t total = 1'000'000;
+        std::uint32_t next = 0;
+        std::uint64_t received = 0;
+        std::uint64_t sensor_sum = 0;
+
+        auto pipeline = source([&next](std::stop_token) -> std::optional<Reading> {
+                            if (next == total) return std::nullopt;
+                            const std::uint32_t i = next++;
+                            return Reading{i % 64, static_cast<double>(i % 1000) * 0.1};
+                        }, {.name = "采集", .max_batch = 256})
+                      | stage([](Reading r) {
+                            r.value = r.value * 1.8 + 32.0;  // 摄氏转华氏
+                            return r;
+                        }, {.name = "转换", .parallelism = 2, .max_batch = 256})
+                      | stage([](Reading r) { return std::uint64_t{r.sensor}; },
+                              {.name = "提取", .max_batch = 256})
+                      | sink([&](std::uint64_t sensor) {
+                            ++received;
+                            sensor_sum += sensor;
+                        }, {.name = "写入"});
+        pipeline.start();
+        pipeline.wait();
+
+        std::cout << std::format("有限数据源 {} 条，汇收到 {} 条，传感器编号和 {}（期望 {}）\n",
+                                 total, received, sensor_sum, std::uint64_t{total} / 64 * (63 * 64 / 2));
+        pipeline.print_metrics();
+    }
+
+    // 慢消费者：小额度通道把压力传回源头，队列深度不超过额度；stop后排空，不丢数据
+    {
+        std::uint64_t produced = 0;
+        std::uint64_t consumed = 0;
+        auto pipeline = source([&produced](std::stop_token) -> std::optional<std::uint64_t> { return produced++; },
+                               {.name = "采集", .max_batch = 32, .queue_capacity = 128})
+                      | stage([](std::uint64_t v) { return v * 2; },
+                              {.name = "转换", .max_batch = 32, .queue_capacity = 128})
+                      | sink([&consumed](std::uint64_t) {
+                            ++consumed;
+                            if (consumed % 32 == 0) std::this_thread::sleep_for(200us);
+                        }, {.name = "慢写入"});
+        pipeline.start();
+        std::this_thread::sleep_for(300ms);
+        pipeline.stop();
+
+        std::cout << std::format("\n慢消费者：源头产生 {} 条，汇处理 {} 条，丢失 {} 条\n",
+                                 produced, consumed, produced - consumed);
+        pipeline.print_metrics();
+    }
+
+    // 低速数据源：凑不满一批时按max_delay发出，延迟有上界
+    {
+        int remaining = 40;
+        std::uint64_t received = 0;
+        auto pipeline = source([&remaining](std::stop_token) -> std::optional<int> {
+                            if (remaining == 0) return std::nullopt;
+                            std::this_thread::sleep_for(250us);
+                            return remaining--;
+                        }, {.name = "低速源", .max_batch = 64, .max_delay = 2ms})
+                      | sink([&received](int) { ++received; }, {.name = "写入"});
+        pipeline.start();
+        pipeline.wait();
+
+        const auto m = pipeline.metrics().front();
+        std::cout << std::format("\n低速数据源：{} 条分成 {} 批发出（max_batch=64, max_delay=2ms），汇收到 {} 条\n",
+                                 m.items_out, m.batches_out, received);
+    }
+
+    std::cout << "\n";
+}
+
 // ===== 综合示例：现代C++20数据处理管道 =====
 class DataPipeline {
 private:
-    std::jthread worker_;
+    // 线程成员声明在最后：析构时先join线程，再销毁它们访问的缓冲区和队列
     std::vector<double> buffer_;
+    std::unique_ptr<SpscRing<double>> stage_queue_;
+    std::jthread source_;
+    std::jthread worker_;
     
 public:
     struct PipelineConfig {
@@ -451,9 +1134,16 @@ public:
         double processing_delay_ms = 10.0;
         bool enable_logging = true;
         std::string pipeline_name = "默认管道";
+        bool use_spsc_stages = false;      // 拆分为"生成 -> 聚合"两级，中间用SpscRing连接
+        size_t stage_queue_capacity = 1024;
     };
     
     void start(PipelineConfig config = {}) {
+        if (config.use_spsc_stages) {
+            start_staged(config);
+            return;
+        }
+        
         worker_ = std::jthread([this, config](std::stop_token stoken) {
             buffer_.reserve(config.buffer_size);
             
@@ -503,6 +1193,9 @@ public:
     }
     
     void stop() {
+        if (source_.joinable()) {
+            source_.request_stop();
+        }
         if (worker_.joinable()) {
             worker_.request_stop();
         }
@@ -511,6 +1204,73 @@ public:
     std::span<const double> get_buffer() const {
         return std::span<const double>(buffer_);
     }
+    
+private:
+    static constexpr size_t kBatchSize = 100;
+    
+    // 两级流水线：生成阶段每批只做一次release store，聚合阶段批量取出
+    void start_staged(PipelineConfig config) {
+        stage_queue_ = std::make_unique<SpscRing<double>>(config.stage_queue_capacity);
+        buffer_.reserve(config.buffer_size);
+        
+        if (config.enable_logging) {
+            std::cout << std::format("启动两级数据管道: {} (SPSC队列容量 {})\n",
+                     config.pipeline_name, stage_queue_->capacity());
+        }
+        
+        source_ = std::jthread([this, config](std::stop_token stoken) {
+            SpscRing<double>& queue = *stage_queue_;
+            size_t generated = 0;
+            while (!stoken.stop_requested()) {
+                for (size_t i = 0; i < kBatchSize && !stoken.stop_requested(); ++i) {
+                    while (!queue.try_stage(static_cast<double>(generated) * 0.1)) {
+                        queue.commit_batch();
+                        if (stoken.stop_requested()) return;
+                        std::this_thread::yield();
+                    }
+                    ++generated;
+                }
+                queue.commit_batch();
+                
+                std::this_thread::sleep_for(
+                    std::chrono::duration<double, std::milli>(config.processing_delay_ms)
+                );
+            }
+        });
+        
+        worker_ = std::jthread([this, config](std::stop_token stoken) {
+            SpscRing<double>& queue = *stage_queue_;
+            std::array<double, kBatchSize> batch{};
+            size_t filled = 0;
+            int batch_count = 0;
+            
+            while (!stoken.stop_requested()) {
+                filled += queue.pop_batch(std::span<double>(batch).subspan(filled));
+                if (filled < kBatchSize) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    continue;
+                }
+                
+                std::span<const double> batch_span(batch);
+                double avg = std::accumulate(batch_span.begin(), batch_span.end(), 0.0) / batch_span.size();
+                if (config.enable_logging) {
+                    std::cout << std::format("批次 {}: 平均值 = {:.2f}\n", ++batch_count, avg);
+                }
+                
+                buffer_.insert(buffer_.end(), batch.begin(), batch.end());
+                if (buffer_.size() > config.buffer_size) {
+                    buffer_.erase(buffer_.begin(),
+                                 buffer_.begin() + (buffer_.size() - config.buffer_size));
+                }
+                filled = 0;
+            }
+            
+            if (config.enable_logging) {
+                std::cout << std::format("两级数据管道 '{}' 停止，缓冲区大小: {}\n",
+                         config.pipeline_name, buffer_.size());
+            }
+        });
+    }
 };
 
 void demonstrate_comprehensive_example() {
@@ -550,6 +1310,24 @@ void demonstrate_comprehensive_example() {
     std::cout << "\n";
 }
 
+void demonstrate_staged_pipeline() {
+    std::cout << "=== 两级流水线：阶段之间使用SPSC队列 ===\n";
+    
+    DataPipeline staged;
+    staged.start({
+        .buffer_size = 500,
+        .processing_delay_ms = 200.0,
+        .enable_logging = true,
+        .pipeline_name = "两级实时数据分析管道",
+        .use_spsc_stages = true
+    });
+    
+    std::this_thread::sleep_for(1s);
+    
+    staged.stop();
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++20其他重要特性深度解析\n";
@@ -563,7 +1341,10 @@ int main() {
     demonstrate_interruptible_task();
     demonstrate_designated_initializers();
     demonstrate_range_for_init();
+    demonstrate_spsc_queue();
+    demonstrate_stream_pipeline();
     demonstrate_comprehensive_example();
+    demonstrate_staged_pipeline();
     
     return 0;
 }
@@ -579,11 +1360,14 @@ g++ -std=c++20 -O2 -Wall 07_other_features.cpp -o other_features -pthread
 3. std::jthread支持协作式中断和自动资源管理
 4. 指定初始化器提高了结构体初始化的可读性
 5. 范围for循环初始化增强了变量作用域控制
+6. SPSC队列依靠单写者原则和缓存下标，做到无锁无CAS，批量发布只需一次release store
+7. 流水线的背压靠信用额度：下游处理完才归还，每级在途数据有上界；微批把加锁次数降到每批一次
 
 注意事项:
 - std::format需要较新的编译器支持(GCC 13+, Clang 14+, MSVC 19.29+)
 - std::span是非拥有视图，需要确保底层数据生命周期
 - std::jthread的stop_token是协作式的，需要代码主动检查
 - 指定初始化器要求按声明顺序初始化
+- 流水线的并行阶段不保证输出顺序；stop只通知源头，下游阻塞在慢汇上时排空也要等它处理完
 - 某些特性可能需要特定的编译器版本和标准库实现
 */
\ No newline at end of file
@@ -7,6 +7,7 @@
  * 3. 性能优化 - 零开销的错误处理机制
  * 4. 类型安全 - 编译期错误类型检查和约束
  * 5. 组合式设计 - 可串联的错误处理操作符
+ * 6. 零分配解析 - string_view + from_chars，错误只记录错误码和偏移，消息按需格式化
  */
 
 #include <iostream>
@@ -21,6 +22,18 @@
 #include <variant>
 #include <functional>
 #include <numeric>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#include "../common/micro_bench.h"
 
 using namespace std::string_literals;
 
@@ -257,20 +270,12 @@ public:
     }
     
     static std::expected<Config, ConfigError> parse_config(const std::string& content) {
-        // 简化的解析逻辑
-        if (content.empty()) {
-            return std::unexpected(ConfigError::ParseError);
-        }
-        
-        Config config{
-            .host = "localhost",
-            .port = 5432,
-            .database = "myapp",
-            .ssl_enabled = true,
-            .timeout_ms = 5000
-        };
-        
-        return config;
+        // 由快速解析器完成，这里只把结果转成持有型Config、把细粒度错误码归并成ConfigError
+        return parse_fast(content)
+            .transform([](const ConfigView& view) { return view.to_config(); })
+            .transform_error([](const ParseFailure& failure) {
+                return failure.is_validation() ? ConfigError::ValidationError : ConfigError::ParseError;
+            });
     }
     
     static std::expected<Config, ConfigError> validate_config(const Config& config) {
@@ -290,8 +295,293 @@ public:
         }
         return config;
     }
+    
+    // ---- 零分配快速解析：string_view输入 + from_chars + 紧凑错误 ----
+    // 上面的parse_config只是演示组合方式；真正按租户高频重载配置时，
+    // 成功路径不应构造任何std::string，失败路径也只记录错误码和偏移
+    enum class ParseCode : std::uint8_t {
+        MissingSeparator,   // 行里没有'='
+        UnknownKey,
+        DuplicateKey,
+        MissingKey,         // 记录结束时仍缺字段，偏移指向记录末尾
+        EmptyValue,
+        InvalidNumber,
+        NumberOutOfRange,
+        InvalidBool,
+        PortOutOfRange,
+        InvalidTimeout,
+    };
+    
+    // 8字节的错误：热路径只写错误码和偏移，消息在describe时才格式化
+    struct ParseFailure {
+        ParseCode code;
+        std::uint32_t offset;
+        
+        bool is_validation() const {
+            return code == ParseCode::PortOutOfRange || code == ParseCode::InvalidTimeout;
+        }
+        
+        std::string describe(std::string_view content) const;
+    };
+    
+    // 字符串字段是输入的视图，输入必须比它活得久；需要持有时用to_config拷贝
+    struct ConfigView {
+        std::string_view host;
+        std::uint16_t port = 0;
+        std::string_view database;
+        bool ssl_enabled = false;
+        std::uint32_t timeout_ms = 0;
+        
+        Config to_config() const {
+            return Config{
+                .host = std::string(host),
+                .port = port,
+                .database = std::string(database),
+                .ssl_enabled = ssl_enabled,
+                .timeout_ms = static_cast<int>(timeout_ms)
+            };
+        }
+    };
+    
+    // 字段之间用换行或';'分隔，允许空行、'#'注释和键值两侧的空白。
+    // 每个字段只扫描一趟：先找'='，再找分隔符，键和值都是输入的子串
+    static std::expected<ConfigView, ParseFailure> parse_fast(std::string_view content) {
+        ConfigView view;
+        unsigned seen = 0;
+        const char* const begin = content.data();
+        const char* const end = begin + content.size();
+        const char* p = begin;
+        while (p < end) {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+            const char* const line = p;
+            if (p < end && *p == '#') {
+                while (p < end && *p != '\n' && *p != ';') ++p;
+            }
+            while (p < end && *p != '=' && *p != '\n' && *p != ';') ++p;
+            if (p == end || *p != '=') {
+                if (p != line && *line != '#') return fail(ParseCode::MissingSeparator, line - begin);
+                ++p;  // 空行或注释
+                continue;
+            }
+            
+            const int field = field_index(trim(std::string_view(line, static_cast<std::size_t>(p - line))));
+            if (field < 0) return fail(ParseCode::UnknownKey, line - begin);
+            if (seen & (1u << field)) return fail(ParseCode::DuplicateKey, line - begin);
+            seen |= 1u << field;
+            
+            const char* const value_begin = ++p;
+            while (p < end && *p != '\n' && *p != ';') ++p;
+            const std::string_view value = trim(std::string_view(value_begin, static_cast<std::size_t>(p - value_begin)));
+            ++p;
+            if (value.empty()) return fail(ParseCode::EmptyValue, value_begin - begin);
+            const std::ptrdiff_t value_offset = value.data() - begin;
+            
+            switch (field) {
+                case kHost:
+                    view.host = value;
+                    break;
+                case kPort: {
+                    auto port = parse_number<std::uint32_t>(value);
+                    if (!port) return fail(port.error(), value_offset);
+                    if (*port == 0 || *port > 65535) return fail(ParseCode::PortOutOfRange, value_offset);
+                    view.port = static_cast<std::uint16_t>(*port);
+                    break;
+                }
+                case kDatabase:
+                    view.database = value;
+                    break;
+                case kSsl:
+                    if (value == "true" || value == "1") view.ssl_enabled = true;
+                    else if (value == "false" || value == "0") view.ssl_enabled = false;
+                    else return fail(ParseCode::InvalidBool, value_offset);
+                    break;
+                case kTimeout: {
+                    auto timeout = parse_number<std::uint32_t>(value);
+                    if (!timeout) return fail(timeout.error(), value_offset);
+                    if (*timeout == 0 || *timeout > static_cast<std::uint32_t>(INT_MAX)) {
+                        return fail(ParseCode::InvalidTimeout, value_offset);
+                    }
+                    view.timeout_ms = *timeout;
+                    break;
+                }
+            }
+        }
+        if (seen != kAllFields) return fail(ParseCode::MissingKey, static_cast<std::ptrdiff_t>(content.size()));
+        return view;
+    }
+    
+    struct BatchFailure {
+        std::uint32_t record;
+        ParseFailure error;
+    };
+    
+    struct BatchReport {
+        std::size_t valid = 0;
+        std::size_t invalid = 0;
+    };
+    
+    // 批量校验：on_valid(index, view)处理成功的记录，失败记录追加到调用方复用的failures；
+    // failures预留好容量后整个批次不分配内存
+    template<typename OnValid>
+    static BatchReport validate_batch(std::span<const std::string_view> records,
+                                      std::vector<BatchFailure>& failures, OnValid&& on_valid) {
+        BatchReport report;
+        failures.clear();
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            auto result = parse_fast(records[i]);
+            if (result) {
+                ++report.valid;
+                on_valid(i, *result);
+            } else {
+                ++report.invalid;
+                failures.push_back({static_cast<std::uint32_t>(i), result.error()});
+            }
+        }
+        return report;
+    }
+    
+    static BatchReport validate_batch(std::span<const std::string_view> records, std::vector<BatchFailure>& failures) {
+        return validate_batch(records, failures, [](std::size_t, const ConfigView&) {});
+    }
+    
+private:
+    enum Field { kHost, kPort, kDatabase, kSsl, kTimeout, kFieldCount };
+    static constexpr unsigned kAllFields = (1u << kFieldCount) - 1;
+    static constexpr std::array<std::string_view, kFieldCount> kFieldNames{"host", "port", "db", "ssl", "timeout"};
+    
+    static std::unexpected<ParseFailure> fail(ParseCode code, std::ptrdiff_t offset) {
+        return std::unexpected(ParseFailure{code, static_cast<std::uint32_t>(offset)});
+    }
+    
+    static std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+        return s;
+    }
+    
+    // 只有两个分隔符，手写循环比find_first_of快得多（后者对每个字符都要遍历一遍分隔符集合）
+    static std::size_t find_separator(std::string_view s, std::size_t pos) {
+        while (pos < s.size() && s[pos] != '\n' && s[pos] != ';') ++pos;
+        return pos;
+    }
+    
+    // 先按长度分派，每个键最多比较两次
+    static int field_index(std::string_view key) {
+        switch (key.size()) {
+            case 2: return key == kFieldNames[kDatabase] ? kDatabase : -1;
+            case 3: return key == kFieldNames[kSsl] ? kSsl : -1;
+            case 4: return key == kFieldNames[kHost] ? kHost : key == kFieldNames[kPort] ? kPort : -1;
+            case 7: return key == kFieldNames[kTimeout] ? kTimeout : -1;
+        }
+        return -1;
+    }
+    
+    // from_chars不跳过空白、不认'+'号、不依赖locale，也不会抛异常
+    template<typename T>
+    static std::expected<T, ParseCode> parse_number(std::string_view text) {
+        T value{};
+        const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec == std::errc::result_out_of_range) return std::unexpected(ParseCode::NumberOutOfRange);
+        if (ec != std::errc{} || ptr != text.data() + text.size()) return std::unexpected(ParseCode::InvalidNumber);
+        return value;
+    }
+    
+    static const char* code_message(ParseCode code) {
+        switch (code) {
+            case ParseCode::MissingSeparator: return "缺少'='";
+            case ParseCode::UnknownKey:       return "未知的配置项";
+            case ParseCode::DuplicateKey:     return "配置项重复";
+            case ParseCode::MissingKey:       return "缺少必填配置项";
+            case ParseCode::EmptyValue:       return "值为空";
+            case ParseCode::InvalidNumber:    return "不是合法的整数";
+            case ParseCode::NumberOutOfRange: return "整数超出范围";
+            case ParseCode::InvalidBool:      return "布尔值只能是true/false/1/0";
+            case ParseCode::PortOutOfRange:   return "端口必须在1~65535之间";
+            case ParseCode::InvalidTimeout:   return "超时必须为正数";
+        }
+        return "未知错误";
+    }
 };
 
+// 只在需要展示错误时调用：由偏移反推行列号、截取出错的片段；缺字段时重新扫描一遍找出缺了哪些
+inline std::string ConfigLoader::ParseFailure::describe(std::string_view content) const {
+    const std::size_t at = std::min<std::size_t>(offset, content.size());
+    const std::string_view before = content.substr(0, at);
+    const std::size_t line = static_cast<std::size_t>(std::count(before.begin(), before.end(), '\n')) + 1;
+    const std::size_t line_start = before.rfind('\n') == std::string_view::npos ? 0 : before.rfind('\n') + 1;
+    
+    if (code == ParseCode::MissingKey) {
+        unsigned seen = 0;
+        for (std::size_t pos = 0; pos < content.size();) {
+            const std::size_t end = find_separator(content, pos);
+            const std::string_view entry = trim(content.substr(pos, end - pos));
+            const int field = field_index(trim(entry.substr(0, entry.find('='))));
+            if (field >= 0) seen |= 1u << field;
+            pos = end + 1;
+        }
+        std::string missing;
+        for (int i = 0; i < kFieldCount; ++i) {
+            if (!(seen & (1u << i))) missing += std::format("{}{}", missing.empty() ? "" : ",", kFieldNames[i]);
+        }
+        return std::format("{}: {}", code_message(code), missing);
+    }
+    
+    const std::string_view rest = content.substr(at);
+    const std::string_view token = trim(rest.substr(0, find_separator(rest, 0)));
+    return std::format("第{}行第{}列: {} ('{}')", line, at - line_start + 1, code_message(code), token);
+}
+
+void demonstrate_fast_config_parsing() {
+    std::cout << "=== 零分配配置解析：from_chars + 紧凑错误码 ===\n";
+    std::cout << std::format("sizeof(ParseFailure) = {} 字节, sizeof(std::string) = {} 字节\n",
+                             sizeof(ConfigLoader::ParseFailure), sizeof(std::string));
+    
+    constexpr std::string_view inputs[] = {
+        "host=db.internal\nport=5432\ndb=tenant_42\nssl=true\ntimeout=5000",
+        "host = db.internal ; port = 6543 ; db = billing ; ssl = 0 ; timeout = 250",
+        "host=db.internal\nport=70000\ndb=x\nssl=true\ntimeout=5000",
+        "host=db.internal\nport=54x2\ndb=x\nssl=true\ntimeout=5000",
+        "host=db.internal\nport=5432\nssl=yes\ndb=x\ntimeout=5000",
+        "host=db.internal\nport=5432\nretries=3",
+        "host=db.internal\nport=5432",
+    };
+    
+    for (std::string_view input : inputs) {
+        auto result = ConfigLoader::parse_fast(input);
+        if (result) {
+            std::cout << std::format("  成功: {}:{} 库={} SSL={} 超时={}ms\n", result->host, result->port,
+                                     result->database, result->ssl_enabled ? "启用" : "禁用", result->timeout_ms);
+        } else {
+            std::cout << std::format("  失败[{}]: {}\n", result.error().is_validation() ? "校验" : "语法",
+                                     result.error().describe(input));
+        }
+    }
+    
+    // 批量模式：一次校验上千个租户配置，失败记录只保留错误码和偏移
+    std::vector<std::string> storage;
+    for (int i = 0; i < 2000; ++i) {
+        storage.push_back(std::format("host=db-{}.tenant.internal;port={};db=tenant_{};ssl={};timeout={}",
+                                      i, i % 97 == 0 ? 0 : 5000 + i, i, i % 2 ? "true" : "false",
+                                      i % 251 == 0 ? "fast" : "3000"));
+    }
+    std::vector<std::string_view> records(storage.begin(), storage.end());
+    std::vector<ConfigLoader::BatchFailure> failures;
+    failures.reserve(records.size());
+    
+    std::uint64_t ssl_tenants = 0;
+    auto report = ConfigLoader::validate_batch(records, failures, [&](std::size_t, const ConfigLoader::ConfigView& view) {
+        ssl_tenants += view.ssl_enabled;
+    });
+    std::cout << std::format("\n批量校验 {} 条: 通过 {}, 失败 {}, 其中启用SSL {}\n",
+                             records.size(), report.valid, report.invalid, ssl_tenants);
+    for (std::size_t i = 0; i < std::min<std::size_t>(3, failures.size()); ++i) {
+        const auto& failure = failures[i];
+        std::cout << std::format("  记录#{}: {}\n", failure.record, failure.error.describe(records[failure.record]));
+    }
+    
+    std::cout << "\n";
+}
+
 void demonstrate_complex_error_handling() {
     std::cout << "=== 复杂业务场景的错误处理 ===\n";
     
@@ -360,7 +650,7 @@ public:
     static void run_performance_comparison() {
         std::cout << "=== 性能对比：expected vs 异常 ===\n";
         
-        const int iterations = 1000000;
+        const int iterations = 100000;
         std::vector<std::pair<double, double>> test_data;
         test_data.reserve(iterations);
         
@@ -373,49 +663,46 @@ public:
             }
         }
         
-        // 测试expected性能
-        auto start = std::chrono::high_resolution_clock::now();
+        // 每次迭代跑完整批数据；预热、重复采样和统计交给统一基准框架，计数取最后一轮
         int expected_success = 0, expected_errors = 0;
-        
-        for (const auto& [a, b] : test_data) {
-            auto result = divide_expected(a, b);
-            if (result) {
-                expected_success++;
-            } else {
-                expected_errors++;
+        const auto expected_result = micro_bench::measure("expected方式", [&] {
+            expected_success = expected_errors = 0;
+            for (const auto& [a, b] : test_data) {
+                auto result = divide_expected(a, b);
+                if (result) {
+                    expected_success++;
+                } else {
+                    expected_errors++;
+                }
             }
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        auto expected_duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            micro_bench::do_not_optimize(expected_success);
+        }, test_data.size());
         
         // 测试异常性能
-        start = std::chrono::high_resolution_clock::now();
         int exception_success = 0, exception_errors = 0;
-        
-        for (const auto& [a, b] : test_data) {
-            try {
-                auto result = divide_exception(a, b);
-                exception_success++;
-            } catch (const std::exception&) {
-                exception_errors++;
+        const auto exception_result = micro_bench::measure("异常方式", [&] {
+            exception_success = exception_errors = 0;
+            for (const auto& [a, b] : test_data) {
+                try {
+                    micro_bench::do_not_optimize(divide_exception(a, b));
+                    exception_success++;
+                } catch (const std::exception&) {
+                    exception_errors++;
+                }
             }
-        }
-        
-        end = std::chrono::high_resolution_clock::now();
-        auto exception_duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        }, test_data.size());
         
         // 输出结果
-        std::cout << std::format("测试迭代次数: {}\n", iterations);
+        std::cout << std::format("每轮记录数: {}\n", iterations);
         std::cout << std::format("错误率: {:.1f}%\n", (expected_errors * 100.0) / iterations);
         std::cout << "\n性能结果:\n";
-        std::cout << std::format("expected方式: {}μs (成功: {}, 错误: {})\n", 
-                                expected_duration.count(), expected_success, expected_errors);
-        std::cout << std::format("异常方式: {}μs (成功: {}, 错误: {})\n", 
-                                exception_duration.count(), exception_success, exception_errors);
+        micro_bench::print_result(std::cout, expected_result);
+        std::cout << std::format("  成功: {}, 错误: {}\n", expected_success, expected_errors);
+        micro_bench::print_result(std::cout, exception_result);
+        std::cout << std::format("  成功: {}, 错误: {}\n", exception_success, exception_errors);
         
-        double speedup = static_cast<double>(exception_duration.count()) / expected_duration.count();
-        std::cout << std::format("性能提升: {:.2f}倍\n", speedup);
+        double speedup = exception_result.median_ns / expected_result.median_ns;
+        std::cout << std::format("性能提升: {:.2f}倍（按中位数）\n", speedup);
         
         std::cout << "\n性能分析:\n";
         std::cout << "- expected在错误频繁的场景下性能优势明显\n";
@@ -425,6 +712,132 @@ public:
         
         std::cout << "\n";
     }
+    
+    // 对照组：改造前的常见写法——按行拆成std::string，std::stoi转换，出错时立即格式化消息。
+    // 返回空串表示成功；下面分别包装成"expected + 字符串错误"和"抛异常"两种接口
+    static std::string parse_config_strings(const std::string& content, ConfigLoader::Config& out) {
+        bool seen[5] = {};
+        std::size_t pos = 0;
+        int line_no = 0;
+        while (pos < content.size()) {
+            std::size_t end = content.find('\n', pos);
+            if (end == std::string::npos) end = content.size();
+            std::string line = content.substr(pos, end - pos);
+            pos = end + 1;
+            ++line_no;
+            const std::size_t eq = line.find('=');
+            if (eq == std::string::npos) return std::format("第{}行: 缺少'=': {}", line_no, line);
+            std::string key = line.substr(0, eq);
+            std::string value = line.substr(eq + 1);
+            try {
+                if (key == "host") { out.host = value; seen[0] = true; }
+                else if (key == "port") {
+                    out.port = std::stoi(value);
+                    if (out.port <= 0 || out.port > 65535) return std::format("第{}行: 端口超出范围: {}", line_no, value);
+                    seen[1] = true;
+                }
+                else if (key == "db") { out.database = value; seen[2] = true; }
+                else if (key == "ssl") { out.ssl_enabled = (value == "true" || value == "1"); seen[3] = true; }
+                else if (key == "timeout") {
+                    out.timeout_ms = std::stoi(value);
+                    if (out.timeout_ms <= 0) return std::format("第{}行: 超时必须为正数: {}", line_no, value);
+                    seen[4] = true;
+                }
+                else return std::format("第{}行: 未知的配置项: {}", line_no, key);
+            } catch (const std::exception&) {
+                return std::format("第{}行: 不是合法的整数: {}", line_no, value);
+            }
+        }
+        for (bool s : seen) {
+            if (!s) return "缺少必填配置项";
+        }
+        return {};
+    }
+    
+    static std::expected<ConfigLoader::Config, std::string> parse_config_eager(const std::string& content) {
+        ConfigLoader::Config config{};
+        std::string error = parse_config_strings(content, config);
+        if (!error.empty()) return std::unexpected(std::move(error));
+        return config;
+    }
+    
+    static ConfigLoader::Config parse_config_throwing(const std::string& content) {
+        ConfigLoader::Config config{};
+        std::string error = parse_config_strings(content, config);
+        if (!error.empty()) throw std::invalid_argument(error);
+        return config;
+    }
+    
+    // 每轮要解析上万条记录，一轮就是几十毫秒：少采几个样本，取中位数
+    template<typename Func>
+    static double median_ns_per_record(std::size_t records, Func&& run) {
+        return micro_bench::measure("parse", std::forward<Func>(run), records,
+                                    micro_bench::heavy_config(kParseSamples)).median_ns_per_item();
+    }
+    
+    static constexpr std::size_t kParseSamples = 7;
+    
+public:
+    // 成功路径和失败路径分开测：前者看解析本身的开销，后者看错误构造与传播的开销
+    static void run_config_parse_comparison() {
+        std::cout << "=== 配置解析性能：from_chars + 紧凑错误 vs 字符串错误 vs 异常 ===\n";
+        
+        constexpr int count = 20000;
+        std::vector<std::string> valid, invalid;
+        valid.reserve(count);
+        invalid.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            valid.push_back(std::format("host=db-{}.tenant.internal\nport={}\ndb=tenant_{}\nssl=true\ntimeout=5000",
+                                        i, 1024 + i, i));
+            switch (i % 3) {  // 三种典型错误轮流出现：端口越界、未知配置项、缺字段
+                case 0: invalid.push_back(std::format("host=db-{}.tenant.internal\nport=99999\ndb=t\nssl=true\ntimeout=5000", i)); break;
+                case 1: invalid.push_back(std::format("host=db-{}.tenant.internal\nport=5432\nretries=3\ndb=t\ntimeout=5000", i)); break;
+                default: invalid.push_back(std::format("host=db-{}.tenant.internal\nport=5432\ndb=t", i)); break;
+            }
+        }
+        
+        std::uint64_t sink = 0;  // 累加结果，防止解析被优化掉
+        auto measure = [&](const std::vector<std::string>& records) {
+            std::array<double, 3> ns{};
+            ns[0] = median_ns_per_record(records.size(), [&] {
+                for (const auto& r : records) {
+                    auto result = ConfigLoader::parse_fast(r);
+                    sink += result ? result->port : result.error().offset;
+                }
+            });
+            ns[1] = median_ns_per_record(records.size(), [&] {
+                for (const auto& r : records) {
+                    auto result = parse_config_eager(r);
+                    sink += result ? static_cast<std::uint64_t>(result->port) : result.error().size();
+                }
+            });
+            ns[2] = median_ns_per_record(records.size(), [&] {
+                for (const auto& r : records) {
+                    try {
+                        sink += static_cast<std::uint64_t>(parse_config_throwing(r).port);
+                    } catch (const std::invalid_argument& e) {
+                        sink += std::strlen(e.what());
+                    }
+                }
+            });
+            return ns;
+        };
+        
+        const auto happy = measure(valid);
+        const auto failing = measure(invalid);
+        std::cout << std::format("{} 条记录，{}次采样的中位数 (ns/条):\n", count, kParseSamples);
+        std::cout << std::format("  {:<28} {:>10} {:>10}\n", "实现", "成功路径", "失败路径");
+        const char* names[] = {"parse_fast (错误码+偏移)", "expected<Config, string>", "异常"};
+        for (int i = 0; i < 3; ++i) {
+            std::cout << std::format("  {:<28} {:>10.1f} {:>10.1f}\n", names[i], happy[i], failing[i]);
+        }
+        std::cout << std::format("  成功路径提速 {:.1f}x，失败路径比异常快 {:.1f}x (校验和 {})\n",
+                                 happy[2] / happy[0], failing[2] / failing[0], sink % 1000);
+        std::cout << "- parse_fast的成功路径只产出string_view，完全不分配；失败路径只写8字节错误\n";
+        std::cout << "- 对照组成功时每个字段都要substr，失败时还要格式化消息；异常再加上栈展开\n";
+        
+        std::cout << "\n";
+    }
 };
 
 // ===== 6. expected的高级用法和设计模式 =====
@@ -561,7 +974,8 @@ void demonstrate_advanced_patterns() {
 }
 
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++23 std::expected函数式错误处理深度解析\n";
     std::cout << "==========================================\n";
     
@@ -569,7 +983,9 @@ int main() {
     demonstrate_structured_errors();
     demonstrate_monadic_operations();
     demonstrate_complex_error_handling();
+    demonstrate_fast_config_parsing();
     PerformanceTest::run_performance_comparison();
+    PerformanceTest::run_config_parse_comparison();
     demonstrate_advanced_patterns();
     
     return 0;
@@ -593,10 +1009,12 @@ g++ -std=c++23 -O2 -Wall 01_expected_error_handling.cpp -o expected_demo
 3. 相比异常，expected在错误频繁的场景下性能更好
 4. 支持结构化错误类型，提供丰富的错误信息
 5. 可以构建复杂的错误处理流水线和恢复机制
+6. 错误类型越小越便宜：错误码+偏移的expected在失败路径上几乎和成功路径一样快，消息留到展示时再生成
 
 注意事项:
 - expected适合可预期的错误情况，不适合真正的异常情况
 - 错误类型设计要平衡信息丰富性和性能开销
 - 链式操作要注意错误类型的一致性
 - 在性能关键路径上使用expected可以获得显著优势
+- ConfigView里的string_view指向输入缓冲区，输入释放后不能再使用；需要长期持有时先to_config()
 */
\ No newline at end of file
@@ -7,6 +7,7 @@
  * 3. Unicode支持 - 原生UTF-8输出和国际化支持
  * 4. 编译期检查 - 格式字符串的编译期验证
  * 5. 线程安全 - 无锁的输出机制
+ * 6. 异步日志 - 线程局部格式化、SPSC无锁交接、批量write与延迟格式化
  */
 
 #include <iostream>
@@ -22,6 +23,30 @@
 #include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "../common/micro_bench.h"
 
 // ===== 1. 输出系统的演进历程 =====
 void demonstrate_output_evolution() {
@@ -117,66 +142,51 @@ public:
     static void run_output_performance_comparison() {
         std::cout << "=== 输出性能对比测试 ===\n";
         
-        const int iterations = 100000;
-        std::vector<int> data(iterations);
-        std::iota(data.begin(), data.end(), 1);
+        // 每个样本输出一批数字；终端I/O波动很大，采样几次取中位数，不做额外预热
+        const int iterations = 10000;
+        const auto config = micro_bench::heavy_config(5);
         
         // 测试printf性能
         auto test_printf = [&]() {
-            auto start = std::chrono::high_resolution_clock::now();
             for (int i = 0; i < iterations; ++i) {
                 printf("%d ", i);
             }
             printf("\n");
-            auto end = std::chrono::high_resolution_clock::now();
-            return std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+            fflush(stdout);
         };
         
         // 测试iostream性能
         auto test_iostream = [&]() {
-            auto start = std::chrono::high_resolution_clock::now();
             for (int i = 0; i < iterations; ++i) {
                 std::cout << i << " ";
             }
             std::cout << "\n";
-            auto end = std::chrono::high_resolution_clock::now();
-            return std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+            std::cout.flush();
         };
         
         // 测试std::print性能
         auto test_std_print = [&]() {
-            auto start = std::chrono::high_resolution_clock::now();
             for (int i = 0; i < iterations; ++i) {
                 std::print("{} ", i);
             }
             std::println("");
-            auto end = std::chrono::high_resolution_clock::now();
-            return std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+            fflush(stdout);
         };
         
-        // 执行测试
-        std::cout << "测试参数: " << iterations << " 次迭代\n\n";
-        
-        // printf测试
-        auto printf_time = test_printf();
-        std::println("printf耗时: {}ms", printf_time.count());
+        const auto printf_result = micro_bench::measure("printf", test_printf, iterations, config);
+        const auto iostream_result = micro_bench::measure("iostream", test_iostream, iterations, config);
+        const auto std_print_result = micro_bench::measure("std::print", test_std_print, iterations, config);
         
-        // iostream测试
-        auto iostream_time = test_iostream();
-        std::println("iostream耗时: {}ms", iostream_time.count());
-        
-        // std::print测试
-        auto print_time = test_std_print();
-        std::println("std::print耗时: {}ms", print_time.count());
+        std::print("\n每批 {} 个整数，{} 次采样:\n", iterations, config.samples);
+        micro_bench::print_result(std::cout, printf_result);
+        micro_bench::print_result(std::cout, iostream_result);
+        micro_bench::print_result(std::cout, std_print_result);
         
         // 性能分析
-        std::print("\n性能分析:\n");
-        std::println("printf相对性能: {:.2f}x", 
-                     static_cast<double>(iostream_time.count()) / printf_time.count());
-        std::println("iostream相对性能: {:.2f}x", 
-                     static_cast<double>(iostream_time.count()) / iostream_time.count());
-        std::println("std::print相对性能: {:.2f}x", 
-                     static_cast<double>(iostream_time.count()) / print_time.count());
+        std::print("\n性能分析（相对iostream，按中位数）:\n");
+        std::println("printf相对性能: {:.2f}x", iostream_result.median_ns / printf_result.median_ns);
+        std::println("iostream相对性能: {:.2f}x", 1.0);
+        std::println("std::print相对性能: {:.2f}x", iostream_result.median_ns / std_print_result.median_ns);
         
         std::println("\nstd::print的优势:");
         std::println("- 直接系统调用，避免iostream的同步开销");
@@ -377,8 +387,417 @@ void demonstrate_custom_formatters() {
     std::cout << "\n";
 }
 
+// ===== 8. 异步日志：缓冲、无锁交接与延迟格式化 =====
+// 同步日志每条都要在调用线程上格式化并发起一次write，业务线程被拖慢
+// AsyncLogger把工作拆开：
+// 1. 调用线程用std::format_to_n把消息格式化进线程局部缓冲，格式字符串在编译期检查
+// 2. 每个线程独占一个SPSC字节环形缓冲区，入队只有两次memcpy和一次release store，无锁
+// 3. 后台线程轮询所有环形缓冲区，攒满一批再调用一次write
+// 4. 延迟模式只拷贝参数的原始字节，格式化推迟到读取日志时才做
+namespace async_log {
+
+inline bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+#if defined(_WIN32)
+        int written = ::_write(fd, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+#else
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) continue;
+#endif
+        if (written <= 0) return false;
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// 单生产者单消费者字节环：head/tail单调递增，取模定位；两端各自缓存对方的位置减少缓存行争用
+class SpscByteRing {
+public:
+    static constexpr size_t kCapacity = 1 << 18;
+
+    // 生产者：header与payload作为一条完整记录写入，head在全部写完后才发布
+    bool try_push(const void* header, size_t header_size, const void* payload, size_t payload_size) {
+        const size_t need = header_size + payload_size;
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head + need - cached_tail_ > kCapacity) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head + need - cached_tail_ > kCapacity) return false;
+        }
+        copy_in(head, header, header_size);
+        copy_in(head + header_size, payload, payload_size);
+        head_.store(head + need, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：把所有已发布的字节追加到out，返回字节数
+    size_t drain(std::string& out) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const size_t n = static_cast<size_t>(head - tail);
+        if (n == 0) return 0;
+        const size_t old_size = out.size();
+        out.resize(old_size + n);
+        const size_t offset = static_cast<size_t>(tail & (kCapacity - 1));
+        const size_t first = std::min(n, kCapacity - offset);
+        std::memcpy(out.data() + old_size, data_.get() + offset, first);
+        std::memcpy(out.data() + old_size + first, data_.get(), n - first);
+        tail_.store(head, std::memory_order_release);
+        return n;
+    }
+
+private:
+    void copy_in(uint64_t position, const void* src, size_t n) {
+        const size_t offset = static_cast<size_t>(position & (kCapacity - 1));
+        const size_t first = std::min(n, kCapacity - offset);
+        std::memcpy(data_.get() + offset, src, first);
+        std::memcpy(data_.get(), static_cast<const char*>(src) + first, n - first);
+    }
+
+    std::unique_ptr<char[]> data_{new char[kCapacity]};
+    alignas(64) std::atomic<uint64_t> head_{0};
+    uint64_t cached_tail_ = 0;  // 只由生产者访问
+    alignas(64) std::atomic<uint64_t> tail_{0};
+};
+
+enum class RecordKind : uint32_t { text = 0, deferred = 1 };
+
+struct RecordHeader {
+    uint32_t size;
+    RecordKind kind;
+};
+
+// 延迟记录：解码函数指针 + 格式字符串 + 参数原始字节
+// 指针只在同一进程内有效，跨进程读取需要改成调用点编号表
+using DecodeFn = void (*)(const char* args, std::string_view fmt, std::string& out);
+
+struct DeferredHeader {
+    DecodeFn decode;
+    const char* fmt;
+    size_t fmt_size;
+};
+
+template<typename T>
+inline constexpr bool is_deferrable_v = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> &&
+                                        !std::is_array_v<T> && !std::is_same_v<T, std::string_view>;
+
+class AsyncLogger {
+public:
+    static constexpr size_t kMaxLine = 1024;          // 超长消息截断
+    static constexpr size_t kFlushBytes = 64 * 1024;  // 攒够这么多再write
+
+    // text_fd接收已格式化的文本，binary_fd接收延迟记录（可为-1表示不用延迟模式）
+    explicit AsyncLogger(int text_fd, int binary_fd = -1)
+        : text_fd_(text_fd), binary_fd_(binary_fd), id_(next_id()) {
+        writer_ = std::thread([this] { run(); });
+    }
+
+    ~AsyncLogger() { stop(); }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // 所有生产者线程结束后调用：写完剩余记录再返回
+    void stop() {
+        if (!writer_.joinable()) return;
+        running_.store(false, std::memory_order_release);
+        writer_.join();
+    }
+
+    template<typename... Args>
+    void log(std::format_string<Args...> fmt, Args&&... args) {
+        auto& scratch = local_scratch();
+        auto result = std::format_to_n(scratch.data(), kMaxLine - 1, fmt, std::forward<Args>(args)...);
+        size_t n = std::min(static_cast<size_t>(result.size), kMaxLine - 1);
+        scratch[n++] = '\n';
+        push(RecordKind::text, scratch.data(), n);
+    }
+
+    // 只接受可按字节复制的值（数字、枚举、POD结构），字符串请用log
+    template<typename... Args>
+    void log_deferred(std::format_string<const Args&...> fmt, const Args&... args) {
+        static_assert((is_deferrable_v<Args> && ...), "延迟格式化的参数必须是可按字节复制的值类型");
+        char payload[sizeof(DeferredHeader) + (size_t{0} + ... + sizeof(Args))];
+        const DeferredHeader header{&decode_args<Args...>, fmt.get().data(), fmt.get().size()};
+        std::memcpy(payload, &header, sizeof(header));
+        size_t offset = sizeof(header);
+        ((std::memcpy(payload + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+        push(RecordKind::deferred, payload, sizeof(payload));
+    }
+
+    size_t write_calls() const { return write_calls_.load(std::memory_order_relaxed); }
+    size_t full_waits() const { return full_waits_.load(std::memory_order_relaxed); }
+
+    // 读取延迟日志时才真正格式化
+    static std::string format_deferred(std::string_view binary) {
+        std::string out;
+        size_t pos = 0;
+        while (pos + sizeof(RecordHeader) <= binary.size()) {
+            RecordHeader record;
+            std::memcpy(&record, binary.data() + pos, sizeof(record));
+            const char* payload = binary.data() + pos + sizeof(record);
+            DeferredHeader header;
+            std::memcpy(&header, payload, sizeof(header));
+            header.decode(payload + sizeof(header), std::string_view(header.fmt, header.fmt_size), out);
+            pos += sizeof(record) + record.size;
+        }
+        return out;
+    }
+
+private:
+    // 环形缓冲区归logger所有（rings_），线程局部只保留弱引用：logger析构时256KB缓冲区随之释放
+    // 热路径按logger_id命中后直接用裸指针，logger存活期间其环形缓冲区一定存活，且id不会复用
+    struct LocalSlot {
+        uint64_t logger_id = 0;
+        SpscByteRing* ring = nullptr;
+        std::weak_ptr<SpscByteRing> owner;
+    };
+
+    static std::array<char, kMaxLine>& local_scratch() {
+        thread_local std::array<char, kMaxLine> scratch;
+        return scratch;
+    }
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // 参数类型不要求可默认构造：按字节取出后用bit_cast直接构造出值
+    template<typename T>
+    static T load_arg(const char* data, size_t& offset) {
+        std::array<char, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), data + offset, sizeof(T));
+        offset += sizeof(T);
+        return std::bit_cast<T>(bytes);
+    }
+
+    template<typename... Args>
+    static void decode_args(const char* data, std::string_view fmt, std::string& out) {
+        size_t offset = 0;
+        // 花括号初始化保证从左到右求值，与写入时的参数顺序一致
+        const std::tuple<Args...> values{load_arg<Args>(data, offset)...};
+        std::apply([&](const auto&... v) {
+            std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(v...));
+        }, values);
+        out.push_back('\n');
+    }
+
+    // 线程第一次写这个logger时注册自己的环形缓冲区，之后只查线程局部缓存
+    SpscByteRing& local_ring() {
+        thread_local std::vector<LocalSlot> slots;
+        if (!slots.empty() && slots.back().logger_id == id_) return *slots.back().ring;
+        for (auto& slot : slots) {
+            if (slot.logger_id == id_) {
+                std::swap(slot, slots.back());
+                return *slots.back().ring;
+            }
+        }
+        // 未命中时顺便清理已析构logger留下的条目
+        std::erase_if(slots, [](const LocalSlot& slot) { return slot.owner.expired(); });
+        auto ring = std::make_shared<SpscByteRing>();
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            rings_.push_back(ring);
+            registry_version_.fetch_add(1, std::memory_order_release);
+        }
+        slots.push_back(LocalSlot{id_, ring.get(), ring});
+        return *ring;
+    }
+
+    void push(RecordKind kind, const void* payload, size_t size) {
+        SpscByteRing& ring = local_ring();
+        const RecordHeader header{static_cast<uint32_t>(size), kind};
+        if (ring.try_push(&header, sizeof(header), payload, size)) return;
+        // 缓冲区满：让出CPU等后台线程消费，不丢日志
+        full_waits_.fetch_add(1, std::memory_order_relaxed);
+        while (!ring.try_push(&header, sizeof(header), payload, size)) std::this_thread::yield();
+    }
+
+    void flush(int fd, std::string& batch) {
+        if (batch.empty()) return;
+        if (fd >= 0) write_all(fd, batch.data(), batch.size());
+        write_calls_.fetch_add(1, std::memory_order_relaxed);
+        batch.clear();
+    }
+
+    // 后台线程：按记录类型分流到文本批与二进制批
+    void run() {
+        std::vector<std::shared_ptr<SpscByteRing>> rings;
+        uint64_t seen_version = 0;
+        std::string staging, text_batch, binary_batch;
+        text_batch.reserve(kFlushBytes * 2);
+        binary_batch.reserve(kFlushBytes * 2);
+
+        for (;;) {
+            const bool stopping = !running_.load(std::memory_order_acquire);
+            if (registry_version_.load(std::memory_order_acquire) != seen_version) {
+                std::lock_guard<std::mutex> lock(registry_mutex_);
+                rings = rings_;
+                seen_version = registry_version_.load(std::memory_order_relaxed);
+            }
+
+            size_t drained = 0;
+            for (auto& ring : rings) {
+                staging.clear();
+                drained += ring->drain(staging);
+                size_t pos = 0;
+                while (pos < staging.size()) {
+                    RecordHeader record;
+                    std::memcpy(&record, staging.data() + pos, sizeof(record));
+                    const size_t record_size = sizeof(record) + record.size;
+                    if (record.kind == RecordKind::text) {
+                        text_batch.append(staging, pos + sizeof(record), record.size);
+                    } else {
+                        binary_batch.append(staging, pos, record_size);
+                    }
+                    pos += record_size;
+                }
+            }
+
+            if (text_batch.size() >= kFlushBytes || (drained == 0 && !text_batch.empty())) flush(text_fd_, text_batch);
+            if (binary_batch.size() >= kFlushBytes || (drained == 0 && !binary_batch.empty())) {
+                flush(binary_fd_, binary_batch);
+            }
+            if (drained == 0) {
+                if (stopping) break;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    int text_fd_;
+    int binary_fd_;
+    uint64_t id_;
+    std::atomic<bool> running_{true};
+    std::atomic<size_t> write_calls_{0};
+    std::atomic<size_t> full_waits_{0};
+    std::mutex registry_mutex_;
+    std::vector<std::shared_ptr<SpscByteRing>> rings_;
+    std::atomic<uint64_t> registry_version_{0};
+    std::thread writer_;
+};
+
+inline int open_log_file(const std::string& path) {
+#if defined(_WIN32)
+    return ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+inline void close_log_file(int fd) {
+#if defined(_WIN32)
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+inline std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+} // namespace async_log
+
+void demonstrate_async_logger() {
+    std::cout << "=== 异步日志：缓冲、无锁交接与延迟格式化 ===\n";
+    using namespace async_log;
+    namespace fs = std::filesystem;
+    const std::string text_path = (fs::temp_directory_path() / "async_logger_demo.log").string();
+    const std::string binary_path = (fs::temp_directory_path() / "async_logger_demo.bin").string();
+
+    // 多线程写同一个logger，每个线程有自己的环形缓冲区
+    {
+        int text_fd = open_log_file(text_path);
+        AsyncLogger logger(text_fd);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < 1000; ++i) logger.log("线程 {} - 消息 {}", t, i);
+            });
+        }
+        for (auto& th : threads) th.join();
+        logger.stop();
+        close_log_file(text_fd);
+        std::string content = read_file(text_path);
+        std::println("4线程x1000条: 共 {} 行, write调用 {} 次",
+                     std::ranges::count(content, '\n'), logger.write_calls());
+    }
+
+    // 性能对比：调用线程耗时 vs 含后台写出的总耗时
+    const int messages = 200000;
+    auto elapsed_ms = [](auto start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // 同步：每条format后直接write
+    int sync_fd = open_log_file(text_path);
+    auto sync_start = std::chrono::steady_clock::now();
+    std::string line;
+    for (int i = 0; i < messages; ++i) {
+        line.clear();
+        std::format_to(std::back_inserter(line), "request id={} latency={:.3f}ms status={}\n", i, i * 0.001, 200);
+        write_all(sync_fd, line.data(), line.size());
+    }
+    double sync_ms = elapsed_ms(sync_start);
+    close_log_file(sync_fd);
+    std::string sync_log = read_file(text_path);
+
+    // 异步文本模式
+    int text_fd = open_log_file(text_path);
+    auto text_start = std::chrono::steady_clock::now();
+    double text_caller_ms = 0;
+    size_t text_writes = 0;
+    {
+        AsyncLogger logger(text_fd);
+        for (int i = 0; i < messages; ++i) logger.log("request id={} latency={:.3f}ms status={}", i, i * 0.001, 200);
+        text_caller_ms = elapsed_ms(text_start);
+        logger.stop();
+        text_writes = logger.write_calls();
+    }
+    double text_total_ms = elapsed_ms(text_start);
+    close_log_file(text_fd);
+    std::string text_log = read_file(text_path);
+
+    // 延迟格式化模式：调用线程只拷贝参数字节
+    int binary_fd = open_log_file(binary_path);
+    auto deferred_start = std::chrono::steady_clock::now();
+    double deferred_caller_ms = 0;
+    {
+        AsyncLogger logger(-1, binary_fd);
+        for (int i = 0; i < messages; ++i) {
+            logger.log_deferred("request id={} latency={:.3f}ms status={}", i, i * 0.001, 200);
+        }
+        deferred_caller_ms = elapsed_ms(deferred_start);
+        logger.stop();
+    }
+    double deferred_total_ms = elapsed_ms(deferred_start);
+    close_log_file(binary_fd);
+    auto decode_start = std::chrono::steady_clock::now();
+    std::string decoded = AsyncLogger::format_deferred(read_file(binary_path));
+    double decode_ms = elapsed_ms(decode_start);
+
+    std::println("\n{} 条日志:", messages);
+    std::println("  同步format+write:  {:.2f} ms ({} 次write)", sync_ms, messages);
+    std::println("  异步文本: 调用线程 {:.2f} ms, 含写出 {:.2f} ms ({} 次write)",
+                 text_caller_ms, text_total_ms, text_writes);
+    std::println("  延迟格式化: 调用线程 {:.2f} ms, 含写出 {:.2f} ms, 读取时格式化 {:.2f} ms",
+                 deferred_caller_ms, deferred_total_ms, decode_ms);
+    std::println("  三种方式内容一致: {}", (decoded == text_log && sync_log == text_log) ? "是" : "否");
+    std::println("  首行: {}", std::string_view(decoded).substr(0, decoded.find('\n')));
+
+    std::error_code ec;
+    fs::remove(text_path, ec);
+    fs::remove(binary_path, ec);
+
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++23 std::print现代化输出系统深度解析\n";
     std::cout << "=========================================\n";
     
@@ -389,6 +808,7 @@ int main() {
     demonstrate_thread_safety();
     demonstrate_file_output();
     demonstrate_custom_formatters();
+    demonstrate_async_logger();
     
     return 0;
 }
@@ -413,10 +833,12 @@ g++ -std=c++23 -O2 -Wall 03_print_modern_output.cpp -o print_demo
 3. 性能显著优于传统的iostream输出
 4. 线程安全的并发输出机制
 5. 支持自定义类型的格式化扩展
+6. 异步日志把格式化和系统调用移出业务线程，延迟模式连格式化都推迟到读日志时
 
 注意事项:
 - std::print直接输出到stdout，不支持重定向
 - 需要编译器支持C++23标准
 - 格式字符串在编译期进行验证，提高安全性
 - 在性能关键路径上推荐使用std::print
+- 延迟格式化只能记录可按字节复制的参数，字符串要先用log格式化
 */
\ No newline at end of file
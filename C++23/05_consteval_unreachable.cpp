@@ -7,6 +7,8 @@
  * 3. 性能优化 - 消除死代码和分支优化
  * 4. 元编程增强 - 编译期和运行时的统一接口
  * 5. 安全性保证 - 编译期检查和运行时验证
+ * 6. 实际应用场景 - 矩阵运算和验证器按编译期/运行时选择不同实现
+ * 7. 编译期查找表 - consteval生成对齐的CRC/位操作/定点三角/伽马表，插值与大表拆分
  */
 
 #include <iostream>
@@ -22,6 +24,12 @@
 #include <type_traits>
 #include <concepts>
 #include <cassert>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
 
 // ===== 1. if consteval基础概念 =====
 void demonstrate_if_consteval_basics() {
@@ -488,6 +496,396 @@ public:
     }
 };
 
+// ===== 7. 编译期查找表生成器 =====
+// 把CompileTimeCache的思路推广到整张表：给一个constexpr函数和定义域，在编译期一次生成对齐的数组
+namespace LookupTables {
+    // 按缓存行对齐的只读表，热循环里整张小表只占用少量缓存行
+    template<typename T, size_t N>
+    struct alignas(64) AlignedTable {
+        std::array<T, N> data;
+        
+        constexpr const T& operator[](size_t i) const { return data[i]; }
+        constexpr const T* begin() const { return data.data(); }
+        constexpr const T* end() const { return data.data() + N; }
+        static constexpr size_t size() { return N; }
+    };
+    
+    // 定义域：下标i映射到函数参数。默认就是下标本身
+    struct IndexDomain {
+        constexpr size_t operator()(size_t i) const { return i; }
+    };
+    
+    // 把[0, N)线性映射到闭区间[lo, hi]，最后一个元素正好落在hi上
+    template<size_t N>
+    struct LinearDomain {
+        double lo;
+        double hi;
+        constexpr double operator()(size_t i) const {
+            return lo + (hi - lo) * static_cast<double>(i) / static_cast<double>(N - 1);
+        }
+    };
+    
+    // 核心生成器：table[i] = func(domain(Offset + i))，Offset用于把大表切成若干片
+    template<typename T, size_t N, size_t Offset = 0, typename Func, typename Domain = IndexDomain>
+    consteval AlignedTable<T, N> make_table(Func func, Domain domain = {}) {
+        AlignedTable<T, N> table{};
+        for (size_t i = 0; i < N; ++i) {
+            table.data[i] = static_cast<T>(func(domain(Offset + i)));
+        }
+        return table;
+    }
+    
+    // CompileTimeCache的表格版：编译期直接求值，运行时查表，超出表范围才回退到函数本身
+    template<typename F, size_t N>
+    struct TabulatedFunction {
+        using Result = std::invoke_result_t<F, size_t>;
+        static constexpr AlignedTable<Result, N> table = make_table<Result, N>(F{});
+        
+        static constexpr Result get(size_t i) {
+            if consteval {
+                return F{}(i);
+            } else {
+                return i < N ? table[i] : F{}(i);
+            }
+        }
+    };
+    
+    // --- constexpr数学函数：<cmath>在C++23之前没有constexpr保证，生成表时自己实现 ---
+    inline constexpr double kPi = 3.14159265358979323846;
+    inline constexpr double kLn2 = 0.69314718055994530942;
+    
+    constexpr long long round_to_integer(double x) {
+        return static_cast<long long>(x < 0 ? x - 0.5 : x + 0.5);
+    }
+    
+    constexpr double constexpr_sin(double x) {
+        x -= 2 * kPi * static_cast<double>(round_to_integer(x / (2 * kPi)));  // 归约到[-pi, pi]
+        if (x > kPi / 2) x = kPi - x;
+        if (x < -kPi / 2) x = -kPi - x;
+        double term = x, sum = x;
+        for (int n = 1; n < 10; ++n) {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+    
+    constexpr double constexpr_cos(double x) { return constexpr_sin(x + kPi / 2); }
+    
+    constexpr double constexpr_exp(double x) {
+        const long long n = round_to_integer(x / kLn2);
+        const double r = x - static_cast<double>(n) * kLn2;  // |r| <= ln2/2
+        double term = 1, sum = 1;
+        for (int k = 1; k < 20; ++k) {
+            term *= r / k;
+            sum += term;
+        }
+        for (long long i = 0; i < n; ++i) sum *= 2;
+        for (long long i = 0; i > n; --i) sum /= 2;
+        return sum;
+    }
+    
+    // x > 0：x = m * 2^e，m∈[1, 2)，ln(m) = 2*atanh((m-1)/(m+1))
+    constexpr double constexpr_log(double x) {
+        int exponent = 0;
+        while (x >= 2) { x /= 2; ++exponent; }
+        while (x < 1) { x *= 2; --exponent; }
+        const double s = (x - 1) / (x + 1);
+        double power = s, sum = 0;
+        for (int k = 1; k < 40; k += 2) {
+            sum += power / k;
+            power *= s * s;
+        }
+        return 2 * sum + exponent * kLn2;
+    }
+    
+    constexpr double constexpr_pow(double base, double exponent) {
+        return base <= 0 ? 0.0 : constexpr_exp(exponent * constexpr_log(base));
+    }
+    
+    // --- CRC：反射形式的CRC32(IEEE 802.3)和CRC64(XZ/ECMA-182)，slicing-by-8需要8张256项的表 ---
+    template<typename Word, Word Poly>
+    struct ReflectedCrc {
+        static constexpr Word byte_entry(size_t byte) {
+            Word crc = static_cast<Word>(byte);
+            for (int bit = 0; bit < 8; ++bit) crc = (crc & 1) ? (crc >> 1) ^ Poly : crc >> 1;
+            return crc;
+        }
+        
+        // 第k张表：字节i后面再跟k个零字节的CRC，扁平下标 = k * 256 + i
+        static constexpr Word slice_entry(size_t flat_index) {
+            Word crc = byte_entry(flat_index & 0xFF);
+            for (size_t k = 0; k < flat_index / 256; ++k) crc = (crc >> 8) ^ byte_entry(crc & 0xFF);
+            return crc;
+        }
+        
+        static constexpr AlignedTable<Word, 8 * 256> slices =
+            make_table<Word, 8 * 256>([](size_t i) { return slice_entry(i); });
+        
+        // 逐位计算，不查表，作为基准和正确性对照
+        static constexpr Word update_bitwise(Word crc, const uint8_t* data, size_t size) {
+            crc = ~crc;
+            for (size_t i = 0; i < size; ++i) {
+                crc ^= data[i];
+                for (int bit = 0; bit < 8; ++bit) crc = (crc & 1) ? (crc >> 1) ^ Poly : crc >> 1;
+            }
+            return ~crc;
+        }
+        
+        static constexpr Word update_bytewise(Word crc, const uint8_t* data, size_t size) {
+            crc = ~crc;
+            for (size_t i = 0; i < size; ++i) crc = (crc >> 8) ^ slices[(crc ^ data[i]) & 0xFF];
+            return ~crc;
+        }
+        
+        // 每次消化8个字节：8次独立查表异或在一起，没有逐字节的依赖链
+        static constexpr Word update(Word crc, const uint8_t* data, size_t size) {
+            if consteval {
+                return update_bytewise(crc, data, size);
+            } else {
+                if constexpr (std::endian::native != std::endian::little) {
+                    return update_bytewise(crc, data, size);
+                } else {
+                    crc = ~crc;
+                    for (; size >= 8; data += 8, size -= 8) {
+                        uint64_t chunk;
+                        std::memcpy(&chunk, data, 8);
+                        chunk ^= static_cast<uint64_t>(crc);
+                        crc = slices[7 * 256 + (chunk & 0xFF)] ^ slices[6 * 256 + ((chunk >> 8) & 0xFF)] ^
+                              slices[5 * 256 + ((chunk >> 16) & 0xFF)] ^ slices[4 * 256 + ((chunk >> 24) & 0xFF)] ^
+                              slices[3 * 256 + ((chunk >> 32) & 0xFF)] ^ slices[2 * 256 + ((chunk >> 40) & 0xFF)] ^
+                              slices[1 * 256 + ((chunk >> 48) & 0xFF)] ^ slices[chunk >> 56];
+                    }
+                    return update_bytewise(~crc, data, size);
+                }
+            }
+        }
+        
+        static constexpr Word compute(std::string_view text) {
+            Word crc = 0;
+            for (char c : text) {  // 编译期不能把char*重解释成uint8_t*，逐字节喂入
+                const uint8_t byte = static_cast<uint8_t>(c);
+                crc = update_bytewise(crc, &byte, 1);
+            }
+            return crc;
+        }
+    };
+    
+    using Crc32 = ReflectedCrc<uint32_t, 0xEDB88320u>;
+    using Crc64 = ReflectedCrc<uint64_t, 0xC96C5795D7870F42ull>;
+    
+    static_assert(Crc32::compute("123456789") == 0xCBF43926u, "CRC32校验值错误");
+    static_assert(Crc64::compute("123456789") == 0x995DC9BBDF1939FAull, "CRC64校验值错误");
+    
+    // --- 位操作表 ---
+    inline constexpr auto kPopcount8 =
+        make_table<uint8_t, 256>([](size_t i) { return std::popcount(static_cast<unsigned>(i)); });
+    
+    inline constexpr auto kReverse8 = make_table<uint8_t, 256>([](size_t i) {
+        unsigned reversed = 0;
+        for (int bit = 0; bit < 8; ++bit) reversed |= ((i >> bit) & 1u) << (7 - bit);
+        return reversed;
+    });
+    
+    constexpr uint32_t reverse_bits32(uint32_t x) {
+        return (static_cast<uint32_t>(kReverse8[x & 0xFF]) << 24) | (static_cast<uint32_t>(kReverse8[(x >> 8) & 0xFF]) << 16) |
+               (static_cast<uint32_t>(kReverse8[(x >> 16) & 0xFF]) << 8) | kReverse8[x >> 24];
+    }
+    
+    // --- 插值：表末尾多放一个保护项，table[i+1]永远不越界 ---
+    // position的低FracBits位是小数部分
+    template<unsigned FracBits, typename Table>
+    constexpr int32_t lerp_fixed(const Table& table, uint32_t position) {
+        const uint32_t index = position >> FracBits;
+        const int32_t frac = static_cast<int32_t>(position & ((1u << FracBits) - 1));
+        const int32_t a = table[index];
+        const int32_t b = table[index + 1];
+        return a + (((b - a) * frac) >> FracBits);
+    }
+    
+    // 浮点版：x按LinearDomain的[lo, hi]定位，超出范围时夹到端点
+    template<typename Table>
+    constexpr double lerp(const Table& table, double x, double lo, double hi) {
+        const double position = (x - lo) / (hi - lo) * static_cast<double>(Table::size() - 1);
+        if (position <= 0) return table[0];
+        if (position >= static_cast<double>(Table::size() - 1)) return table[Table::size() - 1];
+        const size_t index = static_cast<size_t>(position);
+        const double frac = position - static_cast<double>(index);
+        return table[index] + (table[index + 1] - table[index]) * frac;
+    }
+    
+    // --- 定点正弦/余弦：一整圈1024格加1个保护项，Q15输出，相位是16位（65536 = 一整圈）---
+    inline constexpr auto kSinQ15 = make_table<int16_t, 1025>(
+        [](double angle) { return round_to_integer(32767 * constexpr_sin(angle)); },
+        LinearDomain<1025>{0.0, 2 * kPi});
+    
+    constexpr int16_t sin_q15(uint16_t phase) { return static_cast<int16_t>(lerp_fixed<6>(kSinQ15, phase)); }
+    constexpr int16_t cos_q15(uint16_t phase) { return sin_q15(static_cast<uint16_t>(phase + 16384)); }
+    
+    // --- sRGB伽马：解码用256项浮点表，编码用12位线性值到8位的4096项表 ---
+    constexpr double srgb_to_linear(double c) {
+        return c <= 0.04045 ? c / 12.92 : constexpr_pow((c + 0.055) / 1.055, 2.4);
+    }
+    
+    constexpr double linear_to_srgb(double l) {
+        return l <= 0.0031308 ? 12.92 * l : 1.055 * constexpr_pow(l, 1 / 2.4) - 0.055;
+    }
+    
+    inline constexpr auto kSrgbToLinear = make_table<float, 256>(
+        [](double c) { return srgb_to_linear(c); }, LinearDomain<256>{0.0, 1.0});
+    
+    inline constexpr auto kLinearToSrgb = make_table<uint8_t, 4096>(
+        [](double l) { return round_to_integer(255 * linear_to_srgb(l)); }, LinearDomain<4096>{0.0, 1.0});
+    
+    // 比较写成"不大于0"，NaN也落到0，不会把NaN转换成下标
+    inline uint8_t encode_srgb(float linear) {
+        const float clamped = !(linear > 0) ? 0.0f : (linear < 1 ? linear : 1.0f);
+        return kLinearToSrgb[static_cast<size_t>(clamped * 4095.0f + 0.5f)];
+    }
+    
+    // --- 拆分大表：定义放进单独的翻译单元，其余翻译单元只看到extern声明 ---
+    // 生成表的constexpr求值只在定义它的那个.cpp里发生一次，改动使用方不会重新计算整张表；
+    // 代价是使用方不能再在编译期折叠查表结果。这里为了单文件演示把声明和定义写在一起
+    struct ReciprocalQ32 {
+        constexpr uint32_t operator()(size_t d) const {  // floor(2^32 / d)，d <= 1时放不下，给全1
+            return d <= 1 ? 0xFFFFFFFFu : static_cast<uint32_t>((1ull << 32) / d);
+        }
+    };
+    
+    inline constexpr size_t kReciprocalChunk = 32768;
+    
+    // 通常放在头文件lut_reciprocal.h
+    extern const AlignedTable<uint32_t, kReciprocalChunk> kReciprocalLow;
+    extern const AlignedTable<uint32_t, kReciprocalChunk> kReciprocalHigh;
+    
+    // 通常分别放在lut_reciprocal_0.cpp和lut_reciprocal_1.cpp；constinit保证没有动态初始化
+    constinit const AlignedTable<uint32_t, kReciprocalChunk> kReciprocalLow =
+        make_table<uint32_t, kReciprocalChunk, 0>(ReciprocalQ32{});
+    constinit const AlignedTable<uint32_t, kReciprocalChunk> kReciprocalHigh =
+        make_table<uint32_t, kReciprocalChunk, kReciprocalChunk>(ReciprocalQ32{});
+    
+    // 把若干片拼成一个逻辑上的大表，只多一次按高位选片
+    template<typename T, size_t ChunkSize, size_t Chunks>
+    struct ChunkedTable {
+        static_assert((ChunkSize & (ChunkSize - 1)) == 0, "片大小必须是2的幂");
+        std::array<const T*, Chunks> chunks;
+        
+        T operator[](size_t i) const { return chunks[i / ChunkSize][i % ChunkSize]; }
+        static constexpr size_t size() { return ChunkSize * Chunks; }
+    };
+    
+    constinit const ChunkedTable<uint32_t, kReciprocalChunk, 2> kReciprocal{{kReciprocalLow.begin(), kReciprocalHigh.begin()}};
+    
+    // 用倒数表做除法：乘法取高32位后最多比真实商小1，再校正一次
+    // d == 0没有意义（被替换的x / d会直接出错），表里的占位值只是为了让表完整
+    inline uint32_t divide_by_table(uint32_t x, uint16_t d) {
+        assert(d != 0 && "divide_by_table: 除数不能为0");
+        uint32_t q = static_cast<uint32_t>((static_cast<uint64_t>(x) * kReciprocal[d]) >> 32);
+        if (static_cast<uint64_t>(q + 1) * d <= x) ++q;
+        return q;
+    }
+    
+    // 取多次运行中最快的一次，单位：纳秒/字节或纳秒/像素
+    template<typename Func>
+    double best_ns_per_unit(size_t units, Func&& func) {
+        double best = 1e300;
+        for (int round = 0; round < 5; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            func();
+            auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            best = std::min(best, elapsed / static_cast<double>(units));
+        }
+        return best;
+    }
+    
+    inline void benchmark_lookup_tables() {
+        std::vector<uint8_t> buffer(1 << 20);
+        uint32_t seed = 12345;
+        for (auto& byte : buffer) {
+            seed = seed * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t>(seed >> 24);
+        }
+        
+        volatile uint64_t sink = 0;
+        const double bitwise = best_ns_per_unit(buffer.size(), [&] { sink = Crc32::update_bitwise(0, buffer.data(), buffer.size()); });
+        const double bytewise = best_ns_per_unit(buffer.size(), [&] { sink = Crc32::update_bytewise(0, buffer.data(), buffer.size()); });
+        const double sliced = best_ns_per_unit(buffer.size(), [&] { sink = Crc32::update(0, buffer.data(), buffer.size()); });
+        const double sliced64 = best_ns_per_unit(buffer.size(), [&] { sink = Crc64::update(0, buffer.data(), buffer.size()); });
+        std::cout << "CRC32 (1 MiB): 逐位 " << 1e3 / bitwise << " MB/s, 单表 " << 1e3 / bytewise
+                  << " MB/s, slicing-by-8 " << 1e3 / sliced << " MB/s; CRC64 slicing-by-8 " << 1e3 / sliced64 << " MB/s\n";
+        
+        // 伽马：sRGB解码 -> 线性空间调暗到80% -> 重新编码
+        std::vector<uint8_t> pixels(buffer.begin(), buffer.end()), out_pow(pixels.size()), out_lut(pixels.size());
+        const double with_pow = best_ns_per_unit(pixels.size(), [&] {
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                const double c = pixels[i] / 255.0;
+                const double linear = (c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4)) * 0.8;
+                const double s = linear <= 0.0031308 ? 12.92 * linear : 1.055 * std::pow(linear, 1 / 2.4) - 0.055;
+                out_pow[i] = static_cast<uint8_t>(s * 255 + 0.5);
+            }
+        });
+        const double with_lut = best_ns_per_unit(pixels.size(), [&] {
+            for (size_t i = 0; i < pixels.size(); ++i) out_lut[i] = encode_srgb(kSrgbToLinear[pixels[i]] * 0.8f);
+        });
+        int max_diff = 0;
+        for (size_t i = 0; i < pixels.size(); ++i) max_diff = std::max(max_diff, std::abs(out_pow[i] - out_lut[i]));
+        std::cout << "伽马调整 (1M像素): std::pow " << with_pow << " ns/像素, 查表 " << with_lut
+                  << " ns/像素, 加速 " << with_pow / with_lut << "x, 最大差异 " << max_diff << " 级\n";
+    }
+    
+    struct FibonacciNumber {
+        constexpr uint64_t operator()(size_t n) const {
+            uint64_t a = 0, b = 1;
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t next = a + b;
+                a = b;
+                b = next;
+            }
+            return a;
+        }
+    };
+    
+    inline void demonstrate_lookup_tables() {
+        std::cout << "=== 编译期查找表生成器 ===\n";
+        
+        constexpr uint64_t fib50 = TabulatedFunction<FibonacciNumber, 94>::get(50);
+        std::cout << "Fibonacci(50): 编译期 " << fib50 << ", 运行时查表 "
+                  << TabulatedFunction<FibonacciNumber, 94>::get(50) << "\n";
+        
+        std::cout << std::hex << "CRC32(\"123456789\") = 0x" << Crc32::compute("123456789")
+                  << ", CRC64 = 0x" << Crc64::compute("123456789") << std::dec << " (编译期已static_assert)\n";
+        std::cout << "表对齐: CRC切片表地址 % 64 = " << reinterpret_cast<uintptr_t>(&Crc32::slices) % 64
+                  << ", 大小 " << sizeof(Crc32::slices) << " 字节\n";
+        
+        std::cout << "popcount(0xB7) = " << int(kPopcount8[0xB7]) << ", reverse_bits32(0x00000001) = 0x"
+                  << std::hex << reverse_bits32(1) << std::dec << "\n";
+        
+        int max_sin_error = 0;
+        for (uint32_t phase = 0; phase < 65536; ++phase) {
+            const double angle = 2 * kPi * phase / 65536.0;
+            max_sin_error = std::max<int>(max_sin_error, std::abs(sin_q15(static_cast<uint16_t>(phase)) - static_cast<int>(std::lround(32767 * std::sin(angle)))));
+            max_sin_error = std::max<int>(max_sin_error, std::abs(cos_q15(static_cast<uint16_t>(phase)) - static_cast<int>(std::lround(32767 * std::cos(angle)))));
+        }
+        std::cout << "Q15 sin(30度) = " << sin_q15(65536 / 12) << "/32767, cos(60度) = " << cos_q15(65536 / 6)
+                  << "/32767, 全相位最大误差 " << max_sin_error << " LSB\n";
+        std::cout << "线性插值: sRGB 127.5 -> 线性 " << lerp(kSrgbToLinear, 127.5, 0, 255) << "\n";
+        
+        uint32_t seed = 7;
+        bool division_ok = true;
+        for (int i = 0; i < 200000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            const uint32_t x = seed;
+            const uint16_t d = static_cast<uint16_t>((seed >> 7) | 1);
+            division_ok &= divide_by_table(x, d) == x / d;
+        }
+        std::cout << "拆分成两片的倒数表(" << kReciprocal.size() << "项): 查表除法 "
+                  << (division_ok ? "全部正确" : "出错!") << "\n";
+        
+        benchmark_lookup_tables();
+        std::cout << "\n";
+    }
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++23 if consteval和std::unreachable编译期优化深度解析\n";
@@ -499,6 +897,7 @@ int main() {
     demonstrate_advanced_compile_time_patterns();
     demonstrate_error_handling_and_debugging();
     ApplicationExamples::demonstrate_applications();
+    LookupTables::demonstrate_lookup_tables();
     
     return 0;
 }
@@ -519,10 +918,11 @@ g++ -std=c++23 -O2 -Wall 05_consteval_unreachable.cpp -o consteval_demo
 3. 这两个特性结合可以实现更高效的编译期优化
 4. 统一了编译期和运行时的编程模型
 5. 提供了更好的错误处理和调试支持
+6. consteval表生成器把constexpr函数和定义域变成对齐的只读数组，CRC和伽马这类热循环只剩查表
 
 注意事项:
 - std::unreachable必须确保代码确实不可达，否则会导致未定义行为
 - if consteval主要用于模板和constexpr函数中
-- 过度使用可能增加编译时间
+- 过度使用可能增加编译时间；大表的定义放进单独的翻译单元，其他地方只用extern声明
 - 在性能关键路径上使用可以获得显著优化效果
 */
\ No newline at end of file
@@ -9,6 +9,8 @@
  * 5. 显式对象参数 - deducing this支持更好的成员函数推导
  * 6. 静态调用操作符 - static operator()支持无状态可调用对象
  * 7. 其他标准库改进 - 各种实用的小改进
+ * 8. 平坦映射优化 - 键值分离、批量归并插入、Eytzinger索引与SIMD小表扫描
+ * 9. 批量生成器 - 缓冲区攒满才挂起，以span为单位产出，views::join展平回元素
  */
 
 #include <iostream>
@@ -35,6 +37,18 @@
 #include <optional>
 #include <variant>
 #include <numbers>
+#include <unordered_map>
+#include <random>
+#include <iomanip>
+#include <cstdint>
+#include <coroutine>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 // ===== 1. std::stacktrace - 栈追踪支持 =====
 void demonstrate_stacktrace() {
@@ -95,70 +109,79 @@ void demonstrate_stacktrace() {
 }
 
 // ===== 2. 平坦容器 - std::flat_map和std::flat_set =====
-void demonstrate_flat_containers() {
-    std::cout << "=== 平坦容器 - std::flat_map和std::flat_set ===\n";
+// 模拟std::flat_map的实现（基于排序的vector）
+// 类模板不能定义在函数体内，放在命名空间作用域
+template<typename Key, typename Value, typename Compare = std::less<Key>>
+class flat_map {
+private:
+    std::vector<std::pair<Key, Value>> data_;
+    Compare comp_;
     
-    // 模拟std::flat_map的实现（基于排序的vector）
-    template<typename Key, typename Value, typename Compare = std::less<Key>>
-    class flat_map {
-    private:
-        std::vector<std::pair<Key, Value>> data_;
-        Compare comp_;
-        
-    public:
-        using key_type = Key;
-        using mapped_type = Value;
-        using value_type = std::pair<Key, Value>;
-        using size_type = size_t;
-        
-        flat_map() = default;
-        
-        template<typename InputIt>
-        flat_map(InputIt first, InputIt last, Compare comp = Compare{})
-            : data_(first, last), comp_(comp) {
-            std::sort(data_.begin(), data_.end(), 
-                     [this](const auto& a, const auto& b) {
-                         return comp_(a.first, b.first);
-                     });
-        }
-        
-        auto insert(const value_type& value) {
-            auto it = std::lower_bound(data_.begin(), data_.end(), value,
-                                      [this](const auto& a, const auto& b) {
-                                          return comp_(a.first, b.first);
-                                      });
-            data_.insert(it, value);
-        }
-        
-        auto find(const Key& key) {
-            auto it = std::lower_bound(data_.begin(), data_.end(), key,
-                                      [this](const auto& a, const auto& b) {
-                                          return comp_(a.first, b);
-                                      });
-            return (it != data_.end() && it->first == key) ? it : data_.end();
-        }
-        
-        auto& operator[](const Key& key) {
-            auto it = find(key);
-            if (it == data_.end()) {
-                data_.insert(std::lower_bound(data_.begin(), data_.end(), key,
-                                           [this](const auto& a, const auto& b) {
-                                               return comp_(a.first, b.first);
-                                           }), 
-                           std::make_pair(key, Value{}));
-                it = find(key);
-            }
-            return it->second;
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using size_type = size_t;
+    
+    flat_map() = default;
+    
+    template<typename InputIt>
+    flat_map(InputIt first, InputIt last, Compare comp = Compare{})
+        : data_(first, last), comp_(comp) {
+        std::sort(data_.begin(), data_.end(), 
+                 [this](const auto& a, const auto& b) {
+                     return comp_(a.first, b.first);
+                 });
+    }
+    
+    auto insert(const value_type& value) {
+        auto it = std::lower_bound(data_.begin(), data_.end(), value,
+                                  [this](const auto& a, const auto& b) {
+                                      return comp_(a.first, b.first);
+                                  });
+        data_.insert(it, value);
+    }
+    
+    auto find(const Key& key) {
+        auto it = std::lower_bound(data_.begin(), data_.end(), key,
+                                  [this](const auto& a, const auto& b) {
+                                      return comp_(a.first, b);
+                                  });
+        return (it != data_.end() && it->first == key) ? it : data_.end();
+    }
+    
+    auto find(const Key& key) const {
+        auto it = std::lower_bound(data_.begin(), data_.end(), key,
+                                  [this](const auto& a, const auto& b) {
+                                      return comp_(a.first, b);
+                                  });
+        return (it != data_.end() && it->first == key) ? it : data_.end();
+    }
+    
+    auto& operator[](const Key& key) {
+        auto it = find(key);
+        if (it == data_.end()) {
+            data_.insert(std::lower_bound(data_.begin(), data_.end(), key,
+                                       [this](const auto& a, const auto& b) {
+                                           return comp_(a.first, b.first);
+                                       }), 
+                       std::make_pair(key, Value{}));
+            it = find(key);
         }
-        
-        size_t size() const { return data_.size(); }
-        bool empty() const { return data_.empty(); }
-        
-        auto begin() { return data_.begin(); }
-        auto end() { return data_.end(); }
-        auto begin() const { return data_.begin(); }
-        auto end() const { return data_.end(); }
-    };
+        return it->second;
+    }
+    
+    size_t size() const { return data_.size(); }
+    bool empty() const { return data_.empty(); }
+    
+    auto begin() { return data_.begin(); }
+    auto end() { return data_.end(); }
+    auto begin() const { return data_.begin(); }
+    auto end() const { return data_.end(); }
+};
+
+void demonstrate_flat_containers() {
+    std::cout << "=== 平坦容器 - std::flat_map和std::flat_set ===\n";
     
     // 性能对比测试
     std::cout << "容器性能对比:\n";
@@ -543,6 +566,490 @@ void demonstrate_other_improvements() {
     std::cout << "\n\n";
 }
 
+// ===== 8. 平坦映射的缓存友好优化 =====
+// flat_map把pair<Key,Value>存在一起，二分查找时每次比较都要把整个pair拉进缓存
+// soa_flat_map做了四件事：
+// 1. 键和值分成两个数组，查找只触碰键数组
+// 2. insert_range先把一批数据排好序，再与已有数据归并一次，而不是逐个O(n)插入
+// 3. 可选的Eytzinger(BFS顺序)索引：无分支下降，提前预取4层之后的节点
+// 4. 元素很少时用SIMD线性扫描代替二分
+template<typename Key, typename Value, typename Compare = std::less<Key>>
+class soa_flat_map {
+private:
+    static constexpr size_t kLinearLimit = 32;  // 不超过这个大小时线性扫描
+    // 小而平凡的值直接复制一份到BFS顺序，命中后少一次随机访问；其余类型只记录有序位置
+    static constexpr bool kInlineValues = std::is_trivially_copyable_v<Value> && sizeof(Value) <= 16;
+    using IndexPayload = std::conditional_t<kInlineValues, Value, uint32_t>;
+
+    std::vector<Key> keys_;
+    std::vector<Value> values_;
+    std::vector<Key> eytz_keys_;             // 下标从1开始的BFS顺序
+    std::vector<IndexPayload> eytz_payload_;  // 与eytz_keys_同序的值或有序位置
+    bool index_valid_ = false;
+    Compare comp_;
+
+    bool equal(const Key& a, const Key& b) const { return !comp_(a, b) && !comp_(b, a); }
+
+    // 有序数组里第一个不小于key的位置
+    size_t lower_bound_index(const Key& key) const {
+        if (keys_.size() <= kLinearLimit) return linear_lower_bound(key);
+        return branchless_lower_bound(key);
+    }
+
+    // 每步只根据比较结果移动base，编译成cmov，不受分支预测失败影响
+    size_t branchless_lower_bound(const Key& key) const {
+        const Key* base = keys_.data();
+        size_t len = keys_.size();
+        while (len > 1) {
+            const size_t half = len / 2;
+            base = comp_(base[half - 1], key) ? base + half : base;
+            len -= half;
+        }
+        return static_cast<size_t>(base - keys_.data()) + static_cast<size_t>(comp_(*base, key));
+    }
+
+    size_t linear_lower_bound(const Key& key) const {
+        const Key* data = keys_.data();
+        const size_t n = keys_.size();
+        size_t i = 0;
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<Key, int32_t> && std::is_same_v<Compare, std::less<Key>>) {
+            // 统计小于key的元素个数，就是lower_bound的位置
+            const __m128i needle = _mm_set1_epi32(key);
+            size_t count = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(v, needle)));
+                count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+            }
+            for (; i < n; ++i) count += comp_(data[i], key);
+            return count;
+        }
+#endif
+        while (i < n && comp_(data[i], key)) ++i;
+        return i;
+    }
+
+    // 返回BFS下标，0表示所有键都小于key
+    size_t eytzinger_lower_bound(const Key& key) const {
+        const size_t n = keys_.size();
+        const Key* tree = eytz_keys_.data();
+        // 预取k*16处：k的第4代子孙共16个，在BFS顺序里连续存放，int32键正好占满一条缓存行
+        constexpr size_t kPrefetchStride = 64 / sizeof(Key) > 0 ? 64 / sizeof(Key) : 1;
+        size_t k = 1;
+        while (k <= n) {
+            __builtin_prefetch(tree + std::min(k * kPrefetchStride, n));
+            k = 2 * k + static_cast<size_t>(comp_(tree[k], key));
+        }
+        // 去掉末尾连续的1以及其后的一个0，回到最后一次"向左走"的节点
+        k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+        return k;
+    }
+
+    size_t build_eytzinger(size_t sorted_index, size_t k) {
+        if (k <= keys_.size()) {
+            sorted_index = build_eytzinger(sorted_index, 2 * k);
+            eytz_keys_[k] = keys_[sorted_index];
+            if constexpr (kInlineValues) {
+                eytz_payload_[k] = values_[sorted_index];
+            } else {
+                eytz_payload_[k] = static_cast<uint32_t>(sorted_index);
+            }
+            ++sorted_index;
+            sorted_index = build_eytzinger(sorted_index, 2 * k + 1);
+        }
+        return sorted_index;
+    }
+
+public:
+    soa_flat_map() = default;
+
+    template<typename InputIt>
+    soa_flat_map(InputIt first, InputIt last, Compare comp = Compare{}) : comp_(comp) {
+        insert_range(first, last);
+    }
+
+    // 批量插入：批内排序去重，再与已有数据线性归并；已存在的键保持原值（与insert语义一致）
+    template<typename InputIt>
+    void insert_range(InputIt first, InputIt last) {
+        std::vector<std::pair<Key, Value>> batch(first, last);
+        if (batch.empty()) return;
+        std::stable_sort(batch.begin(), batch.end(),
+                         [this](const auto& a, const auto& b) { return comp_(a.first, b.first); });
+        batch.erase(std::unique(batch.begin(), batch.end(),
+                                [this](const auto& a, const auto& b) { return equal(a.first, b.first); }),
+                    batch.end());
+
+        std::vector<Key> keys;
+        std::vector<Value> values;
+        keys.reserve(keys_.size() + batch.size());
+        values.reserve(keys_.size() + batch.size());
+        size_t i = 0, j = 0;
+        while (i < keys_.size() || j < batch.size()) {
+            if (j == batch.size() || (i < keys_.size() && comp_(keys_[i], batch[j].first))) {
+                keys.push_back(std::move(keys_[i]));
+                values.push_back(std::move(values_[i]));
+                ++i;
+            } else if (i == keys_.size() || comp_(batch[j].first, keys_[i])) {
+                keys.push_back(std::move(batch[j].first));
+                values.push_back(std::move(batch[j].second));
+                ++j;
+            } else {
+                ++j;  // 键已存在，丢弃批内的值
+            }
+        }
+        keys_ = std::move(keys);
+        values_ = std::move(values);
+        index_valid_ = false;
+    }
+
+    bool insert(const Key& key, const Value& value) {
+        size_t pos = static_cast<size_t>(std::lower_bound(keys_.begin(), keys_.end(), key, comp_) - keys_.begin());
+        if (pos < keys_.size() && equal(keys_[pos], key)) return false;
+        keys_.insert(keys_.begin() + pos, key);
+        values_.insert(values_.begin() + pos, value);
+        index_valid_ = false;
+        return true;
+    }
+
+    // 读多写少时在批量写入后调用一次；任何修改都会使索引失效并退回二分查找
+    void build_index() {
+        eytz_keys_.assign(keys_.size() + 1, Key{});
+        eytz_payload_.assign(keys_.size() + 1, IndexPayload{});
+        build_eytzinger(0, 1);
+        index_valid_ = true;
+    }
+
+    bool has_index() const { return index_valid_; }
+
+    // 有索引时只读BFS数组：键直接在树节点上比较，内联的值也在同一下标
+    const Value* find(const Key& key) const {
+        if (index_valid_ && keys_.size() > kLinearLimit) {
+            size_t k = eytzinger_lower_bound(key);
+            if (k == 0 || !equal(eytz_keys_[k], key)) return nullptr;
+            if constexpr (kInlineValues) {
+                return &eytz_payload_[k];
+            } else {
+                return &values_[eytz_payload_[k]];
+            }
+        }
+        size_t pos = lower_bound_index(key);
+        return (pos < keys_.size() && equal(keys_[pos], key)) ? &values_[pos] : nullptr;
+    }
+
+    // 可写查找始终返回有序数组里的值；索引里内联了值的副本时，调用方可能经返回的指针改值，
+    // 因此先让索引失效，之后const find()退回有序数组，直到再次build_index()
+    Value* find(const Key& key) {
+        if constexpr (kInlineValues) index_valid_ = false;
+        size_t pos = lower_bound_index(key);
+        return (pos < keys_.size() && equal(keys_[pos], key)) ? &values_[pos] : nullptr;
+    }
+
+    bool contains(const Key& key) const { return find(key) != nullptr; }
+
+    Value& operator[](const Key& key) {
+        if (Value* value = find(key)) return *value;
+        insert(key, Value{});
+        return *find(key);
+    }
+
+    size_t size() const { return keys_.size(); }
+    bool empty() const { return keys_.empty(); }
+    const std::vector<Key>& keys() const { return keys_; }
+    const std::vector<Value>& values() const { return values_; }
+};
+
+template<typename Map>
+[[gnu::noinline]] long long lookup_sum(const Map& map, const std::vector<int32_t>& queries) {
+    long long sum = 0;
+    for (int32_t q : queries) {
+        if constexpr (requires { map.find(q) == map.end(); }) {
+            auto it = map.find(q);
+            if (it != map.end()) sum += it->second;
+        } else {
+            if (const auto* value = map.find(q)) sum += *value;
+        }
+    }
+    return sum;
+}
+
+void demonstrate_soa_flat_map() {
+    std::cout << "=== 平坦映射的缓存友好优化 ===\n";
+
+    // 基本用法：批量插入与已有键的合并
+    soa_flat_map<int32_t, std::string> names;
+    names.insert(5, "five");
+    std::vector<std::pair<int32_t, std::string>> batch{{3, "three"}, {5, "FIVE"}, {1, "one"}, {3, "dup"}};
+    names.insert_range(batch.begin(), batch.end());
+    std::cout << "insert_range后:";
+    for (size_t i = 0; i < names.size(); ++i) std::cout << " " << names.keys()[i] << "=" << names.values()[i];
+    std::cout << "\n";
+    names.build_index();
+    std::cout << "索引查找 3 -> " << *names.find(3) << ", 4 -> " << (names.contains(4) ? "有" : "无") << "\n\n";
+
+    // 查找性能：10 ~ 10M个元素，每种规模做同样多次随机查找（一半命中）
+    std::mt19937 rng(42);
+    const size_t lookups = 1'000'000;
+    auto time_ms = [](auto&& f) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = f();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return std::pair{ms, result};
+    };
+
+    std::cout << "元素数      std::map  unordered  flat_map(pair)  SoA二分  SoA+Eytzinger   (ms/" << lookups
+              << "次查找)\n";
+    for (size_t n : {size_t{10}, size_t{1'000}, size_t{100'000}, size_t{1'000'000}, size_t{10'000'000}}) {
+        std::vector<std::pair<int32_t, int32_t>> data(n);
+        for (size_t i = 0; i < n; ++i) data[i] = {static_cast<int32_t>(i * 2), static_cast<int32_t>(i)};
+        std::shuffle(data.begin(), data.end(), rng);
+        std::vector<int32_t> queries(lookups);
+        for (auto& q : queries) q = static_cast<int32_t>(rng() % (2 * n));
+
+        double map_ms, hash_ms, pair_ms, soa_ms, eytz_ms;
+        long long expected;
+        {
+            std::map<int32_t, int32_t> map(data.begin(), data.end());
+            std::tie(map_ms, expected) = time_ms([&] { return lookup_sum(map, queries); });
+        }
+        {
+            std::unordered_map<int32_t, int32_t> hash(data.begin(), data.end());
+            long long sum;
+            std::tie(hash_ms, sum) = time_ms([&] { return lookup_sum(hash, queries); });
+            if (sum != expected) std::cout << "结果不一致!\n";
+        }
+        {
+            flat_map<int32_t, int32_t> pairs(data.begin(), data.end());
+            long long sum;
+            std::tie(pair_ms, sum) = time_ms([&] { return lookup_sum(pairs, queries); });
+            if (sum != expected) std::cout << "结果不一致!\n";
+        }
+        {
+            soa_flat_map<int32_t, int32_t> soa(data.begin(), data.end());
+            long long sum;
+            std::tie(soa_ms, sum) = time_ms([&] { return lookup_sum(soa, queries); });
+            if (sum != expected) std::cout << "结果不一致!\n";
+            soa.build_index();
+            std::tie(eytz_ms, sum) = time_ms([&] { return lookup_sum(soa, queries); });
+            if (sum != expected) std::cout << "结果不一致!\n";
+        }
+        const auto old_flags = std::cout.flags();
+        const auto old_precision = std::cout.precision();
+        std::cout << std::left << std::setw(10) << n << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << map_ms << std::setw(11) << hash_ms << std::setw(16) << pair_ms
+                  << std::setw(9) << soa_ms << std::setw(15) << eytz_ms << "\n";
+        std::cout.flags(old_flags);
+        std::cout.precision(old_precision);
+    }
+
+    // 构造：逐个insert vs insert_range
+    const size_t build_n = 20'000;
+    std::vector<std::pair<int32_t, int32_t>> build_data(build_n);
+    for (size_t i = 0; i < build_n; ++i) build_data[i] = {static_cast<int32_t>(rng()), static_cast<int32_t>(i)};
+    auto [single_ms, single_size] = time_ms([&] {
+        soa_flat_map<int32_t, int32_t> m;
+        for (const auto& [k, v] : build_data) m.insert(k, v);
+        return m.size();
+    });
+    auto [range_ms, range_size] = time_ms([&] {
+        soa_flat_map<int32_t, int32_t> m;
+        m.insert_range(build_data.begin(), build_data.end());
+        return m.size();
+    });
+    std::cout << "\n插入 " << build_n << " 个随机键: 逐个insert " << single_ms << " ms, insert_range " << range_ms
+              << " ms (" << single_ms / range_ms << "x), 大小" << (single_size == range_size ? "一致" : "不一致")
+              << "\n\n";
+}
+
+// ===== 9. 批量生成器 - 一次恢复交出一个span =====
+// 逐元素的generator每个co_yield都要挂起/恢复一次；batched_generator把值攒进promise里的缓冲区，
+// 满N个(或协程结束)才挂起，对外是std::span<const T>组成的input_range：
+// - 按批消费：for (std::span<const T> chunk : gen)
+// - 按元素消费：gen.elements() 即 std::views::join，原来逐元素的代码照旧能用
+// 标准库提供std::generator后，同样的思路可以写成 std::generator<std::span<const T>> 再join展平
+template<typename T, size_t N = 64>
+class batched_generator {
+    static_assert(N > 0);
+    static_assert(std::default_initializable<T>, "缓冲区需要默认构造元素");
+
+public:
+    struct promise_type;
+    using handle_type = std::coroutine_handle<promise_type>;
+    
+    struct promise_type {
+        std::array<T, N> buffer;
+        size_t count = 0;
+        std::exception_ptr exception;
+        
+        // 缓冲区未满时await_ready为true，协程不挂起
+        struct yield_awaiter {
+            bool full;
+            bool await_ready() const noexcept { return !full; }
+            void await_suspend(std::coroutine_handle<>) const noexcept {}
+            void await_resume() const noexcept {}
+        };
+        
+        auto get_return_object() { return batched_generator{handle_type::from_promise(*this)}; }
+        auto initial_suspend() { return std::suspend_always{}; }
+        auto final_suspend() noexcept { return std::suspend_always{}; }
+        void return_void() {}
+        void unhandled_exception() { exception = std::current_exception(); }
+        
+        yield_awaiter yield_value(T value) {
+            buffer[count++] = std::move(value);
+            return {count == N};
+        }
+    };
+    
+    class iterator {
+    public:
+        using value_type = std::span<const T>;
+        using difference_type = std::ptrdiff_t;
+        
+        iterator() = default;
+        explicit iterator(handle_type coro) : coro_(coro) { fill(); }
+        
+        std::span<const T> operator*() const {
+            return {coro_.promise().buffer.data(), coro_.promise().count};
+        }
+        iterator& operator++() { fill(); return *this; }
+        void operator++(int) { fill(); }
+        
+        bool operator==(std::default_sentinel_t) const { return !coro_; }
+        
+    private:
+        handle_type coro_;
+        
+        // 恢复到攒满一批或结束；最后一批可能不满，之后才报告结束或重新抛出异常
+        // 被移走的生成器句柄为空，直接视为结束
+        void fill() {
+            if (!coro_) return;
+            auto& promise = coro_.promise();
+            promise.count = 0;
+            if (!coro_.done()) {
+                coro_.resume();
+                if (promise.count > 0) return;
+            }
+            coro_ = nullptr;  // 帧仍归batched_generator所有，promise引用依然有效
+            if (promise.exception) std::rethrow_exception(std::exchange(promise.exception, nullptr));
+        }
+    };
+    
+    explicit batched_generator(handle_type h) : coro_(h) {}
+    ~batched_generator() { if (coro_) coro_.destroy(); }
+    
+    batched_generator(const batched_generator&) = delete;
+    batched_generator& operator=(const batched_generator&) = delete;
+    
+    batched_generator(batched_generator&& other) noexcept : coro_(std::exchange(other.coro_, nullptr)) {}
+    
+    batched_generator& operator=(batched_generator&& other) noexcept {
+        if (this != &other) {
+            if (coro_) coro_.destroy();
+            coro_ = std::exchange(other.coro_, nullptr);
+        }
+        return *this;
+    }
+    
+    // 和generator一样是单趟的：begin()只能调用一次
+    iterator begin() { return iterator(coro_); }
+    std::default_sentinel_t end() const { return {}; }
+    
+    auto elements() & { return *this | std::views::join; }
+    
+private:
+    handle_type coro_;
+};
+
+template<typename Body>
+double best_ns_per_item(size_t items, Body&& body) {
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ns / static_cast<double>(items));
+    }
+    return best;
+}
+
+void demonstrate_batched_generator() {
+    std::cout << "=== 批量生成器 - 按span产出 ===\n";
+    
+    auto squares = [](int n) -> batched_generator<int, 4> {
+        for (int i = 0; i < n; ++i) co_yield i * i;
+    };
+    
+    std::cout << "按批消费:\n";
+    for (std::span<const int> chunk : squares(10)) {
+        std::cout << "  [" << chunk.size() << "]";
+        for (int v : chunk) std::cout << " " << v;
+        std::cout << "\n";
+    }
+    
+    std::cout << "elements()展平并接入ranges:";
+    auto gen = squares(10);
+    for (int v : gen.elements() | std::views::filter([](int v) { return v % 2 == 1; })) {
+        std::cout << " " << v;
+    }
+    std::cout << "\n";
+    
+    // 协程抛出的异常在已产出的元素交付后才传给消费者
+    auto failing = []() -> batched_generator<int, 4> {
+        for (int i = 0; i < 6; ++i) co_yield i;
+        throw std::runtime_error("数据源中断");
+    }();
+    int delivered = 0;
+    try {
+        for (int v : failing.elements()) delivered += (v >= 0);
+    } catch (const std::exception& e) {
+        std::cout << "取到 " << delivered << " 个元素后捕获异常: " << e.what() << "\n";
+    }
+    
+    // 每个元素一次恢复 vs 每64个元素一次恢复
+    struct single_generator {
+        struct promise_type {
+            int value = 0;
+            single_generator get_return_object() {
+                return {std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            std::suspend_always yield_value(int v) { value = v; return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+        std::coroutine_handle<promise_type> coro;
+        ~single_generator() { coro.destroy(); }
+    };
+    
+    constexpr int n = 10'000'000;
+    long long sum_single = 0, sum_batched = 0, sum_chunks = 0;
+    double single_ns = best_ns_per_item(n, [&] {
+        auto g = [](int count) -> single_generator { for (int i = 0; i < count; ++i) co_yield i; }(n);
+        sum_single = 0;
+        for (g.coro.resume(); !g.coro.done(); g.coro.resume()) sum_single += g.coro.promise().value;
+    });
+    double batched_ns = best_ns_per_item(n, [&] {
+        auto g = [](int count) -> batched_generator<int> { for (int i = 0; i < count; ++i) co_yield i; }(n);
+        sum_batched = 0;
+        for (int v : g.elements()) sum_batched += v;
+    });
+    double chunk_ns = best_ns_per_item(n, [&] {
+        auto g = [](int count) -> batched_generator<int> { for (int i = 0; i < count; ++i) co_yield i; }(n);
+        sum_chunks = 0;
+        for (std::span<const int> chunk : g) sum_chunks += std::accumulate(chunk.begin(), chunk.end(), 0LL);
+    });
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n遍历 " << n << " 个int:\n";
+    std::cout << "  逐元素generator:         " << single_ns << " ns/个\n";
+    std::cout << "  batched elements():      " << batched_ns << " ns/个\n";
+    std::cout << "  batched 按span消费:      " << chunk_ns << " ns/个\n";
+    std::cout << "  结果一致: " << (sum_single == sum_batched && sum_batched == sum_chunks ? "是" : "否") << "\n";
+    std::cout << std::defaultfloat;
+    std::cout << "注：恢复本身只是一次间接调用，收益取决于它在每个元素上的占比；批内仍是逐个co_yield\n\n";
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++23 补充特性和标准库改进深度解析\n";
@@ -554,6 +1061,8 @@ int main() {
     demonstrate_deducing_this();
     demonstrate_static_operator();
     demonstrate_other_improvements();
+    demonstrate_soa_flat_map();
+    demonstrate_batched_generator();
     
     return 0;
 }
@@ -576,10 +1085,15 @@ g++ -std=c++23 -O2 -Wall -fcoroutines 07_additional_features.cpp -o additional_d
 4. 显式对象参数支持更灵活的成员函数设计
 5. 静态调用操作符支持无状态的函数对象
 6. 各种标准库改进提升了日常开发体验
+7. 平坦映射的查找只应触碰键数组；读多写少时Eytzinger布局让二分查找可预取、无分支
+8. batched_generator让co_yield在缓冲区未满时不挂起，消费者按span处理或用views::join展平
 
 注意事项:
 - 部分特性可能还在实验性阶段
 - 需要检查编译器的具体支持情况
 - 某些特性可能需要特定的编译标志
 - 在生产环境中使用前需要进行充分测试
+- soa_flat_map的索引在任何修改后失效，应在批量写入完成后再build_index
+- 纯随机点查找unordered_map依然最快，平坦映射的优势在有序遍历、范围查询和内存占用
+- batched_generator交出的span指向协程内部缓冲区，迭代器前进后即失效
 */
\ No newline at end of file
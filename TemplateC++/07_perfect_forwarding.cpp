@@ -17,6 +17,8 @@
 #include <type_traits>
 #include <utility>
 
+#include "../common/micro_bench.h"
+
 // ===== 1. 完美转发的设计动机演示 =====
 void demonstrate_forwarding_motivation() {
     std::cout << "=== 完美转发的设计动机演示 ===\n";
@@ -323,8 +325,6 @@ void demonstrate_forwarding_limitations() {
 void benchmark_perfect_forwarding() {
     std::cout << "=== 完美转发性能基准测试 ===\n";
     
-    const int iterations = 1000000;
-    
     // 测试对象
     struct TestObj {
         std::string data;
@@ -344,34 +344,26 @@ void benchmark_perfect_forwarding() {
     
     std::string test_str = "benchmark_test_string";
     
-    // 基准测试：拷贝方式
-    auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; ++i) {
+    // 基准测试：每次迭代构造一个对象，预热、重复采样并取中位数交给统一基准框架
+    const auto copy_result = micro_bench::measure("拷贝方式", [&]() {
         auto obj = copy_approach(test_str);
-        (void)obj;  // 防止优化
-    }
-    auto copy_time = std::chrono::high_resolution_clock::now() - start;
+        micro_bench::do_not_optimize(obj);  // 防止优化
+    });
     
-    // 基准测试：完美转发方式
-    start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; ++i) {
+    const auto forward_result = micro_bench::measure("完美转发", [&]() {
         auto obj = forward_approach(test_str);
-        (void)obj;  // 防止优化
-    }
-    auto forward_time = std::chrono::high_resolution_clock::now() - start;
+        micro_bench::do_not_optimize(obj);  // 防止优化
+    });
     
-    std::cout << "拷贝方式耗时: " 
-              << std::chrono::duration_cast<std::chrono::microseconds>(copy_time).count() 
-              << " 微秒\n";
-    std::cout << "完美转发耗时: " 
-              << std::chrono::duration_cast<std::chrono::microseconds>(forward_time).count() 
-              << " 微秒\n";
+    micro_bench::print_result(std::cout, copy_result);
+    micro_bench::print_result(std::cout, forward_result);
     
     std::cout << "\n";
 }
 
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++11/14/17 完美转发深度解析\n";
     std::cout << "============================\n";
     
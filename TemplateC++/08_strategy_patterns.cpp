@@ -7,6 +7,7 @@
  * 3. 策略的自动推导机制 - SFINAE与Concepts约束
  * 4. 性能优化策略模式 - 零开销抽象
  * 5. 现代C++策略设计 - 函数对象与Lambda策略
+ * 6. 运行期选择策略的静态分派 - 每批分派一次与热点快速路径
  */
 
 #include <iostream>
@@ -18,6 +19,12 @@
 #include <algorithm>
 #include <random>
 #include <concepts>
+#include <variant>
+#include <tuple>
+#include <cstdint>
+#include <iterator>
+
+#include "../common/micro_bench.h"
 
 // ===== 1. 策略模式的模板化实现演示 =====
 void demonstrate_template_strategy() {
@@ -495,17 +502,13 @@ void benchmark_strategy_patterns() {
     std::cout << "=== 策略模式性能基准测试 ===\n";
     
     const int data_size = 10000;
-    const int iterations = 100;
-    
-    // 生成测试数据
-    auto generate_data = []() {
-        std::vector<int> data(data_size);
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::iota(data.begin(), data.end(), 1);
-        std::shuffle(data.begin(), data.end(), gen);
-        return data;
-    };
+    
+    // 生成一份打乱的测试数据；每次迭代先拷贝再排序，生成数据的开销不计入任何一种策略
+    std::vector<int> source(data_size);
+    std::iota(source.begin(), source.end(), 1);
+    std::shuffle(source.begin(), source.end(), std::mt19937(std::random_device{}()));
+    std::vector<int> data;
+    data.reserve(source.size());
     
     // 传统多态策略（虚函数）
     class VirtualStrategy {
@@ -529,53 +532,38 @@ void benchmark_strategy_patterns() {
     };
     
     // 基准测试：虚函数策略
-    auto virtual_strategy = std::make_unique<VirtualQuickSort>();
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    for (int i = 0; i < iterations; ++i) {
-        auto data = generate_data();
+    std::unique_ptr<VirtualStrategy> virtual_strategy = std::make_unique<VirtualQuickSort>();
+    const auto virtual_result = micro_bench::measure("虚函数策略", [&]() {
+        data = source;
         virtual_strategy->sort(data);
-    }
-    
-    auto virtual_time = std::chrono::high_resolution_clock::now() - start;
+        micro_bench::do_not_optimize(data.data());
+    }, data_size);
     
     // 基准测试：模板策略
     TemplateQuickSort template_strategy;
-    start = std::chrono::high_resolution_clock::now();
-    
-    for (int i = 0; i < iterations; ++i) {
-        auto data = generate_data();
+    const auto template_result = micro_bench::measure("模板策略", [&]() {
+        data = source;
         template_strategy.sort(data);
-    }
-    
-    auto template_time = std::chrono::high_resolution_clock::now() - start;
+        micro_bench::do_not_optimize(data.data());
+    }, data_size);
     
     // 基准测试：Lambda策略
     auto lambda_strategy = [](std::vector<int>& data) {
         std::sort(data.begin(), data.end());
     };
     
-    start = std::chrono::high_resolution_clock::now();
-    
-    for (int i = 0; i < iterations; ++i) {
-        auto data = generate_data();
+    const auto lambda_result = micro_bench::measure("Lambda策略", [&]() {
+        data = source;
         lambda_strategy(data);
-    }
-    
-    auto lambda_time = std::chrono::high_resolution_clock::now() - start;
+        micro_bench::do_not_optimize(data.data());
+    }, data_size);
     
-    std::cout << "虚函数策略耗时: " 
-              << std::chrono::duration_cast<std::chrono::milliseconds>(virtual_time).count() 
-              << " 毫秒\n";
-    std::cout << "模板策略耗时: " 
-              << std::chrono::duration_cast<std::chrono::milliseconds>(template_time).count() 
-              << " 毫秒\n";
-    std::cout << "Lambda策略耗时: " 
-              << std::chrono::duration_cast<std::chrono::milliseconds>(lambda_time).count() 
-              << " 毫秒\n";
+    micro_bench::print_result(std::cout, virtual_result);
+    micro_bench::print_result(std::cout, template_result);
+    micro_bench::print_result(std::cout, lambda_result);
     
-    double speedup_template = static_cast<double>(virtual_time.count()) / template_time.count();
-    double speedup_lambda = static_cast<double>(virtual_time.count()) / lambda_time.count();
+    double speedup_template = virtual_result.median_ns / template_result.median_ns;
+    double speedup_lambda = virtual_result.median_ns / lambda_result.median_ns;
     
     std::cout << "模板策略加速比: " << speedup_template << "x\n";
     std::cout << "Lambda策略加速比: " << speedup_lambda << "x\n";
@@ -583,8 +571,359 @@ void benchmark_strategy_patterns() {
     std::cout << "\n";
 }
 
+// ===== 6. 运行期选择策略的静态分派 =====
+// ModernStrategyContainer在运行期持有策略，每处理一个元素都要经过一次间接调用
+// 这里把"选哪个策略"和"执行策略"拆开：每批数据只分派一次，批内执行单态化的循环
+namespace static_dispatch {
+
+// 三个逐元素策略，每个都足够小，分派开销会占到总开销的大头
+struct ScaleStrategy {
+    int factor = 1;
+    static const char* name() { return "Scale"; }
+    int operator()(int x) const { return x * factor; }
+};
+
+struct OffsetStrategy {
+    int delta = 0;
+    static const char* name() { return "Offset"; }
+    int operator()(int x) const { return x + delta; }
+};
+
+struct ClampStrategy {
+    int lo = 0;
+    int hi = 0;
+    static const char* name() { return "Clamp"; }
+    int operator()(int x) const { return x < lo ? lo : (x > hi ? hi : x); }
+};
+
+// 策略在参数包中的下标
+template<typename T, typename... Ts>
+struct index_of;
+
+template<typename T, typename... Ts>
+struct index_of<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+
+template<typename T, typename U, typename... Ts>
+struct index_of<T, U, Ts...> : std::integral_constant<std::size_t, 1 + index_of<T, Ts...>::value> {};
+
+// 对照组：运行期持有虚接口，逐元素调用
+class DynamicStrategy {
+public:
+    virtual ~DynamicStrategy() = default;
+    virtual int apply(int x) const = 0;
+};
+
+template<typename Strategy>
+class DynamicAdapter final : public DynamicStrategy {
+    Strategy strategy_;
+
+public:
+    explicit DynamicAdapter(Strategy s) : strategy_(s) {}
+    int apply(int x) const override { return strategy_(x); }
+};
+
+class PerCallEngine {
+    std::unique_ptr<DynamicStrategy> strategy_;
+
+public:
+    template<typename Strategy>
+    void select(Strategy s) { strategy_ = std::make_unique<DynamicAdapter<Strategy>>(s); }
+
+    [[gnu::noinline]] void run_batch(std::vector<int>& data) const {
+        for (auto& x : data) x = strategy_->apply(x);
+    }
+};
+
+// 方案一：variant保存当前策略，std::visit只在批开头执行一次
+// lambda对每个备选类型各实例化一份循环，循环体内是具体类型的内联调用
+template<typename... Strategies>
+class VariantEngine {
+    std::variant<Strategies...> current_;
+
+public:
+    template<typename Strategy>
+    void select(Strategy s) { current_ = s; }
+
+    std::size_t index() const { return current_.index(); }
+
+    [[gnu::noinline]] void run_batch(std::vector<int>& data) const {
+        std::visit([&data](auto strategy) {
+            int* p = data.data();
+            const std::size_t n = data.size();
+            for (std::size_t i = 0; i < n; ++i) p[i] = strategy(p[i]);
+        }, current_);
+    }
+};
+
+// 方案二：每个策略的批处理循环实例化为一个函数，放进constexpr函数指针表
+// 选择策略只是改一个下标，批内没有任何间接调用
+template<typename... Strategies>
+class TableEngine {
+    using Params = std::tuple<Strategies...>;
+    using BatchKernel = void (*)(const Params&, int*, std::size_t);
+
+    template<typename Strategy>
+    static void batch_kernel(const Params& params, int* data, std::size_t n) {
+        const Strategy strategy = std::get<Strategy>(params);
+        for (std::size_t i = 0; i < n; ++i) data[i] = strategy(data[i]);
+    }
+
+    static constexpr BatchKernel kernels_[] = {&batch_kernel<Strategies>...};
+
+    Params params_{};
+    std::size_t index_ = 0;
+
+public:
+    template<typename Strategy>
+    void select(Strategy s) {
+        std::get<Strategy>(params_) = s;
+        index_ = index_of<Strategy, Strategies...>::value;
+    }
+
+    std::size_t index() const { return index_; }
+
+    [[gnu::noinline]] void run_batch(std::vector<int>& data) const {
+        kernels_[index_](params_, data.data(), data.size());
+    }
+};
+
+// 另一种负载：每个元素自带策略编号，无法整批选一次策略
+struct Command {
+    std::uint8_t strategy;
+    int value;
+};
+
+// 逐元素查表：每个元素一次间接调用
+template<typename... Strategies>
+class StreamTable {
+protected:
+    using Params = std::tuple<Strategies...>;
+    using ElementKernel = int (*)(const Params&, int);
+
+    template<typename Strategy>
+    static int element_kernel(const Params& params, int x) {
+        return std::get<Strategy>(params)(x);
+    }
+
+    static constexpr ElementKernel element_kernels_[] = {&element_kernel<Strategies>...};
+
+    Params params_{};
+
+public:
+    template<typename Strategy>
+    void configure(Strategy s) { std::get<Strategy>(params_) = s; }
+
+    [[gnu::noinline]] long long run_stream(const std::vector<Command>& commands) const {
+        long long sum = 0;
+        for (const auto& cmd : commands) {
+            sum += element_kernels_[cmd.strategy](params_, cmd.value);
+        }
+        return sum;
+    }
+};
+
+// 方案三：带剖析的引擎
+// 先对样本统计各策略命中次数，选出热点策略，再按热点选择一个实例化好的循环：
+// 循环里先比较编号，命中热点时走内联的快速路径，其余情况回退到函数指针表
+// 这与编译器的"推测性去虚化"(guarded devirtualization)是同一个思路
+template<typename... Strategies>
+class ProfiledEngine : public StreamTable<Strategies...> {
+    using Base = StreamTable<Strategies...>;
+    using typename Base::Params;
+    using StreamLoop = long long (*)(const Params&, const Command*, std::size_t, std::size_t&);
+
+    template<typename Hot>
+    static long long guarded_loop(const Params& params, const Command* cmds, std::size_t n,
+                                  std::size_t& misses) {
+        constexpr std::size_t hot_index = index_of<Hot, Strategies...>::value;
+        const Hot hot = std::get<Hot>(params);
+        long long sum = 0;
+        std::size_t local_misses = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (cmds[i].strategy == hot_index) {
+                sum += hot(cmds[i].value);
+            } else {
+                sum += Base::element_kernels_[cmds[i].strategy](params, cmds[i].value);
+                ++local_misses;
+            }
+        }
+        misses = local_misses;
+        return sum;
+    }
+
+    static constexpr StreamLoop loops_[] = {&guarded_loop<Strategies>...};
+
+    std::size_t hot_ = 0;
+    bool profiled_ = false;
+    std::size_t reprofiles_ = 0;
+
+public:
+    // 只抽样统计，剖析成本与数据量无关
+    void profile(const std::vector<Command>& commands, std::size_t sample_stride = 64) {
+        std::size_t counts[sizeof...(Strategies)] = {};
+        for (std::size_t i = 0; i < commands.size(); i += sample_stride) {
+            ++counts[commands[i].strategy];
+        }
+        hot_ = static_cast<std::size_t>(std::max_element(std::begin(counts), std::end(counts)) - std::begin(counts));
+        profiled_ = true;
+    }
+
+    std::size_t hot_index() const { return hot_; }
+    std::size_t reprofile_count() const { return reprofiles_; }
+
+    // 快速路径不计数；只有回退路径统计未命中，超过一半说明分布变了，下一批重新剖析
+    [[gnu::noinline]] long long run_stream(const std::vector<Command>& commands) {
+        if (!profiled_) profile(commands);
+        std::size_t misses = 0;
+        long long sum = loops_[hot_](this->params_, commands.data(), commands.size(), misses);
+        if (misses * 2 > commands.size()) {
+            profiled_ = false;
+            ++reprofiles_;
+        }
+        return sum;
+    }
+};
+
+// 逐元素虚调用的流式对照组
+[[gnu::noinline]] long long run_stream_virtual(const std::vector<Command>& commands,
+                                               const DynamicStrategy* const* table) {
+    long long sum = 0;
+    for (const auto& cmd : commands) sum += table[cmd.strategy]->apply(cmd.value);
+    return sum;
+}
+
+// hot_percent%的命令使用策略hot，其余均匀分布
+std::vector<Command> make_commands(std::size_t n, std::uint8_t hot, int hot_percent, std::mt19937& gen) {
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> any(0, 2);
+    std::uniform_int_distribution<int> value(-1000, 1000);
+    std::vector<Command> commands(n);
+    for (auto& cmd : commands) {
+        cmd.strategy = percent(gen) < hot_percent ? hot : static_cast<std::uint8_t>(any(gen));
+        cmd.value = value(gen);
+    }
+    return commands;
+}
+
+template<typename F>
+double best_ms(int repeats, F&& f) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+} // namespace static_dispatch
+
+void demonstrate_static_dispatch() {
+    std::cout << "=== 运行期选择策略的静态分派演示 ===\n";
+    using namespace static_dispatch;
+
+    // 1. 整批同一策略：分派一次 vs 逐元素分派
+    const std::size_t batch_size = 1 << 20;
+    const int batches = 3;
+    std::vector<int> input(batch_size);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> value(-1000, 1000);
+    for (auto& x : input) x = value(gen);
+
+    PerCallEngine per_call;
+    VariantEngine<ScaleStrategy, OffsetStrategy, ClampStrategy> variant_engine;
+    TableEngine<ScaleStrategy, OffsetStrategy, ClampStrategy> table_engine;
+
+    // 每批轮换策略，模拟运行期配置变化
+    auto select_all = [&](int round) {
+        switch (round % 3) {
+        case 0:
+            per_call.select(ScaleStrategy{3});
+            variant_engine.select(ScaleStrategy{3});
+            table_engine.select(ScaleStrategy{3});
+            break;
+        case 1:
+            per_call.select(OffsetStrategy{-7});
+            variant_engine.select(OffsetStrategy{-7});
+            table_engine.select(OffsetStrategy{-7});
+            break;
+        default:
+            per_call.select(ClampStrategy{-500, 500});
+            variant_engine.select(ClampStrategy{-500, 500});
+            table_engine.select(ClampStrategy{-500, 500});
+            break;
+        }
+    };
+
+    std::vector<int> a, b, c;
+    double per_call_ms = 0, variant_ms = 0, table_ms = 0;
+    for (int round = 0; round < batches; ++round) {
+        select_all(round);
+        per_call_ms += best_ms(5, [&] { a = input; per_call.run_batch(a); });
+        variant_ms += best_ms(5, [&] { b = input; variant_engine.run_batch(b); });
+        table_ms += best_ms(5, [&] { c = input; table_engine.run_batch(c); });
+        if (a != b || a != c) std::cout << "结果不一致!\n";
+    }
+
+    std::cout << "整批处理 " << batches << " 批 x " << batch_size << " 个元素 (含拷贝输入):\n";
+    std::cout << "  虚函数逐元素调用: " << per_call_ms << " ms\n";
+    std::cout << "  variant每批visit一次: " << variant_ms << " ms ("
+              << per_call_ms / variant_ms << "x)\n";
+    std::cout << "  函数指针表每批查一次: " << table_ms << " ms ("
+              << per_call_ms / table_ms << "x)\n";
+
+    // 2. 每个元素自带策略编号：剖析出热点策略，为它内联快速路径
+    const std::size_t stream_size = 1 << 20;
+    auto skewed = make_commands(stream_size, 0, 90, gen);
+
+    ScaleStrategy scale{3};
+    OffsetStrategy offset{-7};
+    ClampStrategy clamp{-500, 500};
+    DynamicAdapter<ScaleStrategy> v0(scale);
+    DynamicAdapter<OffsetStrategy> v1(offset);
+    DynamicAdapter<ClampStrategy> v2(clamp);
+    const DynamicStrategy* virtual_table[] = {&v0, &v1, &v2};
+
+    StreamTable<ScaleStrategy, OffsetStrategy, ClampStrategy> stream_table;
+    ProfiledEngine<ScaleStrategy, OffsetStrategy, ClampStrategy> profiled;
+    for (auto* engine : {static_cast<StreamTable<ScaleStrategy, OffsetStrategy, ClampStrategy>*>(&stream_table),
+                         static_cast<StreamTable<ScaleStrategy, OffsetStrategy, ClampStrategy>*>(&profiled)}) {
+        engine->configure(scale);
+        engine->configure(offset);
+        engine->configure(clamp);
+    }
+
+    long long r1 = 0, r2 = 0, r3 = 0;
+    double virtual_ms = best_ms(5, [&] { r1 = run_stream_virtual(skewed, virtual_table); });
+    double stream_ms = best_ms(5, [&] { r2 = stream_table.run_stream(skewed); });
+    double profiled_ms = best_ms(5, [&] { r3 = profiled.run_stream(skewed); });
+
+    std::cout << "逐元素分派 " << stream_size << " 条命令 (90%为同一策略):\n";
+    std::cout << "  虚函数: " << virtual_ms << " ms\n";
+    std::cout << "  函数指针表: " << stream_ms << " ms (" << virtual_ms / stream_ms << "x)\n";
+    std::cout << "  剖析+热点快速路径: " << profiled_ms << " ms (" << virtual_ms / profiled_ms << "x)"
+              << ", 热点策略下标 " << profiled.hot_index() << "\n";
+    if (r1 != r2 || r1 != r3) std::cout << "结果不一致!\n";
+
+    // 分布变化后，回退路径的未命中计数触发重新剖析
+    auto shifted = make_commands(stream_size, 2, 90, gen);
+    profiled.run_stream(shifted);
+    profiled.run_stream(shifted);
+    std::cout << "  热点切换后: 重新剖析 " << profiled.reprofile_count()
+              << " 次, 新热点下标 " << profiled.hot_index() << "\n";
+
+    std::cout << "\n要点:\n";
+    std::cout << "- 策略在批内不变时，把分派提到循环外，循环体可以内联甚至向量化\n";
+    std::cout << "- variant与函数指针表都为每个策略生成一份单态化循环，区别只在选择方式\n";
+    std::cout << "- 逐元素必须分派时，剖析热点并加一次比较就能让大多数元素走内联路径\n";
+
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++11/14/17/20 模板策略模式深度解析\n";
     std::cout << "==================================\n";
     
@@ -594,6 +933,7 @@ int main() {
     demonstrate_performance_strategies();
     demonstrate_modern_strategy();
     benchmark_strategy_patterns();
+    demonstrate_static_dispatch();
     
     return 0;
 }
@@ -612,9 +952,10 @@ g++ -std=c++20 -O2 -Wall 08_strategy_patterns.cpp -o strategy_patterns
 3. SFINAE和Concepts可以实现策略的自动推导和约束
 4. 零开销抽象是现代C++策略模式的核心优势
 5. Lambda和函数对象提供了灵活的现代策略实现
+6. 运行期选择的策略可以每批只分派一次，批内执行单态化循环；逐元素分派时可剖析热点加快速路径
 
 注意事项:
-- 模板策略在编译期确定，无法运行时动态切换
+- 模板策略在编译期确定，无法运行时动态切换；需要运行期切换时用variant或函数指针表按批分派
 - 策略组合可能导致模板实例膨胀
 - 需要在灵活性和性能之间找到平衡
 - 合理使用策略特化避免代码重复
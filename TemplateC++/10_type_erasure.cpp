@@ -7,6 +7,9 @@
  * 3. 任意类型容器设计 - std::any与自定义实现
  * 4. 接口类型擦除模式 - 运行时多态的现代替代
  * 5. 性能优化技术 - 小对象优化与内存管理
+ * 6. 小缓冲区优化的函数包装器 - 函数指针表、只移动版本与function_ref
+ * 7. 可配置缓冲区的Any - 静态地址类型标识与按类型分段的容器
+ * 8. 连续存储的多态容器 - poly_vector与按类型分组
  */
 
 #include <iostream>
@@ -19,6 +22,12 @@
 #include <any>
 #include <chrono>
 #include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <cmath>
+#include <utility>
 
 // ===== 1. 类型擦除基础原理演示 =====
 void demonstrate_type_erasure_basics() {
@@ -727,6 +736,1115 @@ void demonstrate_performance_optimization() {
     std::cout << "\n";
 }
 
+// ===== 6. 小缓冲区优化的函数包装器 =====
+// 第2节的MyFunction每次构造都new一个CallableModel，拷贝走虚函数clone()，调用走虚函数call()
+// 这里改成：
+// 1. 内联缓冲区（默认48字节）放得下的可调用对象不分配堆内存
+// 2. 用函数指针表代替多态基类（与OptimizedAny::VTable同样的做法），调用指针直接存在对象里
+// 3. Copyable = false时得到类似std::move_only_function的只移动版本，可以保存unique_ptr等
+// 4. function_ref只保存对象地址和一个调用指针，不拥有、不分配，适合作为参数传递
+namespace fast_function {
+
+template<typename Signature, std::size_t InlineSize, bool Copyable>
+class BasicFunction;
+
+template<typename R, typename... Args, std::size_t InlineSize, bool Copyable>
+class BasicFunction<R(Args...), InlineSize, Copyable> {
+private:
+    static constexpr std::size_t kBufferSize = InlineSize < sizeof(void*) ? sizeof(void*) : InlineSize;
+    
+    // 对象生命周期操作；调用指针单独放在对象里，少一次间接寻址
+    struct Ops {
+        void (*relocate)(void* dst, void* src) noexcept;  // 移动到dst并析构src
+        void (*copy)(void* dst, const void* src);          // 只移动版本为nullptr
+        void (*destroy)(void* self) noexcept;
+        const std::type_info& (*type)() noexcept;
+    };
+    
+    template<typename F>
+    static constexpr bool stored_inline = sizeof(F) <= kBufferSize && alignof(F) <= alignof(std::max_align_t) &&
+                                          std::is_nothrow_move_constructible_v<F>;
+    
+    // 内联存储时缓冲区里就是F；否则缓冲区里是指向堆上F的指针
+    template<typename F>
+    static F* target_of(void* storage) noexcept {
+        if constexpr (stored_inline<F>) {
+            return std::launder(static_cast<F*>(storage));
+        } else {
+            return *static_cast<F**>(storage);
+        }
+    }
+    
+    template<typename F>
+    static R invoke_impl(void* storage, Args&&... args) {
+        if constexpr (std::is_void_v<R>) {
+            (*target_of<F>(storage))(std::forward<Args>(args)...);
+        } else {
+            return (*target_of<F>(storage))(std::forward<Args>(args)...);
+        }
+    }
+    
+    template<typename F>
+    static void copy_impl(void* dst, const void* src) {
+        if constexpr (Copyable) {
+            const F& from = *target_of<F>(const_cast<void*>(src));
+            if constexpr (stored_inline<F>) {
+                ::new (dst) F(from);
+            } else {
+                *static_cast<F**>(dst) = new F(from);
+            }
+        } else {
+            (void)dst;
+            (void)src;
+        }
+    }
+    
+    template<typename F>
+    static const Ops* ops_for() {
+        static const Ops ops = {
+            [](void* dst, void* src) noexcept {
+                if constexpr (stored_inline<F>) {
+                    F* from = target_of<F>(src);
+                    ::new (dst) F(std::move(*from));
+                    from->~F();
+                } else {
+                    *static_cast<F**>(dst) = *static_cast<F**>(src);
+                }
+            },
+            Copyable ? &copy_impl<F> : nullptr,
+            [](void* self) noexcept {
+                if constexpr (stored_inline<F>) {
+                    target_of<F>(self)->~F();
+                } else {
+                    delete target_of<F>(self);
+                }
+            },
+            []() noexcept -> const std::type_info& { return typeid(F); },
+        };
+        return &ops;
+    }
+    
+    R (*invoke_)(void*, Args&&...) = nullptr;
+    const Ops* ops_ = nullptr;
+    alignas(std::max_align_t) mutable unsigned char storage_[kBufferSize];
+    
+    // 只移动版本把拷贝操作的参数换成一个构造不出来的占位类型：它们不再是拷贝构造/拷贝赋值，
+    // 又因为声明了移动操作，隐式的拷贝操作被删除，is_copy_constructible_v等特征如实返回false
+    struct CopyDisabled {
+        explicit CopyDisabled(int) = delete;
+    };
+    using CopySource = std::conditional_t<Copyable, BasicFunction, CopyDisabled>;
+    
+    void move_from(BasicFunction& other) noexcept {
+        if (other.ops_) {
+            other.ops_->relocate(storage_, other.storage_);
+            invoke_ = other.invoke_;
+            ops_ = other.ops_;
+            other.invoke_ = nullptr;
+            other.ops_ = nullptr;
+        }
+    }
+    
+public:
+    BasicFunction() noexcept = default;
+    BasicFunction(std::nullptr_t) noexcept {}
+    
+    template<typename F, typename D = std::decay_t<F>,
+             typename = std::enable_if_t<!std::is_same_v<D, BasicFunction> && std::is_invocable_r_v<R, D&, Args...>>>
+    BasicFunction(F&& f) {
+        static_assert(!Copyable || std::is_copy_constructible_v<D>, "可拷贝版本要求可调用对象可拷贝");
+        if constexpr (std::is_pointer_v<D> || std::is_member_pointer_v<D>) {
+            if (f == nullptr) return;
+        }
+        if constexpr (stored_inline<D>) {
+            ::new (static_cast<void*>(storage_)) D(std::forward<F>(f));
+        } else {
+            *reinterpret_cast<D**>(storage_) = new D(std::forward<F>(f));
+        }
+        invoke_ = &invoke_impl<D>;
+        ops_ = ops_for<D>();
+    }
+    
+    BasicFunction(const CopySource& other) {
+        if (other.ops_) {
+            other.ops_->copy(storage_, other.storage_);
+            invoke_ = other.invoke_;
+            ops_ = other.ops_;
+        }
+    }
+    
+    BasicFunction(BasicFunction&& other) noexcept { move_from(other); }
+    
+    BasicFunction& operator=(const CopySource& other) {
+        if (this != &other) {
+            BasicFunction copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+    
+    BasicFunction& operator=(BasicFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+    
+    ~BasicFunction() { reset(); }
+    
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            invoke_ = nullptr;
+            ops_ = nullptr;
+        }
+    }
+    
+    R operator()(Args... args) const {
+        if (!invoke_) throw std::bad_function_call();
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+    
+    explicit operator bool() const noexcept { return invoke_ != nullptr; }
+    
+    const std::type_info& target_type() const noexcept { return ops_ ? ops_->type() : typeid(void); }
+    
+    // 编译期查询：某类型的可调用对象是否会内联存储
+    template<typename F>
+    static constexpr bool fits_inline() { return stored_inline<std::decay_t<F>>; }
+};
+
+template<typename Signature, std::size_t InlineSize = 48>
+using Function = BasicFunction<Signature, InlineSize, true>;
+
+template<typename Signature, std::size_t InlineSize = 48>
+using MoveOnlyFunction = BasicFunction<Signature, InlineSize, false>;
+
+// 非拥有的函数引用：被引用的可调用对象必须比function_ref活得久
+template<typename Signature>
+class function_ref;
+
+template<typename R, typename... Args>
+class function_ref<R(Args...)> {
+private:
+    void* object_ = nullptr;
+    R (*invoke_)(void*, Args&&...) = nullptr;
+    
+public:
+    template<typename F, typename D = std::remove_reference_t<F>,
+             typename = std::enable_if_t<!std::is_same_v<std::remove_cv_t<D>, function_ref> &&
+                                         std::is_invocable_r_v<R, D&, Args...>>>
+    function_ref(F&& f) noexcept {
+        if constexpr (std::is_function_v<D>) {
+            object_ = reinterpret_cast<void*>(&f);
+            invoke_ = [](void* obj, Args&&... args) -> R {
+                return (*reinterpret_cast<D*>(obj))(std::forward<Args>(args)...);
+            };
+        } else {
+            object_ = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+            invoke_ = [](void* obj, Args&&... args) -> R {
+                return (*static_cast<D*>(obj))(std::forward<Args>(args)...);
+            };
+        }
+    }
+    
+    R operator()(Args... args) const { return invoke_(object_, std::forward<Args>(args)...); }
+};
+
+}  // namespace fast_function
+
+// 统计全局operator new调用次数，用来展示各包装器的分配行为
+namespace alloc_stats {
+inline std::size_t& count() {
+    static std::size_t n = 0;
+    return n;
+}
+}  // namespace alloc_stats
+
+void* operator new(std::size_t size) {
+    ++alloc_stats::count();
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++alloc_stats::count();
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace function_bench {
+
+// 第2节MyFunction的同构实现（虚函数 + 堆分配 + clone），放在命名空间作用域用于对比
+template<typename Signature>
+class LegacyFunction;
+
+template<typename R, typename... Args>
+class LegacyFunction<R(Args...)> {
+private:
+    struct CallableBase {
+        virtual ~CallableBase() = default;
+        virtual R call(Args... args) = 0;
+        virtual std::unique_ptr<CallableBase> clone() const = 0;
+    };
+    
+    template<typename F>
+    struct CallableModel : CallableBase {
+        F f;
+        explicit CallableModel(F fn) : f(std::move(fn)) {}
+        R call(Args... args) override { return f(std::forward<Args>(args)...); }
+        std::unique_ptr<CallableBase> clone() const override { return std::make_unique<CallableModel>(f); }
+    };
+    
+    std::unique_ptr<CallableBase> callable_;
+    
+public:
+    template<typename F>
+    LegacyFunction(F f) : callable_(std::make_unique<CallableModel<F>>(std::move(f))) {}
+    LegacyFunction(const LegacyFunction& other) : callable_(other.callable_ ? other.callable_->clone() : nullptr) {}
+    
+    R operator()(Args... args) const { return callable_->call(std::forward<Args>(args)...); }
+    explicit operator bool() const { return callable_ != nullptr; }
+};
+
+// 调用基准：回调表里每个回调都调用一次，非内联保证比较的是真实的间接调用
+// 让构造出的对象逃逸，避免编译器把整个构造/析构消除
+[[gnu::noinline]] inline long long observe(const void* p) { return p != nullptr; }
+
+template<typename Fn>
+[[gnu::noinline]] long long invoke_all(const std::vector<Fn>& callbacks, int rounds) {
+    long long sum = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto& cb : callbacks) sum += cb(r);
+    }
+    return sum;
+}
+
+[[gnu::noinline]] long long invoke_ref(fast_function::function_ref<long long(int)> cb, int calls) {
+    long long sum = 0;
+    for (int i = 0; i < calls; ++i) sum += cb(i);
+    return sum;
+}
+
+[[gnu::noinline]] long long invoke_std_ref(const std::function<long long(int)>& cb, int calls) {
+    long long sum = 0;
+    for (int i = 0; i < calls; ++i) sum += cb(i);
+    return sum;
+}
+
+}  // namespace function_bench
+
+void demonstrate_small_buffer_function() {
+    std::cout << "=== 小缓冲区优化函数包装器演示 ===\n";
+    using namespace fast_function;
+    
+    // 捕获3个指针(24字节)：超出libstdc++ std::function的16字节内联区，但在48字节缓冲区内
+    long long a = 1, b = 2, c = 3;
+    auto small = [pa = &a, pb = &b, pc = &c](int x) -> long long { return x + *pa + *pb + *pc; };
+    // 捕获64字节数组：两者都要堆分配
+    struct Big {
+        long long table[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+        long long operator()(int x) const { return table[x & 7]; }
+    };
+    
+    std::cout << "sizeof: std::function " << sizeof(std::function<long long(int)>) << "，Function<48> "
+              << sizeof(Function<long long(int)>) << "，function_ref " << sizeof(function_ref<long long(int)>)
+              << "\n";
+    std::cout << "24字节lambda内联存储: " << (Function<long long(int)>::fits_inline<decltype(small)>() ? "是" : "否")
+              << "，64字节对象内联存储: " << (Function<long long(int)>::fits_inline<Big>() ? "是" : "否") << "\n";
+    
+    // 只移动版本可以直接持有unique_ptr
+    auto owned = std::make_unique<int>(42);
+    MoveOnlyFunction<int()> take = [p = std::move(owned)] { return *p; };
+    MoveOnlyFunction<int()> moved = std::move(take);
+    static_assert(!std::is_copy_constructible_v<MoveOnlyFunction<int()>> && !std::is_copy_assignable_v<MoveOnlyFunction<int()>>,
+                  "只移动版本的拷贝操作不存在");
+    static_assert(std::is_copy_constructible_v<fast_function::Function<int()>>, "可拷贝版本保留拷贝操作");
+    std::cout << "MoveOnlyFunction持有unique_ptr: " << moved() << "，移动后原对象为空: " << (!take ? "是" : "否") << "\n";
+    
+    // 构造开销：构造 + 析构，统计堆分配次数
+    const int n = 1'000'000;
+    auto construct = [&](const char* name, auto make) {
+        std::size_t before = alloc_stats::count();
+        auto start = std::chrono::high_resolution_clock::now();
+        long long sink = 0;
+        for (int i = 0; i < n; ++i) {
+            auto f = make();
+            sink += function_bench::observe(&f);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / n;
+        std::cout << "  " << name << ": " << ns << " ns/次，堆分配 "
+                  << (alloc_stats::count() - before) / static_cast<double>(n) << " 次/个"
+                  << (sink == n ? "" : "!") << "\n";
+    };
+    std::cout << "\n构造+析构(24字节捕获):\n";
+    construct("std::function       ", [&] { return std::function<long long(int)>(small); });
+    construct("MyFunction(虚函数)  ", [&] { return function_bench::LegacyFunction<long long(int)>(small); });
+    construct("Function<48>        ", [&] { return Function<long long(int)>(small); });
+    std::cout << "构造+析构(64字节对象):\n";
+    construct("std::function       ", [&] { return std::function<long long(int)>(Big{}); });
+    construct("Function<48>        ", [&] { return Function<long long(int)>(Big{}); });
+    construct("Function<64>        ", [&] { return Function<long long(int), 64>(Big{}); });
+    
+    // 调用开销：1000个回调 x 1000轮
+    const int callbacks = 1000, rounds = 1000;
+    std::vector<std::function<long long(int)>> std_cbs(callbacks, small);
+    std::vector<function_bench::LegacyFunction<long long(int)>> legacy_cbs(callbacks, small);
+    std::vector<Function<long long(int)>> fast_cbs(callbacks, small);
+    auto time_calls = [&](const char* name, auto&& fn) {
+        double best = 1e300;
+        long long sum = 0;
+        for (int rep = 0; rep < 5; ++rep) {
+            auto start = std::chrono::high_resolution_clock::now();
+            sum = fn();
+            best = std::min(best, std::chrono::duration<double, std::nano>(
+                                      std::chrono::high_resolution_clock::now() - start).count());
+        }
+        double ns = best / (static_cast<double>(callbacks) * rounds);
+        std::cout << "  " << name << ": " << ns << " ns/次 (sum=" << sum << ")\n";
+    };
+    std::cout << "\n调用(" << callbacks << "个回调 x " << rounds << "轮):\n";
+    time_calls("std::function       ", [&] { return function_bench::invoke_all(std_cbs, rounds); });
+    time_calls("MyFunction(虚函数)  ", [&] { return function_bench::invoke_all(legacy_cbs, rounds); });
+    time_calls("Function<48>        ", [&] { return function_bench::invoke_all(fast_cbs, rounds); });
+    time_calls("const std::function&", [&] { return function_bench::invoke_std_ref(std_cbs[0], callbacks * rounds); });
+    time_calls("function_ref        ", [&] { return function_bench::invoke_ref(small, callbacks * rounds); });
+    
+    std::cout << "\n要点:\n";
+    std::cout << "- 内联存储省掉每次构造的malloc/free，回调表里的对象也更紧凑\n";
+    std::cout << "- 调用都是一次间接调用，与虚函数版本相当；Function把调用指针放在对象里，不经过vtable\n";
+    std::cout << "- 超出内联容量时仍会堆分配，可按实际捕获大小调整InlineSize\n";
+    std::cout << "- 只作参数、不需保存的回调用function_ref，既不分配也不拷贝\n";
+    
+    std::cout << "\n";
+}
+
+// ===== 7. 可配置缓冲区的Any与按类型分段的容器 =====
+// 第5节OptimizedAny的改进版，放在命名空间作用域：
+// 1. 内联容量InlineSize是模板参数，超出时才堆分配，大对象拷贝也完整实现
+// 2. 类型标识用每个类型一个静态变量的地址，any_cast只比较一次指针，不比较type_info
+// 3. TypedRunContainer把连续插入的同类型值放在同一段连续内存里，遍历时每段只做一次类型判断
+namespace fast_any {
+
+// 每个类型一个静态对象，其地址就是类型标识
+// 注意：跨动态库时同一类型可能有多个实例，与未合并的type_info存在同样的问题
+using type_id_t = const void*;
+
+template<typename T>
+struct type_tag {
+    static constexpr char id = 0;
+};
+
+template<typename T>
+constexpr type_id_t type_id() noexcept {
+    return &type_tag<std::remove_cv_t<T>>::id;
+}
+
+template<std::size_t InlineSize = 32>
+class FastAny {
+private:
+    struct VTable {
+        type_id_t id;
+        const std::type_info& (*type)() noexcept;
+        void (*destroy)(void* storage) noexcept;
+        void (*copy)(void* dst, const void* src);
+        void (*move)(void* dst, void* src) noexcept;   // 移动到dst并析构src
+    };
+    
+    template<typename T>
+    static constexpr bool is_small() {
+        return sizeof(T) <= InlineSize && alignof(T) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<T>;
+    }
+    
+    // 内联对象直接放在缓冲区；大对象在缓冲区里只存一个指针
+    template<typename T>
+    static T* object_in(void* storage) noexcept {
+        if constexpr (is_small<T>()) {
+            return std::launder(static_cast<T*>(storage));
+        } else {
+            return *static_cast<T**>(storage);
+        }
+    }
+    
+    template<typename T>
+    static const VTable* vtable_for() noexcept {
+        static const VTable vtable = {
+            type_id<T>(),
+            []() noexcept -> const std::type_info& { return typeid(T); },
+            [](void* storage) noexcept {
+                if constexpr (is_small<T>()) {
+                    object_in<T>(storage)->~T();
+                } else {
+                    delete object_in<T>(storage);
+                }
+            },
+            [](void* dst, const void* src) {
+                const T& from = *object_in<T>(const_cast<void*>(src));
+                if constexpr (is_small<T>()) {
+                    ::new (dst) T(from);
+                } else {
+                    *static_cast<T**>(dst) = new T(from);
+                }
+            },
+            [](void* dst, void* src) noexcept {
+                if constexpr (is_small<T>()) {
+                    T* from = object_in<T>(src);
+                    ::new (dst) T(std::move(*from));
+                    from->~T();
+                } else {
+                    *static_cast<T**>(dst) = *static_cast<T**>(src);
+                }
+            },
+        };
+        return &vtable;
+    }
+    
+    const VTable* vtable_ = nullptr;
+    alignas(std::max_align_t) unsigned char storage_[InlineSize < sizeof(void*) ? sizeof(void*) : InlineSize];
+    
+public:
+    FastAny() noexcept = default;
+    
+    template<typename T, typename D = std::decay_t<T>,
+             typename = std::enable_if_t<!std::is_same_v<D, FastAny> && std::is_copy_constructible_v<D>>>
+    FastAny(T&& value) {
+        if constexpr (is_small<D>()) {
+            ::new (static_cast<void*>(storage_)) D(std::forward<T>(value));
+        } else {
+            *reinterpret_cast<D**>(storage_) = new D(std::forward<T>(value));
+        }
+        vtable_ = vtable_for<D>();
+    }
+    
+    FastAny(const FastAny& other) {
+        if (other.vtable_) {
+            other.vtable_->copy(storage_, other.storage_);
+            vtable_ = other.vtable_;
+        }
+    }
+    
+    FastAny(FastAny&& other) noexcept {
+        if (other.vtable_) {
+            other.vtable_->move(storage_, other.storage_);
+            vtable_ = other.vtable_;
+            other.vtable_ = nullptr;
+        }
+    }
+    
+    FastAny& operator=(const FastAny& other) {
+        if (this != &other) *this = FastAny(other);
+        return *this;
+    }
+    
+    FastAny& operator=(FastAny&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.vtable_) {
+                other.vtable_->move(storage_, other.storage_);
+                vtable_ = other.vtable_;
+                other.vtable_ = nullptr;
+            }
+        }
+        return *this;
+    }
+    
+    ~FastAny() { reset(); }
+    
+    void reset() noexcept {
+        if (vtable_) {
+            vtable_->destroy(storage_);
+            vtable_ = nullptr;
+        }
+    }
+    
+    bool has_value() const noexcept { return vtable_ != nullptr; }
+    type_id_t id() const noexcept { return vtable_ ? vtable_->id : type_id<void>(); }
+    const std::type_info& type() const noexcept { return vtable_ ? vtable_->type() : typeid(void); }
+    
+    template<typename T>
+    static constexpr bool stores_inline() { return is_small<std::decay_t<T>>(); }
+    
+    // 每个类型的vtable本身也是唯一的静态对象：一次指针比较就能判断类型，空对象自然不匹配
+    template<typename T>
+    T* try_cast() noexcept {
+        return vtable_ == vtable_for<T>() ? object_in<T>(storage_) : nullptr;
+    }
+    
+    template<typename T>
+    const T* try_cast() const noexcept {
+        return vtable_ == vtable_for<T>() ? object_in<T>(const_cast<unsigned char*>(storage_)) : nullptr;
+    }
+    
+    template<typename T>
+    T& any_cast() {
+        if (T* p = try_cast<T>()) return *p;
+        throw std::bad_any_cast();
+    }
+};
+
+// 按插入顺序保存若干"段"，每段是一个std::vector<T>；与上一段类型相同的值追加到同一段
+class TypedRunContainer {
+private:
+    struct RunOps {
+        type_id_t id;
+        void (*destroy)(void* run) noexcept;
+        std::size_t (*size)(const void* run) noexcept;
+    };
+    
+    template<typename T>
+    static const RunOps* ops_for() noexcept {
+        static const RunOps ops = {
+            type_id<T>(),
+            [](void* run) noexcept { delete static_cast<std::vector<T>*>(run); },
+            [](const void* run) noexcept { return static_cast<const std::vector<T>*>(run)->size(); },
+        };
+        return &ops;
+    }
+    
+    struct Run {
+        const RunOps* ops;
+        void* elements;
+    };
+    
+    static constexpr std::size_t kInitialRunCapacity = 64;
+    
+    std::vector<Run> runs_;
+    std::size_t size_ = 0;
+    
+    template<typename T, typename F>
+    static bool visit_run(const Run& run, F& f) {
+        if (run.ops->id != type_id<T>()) return false;
+        for (const T& value : *static_cast<const std::vector<T>*>(run.elements)) f(value);
+        return true;
+    }
+    
+public:
+    TypedRunContainer() = default;
+    TypedRunContainer(const TypedRunContainer&) = delete;
+    TypedRunContainer& operator=(const TypedRunContainer&) = delete;
+    
+    ~TypedRunContainer() {
+        for (auto& run : runs_) run.ops->destroy(run.elements);
+    }
+    
+    template<typename T>
+    void push_back(T&& value) {
+        using D = std::decay_t<T>;
+        if (runs_.empty() || runs_.back().ops->id != type_id<D>()) {
+            auto elements = std::make_unique<std::vector<D>>();
+            elements->reserve(kInitialRunCapacity);
+            runs_.push_back(Run{ops_for<D>(), elements.get()});
+            elements.release();
+        }
+        static_cast<std::vector<D>*>(runs_.back().elements)->push_back(std::forward<T>(value));
+        ++size_;
+    }
+    
+    // 只访问类型为T的元素，每段只比较一次类型
+    template<typename T, typename F>
+    void for_each(F f) const {
+        for (const auto& run : runs_) visit_run<T>(run, f);
+    }
+    
+    // 按插入顺序访问Ts中列出的类型，其余类型跳过
+    template<typename... Ts, typename F>
+    void visit(F f) const {
+        for (const auto& run : runs_) {
+            (visit_run<Ts>(run, f) || ...);
+        }
+    }
+    
+    std::size_t size() const noexcept { return size_; }
+    std::size_t run_count() const noexcept { return runs_.size(); }
+};
+
+}  // namespace fast_any
+
+namespace any_bench {
+
+// 第3节MyAny的同构实现（虚函数 + 每个值一次堆分配 + type_info比较），去掉了打印
+class LegacyAny {
+private:
+    struct StorageBase {
+        virtual ~StorageBase() = default;
+        virtual std::unique_ptr<StorageBase> clone() const = 0;
+        virtual const std::type_info& type() const = 0;
+        virtual const void* get_ptr() const = 0;
+    };
+    
+    template<typename T>
+    struct StorageImpl : StorageBase {
+        T value;
+        template<typename U>
+        StorageImpl(U&& v) : value(std::forward<U>(v)) {}
+        std::unique_ptr<StorageBase> clone() const override { return std::make_unique<StorageImpl<T>>(value); }
+        const std::type_info& type() const override { return typeid(T); }
+        const void* get_ptr() const override { return &value; }
+    };
+    
+    std::unique_ptr<StorageBase> storage_;
+    
+public:
+    template<typename T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, LegacyAny>>>
+    LegacyAny(T&& value) : storage_(std::make_unique<StorageImpl<std::decay_t<T>>>(std::forward<T>(value))) {}
+    LegacyAny(LegacyAny&&) = default;
+    
+    template<typename T>
+    const T* try_cast() const {
+        return storage_ && storage_->type() == typeid(T) ? static_cast<const T*>(storage_->get_ptr()) : nullptr;
+    }
+};
+
+// 每64个值换一种类型：int、double、偶尔一个string
+template<typename Push>
+void fill_mixed(std::size_t n, Push push) {
+    for (std::size_t i = 0; i < n; ++i) {
+        switch ((i / 64) % 5) {
+            case 0:
+            case 2:
+                push(static_cast<int>(i));
+                break;
+            case 1:
+            case 3:
+                push(static_cast<double>(i) * 0.5);
+                break;
+            default:
+                push(std::string("value"));
+                break;
+        }
+    }
+}
+
+template<typename Container>
+[[gnu::noinline]] double sum_numbers(const Container& values) {
+    double sum = 0;
+    for (const auto& value : values) {
+        if (auto p = value.template try_cast<int>()) {
+            sum += *p;
+        } else if (auto d = value.template try_cast<double>()) {
+            sum += *d;
+        }
+    }
+    return sum;
+}
+
+[[gnu::noinline]] double sum_numbers(const std::vector<std::any>& values) {
+    double sum = 0;
+    for (const auto& value : values) {
+        if (auto p = std::any_cast<int>(&value)) {
+            sum += *p;
+        } else if (auto d = std::any_cast<double>(&value)) {
+            sum += *d;
+        }
+    }
+    return sum;
+}
+
+[[gnu::noinline]] double sum_numbers(const fast_any::TypedRunContainer& values) {
+    double sum = 0;
+    values.visit<int, double>([&](const auto& v) { sum += v; });
+    return sum;
+}
+
+}  // namespace any_bench
+
+void demonstrate_fast_any() {
+    std::cout << "=== 可配置缓冲区Any与分段容器演示 ===\n";
+    using namespace fast_any;
+    
+    std::cout << "sizeof: std::any " << sizeof(std::any) << "，FastAny<16> " << sizeof(FastAny<16>)
+              << "，FastAny<32> " << sizeof(FastAny<32>) << "，FastAny<64> " << sizeof(FastAny<64>) << "\n";
+    std::cout << "std::string内联存储: FastAny<16> " << (FastAny<16>::stores_inline<std::string>() ? "是" : "否")
+              << "，FastAny<32> " << (FastAny<32>::stores_inline<std::string>() ? "是" : "否") << "\n";
+    
+    FastAny<> text = std::string("interned type id");
+    FastAny<> copy = text;
+    std::cout << "拷贝后的值: " << copy.any_cast<std::string>() << "，类型标识相同: "
+              << (copy.id() == type_id<std::string>() ? "是" : "否") << "\n";
+    try {
+        copy.any_cast<int>();
+    } catch (const std::bad_any_cast&) {
+        std::cout << "错误类型转换抛出std::bad_any_cast\n";
+    }
+    
+    // 大对象走堆，拷贝也要完整复制
+    struct LargeObject {
+        char data[128];
+        int value;
+    };
+    FastAny<32> large = LargeObject{{}, 7};
+    FastAny<32> large_copy = large;
+    std::cout << "大对象拷贝: " << large_copy.any_cast<LargeObject>().value << "\n";
+    
+    const std::size_t n = 1'000'000;
+    std::vector<std::any> std_values;
+    std::vector<any_bench::LegacyAny> legacy_values;
+    std::vector<FastAny<>> fast_values;
+    TypedRunContainer runs;
+    std_values.reserve(n);
+    legacy_values.reserve(n);
+    fast_values.reserve(n);
+    
+    auto timed_fill = [&](const char* name, auto push) {
+        std::size_t before = alloc_stats::count();
+        auto start = std::chrono::high_resolution_clock::now();
+        any_bench::fill_mixed(n, push);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "  " << name << ": " << ms << " ms，堆分配 " << alloc_stats::count() - before << " 次\n";
+    };
+    std::cout << "\n插入" << n << "个值(int/double/string混合，每64个换一种类型):\n";
+    timed_fill("std::vector<std::any>   ", [&](auto v) { std_values.emplace_back(std::move(v)); });
+    timed_fill("std::vector<MyAny>      ", [&](auto v) { legacy_values.emplace_back(std::move(v)); });
+    timed_fill("std::vector<FastAny<32>>", [&](auto v) { fast_values.emplace_back(std::move(v)); });
+    timed_fill("TypedRunContainer       ", [&](auto v) { runs.push_back(std::move(v)); });
+    std::cout << "  TypedRunContainer段数: " << runs.run_count() << "\n";
+    
+    auto timed_sum = [&](const char* name, auto&& sum) {
+        double best = 1e300, result = 0;
+        for (int rep = 0; rep < 5; ++rep) {
+            auto start = std::chrono::high_resolution_clock::now();
+            result = sum();
+            best = std::min(best, std::chrono::duration<double, std::milli>(
+                                      std::chrono::high_resolution_clock::now() - start).count());
+        }
+        std::cout << "  " << name << ": " << best << " ms (sum=" << result << ")\n";
+    };
+    std::cout << "\n累加所有int和double (两次类型判断):\n";
+    timed_sum("std::any                ", [&] { return any_bench::sum_numbers(std_values); });
+    timed_sum("MyAny(type_info比较)    ", [&] { return any_bench::sum_numbers(legacy_values); });
+    timed_sum("FastAny<32>(指针比较)   ", [&] { return any_bench::sum_numbers(fast_values); });
+    timed_sum("TypedRunContainer       ", [&] { return any_bench::sum_numbers(runs); });
+    
+    std::cout << "\n要点:\n";
+    std::cout << "- type_info比较在类型不匹配时可能退化为字符串比较，静态地址比较始终只是一条指令\n";
+    std::cout << "- 按类型分段后，类型判断从每个元素一次变成每段一次，内层循环是普通的连续数组遍历\n";
+    std::cout << "- TypedRunContainer只能按类型访问，不支持按下标随机访问单个元素\n";
+    
+    std::cout << "\n";
+}
+
+// ===== 8. 连续存储的多态容器 =====
+// 第4节的DrawableTypeErased每个形状单独堆分配，遍历混合集合时在内存中来回跳转
+// poly_vector<Concept, Model>把不同大小的Model<T>按各自的对齐要求紧密排列在同一块缓冲区里：
+// 1. 每个元素就是一个带虚表指针的Model<T>对象，遍历时直接做虚函数调用
+// 2. 另存一张槽位表(偏移 + 生命周期操作)，缓冲区扩容时逐个移动元素
+// 3. group_by_type()按动态类型稳定重排，同类型的虚函数调用连成一批，分支预测几乎总是命中
+namespace poly {
+
+template<typename Concept, template<typename> class Model>
+class poly_vector {
+private:
+    // 每个具体类型一份：扩容/重排时移动元素，析构时销毁元素
+    struct Ops {
+        void (*relocate)(void* dst, void* src) noexcept;
+        void (*destroy)(void* model) noexcept;
+        std::size_t size;
+        std::size_t align;
+    };
+    
+    template<typename M>
+    static const Ops* ops_for() noexcept {
+        static const Ops ops = {
+            [](void* dst, void* src) noexcept {
+                M* from = std::launder(static_cast<M*>(src));
+                ::new (dst) M(std::move(*from));
+                from->~M();
+            },
+            [](void* model) noexcept { std::launder(static_cast<M*>(model))->~M(); },
+            sizeof(M),
+            alignof(M),
+        };
+        return &ops;
+    }
+    
+    struct Slot {
+        std::size_t offset;          // Model<T>在缓冲区中的偏移
+        std::ptrdiff_t base_delta;   // Concept子对象相对Model<T>的偏移，同一类型恒定
+        const Ops* ops;
+    };
+    
+    unsigned char* buffer_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t used_ = 0;
+    std::vector<Slot> slots_;
+    
+    static std::size_t align_up(std::size_t n, std::size_t align) { return (n + align - 1) / align * align; }
+    
+    Concept* concept_at(const Slot& slot) const noexcept {
+        return std::launder(reinterpret_cast<Concept*>(buffer_ + slot.offset + slot.base_delta));
+    }
+    
+    static unsigned char* allocate_buffer(std::size_t bytes) {
+        return static_cast<unsigned char*>(::operator new(bytes));
+    }
+    
+    // 新缓冲区同样按max_align_t对齐，原偏移仍然满足每个元素的对齐要求
+    void grow(std::size_t required) {
+        std::size_t new_capacity = std::max({required, capacity_ * 2, std::size_t(256)});
+        unsigned char* fresh = allocate_buffer(new_capacity);
+        for (const auto& slot : slots_) {
+            slot.ops->relocate(fresh + slot.offset, buffer_ + slot.offset);
+        }
+        ::operator delete(buffer_);
+        buffer_ = fresh;
+        capacity_ = new_capacity;
+    }
+    
+public:
+    class iterator {
+    private:
+        const poly_vector* owner_;
+        typename std::vector<Slot>::const_iterator it_;
+        
+    public:
+        iterator(const poly_vector* owner, typename std::vector<Slot>::const_iterator it) : owner_(owner), it_(it) {}
+        Concept& operator*() const { return *owner_->concept_at(*it_); }
+        Concept* operator->() const { return owner_->concept_at(*it_); }
+        iterator& operator++() {
+            ++it_;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return it_ == other.it_; }
+        bool operator!=(const iterator& other) const { return it_ != other.it_; }
+    };
+    
+    poly_vector() = default;
+    poly_vector(const poly_vector&) = delete;
+    poly_vector& operator=(const poly_vector&) = delete;
+    
+    poly_vector(poly_vector&& other) noexcept
+        : buffer_(std::exchange(other.buffer_, nullptr)), capacity_(std::exchange(other.capacity_, 0)),
+          used_(std::exchange(other.used_, 0)), slots_(std::move(other.slots_)) {}
+    
+    ~poly_vector() {
+        clear();
+        ::operator delete(buffer_);
+    }
+    
+    template<typename T, typename... Args>
+    Concept& emplace_back(Args&&... args) {
+        using M = Model<T>;
+        static_assert(std::is_base_of_v<Concept, M>, "Model<T>必须派生自Concept");
+        static_assert(alignof(M) <= alignof(std::max_align_t), "不支持超对齐类型");
+        static_assert(std::is_nothrow_move_constructible_v<M>, "扩容时需要无异常移动");
+        
+        std::size_t offset = align_up(used_, alignof(M));
+        if (offset + sizeof(M) > capacity_) grow(offset + sizeof(M));
+        slots_.push_back(Slot{offset, 0, ops_for<M>()});
+        M* model;
+        try {
+            model = ::new (buffer_ + offset) M(std::forward<Args>(args)...);
+        } catch (...) {
+            slots_.pop_back();
+            throw;
+        }
+        Concept* base = model;
+        slots_.back().base_delta = reinterpret_cast<unsigned char*>(base) - reinterpret_cast<unsigned char*>(model);
+        used_ = offset + sizeof(M);
+        return *base;
+    }
+    
+    void reserve_bytes(std::size_t bytes) {
+        if (bytes > capacity_) grow(bytes);
+    }
+    
+    void clear() noexcept {
+        for (const auto& slot : slots_) slot.ops->destroy(buffer_ + slot.offset);
+        slots_.clear();
+        used_ = 0;
+    }
+    
+    // 按类型首次出现的顺序稳定重排，同类型元素变为连续的一段
+    void group_by_type() {
+        std::vector<const Ops*> kinds;
+        std::vector<std::size_t> rank(slots_.size());
+        for (std::size_t i = 0; i < slots_.size(); ++i) {
+            auto it = std::find(kinds.begin(), kinds.end(), slots_[i].ops);
+            rank[i] = static_cast<std::size_t>(it - kinds.begin());
+            if (it == kinds.end()) kinds.push_back(slots_[i].ops);
+        }
+        std::vector<std::size_t> order(slots_.size());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return rank[a] < rank[b]; });
+        
+        std::vector<Slot> grouped;
+        grouped.reserve(slots_.size());
+        std::size_t used = 0;
+        for (std::size_t index : order) {
+            const Slot& slot = slots_[index];
+            std::size_t offset = align_up(used, slot.ops->align);
+            grouped.push_back(Slot{offset, slot.base_delta, slot.ops});
+            used = offset + slot.ops->size;
+        }
+        unsigned char* fresh = allocate_buffer(std::max(used, std::size_t(1)));
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            const Slot& from = slots_[order[i]];
+            from.ops->relocate(fresh + grouped[i].offset, buffer_ + from.offset);
+        }
+        ::operator delete(buffer_);
+        buffer_ = fresh;
+        capacity_ = std::max(used, std::size_t(1));
+        used_ = used;
+        slots_ = std::move(grouped);
+    }
+    
+    template<typename F>
+    void for_each(F&& f) const {
+        for (const auto& slot : slots_) f(*concept_at(slot));
+    }
+    
+    Concept& operator[](std::size_t i) const { return *concept_at(slots_[i]); }
+    iterator begin() const { return iterator(this, slots_.begin()); }
+    iterator end() const { return iterator(this, slots_.end()); }
+    
+    std::size_t size() const noexcept { return slots_.size(); }
+    bool empty() const noexcept { return slots_.empty(); }
+    std::size_t bytes_used() const noexcept { return used_; }
+};
+
+// 形状接口与模型：与第4节的DrawableConcept/DrawableModel对应
+struct ShapeConcept {
+    virtual ~ShapeConcept() = default;
+    virtual double area() const = 0;
+    virtual void scale(double factor) = 0;
+    virtual const char* name() const = 0;
+};
+
+template<typename T>
+struct ShapeModel final : ShapeConcept {
+    T object;
+    
+    template<typename... Args>
+    explicit ShapeModel(Args&&... args) : object{std::forward<Args>(args)...} {}
+    
+    double area() const override { return object.area(); }
+    void scale(double factor) override { object.scale(factor); }
+    const char* name() const override { return T::kName; }
+};
+
+// 大小各不相同的三种形状
+struct Circle {
+    static constexpr const char* kName = "Circle";
+    double radius;
+    double area() const { return 3.14159 * radius * radius; }
+    void scale(double f) { radius *= f; }
+};
+
+struct Rectangle {
+    static constexpr const char* kName = "Rectangle";
+    double width, height;
+    double area() const { return width * height; }
+    void scale(double f) {
+        width *= f;
+        height *= f;
+    }
+};
+
+struct Triangle {
+    static constexpr const char* kName = "Triangle";
+    double x[3], y[3];
+    double area() const { return 0.5 * std::abs((x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0])); }
+    void scale(double f) {
+        for (int i = 0; i < 3; ++i) {
+            x[i] *= f;
+            y[i] *= f;
+        }
+    }
+};
+
+using ShapeVector = poly_vector<ShapeConcept, ShapeModel>;
+
+template<typename Range>
+[[gnu::noinline]] double total_area(const Range& shapes) {
+    double sum = 0;
+    for (const auto& shape : shapes) sum += shape->area();
+    return sum;
+}
+
+[[gnu::noinline]] inline double total_area(const ShapeVector& shapes) {
+    double sum = 0;
+    shapes.for_each([&](const ShapeConcept& shape) { sum += shape.area(); });
+    return sum;
+}
+
+}  // namespace poly
+
+void demonstrate_poly_vector() {
+    std::cout << "=== 连续存储的多态容器演示 ===\n";
+    using namespace poly;
+    
+    ShapeVector shapes;
+    shapes.emplace_back<Circle>(5.0);
+    shapes.emplace_back<Rectangle>(4.0, 6.0);
+    shapes.emplace_back<Triangle>(Triangle{{0, 3, 0}, {0, 0, 8}});
+    shapes.emplace_back<Circle>(1.0);
+    std::cout << "元素大小: Circle " << sizeof(ShapeModel<Circle>) << "，Rectangle " << sizeof(ShapeModel<Rectangle>)
+              << "，Triangle " << sizeof(ShapeModel<Triangle>) << "，共占用 " << shapes.bytes_used() << " 字节\n";
+    shapes.group_by_type();
+    std::cout << "按类型分组后:";
+    for (const auto& shape : shapes) std::cout << " " << shape.name() << "(" << shape.area() << ")";
+    std::cout << "\n";
+    
+    // 基准：随机混合的200万个形状，累加面积
+    const std::size_t n = 2'000'000;
+    std::mt19937 rng(42);
+    std::vector<int> kinds(n);
+    for (auto& kind : kinds) kind = static_cast<int>(rng() % 3);
+    
+    std::vector<std::unique_ptr<ShapeConcept>> heap_shapes;
+    ShapeVector packed;
+    heap_shapes.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        double v = 1.0 + static_cast<double>(i % 100) * 0.01;
+        switch (kinds[i]) {
+            case 0:
+                heap_shapes.push_back(std::make_unique<ShapeModel<Circle>>(v));
+                packed.emplace_back<Circle>(v);
+                break;
+            case 1:
+                heap_shapes.push_back(std::make_unique<ShapeModel<Rectangle>>(v, 2.0));
+                packed.emplace_back<Rectangle>(v, 2.0);
+                break;
+            default:
+                heap_shapes.push_back(std::make_unique<ShapeModel<Triangle>>(Triangle{{0, v, 0}, {0, 0, 2}}));
+                packed.emplace_back<Triangle>(Triangle{{0, v, 0}, {0, 0, 2}});
+                break;
+        }
+    }
+    ShapeVector grouped(std::move(packed));
+    auto timed = [](const char* name, auto&& run) {
+        double best = 1e300, result = 0;
+        for (int rep = 0; rep < 5; ++rep) {
+            auto start = std::chrono::high_resolution_clock::now();
+            result = run();
+            best = std::min(best, std::chrono::duration<double, std::milli>(
+                                      std::chrono::high_resolution_clock::now() - start).count());
+        }
+        std::cout << "  " << name << ": " << best << " ms (面积和=" << result << ")\n";
+    };
+    std::cout << "\n" << n << "个随机混合形状累加面积:\n";
+    timed("vector<unique_ptr> 分配顺序     ", [&] { return total_area(heap_shapes); });
+    // 打乱指针顺序，模拟在不同时间创建、散落在堆上的对象
+    std::shuffle(heap_shapes.begin(), heap_shapes.end(), rng);
+    timed("vector<unique_ptr> 打乱的堆对象 ", [&] { return total_area(heap_shapes); });
+    timed("poly_vector 插入顺序           ", [&] { return total_area(grouped); });
+    grouped.group_by_type();
+    timed("poly_vector 按类型分组         ", [&] { return total_area(grouped); });
+    std::cout << "poly_vector缓冲区: " << grouped.bytes_used() / (1024 * 1024) << " MB，平均每个元素 "
+              << grouped.bytes_used() / grouped.size() << " 字节\n";
+    
+    std::cout << "\n要点:\n";
+    std::cout << "- 连续存储消除了指针追逐，硬件预取可以顺序读入后续元素\n";
+    std::cout << "- 分组后连续的虚函数调用目标相同，间接跳转预测几乎不会失败\n";
+    std::cout << "- 元素地址在扩容和分组时会改变，不能长期保存元素的引用\n";
+    
+    std::cout << "\n";
+}
+
 // ===== 主函数 =====
 int main() {
     std::cout << "C++11/14/17/20 类型擦除技术深度解析\n";
@@ -737,6 +1855,9 @@ int main() {
     demonstrate_any_type_container();
     demonstrate_interface_type_erasure();
     demonstrate_performance_optimization();
+    demonstrate_small_buffer_function();
+    demonstrate_fast_any();
+    demonstrate_poly_vector();
     
     return 0;
 }
@@ -752,6 +1873,9 @@ g++ -std=c++17 -O2 -Wall 10_type_erasure.cpp -o type_erasure
 3. 接口类型擦除可以实现无侵入式的多态设计
 4. 小对象优化是重要的性能优化技术
 5. 类型擦除在泛型编程中提供了运行时灵活性
+6. 内联缓冲区 + 函数指针表的函数包装器避免了构造时的堆分配，只传参时用function_ref
+7. 用静态变量地址做类型标识，类型判断只需一次指针比较；同类型数据连续存放可把判断移出内层循环
+8. 多态对象连续存放并按类型分组，可以同时改善缓存局部性和间接跳转预测
 
 注意事项:
 - 类型擦除会引入运行时开销（虚函数调用、内存分配）
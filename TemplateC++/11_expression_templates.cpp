@@ -17,6 +17,35 @@
 #include <algorithm>
 #include <type_traits>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <initializer_list>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define SIMD_NEON 0
+#endif
+
+#include "../common/micro_bench.h"
 
 // ===== 1. 表达式模板基础原理演示 =====
 void demonstrate_expression_template_basics() {
@@ -577,7 +606,9 @@ void demonstrate_metaprogramming_optimization() {
     template<typename T>
     class SIMDVector : public VectorExpression<SIMDVector<T>> {
     private:
-        alignas(32) std::vector<T> data_;  // AVX对齐
+        // alignas(32)写在std::vector成员上只对齐vector对象本身，堆上缓冲区并不对齐
+        // 对齐分配器 + packet求值 + 运行时指令集分派的真实实现见第6节simd::SIMDVector
+        std::vector<T> data_;
         
     public:
         explicit SIMDVector(size_t size) : data_(size) {}
@@ -724,12 +755,1070 @@ void demonstrate_modern_expression_templates() {
     std::cout << "\n\n";
 }
 
+// ===== 6. SIMD表达式求值：packet访问 + 运行时指令集分派 =====
+// 第4节的SIMDVector只是打印"模拟"后跑标量循环，alignas(32)也只对齐了std::vector对象本身
+// 这里给每个表达式节点加上packet<P>(i)：一次返回P::width个元素组成的寄存器
+// 求值循环按寄存器宽度推进，剩余不足一个寄存器的元素走operator[]标量尾部
+// 各指令集的求值函数单独带target属性编译，运行时按CPU能力选择
+namespace simd {
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#define SIMD_FLATTEN __attribute__((flatten))  // 把整棵表达式树内联进带target的求值函数
+#else
+#define SIMD_TARGET(isa)
+#define SIMD_FLATTEN
+#endif
+
+// packet()在未开启AVX的上下文中按值返回__m256d/__m512d会触发ABI提示（-Wpsabi）
+// 它们总是被内联进带target属性的求值函数，不会发生跨ABI调用，因此只在这些声明周围关闭该提示
+#if defined(__GNUC__) && !defined(__clang__)
+#define SIMD_PACKET_ABI_BEGIN _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wpsabi\"")
+#define SIMD_PACKET_ABI_END _Pragma("GCC diagnostic pop")
+#else
+#define SIMD_PACKET_ABI_BEGIN
+#define SIMD_PACKET_ABI_END
+#endif
+
+// 对齐分配器：保证堆上缓冲区按Align字节对齐，packet加载可以用对齐指令
+template<typename T, std::size_t Align = 64>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const noexcept { return false; }
+};
+
+enum class Isa { Scalar, SSE2, AVX2, AVX512, NEON };
+
+inline const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "Scalar";
+        case Isa::SSE2: return "SSE2";
+        case Isa::AVX2: return "AVX2";
+        case Isa::AVX512: return "AVX-512";
+        case Isa::NEON: return "NEON";
+    }
+    return "?";
+}
+
+// ---- 各指令集的packet策略：寄存器类型、宽度和基本运算 ----
+template<typename T>
+struct ScalarPacket {
+    using reg = T;
+    static constexpr std::size_t width = 1;
+    static reg load(const T* p) { return *p; }
+    static void store(T* p, reg v) { *p = v; }
+    static reg set1(T v) { return v; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg sub(reg a, reg b) { return a - b; }
+    static reg mul(reg a, reg b) { return a * b; }
+};
+
+template<typename T> struct Sse2Packet;
+template<typename T> struct Avx2Packet;
+template<typename T> struct Avx512Packet;
+template<typename T> struct NeonPacket;
+
+#if SIMD_X86
+template<>
+struct Sse2Packet<double> {
+    using reg = __m128d;
+    static constexpr std::size_t width = 2;
+    SIMD_TARGET("sse2") static reg load(const double* p) { return _mm_load_pd(p); }
+    SIMD_TARGET("sse2") static void store(double* p, reg v) { _mm_store_pd(p, v); }
+    SIMD_TARGET("sse2") static reg set1(double v) { return _mm_set1_pd(v); }
+    SIMD_TARGET("sse2") static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    SIMD_TARGET("sse2") static reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+    SIMD_TARGET("sse2") static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+};
+
+template<>
+struct Sse2Packet<float> {
+    using reg = __m128;
+    static constexpr std::size_t width = 4;
+    SIMD_TARGET("sse2") static reg load(const float* p) { return _mm_load_ps(p); }
+    SIMD_TARGET("sse2") static void store(float* p, reg v) { _mm_store_ps(p, v); }
+    SIMD_TARGET("sse2") static reg set1(float v) { return _mm_set1_ps(v); }
+    SIMD_TARGET("sse2") static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+    SIMD_TARGET("sse2") static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+    SIMD_TARGET("sse2") static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+};
+
+template<>
+struct Avx2Packet<double> {
+    using reg = __m256d;
+    static constexpr std::size_t width = 4;
+    SIMD_TARGET("avx2") static reg load(const double* p) { return _mm256_load_pd(p); }
+    SIMD_TARGET("avx2") static void store(double* p, reg v) { _mm256_store_pd(p, v); }
+    SIMD_TARGET("avx2") static reg set1(double v) { return _mm256_set1_pd(v); }
+    SIMD_TARGET("avx2") static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    SIMD_TARGET("avx2") static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    SIMD_TARGET("avx2") static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+};
+
+template<>
+struct Avx2Packet<float> {
+    using reg = __m256;
+    static constexpr std::size_t width = 8;
+    SIMD_TARGET("avx2") static reg load(const float* p) { return _mm256_load_ps(p); }
+    SIMD_TARGET("avx2") static void store(float* p, reg v) { _mm256_store_ps(p, v); }
+    SIMD_TARGET("avx2") static reg set1(float v) { return _mm256_set1_ps(v); }
+    SIMD_TARGET("avx2") static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    SIMD_TARGET("avx2") static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    SIMD_TARGET("avx2") static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+};
+
+template<>
+struct Avx512Packet<double> {
+    using reg = __m512d;
+    static constexpr std::size_t width = 8;
+    SIMD_TARGET("avx512f") static reg load(const double* p) { return _mm512_load_pd(p); }
+    SIMD_TARGET("avx512f") static void store(double* p, reg v) { _mm512_store_pd(p, v); }
+    SIMD_TARGET("avx512f") static reg set1(double v) { return _mm512_set1_pd(v); }
+    SIMD_TARGET("avx512f") static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+    SIMD_TARGET("avx512f") static reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+    SIMD_TARGET("avx512f") static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+};
+
+template<>
+struct Avx512Packet<float> {
+    using reg = __m512;
+    static constexpr std::size_t width = 16;
+    SIMD_TARGET("avx512f") static reg load(const float* p) { return _mm512_load_ps(p); }
+    SIMD_TARGET("avx512f") static void store(float* p, reg v) { _mm512_store_ps(p, v); }
+    SIMD_TARGET("avx512f") static reg set1(float v) { return _mm512_set1_ps(v); }
+    SIMD_TARGET("avx512f") static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    SIMD_TARGET("avx512f") static reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+    SIMD_TARGET("avx512f") static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+};
+#endif
+
+#if SIMD_NEON
+template<>
+struct NeonPacket<double> {
+    using reg = float64x2_t;
+    static constexpr std::size_t width = 2;
+    static reg load(const double* p) { return vld1q_f64(p); }
+    static void store(double* p, reg v) { vst1q_f64(p, v); }
+    static reg set1(double v) { return vdupq_n_f64(v); }
+    static reg add(reg a, reg b) { return vaddq_f64(a, b); }
+    static reg sub(reg a, reg b) { return vsubq_f64(a, b); }
+    static reg mul(reg a, reg b) { return vmulq_f64(a, b); }
+};
+
+template<>
+struct NeonPacket<float> {
+    using reg = float32x4_t;
+    static constexpr std::size_t width = 4;
+    static reg load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, reg v) { vst1q_f32(p, v); }
+    static reg set1(float v) { return vdupq_n_f32(v); }
+    static reg add(reg a, reg b) { return vaddq_f32(a, b); }
+    static reg sub(reg a, reg b) { return vsubq_f32(a, b); }
+    static reg mul(reg a, reg b) { return vmulq_f32(a, b); }
+};
+#endif
+
+// ---- 运行时CPU能力检测 ----
+inline bool cpu_supports(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return true;
+#if SIMD_X86
+        case Isa::SSE2: return true;  // x86-64基线
+#if defined(__GNUC__) || defined(__clang__)
+        case Isa::AVX2: return __builtin_cpu_supports("avx2");
+        case Isa::AVX512: return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER)
+        case Isa::AVX2:
+        case Isa::AVX512: {
+            int info[4];
+            __cpuid(info, 1);
+            bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            if (isa == Isa::AVX2) return os_saves_ymm && (info[1] & (1 << 5));
+            return os_saves_ymm && (info[1] & (1 << 16)) && (_xgetbv(0) & 0xe6) == 0xe6;
+        }
+#endif
+#endif
+#if SIMD_NEON
+        case Isa::NEON: return true;  // AArch64基线
+#endif
+        default: return false;
+    }
+}
+
+inline Isa best_isa() {
+    static const Isa best = [] {
+        for (Isa isa : {Isa::AVX512, Isa::AVX2, Isa::NEON, Isa::SSE2}) {
+            if (cpu_supports(isa)) return isa;
+        }
+        return Isa::Scalar;
+    }();
+    return best;
+}
+
+// ---- 表达式节点 ----
+template<typename E>
+class VectorExpression {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+    auto operator[](std::size_t i) const { return self()[i]; }
+    std::size_t size() const { return self().size(); }
+};
+
+template<typename T>
+class SIMDVector;
+
+// 中间节点按值保存，叶子向量按引用保存：auto expr = (a + b * 2.0) - c 不会悬挂引用临时节点
+template<typename E>
+struct expr_storage {
+    using type = const E;
+};
+
+template<typename T>
+struct expr_storage<SIMDVector<T>> {
+    using type = const SIMDVector<T>&;
+};
+
+template<typename L, typename R>
+class VectorAdd : public VectorExpression<VectorAdd<L, R>> {
+    typename expr_storage<L>::type lhs_;
+    typename expr_storage<R>::type rhs_;
+
+public:
+    using value_type = typename L::value_type;
+    VectorAdd(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) { assert(lhs.size() == rhs.size()); }
+    value_type operator[](std::size_t i) const { return lhs_[i] + rhs_[i]; }
+    SIMD_PACKET_ABI_BEGIN
+    template<typename P>
+    typename P::reg packet(std::size_t i) const {
+        return P::add(lhs_.template packet<P>(i), rhs_.template packet<P>(i));
+    }
+    SIMD_PACKET_ABI_END
+    std::size_t size() const { return lhs_.size(); }
+};
+
+template<typename L, typename R>
+class VectorSub : public VectorExpression<VectorSub<L, R>> {
+    typename expr_storage<L>::type lhs_;
+    typename expr_storage<R>::type rhs_;
+
+public:
+    using value_type = typename L::value_type;
+    VectorSub(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) { assert(lhs.size() == rhs.size()); }
+    value_type operator[](std::size_t i) const { return lhs_[i] - rhs_[i]; }
+    SIMD_PACKET_ABI_BEGIN
+    template<typename P>
+    typename P::reg packet(std::size_t i) const {
+        return P::sub(lhs_.template packet<P>(i), rhs_.template packet<P>(i));
+    }
+    SIMD_PACKET_ABI_END
+    std::size_t size() const { return lhs_.size(); }
+};
+
+template<typename V>
+class VectorScalarMul : public VectorExpression<VectorScalarMul<V>> {
+    typename expr_storage<V>::type vec_;
+    typename V::value_type scalar_;
+
+public:
+    using value_type = typename V::value_type;
+    VectorScalarMul(const V& vec, value_type scalar) : vec_(vec), scalar_(scalar) {}
+    value_type operator[](std::size_t i) const { return vec_[i] * scalar_; }
+    SIMD_PACKET_ABI_BEGIN
+    template<typename P>
+    typename P::reg packet(std::size_t i) const {
+        return P::mul(vec_.template packet<P>(i), P::set1(scalar_));
+    }
+    SIMD_PACKET_ABI_END
+    std::size_t size() const { return vec_.size(); }
+};
+
+template<typename L, typename R>
+VectorAdd<L, R> operator+(const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) {
+    return VectorAdd<L, R>(lhs.self(), rhs.self());
+}
+
+template<typename L, typename R>
+VectorSub<L, R> operator-(const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) {
+    return VectorSub<L, R>(lhs.self(), rhs.self());
+}
+
+template<typename V>
+VectorScalarMul<V> operator*(const VectorExpression<V>& vec, typename V::value_type scalar) {
+    return VectorScalarMul<V>(vec.self(), scalar);
+}
+
+// ---- 求值：主循环按packet推进，尾部标量处理 ----
+SIMD_PACKET_ABI_BEGIN
+template<typename P, typename T, typename E>
+void evaluate_with(T* out, const E& expr, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width) {
+        P::store(out + i, expr.template packet<P>(i));
+    }
+    for (; i < n; ++i) {
+        out[i] = expr.template packet<ScalarPacket<T>>(i);
+    }
+}
+SIMD_PACKET_ABI_END
+
+// 每个入口都带对应的target属性，flatten保证packet调用链全部按该指令集内联
+template<typename T, typename E>
+SIMD_FLATTEN void evaluate_scalar(T* out, const E& expr, std::size_t n) {
+    evaluate_with<ScalarPacket<T>>(out, expr, n);
+}
+
+#if SIMD_X86
+template<typename T, typename E>
+SIMD_TARGET("sse2") SIMD_FLATTEN void evaluate_sse2(T* out, const E& expr, std::size_t n) {
+    evaluate_with<Sse2Packet<T>>(out, expr, n);
+}
+
+template<typename T, typename E>
+SIMD_TARGET("avx2") SIMD_FLATTEN void evaluate_avx2(T* out, const E& expr, std::size_t n) {
+    evaluate_with<Avx2Packet<T>>(out, expr, n);
+}
+
+template<typename T, typename E>
+SIMD_TARGET("avx512f") SIMD_FLATTEN void evaluate_avx512(T* out, const E& expr, std::size_t n) {
+    evaluate_with<Avx512Packet<T>>(out, expr, n);
+}
+#endif
+
+#if SIMD_NEON
+template<typename T, typename E>
+SIMD_FLATTEN void evaluate_neon(T* out, const E& expr, std::size_t n) {
+    evaluate_with<NeonPacket<T>>(out, expr, n);
+}
+#endif
+
+// 求值批次号：每次evaluate/fuse从全局计数器取一个新值，作为当前线程正在进行的批次（0表示不在求值中）
+// 第8节的share()节点据此判断缓存是否属于本次求值；计数器全局递增，不同线程、不同次求值的批次号不会相同
+inline std::atomic<std::size_t>& evaluation_generation_counter() {
+    static std::atomic<std::size_t> counter{0};
+    return counter;
+}
+
+inline std::size_t& current_evaluation() {
+    static thread_local std::size_t generation = 0;
+    return generation;
+}
+
+class EvaluationScope {
+    std::size_t previous_;
+
+public:
+    EvaluationScope() : previous_(current_evaluation()) {
+        current_evaluation() = evaluation_generation_counter().fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    ~EvaluationScope() { current_evaluation() = previous_; }
+
+    EvaluationScope(const EvaluationScope&) = delete;
+    EvaluationScope& operator=(const EvaluationScope&) = delete;
+};
+
+// 调用方需保证isa在当前CPU上可用（见cpu_supports）
+template<typename T, typename E>
+void evaluate(T* out, const E& expr, std::size_t n, Isa isa) {
+    EvaluationScope scope;
+    switch (isa) {
+#if SIMD_X86
+        case Isa::SSE2: return evaluate_sse2(out, expr, n);
+        case Isa::AVX2: return evaluate_avx2(out, expr, n);
+        case Isa::AVX512: return evaluate_avx512(out, expr, n);
+#endif
+#if SIMD_NEON
+        case Isa::NEON: return evaluate_neon(out, expr, n);
+#endif
+        default: return evaluate_scalar(out, expr, n);
+    }
+}
+
+// 叶子节点：存储由AlignedAllocator按64字节对齐，同时满足AVX-512的对齐加载要求
+template<typename T>
+class SIMDVector : public VectorExpression<SIMDVector<T>> {
+    static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "只支持float/double");
+
+    std::vector<T, AlignedAllocator<T, 64>> data_;
+
+public:
+    using value_type = T;
+
+    explicit SIMDVector(std::size_t size, T value = T()) : data_(size, value) {}
+    SIMDVector(std::initializer_list<T> list) : data_(list) {}
+
+    template<typename E>
+    SIMDVector(const VectorExpression<E>& expr) : data_(expr.size()) {
+        assign(expr, best_isa());
+    }
+
+    template<typename E>
+    SIMDVector& operator=(const VectorExpression<E>& expr) {
+        data_.resize(expr.size());
+        assign(expr, best_isa());
+        return *this;
+    }
+
+    // 指定指令集求值，基准测试用来逐一对比
+    template<typename E>
+    void assign(const VectorExpression<E>& expr, Isa isa) {
+        evaluate(data_.data(), expr.self(), data_.size(), isa);
+    }
+
+    SIMD_PACKET_ABI_BEGIN
+    template<typename P>
+    typename P::reg packet(std::size_t i) const { return P::load(data_.data() + i); }
+    SIMD_PACKET_ABI_END
+
+    T& operator[](std::size_t i) { return data_[i]; }
+    const T& operator[](std::size_t i) const { return data_[i]; }
+    std::size_t size() const { return data_.size(); }
+    void resize(std::size_t n) { data_.resize(n); }
+    T* data() { return data_.data(); }
+    const T* data() const { return data_.data(); }
+
+    void print() const {
+        std::cout << "[SIMD-";
+        for (std::size_t i = 0; i < std::min(data_.size(), std::size_t(5)); ++i) {
+            if (i > 0) std::cout << ", ";
+            std::cout << data_[i];
+        }
+        if (data_.size() > 5) std::cout << ", ...";
+        std::cout << "]";
+    }
+};
+
+}  // namespace simd
+
+void demonstrate_simd_evaluation() {
+    std::cout << "=== SIMD表达式求值演示 ===\n";
+
+    std::cout << "当前CPU支持:";
+    for (simd::Isa isa : {simd::Isa::SSE2, simd::Isa::AVX2, simd::Isa::AVX512, simd::Isa::NEON}) {
+        if (simd::cpu_supports(isa)) std::cout << " " << simd::isa_name(isa);
+    }
+    std::cout << "，默认使用 " << simd::isa_name(simd::best_isa()) << "\n";
+
+    // 长度11：AVX-512一次处理8个double，剩下3个走标量尾部
+    simd::SIMDVector<double> x{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    simd::SIMDVector<double> y{11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1};
+    simd::SIMDVector<double> result = (x + y * 2.0) - x;
+    std::cout << "(x + y * 2.0) - x = ";
+    result.print();
+    std::cout << "，最后一个元素 " << result[10] << "\n";
+    std::cout << "存储地址按64字节对齐: "
+              << (reinterpret_cast<std::uintptr_t>(result.data()) % 64 == 0 ? "是" : "否") << "\n\n";
+}
+
+// ===== 7. 矩阵表达式：分块并行求值 =====
+// 第3节的Matrix构造时逐元素、单线程、按行顺序求值
+// 对transpose来说按行写输出就是按列读输入，大矩阵上每次读取几乎都是缓存未命中
+// 这里把求值策略作为模板参数：eval<seq>(expr) / eval<tiled>(expr) / eval<par_tiled>(expr)
+// 分块策略把输出切成kTile x kTile的块，块内源数据也落在一小片区域，transpose自然变成分块转置
+// 每个输出元素仍由同一条表达式计算，求值顺序不影响结果，与seq逐位一致
+namespace tiled_matrix {
+
+// 持久线程池：parallel_for把任务编号分给工作线程和调用线程，取号用一个原子计数器
+class TilePool {
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mtx_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+
+    const std::function<void(std::size_t)>* job_ = nullptr;
+    std::size_t job_count_ = 0;
+    std::atomic<std::size_t> next_{0};
+    std::size_t active_ = 0;
+    std::uint64_t generation_ = 0;
+    bool stopping_ = false;
+
+    void run_tasks(const std::function<void(std::size_t)>& job, std::size_t count) {
+        for (std::size_t t = next_.fetch_add(1); t < count; t = next_.fetch_add(1)) {
+            job(t);
+        }
+    }
+
+    void worker_loop() {
+        std::uint64_t seen = 0;
+        while (true) {
+            const std::function<void(std::size_t)>* job;
+            std::size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                work_cv_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+                job = job_;
+                count = job_count_;
+                ++active_;
+            }
+            run_tasks(*job, count);
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                --active_;
+            }
+            done_cv_.notify_one();
+        }
+    }
+
+public:
+    explicit TilePool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        // 调用线程也参与计算，所以只额外创建threads-1个工作线程
+        for (std::size_t i = 1; i < threads; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~TilePool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+    TilePool(const TilePool&) = delete;
+    TilePool& operator=(const TilePool&) = delete;
+
+    std::size_t size() const { return workers_.size() + 1; }
+
+    static TilePool& instance() {
+        static TilePool pool;
+        return pool;
+    }
+
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)>& job) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            job_ = &job;
+            job_count_ = count;
+            next_.store(0);
+            ++generation_;
+        }
+        work_cv_.notify_all();
+        run_tasks(job, count);
+        // 等所有参与的工作线程离开run_tasks，job引用才能失效
+        std::unique_lock<std::mutex> lock(mtx_);
+        done_cv_.wait(lock, [this] { return active_ == 0; });
+        job_ = nullptr;
+    }
+};
+
+template<typename E>
+class MatrixExpression {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+    double operator()(std::size_t i, std::size_t j) const { return self()(i, j); }
+    std::size_t rows() const { return self().rows(); }
+    std::size_t cols() const { return self().cols(); }
+};
+
+class Matrix;
+
+// 与第6节相同：中间节点按值保存，叶子按引用保存
+template<typename E>
+struct expr_storage {
+    using type = const E;
+};
+
+template<>
+struct expr_storage<Matrix> {
+    using type = const Matrix&;
+};
+
+template<typename L, typename R>
+class MatrixAdd : public MatrixExpression<MatrixAdd<L, R>> {
+    typename expr_storage<L>::type left_;
+    typename expr_storage<R>::type right_;
+
+public:
+    MatrixAdd(const L& left, const R& right) : left_(left), right_(right) {
+        assert(left.rows() == right.rows() && left.cols() == right.cols());
+    }
+    double operator()(std::size_t i, std::size_t j) const { return left_(i, j) + right_(i, j); }
+    std::size_t rows() const { return left_.rows(); }
+    std::size_t cols() const { return left_.cols(); }
+};
+
+template<typename M>
+class MatrixScalarMul : public MatrixExpression<MatrixScalarMul<M>> {
+    typename expr_storage<M>::type matrix_;
+    double scalar_;
+
+public:
+    MatrixScalarMul(const M& matrix, double scalar) : matrix_(matrix), scalar_(scalar) {}
+    double operator()(std::size_t i, std::size_t j) const { return matrix_(i, j) * scalar_; }
+    std::size_t rows() const { return matrix_.rows(); }
+    std::size_t cols() const { return matrix_.cols(); }
+};
+
+template<typename M>
+class MatrixTranspose : public MatrixExpression<MatrixTranspose<M>> {
+    typename expr_storage<M>::type matrix_;
+
+public:
+    explicit MatrixTranspose(const M& matrix) : matrix_(matrix) {}
+    double operator()(std::size_t i, std::size_t j) const { return matrix_(j, i); }
+    std::size_t rows() const { return matrix_.cols(); }
+    std::size_t cols() const { return matrix_.rows(); }
+};
+
+template<typename L, typename R>
+MatrixAdd<L, R> operator+(const MatrixExpression<L>& left, const MatrixExpression<R>& right) {
+    return MatrixAdd<L, R>(left.self(), right.self());
+}
+
+template<typename M>
+MatrixScalarMul<M> operator*(const MatrixExpression<M>& matrix, double scalar) {
+    return MatrixScalarMul<M>(matrix.self(), scalar);
+}
+
+template<typename M>
+MatrixScalarMul<M> operator*(double scalar, const MatrixExpression<M>& matrix) {
+    return MatrixScalarMul<M>(matrix.self(), scalar);
+}
+
+template<typename M>
+MatrixTranspose<M> transpose(const MatrixExpression<M>& matrix) {
+    return MatrixTranspose<M>(matrix.self());
+}
+
+// 叶子：连续行主序存储（第3节用vector<vector>，每行一次独立分配）
+class Matrix : public MatrixExpression<Matrix> {
+    std::size_t rows_, cols_;
+    std::vector<double> data_;
+
+public:
+    Matrix(std::size_t rows, std::size_t cols) : rows_(rows), cols_(cols), data_(rows * cols) {}
+
+    double& operator()(std::size_t i, std::size_t j) { return data_[i * cols_ + j]; }
+    double operator()(std::size_t i, std::size_t j) const { return data_[i * cols_ + j]; }
+    std::size_t rows() const { return rows_; }
+    std::size_t cols() const { return cols_; }
+    const double* data() const { return data_.data(); }
+
+    bool operator==(const Matrix& other) const {
+        return rows_ == other.rows_ && cols_ == other.cols_ &&
+               std::memcmp(data_.data(), other.data_.data(), data_.size() * sizeof(double)) == 0;
+    }
+};
+
+// ---- 求值策略 ----
+struct seq {};        // 逐行逐元素，单线程
+struct tiled {};      // 按块求值，单线程
+struct par_tiled {};  // 按块求值，块分配到TilePool
+
+// 64x64个double = 32KB：一块输出加上对应的一块源数据大致落在L2
+constexpr std::size_t kTile = 64;
+
+// 表达式树中是否含有转置：不含转置时逐行访问本来就是顺序的，块宽取整行，避免内层循环被切短
+template<typename E>
+struct has_transpose : std::false_type {};
+
+template<typename M>
+struct has_transpose<MatrixTranspose<M>> : std::true_type {};
+
+template<typename L, typename R>
+struct has_transpose<MatrixAdd<L, R>>
+    : std::integral_constant<bool, has_transpose<L>::value || has_transpose<R>::value> {};
+
+template<typename M>
+struct has_transpose<MatrixScalarMul<M>> : has_transpose<M> {};
+
+template<typename E>
+std::size_t tile_width(const E& expr) {
+    return has_transpose<E>::value ? kTile : expr.cols();
+}
+
+template<typename E>
+void eval_tile(Matrix& out, const E& expr, std::size_t tile_row, std::size_t tile_col) {
+    const std::size_t i_end = std::min(tile_row + kTile, out.rows());
+    const std::size_t j_end = std::min(tile_col + tile_width(expr), out.cols());
+    for (std::size_t i = tile_row; i < i_end; ++i) {
+        for (std::size_t j = tile_col; j < j_end; ++j) {
+            out(i, j) = expr(i, j);
+        }
+    }
+}
+
+template<typename E>
+void eval_into(Matrix& out, const E& expr, seq) {
+    for (std::size_t i = 0; i < out.rows(); ++i) {
+        for (std::size_t j = 0; j < out.cols(); ++j) {
+            out(i, j) = expr(i, j);
+        }
+    }
+}
+
+template<typename E>
+void eval_into(Matrix& out, const E& expr, tiled) {
+    const std::size_t width = tile_width(expr);
+    for (std::size_t ti = 0; ti < out.rows(); ti += kTile) {
+        for (std::size_t tj = 0; tj < out.cols(); tj += width) {
+            eval_tile(out, expr, ti, tj);
+        }
+    }
+}
+
+template<typename E>
+void eval_into(Matrix& out, const E& expr, par_tiled) {
+    const std::size_t tile_rows = (out.rows() + kTile - 1) / kTile;
+    const std::size_t width = tile_width(expr);
+    const std::size_t tile_cols = (out.cols() + width - 1) / width;
+    // 块之间写入的输出区域互不重叠，不需要同步
+    TilePool::instance().parallel_for(tile_rows * tile_cols, [&](std::size_t t) {
+        eval_tile(out, expr, (t / tile_cols) * kTile, (t % tile_cols) * width);
+    });
+}
+
+// 注意：输出不能与表达式中的操作数是同一个矩阵（A = transpose(A)需要先求值到新矩阵）
+template<typename Policy, typename E>
+Matrix eval(const MatrixExpression<E>& expr) {
+    Matrix out(expr.rows(), expr.cols());
+    eval_into(out, expr.self(), Policy{});
+    return out;
+}
+
+}  // namespace tiled_matrix
+
+void demonstrate_tiled_matrix_evaluation() {
+    std::cout << "=== 矩阵表达式分块并行求值演示 ===\n";
+    using namespace tiled_matrix;
+
+    const std::size_t n = 2048;  // 8k x 8k每个矩阵512MB，演示用2048 x 2048 (32MB)
+    Matrix A(n, n), B(n, n);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            A(i, j) = dist(gen);
+            B(i, j) = dist(gen);
+        }
+    }
+
+    std::cout << "矩阵 " << n << "x" << n << "，块大小 " << kTile << "x" << kTile
+              << "，线程池 " << TilePool::instance().size() << " 线程\n";
+
+    auto time_ms = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    auto report = [&](const char* label, const auto& expr) {
+        Matrix serial(1, 1), blocked(1, 1), parallel(1, 1);
+        double t_seq = time_ms([&] { serial = eval<seq>(expr); });
+        double t_tiled = time_ms([&] { blocked = eval<tiled>(expr); });
+        double t_par = time_ms([&] { parallel = eval<par_tiled>(expr); });
+        std::cout << label << "\n";
+        std::cout << "  seq: " << t_seq << " ms, tiled: " << t_tiled << " ms ("
+                  << t_seq / t_tiled << "x), par_tiled: " << t_par << " ms (" << t_seq / t_par << "x)\n";
+        std::cout << "  与seq逐位一致: " << (serial == blocked && serial == parallel ? "是" : "否") << "\n";
+    };
+
+    report("A + B * 2.0", A + B * 2.0);
+    report("transpose(A)", transpose(A));
+    report("(A + transpose(B)) * 0.5", (A + transpose(B)) * 0.5);
+
+    std::cout << "注：tiled相对seq的收益来自转置的缓存局部性；par_tiled还随核数扩展\n";
+
+    std::cout << "\n";
+}
+
+// ===== 8. 多输出融合求值：fuse(lazy(o1) = e1, lazy(o2) = e2, ...) =====
+// 逐条赋值时每条语句各扫一遍输入；多个输出共享输入时，融合成一个循环只读一遍
+// 每次迭代先算出全部输出的packet再统一写回：写回不会打断编译器对公共子表达式的合并，
+// share(e)则显式地让子表达式在同一个下标上只计算一次
+namespace simd {
+
+// 逐元素乘法，特征变换里常见的x*y交叉项
+template<typename L, typename R>
+class VectorMul : public VectorExpression<VectorMul<L, R>> {
+    typename expr_storage<L>::type lhs_;
+    typename expr_storage<R>::type rhs_;
+
+public:
+    using value_type = typename L::value_type;
+    VectorMul(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) { assert(lhs.size() == rhs.size()); }
+    value_type operator[](std::size_t i) const { return lhs_[i] * rhs_[i]; }
+    SIMD_PACKET_ABI_BEGIN
+    template<typename P>
+    typename P::reg packet(std::size_t i) const {
+        return P::mul(lhs_.template packet<P>(i), rhs_.template packet<P>(i));
+    }
+    SIMD_PACKET_ABI_END
+    std::size_t size() const { return lhs_.size(); }
+};
+
+template<typename L, typename R>
+VectorMul<L, R> operator*(const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) {
+    return VectorMul<L, R>(lhs.self(), rhs.self());
+}
+
+// 共享子表达式：缓存最近一次计算的(求值批次, 下标, 宽度)和结果，同一下标的后续引用直接取缓存
+// 必须先命名（auto s = share(a + b)），各表达式按引用持有同一个节点；
+// 缓存只在evaluate/fuse内部使用，直接调用operator[]总是重新计算；
+// 缓存是可变状态，同一个share节点不要在多个线程里同时求值
+template<typename E>
+class SharedExpression : public VectorExpression<SharedExpression<E>> {
+    E expr_;
+    mutable std::size_t cached_generation_ = 0;
+    mutable std::size_t cached_index_ = 0;
+    mutable std::size_t cached_width_ = 0;
+    alignas(64) mutable unsigned char cached_packet_[64];
+
+    bool hit(std::size_t i, std::size_t width) const {
+        const std::size_t generation = current_evaluation();
+        return generation != 0 && cached_generation_ == generation && cached_index_ == i && cached_width_ == width;
+    }
+
+    void remember(std::size_t i, std::size_t width) const {
+        cached_generation_ = current_evaluation();
+        cached_index_ = i;
+        cached_width_ = width;
+    }
+
+public:
+    using value_type = typename E::value_type;
+    explicit SharedExpression(const E& expr) : expr_(expr) {}
+
+    value_type operator[](std::size_t i) const { return expr_[i]; }
+
+    SIMD_PACKET_ABI_BEGIN
+    template<typename P>
+    typename P::reg packet(std::size_t i) const {
+        static_assert(sizeof(typename P::reg) <= sizeof(cached_packet_), "packet超出缓存槽");
+        typename P::reg value;
+        if (hit(i, P::width)) {
+            std::memcpy(&value, cached_packet_, sizeof(value));
+        } else {
+            value = expr_.template packet<P>(i);
+            std::memcpy(cached_packet_, &value, sizeof(value));
+            remember(i, P::width);
+        }
+        return value;
+    }
+    SIMD_PACKET_ABI_END
+
+    std::size_t size() const { return expr_.size(); }
+};
+
+template<typename E>
+struct expr_storage<SharedExpression<E>> {
+    using type = const SharedExpression<E>&;
+};
+
+template<typename E>
+SharedExpression<E> share(const VectorExpression<E>& expr) {
+    return SharedExpression<E>(expr.self());
+}
+
+// 延迟赋值：lazy(out) = expr 只记录目标和表达式，交给fuse统一求值
+template<typename T, typename E>
+struct Assignment {
+    SIMDVector<T>* out;
+    typename expr_storage<E>::type expr;
+};
+
+template<typename T>
+class LazyTarget {
+    SIMDVector<T>& out_;
+
+public:
+    explicit LazyTarget(SIMDVector<T>& out) : out_(out) {}
+
+    template<typename E>
+    Assignment<T, E> operator=(const VectorExpression<E>& expr) const {
+        return Assignment<T, E>{&out_, expr.self()};
+    }
+};
+
+template<typename T>
+LazyTarget<T> lazy(SIMDVector<T>& out) {
+    return LazyTarget<T>(out);
+}
+
+SIMD_PACKET_ABI_BEGIN
+template<typename P, typename T, typename... E>
+void fuse_with(std::size_t n, const Assignment<T, E>&... assignments) {
+    T* outs[] = {assignments.out->data()...};
+    std::size_t i = 0;
+    for (; i + P::width <= n; i += P::width) {
+        // 先全部计算，再全部写回
+        typename P::reg values[] = {assignments.expr.template packet<P>(i)...};
+        for (std::size_t k = 0; k < sizeof...(E); ++k) P::store(outs[k] + i, values[k]);
+    }
+    for (; i < n; ++i) {
+        T values[] = {assignments.expr.template packet<ScalarPacket<T>>(i)...};
+        for (std::size_t k = 0; k < sizeof...(E); ++k) outs[k][i] = values[k];
+    }
+}
+SIMD_PACKET_ABI_END
+
+template<typename T, typename... E>
+SIMD_FLATTEN void fuse_scalar(std::size_t n, const Assignment<T, E>&... as) {
+    fuse_with<ScalarPacket<T>>(n, as...);
+}
+
+#if SIMD_X86
+template<typename T, typename... E>
+SIMD_TARGET("sse2") SIMD_FLATTEN void fuse_sse2(std::size_t n, const Assignment<T, E>&... as) {
+    fuse_with<Sse2Packet<T>>(n, as...);
+}
+
+template<typename T, typename... E>
+SIMD_TARGET("avx2") SIMD_FLATTEN void fuse_avx2(std::size_t n, const Assignment<T, E>&... as) {
+    fuse_with<Avx2Packet<T>>(n, as...);
+}
+
+template<typename T, typename... E>
+SIMD_TARGET("avx512f") SIMD_FLATTEN void fuse_avx512(std::size_t n, const Assignment<T, E>&... as) {
+    fuse_with<Avx512Packet<T>>(n, as...);
+}
+#endif
+
+#if SIMD_NEON
+template<typename T, typename... E>
+SIMD_FLATTEN void fuse_neon(std::size_t n, const Assignment<T, E>&... as) {
+    fuse_with<NeonPacket<T>>(n, as...);
+}
+#endif
+
+// 所有赋值同时生效：右侧读到的都是fuse之前的值，与逐条执行的区别只在于
+// 某个输出又被另一条表达式读取时；同一下标上的原地更新（a = a + b）两者一致
+template<typename T, typename... E>
+void fuse(Isa isa, const Assignment<T, E>&... assignments) {
+    static_assert(sizeof...(E) > 0, "至少需要一个赋值");
+    const std::size_t sizes[] = {assignments.expr.size()...};
+    const std::size_t n = sizes[0];
+    for (std::size_t s : sizes) {
+        assert(s == n && "融合的表达式长度必须一致");
+        (void)s;
+    }
+    (assignments.out->resize(n), ...);
+    EvaluationScope scope;
+    switch (isa) {
+#if SIMD_X86
+        case Isa::SSE2: return fuse_sse2(n, assignments...);
+        case Isa::AVX2: return fuse_avx2(n, assignments...);
+        case Isa::AVX512: return fuse_avx512(n, assignments...);
+#endif
+#if SIMD_NEON
+        case Isa::NEON: return fuse_neon(n, assignments...);
+#endif
+        default: return fuse_scalar(n, assignments...);
+    }
+}
+
+template<typename T, typename... E>
+void fuse(const Assignment<T, E>&... assignments) {
+    fuse(best_isa(), assignments...);
+}
+
+}  // namespace simd
+
+void demonstrate_fused_evaluation() {
+    std::cout << "=== 多输出融合求值演示 ===\n";
+
+    // 三个输出共享输入a、b、c和子表达式(a + b)
+    const std::size_t n = 4'000'000;
+    simd::SIMDVector<double> a(n), b(n), c(n);
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (std::size_t i = 0; i < n; ++i) {
+        a[i] = dist(gen);
+        b[i] = dist(gen);
+        c[i] = dist(gen);
+    }
+    simd::SIMDVector<double> o1(n), o2(n), o3(n), f1(n), f2(n), f3(n), g1(n), g2(n), g3(n);
+
+    auto sum = simd::share(a + b);
+    auto run_separate = [&] {
+        o1 = sum * 0.5;
+        o2 = (a + b) * c;
+        o3 = ((a + b) - c) * 2.0 + a;
+    };
+    auto run_fused = [&] {
+        simd::fuse(simd::lazy(f1) = (a + b) * 0.5,
+                   simd::lazy(f2) = (a + b) * c,
+                   simd::lazy(f3) = ((a + b) - c) * 2.0 + a);
+    };
+    auto run_fused_shared = [&] {
+        simd::fuse(simd::lazy(g1) = sum * 0.5,
+                   simd::lazy(g2) = sum * c,
+                   simd::lazy(g3) = (sum - c) * 2.0 + a);
+    };
+
+    // 交替运行取最短时间
+    const std::function<void()> variants[] = {run_separate, run_fused, run_fused_shared};
+    double best[3] = {1e300, 1e300, 1e300};
+    for (int round = 0; round < 5; ++round) {
+        for (int k = 0; k < 3; ++k) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            variants[k]();
+            best[k] = std::min(best[k], std::chrono::duration<double, std::milli>(
+                                            std::chrono::high_resolution_clock::now() - t0).count());
+        }
+    }
+
+    bool same = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        same = same && o1[i] == f1[i] && o2[i] == f2[i] && o3[i] == f3[i] && f1[i] == g1[i] && f2[i] == g2[i] &&
+               f3[i] == g3[i];
+    }
+
+    // 流量模型：逐条赋值读2+3+3个输入数组，融合后只读a、b、c各一次；写回都是3个数组
+    const double mb = n * sizeof(double) / 1e6;
+    std::cout << "n = " << n << "，指令集 " << simd::isa_name(simd::best_isa()) << "\n";
+    std::cout << "逐条赋值(3个循环)    " << best[0] << " ms，理论流量 " << 11 * mb << " MB\n";
+    std::cout << "fuse                 " << best[1] << " ms，理论流量 " << 6 * mb << " MB，"
+              << best[0] / best[1] << "x\n";
+    std::cout << "fuse + share(a + b)  " << best[2] << " ms，理论流量 " << 6 * mb << " MB，"
+              << best[0] / best[2] << "x\n";
+    std::cout << "三种方式结果逐位一致: " << (same ? "是" : "否") << "\n";
+    std::cout << "注：a + b这类便宜的子表达式，编译器已在融合循环里自动合并，share的缓存检查反而多出开销；\n"
+              << "    share适合除法、开方等代价高、或编译器无法证明相同的子表达式\n";
+
+    // 尾部元素走标量路径，同样只计算一次共享子表达式
+    simd::SIMDVector<double> x{1, 2, 3, 4, 5}, y{5, 4, 3, 2, 1}, p(5), q(5);
+    auto xy = simd::share(x * y);
+    simd::fuse(simd::lazy(p) = xy + x, simd::lazy(q) = xy - y);
+    std::cout << "x*y + x = ";
+    p.print();
+    std::cout << "，x*y - y = ";
+    q.print();
+    std::cout << "\n\n";
+}
+
 // ===== 性能基准测试 =====
 void benchmark_expression_templates() {
     std::cout << "=== 表达式模板性能基准测试 ===\n";
     
     const size_t vector_size = 1000000;
-    const int iterations = 100;
     
     // 生成测试数据
     std::vector<double> data_a(vector_size), data_b(vector_size), data_c(vector_size);
@@ -743,10 +1832,9 @@ void benchmark_expression_templates() {
         data_c[i] = dist(gen);
     }
     
+    // 每次迭代完整求值一遍表达式，预热、重复采样并取中位数交给统一基准框架
     // 传统方法基准测试
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    for (int iter = 0; iter < iterations; ++iter) {
+    const auto traditional_result = micro_bench::measure("传统方法", [&]() {
         std::vector<double> temp1(vector_size), temp2(vector_size), result(vector_size);
         
         // 传统方法：多个循环，多个临时对象
@@ -761,43 +1849,62 @@ void benchmark_expression_templates() {
         for (size_t i = 0; i < vector_size; ++i) {
             result[i] = temp2[i] - data_c[i];
         }
-    }
-    
-    auto traditional_time = std::chrono::high_resolution_clock::now() - start;
+        micro_bench::do_not_optimize(result.data());
+        micro_bench::clobber_memory();
+    }, vector_size);
     
     // 表达式模板方法基准测试
     OptimizedVector<double> expr_a(data_a.begin(), data_a.end());
     OptimizedVector<double> expr_b(data_b.begin(), data_b.end());
     OptimizedVector<double> expr_c(data_c.begin(), data_c.end());
     
-    start = std::chrono::high_resolution_clock::now();
-    
-    for (int iter = 0; iter < iterations; ++iter) {
+    const auto expression_result = micro_bench::measure("表达式模板", [&]() {
         // 表达式模板：单个循环，无临时对象
         OptimizedVector<double> result = (expr_a + expr_b * 2.0) - expr_c;
-        (void)result;  // 防止优化掉
-    }
-    
-    auto expression_time = std::chrono::high_resolution_clock::now() - start;
+        micro_bench::do_not_optimize(result);  // 防止优化掉
+        micro_bench::clobber_memory();
+    }, vector_size);
     
     std::cout << "性能对比结果:\n";
     std::cout << "向量大小: " << vector_size << "\n";
-    std::cout << "迭代次数: " << iterations << "\n";
-    std::cout << "传统方法耗时: " 
-              << std::chrono::duration_cast<std::chrono::milliseconds>(traditional_time).count() 
-              << " 毫秒\n";
-    std::cout << "表达式模板耗时: " 
-              << std::chrono::duration_cast<std::chrono::milliseconds>(expression_time).count() 
-              << " 毫秒\n";
-    
-    double speedup = static_cast<double>(traditional_time.count()) / expression_time.count();
+    micro_bench::print_result(std::cout, traditional_result);
+    micro_bench::print_result(std::cout, expression_result);
+    
+    double speedup = traditional_result.median_ns / expression_result.median_ns;
     std::cout << "性能提升: " << speedup << "x\n";
+
+    // 同一表达式 (a + b*2.0) - c 按各指令集求值：每个元素1次乘法 + 2次加减 = 3 FLOP
+    std::cout << "\nSIMD求值吞吐量 (每元素3 FLOP，按中位耗时):\n";
+    std::cout << "指令集\t\t缓存内(4K元素)\t内存(1M元素)\n";
+    const std::size_t sizes[] = {4096, vector_size};
+    for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::SSE2, simd::Isa::AVX2, simd::Isa::AVX512, simd::Isa::NEON}) {
+        if (!simd::cpu_supports(isa)) continue;
+        std::cout << simd::isa_name(isa) << "\t\t";
+        for (std::size_t n : sizes) {
+            simd::SIMDVector<double> sa(n), sb(n), sc(n), sr(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                sa[i] = data_a[i];
+                sb[i] = data_b[i];
+                sc[i] = data_c[i];
+            }
+            auto expr = (sa + sb * 2.0) - sc;
+            const auto result = micro_bench::measure(simd::isa_name(isa), [&]() {
+                sr.assign(expr, isa);
+                micro_bench::clobber_memory();
+            }, n);
+            assert(sr[n - 1] == (data_a[n - 1] + data_b[n - 1] * 2.0) - data_c[n - 1]);
+            std::cout << 3.0 * result.items_per_second() / 1e9 << " GFLOP/s\t";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "注：1M元素时4个数组共32MB，受内存带宽限制，各指令集差距会明显缩小\n";
     
     std::cout << "\n";
 }
 
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++98/11/14/17/20 表达式模板深度解析\n";
     std::cout << "====================================\n";
     
@@ -806,6 +1913,9 @@ int main() {
     demonstrate_operator_overloading();
     demonstrate_metaprogramming_optimization();
     demonstrate_modern_expression_templates();
+    demonstrate_simd_evaluation();
+    demonstrate_tiled_matrix_evaluation();
+    demonstrate_fused_evaluation();
     benchmark_expression_templates();
     
     return 0;
@@ -822,6 +1932,9 @@ g++ -std=c++17 -O2 -Wall 11_expression_templates.cpp -o expression_templates
 3. 模板元编程可以实现编译期表达式优化和自动向量化
 4. 现代C++特性（auto、可变参数模板）简化表达式模板实现
 5. 表达式模板在数值计算库中有广泛应用（Eigen、Blaze等）
+6. 给表达式节点加packet(i)即可整树向量化：target属性 + flatten按指令集生成代码，运行时检测CPU后分派，尾部元素走标量
+7. 求值策略作为模板参数（eval<seq>/eval<tiled>/eval<par_tiled>）：分块让transpose按块访问源矩阵，块互不重叠可直接并行，结果与串行逐位一致
+8. 多个输出共享输入时用fuse合并成一个循环，输入只读一遍；share()让公共子表达式在每个下标上只算一次
 
 注意事项:
 - 表达式模板会显著增加编译时间和二进制大小
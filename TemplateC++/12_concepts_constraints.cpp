@@ -20,6 +20,8 @@
 #include <chrono>
 #include <ranges>
 
+#include "../common/micro_bench.h"
+
 // ===== 1. Concepts基础语法演示 =====
 void demonstrate_concepts_basics() {
     std::cout << "=== Concepts基础语法演示 ===\n";
@@ -676,35 +678,32 @@ void benchmark_concepts_vs_sfinae() {
         return value * value + value;
     }
     
-    // 编译时间测试（运行时展示）
-    auto start = std::chrono::high_resolution_clock::now();
-    
+    // 运行时对比：预热、重复采样并取中位数交给统一基准框架，每次采样跑完整的iterations次
     int sfinae_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
-        sfinae_sum += sfinae_compute(i % 1000);
-    }
-    
-    auto sfinae_time = std::chrono::high_resolution_clock::now() - start;
-    
-    start = std::chrono::high_resolution_clock::now();
+    const auto sfinae_result = micro_bench::measure("SFINAE版本", [&]() {
+        sfinae_sum = 0;
+        for (int i = 0; i < iterations; ++i) {
+            sfinae_sum += sfinae_compute(i % 1000);
+        }
+        micro_bench::do_not_optimize(sfinae_sum);
+    }, iterations);
     
     int concepts_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
-        concepts_sum += concepts_compute(i % 1000);
-    }
-    
-    auto concepts_time = std::chrono::high_resolution_clock::now() - start;
+    const auto concepts_result = micro_bench::measure("Concepts版本", [&]() {
+        concepts_sum = 0;
+        for (int i = 0; i < iterations; ++i) {
+            concepts_sum += concepts_compute(i % 1000);
+        }
+        micro_bench::do_not_optimize(concepts_sum);
+    }, iterations);
     
-    std::cout << "运行时性能对比 (" << iterations << " 次迭代):\n";
-    std::cout << "SFINAE版本耗时: " 
-              << std::chrono::duration_cast<std::chrono::microseconds>(sfinae_time).count() 
-              << " 微秒 (结果: " << sfinae_sum << ")\n";
-    std::cout << "Concepts版本耗时: " 
-              << std::chrono::duration_cast<std::chrono::microseconds>(concepts_time).count() 
-              << " 微秒 (结果: " << concepts_sum << ")\n";
+    std::cout << "运行时性能对比 (每次采样 " << iterations << " 次迭代):\n";
+    micro_bench::print_result(std::cout, sfinae_result);
+    micro_bench::print_result(std::cout, concepts_result);
+    std::cout << "结果: SFINAE " << sfinae_sum << ", Concepts " << concepts_sum << "\n";
     
-    double ratio = static_cast<double>(sfinae_time.count()) / concepts_time.count();
-    std::cout << "性能比率 (SFINAE/Concepts): " << ratio << "\n";
+    double ratio = sfinae_result.median_ns / concepts_result.median_ns;
+    std::cout << "性能比率 (SFINAE/Concepts，按中位数): " << ratio << "\n";
     
     std::cout << "\n编译时优势:\n";
     std::cout << "- Concepts提供更清晰的错误消息\n";
@@ -715,7 +714,8 @@ void benchmark_concepts_vs_sfinae() {
 }
 
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++20 Concepts与约束系统深度解析\n";
     std::cout << "=================================\n";
     
@@ -19,6 +19,8 @@
 #include <chrono>
 #include <array>
 
+#include "../common/micro_bench.h"
+
 // ===== 1. 类型特性基础机制演示 =====
 void demonstrate_type_traits_basics() {
     std::cout << "=== 类型特性基础机制演示 ===\n";
@@ -574,36 +576,32 @@ void benchmark_type_traits() {
         }
     };
     
-    // 编译期版本基准测试
-    auto start = std::chrono::high_resolution_clock::now();
-    
+    // 预热、重复采样并取中位数交给统一基准框架，每次采样跑完整的iterations次
     int compile_time_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
-        compile_time_sum += compile_time_dispatch(i % 1000);
-    }
-    
-    auto compile_time_duration = std::chrono::high_resolution_clock::now() - start;
-    
-    // 运行期版本基准测试
-    start = std::chrono::high_resolution_clock::now();
+    const auto compile_time_result = micro_bench::measure("编译期类型检查", [&]() {
+        compile_time_sum = 0;
+        for (int i = 0; i < iterations; ++i) {
+            compile_time_sum += compile_time_dispatch(i % 1000);
+        }
+        micro_bench::do_not_optimize(compile_time_sum);
+    }, iterations);
     
     int runtime_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
-        runtime_sum += runtime_dispatch(i % 1000);
-    }
-    
-    auto runtime_duration = std::chrono::high_resolution_clock::now() - start;
+    const auto runtime_result = micro_bench::measure("运行期类型检查", [&]() {
+        runtime_sum = 0;
+        for (int i = 0; i < iterations; ++i) {
+            runtime_sum += runtime_dispatch(i % 1000);
+        }
+        micro_bench::do_not_optimize(runtime_sum);
+    }, iterations);
     
-    std::cout << "性能对比结果 (" << iterations << " 次迭代):\n";
-    std::cout << "编译期类型检查耗时: " 
-              << std::chrono::duration_cast<std::chrono::milliseconds>(compile_time_duration).count() 
-              << " 毫秒 (结果: " << compile_time_sum << ")\n";
-    std::cout << "运行期类型检查耗时: " 
-              << std::chrono::duration_cast<std::chrono::milliseconds>(runtime_duration).count() 
-              << " 毫秒 (结果: " << runtime_sum << ")\n";
+    std::cout << "性能对比结果 (每次采样 " << iterations << " 次迭代):\n";
+    micro_bench::print_result(std::cout, compile_time_result);
+    micro_bench::print_result(std::cout, runtime_result);
+    std::cout << "结果: 编译期 " << compile_time_sum << ", 运行期 " << runtime_sum << "\n";
     
-    double speedup = static_cast<double>(runtime_duration.count()) / compile_time_duration.count();
-    std::cout << "编译期优势: " << speedup << "x 性能提升\n";
+    double speedup = runtime_result.median_ns / compile_time_result.median_ns;
+    std::cout << "编译期优势: " << speedup << "x 性能提升（按中位数）\n";
     
     std::cout << "\n编译期优势总结:\n";
     std::cout << "- 零运行时开销的类型检查和分发\n";
@@ -615,7 +613,8 @@ void benchmark_type_traits() {
 }
 
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++11/14/17/20 type_traits库深度解析\n";
     std::cout << "===================================\n";
     
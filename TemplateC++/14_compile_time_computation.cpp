@@ -18,6 +18,8 @@
 #include <algorithm>
 #include <numeric>
 
+#include "../common/micro_bench.h"
+
 // ===== 1. constexpr基础机制演示 =====
 void demonstrate_constexpr_basics() {
     std::cout << "=== constexpr基础机制演示 ===\n";
@@ -696,36 +698,33 @@ void benchmark_compile_time_vs_runtime() {
     constexpr long long compile_time_fact_10 = factorial(10);
     constexpr long long compile_time_fib_20 = fibonacci(20);
     
-    // 基准测试：运行期计算
-    auto start = std::chrono::high_resolution_clock::now();
-    
+    // 基准测试：预热、重复采样并取中位数交给统一基准框架，每次采样跑完整的iterations次
     long long runtime_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
-        runtime_sum += runtime_factorial(10) + runtime_fibonacci(20);
-    }
-    
-    auto runtime_duration = std::chrono::high_resolution_clock::now() - start;
+    const auto runtime_result = micro_bench::measure("运行期计算", [&]() {
+        runtime_sum = 0;
+        for (int i = 0; i < iterations; ++i) {
+            runtime_sum += runtime_factorial(10) + runtime_fibonacci(20);
+        }
+        micro_bench::do_not_optimize(runtime_sum);
+    }, iterations);
     
     // 基准测试：使用编译期预计算值
-    start = std::chrono::high_resolution_clock::now();
-    
     long long compile_time_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
-        compile_time_sum += compile_time_fact_10 + compile_time_fib_20;
-    }
-    
-    auto compile_time_duration = std::chrono::high_resolution_clock::now() - start;
+    const auto compile_time_result = micro_bench::measure("编译期预计算", [&]() {
+        compile_time_sum = 0;
+        for (int i = 0; i < iterations; ++i) {
+            compile_time_sum += compile_time_fact_10 + compile_time_fib_20;
+        }
+        micro_bench::do_not_optimize(compile_time_sum);
+    }, iterations);
     
-    std::cout << "性能对比结果 (" << iterations << " 次迭代):\n";
-    std::cout << "运行期计算耗时: " 
-              << std::chrono::duration_cast<std::chrono::microseconds>(runtime_duration).count() 
-              << " 微秒 (结果: " << runtime_sum << ")\n";
-    std::cout << "编译期预计算耗时: " 
-              << std::chrono::duration_cast<std::chrono::microseconds>(compile_time_duration).count() 
-              << " 微秒 (结果: " << compile_time_sum << ")\n";
+    std::cout << "性能对比结果 (每次采样 " << iterations << " 次迭代):\n";
+    micro_bench::print_result(std::cout, runtime_result);
+    micro_bench::print_result(std::cout, compile_time_result);
+    std::cout << "结果: 运行期 " << runtime_sum << ", 编译期 " << compile_time_sum << "\n";
     
-    double speedup = static_cast<double>(runtime_duration.count()) / compile_time_duration.count();
-    std::cout << "编译期优势: " << speedup << "x 性能提升\n";
+    double speedup = runtime_result.median_ns / compile_time_result.median_ns;
+    std::cout << "编译期优势: " << speedup << "x 性能提升（按中位数）\n";
     
     // 查表法性能测试
     constexpr auto factorial_table = []() {
@@ -737,18 +736,17 @@ void benchmark_compile_time_vs_runtime() {
         return table;
     }();
     
-    start = std::chrono::high_resolution_clock::now();
-    
     long long table_sum = 0;
-    for (int i = 0; i < iterations; ++i) {
-        table_sum += factorial_table[10] + factorial_table[15];
-    }
-    
-    auto table_duration = std::chrono::high_resolution_clock::now() - start;
+    const auto table_result = micro_bench::measure("查表法", [&]() {
+        table_sum = 0;
+        for (int i = 0; i < iterations; ++i) {
+            table_sum += factorial_table[10] + factorial_table[15];
+        }
+        micro_bench::do_not_optimize(table_sum);
+    }, iterations);
     
-    std::cout << "查表法耗时: " 
-              << std::chrono::duration_cast<std::chrono::microseconds>(table_duration).count() 
-              << " 微秒 (结果: " << table_sum << ")\n";
+    micro_bench::print_result(std::cout, table_result);
+    std::cout << "结果: 查表法 " << table_sum << "\n";
     
     std::cout << "\n编译期计算优势总结:\n";
     std::cout << "- 零运行时计算开销\n";
@@ -760,7 +758,8 @@ void benchmark_compile_time_vs_runtime() {
 }
 
 // ===== 主函数 =====
-int main() {
+int main(int argc, char* argv[]) {
+    micro_bench::init(argc, argv);  // --json=/--csv=导出本次运行的全部基准结果
     std::cout << "C++11/14/17/20 编译期计算深度解析\n";
     std::cout << "=================================\n";
     
@@ -0,0 +1,74 @@
+/**
+ * 字节串哈希的公共实现
+ *
+ * C++14/04_generalized_constexpr_functions.cpp（运行时Swiss表与编译期完美哈希）
+ * 和C++20/04_consteval_constinit.cpp（static_string_map）共用这一份实现，
+ * 同一个constexpr函数既能在常量求值中构造哈希表，也能在运行时热路径上查找
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// 运行时快速路径需要__builtin_is_constant_evaluated（GCC 9+/Clang 9+），没有时只走逐字节路径
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BYTE_HASH_FAST_LOAD 1
+#endif
+#endif
+
+namespace byte_hash {
+
+// 按小端读取n个字节：常量求值时逐字节拼接，运行时在小端平台上直接memcpy，两者结果一致
+constexpr std::uint64_t load_le(const char* p, std::size_t n) {
+#if defined(BYTE_HASH_FAST_LOAD)
+    if (!__builtin_is_constant_evaluated()) {
+        std::uint64_t v = 0;
+        std::memcpy(&v, p, n);
+        return v;
+    }
+#endif
+    std::uint64_t v = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        v |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return v;
+}
+
+// murmur3的fmix64
+constexpr std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+constexpr std::uint64_t hash_round(std::uint64_t h, std::uint64_t k) {
+    k *= 0x87c37b91114253d5ULL;
+    k = (k << 31) | (k >> 33);
+    return (h ^ k) * 0x4cf5ad432745937fULL;
+}
+
+// 每次吃8字节；不足8字节的尾部用重叠读取代替逐字节循环，最后用mix64打散
+constexpr std::uint64_t hash_bytes(std::string_view s, std::uint64_t seed = 0) {
+    const char* p = s.data();
+    const std::size_t n = s.size();
+    std::uint64_t h = seed ^ (n * 0x9e3779b97f4a7c15ULL);
+    if (n >= 8) {
+        for (std::size_t i = 0; i + 8 < n; i += 8) h = hash_round(h, load_le(p + i, 8));
+        h = hash_round(h, load_le(p + n - 8, 8));
+    } else if (n >= 4) {
+        h = hash_round(h, (load_le(p, 4) << 32) | load_le(p + n - 4, 4));
+    } else if (n > 0) {
+        h = hash_round(h, (load_le(p, 1) << 16) | (load_le(p + n / 2, 1) << 8) | load_le(p + n - 1, 1));
+    }
+    return mix64(h);
+}
+
+} // namespace byte_hash
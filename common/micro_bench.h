@@ -0,0 +1,547 @@
+/**
+ * 统一微基准测试框架
+ *
+ * 预热 -> 标定每个样本的迭代次数 -> 重复采样 -> 稳健统计（中位数、p99、中位数的95%置信区间），
+ * 可选读取硬件计数器，并输出文本报告、JSON和CSV。
+ * C++14/06_stdlib_new_features.cpp的基准套件（--bench模式）和各示例文件里的性能对比共用这一份实现，
+ * 只依赖C++11标准库
+ *
+ * 每个包含本头文件的示例在main开头调用micro_bench::init(argc, argv)，运行时加上参数即可导出本次跑过的全部基准：
+ *   ./example --json=gcc12.json --csv=gcc12.csv --samples=51
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace micro_bench {
+
+// 防止编译器把被测结果当作死代码消除：让值"逃逸"到一段不透明的内联汇编
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile char* volatile escape = reinterpret_cast<const volatile char*>(&value);
+    (void)escape;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// 强制之前的内存写入对"外部"可见，阻止编译器合并或删除对同一块内存的重复写
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// 硬件计数器：Linux上通过perf_event_open读取周期、指令、缓存未命中和分支预测失败
+// 内核不允许（perf_event_paranoid、容器seccomp）或非Linux平台时available()为false，基准照常运行
+class HardwareCounters {
+public:
+    struct Snapshot {
+        std::uint64_t cycles = 0;
+        std::uint64_t instructions = 0;
+        std::uint64_t cache_misses = 0;
+        std::uint64_t branch_misses = 0;
+    };
+
+    HardwareCounters() {
+#if defined(__linux__)
+        const std::uint64_t configs[kEvents] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (int i = 0; i < kEvents; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = (i == 0);  // 组长先停住，start()时整组一起开始计数
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            const int group = (i == 0) ? -1 : fds_[0];
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+            if (fds_[i] < 0) {
+                close_all();
+                return;
+            }
+        }
+        available_ = true;
+#endif
+    }
+
+    ~HardwareCounters() { close_all(); }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    bool available() const { return available_; }
+
+    void start() {
+#if defined(__linux__)
+        if (!available_) return;
+        ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    Snapshot stop() {
+        Snapshot snapshot;
+#if defined(__linux__)
+        if (!available_) return snapshot;
+        ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        std::uint64_t values[1 + kEvents] = {};  // PERF_FORMAT_GROUP: 先是事件个数，后面依次是各计数值
+        if (read(fds_[0], values, sizeof(values)) == static_cast<ssize_t>(sizeof(values))) {
+            snapshot.cycles = values[1];
+            snapshot.instructions = values[2];
+            snapshot.cache_misses = values[3];
+            snapshot.branch_misses = values[4];
+        }
+#endif
+        return snapshot;
+    }
+
+private:
+    static constexpr int kEvents = 4;
+    int fds_[kEvents] = {-1, -1, -1, -1};
+    bool available_ = false;
+
+    void close_all() {
+#if defined(__linux__)
+        for (int& fd : fds_) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+#endif
+        available_ = false;
+    }
+};
+
+struct BenchmarkConfig {
+    std::chrono::nanoseconds warmup = std::chrono::milliseconds(20);
+    std::chrono::nanoseconds min_sample_time = std::chrono::milliseconds(1);  // 远大于时钟分辨率
+    std::size_t samples = 31;
+    bool hardware_counters = true;
+};
+
+// 单次迭代本身就要几十毫秒的场景（大循环、I/O）：少采几个样本，不额外预热
+inline BenchmarkConfig heavy_config(std::size_t samples = 7) {
+    BenchmarkConfig config;
+    config.warmup = std::chrono::nanoseconds(0);
+    config.min_sample_time = std::chrono::nanoseconds(0);
+    config.samples = samples;
+    return config;
+}
+
+struct BenchmarkResult {
+    std::string name;
+    std::size_t iterations_per_sample = 0;
+    std::size_t items_per_iteration = 1;
+    std::vector<double> samples_ns;  // 每个样本的单次迭代耗时，已排序
+    double mean_ns = 0;
+    double stddev_ns = 0;
+    double median_ns = 0;
+    double p99_ns = 0;
+    double min_ns = 0;
+    double ci_low_ns = 0;   // 中位数的95%置信区间（顺序统计量法，不假设正态分布）
+    double ci_high_ns = 0;
+    bool has_counters = false;
+    double cycles = 0;  // 以下均为每次迭代的平均值
+    double instructions = 0;
+    double cache_misses = 0;
+    double branch_misses = 0;
+
+    double items_per_second() const {
+        return median_ns > 0 ? items_per_iteration * 1e9 / median_ns : 0;
+    }
+
+    // 每个处理项的中位耗时，用于比较一次迭代处理了不同数量元素的基准
+    double median_ns_per_item() const {
+        return items_per_iteration > 0 ? median_ns / static_cast<double>(items_per_iteration) : median_ns;
+    }
+};
+
+inline std::string format_ns(double ns) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    if (ns >= 1e6) oss << ns / 1e6 << "ms";
+    else if (ns >= 1e3) oss << ns / 1e3 << "μs";
+    else oss << ns << "ns";
+    return oss.str();
+}
+
+// setw按字节计宽，中文名会错位：按UTF-8码点计数，非ASCII字符按两列算
+inline std::size_t display_width(const std::string& text) {
+    std::size_t width = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const auto byte = static_cast<unsigned char>(text[i]);
+        if (byte < 0x80) ++width;
+        else if ((byte & 0xC0) == 0xC0) width += 2;  // 多字节序列的首字节
+    }
+    return width;
+}
+
+inline std::string compiler_id() {
+    std::ostringstream oss;
+#if defined(__clang__)
+    oss << "clang " << __clang_major__ << "." << __clang_minor__ << "." << __clang_patchlevel__;
+#elif defined(__GNUC__)
+    oss << "gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "." << __GNUC_PATCHLEVEL__;
+#elif defined(_MSC_VER)
+    oss << "msvc " << _MSC_VER;
+#else
+    oss << "unknown";
+#endif
+    return oss.str();
+}
+
+// 一行报告：中位数 [95%CI] p99 ±变异系数，可选吞吐率和硬件计数器
+inline void print_result(std::ostream& os, const BenchmarkResult& r) {
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+    const std::size_t width = display_width(r.name);
+    os << "  " << r.name << std::string(width < 22 ? 22 - width : 1, ' ')
+       << "中位数 " << format_ns(r.median_ns)
+       << " [95%CI " << format_ns(r.ci_low_ns) << " ~ " << format_ns(r.ci_high_ns) << "]"
+       << " p99 " << format_ns(r.p99_ns)
+       << " ±" << (r.mean_ns > 0 ? 100.0 * r.stddev_ns / r.mean_ns : 0.0) << "%";
+    if (r.items_per_iteration > 1) os << " " << r.items_per_second() / 1e6 << " M项/秒";
+    if (r.has_counters) {
+        os << std::setprecision(2) << " IPC " << (r.cycles > 0 ? r.instructions / r.cycles : 0.0)
+           << " 缓存未命中 " << r.cache_misses << " 分支失败 " << r.branch_misses;
+    }
+    os << "\n";
+    os.flags(flags);
+    os.precision(precision);
+}
+
+// JSON字符串：转义引号、反斜杠和控制字符
+inline void write_json_string(std::ostream& os, const std::string& text) {
+    os << '"';
+    for (char ch : text) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (c == '"' || c == '\\') {
+            os << '\\' << ch;
+        } else if (c < 0x20) {
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+               << std::dec << std::setfill(' ');
+        } else {
+            os << ch;
+        }
+    }
+    os << '"';
+}
+
+// CSV字段：含逗号、引号或换行时整体加引号，内部引号写两遍
+inline void write_csv_field(std::ostream& os, const std::string& text) {
+    if (text.find_first_of(",\"\r\n") == std::string::npos) {
+        os << text;
+        return;
+    }
+    os << '"';
+    for (char ch : text) {
+        if (ch == '"') os << '"';
+        os << ch;
+    }
+    os << '"';
+}
+
+inline const char* csv_header() {
+    return "suite,name,compiler,iterations,median_ns,mean_ns,stddev_ns,p99_ns,min_ns,ci_low_ns,ci_high_ns,"
+           "items_per_second,cycles,instructions,cache_misses,branch_misses\n";
+}
+
+// 一条结果的JSON对象（调用方负责设置浮点格式）
+inline void write_json_result(std::ostream& os, const std::string& suite, const BenchmarkResult& r) {
+    os << "{\"suite\": ";
+    write_json_string(os, suite);
+    os << ", \"name\": ";
+    write_json_string(os, r.name);
+    os << ", \"iterations\": " << r.iterations_per_sample
+       << ", \"median_ns\": " << r.median_ns << ", \"mean_ns\": " << r.mean_ns
+       << ", \"stddev_ns\": " << r.stddev_ns << ", \"p99_ns\": " << r.p99_ns << ", \"min_ns\": " << r.min_ns
+       << ", \"ci95_ns\": [" << r.ci_low_ns << ", " << r.ci_high_ns << "]"
+       << ", \"items_per_second\": " << r.items_per_second();
+    if (r.has_counters) {
+        os << ", \"cycles\": " << r.cycles << ", \"instructions\": " << r.instructions
+           << ", \"cache_misses\": " << r.cache_misses << ", \"branch_misses\": " << r.branch_misses;
+    }
+    os << "}";
+}
+
+// 一条结果的CSV行（调用方负责设置浮点格式）
+inline void write_csv_row(std::ostream& os, const std::string& suite, const BenchmarkResult& r) {
+    write_csv_field(os, suite);
+    os << ",";
+    write_csv_field(os, r.name);
+    os << ",";
+    write_csv_field(os, compiler_id());
+    os << "," << r.iterations_per_sample << "," << r.median_ns << "," << r.mean_ns << "," << r.stddev_ns << ","
+       << r.p99_ns << "," << r.min_ns << "," << r.ci_low_ns << "," << r.ci_high_ns << "," << r.items_per_second() << ",";
+    if (r.has_counters) {
+        os << r.cycles << "," << r.instructions << "," << r.cache_misses << "," << r.branch_misses;
+    } else {
+        os << ",,,";
+    }
+    os << "\n";
+}
+
+// ---- 命令行钩子：收集本进程内跑过的所有基准，退出时统一写出 ----
+struct Session {
+    std::string program = "micro_bench";
+    std::string json_path;
+    std::string csv_path;
+    std::size_t samples = 0;  // 0表示沿用各基准自己的样本数
+    bool pending = false;     // 还有结果没写出
+    std::vector<std::pair<std::string, BenchmarkResult>> results;  // (套件, 结果)
+
+    bool collecting() const { return !json_path.empty() || !csv_path.empty(); }
+};
+
+inline Session& session() {
+    static Session instance;
+    return instance;
+}
+
+inline void record(const std::string& suite, const BenchmarkResult& result) {
+    Session& s = session();
+    if (!s.collecting()) return;
+    s.results.emplace_back(suite, result);
+    s.pending = true;
+}
+
+// 把收集到的结果写到--json=/--csv=指定的文件，失败时返回非0
+inline int write_reports() {
+    Session& s = session();
+    s.pending = false;
+    int status = 0;
+    if (!s.json_path.empty()) {
+        std::ofstream out(s.json_path);
+        out << std::fixed << std::setprecision(3) << "{\n  \"program\": ";
+        write_json_string(out, s.program);
+        out << ",\n  \"compiler\": ";
+        write_json_string(out, compiler_id());
+        out << ",\n  \"cplusplus\": " << __cplusplus << ",\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < s.results.size(); ++i) {
+            out << (i ? ",\n    " : "\n    ");
+            write_json_result(out, s.results[i].first, s.results[i].second);
+        }
+        out << "\n  ]\n}\n";
+        if (!out) {
+            std::cerr << "无法写入 " << s.json_path << "\n";
+            status = 1;
+        }
+    }
+    if (!s.csv_path.empty()) {
+        std::ofstream out(s.csv_path);
+        out << csv_header() << std::fixed << std::setprecision(3);
+        for (const auto& entry : s.results) write_csv_row(out, entry.first, entry.second);
+        if (!out) {
+            std::cerr << "无法写入 " << s.csv_path << "\n";
+            status = 1;
+        }
+    }
+    return status;
+}
+
+// 解析--json=、--csv=、--samples=；指定了输出文件时，程序正常退出前自动写出（已手动调用write_reports则跳过）
+inline void init(int argc, char* argv[]) {
+    Session& s = session();
+    if (argc > 0 && argv[0]) {
+        const std::string path = argv[0];
+        const std::size_t slash = path.find_last_of("/\\");
+        s.program = slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.compare(0, 7, "--json=") == 0) s.json_path = arg.substr(7);
+        else if (arg.compare(0, 6, "--csv=") == 0) s.csv_path = arg.substr(6);
+        else if (arg.compare(0, 10, "--samples=") == 0) s.samples = static_cast<std::size_t>(std::max(1, std::atoi(arg.c_str() + 10)));
+    }
+    static bool registered = false;
+    if (s.collecting() && !registered) {
+        registered = true;
+        std::atexit([] {
+            if (session().pending) write_reports();
+        });
+    }
+}
+
+// 对已采集的样本排序并计算统计量；自行采样（例如多个方案交替运行）的基准也用它汇总
+inline void summarize(BenchmarkResult& r) {
+    auto& s = r.samples_ns;
+    std::sort(s.begin(), s.end());
+    const std::size_t n = s.size();
+    double sum = 0;
+    for (double v : s) sum += v;
+    r.mean_ns = sum / n;
+    double squares = 0;
+    for (double v : s) squares += (v - r.mean_ns) * (v - r.mean_ns);
+    r.stddev_ns = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+    r.min_ns = s.front();
+    r.median_ns = (n % 2) ? s[n / 2] : (s[n / 2 - 1] + s[n / 2]) / 2;
+    r.p99_ns = s[std::min(n - 1, static_cast<std::size_t>(std::ceil(0.99 * n)) - 1)];
+    // 样本落在中位数两侧的个数服从Binomial(n, 0.5)：区间取第j和第n+1-j个顺序统计量（从1数起），
+    // j = ⌊n/2 - 1.96·√n/2⌋；s从0开始编号，所以下标是j-1和n-j
+    const double half_width = 0.98 * std::sqrt(static_cast<double>(n));
+    const std::size_t j = static_cast<std::size_t>(std::max(1.0, std::floor(n / 2.0 - half_width)));
+    r.ci_low_ns = s[j - 1];
+    r.ci_high_ns = s[n - j];
+}
+
+// 由自行采集的样本（每次迭代的耗时，纳秒）构造结果
+inline BenchmarkResult from_samples(const std::string& name, std::vector<double> samples_ns,
+                                    std::size_t items_per_iteration = 1) {
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations_per_sample = 1;
+    result.items_per_iteration = items_per_iteration;
+    result.samples_ns = std::move(samples_ns);
+    summarize(result);
+    record(session().program, result);
+    return result;
+}
+
+// 性能基准测试器：预热 -> 标定每个样本的迭代次数 -> 重复采样 -> 统计
+// 被测函数每调用一次计为一次迭代，结果应通过do_not_optimize逃逸
+class PerformanceBenchmark {
+public:
+    explicit PerformanceBenchmark(std::string suite, BenchmarkConfig config = BenchmarkConfig())
+        : suite_(std::move(suite)), config_(config) {
+        if (session().samples > 0) config_.samples = session().samples;
+    }
+
+    template<typename Func>
+    const BenchmarkResult& run(const std::string& name, Func&& body, std::size_t items_per_iteration = 1) {
+        using clock = std::chrono::steady_clock;
+
+        // 预热：填充缓存、触发惰性初始化并让CPU升频，顺便估计单次耗时
+        std::size_t warmup_iterations = 0;
+        const auto warmup_start = clock::now();
+        do {
+            body();
+            ++warmup_iterations;
+        } while (clock::now() - warmup_start < config_.warmup);
+        const double warmup_ns = std::chrono::duration<double, std::nano>(clock::now() - warmup_start).count();
+        const double estimate_ns = warmup_ns / static_cast<double>(warmup_iterations);
+
+        BenchmarkResult result;
+        result.name = name;
+        result.items_per_iteration = items_per_iteration;
+        result.iterations_per_sample = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(
+            static_cast<double>(config_.min_sample_time.count()) / std::max(estimate_ns, 1.0))));
+        result.samples_ns.reserve(config_.samples);
+
+        HardwareCounters* counters = config_.hardware_counters && counters_.available() ? &counters_ : nullptr;
+        HardwareCounters::Snapshot totals;
+        for (std::size_t s = 0; s < config_.samples; ++s) {
+            if (counters) counters->start();
+            const auto start = clock::now();
+            for (std::size_t i = 0; i < result.iterations_per_sample; ++i) {
+                body();
+            }
+            const auto end = clock::now();
+            if (counters) {
+                const auto snapshot = counters->stop();
+                totals.cycles += snapshot.cycles;
+                totals.instructions += snapshot.instructions;
+                totals.cache_misses += snapshot.cache_misses;
+                totals.branch_misses += snapshot.branch_misses;
+            }
+            result.samples_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count() /
+                                        static_cast<double>(result.iterations_per_sample));
+        }
+
+        summarize(result);
+        if (counters) {
+            const double iterations = static_cast<double>(result.iterations_per_sample * config_.samples);
+            result.has_counters = true;
+            result.cycles = totals.cycles / iterations;
+            result.instructions = totals.instructions / iterations;
+            result.cache_misses = totals.cache_misses / iterations;
+            result.branch_misses = totals.branch_misses / iterations;
+        }
+        record(suite_, result);
+        results_.push_back(std::move(result));
+        return results_.back();
+    }
+
+    const std::vector<BenchmarkResult>& results() const { return results_; }
+    bool counters_available() const { return config_.hardware_counters && counters_.available(); }
+
+    void print_report(std::ostream& os = std::cout) const {
+        os << "基准套件 [" << suite_ << "] 样本数 " << config_.samples
+           << (counters_available() ? "，硬件计数器已启用" : "，硬件计数器不可用") << "\n";
+        for (const auto& r : results_) print_result(os, r);
+    }
+
+    // JSON带上编译器与标准版本，便于跨编译器版本对比回归
+    void write_json(std::ostream& os) const {
+        const auto flags = os.flags();
+        const auto precision = os.precision();
+        os << std::fixed << std::setprecision(3) << "{\n  \"suite\": ";
+        write_json_string(os, suite_);
+        os << ",\n  \"compiler\": ";
+        write_json_string(os, compiler_id());
+        os << ",\n  \"cplusplus\": " << __cplusplus << ",\n  \"samples\": " << config_.samples << ",\n"
+           << "  \"benchmarks\": [";
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            os << (i ? ",\n    " : "\n    ");
+            write_json_result(os, suite_, results_[i]);
+        }
+        os << "\n  ]\n}\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    void write_csv(std::ostream& os, bool header = true) const {
+        const auto flags = os.flags();
+        const auto precision = os.precision();
+        if (header) os << csv_header();
+        os << std::fixed << std::setprecision(3);
+        for (const auto& r : results_) write_csv_row(os, suite_, r);
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+private:
+    std::string suite_;
+    BenchmarkConfig config_;
+    HardwareCounters counters_;
+    std::vector<BenchmarkResult> results_;
+};
+
+// 只跑一个基准、不需要汇总报告时的简写
+template<typename Func>
+BenchmarkResult measure(const std::string& name, Func&& body, std::size_t items_per_iteration = 1,
+                        BenchmarkConfig config = BenchmarkConfig()) {
+    PerformanceBenchmark bench(session().program, config);
+    return bench.run(name, std::forward<Func>(body), items_per_iteration);
+}
+
+} // namespace micro_bench